@@ -40,6 +40,7 @@ THE SOFTWARE.
 #include "touch_dispatcher/CCTouchDispatcher.h"
 #include "support/CCPointExtension.h"
 #include "support/CCNotificationCenter.h"
+#include "CCEventType.h"
 #include "layers_scenes_transitions_nodes/CCTransition.h"
 #include "textures/CCTextureCache.h"
 #include "sprite_nodes/CCSpriteFrameCache.h"
@@ -49,6 +50,7 @@ THE SOFTWARE.
 #include "CCApplication.h"
 #include "label_nodes/CCLabelBMFont.h"
 #include "label_nodes/CCLabelAtlas.h"
+#include "misc_nodes/CCRenderTexture.h"
 #include "actions/CCActionManager.h"
 #include "CCConfiguration.h"
 #include "keypad_dispatcher/CCKeypadDispatcher.h"
@@ -459,12 +461,14 @@ void CCDirector::purgeCachedData(void)
     if (s_SharedDirector->getOpenGLView())
     {
         CCSpriteFrameCache::sharedSpriteFrameCache()->purgeSharedSpriteFrameCache();
+        CCRenderTexture::purgeRenderTargetPool();
         CCTextureCache::sharedTextureCache()->removeUnusedTextures();
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
         CCTextureCache::sharedTextureCache()->dumpCachedTextureInfo();
 #endif
     }
     CCFileUtils::sharedFileUtils()->purgeCachedEntries();
+    CCNotificationCenter::sharedNotificationCenter()->postNotification(EVENT_PURGE_CACHED_DATA, NULL);
 }
 
 float CCDirector::getZEye(void)
@@ -731,6 +735,7 @@ void CCDirector::purgeDirector()
 
     // purge all managed caches
     ccDrawFree();
+    CCRenderTexture::purgeRenderTargetPool();
     CCAnimationCache::purgeSharedAnimationCache();
     CCSpriteFrameCache::purgeSharedSpriteFrameCache();
     CCTextureCache::purgeSharedTextureCache();
@@ -27,10 +27,10 @@ THE SOFTWARE.
 #include "CCScheduler.h"
 #include "ccMacros.h"
 #include "CCDirector.h"
-#include "support/data_support/utlist.h"
-#include "support/data_support/ccCArray.h"
 #include "cocoa/CCArray.h"
+#include "cocoa/CCSet.h"
 #include "script_support/CCScriptSupport.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -38,35 +38,157 @@ NS_CC_BEGIN
 
 // data structures
 
-// A list double-linked list used for "updates with priority"
-typedef struct _listEntry
+// A slot in the dense array of "updates with priority" of one priority
+typedef struct _updateSlot
 {
-    struct _listEntry   *prev, *next;
-    CCObject            *target;        // not retained (retained by hashUpdateEntry)
-    int                 priority;
+    CCObject            *target;        // not retained (retained by the target entry). NULL for a tombstone
+    struct _targetEntry *entry;
     bool                paused;
-    bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
-} tListEntry;
+    bool                markedForDeletion; // selector will no longer be called and slot will be cleared at end of the next tick
+} tUpdateSlot;
 
-typedef struct _hashUpdateEntry
+// The update selectors of one priority, in the order they were scheduled
+typedef struct _updateBucket
 {
-    tListEntry          **list;        // Which list does it belong to ?
-    tListEntry          *entry;        // entry in the list
-    CCObject            *target;        // hash key (retained)
-    UT_hash_handle      hh;
-} tHashUpdateEntry;
+    int                     priority;
+    std::vector<tUpdateSlot> slots;
+    unsigned int            deadCount;  // number of tombstones in slots
+} tUpdateBucket;
 
-// Hash Element used for "selectors with interval"
-typedef struct _hashSelectorEntry
+// Everything scheduled for one target
+typedef struct _targetEntry
 {
-    ccArray             *timers;
-    CCObject            *target;    // hash key (retained)
-    unsigned int        timerIndex;
-    CCTimer             *currentTimer;
-    bool                currentTimerSalvaged;
-    bool                paused;
-    UT_hash_handle      hh;
-} tHashTimerEntry;
+    CCObject                *target;        // map key (retained once for the update selector, and once for the custom selectors)
+    tUpdateBucket           *updateBucket;  // bucket holding the update selector, or NULL
+    unsigned int            updateSlot;
+    std::vector<CCTimer*>   timers;         // custom selectors, in the order they were scheduled (retained)
+    unsigned int            timerTargetSlot; // index in the ordered list of targets with custom selectors
+    unsigned int            timerIndex;
+    CCTimer                 *currentTimer;
+    bool                    currentTimerSalvaged;
+    bool                    hasTimers;
+    bool                    timersPaused;
+} tTargetEntry;
+
+// Open addressing map from target to entry, with linear probing and backward shift deletion
+class CCSchedulerTargetMap
+{
+public:
+    CCSchedulerTargetMap()
+    : m_uCount(0)
+    , m_uMask(63)
+    {
+        m_pSlots = (tMapSlot*)calloc(m_uMask + 1, sizeof(tMapSlot));
+    }
+
+    ~CCSchedulerTargetMap()
+    {
+        free(m_pSlots);
+    }
+
+    tTargetEntry* find(const CCObject *pTarget) const
+    {
+        for (unsigned int i = hash(pTarget) & m_uMask; m_pSlots[i].key; i = (i + 1) & m_uMask)
+        {
+            if (m_pSlots[i].key == pTarget)
+            {
+                return m_pSlots[i].entry;
+            }
+        }
+        return NULL;
+    }
+
+    void insert(tTargetEntry *pEntry)
+    {
+        if ((m_uCount + 1) * 2 > m_uMask + 1)
+        {
+            grow();
+        }
+        place(pEntry->target, pEntry);
+        m_uCount++;
+    }
+
+    void erase(const CCObject *pTarget)
+    {
+        unsigned int i = hash(pTarget) & m_uMask;
+        while (m_pSlots[i].key != pTarget)
+        {
+            if (! m_pSlots[i].key)
+            {
+                return;
+            }
+            i = (i + 1) & m_uMask;
+        }
+
+        // shift back the following entries of the run that may move into the hole
+        for (unsigned int j = (i + 1) & m_uMask; m_pSlots[j].key; j = (j + 1) & m_uMask)
+        {
+            unsigned int home = hash(m_pSlots[j].key) & m_uMask;
+            if (((j - home) & m_uMask) >= ((j - i) & m_uMask))
+            {
+                m_pSlots[i] = m_pSlots[j];
+                i = j;
+            }
+        }
+        m_pSlots[i].key = NULL;
+        m_pSlots[i].entry = NULL;
+        m_uCount--;
+    }
+
+private:
+    typedef struct
+    {
+        const CCObject  *key;
+        tTargetEntry    *entry;
+    } tMapSlot;
+
+    static unsigned int hash(const CCObject *pTarget)
+    {
+        unsigned long long v = (unsigned long long)(size_t)pTarget;
+        return (unsigned int)(((v >> 3) * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    void place(const CCObject *pKey, tTargetEntry *pEntry)
+    {
+        unsigned int i = hash(pKey) & m_uMask;
+        while (m_pSlots[i].key)
+        {
+            i = (i + 1) & m_uMask;
+        }
+        m_pSlots[i].key = pKey;
+        m_pSlots[i].entry = pEntry;
+    }
+
+    void grow()
+    {
+        tMapSlot *pOld = m_pSlots;
+        unsigned int uOldSize = m_uMask + 1;
+        m_uMask = uOldSize * 2 - 1;
+        m_pSlots = (tMapSlot*)calloc(m_uMask + 1, sizeof(tMapSlot));
+        for (unsigned int i = 0; i < uOldSize; ++i)
+        {
+            if (pOld[i].key)
+            {
+                place(pOld[i].key, pOld[i].entry);
+            }
+        }
+        free(pOld);
+    }
+
+    tMapSlot        *m_pSlots;
+    unsigned int    m_uCount;
+    unsigned int    m_uMask;
+};
+
+static bool bucketIsBefore(const tUpdateBucket *pBucket, int nPriority)
+{
+    return pBucket->priority < nPriority;
+}
+
+static bool priorityIsBefore(int nPriority, const tUpdateBucket *pBucket)
+{
+    return nPriority < pBucket->priority;
+}
 
 // implementation CCTimer
 
@@ -236,11 +358,8 @@ SEL_SCHEDULE CCTimer::getSelector() const
 
 CCScheduler::CCScheduler(void)
 : m_fTimeScale(1.0f)
-, m_pUpdatesNegList(NULL)
-, m_pUpdates0List(NULL)
-, m_pUpdatesPosList(NULL)
-, m_pHashForUpdates(NULL)
-, m_pHashForTimers(NULL)
+, m_pTargets(new CCSchedulerTargetMap())
+, m_uDeadTimerTargets(0)
 , m_pCurrentTarget(NULL)
 , m_bCurrentTargetSalvaged(false)
 , m_bUpdateHashLocked(false)
@@ -253,22 +372,90 @@ CCScheduler::~CCScheduler(void)
 {
     unscheduleAll();
     CC_SAFE_RELEASE(m_pScriptHandlerEntries);
+
+    for (unsigned int i = 0; i < m_updateBuckets.size(); ++i)
+    {
+        delete m_updateBuckets[i];
+    }
+    for (unsigned int i = 0; i < m_deadEntries.size(); ++i)
+    {
+        delete m_deadEntries[i];
+    }
+    delete m_pTargets;
 }
 
-void CCScheduler::removeHashElement(_hashSelectorEntry *pElement)
+tTargetEntry* CCScheduler::createEntry(CCObject *pTarget)
 {
+    tTargetEntry *pEntry = new tTargetEntry();
+    pEntry->target = pTarget;
+    pEntry->updateBucket = NULL;
+    pEntry->updateSlot = 0;
+    pEntry->timerTargetSlot = 0;
+    pEntry->timerIndex = 0;
+    pEntry->currentTimer = NULL;
+    pEntry->currentTimerSalvaged = false;
+    pEntry->hasTimers = false;
+    pEntry->timersPaused = false;
+    m_pTargets->insert(pEntry);
+
+    return pEntry;
+}
 
-	cocos2d::CCObject *target = pElement->target;
+void CCScheduler::releaseEntryIfUnused(tTargetEntry *pEntry)
+{
+    if (pEntry->updateBucket || pEntry->hasTimers)
+    {
+        return;
+    }
 
-    ccArrayFree(pElement->timers);
-    HASH_DEL(m_pHashForTimers, pElement);
-    free(pElement);
+    m_pTargets->erase(pEntry->target);
+
+    // the entry may still be referenced by the tick in progress
+    if (m_bUpdateHashLocked)
+    {
+        m_deadEntries.push_back(pEntry);
+    }
+    else
+    {
+        delete pEntry;
+    }
+}
 
-    // make sure the target is released after we have removed the hash element
+void CCScheduler::removeTimersOfEntry(tTargetEntry *pEntry)
+{
+    CCObject *pTarget = pEntry->target;
+
+    // leave a tombstone, so the targets following it are still called on the tick in progress
+    m_timerTargets[pEntry->timerTargetSlot] = NULL;
+    m_uDeadTimerTargets++;
+    if (! m_bUpdateHashLocked && m_uDeadTimerTargets * 2 >= m_timerTargets.size())
+    {
+        compactTimerTargets();
+    }
+
+    pEntry->hasTimers = false;
+    releaseEntryIfUnused(pEntry);
+
+    // make sure the target is released after we have removed the entry
     // otherwise we access invalid memory when the release call deletes the target
     // and the target calls removeAllSelectors() during its destructor
-    target->release();
+    pTarget->release();
+}
 
+void CCScheduler::compactTimerTargets()
+{
+    unsigned int uCount = 0;
+    for (unsigned int i = 0; i < m_timerTargets.size(); ++i)
+    {
+        tTargetEntry *pEntry = m_timerTargets[i];
+        if (pEntry)
+        {
+            pEntry->timerTargetSlot = uCount;
+            m_timerTargets[uCount++] = pEntry;
+        }
+    }
+    m_timerTargets.resize(uCount);
+    m_uDeadTimerTargets = 0;
 }
 
 void CCScheduler::scheduleSelector(SEL_SCHEDULE pfnSelector, CCObject *pTarget, float fInterval, bool bPaused)
@@ -281,51 +468,43 @@ void CCScheduler::scheduleSelector(SEL_SCHEDULE pfnSelector, CCObject *pTarget,
     CCAssert(pfnSelector, "Argument selector must be non-NULL");
     CCAssert(pTarget, "Argument target must be non-NULL");
 
-    tHashTimerEntry *pElement = NULL;
-    HASH_FIND_INT(m_pHashForTimers, &pTarget, pElement);
+    tTargetEntry *pEntry = m_pTargets->find(pTarget);
+    if (! pEntry)
+    {
+        pEntry = createEntry(pTarget);
+    }
 
-    if (! pElement)
+    if (! pEntry->hasTimers)
     {
-        pElement = (tHashTimerEntry *)calloc(sizeof(*pElement), 1);
-        pElement->target = pTarget;
-        if (pTarget)
-        {
-            pTarget->retain();
-        }
-        HASH_ADD_INT(m_pHashForTimers, target, pElement);
+        // targets scheduled during a tick are called on that tick, after the others
+        pEntry->hasTimers = true;
+        pEntry->timerTargetSlot = m_timerTargets.size();
+        m_timerTargets.push_back(pEntry);
+        pTarget->retain();
 
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        pElement->paused = bPaused;
+        pEntry->timersPaused = bPaused;
     }
     else
     {
-        CCAssert(pElement->paused == bPaused, "");
-    }
+        CCAssert(pEntry->timersPaused == bPaused, "");
 
-    if (pElement->timers == NULL)
-    {
-        pElement->timers = ccArrayNew(10);
-    }
-    else 
-    {
-        for (unsigned int i = 0; i < pElement->timers->num; ++i)
+        for (unsigned int i = 0; i < pEntry->timers.size(); ++i)
         {
-            CCTimer *timer = (CCTimer*)pElement->timers->arr[i];
+            CCTimer *timer = pEntry->timers[i];
 
             if (pfnSelector == timer->getSelector())
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), fInterval);
                 timer->setInterval(fInterval);
                 return;
-            }        
+            }
         }
-        ccArrayEnsureExtraCapacity(pElement->timers, 1);
     }
 
     CCTimer *pTimer = new CCTimer();
     pTimer->initWithTarget(pTarget, pfnSelector, fInterval, repeat, delay);
-    ccArrayAppendObject(pElement->timers, pTimer);
-    pTimer->release();    
+    pEntry->timers.push_back(pTimer);
 }
 
 void CCScheduler::unscheduleSelector(SEL_SCHEDULE pfnSelector, CCObject *pTarget)
@@ -336,180 +515,172 @@ void CCScheduler::unscheduleSelector(SEL_SCHEDULE pfnSelector, CCObject *pTarget
         return;
     }
 
-    //CCAssert(pTarget);
-    //CCAssert(pfnSelector);
-
-    tHashTimerEntry *pElement = NULL;
-    HASH_FIND_INT(m_pHashForTimers, &pTarget, pElement);
+    tTargetEntry *pEntry = m_pTargets->find(pTarget);
+    if (! pEntry || ! pEntry->hasTimers)
+    {
+        return;
+    }
 
-    if (pElement)
+    for (unsigned int i = 0; i < pEntry->timers.size(); ++i)
     {
-        for (unsigned int i = 0; i < pElement->timers->num; ++i)
-        {
-            CCTimer *pTimer = (CCTimer*)(pElement->timers->arr[i]);
+        CCTimer *pTimer = pEntry->timers[i];
 
-            if (pfnSelector == pTimer->getSelector())
+        if (pfnSelector == pTimer->getSelector())
+        {
+            if (pTimer == pEntry->currentTimer && (! pEntry->currentTimerSalvaged))
             {
-                if (pTimer == pElement->currentTimer && (! pElement->currentTimerSalvaged))
-                {
-                    pElement->currentTimer->retain();
-                    pElement->currentTimerSalvaged = true;
-                }
-
-                ccArrayRemoveObjectAtIndex(pElement->timers, i, true);
-
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (pElement->timerIndex >= i)
-                {
-                    pElement->timerIndex--;
-                }
-
-                if (pElement->timers->num == 0)
-                {
-                    if (m_pCurrentTarget == pElement)
-                    {
-                        m_bCurrentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(pElement);
-                    }
-                }
-
-                return;
+                pEntry->currentTimer->retain();
+                pEntry->currentTimerSalvaged = true;
             }
-        }
-    }
-}
-
-void CCScheduler::priorityIn(tListEntry **ppList, CCObject *pTarget, int nPriority, bool bPaused)
-{
-    tListEntry *pListElement = (tListEntry *)malloc(sizeof(*pListElement));
 
-    pListElement->target = pTarget;
-    pListElement->priority = nPriority;
-    pListElement->paused = bPaused;
-    pListElement->next = pListElement->prev = NULL;
-    pListElement->markedForDeletion = false;
+            pEntry->timers.erase(pEntry->timers.begin() + i);
+            pTimer->release();
 
-    // empty list ?
-    if (! *ppList)
-    {
-        DL_APPEND(*ppList, pListElement);
-    }
-    else
-    {
-        bool bAdded = false;
+            // update timerIndex in case we are in tick:, looping over the actions
+            if (pEntry->timerIndex >= i)
+            {
+                pEntry->timerIndex--;
+            }
 
-        for (tListEntry *pElement = *ppList; pElement; pElement = pElement->next)
-        {
-            if (nPriority < pElement->priority)
+            if (pEntry->timers.empty())
             {
-                if (pElement == *ppList)
+                if (m_pCurrentTarget == pEntry)
                 {
-                    DL_PREPEND(*ppList, pListElement);
+                    m_bCurrentTargetSalvaged = true;
                 }
                 else
                 {
-                    pListElement->next = pElement;
-                    pListElement->prev = pElement->prev;
-
-                    pElement->prev->next = pListElement;
-                    pElement->prev = pListElement;
+                    removeTimersOfEntry(pEntry);
                 }
-
-                bAdded = true;
-                break;
             }
-        }
 
-        // Not added? priority has the higher value. Append it.
-        if (! bAdded)
-        {
-            DL_APPEND(*ppList, pListElement);
+            return;
         }
     }
-
-    // update hash entry for quick access
-    tHashUpdateEntry *pHashElement = (tHashUpdateEntry *)calloc(sizeof(*pHashElement), 1);
-    pHashElement->target = pTarget;
-    pTarget->retain();
-    pHashElement->list = ppList;
-    pHashElement->entry = pListElement;
-    HASH_ADD_INT(m_pHashForUpdates, target, pHashElement);
 }
 
-void CCScheduler::appendIn(_listEntry **ppList, CCObject *pTarget, bool bPaused)
-{
-    tListEntry *pListElement = (tListEntry *)malloc(sizeof(*pListElement));
+// update specific
 
-    pListElement->target = pTarget;
-    pListElement->paused = bPaused;
-    pListElement->markedForDeletion = false;
+tUpdateBucket* CCScheduler::bucketForPriority(int nPriority)
+{
+    std::vector<tUpdateBucket*>::iterator it = std::lower_bound(m_updateBuckets.begin(), m_updateBuckets.end(), nPriority, bucketIsBefore);
+    if (it != m_updateBuckets.end() && (*it)->priority == nPriority)
+    {
+        return *it;
+    }
 
-    DL_APPEND(*ppList, pListElement);
+    tUpdateBucket *pBucket = new tUpdateBucket();
+    pBucket->priority = nPriority;
+    pBucket->deadCount = 0;
+    m_updateBuckets.insert(it, pBucket);
 
-    // update hash entry for quicker access
-    tHashUpdateEntry *pHashElement = (tHashUpdateEntry *)calloc(sizeof(*pHashElement), 1);
-    pHashElement->target = pTarget;
-    pTarget->retain();
-    pHashElement->list = ppList;
-    pHashElement->entry = pListElement;
-    HASH_ADD_INT(m_pHashForUpdates, target, pHashElement);
+    return pBucket;
 }
 
 void CCScheduler::scheduleUpdateForTarget(CCObject *pTarget, int nPriority, bool bPaused)
 {
-
-    tHashUpdateEntry *pHashElement = NULL;
-    HASH_FIND_INT(m_pHashForUpdates, &pTarget, pHashElement);
-    if (pHashElement)
+    tTargetEntry *pEntry = m_pTargets->find(pTarget);
+    if (pEntry && pEntry->updateBucket)
     {
+        tUpdateSlot &slot = pEntry->updateBucket->slots[pEntry->updateSlot];
 #if COCOS2D_DEBUG >= 1
-        CCAssert(pHashElement->entry->markedForDeletion,"");
+        CCAssert(slot.markedForDeletion,"");
 #endif
         // TODO: check if priority has changed!
-        pHashElement->entry->paused = bPaused;
-        pHashElement->entry->markedForDeletion = false;
+        slot.paused = bPaused;
+        slot.markedForDeletion = false;
         return;
     }
 
-    // most of the updates are going to be 0, that's way there
-    // is an special list for updates with priority 0
-    if (nPriority == 0)
+    if (! pEntry)
     {
-        appendIn(&m_pUpdates0List, pTarget, bPaused);
+        pEntry = createEntry(pTarget);
     }
-    else if (nPriority < 0)
+
+    // updates of the same priority are called in the order they were scheduled
+    tUpdateBucket *pBucket = bucketForPriority(nPriority);
+    tUpdateSlot slot = { pTarget, pEntry, bPaused, false };
+    pEntry->updateBucket = pBucket;
+    pEntry->updateSlot = pBucket->slots.size();
+    pBucket->slots.push_back(slot);
+    pTarget->retain();
+}
+
+void CCScheduler::removeUpdate(tTargetEntry *pEntry)
+{
+    tUpdateBucket *pBucket = pEntry->updateBucket;
+    tUpdateSlot &slot = pBucket->slots[pEntry->updateSlot];
+    CCObject *pTarget = slot.target;
+
+    // leave a tombstone, so the indices of the other slots stay valid during a tick
+    slot.target = NULL;
+    slot.entry = NULL;
+    pBucket->deadCount++;
+    pEntry->updateBucket = NULL;
+    releaseEntryIfUnused(pEntry);
+
+    if (! m_bUpdateHashLocked && pBucket->deadCount * 2 >= pBucket->slots.size())
     {
-        priorityIn(&m_pUpdatesNegList, pTarget, nPriority, bPaused);
+        compactBucket(pBucket);
+        removeEmptyBuckets();
     }
-    else
+
+    // target#release should be the last one to prevent
+    // a possible double-free. eg: If the [target dealloc] might want to remove it itself from there
+    pTarget->release();
+}
+
+void CCScheduler::compactBucket(tUpdateBucket *pBucket)
+{
+    unsigned int uCount = 0;
+    for (unsigned int i = 0; i < pBucket->slots.size(); ++i)
     {
-        // priority > 0
-        priorityIn(&m_pUpdatesPosList, pTarget, nPriority, bPaused);
+        tUpdateSlot &slot = pBucket->slots[i];
+        if (slot.target)
+        {
+            slot.entry->updateSlot = uCount;
+            pBucket->slots[uCount++] = slot;
+        }
     }
+    pBucket->slots.resize(uCount);
+    pBucket->deadCount = 0;
 }
 
-void CCScheduler::removeUpdateFromHash(struct _listEntry *entry)
+void CCScheduler::removeEmptyBuckets()
 {
-    tHashUpdateEntry *element = NULL;
-
-    HASH_FIND_INT(m_pHashForUpdates, &entry->target, element);
-    if (element)
+    unsigned int uCount = 0;
+    for (unsigned int i = 0; i < m_updateBuckets.size(); ++i)
     {
-        // list entry
-        DL_DELETE(*element->list, element->entry);
-        free(element->entry);
+        tUpdateBucket *pBucket = m_updateBuckets[i];
+        if (pBucket->deadCount == pBucket->slots.size())
+        {
+            delete pBucket;
+        }
+        else
+        {
+            m_updateBuckets[uCount++] = pBucket;
+        }
+    }
+    m_updateBuckets.resize(uCount);
+}
 
-        // hash entry
-        CCObject* pTarget = element->target;
-        HASH_DEL(m_pHashForUpdates, element);
-        free(element);
+void CCScheduler::dispatchUpdates(float dt)
+{
+    unsigned int uBucket = 0;
+    while (uBucket < m_updateBuckets.size())
+    {
+        // the slots may grow while they are being called, and buckets may be added
+        tUpdateBucket *pBucket = m_updateBuckets[uBucket];
+        for (unsigned int i = 0; i < pBucket->slots.size(); ++i)
+        {
+            const tUpdateSlot &slot = pBucket->slots[i];
+            if (slot.target && (! slot.paused) && (! slot.markedForDeletion))
+            {
+                slot.target->update(dt);
+            }
+        }
 
-        // target#release should be the last one to prevent
-        // a possible double-free. eg: If the [target dealloc] might want to remove it itself from there
-        pTarget->release();
+        uBucket = std::upper_bound(m_updateBuckets.begin(), m_updateBuckets.end(), pBucket->priority, priorityIsBefore) - m_updateBuckets.begin();
     }
 }
 
@@ -520,17 +691,21 @@ void CCScheduler::unscheduleUpdateForTarget(const CCObject *pTarget)
         return;
     }
 
-    tHashUpdateEntry *pElement = NULL;
-    HASH_FIND_INT(m_pHashForUpdates, &pTarget, pElement);
-    if (pElement)
+    tTargetEntry *pEntry = m_pTargets->find(pTarget);
+    if (pEntry && pEntry->updateBucket)
     {
         if (m_bUpdateHashLocked)
         {
-            pElement->entry->markedForDeletion = true;
+            tUpdateSlot &slot = pEntry->updateBucket->slots[pEntry->updateSlot];
+            if (! slot.markedForDeletion)
+            {
+                slot.markedForDeletion = true;
+                m_pendingUpdateRemovals.push_back(pEntry);
+            }
         }
         else
         {
-            this->removeUpdateFromHash(pElement->entry);
+            this->removeUpdate(pEntry);
         }
     }
 }
@@ -543,44 +718,39 @@ void CCScheduler::unscheduleAll(void)
 void CCScheduler::unscheduleAllWithMinPriority(int nMinPriority)
 {
     // Custom Selectors
-    tHashTimerEntry *pElement = NULL;
-    tHashTimerEntry *pNextElement = NULL;
-    for (pElement = m_pHashForTimers; pElement != NULL;)
+    std::vector<CCObject*> targets;
+    for (unsigned int i = 0; i < m_timerTargets.size(); ++i)
     {
-        // pElement may be removed in unscheduleAllSelectorsForTarget
-        pNextElement = (tHashTimerEntry *)pElement->hh.next;
-        unscheduleAllForTarget(pElement->target);
-
-        pElement = pNextElement;
+        if (m_timerTargets[i])
+        {
+            targets.push_back(m_timerTargets[i]->target);
+        }
+    }
+    for (unsigned int i = 0; i < targets.size(); ++i)
+    {
+        unscheduleAllForTarget(targets[i]);
     }
 
     // Updates selectors
-    tListEntry *pEntry, *pTmp;
-    if(nMinPriority < 0) 
+    targets.clear();
+    for (unsigned int i = 0; i < m_updateBuckets.size(); ++i)
     {
-        DL_FOREACH_SAFE(m_pUpdatesNegList, pEntry, pTmp)
+        tUpdateBucket *pBucket = m_updateBuckets[i];
+        if (pBucket->priority < nMinPriority)
         {
-            if(pEntry->priority >= nMinPriority) 
-            {
-                unscheduleUpdateForTarget(pEntry->target);
-            }
+            continue;
         }
-    }
-
-    if(nMinPriority <= 0) 
-    {
-        DL_FOREACH_SAFE(m_pUpdates0List, pEntry, pTmp)
+        for (unsigned int j = 0; j < pBucket->slots.size(); ++j)
         {
-            unscheduleUpdateForTarget(pEntry->target);
+            if (pBucket->slots[j].target)
+            {
+                targets.push_back(pBucket->slots[j].target);
+            }
         }
     }
-
-    DL_FOREACH_SAFE(m_pUpdatesPosList, pEntry, pTmp)
+    for (unsigned int i = 0; i < targets.size(); ++i)
     {
-        if(pEntry->priority >= nMinPriority) 
-        {
-            unscheduleUpdateForTarget(pEntry->target);
-        }
+        unscheduleUpdateForTarget(targets[i]);
     }
 
     if (m_pScriptHandlerEntries)
@@ -598,26 +768,29 @@ void CCScheduler::unscheduleAllForTarget(CCObject *pTarget)
     }
 
     // Custom Selectors
-    tHashTimerEntry *pElement = NULL;
-    HASH_FIND_INT(m_pHashForTimers, &pTarget, pElement);
-
-    if (pElement)
+    tTargetEntry *pEntry = m_pTargets->find(pTarget);
+    if (pEntry && pEntry->hasTimers)
     {
-        if (ccArrayContainsObject(pElement->timers, pElement->currentTimer)
-            && (! pElement->currentTimerSalvaged))
+        if (pEntry->currentTimer && (! pEntry->currentTimerSalvaged)
+            && std::find(pEntry->timers.begin(), pEntry->timers.end(), pEntry->currentTimer) != pEntry->timers.end())
         {
-            pElement->currentTimer->retain();
-            pElement->currentTimerSalvaged = true;
+            pEntry->currentTimer->retain();
+            pEntry->currentTimerSalvaged = true;
         }
-        ccArrayRemoveAllObjects(pElement->timers);
 
-        if (m_pCurrentTarget == pElement)
+        for (unsigned int i = 0; i < pEntry->timers.size(); ++i)
+        {
+            pEntry->timers[i]->release();
+        }
+        pEntry->timers.clear();
+
+        if (m_pCurrentTarget == pEntry)
         {
             m_bCurrentTargetSalvaged = true;
         }
         else
         {
-            removeHashElement(pElement);
+            removeTimersOfEntry(pEntry);
         }
     }
 
@@ -650,25 +823,27 @@ void CCScheduler::unscheduleScriptEntry(unsigned int uScheduleScriptEntryID)
     }
 }
 
+
 void CCScheduler::resumeTarget(CCObject *pTarget)
 {
     CCAssert(pTarget != NULL, "");
 
+    tTargetEntry *pEntry = m_pTargets->find(pTarget);
+    if (! pEntry)
+    {
+        return;
+    }
+
     // custom selectors
-    tHashTimerEntry *pElement = NULL;
-    HASH_FIND_INT(m_pHashForTimers, &pTarget, pElement);
-    if (pElement)
+    if (pEntry->hasTimers)
     {
-        pElement->paused = false;
+        pEntry->timersPaused = false;
     }
 
     // update selector
-    tHashUpdateEntry *pElementUpdate = NULL;
-    HASH_FIND_INT(m_pHashForUpdates, &pTarget, pElementUpdate);
-    if (pElementUpdate)
+    if (pEntry->updateBucket)
     {
-        CCAssert(pElementUpdate->entry != NULL, "");
-        pElementUpdate->entry->paused = false;
+        pEntry->updateBucket->slots[pEntry->updateSlot].paused = false;
     }
 }
 
@@ -676,21 +851,22 @@ void CCScheduler::pauseTarget(CCObject *pTarget)
 {
     CCAssert(pTarget != NULL, "");
 
+    tTargetEntry *pEntry = m_pTargets->find(pTarget);
+    if (! pEntry)
+    {
+        return;
+    }
+
     // custom selectors
-    tHashTimerEntry *pElement = NULL;
-    HASH_FIND_INT(m_pHashForTimers, &pTarget, pElement);
-    if (pElement)
+    if (pEntry->hasTimers)
     {
-        pElement->paused = true;
+        pEntry->timersPaused = true;
     }
 
     // update selector
-    tHashUpdateEntry *pElementUpdate = NULL;
-    HASH_FIND_INT(m_pHashForUpdates, &pTarget, pElementUpdate);
-    if (pElementUpdate)
+    if (pEntry->updateBucket)
     {
-        CCAssert(pElementUpdate->entry != NULL, "");
-        pElementUpdate->entry->paused = true;
+        pEntry->updateBucket->slots[pEntry->updateSlot].paused = true;
     }
 }
 
@@ -698,22 +874,24 @@ bool CCScheduler::isTargetPaused(CCObject *pTarget)
 {
     CCAssert( pTarget != NULL, "target must be non nil" );
 
+    tTargetEntry *pEntry = m_pTargets->find(pTarget);
+    if (! pEntry)
+    {
+        return false;  // should never get here
+    }
+
     // Custom selectors
-    tHashTimerEntry *pElement = NULL;
-    HASH_FIND_INT(m_pHashForTimers, &pTarget, pElement);
-    if( pElement )
+    if (pEntry->hasTimers)
     {
-        return pElement->paused;
+        return pEntry->timersPaused;
     }
-    
+
     // We should check update selectors if target does not have custom selectors
-	tHashUpdateEntry *elementUpdate = NULL;
-	HASH_FIND_INT(m_pHashForUpdates, &pTarget, elementUpdate);
-	if ( elementUpdate )
+    if (pEntry->updateBucket)
     {
-		return elementUpdate->entry->paused;
+        return pEntry->updateBucket->slots[pEntry->updateSlot].paused;
     }
-    
+
     return false;  // should never get here
 }
 
@@ -728,42 +906,32 @@ CCSet* CCScheduler::pauseAllTargetsWithMinPriority(int nMinPriority)
     idsWithSelectors->autorelease();
 
     // Custom Selectors
-    for(tHashTimerEntry *element = m_pHashForTimers; element != NULL;
-        element = (tHashTimerEntry*)element->hh.next)
+    for (unsigned int i = 0; i < m_timerTargets.size(); ++i)
     {
-        element->paused = true;
-        idsWithSelectors->addObject(element->target);
-    }
-
-    // Updates selectors
-    tListEntry *entry, *tmp;
-    if(nMinPriority < 0) 
-    {
-        DL_FOREACH_SAFE( m_pUpdatesNegList, entry, tmp ) 
+        tTargetEntry *pEntry = m_timerTargets[i];
+        if (pEntry)
         {
-            if(entry->priority >= nMinPriority) 
-            {
-                entry->paused = true;
-                idsWithSelectors->addObject(entry->target);
-            }
+            pEntry->timersPaused = true;
+            idsWithSelectors->addObject(pEntry->target);
         }
     }
 
-    if(nMinPriority <= 0) 
+    // Updates selectors
+    for (unsigned int i = 0; i < m_updateBuckets.size(); ++i)
     {
-        DL_FOREACH_SAFE( m_pUpdates0List, entry, tmp )
+        tUpdateBucket *pBucket = m_updateBuckets[i];
+        if (pBucket->priority < nMinPriority)
         {
-            entry->paused = true;
-            idsWithSelectors->addObject(entry->target);
+            continue;
         }
-    }
-
-    DL_FOREACH_SAFE( m_pUpdatesPosList, entry, tmp ) 
-    {
-        if(entry->priority >= nMinPriority) 
+        for (unsigned int j = 0; j < pBucket->slots.size(); ++j)
         {
-            entry->paused = true;
-            idsWithSelectors->addObject(entry->target);
+            tUpdateSlot &slot = pBucket->slots[j];
+            if (slot.target)
+            {
+                slot.paused = true;
+                idsWithSelectors->addObject(slot.target);
+            }
         }
     }
 
@@ -789,48 +957,27 @@ void CCScheduler::update(float dt)
         dt *= m_fTimeScale;
     }
 
-    // Iterate over all the Updates' selectors
-    tListEntry *pEntry, *pTmp;
-
-    // updates with priority < 0
-    DL_FOREACH_SAFE(m_pUpdatesNegList, pEntry, pTmp)
-    {
-        if ((! pEntry->paused) && (! pEntry->markedForDeletion))
-        {
-            pEntry->target->update(dt);
-        }
-    }
-
-    // updates with priority == 0
-    DL_FOREACH_SAFE(m_pUpdates0List, pEntry, pTmp)
-    {
-        if ((! pEntry->paused) && (! pEntry->markedForDeletion))
-        {
-            pEntry->target->update(dt);
-        }
-    }
+    // Iterate over all the Updates' selectors, in ascending order of priority
+    dispatchUpdates(dt);
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(m_pUpdatesPosList, pEntry, pTmp)
+    // Iterate over all the custom selectors, in the order their targets were scheduled
+    for (unsigned int uTarget = 0; uTarget < m_timerTargets.size(); ++uTarget)
     {
-        if ((! pEntry->paused) && (! pEntry->markedForDeletion))
+        tTargetEntry *elt = m_timerTargets[uTarget];
+        if (! elt)
         {
-            pEntry->target->update(dt);
+            continue;
         }
-    }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = m_pHashForTimers; elt != NULL; )
-    {
         m_pCurrentTarget = elt;
         m_bCurrentTargetSalvaged = false;
 
-        if (! m_pCurrentTarget->paused)
+        if (! m_pCurrentTarget->timersPaused)
         {
             // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
+            for (elt->timerIndex = 0; elt->timerIndex < elt->timers.size(); ++(elt->timerIndex))
             {
-                elt->currentTimer = (CCTimer*)(elt->timers->arr[elt->timerIndex]);
+                elt->currentTimer = elt->timers[elt->timerIndex];
                 elt->currentTimerSalvaged = false;
 
                 elt->currentTimer->update(dt);
@@ -847,14 +994,11 @@ void CCScheduler::update(float dt)
             }
         }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
         // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (m_bCurrentTargetSalvaged && m_pCurrentTarget->timers->num == 0)
+        m_pCurrentTarget = NULL;
+        if (m_bCurrentTargetSalvaged && elt->timers.empty())
         {
-            removeHashElement(m_pCurrentTarget);
+            removeTimersOfEntry(elt);
         }
     }
 
@@ -876,35 +1020,38 @@ void CCScheduler::update(float dt)
     }
 
     // delete all updates that are marked for deletion
-    // updates with priority < 0
-    DL_FOREACH_SAFE(m_pUpdatesNegList, pEntry, pTmp)
+    for (unsigned int i = 0; i < m_pendingUpdateRemovals.size(); ++i)
     {
-        if (pEntry->markedForDeletion)
+        tTargetEntry *pEntry = m_pendingUpdateRemovals[i];
+        if (pEntry->updateBucket && pEntry->updateBucket->slots[pEntry->updateSlot].markedForDeletion)
         {
-            this->removeUpdateFromHash(pEntry);
+            this->removeUpdate(pEntry);
         }
     }
+    m_pendingUpdateRemovals.clear();
 
-    // updates with priority == 0
-    DL_FOREACH_SAFE(m_pUpdates0List, pEntry, pTmp)
+    for (unsigned int i = 0; i < m_updateBuckets.size(); ++i)
     {
-        if (pEntry->markedForDeletion)
+        if (m_updateBuckets[i]->deadCount > 0)
         {
-            this->removeUpdateFromHash(pEntry);
+            compactBucket(m_updateBuckets[i]);
         }
     }
+    removeEmptyBuckets();
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(m_pUpdatesPosList, pEntry, pTmp)
+    if (m_uDeadTimerTargets > 0)
     {
-        if (pEntry->markedForDeletion)
-        {
-            this->removeUpdateFromHash(pEntry);
-        }
+        compactTimerTargets();
     }
 
     m_bUpdateHashLocked = false;
 
+    for (unsigned int i = 0; i < m_deadEntries.size(); ++i)
+    {
+        delete m_deadEntries[i];
+    }
+    m_deadEntries.clear();
+
     m_pCurrentTarget = NULL;
 }
 
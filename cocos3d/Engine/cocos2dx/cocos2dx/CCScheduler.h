@@ -28,7 +28,7 @@ THE SOFTWARE.
 #define __CCSCHEDULER_H__
 
 #include "cocoa/CCObject.h"
-#include "support/data_support/uthash.h"
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -118,9 +118,9 @@ protected:
 //
 // CCScheduler
 //
-struct _listEntry;
-struct _hashSelectorEntry;
-struct _hashUpdateEntry;
+struct _updateBucket;
+struct _targetEntry;
+class CCSchedulerTargetMap;
 
 class CCArray;
 
@@ -283,13 +283,21 @@ public:
     void resumeTargets(CCSet* targetsToResume);
 
 private:
-    void removeHashElement(struct _hashSelectorEntry *pElement);
-    void removeUpdateFromHash(struct _listEntry *entry);
+    struct _targetEntry* createEntry(CCObject *pTarget);
+    void releaseEntryIfUnused(struct _targetEntry *pEntry);
 
     // update specific
 
-    void priorityIn(struct _listEntry **ppList, CCObject *pTarget, int nPriority, bool bPaused);
-    void appendIn(struct _listEntry **ppList, CCObject *pTarget, bool bPaused);
+    struct _updateBucket* bucketForPriority(int nPriority);
+    void removeUpdate(struct _targetEntry *pEntry);
+    void compactBucket(struct _updateBucket *pBucket);
+    void removeEmptyBuckets();
+    void dispatchUpdates(float dt);
+
+    // selector specific
+
+    void removeTimersOfEntry(struct _targetEntry *pEntry);
+    void compactTimerTargets();
 
 protected:
     float m_fTimeScale;
@@ -297,15 +305,16 @@ protected:
     //
     // "updates with priority" stuff
     //
-    struct _listEntry *m_pUpdatesNegList;        // list of priority < 0
-    struct _listEntry *m_pUpdates0List;            // list priority == 0
-    struct _listEntry *m_pUpdatesPosList;        // list priority > 0
-    struct _hashUpdateEntry *m_pHashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
+    std::vector<struct _updateBucket*> m_updateBuckets;     // dense arrays of update selectors, one per priority, in ascending order of priority
+    std::vector<struct _targetEntry*> m_pendingUpdateRemovals; // update selectors unscheduled during a tick
+    CCSchedulerTargetMap *m_pTargets;   // open-addressing map used to fetch quickly the entries of each target for pause,delete,etc
 
     // Used for "selectors with interval"
-    struct _hashSelectorEntry *m_pHashForTimers;
-    struct _hashSelectorEntry *m_pCurrentTarget;
+    std::vector<struct _targetEntry*> m_timerTargets;  // targets with custom selectors, in the order they were scheduled. NULL once removed during a tick
+    unsigned int m_uDeadTimerTargets;
+    struct _targetEntry *m_pCurrentTarget;
     bool m_bCurrentTargetSalvaged;
+    std::vector<struct _targetEntry*> m_deadEntries;   // entries removed during a tick, deleted once it is over
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool m_bUpdateHashLocked;
     CCArray* m_pScriptHandlerEntries;
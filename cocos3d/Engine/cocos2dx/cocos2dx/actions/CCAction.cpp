@@ -41,6 +41,7 @@ CCAction::CCAction()
 ,m_pTarget(NULL)
 ,m_nTag(kCCActionTagInvalid)
 ,m_pUserData(NULL)
+,m_nTweenSlot(-1)
 {
 }
 
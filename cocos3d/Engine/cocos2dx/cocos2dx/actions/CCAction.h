@@ -112,6 +112,11 @@ public:
 	inline void setUserData( void* userData ) { m_pUserData = userData; }
 	inline void* getUserData() { return m_pUserData; }
 
+    /** Whether the action is currently advanced by the CCTweenEngine of its action manager, instead of its step method.
+     @since v2.2
+     */
+    inline bool isDrivenByTweenEngine(void) { return m_nTweenSlot >= 0; }
+
 public:
     /** Create an action */
     static CCAction* create();
@@ -127,6 +132,11 @@ protected:
     int     m_nTag;
 
 	void*	m_pUserData;
+
+    /** Pool and slot of the action in a CCTweenEngine, or -1 */
+    int     m_nTweenSlot;
+
+    friend class CCTweenEngine;
 };
 
 /** 
@@ -32,6 +32,8 @@ THE SOFTWARE.
 
 #include "CCActionEase.h"
 #include "cocoa/CCZone.h"
+#include "CCTweenEngine.h"
+#include <typeinfo>
 
 NS_CC_BEGIN
 
@@ -126,6 +128,35 @@ CCActionInterval* CCActionEase::reverse(void)
     return CCActionEase::create(m_pInner->reverse());
 }
 
+bool CCActionEase::describeTween(ccTweenDescription *pDesc)
+{
+    // subclasses ease differently
+    if (typeid(*this) != typeid(CCActionEase))
+    {
+        return false;
+    }
+
+    return describeInnerTween(pDesc, kCCTweenEasingLinear, 1.0f);
+}
+
+void CCActionEase::restoreTween(const ccTweenDescription *pDesc)
+{
+    m_pInner->restoreTween(pDesc);
+}
+
+bool CCActionEase::describeInnerTween(ccTweenDescription *pDesc, int nEasing, float fRate)
+{
+    // the inner action must not be eased itself
+    if (! m_pInner->describeTween(pDesc) || pDesc->easing != kCCTweenEasingLinear)
+    {
+        return false;
+    }
+
+    pDesc->easing = (ccTweenEasing)nEasing;
+    pDesc->rate = fRate;
+    return true;
+}
+
 CCActionInterval* CCActionEase::getInnerAction()
 {
     return m_pInner;
@@ -242,6 +273,16 @@ void CCEaseIn::update(float time)
     m_pInner->update(powf(time, m_fRate));
 }
 
+bool CCEaseIn::describeTween(ccTweenDescription *pDesc)
+{
+    if (typeid(*this) != typeid(CCEaseIn))
+    {
+        return false;
+    }
+
+    return describeInnerTween(pDesc, kCCTweenEasingIn, m_fRate);
+}
+
 CCActionInterval* CCEaseIn::reverse(void)
 {
     return CCEaseIn::create(m_pInner->reverse(), 1 / m_fRate);
@@ -294,6 +335,16 @@ void CCEaseOut::update(float time)
     m_pInner->update(powf(time, 1 / m_fRate));
 }
 
+bool CCEaseOut::describeTween(ccTweenDescription *pDesc)
+{
+    if (typeid(*this) != typeid(CCEaseOut))
+    {
+        return false;
+    }
+
+    return describeInnerTween(pDesc, kCCTweenEasingOut, m_fRate);
+}
+
 CCActionInterval* CCEaseOut::reverse()
 {
     return CCEaseOut::create(m_pInner->reverse(), 1 / m_fRate);
@@ -354,6 +405,16 @@ void CCEaseInOut::update(float time)
     }
 }
 
+bool CCEaseInOut::describeTween(ccTweenDescription *pDesc)
+{
+    if (typeid(*this) != typeid(CCEaseInOut))
+    {
+        return false;
+    }
+
+    return describeInnerTween(pDesc, kCCTweenEasingInOut, m_fRate);
+}
+
 // InOut and OutIn are symmetrical
 CCActionInterval* CCEaseInOut::reverse(void)
 {
@@ -63,12 +63,18 @@ public:
     virtual void update(float time);
     virtual CCActionInterval* reverse(void);
     virtual CCActionInterval* getInnerAction();
+    virtual bool describeTween(struct _ccTweenDescription *pDesc);
+    virtual void restoreTween(const struct _ccTweenDescription *pDesc);
 
 public:
 
     /** creates the action */
     static CCActionEase* create(CCActionInterval *pAction);
 
+protected:
+    /** describes the tween of the inner action, eased by the given curve */
+    bool describeInnerTween(struct _ccTweenDescription *pDesc, int nEasing, float fRate);
+
 protected:
     /** The inner action */
     CCActionInterval *m_pInner;
@@ -118,6 +124,7 @@ class CC_DLL CCEaseIn : public CCEaseRateAction
 {
 public:
     virtual void update(float time);
+    virtual bool describeTween(struct _ccTweenDescription *pDesc);
     virtual CCActionInterval* reverse(void);
     /**
      *  @js NA
@@ -138,6 +145,7 @@ class CC_DLL CCEaseOut : public CCEaseRateAction
 {
 public:
     virtual void update(float time);
+    virtual bool describeTween(struct _ccTweenDescription *pDesc);
     virtual CCActionInterval* reverse();
     /**
      *  @js NA
@@ -159,6 +167,7 @@ class CC_DLL CCEaseInOut : public CCEaseRateAction
 {
 public:
     virtual void update(float time);
+    virtual bool describeTween(struct _ccTweenDescription *pDesc);
     /**
      *  @js NA
      *  @lua NA
@@ -31,7 +31,9 @@ THE SOFTWARE.
 #include "CCStdC.h"
 #include "CCActionInstant.h"
 #include "cocoa/CCZone.h"
+#include "CCTweenEngine.h"
 #include <stdarg.h>
+#include <typeinfo>
 
 NS_CC_BEGIN
 
@@ -180,6 +182,17 @@ void CCActionInterval::startWithTarget(CCNode *pTarget)
     m_bFirstTick = true;
 }
 
+bool CCActionInterval::describeTween(ccTweenDescription *pDesc)
+{
+    CC_UNUSED_PARAM(pDesc);
+    return false;
+}
+
+void CCActionInterval::restoreTween(const ccTweenDescription *pDesc)
+{
+    CC_UNUSED_PARAM(pDesc);
+}
+
 CCActionInterval* CCActionInterval::reverse(void)
 {
     CCAssert(false, "CCIntervalAction: reverse not implemented.");
@@ -1077,6 +1090,35 @@ void CCMoveBy::update(float t)
     }
 }
 
+bool CCMoveBy::describeTween(ccTweenDescription *pDesc)
+{
+    // subclasses may update differently
+    if (typeid(*this) != typeid(CCMoveBy) && typeid(*this) != typeid(CCMoveTo))
+    {
+        return false;
+    }
+
+    pDesc->property = kCCTweenPropertyPosition;
+    pDesc->easing = kCCTweenEasingLinear;
+    pDesc->rate = 1.0f;
+    pDesc->tweenAction = this;
+    pDesc->node = m_pTarget;
+    pDesc->rgba = NULL;
+    pDesc->start[0] = m_startPosition.x;
+    pDesc->start[1] = m_startPosition.y;
+    pDesc->delta[0] = m_positionDelta.x;
+    pDesc->delta[1] = m_positionDelta.y;
+    pDesc->previous[0] = m_previousPosition.x;
+    pDesc->previous[1] = m_previousPosition.y;
+    return m_pTarget != NULL;
+}
+
+void CCMoveBy::restoreTween(const ccTweenDescription *pDesc)
+{
+    m_startPosition = ccp(pDesc->start[0], pDesc->start[1]);
+    m_previousPosition = ccp(pDesc->previous[0], pDesc->previous[1]);
+}
+
 //
 // MoveTo
 //
@@ -1691,6 +1733,28 @@ void CCScaleTo::update(float time)
     }
 }
 
+bool CCScaleTo::describeTween(ccTweenDescription *pDesc)
+{
+    // subclasses may update differently
+    if (typeid(*this) != typeid(CCScaleTo) && typeid(*this) != typeid(CCScaleBy))
+    {
+        return false;
+    }
+
+    pDesc->property = kCCTweenPropertyScale;
+    pDesc->easing = kCCTweenEasingLinear;
+    pDesc->rate = 1.0f;
+    pDesc->tweenAction = this;
+    pDesc->node = m_pTarget;
+    pDesc->rgba = NULL;
+    pDesc->start[0] = m_fStartScaleX;
+    pDesc->start[1] = m_fStartScaleY;
+    pDesc->delta[0] = m_fDeltaX;
+    pDesc->delta[1] = m_fDeltaY;
+    pDesc->previous[0] = pDesc->previous[1] = 0.0f;
+    return m_pTarget != NULL;
+}
+
 //
 // ScaleBy
 //
@@ -1996,6 +2060,27 @@ void CCFadeTo::update(float time)
     /*m_pTarget->setOpacity((GLubyte)(m_fromOpacity + (m_toOpacity - m_fromOpacity) * time));*/
 }
 
+bool CCFadeTo::describeTween(ccTweenDescription *pDesc)
+{
+    // subclasses may update differently
+    if (typeid(*this) != typeid(CCFadeTo))
+    {
+        return false;
+    }
+
+    pDesc->property = kCCTweenPropertyOpacity;
+    pDesc->easing = kCCTweenEasingLinear;
+    pDesc->rate = 1.0f;
+    pDesc->tweenAction = this;
+    pDesc->node = m_pTarget;
+    pDesc->rgba = dynamic_cast<CCRGBAProtocol*>(m_pTarget);
+    pDesc->start[0] = m_fromOpacity;
+    pDesc->delta[0] = (float)(m_toOpacity - m_fromOpacity);
+    pDesc->start[1] = pDesc->delta[1] = 0.0f;
+    pDesc->previous[0] = pDesc->previous[1] = 0.0f;
+    return pDesc->rgba != NULL;
+}
+
 //
 // TintTo
 //
@@ -36,6 +36,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+struct _ccTweenDescription;
+
 /**
  * @addtogroup actions
  * @{
@@ -79,6 +81,17 @@ public:
     /** returns a reversed action */
     virtual CCActionInterval* reverse(void);
 
+    /** Describes the tween of the action, so a CCTweenEngine can advance it in its place.
+     Returns false if the action can not be driven by a CCTweenEngine.
+     @since v2.2
+     */
+    virtual bool describeTween(struct _ccTweenDescription *pDesc);
+
+    /** Takes back the state of the tween when a CCTweenEngine stops driving the action.
+     @since v2.2
+     */
+    virtual void restoreTween(const struct _ccTweenDescription *pDesc);
+
 public:
 
     /** creates the action */
@@ -92,6 +105,8 @@ public:
 protected:
     float m_elapsed;
     bool   m_bFirstTick;
+
+    friend class CCTweenEngine;
 };
 
 /** @brief Runs actions sequentially, one after another
@@ -404,6 +419,8 @@ public:
     virtual void startWithTarget(CCNode *pTarget);
     virtual CCActionInterval* reverse(void);
     virtual void update(float time);
+    virtual bool describeTween(struct _ccTweenDescription *pDesc);
+    virtual void restoreTween(const struct _ccTweenDescription *pDesc);
 
 public:
     /** creates the action */
@@ -633,6 +650,7 @@ public:
     virtual CCObject* copyWithZone(CCZone* pZone);
     virtual void startWithTarget(CCNode *pTarget);
     virtual void update(float time);
+    virtual bool describeTween(struct _ccTweenDescription *pDesc);
 
 public:
 
@@ -756,6 +774,7 @@ public:
     virtual CCObject* copyWithZone(CCZone* pZone);
     virtual void startWithTarget(CCNode *pTarget);
     virtual void update(float time);
+    virtual bool describeTween(struct _ccTweenDescription *pDesc);
 
 public:
     /** creates an action with duration and opacity */
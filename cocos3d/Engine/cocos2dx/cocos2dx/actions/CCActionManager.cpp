@@ -26,6 +26,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "CCActionManager.h"
+#include "CCTweenEngine.h"
 #include "base_nodes/CCNode.h"
 #include "CCScheduler.h"
 #include "ccMacros.h"
@@ -40,7 +41,9 @@ NS_CC_BEGIN
 CCActionManager::CCActionManager(void)
 : m_pTargets(NULL), 
   m_pCurrentTarget(NULL),
-  m_bCurrentTargetSalvaged(false)
+  m_bCurrentTargetSalvaged(false),
+  m_pTweenEngine(NULL),
+  m_pPendingTweenActions(NULL)
 {
 
 }
@@ -50,6 +53,9 @@ CCActionManager::~CCActionManager(void)
     CCLOGINFO("cocos2d: deallocing %p", this);
 
     removeAllActions();
+
+    CC_SAFE_DELETE(m_pTweenEngine);
+    CC_SAFE_RELEASE(m_pPendingTweenActions);
 }
 
 // private
@@ -86,6 +92,11 @@ void CCActionManager::removeActionAtIndex(unsigned int uIndex, tHashElement *pEl
         pElement->currentActionSalvaged = true;
     }
 
+    if (m_pTweenEngine)
+    {
+        m_pTweenEngine->removeAction(pAction);
+    }
+
     ccArrayRemoveObjectAtIndex(pElement->actions, uIndex, true);
 
     // update actionIndex in case we are in tick. looping over the actions
@@ -116,6 +127,7 @@ void CCActionManager::pauseTarget(CCObject *pTarget)
     if (pElement)
     {
         pElement->paused = true;
+        setElementPaused(pElement, true);
     }
 }
 
@@ -126,6 +138,7 @@ void CCActionManager::resumeTarget(CCObject *pTarget)
     if (pElement)
     {
         pElement->paused = false;
+        setElementPaused(pElement, false);
     }
 }
 
@@ -139,6 +152,7 @@ CCSet* CCActionManager::pauseAllRunningActions()
         if (! element->paused) 
         {
             element->paused = true;
+            setElementPaused(element, true);
             idsWithActions->addObject(element->target);
         }
     }    
@@ -181,6 +195,12 @@ void CCActionManager::addAction(CCAction *pAction, CCNode *pTarget, bool paused)
      ccArrayAppendObject(pElement->actions, pAction);
  
      pAction->startWithTarget(pTarget);
+
+    // routed to the tween engine, with the other actions of the target, on the next update
+    if (m_pTweenEngine)
+    {
+        m_pPendingTweenActions->addObject(pAction);
+    }
 }
 
 // remove
@@ -213,6 +233,14 @@ void CCActionManager::removeAllActionsFromTarget(CCObject *pTarget)
             pElement->currentActionSalvaged = true;
         }
 
+        if (m_pTweenEngine)
+        {
+            for (unsigned int i = 0; i < pElement->actions->num; ++i)
+            {
+                m_pTweenEngine->removeAction((CCAction*)pElement->actions->arr[i]);
+            }
+        }
+
         ccArrayRemoveAllObjects(pElement->actions);
         if (m_pCurrentTarget == pElement)
         {
@@ -324,9 +352,116 @@ unsigned int CCActionManager::numberOfRunningActionsInTarget(CCObject *pTarget)
     return 0;
 }
 
+// tween engine
+
+void CCActionManager::setTweenEngineEnabled(bool bEnabled)
+{
+    if (bEnabled == (m_pTweenEngine != NULL))
+    {
+        return;
+    }
+
+    if (bEnabled)
+    {
+        m_pTweenEngine = new CCTweenEngine();
+        m_pPendingTweenActions = CCArray::create();
+        m_pPendingTweenActions->retain();
+
+        // the running actions are routed on the next update
+        for (tHashElement *pElement = m_pTargets; pElement != NULL; pElement = (tHashElement*)pElement->hh.next)
+        {
+            for (unsigned int i = 0; i < pElement->actions->num; ++i)
+            {
+                m_pPendingTweenActions->addObject((CCAction*)pElement->actions->arr[i]);
+            }
+        }
+    }
+    else
+    {
+        for (tHashElement *pElement = m_pTargets; pElement != NULL; pElement = (tHashElement*)pElement->hh.next)
+        {
+            for (unsigned int i = 0; i < pElement->actions->num; ++i)
+            {
+                m_pTweenEngine->removeAction((CCAction*)pElement->actions->arr[i]);
+            }
+        }
+
+        CC_SAFE_DELETE(m_pTweenEngine);
+        CC_SAFE_RELEASE_NULL(m_pPendingTweenActions);
+    }
+}
+
+void CCActionManager::setElementPaused(tHashElement *pElement, bool bPaused)
+{
+    if (m_pTweenEngine && pElement->actions)
+    {
+        for (unsigned int i = 0; i < pElement->actions->num; ++i)
+        {
+            m_pTweenEngine->setActionPaused((CCAction*)pElement->actions->arr[i], bPaused);
+        }
+    }
+}
+
+void CCActionManager::routeActionsOfElement(tHashElement *pElement)
+{
+    // the engine writes its values before the other actions are stepped, so a target is only routed
+    // when all its actions can be, and no two of them animate the same property
+    unsigned int uProperties = 0;
+    bool bRoutable = true;
+    for (unsigned int i = 0; i < pElement->actions->num; ++i)
+    {
+        ccTweenProperty eProperty = CCTweenEngine::propertyOfAction((CCAction*)pElement->actions->arr[i]);
+        if (eProperty == kCCTweenPropertyCount || (uProperties & (1 << eProperty)))
+        {
+            bRoutable = false;
+            break;
+        }
+        uProperties |= 1 << eProperty;
+    }
+
+    for (unsigned int i = 0; i < pElement->actions->num; ++i)
+    {
+        CCAction *pAction = (CCAction*)pElement->actions->arr[i];
+        if (! bRoutable)
+        {
+            m_pTweenEngine->removeAction(pAction);
+        }
+        else if (! pAction->isDrivenByTweenEngine())
+        {
+            m_pTweenEngine->addAction(pAction, pElement->paused);
+        }
+    }
+}
+
+void CCActionManager::routePendingActions(void)
+{
+    CCObject *pObject = NULL;
+    CCARRAY_FOREACH(m_pPendingTweenActions, pObject)
+    {
+        CCAction *pAction = (CCAction*)pObject;
+        CCObject *pTarget = pAction->getOriginalTarget();
+        tHashElement *pElement = NULL;
+        HASH_FIND_INT(m_pTargets, &pTarget, pElement);
+
+        // the action may have been removed since it was added
+        if (pElement && ccArrayContainsObject(pElement->actions, pAction))
+        {
+            routeActionsOfElement(pElement);
+        }
+    }
+    m_pPendingTweenActions->removeAllObjects();
+}
+
 // main loop
 void CCActionManager::update(float dt)
 {
+    // advance the routed actions in bulk, before the other actions are stepped
+    if (m_pTweenEngine)
+    {
+        routePendingActions();
+        m_pTweenEngine->update(dt);
+    }
+
     for (tHashElement *elt = m_pTargets; elt != NULL; )
     {
         m_pCurrentTarget = elt;
@@ -346,7 +481,10 @@ void CCActionManager::update(float dt)
 
                 m_pCurrentTarget->currentActionSalvaged = false;
 
-                m_pCurrentTarget->currentAction->step(dt);
+                if (! m_pCurrentTarget->currentAction->isDrivenByTweenEngine())
+                {
+                    m_pCurrentTarget->currentAction->step(dt);
+                }
 
                 if (m_pCurrentTarget->currentActionSalvaged)
                 {
@@ -36,6 +36,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class CCSet;
+class CCTweenEngine;
 
 typedef struct _hashElement
 {
@@ -130,6 +131,20 @@ public:
      */
     void resumeTargets(CCSet *targetsToResume);
 
+    /** Enables or disables the bulk advance of the common interval actions by a CCTweenEngine.
+     When enabled, the CCMoveTo, CCMoveBy, CCScaleTo, CCScaleBy and CCFadeTo actions (optionally wrapped in
+     a CCEaseIn, CCEaseOut or CCEaseInOut) of a target are routed to the engine from the next update on,
+     provided that all the actions of the target can be routed and animate different properties.
+     Disabled by default.
+     @since v2.2
+     */
+    void setTweenEngineEnabled(bool bEnabled);
+
+    /** Returns whether the common interval actions are advanced in bulk by a CCTweenEngine.
+     @since v2.2
+     */
+    inline bool isTweenEngineEnabled(void) { return m_pTweenEngine != NULL; }
+
 protected:
     // declared in CCActionManager.m
 
@@ -138,10 +153,18 @@ protected:
     void actionAllocWithHashElement(struct _hashElement *pElement);
     void update(float dt);
 
+    // tween engine specific
+
+    void setElementPaused(struct _hashElement *pElement, bool bPaused);
+    void routeActionsOfElement(struct _hashElement *pElement);
+    void routePendingActions(void);
+
 protected:
     struct _hashElement    *m_pTargets;
     struct _hashElement    *m_pCurrentTarget;
     bool            m_bCurrentTargetSalvaged;
+    CCTweenEngine   *m_pTweenEngine;
+    CCArray         *m_pPendingTweenActions;    // actions added since the last update, to be routed to the tween engine
 };
 
 // end of actions group
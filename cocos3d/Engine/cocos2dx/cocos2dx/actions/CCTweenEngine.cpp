@@ -0,0 +1,365 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCTweenEngine.h"
+#include "CCActionInterval.h"
+#include "CCActionEase.h"
+#include "base_nodes/CCNode.h"
+#include "CCProtocols.h"
+#include "ccMacros.h"
+#include "ccConfig.h"
+#include "support/CCPointExtension.h"
+#include <float.h>
+#include <math.h>
+#include <vector>
+
+NS_CC_BEGIN
+
+#define kCCTweenSlotBits 24
+#define kCCTweenSlotMask ((1 << kCCTweenSlotBits) - 1)
+
+// The tweens of one property, as parallel arrays indexed by slot
+typedef struct _tweenPool
+{
+    std::vector<CCActionInterval*>  actions;        // action run by the action manager, NULL once removed during an update
+    std::vector<CCActionInterval*>  tweenActions;   // action holding the tween (the inner action of an ease)
+    std::vector<CCNode*>            nodes;
+    std::vector<CCRGBAProtocol*>    rgbas;
+    std::vector<float>              elapsed;
+    std::vector<float>              durations;
+    std::vector<unsigned char>      firstTicks;
+    std::vector<unsigned char>      paused;
+    std::vector<unsigned char>      easings;
+    std::vector<float>              rates;
+    std::vector<float>              progress;
+    std::vector<float>              startX;
+    std::vector<float>              startY;
+    std::vector<float>              deltaX;
+    std::vector<float>              deltaY;
+    std::vector<float>              previousX;
+    std::vector<float>              previousY;
+    std::vector<float>              valueX;
+    std::vector<float>              valueY;
+} tTweenPool;
+
+static inline float easeTween(float time, int nEasing, float fRate)
+{
+    // same arithmetic as CCEaseIn, CCEaseOut and CCEaseInOut
+    switch (nEasing)
+    {
+        case kCCTweenEasingIn:
+            return powf(time, fRate);
+        case kCCTweenEasingOut:
+            return powf(time, 1 / fRate);
+        case kCCTweenEasingInOut:
+            time *= 2;
+            if (time < 1)
+            {
+                return 0.5f * powf(time, fRate);
+            }
+            return 1.0f - 0.5f * powf(2-time, fRate);
+        default:
+            return time;
+    }
+}
+
+template <typename T>
+static inline void moveSlot(std::vector<T> &values, unsigned int uFrom, unsigned int uTo)
+{
+    values[uTo] = values[uFrom];
+    values.pop_back();
+}
+
+CCTweenEngine::CCTweenEngine(void)
+: m_bUpdating(false)
+, m_bHasRemovedSlots(false)
+{
+    for (int i = 0; i < kCCTweenPropertyCount; ++i)
+    {
+        m_pPools[i] = new tTweenPool();
+    }
+}
+
+CCTweenEngine::~CCTweenEngine(void)
+{
+    for (int i = 0; i < kCCTweenPropertyCount; ++i)
+    {
+        tTweenPool *pPool = m_pPools[i];
+        for (unsigned int j = 0; j < pPool->actions.size(); ++j)
+        {
+            if (pPool->actions[j])
+            {
+                pPool->actions[j]->m_nTweenSlot = -1;
+            }
+        }
+        delete pPool;
+    }
+}
+
+ccTweenProperty CCTweenEngine::propertyOfAction(CCAction *pAction)
+{
+    CCActionInterval *pInterval = dynamic_cast<CCActionInterval*>(pAction);
+    ccTweenDescription desc;
+    if (pInterval && pInterval->describeTween(&desc))
+    {
+        return desc.property;
+    }
+    return kCCTweenPropertyCount;
+}
+
+bool CCTweenEngine::addAction(CCAction *pAction, bool bPaused)
+{
+    CCAssert(! pAction->isDrivenByTweenEngine(), "action is already driven by a tween engine");
+
+    CCActionInterval *pInterval = dynamic_cast<CCActionInterval*>(pAction);
+    ccTweenDescription desc;
+    if (! pInterval || ! pInterval->describeTween(&desc))
+    {
+        return false;
+    }
+
+    tTweenPool *pPool = m_pPools[desc.property];
+    unsigned int uSlot = pPool->actions.size();
+    CCAssert(uSlot <= kCCTweenSlotMask, "too many tweens");
+
+    pPool->actions.push_back(pInterval);
+    pPool->tweenActions.push_back(desc.tweenAction);
+    pPool->nodes.push_back(desc.node);
+    pPool->rgbas.push_back(desc.rgba);
+    pPool->elapsed.push_back(pInterval->m_elapsed);
+    pPool->durations.push_back(pInterval->getDuration());
+    pPool->firstTicks.push_back(pInterval->m_bFirstTick ? 1 : 0);
+    pPool->paused.push_back(bPaused ? 1 : 0);
+    pPool->easings.push_back((unsigned char)desc.easing);
+    pPool->rates.push_back(desc.rate);
+    pPool->progress.push_back(0.0f);
+    pPool->startX.push_back(desc.start[0]);
+    pPool->startY.push_back(desc.start[1]);
+    pPool->deltaX.push_back(desc.delta[0]);
+    pPool->deltaY.push_back(desc.delta[1]);
+    pPool->previousX.push_back(desc.previous[0]);
+    pPool->previousY.push_back(desc.previous[1]);
+    pPool->valueX.push_back(0.0f);
+    pPool->valueY.push_back(0.0f);
+
+    pAction->m_nTweenSlot = (desc.property << kCCTweenSlotBits) | uSlot;
+    return true;
+}
+
+void CCTweenEngine::removeAction(CCAction *pAction)
+{
+    if (! pAction->isDrivenByTweenEngine())
+    {
+        return;
+    }
+
+    tTweenPool *pPool = m_pPools[pAction->m_nTweenSlot >> kCCTweenSlotBits];
+    unsigned int uSlot = pAction->m_nTweenSlot & kCCTweenSlotMask;
+    pAction->m_nTweenSlot = -1;
+
+    // hand the state the tween changed back to its action
+    ccTweenDescription desc;
+    desc.start[0] = pPool->startX[uSlot];
+    desc.start[1] = pPool->startY[uSlot];
+    desc.previous[0] = pPool->previousX[uSlot];
+    desc.previous[1] = pPool->previousY[uSlot];
+    pPool->tweenActions[uSlot]->restoreTween(&desc);
+
+    // a node may stop its actions while its values are being written
+    if (m_bUpdating)
+    {
+        pPool->actions[uSlot] = NULL;
+        m_bHasRemovedSlots = true;
+    }
+    else
+    {
+        removeSlot(pPool, uSlot);
+    }
+}
+
+void CCTweenEngine::removeSlot(tTweenPool *pPool, unsigned int uSlot)
+{
+    // fill the slot with the last one
+    unsigned int uLast = pPool->actions.size() - 1;
+    if (uLast != uSlot && pPool->actions[uLast])
+    {
+        pPool->actions[uLast]->m_nTweenSlot = (pPool->actions[uLast]->m_nTweenSlot & ~kCCTweenSlotMask) | uSlot;
+    }
+
+    moveSlot(pPool->actions, uLast, uSlot);
+    moveSlot(pPool->tweenActions, uLast, uSlot);
+    moveSlot(pPool->nodes, uLast, uSlot);
+    moveSlot(pPool->rgbas, uLast, uSlot);
+    moveSlot(pPool->elapsed, uLast, uSlot);
+    moveSlot(pPool->durations, uLast, uSlot);
+    moveSlot(pPool->firstTicks, uLast, uSlot);
+    moveSlot(pPool->paused, uLast, uSlot);
+    moveSlot(pPool->easings, uLast, uSlot);
+    moveSlot(pPool->rates, uLast, uSlot);
+    moveSlot(pPool->progress, uLast, uSlot);
+    moveSlot(pPool->startX, uLast, uSlot);
+    moveSlot(pPool->startY, uLast, uSlot);
+    moveSlot(pPool->deltaX, uLast, uSlot);
+    moveSlot(pPool->deltaY, uLast, uSlot);
+    moveSlot(pPool->previousX, uLast, uSlot);
+    moveSlot(pPool->previousY, uLast, uSlot);
+    moveSlot(pPool->valueX, uLast, uSlot);
+    moveSlot(pPool->valueY, uLast, uSlot);
+}
+
+void CCTweenEngine::setActionPaused(CCAction *pAction, bool bPaused)
+{
+    if (pAction->isDrivenByTweenEngine())
+    {
+        m_pPools[pAction->m_nTweenSlot >> kCCTweenSlotBits]->paused[pAction->m_nTweenSlot & kCCTweenSlotMask] = bPaused ? 1 : 0;
+    }
+}
+
+unsigned int CCTweenEngine::getTweenCount(void)
+{
+    unsigned int uCount = 0;
+    for (int i = 0; i < kCCTweenPropertyCount; ++i)
+    {
+        uCount += m_pPools[i]->actions.size();
+    }
+    return uCount;
+}
+
+void CCTweenEngine::update(float dt)
+{
+    m_bUpdating = true;
+
+    for (int nProperty = 0; nProperty < kCCTweenPropertyCount; ++nProperty)
+    {
+        tTweenPool *pPool = m_pPools[nProperty];
+        unsigned int uCount = pPool->actions.size();
+        if (uCount == 0)
+        {
+            continue;
+        }
+
+        float *elapsed = &pPool->elapsed[0];
+        const float *durations = &pPool->durations[0];
+        unsigned char *firstTicks = &pPool->firstTicks[0];
+        const unsigned char *paused = &pPool->paused[0];
+        float *progress = &pPool->progress[0];
+
+        // advance the time, as CCActionInterval::step
+        for (unsigned int i = 0; i < uCount; ++i)
+        {
+            float fElapsed = firstTicks[i] ? 0.0f : elapsed[i] + dt;
+            elapsed[i] = paused[i] ? elapsed[i] : fElapsed;
+            firstTicks[i] = paused[i] ? firstTicks[i] : 0;
+            progress[i] = MAX (0, MIN(1, elapsed[i] / MAX(durations[i], FLT_EPSILON)));
+        }
+
+        for (unsigned int i = 0; i < uCount; ++i)
+        {
+            if (pPool->easings[i] != kCCTweenEasingLinear)
+            {
+                progress[i] = easeTween(progress[i], pPool->easings[i], pPool->rates[i]);
+            }
+        }
+
+        float *startX = &pPool->startX[0];
+        float *startY = &pPool->startY[0];
+        const float *deltaX = &pPool->deltaX[0];
+        const float *deltaY = &pPool->deltaY[0];
+        float *valueX = &pPool->valueX[0];
+        float *valueY = &pPool->valueY[0];
+
+#if CC_ENABLE_STACKABLE_ACTIONS
+        // position tweens add up with the other changes of the position, as CCMoveBy::update
+        if (nProperty == kCCTweenPropertyPosition)
+        {
+            for (unsigned int i = 0; i < uCount; ++i)
+            {
+                if (pPool->actions[i] && ! paused[i])
+                {
+                    const CCPoint &currentPos = pPool->nodes[i]->getPosition();
+                    startX[i] += currentPos.x - pPool->previousX[i];
+                    startY[i] += currentPos.y - pPool->previousY[i];
+                }
+            }
+        }
+#endif // CC_ENABLE_STACKABLE_ACTIONS
+
+        for (unsigned int i = 0; i < uCount; ++i)
+        {
+            valueX[i] = startX[i] + deltaX[i] * progress[i];
+            valueY[i] = startY[i] + deltaY[i] * progress[i];
+        }
+
+        // write the values to the nodes, and the elapsed time to the actions
+        for (unsigned int i = 0; i < uCount; ++i)
+        {
+            CCActionInterval *pAction = pPool->actions[i];
+            if (! pAction || paused[i])
+            {
+                continue;
+            }
+
+            pAction->m_elapsed = elapsed[i];
+            pAction->m_bFirstTick = false;
+
+            switch (nProperty)
+            {
+                case kCCTweenPropertyPosition:
+                    pPool->nodes[i]->setPosition(ccp(valueX[i], valueY[i]));
+                    pPool->previousX[i] = valueX[i];
+                    pPool->previousY[i] = valueY[i];
+                    break;
+                case kCCTweenPropertyScale:
+                    pPool->nodes[i]->setScaleX(valueX[i]);
+                    pPool->nodes[i]->setScaleY(valueY[i]);
+                    break;
+                case kCCTweenPropertyOpacity:
+                    pPool->rgbas[i]->setOpacity((GLubyte)valueX[i]);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    m_bUpdating = false;
+
+    if (m_bHasRemovedSlots)
+    {
+        m_bHasRemovedSlots = false;
+        for (int nProperty = 0; nProperty < kCCTweenPropertyCount; ++nProperty)
+        {
+            tTweenPool *pPool = m_pPools[nProperty];
+            for (unsigned int i = pPool->actions.size(); i > 0; --i)
+            {
+                if (! pPool->actions[i - 1])
+                {
+                    removeSlot(pPool, i - 1);
+                }
+            }
+        }
+    }
+}
+
+NS_CC_END
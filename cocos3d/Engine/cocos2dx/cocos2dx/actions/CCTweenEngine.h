@@ -0,0 +1,145 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __ACTION_CCTWEEN_ENGINE_H__
+#define __ACTION_CCTWEEN_ENGINE_H__
+
+#include "platform/CCPlatformMacros.h"
+#include "ccTypes.h"
+
+NS_CC_BEGIN
+
+class CCNode;
+class CCAction;
+class CCActionInterval;
+class CCRGBAProtocol;
+
+/**
+ * @addtogroup actions
+ * @{
+ */
+
+/** Node properties driven by CCTweenEngine. Each property has its own pool of tweens. */
+typedef enum
+{
+    kCCTweenPropertyPosition,
+    kCCTweenPropertyScale,
+    kCCTweenPropertyOpacity,
+    kCCTweenPropertyCount
+} ccTweenProperty;
+
+/** Easing curves that CCTweenEngine applies to the progress of a tween */
+typedef enum
+{
+    kCCTweenEasingLinear,
+    kCCTweenEasingIn,       // as CCEaseIn
+    kCCTweenEasingOut,      // as CCEaseOut
+    kCCTweenEasingInOut,    // as CCEaseInOut
+} ccTweenEasing;
+
+/** The state of an interval action that CCTweenEngine can drive in its place.
+ Filled by CCActionInterval::describeTween, and handed back to CCActionInterval::restoreTween
+ when the engine stops driving the action.
+ */
+typedef struct _ccTweenDescription
+{
+    ccTweenProperty     property;
+    ccTweenEasing       easing;
+    float               rate;               // rate of the easing
+    CCActionInterval    *tweenAction;       // the action holding the values below (the inner action of an ease)
+    CCNode              *node;
+    CCRGBAProtocol      *rgba;              // the node, for opacity tweens
+    float               start[2];
+    float               delta[2];
+    float               previous[2];        // last value written, used by stackable position tweens
+} ccTweenDescription;
+
+struct _tweenPool;
+
+/**
+ @brief CCTweenEngine advances the common interval actions of a CCActionManager in bulk.
+
+ The tweens of CCMoveTo, CCMoveBy, CCScaleTo, CCScaleBy and CCFadeTo, optionally wrapped in a
+ CCEaseIn, CCEaseOut or CCEaseInOut, are kept in structure-of-arrays pools, one per property.
+ Every frame all the tweens of a pool are advanced in one pass over contiguous arrays, and the
+ results are then written to their nodes. Slots of finished tweens are filled with the last
+ slot of their pool, so no array is shifted.
+
+ The actions keep running in their CCActionManager, which routes them to the engine
+ when it is enabled. Their elapsed time is kept up to date, so they can still be queried,
+ stopped and removed as usual.
+
+ @since v2.2
+ */
+class CC_DLL CCTweenEngine
+{
+public:
+    /**
+     *  @js NA
+     *  @lua NA
+     */
+    CCTweenEngine(void);
+    /**
+     *  @js NA
+     *  @lua NA
+     */
+    ~CCTweenEngine(void);
+
+    /** Returns the property the action would drive in the engine, or kCCTweenPropertyCount
+     if the action can not be routed to the engine.
+     */
+    static ccTweenProperty propertyOfAction(CCAction *pAction);
+
+    /** Starts driving the action, which must have been started with its target.
+     Returns false if the action can not be routed to the engine.
+     */
+    bool addAction(CCAction *pAction, bool bPaused);
+
+    /** Stops driving the action, handing its current state back to it. */
+    void removeAction(CCAction *pAction);
+
+    /** Pauses or resumes an action driven by the engine. */
+    void setActionPaused(CCAction *pAction, bool bPaused);
+
+    /** Returns the number of actions driven by the engine. */
+    unsigned int getTweenCount(void);
+
+    /** Advances all the tweens, and writes their values to their nodes. */
+    void update(float dt);
+
+protected:
+    void removeSlot(struct _tweenPool *pPool, unsigned int uSlot);
+
+protected:
+    struct _tweenPool   *m_pPools[kCCTweenPropertyCount];
+    bool                m_bUpdating;        // slots are only marked while the pools are being updated
+    bool                m_bHasRemovedSlots;
+};
+
+// end of actions group
+/// @}
+
+NS_CC_END
+
+#endif // __ACTION_CCTWEEN_ENGINE_H__
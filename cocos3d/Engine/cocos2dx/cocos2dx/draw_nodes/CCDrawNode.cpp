@@ -102,6 +102,8 @@ CCDrawNode::CCDrawNode()
 , m_uBufferCapacity(0)
 , m_nBufferCount(0)
 , m_pBuffer(NULL)
+, m_nUploadedCount(0)
+, m_uVboCapacity(0)
 , m_bDirty(false)
 {
     m_sBlendFunc.src = CC_BLEND_SRC;
@@ -167,7 +169,8 @@ bool CCDrawNode::init()
     
     glGenBuffers(1, &m_uVbo);
     glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(ccV2F_C4B_T2F)* m_uBufferCapacity, m_pBuffer, GL_STREAM_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(ccV2F_C4B_T2F)* m_uBufferCapacity, m_pBuffer, GL_DYNAMIC_DRAW);
+    m_uVboCapacity = m_uBufferCapacity;
     
     glEnableVertexAttribArray(kCCVertexAttrib_Position);
     glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(ccV2F_C4B_T2F), (GLvoid *)offsetof(ccV2F_C4B_T2F, vertices));
@@ -201,12 +204,23 @@ bool CCDrawNode::init()
 
 void CCDrawNode::render()
 {
-    if (m_bDirty)
+    if (m_bDirty || m_uVboCapacity < m_uBufferCapacity)
     {
+        // The client buffer grew (it doubles), reallocate the VBO to match
         glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(ccV2F_C4B_T2F)*m_uBufferCapacity, m_pBuffer, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(ccV2F_C4B_T2F)*m_uBufferCapacity, m_pBuffer, GL_DYNAMIC_DRAW);
+        m_uVboCapacity = m_uBufferCapacity;
+        m_nUploadedCount = m_nBufferCount;
         m_bDirty = false;
     }
+    else if (m_nUploadedCount < m_nBufferCount)
+    {
+        // Geometry is only ever appended, upload just the new vertices
+        glBindBuffer(GL_ARRAY_BUFFER, m_uVbo);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(ccV2F_C4B_T2F)*m_nUploadedCount,
+                        sizeof(ccV2F_C4B_T2F)*(m_nBufferCount - m_nUploadedCount), m_pBuffer + m_nUploadedCount);
+        m_nUploadedCount = m_nBufferCount;
+    }
 #if CC_TEXTURE_ATLAS_USE_VAO     
     ccGLBindVAO(m_uVao);
 #else
@@ -254,8 +268,6 @@ void CCDrawNode::drawDot(const CCPoint &pos, float radius, const ccColor4F &colo
 	triangles[1] = triangle1;
 	
 	m_nBufferCount += vertex_count;
-	
-	m_bDirty = true;
 }
 
 void CCDrawNode::drawSegment(const CCPoint &from, const CCPoint &to, float radius, const ccColor4F &color)
@@ -327,8 +339,6 @@ void CCDrawNode::drawSegment(const CCPoint &from, const CCPoint &to, float radiu
 	triangles[5] = triangles5;
 	
 	m_nBufferCount += vertex_count;
-	
-	m_bDirty = true;
 }
 
 void CCDrawNode::drawPolygon(CCPoint *verts, unsigned int count, const ccColor4F &fillColor, float borderWidth, const ccColor4F &borderColor)
@@ -431,8 +441,6 @@ void CCDrawNode::drawPolygon(CCPoint *verts, unsigned int count, const ccColor4F
 	}
 	
 	m_nBufferCount += vertex_count;
-	
-	m_bDirty = true;
 
     free(extrude);
 }
@@ -440,7 +448,7 @@ void CCDrawNode::drawPolygon(CCPoint *verts, unsigned int count, const ccColor4F
 void CCDrawNode::clear()
 {
     m_nBufferCount = 0;
-    m_bDirty = true;
+    m_nUploadedCount = 0;
 }
 
 ccBlendFunc CCDrawNode::getBlendFunc() const
@@ -52,8 +52,13 @@ protected:
     GLsizei         m_nBufferCount;
     ccV2F_C4B_T2F   *m_pBuffer;
     
+    /** vertices of m_pBuffer already in the VBO, and the VBO size in vertices */
+    GLsizei         m_nUploadedCount;
+    unsigned int    m_uVboCapacity;
+    
     ccBlendFunc     m_sBlendFunc;
     
+    /** the whole VBO has to be uploaded again */
     bool            m_bDirty;
     
 public:
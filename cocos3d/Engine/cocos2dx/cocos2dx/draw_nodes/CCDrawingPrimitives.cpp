@@ -45,8 +45,10 @@ THE SOFTWARE.
 #include "shaders/CCGLProgram.h"
 #include "actions/CCActionCatmullRom.h"
 #include "support/CCPointExtension.h"
+#include "kazmath/GL/matrix.h"
 #include <string.h>
 #include <cmath>
+#include <vector>
 
 NS_CC_BEGIN
 #ifndef M_PI
@@ -106,6 +108,250 @@ static void lazy_init( void )
     }
 }
 
+//
+// Batching
+//
+// Between ccDrawBeginBatch() and ccDrawEndBatch() the primitives are not drawn right away.
+// Their vertices are transformed to clip space with the matrices current at the call and
+// appended to a few streams: one for solid triangles and one for lines, which carry the
+// color per vertex, plus one per color and point size for points. A flush draws each stream
+// with identity matrices, so a whole overlay costs a handful of draw calls.
+//
+
+typedef struct _ccDrawBatchVertex
+{
+    GLfloat     position[4];
+    ccColor4B   color;
+} ccDrawBatchVertex;
+
+typedef struct _ccDrawPointBatch
+{
+    ccColor4F                   color;
+    GLfloat                     pointSize;
+    std::vector<ccDrawBatchVertex> *vertices;
+} ccDrawPointBatch;
+
+static int s_nBatchDepth = 0;
+static kmMat4 s_tBatchMatrix;
+static std::vector<ccDrawBatchVertex> s_vBatchTriangles;
+static std::vector<ccDrawBatchVertex> s_vBatchLines;
+static std::vector<ccDrawPointBatch> s_vBatchPoints;
+
+static void batchUpdateMatrix()
+{
+    kmMat4 matrixP;
+    kmMat4 matrixMV;
+
+    kmGLGetMatrix(KM_GL_PROJECTION, &matrixP);
+    kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV);
+    kmMat4Multiply(&s_tBatchMatrix, &matrixP, &matrixMV);
+}
+
+static inline void batchAddVertex(std::vector<ccDrawBatchVertex> &stream, float x, float y, const ccColor4B &color)
+{
+    const float *m = s_tBatchMatrix.mat;
+    ccDrawBatchVertex v;
+    v.position[0] = m[0] * x + m[4] * y + m[12];
+    v.position[1] = m[1] * x + m[5] * y + m[13];
+    v.position[2] = m[2] * x + m[6] * y + m[14];
+    v.position[3] = m[3] * x + m[7] * y + m[15];
+    v.color = color;
+    stream.push_back(v);
+}
+
+// Line strips and loops become separate segments so every line shares one GL_LINES draw.
+template <class T>
+static void batchLineStrip(const T *points, unsigned int numberOfPoints, bool closePolygon)
+{
+    if (numberOfPoints < 2)
+    {
+        return;
+    }
+
+    batchUpdateMatrix();
+    ccColor4B color = ccc4BFromccc4F(s_tColor);
+    for (unsigned int i = 1; i < numberOfPoints; i++)
+    {
+        batchAddVertex(s_vBatchLines, points[i-1].x, points[i-1].y, color);
+        batchAddVertex(s_vBatchLines, points[i].x, points[i].y, color);
+    }
+    if (closePolygon && numberOfPoints > 2)
+    {
+        batchAddVertex(s_vBatchLines, points[numberOfPoints-1].x, points[numberOfPoints-1].y, color);
+        batchAddVertex(s_vBatchLines, points[0].x, points[0].y, color);
+    }
+}
+
+// Triangle fans become separate triangles so every solid shares one GL_TRIANGLES draw.
+static void batchTriangleFan(const CCPoint *points, unsigned int numberOfPoints, const ccColor4F &fillColor)
+{
+    if (numberOfPoints < 3)
+    {
+        return;
+    }
+
+    batchUpdateMatrix();
+    ccColor4B color = ccc4BFromccc4F(fillColor);
+    for (unsigned int i = 2; i < numberOfPoints; i++)
+    {
+        batchAddVertex(s_vBatchTriangles, points[0].x, points[0].y, color);
+        batchAddVertex(s_vBatchTriangles, points[i-1].x, points[i-1].y, color);
+        batchAddVertex(s_vBatchTriangles, points[i].x, points[i].y, color);
+    }
+}
+
+static void batchPoints(const CCPoint *points, unsigned int numberOfPoints)
+{
+    ccDrawPointBatch *batch = NULL;
+    for (unsigned int i = 0; i < s_vBatchPoints.size(); i++)
+    {
+        ccDrawPointBatch &candidate = s_vBatchPoints[i];
+        if (candidate.pointSize == s_fPointSize && 0 == memcmp(&candidate.color, &s_tColor, sizeof(ccColor4F)))
+        {
+            batch = &candidate;
+            break;
+        }
+    }
+    if (! batch)
+    {
+        ccDrawPointBatch newBatch;
+        newBatch.color = s_tColor;
+        newBatch.pointSize = s_fPointSize;
+        newBatch.vertices = new std::vector<ccDrawBatchVertex>();
+        s_vBatchPoints.push_back(newBatch);
+        batch = &s_vBatchPoints.back();
+    }
+
+    batchUpdateMatrix();
+    ccColor4B color = ccc4BFromccc4F(s_tColor);
+    for (unsigned int i = 0; i < numberOfPoints; i++)
+    {
+        batchAddVertex(*batch->vertices, points[i].x, points[i].y, color);
+    }
+}
+
+static void batchDrawStream(const std::vector<ccDrawBatchVertex> &stream, GLenum mode, bool useColorAttribute)
+{
+    if (stream.empty())
+    {
+        return;
+    }
+
+    const GLvoid *base = &stream[0];
+#ifdef EMSCRIPTEN
+    setGLBufferData((void*) base, stream.size() * sizeof(ccDrawBatchVertex));
+    base = 0;
+#endif // EMSCRIPTEN
+
+    glVertexAttribPointer(kCCVertexAttrib_Position, 4, GL_FLOAT, GL_FALSE, sizeof(ccDrawBatchVertex),
+                          (const GLvoid*)((const char*)base + offsetof(ccDrawBatchVertex, position)));
+    if (useColorAttribute)
+    {
+        glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ccDrawBatchVertex),
+                              (const GLvoid*)((const char*)base + offsetof(ccDrawBatchVertex, color)));
+    }
+    glDrawArrays(mode, 0, (GLsizei) stream.size());
+
+    CC_INCREMENT_GL_DRAWS(1);
+}
+
+void ccDrawFlush()
+{
+    bool hasPoints = false;
+    for (unsigned int i = 0; i < s_vBatchPoints.size() && ! hasPoints; i++)
+    {
+        hasPoints = ! s_vBatchPoints[i].vertices->empty();
+    }
+    if (s_vBatchTriangles.empty() && s_vBatchLines.empty() && ! hasPoints)
+    {
+        return;
+    }
+
+    lazy_init();
+
+    // The vertices are already in clip space
+    kmGLMatrixMode(KM_GL_PROJECTION);
+    kmGLPushMatrix();
+    kmGLLoadIdentity();
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+    kmGLPushMatrix();
+    kmGLLoadIdentity();
+
+    if (! s_vBatchTriangles.empty() || ! s_vBatchLines.empty())
+    {
+        CCGLProgram *pShader = CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionColor);
+        pShader->use();
+        pShader->setUniformsForBuiltins();
+        ccGLEnableVertexAttribs( kCCVertexAttribFlag_Position | kCCVertexAttribFlag_Color );
+
+        batchDrawStream(s_vBatchTriangles, GL_TRIANGLES, true);
+        batchDrawStream(s_vBatchLines, GL_LINES, true);
+    }
+
+    if (hasPoints)
+    {
+        s_pShader->use();
+        s_pShader->setUniformsForBuiltins();
+        ccGLEnableVertexAttribs( kCCVertexAttribFlag_Position );
+
+        for (unsigned int i = 0; i < s_vBatchPoints.size(); i++)
+        {
+            ccDrawPointBatch &batch = s_vBatchPoints[i];
+            if (batch.vertices->empty())
+            {
+                continue;
+            }
+            s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*) &batch.color.r, 1);
+            s_pShader->setUniformLocationWith1f(s_nPointSizeLocation, batch.pointSize);
+            batchDrawStream(*batch.vertices, GL_POINTS, false);
+        }
+    }
+
+    kmGLMatrixMode(KM_GL_PROJECTION);
+    kmGLPopMatrix();
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+    kmGLPopMatrix();
+
+    // Keep the storage for the next batch
+    s_vBatchTriangles.clear();
+    s_vBatchLines.clear();
+    for (unsigned int i = 0; i < s_vBatchPoints.size(); i++)
+    {
+        s_vBatchPoints[i].vertices->clear();
+    }
+}
+
+void ccDrawBeginBatch()
+{
+    s_nBatchDepth++;
+}
+
+void ccDrawEndBatch()
+{
+    CCAssert(s_nBatchDepth > 0, "ccDrawEndBatch called without ccDrawBeginBatch");
+    if (s_nBatchDepth > 0 && --s_nBatchDepth == 0)
+    {
+        ccDrawFlush();
+    }
+}
+
+int ccDrawSuspendBatch()
+{
+    int nDepth = s_nBatchDepth;
+    if (nDepth > 0)
+    {
+        ccDrawFlush();
+        s_nBatchDepth = 0;
+    }
+    return nDepth;
+}
+
+void ccDrawResumeBatch(int nDepth)
+{
+    CCAssert(s_nBatchDepth == 0, "ccDrawResumeBatch called inside a batch started after ccDrawSuspendBatch");
+    s_nBatchDepth = nDepth;
+}
+
 // When switching from backround to foreground on android, we want the params to be initialized again
 void ccDrawInit()
 {
@@ -116,10 +362,24 @@ void ccDrawFree()
 {
 	CC_SAFE_RELEASE_NULL(s_pShader);
 	s_bInitialized = false;
+
+    for (unsigned int i = 0; i < s_vBatchPoints.size(); i++)
+    {
+        delete s_vBatchPoints[i].vertices;
+    }
+    s_vBatchPoints.clear();
+    s_vBatchTriangles.clear();
+    s_vBatchLines.clear();
 }
 
 void ccDrawPoint( const CCPoint& point )
 {
+    if (s_nBatchDepth > 0)
+    {
+        batchPoints(&point, 1);
+        return;
+    }
+
     lazy_init();
 
     ccVertex2F p;
@@ -147,6 +407,12 @@ void ccDrawPoint( const CCPoint& point )
 
 void ccDrawPoints( const CCPoint *points, unsigned int numberOfPoints )
 {
+    if (s_nBatchDepth > 0)
+    {
+        batchPoints(points, numberOfPoints);
+        return;
+    }
+
     lazy_init();
 
     ccGLEnableVertexAttribs( kCCVertexAttribFlag_Position );
@@ -195,6 +461,13 @@ void ccDrawPoints( const CCPoint *points, unsigned int numberOfPoints )
 
 void ccDrawLine( const CCPoint& origin, const CCPoint& destination )
 {
+    if (s_nBatchDepth > 0)
+    {
+        CCPoint vertices[2] = { origin, destination };
+        batchLineStrip(vertices, 2, false);
+        return;
+    }
+
     lazy_init();
 
     ccVertex2F vertices[2] = {
@@ -220,10 +493,15 @@ void ccDrawLine( const CCPoint& origin, const CCPoint& destination )
 
 void ccDrawRect( CCPoint origin, CCPoint destination )
 {
-    ccDrawLine(CCPointMake(origin.x, origin.y), CCPointMake(destination.x, origin.y));
-    ccDrawLine(CCPointMake(destination.x, origin.y), CCPointMake(destination.x, destination.y));
-    ccDrawLine(CCPointMake(destination.x, destination.y), CCPointMake(origin.x, destination.y));
-    ccDrawLine(CCPointMake(origin.x, destination.y), CCPointMake(origin.x, origin.y));
+    // One line loop instead of four separate lines
+    CCPoint vertices[] = {
+        origin,
+        ccp(destination.x, origin.y),
+        destination,
+        ccp(origin.x, destination.y)
+    };
+
+    ccDrawPoly(vertices, 4, true);
 }
 
 void ccDrawSolidRect( CCPoint origin, CCPoint destination, ccColor4F color )
@@ -240,6 +518,12 @@ void ccDrawSolidRect( CCPoint origin, CCPoint destination, ccColor4F color )
 
 void ccDrawPoly( const CCPoint *poli, unsigned int numberOfPoints, bool closePolygon )
 {
+    if (s_nBatchDepth > 0)
+    {
+        batchLineStrip(poli, numberOfPoints, closePolygon);
+        return;
+    }
+
     lazy_init();
 
     s_pShader->use();
@@ -292,6 +576,12 @@ void ccDrawPoly( const CCPoint *poli, unsigned int numberOfPoints, bool closePol
 
 void ccDrawSolidPoly( const CCPoint *poli, unsigned int numberOfPoints, ccColor4F color )
 {
+    if (s_nBatchDepth > 0)
+    {
+        batchTriangleFan(poli, numberOfPoints, color);
+        return;
+    }
+
     lazy_init();
 
     s_pShader->use();
@@ -359,6 +649,13 @@ void ccDrawCircle( const CCPoint& center, float radius, float angle, unsigned in
     vertices[(segments+1)*2] = center.x;
     vertices[(segments+1)*2+1] = center.y;
 
+    if (s_nBatchDepth > 0)
+    {
+        batchLineStrip((ccVertex2F*) vertices, segments+additionalSegment, false);
+        free( vertices );
+        return;
+    }
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*) &s_tColor.r, 1);
@@ -399,6 +696,13 @@ void ccDrawQuadBezier(const CCPoint& origin, const CCPoint& control, const CCPoi
     vertices[segments].x = destination.x;
     vertices[segments].y = destination.y;
 
+    if (s_nBatchDepth > 0)
+    {
+        batchLineStrip(vertices, segments + 1, false);
+        CC_SAFE_DELETE_ARRAY(vertices);
+        return;
+    }
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*) &s_tColor.r, 1);
@@ -456,6 +760,13 @@ void ccDrawCardinalSpline( CCPointArray *config, float tension,  unsigned int se
         vertices[i].y = newPos.y;
     }
 
+    if (s_nBatchDepth > 0)
+    {
+        batchLineStrip(vertices, segments + 1, false);
+        CC_SAFE_DELETE_ARRAY(vertices);
+        return;
+    }
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*)&s_tColor.r, 1);
@@ -490,6 +801,13 @@ void ccDrawCubicBezier(const CCPoint& origin, const CCPoint& control1, const CCP
     vertices[segments].x = destination.x;
     vertices[segments].y = destination.y;
 
+    if (s_nBatchDepth > 0)
+    {
+        batchLineStrip(vertices, segments + 1, false);
+        CC_SAFE_DELETE_ARRAY(vertices);
+        return;
+    }
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*) &s_tColor.r, 1);
@@ -62,7 +62,7 @@ THE SOFTWARE.
  - ccPointSize()
  - glLineWidth()
  
- @warning These functions draws the Line, Point, Polygon, immediately. They aren't batched. If you are going to make a game that depends on these primitives, I suggest creating a batch. Instead you should use CCDrawNode
+ @warning These functions draws the Line, Point, Polygon, immediately, unless they are called between ccDrawBeginBatch() and ccDrawEndBatch(). If you are going to make a game that depends on these primitives, I suggest creating a batch. Instead you should use CCDrawNode
  
  */
 
@@ -81,6 +81,30 @@ void CC_DLL ccDrawInit();
 /** Frees allocated resources by the drawing primitives */
 void CC_DLL ccDrawFree();
 
+/** Starts collecting the drawing primitives instead of drawing each one immediately.
+ Vertices are transformed with the matrices current at each call, so nodes can keep drawing
+ in their own draw(). Everything collected is drawn by ccDrawEndBatch() in a few draw calls:
+ solid polygons first, then lines, then points.
+ Blending and glLineWidth() are the ones current at the flush; call ccDrawFlush() before changing
+ them or the render target. Calls can be nested, the outermost ccDrawEndBatch() draws.
+ */
+void CC_DLL ccDrawBeginBatch();
+
+/** Ends a batch started by ccDrawBeginBatch(), drawing everything collected if it is the outermost one. */
+void CC_DLL ccDrawEndBatch();
+
+/** Draws everything collected so far by the current batch. */
+void CC_DLL ccDrawFlush();
+
+/** Draws everything collected so far, then draws the primitives immediately until ccDrawResumeBatch().
+ Used around draws that rely on GL state set up only for them, such as stencil and scissor clipping.
+ Returns the batch depth to pass to ccDrawResumeBatch().
+ */
+int CC_DLL ccDrawSuspendBatch();
+
+/** Collects the primitives again in the batch suspended by ccDrawSuspendBatch(). */
+void CC_DLL ccDrawResumeBatch(int nDepth);
+
 /** draws a point given x and y coordinate measured in points */
 void CC_DLL ccDrawPoint( const CCPoint& point );
 
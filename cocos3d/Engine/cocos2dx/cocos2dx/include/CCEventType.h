@@ -16,4 +16,9 @@
 // This message is posted in cocos2dx/platform/android/jni/MessageJni.cpp.
 #define EVENT_COME_TO_BACKGROUND    "event_come_to_background"
 
+// The director is purging its cached data, such as on a memory warning.
+// This message is used by caches the director does not know of, to release their data too.
+// This message is posted in CCDirector::purgeCachedData().
+#define EVENT_PURGE_CACHED_DATA     "event_purge_cached_data"
+
 #endif // __CCEVENT_TYPE_H__
@@ -50,6 +50,7 @@ THE SOFTWARE.
 #include "actions/CCActionTiledGrid.h"
 #include "actions/CCActionInstant.h"
 #include "actions/CCActionTween.h"
+#include "actions/CCTweenEngine.h"
 #include "actions/CCActionCatmullRom.h"
 
 // base_nodes
@@ -99,6 +100,7 @@ THE SOFTWARE.
 #include "label_nodes/CCLabelAtlas.h"
 #include "label_nodes/CCLabelTTF.h"
 #include "label_nodes/CCLabelBMFont.h"
+#include "label_nodes/CCBMFontFormat.h"
 
 // layers_scenes_transitions_nodes
 #include "layers_scenes_transitions_nodes/CCLayer.h"
@@ -0,0 +1,463 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCBMFontFormat.h"
+#include <string.h>
+#include <algorithm>
+
+NS_CC_BEGIN
+
+//
+// Text tokenizer. Works on [begin, end) ranges of the loaded file; nothing is copied.
+//
+
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool tokenEquals(const char *pBegin, const char *pEnd, const char *pszLiteral, size_t uLength)
+{
+    return (size_t)(pEnd - pBegin) == uLength && memcmp(pBegin, pszLiteral, uLength) == 0;
+}
+
+#define TOKEN_IS(b, e, lit) tokenEquals((b), (e), lit, sizeof(lit) - 1)
+
+static int parseIntValue(const char *p, const char *pEnd, const char **ppNext = NULL)
+{
+    bool bNegative = false;
+    if (p < pEnd && (*p == '-' || *p == '+'))
+    {
+        bNegative = (*p == '-');
+        ++p;
+    }
+
+    int nValue = 0;
+    while (p < pEnd && *p >= '0' && *p <= '9')
+    {
+        nValue = nValue * 10 + (*p - '0');
+        ++p;
+    }
+
+    if (ppNext)
+    {
+        *ppNext = p;
+    }
+    return bNegative ? -nValue : nValue;
+}
+
+static float parseFloatValue(const char *p, const char *pEnd)
+{
+    bool bNegative = (p < pEnd && *p == '-');
+    float fValue = (float)parseIntValue(p, pEnd, &p);
+    if (bNegative)
+    {
+        fValue = -fValue;
+    }
+
+    if (p < pEnd && *p == '.')
+    {
+        float fScale = 0.1f;
+        for (++p; p < pEnd && *p >= '0' && *p <= '9'; ++p)
+        {
+            fValue += (*p - '0') * fScale;
+            fScale *= 0.1f;
+        }
+    }
+    return bNegative ? -fValue : fValue;
+}
+
+template <typename T, typename K>
+struct KeyLess
+{
+    K (*m_pKey)(const T&);
+    bool operator()(const T &a, const T &b) const { return m_pKey(a) < m_pKey(b); }
+};
+
+// Sorts by key and keeps the last of equal keys, matching the old hash tables where
+// a later definition shadowed an earlier one. Files are nearly always sorted already.
+template <typename T, typename K>
+static void sortAndCollapse(std::vector<T> &records, K (*key)(const T&))
+{
+    bool bSorted = true;
+    for (size_t i = 1; i < records.size() && bSorted; ++i)
+    {
+        bSorted = key(records[i - 1]) < key(records[i]);
+    }
+    if (bSorted)
+    {
+        return;
+    }
+
+    KeyLess<T, K> less = { key };
+    std::stable_sort(records.begin(), records.end(), less);
+
+    size_t uOut = 0;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (i + 1 < records.size() && key(records[i]) == key(records[i + 1]))
+        {
+            continue;
+        }
+        records[uOut++] = records[i];
+    }
+    records.resize(uOut);
+}
+
+static unsigned int glyphKey(const ccBMFontGlyph &glyph)
+{
+    return glyph.charID;
+}
+
+static unsigned int kerningKey(const ccBMFontKerning &kerning)
+{
+    return kerning.key;
+}
+
+bool ccBMFontParseText(const char *pData, unsigned long uSize, ccBMFontInfo *pInfo,
+                       std::vector<ccBMFontGlyph> &glyphs, std::vector<ccBMFontKerning> &kernings)
+{
+    if (! pData || ! pInfo)
+    {
+        return false;
+    }
+
+    pInfo->commonHeight = 0;
+    memset(pInfo->padding, 0, sizeof(pInfo->padding));
+    pInfo->scaleW = 0;
+    pInfo->scaleH = 0;
+    pInfo->pages = 1;
+    pInfo->atlasFile.clear();
+    pInfo->sourceSize = (unsigned int)uSize;
+    pInfo->sourceHash = ccBMFontHashSource(pData, uSize);
+
+    const char *pCursor = pData;
+    const char *pDataEnd = pData + uSize;
+
+    while (pCursor < pDataEnd)
+    {
+        const char *pLineEnd = (const char*)memchr(pCursor, '\n', pDataEnd - pCursor);
+        if (! pLineEnd)
+        {
+            pLineEnd = pDataEnd;
+        }
+
+        const char *p = pCursor;
+        pCursor = pLineEnd + 1;
+
+        while (p < pLineEnd && isBlank(*p)) ++p;
+        const char *pTag = p;
+        while (p < pLineEnd && ! isBlank(*p)) ++p;
+        const char *pTagEnd = p;
+
+        ccBMFontGlyph glyph;
+        memset(&glyph, 0, sizeof(glyph));
+        int nFirst = 0, nSecond = 0, nAmount = 0;
+
+        enum { kLineOther, kLineInfo, kLineCommon, kLinePage, kLineChars, kLineChar, kLineKernings, kLineKerning } eLine = kLineOther;
+        if (TOKEN_IS(pTag, pTagEnd, "char"))            eLine = kLineChar;
+        else if (TOKEN_IS(pTag, pTagEnd, "kerning"))    eLine = kLineKerning;
+        else if (TOKEN_IS(pTag, pTagEnd, "info"))       eLine = kLineInfo;
+        else if (TOKEN_IS(pTag, pTagEnd, "common"))     eLine = kLineCommon;
+        else if (TOKEN_IS(pTag, pTagEnd, "page"))       eLine = kLinePage;
+        else if (TOKEN_IS(pTag, pTagEnd, "chars"))      eLine = kLineChars;
+        else if (TOKEN_IS(pTag, pTagEnd, "kernings"))   eLine = kLineKernings;
+        else continue;
+
+        // key=value pairs. Values may be quoted, e.g. face="Arial Bold"
+        while (p < pLineEnd)
+        {
+            while (p < pLineEnd && isBlank(*p)) ++p;
+            const char *pKey = p;
+            while (p < pLineEnd && *p != '=' && ! isBlank(*p)) ++p;
+            const char *pKeyEnd = p;
+            if (p >= pLineEnd || *p != '=')
+            {
+                continue;
+            }
+
+            const char *pValue = ++p;
+            const char *pValueEnd;
+            if (p < pLineEnd && *p == '"')
+            {
+                pValue = ++p;
+                while (p < pLineEnd && *p != '"') ++p;
+                pValueEnd = p;
+                if (p < pLineEnd) ++p;
+            }
+            else
+            {
+                while (p < pLineEnd && ! isBlank(*p)) ++p;
+                pValueEnd = p;
+            }
+
+            switch (eLine)
+            {
+            case kLineChar:
+                if (TOKEN_IS(pKey, pKeyEnd, "id"))              glyph.charID = (unsigned int)parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "x"))          glyph.x = parseFloatValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "y"))          glyph.y = parseFloatValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "width"))      glyph.width = parseFloatValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "height"))     glyph.height = parseFloatValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "xoffset"))    glyph.xOffset = (short)parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "yoffset"))    glyph.yOffset = (short)parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "xadvance"))   glyph.xAdvance = (short)parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "page"))       glyph.page = (short)parseIntValue(pValue, pValueEnd);
+                break;
+            case kLineKerning:
+                if (TOKEN_IS(pKey, pKeyEnd, "first"))           nFirst = parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "second"))     nSecond = parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "amount"))     nAmount = parseIntValue(pValue, pValueEnd);
+                break;
+            case kLineInfo:
+                if (TOKEN_IS(pKey, pKeyEnd, "padding"))
+                {
+                    // padding=top,right,bottom,left
+                    int values[4] = { 0, 0, 0, 0 };
+                    const char *pNumber = pValue;
+                    for (int i = 0; i < 4 && pNumber < pValueEnd; ++i)
+                    {
+                        values[i] = parseIntValue(pNumber, pValueEnd, &pNumber);
+                        if (pNumber < pValueEnd && *pNumber == ',') ++pNumber;
+                    }
+                    pInfo->padding[0] = values[3];
+                    pInfo->padding[1] = values[0];
+                    pInfo->padding[2] = values[1];
+                    pInfo->padding[3] = values[2];
+                }
+                break;
+            case kLineCommon:
+                if (TOKEN_IS(pKey, pKeyEnd, "lineHeight"))      pInfo->commonHeight = parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "scaleW"))     pInfo->scaleW = parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "scaleH"))     pInfo->scaleH = parseIntValue(pValue, pValueEnd);
+                else if (TOKEN_IS(pKey, pKeyEnd, "pages"))      pInfo->pages = parseIntValue(pValue, pValueEnd);
+                break;
+            case kLinePage:
+                // only page 0 is supported
+                if (TOKEN_IS(pKey, pKeyEnd, "file"))            pInfo->atlasFile.assign(pValue, pValueEnd - pValue);
+                break;
+            case kLineChars:
+                if (TOKEN_IS(pKey, pKeyEnd, "count"))           glyphs.reserve(glyphs.size() + parseIntValue(pValue, pValueEnd));
+                break;
+            case kLineKernings:
+                if (TOKEN_IS(pKey, pKeyEnd, "count"))           kernings.reserve(kernings.size() + parseIntValue(pValue, pValueEnd));
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (eLine == kLineChar)
+        {
+            glyphs.push_back(glyph);
+        }
+        else if (eLine == kLineKerning)
+        {
+            ccBMFontKerning kerning;
+            kerning.key = ((unsigned int)nFirst << 16) | ((unsigned int)nSecond & 0xffff);
+            kerning.amount = nAmount;
+            kernings.push_back(kerning);
+        }
+    }
+
+    sortAndCollapse(glyphs, glyphKey);
+    sortAndCollapse(kernings, kerningKey);
+
+    return true;
+}
+
+//
+// Binary format
+//
+
+static inline unsigned int alignTo4(unsigned int uValue)
+{
+    return (uValue + 3) & ~3u;
+}
+
+static bool tableFits(unsigned int uOffset, unsigned int uCount, unsigned int uRecordSize, unsigned long uSize)
+{
+    if ((uOffset & 3) != 0 || uOffset > uSize)
+    {
+        return false;
+    }
+    return uCount <= (uSize - uOffset) / uRecordSize;
+}
+
+bool ccBMFontReadBinary(const unsigned char *pData, unsigned long uSize, ccBMFontInfo *pInfo,
+                        const ccBMFontGlyph **ppGlyphs, unsigned int *pGlyphCount,
+                        const ccBMFontKerning **ppKernings, unsigned int *pKerningCount)
+{
+    if (! pData || uSize < sizeof(ccBMFontBinaryHeader) || ((size_t)pData & 3) != 0)
+    {
+        return false;
+    }
+
+    ccBMFontBinaryHeader header;
+    memcpy(&header, pData, sizeof(header));
+
+    if (memcmp(header.magic, kCCBMFontBinaryMagic, sizeof(header.magic)) != 0
+        || header.version != kCCBMFontBinaryVersion
+        || header.byteOrder != kCCBMFontBinaryByteOrder
+        || header.glyphSize != sizeof(ccBMFontGlyph)
+        || header.kerningSize != sizeof(ccBMFontKerning)
+        || header.atlasFileOffset > uSize
+        || header.atlasFileLength > uSize - header.atlasFileOffset
+        || ! tableFits(header.glyphOffset, header.glyphCount, sizeof(ccBMFontGlyph), uSize)
+        || ! tableFits(header.kerningOffset, header.kerningCount, sizeof(ccBMFontKerning), uSize))
+    {
+        return false;
+    }
+
+    const ccBMFontGlyph *pGlyphs = (const ccBMFontGlyph*)(pData + header.glyphOffset);
+    const ccBMFontKerning *pKernings = (const ccBMFontKerning*)(pData + header.kerningOffset);
+
+    // lookups are binary searches, so an unsorted table would silently miss glyphs
+    for (unsigned int i = 1; i < header.glyphCount; ++i)
+    {
+        if (pGlyphs[i - 1].charID >= pGlyphs[i].charID) return false;
+    }
+    for (unsigned int i = 1; i < header.kerningCount; ++i)
+    {
+        if (pKernings[i - 1].key >= pKernings[i].key) return false;
+    }
+
+    pInfo->commonHeight = header.commonHeight;
+    pInfo->padding[0] = header.paddingLeft;
+    pInfo->padding[1] = header.paddingTop;
+    pInfo->padding[2] = header.paddingRight;
+    pInfo->padding[3] = header.paddingBottom;
+    pInfo->scaleW = header.scaleW;
+    pInfo->scaleH = header.scaleH;
+    pInfo->pages = header.pages;
+    pInfo->atlasFile.assign((const char*)pData + header.atlasFileOffset, header.atlasFileLength);
+    pInfo->sourceSize = header.sourceSize;
+    pInfo->sourceHash = header.sourceHash;
+
+    *ppGlyphs = pGlyphs;
+    *pGlyphCount = header.glyphCount;
+    *ppKernings = pKernings;
+    *pKerningCount = header.kerningCount;
+
+    return true;
+}
+
+void ccBMFontWriteBinary(const ccBMFontInfo *pInfo,
+                         const ccBMFontGlyph *pGlyphs, unsigned int uGlyphCount,
+                         const ccBMFontKerning *pKernings, unsigned int uKerningCount,
+                         std::vector<unsigned char> &out)
+{
+    ccBMFontBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kCCBMFontBinaryMagic, sizeof(header.magic));
+    header.version = kCCBMFontBinaryVersion;
+    header.byteOrder = kCCBMFontBinaryByteOrder;
+    header.glyphSize = sizeof(ccBMFontGlyph);
+    header.kerningSize = sizeof(ccBMFontKerning);
+    header.commonHeight = pInfo->commonHeight;
+    header.paddingLeft = pInfo->padding[0];
+    header.paddingTop = pInfo->padding[1];
+    header.paddingRight = pInfo->padding[2];
+    header.paddingBottom = pInfo->padding[3];
+    header.scaleW = pInfo->scaleW;
+    header.scaleH = pInfo->scaleH;
+    header.pages = pInfo->pages;
+
+    header.atlasFileOffset = sizeof(header);
+    header.atlasFileLength = (unsigned int)pInfo->atlasFile.size();
+    header.glyphOffset = alignTo4(header.atlasFileOffset + header.atlasFileLength);
+    header.glyphCount = uGlyphCount;
+    header.kerningOffset = header.glyphOffset + uGlyphCount * sizeof(ccBMFontGlyph);
+    header.kerningCount = uKerningCount;
+    header.sourceSize = pInfo->sourceSize;
+    header.sourceHash = pInfo->sourceHash;
+
+    out.assign(header.kerningOffset + uKerningCount * sizeof(ccBMFontKerning), 0);
+    memcpy(&out[0], &header, sizeof(header));
+    if (header.atlasFileLength > 0)
+    {
+        memcpy(&out[header.atlasFileOffset], pInfo->atlasFile.data(), header.atlasFileLength);
+    }
+    if (uGlyphCount > 0)
+    {
+        memcpy(&out[header.glyphOffset], pGlyphs, uGlyphCount * sizeof(ccBMFontGlyph));
+    }
+    if (uKerningCount > 0)
+    {
+        memcpy(&out[header.kerningOffset], pKernings, uKerningCount * sizeof(ccBMFontKerning));
+    }
+}
+
+unsigned int ccBMFontHashSource(const char *pData, unsigned long uSize)
+{
+    unsigned int uHash = 2166136261u;
+    for (unsigned long i = 0; i < uSize; ++i)
+    {
+        uHash = (uHash ^ (unsigned char)pData[i]) * 16777619u;
+    }
+    return uHash;
+}
+
+//
+// Lookups
+//
+
+const ccBMFontGlyph* ccBMFontFindGlyph(const ccBMFontGlyph *pGlyphs, unsigned int uCount, unsigned int charID)
+{
+    unsigned int uLow = 0, uHigh = uCount;
+    while (uLow < uHigh)
+    {
+        unsigned int uMid = (uLow + uHigh) >> 1;
+        if (pGlyphs[uMid].charID < charID)
+        {
+            uLow = uMid + 1;
+        }
+        else
+        {
+            uHigh = uMid;
+        }
+    }
+    return (uLow < uCount && pGlyphs[uLow].charID == charID) ? &pGlyphs[uLow] : NULL;
+}
+
+int ccBMFontFindKerning(const ccBMFontKerning *pKernings, unsigned int uCount, unsigned short first, unsigned short second)
+{
+    unsigned int key = ((unsigned int)first << 16) | second;
+    unsigned int uLow = 0, uHigh = uCount;
+    while (uLow < uHigh)
+    {
+        unsigned int uMid = (uLow + uHigh) >> 1;
+        if (pKernings[uMid].key < key)
+        {
+            uLow = uMid + 1;
+        }
+        else
+        {
+            uHigh = uMid;
+        }
+    }
+    return (uLow < uCount && pKernings[uLow].key == key) ? pKernings[uLow].amount : 0;
+}
+
+NS_CC_END
@@ -0,0 +1,175 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCBMFONT_FORMAT_H__
+#define __CCBMFONT_FORMAT_H__
+
+#include "platform/CCPlatformMacros.h"
+#include <string>
+#include <vector>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup GUI
+ * @{
+ * @addtogroup label
+ * @{
+ */
+
+/** Leading bytes of a precompiled ".fntb" font file. */
+#define kCCBMFontBinaryMagic        "FNTB"
+/** Layout revision of the ".fntb" records. Bump whenever a record changes. */
+#define kCCBMFontBinaryVersion      2
+/** Written by the producer so a reader can reject files of the other byte order. */
+#define kCCBMFontBinaryByteOrder    0x01020304
+
+/** @struct ccBMFontGlyph
+ Glyph record shared by the text parser and the ".fntb" format. The table is
+ kept sorted by charID so lookups are a binary search over contiguous memory.
+ @since v2.2
+ */
+typedef struct _BMFontGlyph {
+    //! ID of the character
+    unsigned int charID;
+    //! origin and size of the glyph in the atlas (in pixels)
+    float x, y, width, height;
+    //! The X amount the image should be offset when drawing the image (in pixels)
+    short xOffset;
+    //! The Y amount the image should be offset when drawing the image (in pixels)
+    short yOffset;
+    //! The amount to move the current position after drawing the character (in pixels)
+    short xAdvance;
+    //! atlas page of the glyph
+    short page;
+} ccBMFontGlyph;
+
+/** @struct ccBMFontKerning
+ Kerning record, sorted by key. The key packs the first character in the high
+ 16 bits and the second character in the low 16 bits.
+ @since v2.2
+ */
+typedef struct _BMFontKerning {
+    unsigned int key;
+    int amount;
+} ccBMFontKerning;
+
+/** @struct ccBMFontBinaryHeader
+ Header of a ".fntb" file. Glyph and kerning records follow at the given
+ offsets, 4-byte aligned, so a loaded file can be used without copying.
+ sourceSize and sourceHash identify the ".fnt" text the file was built from.
+ @since v2.2
+ */
+typedef struct _BMFontBinaryHeader {
+    char            magic[4];
+    unsigned int    version;
+    unsigned int    byteOrder;
+    unsigned int    glyphSize;
+    unsigned int    kerningSize;
+    int             commonHeight;
+    int             paddingLeft;
+    int             paddingTop;
+    int             paddingRight;
+    int             paddingBottom;
+    int             scaleW;
+    int             scaleH;
+    int             pages;
+    unsigned int    atlasFileOffset;
+    unsigned int    atlasFileLength;
+    unsigned int    glyphOffset;
+    unsigned int    glyphCount;
+    unsigned int    kerningOffset;
+    unsigned int    kerningCount;
+    unsigned int    sourceSize;
+    unsigned int    sourceHash;
+} ccBMFontBinaryHeader;
+
+/** @struct ccBMFontInfo
+ Font wide values of a BMFont description.
+ @since v2.2
+ */
+typedef struct _BMFontInfo {
+    //! line height. Should be signed (issue #1343)
+    int commonHeight;
+    //! padding, in the order left, top, right, bottom
+    int padding[4];
+    //! atlas size, used for sanity checks
+    int scaleW;
+    int scaleH;
+    //! number of atlas pages
+    int pages;
+    //! atlas file name, relative to the font file
+    std::string atlasFile;
+    //! size and ccBMFontHashSource() of the text description
+    unsigned int sourceSize;
+    unsigned int sourceHash;
+} ccBMFontInfo;
+
+/** Hashes a text description (32-bit FNV-1a). A ".fntb" file whose stored hash
+ differs from its ".fnt" sibling is stale and must not be used.
+ @since v2.2
+ */
+unsigned int CC_DLL ccBMFontHashSource(const char *pData, unsigned long uSize);
+
+/** Parses an AngelCode text description held in memory. The buffer is scanned
+ in place; no line or token is copied. On return glyphs and kernings are sorted
+ by key and duplicate keys are collapsed, the last definition winning.
+ @since v2.2
+ */
+bool CC_DLL ccBMFontParseText(const char *pData, unsigned long uSize, ccBMFontInfo *pInfo,
+                              std::vector<ccBMFontGlyph> &glyphs, std::vector<ccBMFontKerning> &kernings);
+
+/** Validates a ".fntb" image and returns pointers to its record tables. The
+ tables point into pData, which must stay alive and 4-byte aligned.
+ @since v2.2
+ */
+bool CC_DLL ccBMFontReadBinary(const unsigned char *pData, unsigned long uSize, ccBMFontInfo *pInfo,
+                               const ccBMFontGlyph **ppGlyphs, unsigned int *pGlyphCount,
+                               const ccBMFontKerning **ppKernings, unsigned int *pKerningCount);
+
+/** Serializes sorted tables into a ".fntb" image.
+ @since v2.2
+ */
+void CC_DLL ccBMFontWriteBinary(const ccBMFontInfo *pInfo,
+                                const ccBMFontGlyph *pGlyphs, unsigned int uGlyphCount,
+                                const ccBMFontKerning *pKernings, unsigned int uKerningCount,
+                                std::vector<unsigned char> &out);
+
+/** Binary search over a sorted glyph table. Returns NULL if charID is missing.
+ @since v2.2
+ */
+CC_DLL const ccBMFontGlyph* ccBMFontFindGlyph(const ccBMFontGlyph *pGlyphs, unsigned int uCount, unsigned int charID);
+
+/** Binary search over a sorted kerning table. Returns 0 if the pair is missing.
+ @since v2.2
+ */
+int CC_DLL ccBMFontFindKerning(const ccBMFontKerning *pKernings, unsigned int uCount, unsigned short first, unsigned short second);
+
+// end of label group
+/// @}
+/// @}
+
+NS_CC_END
+
+#endif //__CCBMFONT_FORMAT_H__
@@ -42,6 +42,7 @@ http://www.angelcode.com/products/bmfont/ (Free, Windows only)
 #include "CCDirector.h"
 #include "textures/CCTextureCache.h"
 #include "support/ccUTF8.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -59,6 +60,12 @@ static unsigned short* copyUTF16StringN(unsigned short* str)
     return ret;
 }
 
+// The letters are sorted by their index in the string.
+static bool isLetterBefore(const ccBMFontLetter& letter, unsigned int index)
+{
+    return letter.index < index;
+}
+
 //
 //FNTConfig Cache - free functions
 //
@@ -113,16 +120,19 @@ CCBMFontConfiguration * CCBMFontConfiguration::create(const char *FNTfile)
 
 bool CCBMFontConfiguration::initWithFNTfile(const char *FNTfile)
 {
-    m_pKerningDictionary = NULL;
-    m_pFontDefDictionary = NULL;
-    
-    m_pCharacterSet = this->parseConfigFile(FNTfile);
-    
-    if (! m_pCharacterSet)
+    this->purgeFontData();
+
+    if (! this->parseConfigFile(FNTfile))
     {
         return false;
     }
 
+    m_pCharacterSet = new set<unsigned int>();
+    for (unsigned int i = 0; i < m_uGlyphCount; ++i)
+    {
+        m_pCharacterSet->insert(m_pCharacterSet->end(), m_pGlyphs[i].charID);
+    }
+
     return true;
 }
 
@@ -132,21 +142,31 @@ std::set<unsigned int>* CCBMFontConfiguration::getCharacterSet() const
 }
 
 CCBMFontConfiguration::CCBMFontConfiguration()
-: m_pFontDefDictionary(NULL)
-, m_nCommonHeight(0)
-, m_pKerningDictionary(NULL)
+: m_nCommonHeight(0)
 , m_pCharacterSet(NULL)
+, m_pGlyphs(NULL)
+, m_uGlyphCount(0)
+, m_pKernings(NULL)
+, m_uKerningCount(0)
+, m_pBinaryData(NULL)
+, m_pFontDefDictionary(NULL)
+, m_pKerningDictionary(NULL)
 {
-
+    memset(&m_tPadding, 0, sizeof(m_tPadding));
+    m_tFontInfo.commonHeight = 0;
+    memset(m_tFontInfo.padding, 0, sizeof(m_tFontInfo.padding));
+    m_tFontInfo.scaleW = 0;
+    m_tFontInfo.scaleH = 0;
+    m_tFontInfo.pages = 1;
+    m_tFontInfo.sourceSize = 0;
+    m_tFontInfo.sourceHash = 0;
 }
 
 CCBMFontConfiguration::~CCBMFontConfiguration()
 {
     CCLOGINFO( "cocos2d: deallocing CCBMFontConfiguration" );
-    this->purgeFontDefDictionary();
-    this->purgeKerningDictionary();
+    this->purgeFontData();
     m_sAtlasName.clear();
-    CC_SAFE_DELETE(m_pCharacterSet);
 }
 
 const char* CCBMFontConfiguration::description(void)
@@ -154,12 +174,26 @@ const char* CCBMFontConfiguration::description(void)
     return CCString::createWithFormat(
         "<CCBMFontConfiguration = " CC_FORMAT_PRINTF_SIZE_T " | Glphys:%d Kernings:%d | Image = %s>",
         (size_t)this,
-        HASH_COUNT(m_pFontDefDictionary),
-        HASH_COUNT(m_pKerningDictionary),
+        m_uGlyphCount,
+        m_uKerningCount,
         m_sAtlasName.c_str()
     )->getCString();
 }
 
+void CCBMFontConfiguration::purgeFontData()
+{
+    this->purgeFontDefDictionary();
+    this->purgeKerningDictionary();
+    m_pGlyphs = NULL;
+    m_uGlyphCount = 0;
+    m_pKernings = NULL;
+    m_uKerningCount = 0;
+    m_glyphStorage.clear();
+    m_kerningStorage.clear();
+    CC_SAFE_DELETE_ARRAY(m_pBinaryData);
+    CC_SAFE_DELETE(m_pCharacterSet);
+}
+
 void CCBMFontConfiguration::purgeKerningDictionary()
 {
     tCCKerningHashElement *current;
@@ -181,235 +215,173 @@ void CCBMFontConfiguration::purgeFontDefDictionary()
     }
 }
 
-std::set<unsigned int>* CCBMFontConfiguration::parseConfigFile(const char *controlFile)
-{    
-    std::string fullpath = CCFileUtils::sharedFileUtils()->fullPathForFilename(controlFile);
-    CCString *contents = CCString::createWithContentsOfFile(fullpath.c_str());
-
-    CCAssert(contents, "CCBMFontConfiguration::parseConfigFile | Open file error.");
-    
-    set<unsigned int> *validCharsString = new set<unsigned int>();
-
-    if (!contents)
+tCCFontDefHashElement* CCBMFontConfiguration::getFontDefDictionary() const
+{
+    if (! m_pFontDefDictionary)
     {
-        CCLOG("cocos2d: Error parsing FNTfile %s", controlFile);
-        return NULL;
+        for (unsigned int i = 0; i < m_uGlyphCount; ++i)
+        {
+            const ccBMFontGlyph& glyph = m_pGlyphs[i];
+            tCCFontDefHashElement *element = (tCCFontDefHashElement*)malloc( sizeof(*element) );
+            if (! element)
+            {
+                break;
+            }
+            element->key = glyph.charID;
+            element->fontDef.charID = glyph.charID;
+            element->fontDef.rect = CCRectMake(glyph.x, glyph.y, glyph.width, glyph.height);
+            element->fontDef.xOffset = glyph.xOffset;
+            element->fontDef.yOffset = glyph.yOffset;
+            element->fontDef.xAdvance = glyph.xAdvance;
+            HASH_ADD_INT(m_pFontDefDictionary, key, element);
+        }
     }
+    return m_pFontDefDictionary;
+}
 
-    // parse spacing / padding
-    std::string line;
-    std::string strLeft = contents->getCString();
-    while (strLeft.length() > 0)
+tCCKerningHashElement* CCBMFontConfiguration::getKerningDictionary() const
+{
+    if (! m_pKerningDictionary)
     {
-        int pos = strLeft.find('\n');
-
-        if (pos != (int)std::string::npos)
+        for (unsigned int i = 0; i < m_uKerningCount; ++i)
         {
-            // the data is more than a line.get one line
-            line = strLeft.substr(0, pos);
-            strLeft = strLeft.substr(pos + 1);
-        }
-        else
-        {
-            // get the left data
-            line = strLeft;
-            strLeft.erase();
+            tCCKerningHashElement *element = (tCCKerningHashElement *)calloc( sizeof( *element ), 1 );
+            if (! element)
+            {
+                break;
+            }
+            element->key = (int)m_pKernings[i].key;
+            element->amount = m_pKernings[i].amount;
+            HASH_ADD_INT(m_pKerningDictionary, key, element);
         }
+    }
+    return m_pKerningDictionary;
+}
 
-        if(line.substr(0,strlen("info face")) == "info face") 
-        {
-            // XXX: info parsing is incomplete
-            // Not needed for the Hiero editors, but needed for the AngelCode editor
-            //            [self parseInfoArguments:line];
-            this->parseInfoArguments(line);
-        }
-        // Check to see if the start of the line is something we are interested in
-        else if(line.substr(0,strlen("common lineHeight")) == "common lineHeight")
-        {
-            this->parseCommonArguments(line);
-        }
-        else if(line.substr(0,strlen("page id")) == "page id")
-        {
-            this->parseImageFileName(line, controlFile);
-        }
-        else if(line.substr(0,strlen("chars c")) == "chars c")
-        {
-            // Ignore this line
-        }
-        else if(line.substr(0,strlen("char")) == "char")
-        {
-            // Parse the current line and create a new CharDef
-            tCCFontDefHashElement* element = (tCCFontDefHashElement*)malloc( sizeof(*element) );
-            this->parseCharacterDefinition(line, &element->fontDef);
+bool CCBMFontConfiguration::parseConfigFile(const char *controlFile)
+{
+    CCFileUtils *pFileUtils = CCFileUtils::sharedFileUtils();
+    std::string file = controlFile;
+    size_t uLength = file.length();
 
-            element->key = element->fontDef.charID;
-            HASH_ADD_INT(m_pFontDefDictionary, key, element);
-            
-            validCharsString->insert(element->fontDef.charID);
-        }
-//        else if(line.substr(0,strlen("kernings count")) == "kernings count")
-//        {
-//            this->parseKerningCapacity(line);
-//        }
-        else if(line.substr(0,strlen("kerning first")) == "kerning first")
-        {
-            this->parseKerningEntry(line);
-        }
+    if (uLength > 5 && file.compare(uLength - 5, 5, ".fntb") == 0)
+    {
+        return this->loadBinaryFile(pFileUtils->fullPathForFilename(controlFile), NULL, 0);
     }
-    
-    return validCharsString;
+
+    std::string fullpath = pFileUtils->fullPathForFilename(controlFile);
+    unsigned long uSize = 0;
+    unsigned char *pData = pFileUtils->getFileData(fullpath.c_str(), "rb", &uSize);
+
+    CCAssert(pData, "CCBMFontConfiguration::parseConfigFile | Open file error.");
+
+    if (! pData)
+    {
+        CCLOG("cocos2d: Error parsing FNTfile %s", fullpath.c_str());
+        return false;
+    }
+
+    // prefer a precompiled sibling, e.g. "font.fntb" next to "font.fnt", as long
+    // as it was built from this very text. Hashing is far cheaper than parsing.
+    bool bRet = false;
+    if (uLength > 4 && file.compare(uLength - 4, 4, ".fnt") == 0)
+    {
+        std::string binaryPath = pFileUtils->fullPathForFilename((file + "b").c_str());
+        bRet = pFileUtils->isFileExist(binaryPath) && this->loadBinaryFile(binaryPath, pData, uSize);
+    }
+
+    if (! bRet)
+    {
+        bRet = this->loadTextData(pData, uSize, fullpath);
+    }
+
+    CC_SAFE_DELETE_ARRAY(pData);
+    return bRet;
 }
 
-void CCBMFontConfiguration::parseImageFileName(std::string line, const char *fntFile)
+bool CCBMFontConfiguration::loadBinaryFile(const std::string& fullpath, const unsigned char *pSource, unsigned long uSourceSize)
 {
-    //////////////////////////////////////////////////////////////////////////
-    // line to parse:
-    // page id=0 file="bitmapFontTest.png"
-    //////////////////////////////////////////////////////////////////////////
+    unsigned long uSize = 0;
+    unsigned char *pData = CCFileUtils::sharedFileUtils()->getFileData(fullpath.c_str(), "rb", &uSize);
+    ccBMFontInfo info;
+
+    // the glyph and kerning records are used straight out of the file buffer
+    if (! pData || ! ccBMFontReadBinary(pData, uSize, &info, &m_pGlyphs, &m_uGlyphCount, &m_pKernings, &m_uKerningCount))
+    {
+        CCLOG("cocos2d: Error parsing FNTfile %s", fullpath.c_str());
+        CC_SAFE_DELETE_ARRAY(pData);
+        m_pGlyphs = NULL;
+        m_pKernings = NULL;
+        m_uGlyphCount = m_uKerningCount = 0;
+        return false;
+    }
 
-    // page ID. Sanity check
-    int index = line.find('=')+1;
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    CCAssert(atoi(value.c_str()) == 0, "LabelBMFont file could not be found");
-    // file 
-    index = line.find('"')+1;
-    index2 = line.find('"', index);
-    value = line.substr(index, index2-index);
+    if (pSource && (info.sourceSize != uSourceSize || info.sourceHash != ccBMFontHashSource((const char*)pSource, uSourceSize)))
+    {
+        CCLOG("cocos2d: %s is out of date, parsing the text font instead", fullpath.c_str());
+        CC_SAFE_DELETE_ARRAY(pData);
+        m_pGlyphs = NULL;
+        m_pKernings = NULL;
+        m_uGlyphCount = m_uKerningCount = 0;
+        return false;
+    }
 
-    m_sAtlasName = CCFileUtils::sharedFileUtils()->fullPathFromRelativeFile(value.c_str(), fntFile);
+    m_pBinaryData = pData;
+    this->applyFontInfo(info, fullpath.c_str());
+    return true;
 }
 
-void CCBMFontConfiguration::parseInfoArguments(std::string line)
+bool CCBMFontConfiguration::loadTextData(const unsigned char *pData, unsigned long uSize, const std::string& fullpath)
 {
-    //////////////////////////////////////////////////////////////////////////
-    // possible lines to parse:
-    // info face="Script" size=32 bold=0 italic=0 charset="" unicode=1 stretchH=100 smooth=1 aa=1 padding=1,4,3,2 spacing=0,0 outline=0
-    // info face="Cracked" size=36 bold=0 italic=0 charset="" unicode=0 stretchH=100 smooth=1 aa=1 padding=0,0,0,0 spacing=1,1
-    //////////////////////////////////////////////////////////////////////////
+    ccBMFontInfo info;
+    if (! ccBMFontParseText((const char*)pData, uSize, &info, m_glyphStorage, m_kerningStorage))
+    {
+        CCLOG("cocos2d: Error parsing FNTfile %s", fullpath.c_str());
+        return false;
+    }
 
-    // padding
-    int index = line.find("padding=");
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "padding=%d,%d,%d,%d", &m_tPadding.top, &m_tPadding.right, &m_tPadding.bottom, &m_tPadding.left);
+    m_pGlyphs = m_glyphStorage.empty() ? NULL : &m_glyphStorage[0];
+    m_uGlyphCount = (unsigned int)m_glyphStorage.size();
+    m_pKernings = m_kerningStorage.empty() ? NULL : &m_kerningStorage[0];
+    m_uKerningCount = (unsigned int)m_kerningStorage.size();
+
+    this->applyFontInfo(info, fullpath.c_str());
+    return true;
+}
+
+void CCBMFontConfiguration::applyFontInfo(const ccBMFontInfo& info, const char *fntFile)
+{
+    CCAssert(info.scaleW <= CCConfiguration::sharedConfiguration()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
+    CCAssert(info.scaleH <= CCConfiguration::sharedConfiguration()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
+    CCAssert(info.pages == 1, "CCBitfontAtlas: only supports 1 page");
+
+    m_nCommonHeight = info.commonHeight;
+    m_tPadding.left = info.padding[0];
+    m_tPadding.top = info.padding[1];
+    m_tPadding.right = info.padding[2];
+    m_tPadding.bottom = info.padding[3];
     CCLOG("cocos2d: padding: %d,%d,%d,%d", m_tPadding.left, m_tPadding.top, m_tPadding.right, m_tPadding.bottom);
+
+    m_tFontInfo = info;
+    m_sAtlasName = CCFileUtils::sharedFileUtils()->fullPathFromRelativeFile(info.atlasFile.c_str(), fntFile);
 }
 
-void CCBMFontConfiguration::parseCommonArguments(std::string line)
-{
-    //////////////////////////////////////////////////////////////////////////
-    // line to parse:
-    // common lineHeight=104 base=26 scaleW=1024 scaleH=512 pages=1 packed=0
-    //////////////////////////////////////////////////////////////////////////
-
-    // Height
-    int index = line.find("lineHeight=");
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "lineHeight=%d", &m_nCommonHeight);
-    // scaleW. sanity check
-    index = line.find("scaleW=") + strlen("scaleW=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    CCAssert(atoi(value.c_str()) <= CCConfiguration::sharedConfiguration()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
-    // scaleH. sanity check
-    index = line.find("scaleH=") + strlen("scaleH=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    CCAssert(atoi(value.c_str()) <= CCConfiguration::sharedConfiguration()->getMaxTextureSize(), "CCLabelBMFont: page can't be larger than supported");
-    // pages. sanity check
-    index = line.find("pages=") + strlen("pages=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    CCAssert(atoi(value.c_str()) == 1, "CCBitfontAtlas: only supports 1 page");
-
-    // packed (ignore) What does this mean ??
-}
-
-void CCBMFontConfiguration::parseCharacterDefinition(std::string line, ccBMFontDef *characterDefinition)
-{    
-    //////////////////////////////////////////////////////////////////////////
-    // line to parse:
-    // char id=32   x=0     y=0     width=0     height=0     xoffset=0     yoffset=44    xadvance=14     page=0  chnl=0 
-    //////////////////////////////////////////////////////////////////////////
-
-    // Character ID
-    int index = line.find("id=");
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "id=%u", &characterDefinition->charID);
-
-    // Character x
-    index = line.find("x=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "x=%f", &characterDefinition->rect.origin.x);
-    // Character y
-    index = line.find("y=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "y=%f", &characterDefinition->rect.origin.y);
-    // Character width
-    index = line.find("width=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "width=%f", &characterDefinition->rect.size.width);
-    // Character height
-    index = line.find("height=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "height=%f", &characterDefinition->rect.size.height);
-    // Character xoffset
-    index = line.find("xoffset=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "xoffset=%hd", &characterDefinition->xOffset);
-    // Character yoffset
-    index = line.find("yoffset=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "yoffset=%hd", &characterDefinition->yOffset);
-    // Character xadvance
-    index = line.find("xadvance=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "xadvance=%hd", &characterDefinition->xAdvance);
-}
-
-void CCBMFontConfiguration::parseKerningEntry(std::string line)
-{        
-    //////////////////////////////////////////////////////////////////////////
-    // line to parse:
-    // kerning first=121  second=44  amount=-7
-    //////////////////////////////////////////////////////////////////////////
-
-    // first
-    int first;
-    int index = line.find("first=");
-    int index2 = line.find(' ', index);
-    std::string value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "first=%d", &first);
-
-    // second
-    int second;
-    index = line.find("second=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "second=%d", &second);
-
-    // amount
-    int amount;
-    index = line.find("amount=");
-    index2 = line.find(' ', index);
-    value = line.substr(index, index2-index);
-    sscanf(value.c_str(), "amount=%d", &amount);
-
-    tCCKerningHashElement *element = (tCCKerningHashElement *)calloc( sizeof( *element ), 1 );
-    element->amount = amount;
-    element->key = (first<<16) | (second&0xffff);
-    HASH_ADD_INT(m_pKerningDictionary,key, element);
+bool CCBMFontConfiguration::writeBinaryFile(const char *pszPath) const
+{
+    std::vector<unsigned char> data;
+    ccBMFontWriteBinary(&m_tFontInfo, m_pGlyphs, m_uGlyphCount, m_pKernings, m_uKerningCount, data);
+
+    FILE *fp = fopen(pszPath, "wb");
+    if (! fp)
+    {
+        CCLOG("cocos2d: CCBMFontConfiguration could not write %s", pszPath);
+        return false;
+    }
+    bool bRet = fwrite(&data[0], 1, data.size(), fp) == data.size();
+    fclose(fp);
+    return bRet;
 }
+
 //
 //CCLabelBMFont
 //
@@ -538,6 +510,12 @@ CCLabelBMFont::CCLabelBMFont()
 , m_bLineBreakWithoutSpaces(false)
 , m_tImageOffset(CCPointZero)
 , m_pReusedChar(NULL)
+, m_bUsesGlyphQuads(false)
+, m_nNextFontPositionX(0)
+, m_nNextFontPositionY(0)
+, m_uPrevChar(-1)
+, m_nLongestLine(0)
+, m_uTotalHeight(0)
 , m_cDisplayedOpacity(255)
 , m_cRealOpacity(255)
 , m_tDisplayedColor(ccWHITE)
@@ -546,7 +524,10 @@ CCLabelBMFont::CCLabelBMFont()
 , m_bCascadeOpacityEnabled(true)
 , m_bIsOpacityModifyRGB(false)
 {
-
+    m_tLastFontDef.charID = 0;
+    m_tLastFontDef.xOffset = 0;
+    m_tLastFontDef.yOffset = 0;
+    m_tLastFontDef.xAdvance = 0;
 }
 
 CCLabelBMFont::~CCLabelBMFont()
@@ -560,40 +541,33 @@ CCLabelBMFont::~CCLabelBMFont()
 // LabelBMFont - Atlas generation
 int CCLabelBMFont::kerningAmountForFirst(unsigned short first, unsigned short second)
 {
-    int ret = 0;
-    unsigned int key = (first<<16) | (second & 0xffff);
-
-    if( m_pConfiguration->m_pKerningDictionary ) {
-        tCCKerningHashElement *element = NULL;
-        HASH_FIND_INT(m_pConfiguration->m_pKerningDictionary, &key, element);        
-        if(element)
-            ret = element->amount;
-    }
-    return ret;
+    return m_pConfiguration->getKerningAmount(first, second);
 }
 
 void CCLabelBMFont::createFontChars()
 {
-    int nextFontPositionX = 0;
-    int nextFontPositionY = 0;
-    unsigned short prev = -1;
-    int kerningAmount = 0;
-
-    CCSize tmpSize = CCSizeZero;
-
-    int longestLine = 0;
-    unsigned int totalHeight = 0;
+    m_nNextFontPositionX = 0;
+    m_nNextFontPositionY = 0;
+    m_uPrevChar = -1;
+    m_nLongestLine = 0;
+    m_uTotalHeight = 0;
+    m_tLastFontDef.rect = CCRectZero;
+    m_tLastFontDef.xAdvance = 0;
+
+    if (m_bUsesGlyphQuads)
+    {
+        m_letters.clear();
+        m_pobTextureAtlas->removeAllQuads();
+    }
 
     unsigned int quantityOfLines = 1;
     unsigned int stringLen = m_sString ? cc_wcslen(m_sString) : 0;
     if (stringLen == 0)
     {
-        this->setContentSize(CC_SIZE_PIXELS_TO_POINTS(tmpSize));
+        this->setContentSize(CCSizeZero);
         return;
     }
 
-    set<unsigned int> *charSet = m_pConfiguration->getCharacterSet();
-
     for (unsigned int i = 0; i < stringLen - 1; ++i)
     {
         unsigned short c = m_sString[i];
@@ -603,43 +577,62 @@ void CCLabelBMFont::createFontChars()
         }
     }
 
-    totalHeight = m_pConfiguration->m_nCommonHeight * quantityOfLines;
-    nextFontPositionY = 0-(m_pConfiguration->m_nCommonHeight - m_pConfiguration->m_nCommonHeight * quantityOfLines);
+    m_uTotalHeight = m_pConfiguration->m_nCommonHeight * quantityOfLines;
+    m_nNextFontPositionY = 0-(m_pConfiguration->m_nCommonHeight - m_pConfiguration->m_nCommonHeight * quantityOfLines);
     
+    this->layoutFontChars(0, stringLen);
+}
+
+void CCLabelBMFont::layoutFontChars(unsigned int start, unsigned int end)
+{
+    int kerningAmount = 0;
+
+    CCSize tmpSize = CCSizeZero;
+
     CCRect rect;
-    ccBMFontDef fontDef;
+    ccBMFontDef &fontDef = m_tLastFontDef;
 
-    for (unsigned int i= 0; i < stringLen; i++)
+    if (m_bUsesGlyphQuads)
+    {
+        // make room for the new letters at once, the batch node wants one spare quad
+        unsigned int uNeededQuads = m_letters.size() + end - start;
+        if (m_pobTextureAtlas->getCapacity() <= uNeededQuads)
+        {
+            m_pobTextureAtlas->resizeCapacity(uNeededQuads + 1);
+        }
+        m_letters.reserve(uNeededQuads);
+
+        // the quads are made by the reused char, with the label properties
+        m_pReusedChar->setOpacityModifyRGB(m_bIsOpacityModifyRGB);
+        m_pReusedChar->updateDisplayedColor(m_tDisplayedColor);
+        m_pReusedChar->updateDisplayedOpacity(m_cDisplayedOpacity);
+    }
+
+    for (unsigned int i = start; i < end; i++)
     {
         unsigned short c = m_sString[i];
 
         if (c == '\n')
         {
-            nextFontPositionX = 0;
-            nextFontPositionY -= m_pConfiguration->m_nCommonHeight;
+            m_nNextFontPositionX = 0;
+            m_nNextFontPositionY -= m_pConfiguration->m_nCommonHeight;
             continue;
         }
         
-        if (charSet->find(c) == charSet->end())
+        const ccBMFontGlyph *pGlyph = m_pConfiguration->getGlyph(c);
+        if (! pGlyph)
         {
             CCLOGWARN("cocos2d::CCLabelBMFont: Attempted to use character not defined in this bitmap: %d", c);
-            continue;      
-        }
-
-        kerningAmount = this->kerningAmountForFirst(prev, c);
-        
-        tCCFontDefHashElement *element = NULL;
-
-        // unichar is a short, and an int is needed on HASH_FIND_INT
-        unsigned int key = c;
-        HASH_FIND_INT(m_pConfiguration->m_pFontDefDictionary, &key, element);
-        if (! element)
-        {
-            CCLOGWARN("cocos2d::CCLabelBMFont: characer not found %d", c);
             continue;
         }
 
-        fontDef = element->fontDef;
+        kerningAmount = this->kerningAmountForFirst(m_uPrevChar, c);
+
+        fontDef.charID = pGlyph->charID;
+        fontDef.rect.setRect(pGlyph->x, pGlyph->y, pGlyph->width, pGlyph->height);
+        fontDef.xOffset = pGlyph->xOffset;
+        fontDef.yOffset = pGlyph->yOffset;
+        fontDef.xAdvance = pGlyph->xAdvance;
 
         rect = fontDef.rect;
         rect = CC_RECT_PIXELS_TO_POINTS(rect);
@@ -647,84 +640,126 @@ void CCLabelBMFont::createFontChars()
         rect.origin.x += m_tImageOffset.x;
         rect.origin.y += m_tImageOffset.y;
 
-        CCSprite *fontChar;
+        // See issue 1343. cast( signed short + unsigned integer ) == unsigned integer (sign is lost!)
+        int yOffset = m_pConfiguration->m_nCommonHeight - fontDef.yOffset;
+        CCPoint fontPos = ccp( (float)m_nNextFontPositionX + fontDef.xOffset + fontDef.rect.size.width*0.5f + kerningAmount,
+            (float)m_nNextFontPositionY + yOffset - rect.size.height*0.5f * CC_CONTENT_SCALE_FACTOR() );
 
-        bool hasSprite = true;
-        fontChar = (CCSprite*)(this->getChildByTag(i));
-        if(fontChar )
+        if (m_bUsesGlyphQuads)
         {
-            // Reusing previous Sprite
-			fontChar->setVisible(true);
+            // no sprite, only the quad of the letter
+            ccBMFontLetter letter;
+            letter.rect = rect;
+            letter.position = CC_POINT_PIXELS_TO_POINTS(fontPos);
+            letter.index = i;
+            m_letters.push_back(letter);
+
+            updateLetterQuad(m_letters.size() - 1);
         }
         else
         {
-            // New Sprite ? Set correct color, opacity, etc...
-            if( 0 )
+            CCSprite *fontChar = getLetterSprite(i);
+            if(fontChar )
             {
-				/* WIP: Doesn't support many features yet.
-				 But this code is super fast. It doesn't create any sprite.
-				 Ideal for big labels.
-				 */
-				fontChar = m_pReusedChar;
-				fontChar->setBatchNode(NULL);
-				hasSprite = false;
-			}
+                // Reusing previous Sprite
+                fontChar->setVisible(true);
+            }
             else
             {
+                // New Sprite ? Set correct color, opacity, etc...
                 fontChar = new CCSprite();
                 fontChar->initWithTexture(m_pobTextureAtlas->getTexture(), rect);
                 addChild(fontChar, i, i);
                 fontChar->release();
-			}
-            
-            // Apply label properties
-			fontChar->setOpacityModifyRGB(m_bIsOpacityModifyRGB);
-            
-			// Color MUST be set before opacity, since opacity might change color if OpacityModifyRGB is on
-			fontChar->updateDisplayedColor(m_tDisplayedColor);
-			fontChar->updateDisplayedOpacity(m_cDisplayedOpacity);
-        }
 
-        // updating previous sprite
-        fontChar->setTextureRect(rect, false, rect.size);
+                // Apply label properties
+                fontChar->setOpacityModifyRGB(m_bIsOpacityModifyRGB);
 
-        // See issue 1343. cast( signed short + unsigned integer ) == unsigned integer (sign is lost!)
-        int yOffset = m_pConfiguration->m_nCommonHeight - fontDef.yOffset;
-        CCPoint fontPos = ccp( (float)nextFontPositionX + fontDef.xOffset + fontDef.rect.size.width*0.5f + kerningAmount,
-            (float)nextFontPositionY + yOffset - rect.size.height*0.5f * CC_CONTENT_SCALE_FACTOR() );
-        fontChar->setPosition(CC_POINT_PIXELS_TO_POINTS(fontPos));
+                // Color MUST be set before opacity, since opacity might change color if OpacityModifyRGB is on
+                fontChar->updateDisplayedColor(m_tDisplayedColor);
+                fontChar->updateDisplayedOpacity(m_cDisplayedOpacity);
+            }
+
+            // updating previous sprite
+            fontChar->setTextureRect(rect, false, rect.size);
+            fontChar->setPosition(CC_POINT_PIXELS_TO_POINTS(fontPos));
+        }
 
         // update kerning
-        nextFontPositionX += fontDef.xAdvance + kerningAmount;
-        prev = c;
+        m_nNextFontPositionX += fontDef.xAdvance + kerningAmount;
+        m_uPrevChar = c;
 
-        if (longestLine < nextFontPositionX)
+        if (m_nLongestLine < m_nNextFontPositionX)
         {
-            longestLine = nextFontPositionX;
-        }
-        
-        if (! hasSprite)
-        {
-            updateQuadFromSprite(fontChar, i);
+            m_nLongestLine = m_nNextFontPositionX;
         }
     }
 
+    if (m_bUsesGlyphQuads)
+    {
+        // the reused char is not a letter anymore, its color changes must not touch the atlas
+        m_pReusedChar->setAtlasIndex(CCSpriteIndexNotInitialized);
+    }
+
     // If the last character processed has an xAdvance which is less that the width of the characters image, then we need
     // to adjust the width of the string to take this into account, or the character will overlap the end of the bounding
     // box
     if (fontDef.xAdvance < fontDef.rect.size.width)
     {
-        tmpSize.width = longestLine + fontDef.rect.size.width - fontDef.xAdvance;
+        tmpSize.width = m_nLongestLine + fontDef.rect.size.width - fontDef.xAdvance;
     }
     else
     {
-        tmpSize.width = longestLine;
+        tmpSize.width = m_nLongestLine;
     }
-    tmpSize.height = totalHeight;
+    tmpSize.height = m_uTotalHeight;
 
     this->setContentSize(CC_SIZE_PIXELS_TO_POINTS(tmpSize));
 }
 
+bool CCLabelBMFont::appendString(const char *newString)
+{
+    // only the letters of a single line, left aligned label can be laid out after the others
+    size_t uOldLength = m_sInitialStringUTF8.length();
+    if (!m_bUsesGlyphQuads || m_fWidth > 0 || m_pAlignment != kCCTextAlignmentLeft
+        || uOldLength == 0 || m_sInitialStringUTF8[uOldLength - 1] == '\n'
+        || strncmp(newString, m_sInitialStringUTF8.c_str(), uOldLength) != 0
+        || newString[uOldLength] == 0 || strchr(newString + uOldLength, '\n') != NULL)
+    {
+        return false;
+    }
+
+    // the laid out string has to be the initial one, without line breaks
+    int nOldLength = m_sInitialString ? cc_wcslen(m_sInitialString) : 0;
+    if (nOldLength == 0 || !m_sString || cc_wcslen(m_sString) != nOldLength
+        || memcmp(m_sString, m_sInitialString, nOldLength * sizeof(unsigned short)) != 0)
+    {
+        return false;
+    }
+
+    // only the new characters are converted
+    unsigned short* utf16Suffix = cc_utf8_to_utf16(newString + uOldLength);
+    if (!utf16Suffix)
+    {
+        return false;
+    }
+    int nSuffixLength = cc_wcslen(utf16Suffix);
+
+    unsigned short* str_new = new unsigned short[nOldLength + nSuffixLength + 1];
+    memcpy(str_new, m_sInitialString, nOldLength * sizeof(unsigned short));
+    memcpy(str_new + nOldLength, utf16Suffix, (nSuffixLength + 1) * sizeof(unsigned short));
+    CC_SAFE_DELETE_ARRAY(utf16Suffix);
+
+    CC_SAFE_DELETE_ARRAY(m_sInitialString);
+    m_sInitialString = str_new;
+    CC_SAFE_DELETE_ARRAY(m_sString);
+    m_sString = copyUTF16StringN(str_new);
+    m_sInitialStringUTF8 = newString;
+
+    this->layoutFontChars(nOldLength, nOldLength + nSuffixLength);
+    return true;
+}
+
 //LabelBMFont - CCLabelProtocol protocol
 void CCLabelBMFont::setString(const char *newString)
 {
@@ -736,6 +771,9 @@ void CCLabelBMFont::setString(const char *newString, bool needUpdateLabel)
     if (newString == NULL) {
         newString = "";
     }
+    if (needUpdateLabel && appendString(newString)) {
+        return;
+    }
     if (needUpdateLabel) {
         m_sInitialStringUTF8 = newString;
     }
@@ -859,6 +897,7 @@ void CCLabelBMFont::setOpacityModifyRGB(bool var)
             }
         }
     }
+    updateLetterQuads();
 }
 bool CCLabelBMFont::isOpacityModifyRGB()
 {
@@ -875,6 +914,7 @@ void CCLabelBMFont::updateDisplayedOpacity(GLubyte parentOpacity)
         CCSprite *item = (CCSprite*)pObj;
 		item->updateDisplayedOpacity(m_cDisplayedOpacity);
 	}
+    updateLetterQuads();
 }
 
 void CCLabelBMFont::updateDisplayedColor(const ccColor3B& parentColor)
@@ -889,6 +929,7 @@ void CCLabelBMFont::updateDisplayedColor(const ccColor3B& parentColor)
         CCSprite *item = (CCSprite*)pObj;
 		item->updateDisplayedColor(m_tDisplayedColor);
 	}
+    updateLetterQuads();
 }
 
 bool CCLabelBMFont::isCascadeColorEnabled()
@@ -941,20 +982,20 @@ void CCLabelBMFont::updateLabel()
         float startOfLine = -1, startOfWord = -1;
         int skip = 0;
 
-        CCArray* children = getChildren();
-        for (unsigned int j = 0; j < children->count(); j++)
+        unsigned int letterCount = getLetterCount();
+        for (unsigned int j = 0; j < letterCount; j++)
         {
-            CCSprite* characterSprite;
             unsigned int justSkipped = 0;
             
-            while (!(characterSprite = (CCSprite*)this->getChildByTag(j + skip + justSkipped)))
+            while (!hasLetter(j + skip + justSkipped))
             {
                 justSkipped++;
             }
             
             skip += justSkipped;
+            int tag = j + skip;
             
-            if (!characterSprite->isVisible())
+            if (!isLetterVisible(tag))
                 continue;
 
             if (i >= stringLength)
@@ -964,7 +1005,7 @@ void CCLabelBMFont::updateLabel()
 
             if (!start_word)
             {
-                startOfWord = getLetterPosXLeft( characterSprite );
+                startOfWord = getLetterPosXLeft(tag);
                 start_word = true;
             }
             if (!start_line)
@@ -995,7 +1036,7 @@ void CCLabelBMFont::updateLabel()
 
                 if (!startOfWord)
                 {
-                    startOfWord = getLetterPosXLeft( characterSprite );
+                    startOfWord = getLetterPosXLeft(tag);
                     start_word = true;
                 }
                 if (!startOfLine)
@@ -1018,7 +1059,7 @@ void CCLabelBMFont::updateLabel()
             }
 
             // Out of bounds.
-            if ( getLetterPosXRight( characterSprite ) - startOfLine > m_fWidth )
+            if ( getLetterPosXRight(tag) - startOfLine > m_fWidth )
             {
                 if (!m_bLineBreakWithoutSpaces)
                 {
@@ -1056,7 +1097,7 @@ void CCLabelBMFont::updateLabel()
 
                     if (!startOfWord)
                     {
-                        startOfWord = getLetterPosXLeft( characterSprite );
+                        startOfWord = getLetterPosXLeft(tag);
                         start_word = true;
                     }
                     if (!startOfLine)
@@ -1119,11 +1160,10 @@ void CCLabelBMFont::updateLabel()
                 int index = i + line_length - 1 + lineNumber;
                 if (index < 0) continue;
 
-                CCSprite* lastChar = (CCSprite*)getChildByTag(index);
-                if ( lastChar == NULL )
+                if (!hasLetter(index))
                     continue;
 
-                lineWidth = lastChar->getPosition().x + lastChar->getContentSize().width/2.0f;
+                lineWidth = getLetterPosition(index).x + getLetterWidth(index)/2.0f;
 
                 float shift = 0;
                 switch (m_pAlignment)
@@ -1145,10 +1185,9 @@ void CCLabelBMFont::updateLabel()
                         index = i + j + lineNumber;
                         if (index < 0) continue;
 
-                        CCSprite* characterSprite = (CCSprite*)getChildByTag(index);
-                        if (characterSprite)
+                        if (hasLetter(index))
                         {
-                            characterSprite->setPosition(ccpAdd(characterSprite->getPosition(), ccp(shift, 0.0f)));
+                            moveLetter(index, shift);
                         }
                     }
                 }
@@ -1162,6 +1201,8 @@ void CCLabelBMFont::updateLabel()
 
             last_line.push_back(m_sString[ctr]);
         }
+
+        updateLetterQuads();
     }
 }
 
@@ -1202,14 +1243,144 @@ void CCLabelBMFont::setScaleY(float scaleY)
     updateLabel();
 }
 
-float CCLabelBMFont::getLetterPosXLeft( CCSprite* sp )
+float CCLabelBMFont::getLetterPosXLeft(int tag)
+{
+    float anchorX = m_bUsesGlyphQuads ? 0.5f : getLetterSprite(tag)->getAnchorPoint().x;
+    return getLetterPosition(tag).x * m_fScaleX - (getLetterWidth(tag) * m_fScaleX * anchorX);
+}
+
+float CCLabelBMFont::getLetterPosXRight(int tag)
 {
-    return sp->getPosition().x * m_fScaleX - (sp->getContentSize().width * m_fScaleX * sp->getAnchorPoint().x);
+    float anchorX = m_bUsesGlyphQuads ? 0.5f : getLetterSprite(tag)->getAnchorPoint().x;
+    return getLetterPosition(tag).x * m_fScaleX + (getLetterWidth(tag) * m_fScaleX * anchorX);
 }
 
-float CCLabelBMFont::getLetterPosXRight( CCSprite* sp )
+// LabelBMFont - Letters
+CCSprite* CCLabelBMFont::getLetterSprite(int tag)
 {
-    return sp->getPosition().x * m_fScaleX + (sp->getContentSize().width * m_fScaleX * sp->getAnchorPoint().x);
+    return (CCSprite*)CCSpriteBatchNode::getChildByTag(tag);
+}
+
+ccBMFontLetter* CCLabelBMFont::getLetter(int tag)
+{
+    if (tag < 0)
+    {
+        return NULL;
+    }
+    std::vector<ccBMFontLetter>::iterator it = std::lower_bound(m_letters.begin(), m_letters.end(), (unsigned int)tag, isLetterBefore);
+    if (it == m_letters.end() || it->index != (unsigned int)tag)
+    {
+        return NULL;
+    }
+    return &(*it);
+}
+
+unsigned int CCLabelBMFont::getLetterCount()
+{
+    if (m_bUsesGlyphQuads)
+    {
+        return m_letters.size();
+    }
+    return m_pChildren ? m_pChildren->count() : 0;
+}
+
+bool CCLabelBMFont::hasLetter(int tag)
+{
+    return m_bUsesGlyphQuads ? getLetter(tag) != NULL : getLetterSprite(tag) != NULL;
+}
+
+bool CCLabelBMFont::isLetterVisible(int tag)
+{
+    if (m_bUsesGlyphQuads)
+    {
+        return getLetter(tag) != NULL;
+    }
+    CCSprite* pSprite = getLetterSprite(tag);
+    return pSprite && pSprite->isVisible();
+}
+
+CCPoint CCLabelBMFont::getLetterPosition(int tag)
+{
+    return m_bUsesGlyphQuads ? getLetter(tag)->position : getLetterSprite(tag)->getPosition();
+}
+
+float CCLabelBMFont::getLetterWidth(int tag)
+{
+    return m_bUsesGlyphQuads ? getLetter(tag)->rect.size.width : getLetterSprite(tag)->getContentSize().width;
+}
+
+void CCLabelBMFont::moveLetter(int tag, float shift)
+{
+    if (m_bUsesGlyphQuads)
+    {
+        ccBMFontLetter* pLetter = getLetter(tag);
+        pLetter->position.x += shift;
+    }
+    else
+    {
+        CCSprite* pSprite = getLetterSprite(tag);
+        pSprite->setPosition(ccpAdd(pSprite->getPosition(), ccp(shift, 0.0f)));
+    }
+}
+
+void CCLabelBMFont::updateLetterQuad(unsigned int letterIndex)
+{
+    const ccBMFontLetter &letter = m_letters[letterIndex];
+    m_pReusedChar->setTextureRect(letter.rect, false, letter.rect.size);
+    m_pReusedChar->setPosition(letter.position);
+    updateQuadFromSprite(m_pReusedChar, letterIndex);
+}
+
+void CCLabelBMFont::updateLetterQuads()
+{
+    if (!m_bUsesGlyphQuads || !m_pReusedChar)
+    {
+        return;
+    }
+
+    m_pReusedChar->setOpacityModifyRGB(m_bIsOpacityModifyRGB);
+    m_pReusedChar->updateDisplayedColor(m_tDisplayedColor);
+    m_pReusedChar->updateDisplayedOpacity(m_cDisplayedOpacity);
+
+    for (unsigned int i = 0; i < m_letters.size(); i++)
+    {
+        updateLetterQuad(i);
+    }
+
+    m_pReusedChar->setAtlasIndex(CCSpriteIndexNotInitialized);
+}
+
+void CCLabelBMFont::setUsesGlyphQuads(bool bUsesGlyphQuads)
+{
+    if (m_bUsesGlyphQuads == bUsesGlyphQuads)
+    {
+        return;
+    }
+    CCAssert(!m_bUsesSlotStorage, "CCLabelBMFont: glyph quads need the quads to stay in string order");
+
+    m_bUsesGlyphQuads = bUsesGlyphQuads;
+
+    // not initialized yet, the string is laid out by init
+    if (!m_pReusedChar)
+    {
+        return;
+    }
+
+    // drop the sprites or the letters, and lay out the string again
+    removeAllChildrenWithCleanup(true);
+    m_letters.clear();
+    m_pobTextureAtlas->removeAllQuads();
+    updateLabel();
+}
+
+CCNode* CCLabelBMFont::getChildByTag(int tag)
+{
+    // the sprites of the characters are only created once they are asked for
+    if (m_bUsesGlyphQuads)
+    {
+        setUsesGlyphQuads(false);
+    }
+    return CCSpriteBatchNode::getChildByTag(tag);
 }
 
 // LabelBMFont - FntFile
@@ -34,6 +34,7 @@ Use any of these editors to generate BMFonts:
 #define __CCBITMAP_FONT_ATLAS_H__
 
 #include "sprite_nodes/CCSpriteBatchNode.h"
+#include "CCBMFontFormat.h"
 #include "support/data_support/uthash.h"
 #include <map>
 #include <sstream>
@@ -53,8 +54,6 @@ enum {
     kCCLabelAutomaticWidth = -1,
 };
 
-struct _FontDefHashElement;
-
 /**
 @struct ccBMFontDef
 BMFont definition
@@ -102,6 +101,18 @@ typedef struct _KerningHashElement
 	UT_hash_handle	hh;
 } tCCKerningHashElement;
 
+/** @struct ccBMFontLetter
+Character of a CCLabelBMFont that is drawn as a quad, without a sprite
+*/
+typedef struct _BMFontLetter {
+    //! rect of the character in the texture (in points)
+    CCRect rect;
+    //! center of the character in the label (in points)
+    CCPoint position;
+    //! index of the character in the string, it is the tag of its sprite
+    unsigned int index;
+} ccBMFontLetter;
+
 /** @brief CCBMFontConfiguration has parsed configuration of the the .fnt file
 @since v0.8
 @js NA
@@ -111,18 +122,13 @@ class CC_DLL CCBMFontConfiguration : public CCObject
 {
     // XXX: Creating a public interface so that the bitmapFontArray[] is accessible
 public://@public
-    // BMFont definitions
-    tCCFontDefHashElement *m_pFontDefDictionary;
-
     //! FNTConfig: Common Height Should be signed (issue #1343)
     int m_nCommonHeight;
     //! Padding
     ccBMFontPadding    m_tPadding;
     //! atlas name
     std::string m_sAtlasName;
-    //! values for kerning
-    tCCKerningHashElement *m_pKerningDictionary;
-    
+
     // Character Set defines the letters that actually exist in the font
     std::set<unsigned int> *m_pCharacterSet;
 public:
@@ -141,22 +147,73 @@ public:
     /** allocates a CCBMFontConfiguration with a FNT file */
     static CCBMFontConfiguration * create(const char *FNTfile);
 
-    /** initializes a BitmapFontConfiguration with a FNT file */
+    /** initializes a BitmapFontConfiguration with a FNT file.
+     A precompiled ".fntb" file is loaded directly; for a ".fnt" file a ".fntb" sibling is preferred when present.
+     */
     bool initWithFNTfile(const char *FNTfile);
+
+    /** returns the glyph of a character, or NULL if the font doesn't define it
+     @since v2.2
+     */
+    inline const ccBMFontGlyph* getGlyph(unsigned int charID) const { return ccBMFontFindGlyph(m_pGlyphs, m_uGlyphCount, charID); }
+
+    /** returns the kerning between two characters, or 0 if the pair has none
+     @since v2.2
+     */
+    inline int getKerningAmount(unsigned short first, unsigned short second) const { return ccBMFontFindKerning(m_pKernings, m_uKerningCount, first, second); }
+
+    /** number of glyphs, in charID order
+     @since v2.2
+     */
+    inline unsigned int getGlyphCount() const { return m_uGlyphCount; }
+
+    /** number of kerning pairs
+     @since v2.2
+     */
+    inline unsigned int getKerningCount() const { return m_uKerningCount; }
+
+    /** BMFont definitions as a uthash dictionary, built on first use from the glyph table
+     @deprecated Use getGlyph() instead. Kept for code written against the former m_pFontDefDictionary member.
+     */
+    tCCFontDefHashElement* getFontDefDictionary() const;
+
+    /** kerning values as a uthash dictionary, built on first use from the kerning table
+     @deprecated Use getKerningAmount() instead. Kept for code written against the former m_pKerningDictionary member.
+     */
+    tCCKerningHashElement* getKerningDictionary() const;
+
+    /** writes the parsed font as a precompiled ".fntb" file
+     @since v2.2
+     */
+    bool writeBinaryFile(const char *pszPath) const;
     
     inline const char* getAtlasName(){ return m_sAtlasName.c_str(); }
     inline void setAtlasName(const char* atlasName) { m_sAtlasName = atlasName; }
     
     std::set<unsigned int>* getCharacterSet() const;
 private:
-    std::set<unsigned int>* parseConfigFile(const char *controlFile);
-    void parseCharacterDefinition(std::string line, ccBMFontDef *characterDefinition);
-    void parseInfoArguments(std::string line);
-    void parseCommonArguments(std::string line);
-    void parseImageFileName(std::string line, const char *fntFile);
-    void parseKerningEntry(std::string line);
+    bool parseConfigFile(const char *controlFile);
+    bool loadBinaryFile(const std::string& fullpath, const unsigned char *pSource, unsigned long uSourceSize);
+    bool loadTextData(const unsigned char *pData, unsigned long uSize, const std::string& fullpath);
+    void applyFontInfo(const ccBMFontInfo& info, const char *fntFile);
+    void purgeFontData();
     void purgeKerningDictionary();
     void purgeFontDefDictionary();
+
+    // Sorted glyph and kerning tables. They point either into the loaded ".fntb"
+    // buffer or into the storage vectors filled by the text parser.
+    const ccBMFontGlyph *m_pGlyphs;
+    unsigned int m_uGlyphCount;
+    const ccBMFontKerning *m_pKernings;
+    unsigned int m_uKerningCount;
+    std::vector<ccBMFontGlyph> m_glyphStorage;
+    std::vector<ccBMFontKerning> m_kerningStorage;
+    unsigned char *m_pBinaryData;
+    // font wide values as read from the file, kept for writeBinaryFile
+    ccBMFontInfo m_tFontInfo;
+    // compatibility dictionaries, only built when asked for
+    mutable tCCFontDefHashElement *m_pFontDefDictionary;
+    mutable tCCKerningHashElement *m_pKerningDictionary;
 };
 
 /** @brief CCLabelBMFont is a subclass of CCSpriteBatchNode.
@@ -176,6 +233,9 @@ Limitations:
 - All inner characters are using an anchorPoint of (0.5f, 0.5f) and it is not recommend to change it
 because it might affect the rendering
 
+For big labels that are never animated per character, setUsesGlyphQuads(true) lays out the characters
+as quads of the texture atlas, without creating a sprite for each of them.
+
 CCLabelBMFont implements the protocol CCLabelProtocol, like CCLabel and CCLabelAtlas.
 CCLabelBMFont has the flexibility of CCLabel, the speed of CCLabelAtlas and all the features of CCSprite.
 If in doubt, use CCLabelBMFont instead of CCLabelAtlas / CCLabel.
@@ -256,6 +316,18 @@ public:
     virtual bool isCascadeColorEnabled();
     virtual void setCascadeColorEnabled(bool cascadeColorEnabled);
 
+    /** Whether the characters are drawn as quads instead of CCSprite children.
+     Text appended with setString() is then laid out without redoing the whole label,
+     as long as the label has no width and is left aligned.
+     The sprites are created, and this mode is left, when getChildByTag() is called.
+     Default is false.
+     */
+    void setUsesGlyphQuads(bool bUsesGlyphQuads);
+    inline bool isUsingGlyphQuads(void) { return m_bUsesGlyphQuads; }
+    
+    /** returns the sprite of the character at the given index of the string */
+    virtual CCNode* getChildByTag(int tag);
+
     void setFntFile(const char* fntFile);
     const char* getFntFile();
 	CCBMFontConfiguration* getConfiguration() const;
@@ -265,8 +337,20 @@ public:
 private:
     char * atlasNameFromFntFile(const char *fntFile);
     int kerningAmountForFirst(unsigned short first, unsigned short second);
-    float getLetterPosXLeft( CCSprite* characterSprite );
-    float getLetterPosXRight( CCSprite* characterSprite );
+    void layoutFontChars(unsigned int start, unsigned int end);
+    bool appendString(const char *newString);
+    void updateLetterQuad(unsigned int letterIndex);
+    void updateLetterQuads();
+    CCSprite* getLetterSprite(int tag);
+    ccBMFontLetter* getLetter(int tag);
+    unsigned int getLetterCount();
+    bool hasLetter(int tag);
+    bool isLetterVisible(int tag);
+    CCPoint getLetterPosition(int tag);
+    float getLetterWidth(int tag);
+    void moveLetter(int tag, float shift);
+    float getLetterPosXLeft(int tag);
+    float getLetterPosXRight(int tag);
     
 protected:
     virtual void setString(unsigned short *newString, bool needUpdateLabel);
@@ -294,6 +378,18 @@ protected:
     // reused char
     CCSprite *m_pReusedChar;
     
+    // characters drawn without sprites, in the order of the string
+    bool m_bUsesGlyphQuads;
+    std::vector<ccBMFontLetter> m_letters;
+    
+    // layout state at the end of the string
+    int m_nNextFontPositionX;
+    int m_nNextFontPositionY;
+    unsigned short m_uPrevChar;
+    int m_nLongestLine;
+    unsigned int m_uTotalHeight;
+    ccBMFontDef m_tLastFontDef;
+    
     // texture RGBA
     GLubyte m_cDisplayedOpacity;
     GLubyte m_cRealOpacity;
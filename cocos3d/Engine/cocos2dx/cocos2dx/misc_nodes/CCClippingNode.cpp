@@ -32,11 +32,44 @@
 #include "CCDirector.h"
 #include "support/CCPointExtension.h"
 #include "draw_nodes/CCDrawingPrimitives.h"
+#include "layers_scenes_transitions_nodes/CCLayer.h"
+#include <math.h>
 
 NS_CC_BEGIN
 
 static GLint g_sStencilBits = -1;
 
+// stencil bits currently used by the CCClippingNodes being visited
+static GLuint s_uStencilBitsInUse = 0;
+
+// the stencil last written to each bit, so an adjacent clipping node
+// drawing the same stencil at the same place can reuse it
+typedef struct _ccStencilBitContent
+{
+    CCNode*         stencil;
+    kmMat4          matrix;
+    bool            inverted;
+    GLfloat         alphaThreshold;
+    GLuint          bitsBelow;
+    GLint           framebuffer;
+    GLint           scissorBox[4];
+    unsigned int    frame;
+    CCClippingNode* writer;
+    unsigned int    generation;
+} ccStencilBitContent;
+
+static ccStencilBitContent s_tStencilBitContents[32];
+
+// changes whenever something else than a CCClippingNode writes the stencil buffer
+static unsigned int s_uStencilGeneration = 0;
+
+// the CCClippingNode whose visit ended last, only compared, never dereferenced
+static CCClippingNode *s_pLastVisitedClipper = NULL;
+
+static unsigned int s_uStencilPasses = 0;
+static unsigned int s_uScissorPasses = 0;
+static unsigned int s_uMergedPasses = 0;
+
 static void setProgram(CCNode *n, CCGLProgram *p)
 {
     n->setShaderProgram(p);
@@ -49,6 +82,98 @@ static void setProgram(CCNode *n, CCGLProgram *p)
     }
 }
 
+// Projection * modelview of the stencil node, as it is when the stencil is visited
+static void stencilMatrix(CCNode *pClippingNode, CCNode *pStencil, kmMat4 *pOut)
+{
+    kmMat4 matrixP;
+    kmMat4 matrixMV;
+
+    kmGLPushMatrix();
+    pClippingNode->transform();
+    pStencil->transform();
+    kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV);
+    kmGLPopMatrix();
+
+    kmGLGetMatrix(KM_GL_PROJECTION, &matrixP);
+    kmMat4Multiply(pOut, &matrixP, &matrixMV);
+}
+
+// Whether the stencil fills exactly its content rect. Only a CCLayerColor without
+// children qualifies, and only if none of its pixels fail the alpha test.
+static bool isRectangularStencil(CCNode *pStencil, GLfloat fAlphaThreshold)
+{
+    CCLayerColor *pLayer = dynamic_cast<CCLayerColor*>(pStencil);
+    if (!pLayer || pLayer->getChildrenCount() > 0)
+    {
+        return false;
+    }
+    if (fAlphaThreshold < 1)
+    {
+        if (dynamic_cast<CCLayerGradient*>(pLayer) != NULL)
+        {
+            return false;
+        }
+        if (pLayer->getDisplayedOpacity() / 255.0f <= fAlphaThreshold)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Computes the window rect covered by the stencil content rect.
+// Returns false if it does not project to an axis aligned rectangle.
+static bool stencilWindowRect(CCNode *pStencil, const kmMat4 &matrix, GLint *pRect)
+{
+    const CCSize &size = pStencil->getContentSize();
+    const float corners[4][2] = {
+        {0, 0}, {size.width, 0}, {size.width, size.height}, {0, size.height}
+    };
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    const float *m = matrix.mat;
+    float x[4], y[4];
+    for (int i = 0; i < 4; i++)
+    {
+        float cx = corners[i][0];
+        float cy = corners[i][1];
+        float w = m[3] * cx + m[7] * cy + m[15];
+        if (w <= 0)
+        {
+            return false;
+        }
+        x[i] = viewport[0] + ((m[0] * cx + m[4] * cy + m[12]) / w + 1) * viewport[2] * 0.5f;
+        y[i] = viewport[1] + ((m[1] * cx + m[5] * cy + m[13]) / w + 1) * viewport[3] * 0.5f;
+    }
+
+    float minX = MIN(MIN(x[0], x[1]), MIN(x[2], x[3]));
+    float maxX = MAX(MAX(x[0], x[1]), MAX(x[2], x[3]));
+    float minY = MIN(MIN(y[0], y[1]), MIN(y[2], y[3]));
+    float maxY = MAX(MAX(y[0], y[1]), MAX(y[2], y[3]));
+
+    // every corner has to sit on a corner of the bounding box
+    const float epsilon = 0.01f;
+    for (int i = 0; i < 4; i++)
+    {
+        if ((fabsf(x[i] - minX) > epsilon && fabsf(x[i] - maxX) > epsilon) ||
+            (fabsf(y[i] - minY) > epsilon && fabsf(y[i] - maxY) > epsilon))
+        {
+            return false;
+        }
+    }
+
+    // same pixels as the rasterized stencil: those whose center is inside
+    GLint x0 = (GLint)ceilf(minX - 0.5f);
+    GLint y0 = (GLint)ceilf(minY - 0.5f);
+    pRect[0] = x0;
+    pRect[1] = y0;
+    pRect[2] = MAX((GLint)ceilf(maxX - 0.5f) - x0, 0);
+    pRect[3] = MAX((GLint)ceilf(maxY - 0.5f) - y0, 0);
+    return true;
+}
+
 CCClippingNode::CCClippingNode()
 : m_pStencil(NULL)
 , m_fAlphaThreshold(0.0f)
@@ -142,7 +267,36 @@ void CCClippingNode::onExit()
     CCNode::onExit();
 }
 
+// Whether pNode is visited right after pPrevious, with nothing drawn in between
+// but the children of pPrevious.
+static bool isVisitedRightAfter(CCNode *pNode, CCNode *pPrevious)
+{
+    CCNode *pParent = pNode->getParent();
+    CCArray *pChildren = pParent ? pParent->getChildren() : NULL;
+    if (!pChildren)
+    {
+        return false;
+    }
+    unsigned int index = pChildren->indexOfObject(pNode);
+    if (index == 0 || index == CC_INVALID_INDEX || pChildren->objectAtIndex(index - 1) != pPrevious)
+    {
+        return false;
+    }
+    // the parent is drawn between its children of negative and positive z order
+    return (pPrevious->getZOrder() < 0) == (pNode->getZOrder() < 0);
+}
+
 void CCClippingNode::visit()
+{
+    // the stencil and its content must be drawn while the stencil state set up for them is current,
+    // not when an enclosing batch of drawing primitives is flushed
+    int nBatchDepth = ccDrawSuspendBatch();
+    visitClipped();
+    ccDrawResumeBatch(nBatchDepth);
+    s_pLastVisitedClipper = this;
+}
+
+void CCClippingNode::visitClipped()
 {
     // if stencil buffer disabled
     if (g_sStencilBits < 1)
@@ -165,13 +319,31 @@ void CCClippingNode::visit()
         return;
     }
     
-    // store the current stencil layer (position in the stencil buffer),
-    // this will allow nesting up to n CCClippingNode,
+    kmMat4 stencilMVP;
+    stencilMatrix(this, m_pStencil, &stencilMVP);
+    
+    // a rectangular stencil is done with the scissor test, without using the stencil buffer
+    if (!m_bInverted && isRectangularStencil(m_pStencil, m_fAlphaThreshold))
+    {
+        GLint rect[4];
+        if (stencilWindowRect(m_pStencil, stencilMVP, rect))
+        {
+            visitWithScissor(rect);
+            return;
+        }
+    }
+    
+    // find a free stencil bit, this will allow nesting up to n CCClippingNode,
     // where n is the number of bits of the stencil buffer.
-    static GLint layer = -1;
+    // Bits are freed once the node is visited, so siblings reuse them.
+    GLint layer = 0;
+    while (layer < g_sStencilBits && layer < 32 && (s_uStencilBitsInUse & (0x1 << layer)))
+    {
+        layer++;
+    }
     
     // all the _stencilBits are in use?
-    if (layer + 1 == g_sStencilBits)
+    if (layer == g_sStencilBits || layer == 32)
     {
         // warn once
         static bool once = true;
@@ -191,16 +363,44 @@ void CCClippingNode::visit()
     ///////////////////////////////////
     // INIT
     
-    // increment the current layer
-    layer++;
-    
     // mask of the current layer (ie: for layer 3: 00000100)
     GLint mask_layer = 0x1 << layer;
-    // mask of all layers less than the current (ie: for layer 3: 00000011)
-    GLint mask_layer_l = mask_layer - 1;
-    // mask of all layers less than or equal to the current (ie: for layer 3: 00000111)
+    // mask of the layers used by the enclosing clipping nodes (ie: for layer 3: 00000011)
+    GLint mask_layer_l = s_uStencilBitsInUse;
+    // mask of those layers and the current one (ie: for layer 3: 00000111)
     GLint mask_layer_le = mask_layer | mask_layer_l;
     
+    // take the current layer
+    s_uStencilBitsInUse |= mask_layer;
+    
+    // can the stencil drawn last time in this layer be reused?
+    GLint currentFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &currentFramebuffer);
+    unsigned int currentFrame = CCDirector::sharedDirector()->getTotalFrames();
+    // the stencil is only written inside the scissor box, if any
+    GLint currentScissorBox[4] = {0, 0, 0, 0};
+    if (glIsEnabled(GL_SCISSOR_TEST))
+    {
+        glGetIntegerv(GL_SCISSOR_BOX, currentScissorBox);
+    }
+    else
+    {
+        currentScissorBox[2] = currentScissorBox[3] = -1;
+    }
+    ccStencilBitContent &layerContent = s_tStencilBitContents[layer];
+    // only the stencil of the previous sibling is reused, if nothing else wrote the stencil buffer since
+    bool reuseStencil = (layerContent.stencil == m_pStencil
+                         && layerContent.writer == s_pLastVisitedClipper
+                         && layerContent.generation == s_uStencilGeneration
+                         && layerContent.inverted == m_bInverted
+                         && layerContent.alphaThreshold == m_fAlphaThreshold
+                         && layerContent.bitsBelow == (GLuint)mask_layer_l
+                         && layerContent.framebuffer == currentFramebuffer
+                         && layerContent.frame == currentFrame
+                         && 0 == memcmp(layerContent.scissorBox, currentScissorBox, sizeof(currentScissorBox))
+                         && 0 == memcmp(&layerContent.matrix, &stencilMVP, sizeof(kmMat4))
+                         && isVisitedRightAfter(this, layerContent.writer));
+    
     // manually save the stencil state
     GLboolean currentStencilEnabled = GL_FALSE;
     GLuint currentStencilWriteMask = ~0;
@@ -228,109 +428,130 @@ void CCClippingNode::visit()
     // this means that operation like glClear or glStencilOp will be masked with this value
     glStencilMask(mask_layer);
     
-    //glClear(GL_STENCIL_BUFFER_BIT);
-    // manually save the depth test state
-    //GLboolean currentDepthTestEnabled = GL_TRUE;
-    GLboolean currentDepthWriteMask = GL_TRUE;
-    //currentDepthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &currentDepthWriteMask);
-    
-    // disable depth test while drawing the stencil
-    //glDisable(GL_DEPTH_TEST);
-    // disable update to the depth buffer while drawing the stencil,
-    // as the stencil is not meant to be rendered in the real scene,
-    // it should never prevent something else to be drawn,
-    // only disabling depth buffer update should do
-    glDepthMask(GL_FALSE);
+    if (reuseStencil)
+    {
+        s_uMergedPasses++;
+    }
+    else
+    {
+        //glClear(GL_STENCIL_BUFFER_BIT);
+        // manually save the depth test state
+        //GLboolean currentDepthTestEnabled = GL_TRUE;
+        GLboolean currentDepthWriteMask = GL_TRUE;
+        //currentDepthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &currentDepthWriteMask);
+    
+        // disable depth test while drawing the stencil
+        //glDisable(GL_DEPTH_TEST);
+        // disable update to the depth buffer while drawing the stencil,
+        // as the stencil is not meant to be rendered in the real scene,
+        // it should never prevent something else to be drawn,
+        // only disabling depth buffer update should do
+        glDepthMask(GL_FALSE);
     
-    ///////////////////////////////////
-    // CLEAR STENCIL BUFFER
+        ///////////////////////////////////
+        // CLEAR STENCIL BUFFER
     
-    // manually clear the stencil buffer by drawing a fullscreen rectangle on it
-    // setup the stencil test func like this:
-    // for each pixel in the fullscreen rectangle
-    //     never draw it into the frame buffer
-    //     if not in inverted mode: set the current layer value to 0 in the stencil buffer
-    //     if in inverted mode: set the current layer value to 1 in the stencil buffer
-    glStencilFunc(GL_NEVER, mask_layer, mask_layer);
-    glStencilOp(!m_bInverted ? GL_ZERO : GL_REPLACE, GL_KEEP, GL_KEEP);
+        // manually clear the stencil buffer by drawing a fullscreen rectangle on it
+        // setup the stencil test func like this:
+        // for each pixel in the fullscreen rectangle
+        //     never draw it into the frame buffer
+        //     if not in inverted mode: set the current layer value to 0 in the stencil buffer
+        //     if in inverted mode: set the current layer value to 1 in the stencil buffer
+        glStencilFunc(GL_NEVER, mask_layer, mask_layer);
+        glStencilOp(!m_bInverted ? GL_ZERO : GL_REPLACE, GL_KEEP, GL_KEEP);
     
-    // draw a fullscreen solid rectangle to clear the stencil buffer
-    //ccDrawSolidRect(CCPointZero, ccpFromSize([[CCDirector sharedDirector] winSize]), ccc4f(1, 1, 1, 1));
-    ccDrawSolidRect(CCPointZero, ccpFromSize(CCDirector::sharedDirector()->getWinSize()), ccc4f(1, 1, 1, 1));
+        // draw a fullscreen solid rectangle to clear the stencil buffer
+        //ccDrawSolidRect(CCPointZero, ccpFromSize([[CCDirector sharedDirector] winSize]), ccc4f(1, 1, 1, 1));
+        ccDrawSolidRect(CCPointZero, ccpFromSize(CCDirector::sharedDirector()->getWinSize()), ccc4f(1, 1, 1, 1));
     
-    ///////////////////////////////////
-    // DRAW CLIPPING STENCIL
+        ///////////////////////////////////
+        // DRAW CLIPPING STENCIL
     
-    // setup the stencil test func like this:
-    // for each pixel in the stencil node
-    //     never draw it into the frame buffer
-    //     if not in inverted mode: set the current layer value to 1 in the stencil buffer
-    //     if in inverted mode: set the current layer value to 0 in the stencil buffer
-    glStencilFunc(GL_NEVER, mask_layer, mask_layer);
-    glStencilOp(!m_bInverted ? GL_REPLACE : GL_ZERO, GL_KEEP, GL_KEEP);
-    
-    // enable alpha test only if the alpha threshold < 1,
-    // indeed if alpha threshold == 1, every pixel will be drawn anyways
+        // setup the stencil test func like this:
+        // for each pixel in the stencil node
+        //     never draw it into the frame buffer
+        //     if not in inverted mode: set the current layer value to 1 in the stencil buffer
+        //     if in inverted mode: set the current layer value to 0 in the stencil buffer
+        glStencilFunc(GL_NEVER, mask_layer, mask_layer);
+        glStencilOp(!m_bInverted ? GL_REPLACE : GL_ZERO, GL_KEEP, GL_KEEP);
+    
+        // enable alpha test only if the alpha threshold < 1,
+        // indeed if alpha threshold == 1, every pixel will be drawn anyways
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_WINDOWS || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
-    GLboolean currentAlphaTestEnabled = GL_FALSE;
-    GLenum currentAlphaTestFunc = GL_ALWAYS;
-    GLclampf currentAlphaTestRef = 1;
+        GLboolean currentAlphaTestEnabled = GL_FALSE;
+        GLenum currentAlphaTestFunc = GL_ALWAYS;
+        GLclampf currentAlphaTestRef = 1;
 #endif
-    if (m_fAlphaThreshold < 1) {
+        if (m_fAlphaThreshold < 1) {
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_WINDOWS || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
-        // manually save the alpha test state
-        currentAlphaTestEnabled = glIsEnabled(GL_ALPHA_TEST);
-        glGetIntegerv(GL_ALPHA_TEST_FUNC, (GLint *)&currentAlphaTestFunc);
-        glGetFloatv(GL_ALPHA_TEST_REF, &currentAlphaTestRef);
-        // enable alpha testing
-        glEnable(GL_ALPHA_TEST);
-        // check for OpenGL error while enabling alpha test
-        CHECK_GL_ERROR_DEBUG();
-        // pixel will be drawn only if greater than an alpha threshold
-        glAlphaFunc(GL_GREATER, m_fAlphaThreshold);
+            // manually save the alpha test state
+            currentAlphaTestEnabled = glIsEnabled(GL_ALPHA_TEST);
+            glGetIntegerv(GL_ALPHA_TEST_FUNC, (GLint *)&currentAlphaTestFunc);
+            glGetFloatv(GL_ALPHA_TEST_REF, &currentAlphaTestRef);
+            // enable alpha testing
+            glEnable(GL_ALPHA_TEST);
+            // check for OpenGL error while enabling alpha test
+            CHECK_GL_ERROR_DEBUG();
+            // pixel will be drawn only if greater than an alpha threshold
+            glAlphaFunc(GL_GREATER, m_fAlphaThreshold);
 #else
-        // since glAlphaTest do not exists in OES, use a shader that writes
-        // pixel only if greater than an alpha threshold
-        CCGLProgram *program = CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionTextureColorAlphaTest);
-        GLint alphaValueLocation = glGetUniformLocation(program->getProgram(), kCCUniformAlphaTestValue);
-        // set our alphaThreshold
-        program->use();
-        program->setUniformLocationWith1f(alphaValueLocation, m_fAlphaThreshold);
-        // we need to recursively apply this shader to all the nodes in the stencil node
-        // XXX: we should have a way to apply shader to all nodes without having to do this
-        setProgram(m_pStencil, program);
+            // since glAlphaTest do not exists in OES, use a shader that writes
+            // pixel only if greater than an alpha threshold
+            CCGLProgram *program = CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionTextureColorAlphaTest);
+            GLint alphaValueLocation = glGetUniformLocation(program->getProgram(), kCCUniformAlphaTestValue);
+            // set our alphaThreshold
+            program->use();
+            program->setUniformLocationWith1f(alphaValueLocation, m_fAlphaThreshold);
+            // we need to recursively apply this shader to all the nodes in the stencil node
+            // XXX: we should have a way to apply shader to all nodes without having to do this
+            setProgram(m_pStencil, program);
        
 #endif
-    }
+        }
     
-    // draw the stencil node as if it was one of our child
-    // (according to the stencil test func/op and alpha (or alpha shader) test)
-    kmGLPushMatrix();
-    transform();
-    m_pStencil->visit();
-    kmGLPopMatrix();
+        // draw the stencil node as if it was one of our child
+        // (according to the stencil test func/op and alpha (or alpha shader) test)
+        kmGLPushMatrix();
+        transform();
+        m_pStencil->visit();
+        kmGLPopMatrix();
     
-    // restore alpha test state
-    if (m_fAlphaThreshold < 1)
-    {
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_WINDOWS || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
-        // manually restore the alpha test state
-        glAlphaFunc(currentAlphaTestFunc, currentAlphaTestRef);
-        if (!currentAlphaTestEnabled)
+        // restore alpha test state
+        if (m_fAlphaThreshold < 1)
         {
-            glDisable(GL_ALPHA_TEST);
-        }
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_WINDOWS || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+            // manually restore the alpha test state
+            glAlphaFunc(currentAlphaTestFunc, currentAlphaTestRef);
+            if (!currentAlphaTestEnabled)
+            {
+                glDisable(GL_ALPHA_TEST);
+            }
 #else
-// XXX: we need to find a way to restore the shaders of the stencil node and its childs
+    // XXX: we need to find a way to restore the shaders of the stencil node and its childs
 #endif
-    }
+        }
+    
+        // restore the depth test state
+        glDepthMask(currentDepthWriteMask);
+        //if (currentDepthTestEnabled) {
+        //    glEnable(GL_DEPTH_TEST);
+        //}
     
-    // restore the depth test state
-    glDepthMask(currentDepthWriteMask);
-    //if (currentDepthTestEnabled) {
-    //    glEnable(GL_DEPTH_TEST);
-    //}
+    
+        // remember what this layer holds now
+        layerContent.stencil = m_pStencil;
+        layerContent.matrix = stencilMVP;
+        layerContent.inverted = m_bInverted;
+        layerContent.alphaThreshold = m_fAlphaThreshold;
+        layerContent.bitsBelow = mask_layer_l;
+        layerContent.framebuffer = currentFramebuffer;
+        layerContent.frame = currentFrame;
+        layerContent.writer = this;
+        layerContent.generation = s_uStencilGeneration;
+        memcpy(layerContent.scissorBox, currentScissorBox, sizeof(currentScissorBox));
+        s_uStencilPasses++;
+    }
     
     ///////////////////////////////////
     // DRAW CONTENT
@@ -359,8 +580,73 @@ void CCClippingNode::visit()
         glDisable(GL_STENCIL_TEST);
     }
     
-    // we are done using this layer, decrement
-    layer--;
+    // we are done using this layer, free it
+    s_uStencilBitsInUse &= ~mask_layer;
+}
+
+void CCClippingNode::visitWithScissor(const GLint *pRect)
+{
+    // manually save the scissor state
+    GLboolean currentScissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+    GLint currentScissorBox[4] = {0, 0, 0, 0};
+    
+    GLint x0 = pRect[0];
+    GLint y0 = pRect[1];
+    GLint x1 = pRect[0] + pRect[2];
+    GLint y1 = pRect[1] + pRect[3];
+    
+    // intersect with the enclosing scissor rect, if any
+    if (currentScissorEnabled)
+    {
+        glGetIntegerv(GL_SCISSOR_BOX, currentScissorBox);
+        x0 = MAX(x0, currentScissorBox[0]);
+        y0 = MAX(y0, currentScissorBox[1]);
+        x1 = MIN(x1, currentScissorBox[0] + currentScissorBox[2]);
+        y1 = MIN(y1, currentScissorBox[1] + currentScissorBox[3]);
+    }
+    
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x0, y0, MAX(x1 - x0, 0), MAX(y1 - y0, 0));
+    s_uScissorPasses++;
+    
+    CCNode::visit();
+    
+    // manually restore the scissor state
+    if (currentScissorEnabled)
+    {
+        glScissor(currentScissorBox[0], currentScissorBox[1], currentScissorBox[2], currentScissorBox[3]);
+    }
+    else
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+}
+
+unsigned int CCClippingNode::getStencilPassCount()
+{
+    return s_uStencilPasses;
+}
+
+unsigned int CCClippingNode::getScissorPassCount()
+{
+    return s_uScissorPasses;
+}
+
+unsigned int CCClippingNode::getMergedPassCount()
+{
+    return s_uMergedPasses;
+}
+
+void CCClippingNode::notifyStencilBufferWritten()
+{
+    s_uStencilGeneration++;
+}
+
+void CCClippingNode::resetStatistics()
+{
+    s_uStencilPasses = 0;
+    s_uScissorPasses = 0;
+    s_uMergedPasses = 0;
 }
 
 CCNode* CCClippingNode::getStencil() const
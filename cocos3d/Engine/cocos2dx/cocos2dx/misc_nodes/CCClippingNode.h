@@ -112,8 +112,32 @@ public:
     bool isInverted() const;
     void setInverted(bool bInverted);
     
+    /** Number of stencils drawn into the stencil buffer since the last resetStatistics(). */
+    static unsigned int getStencilPassCount();
+    
+    /** Number of clipping nodes done with the scissor test instead of the stencil buffer.
+     This happens when the stencil is a CCLayerColor without children that is not inverted
+     and ends up as an axis aligned rectangle on screen.
+     */
+    static unsigned int getScissorPassCount();
+    
+    /** Number of clipping nodes that reused the stencil drawn by the previous sibling,
+     because it is also a clipping node with the same stencil node, transform and settings.
+     */
+    static unsigned int getMergedPassCount();
+    
+    /** Code that writes the stencil buffer outside of CCClippingNode calls this,
+     so that a stencil drawn before is not reused by the next sibling.
+     */
+    static void notifyStencilBufferWritten();
+    
+    static void resetStatistics();
+    
 protected:
     CCClippingNode();
+    
+    void visitClipped();
+    void visitWithScissor(const GLint *pRect);
 };
 
 NS_CC_END
@@ -25,6 +25,7 @@ THE SOFTWARE.
 
 #include "CCConfiguration.h"
 #include "misc_nodes/CCRenderTexture.h"
+#include "misc_nodes/CCClippingNode.h"
 #include "CCDirector.h"
 #include "platform/platform.h"
 #include "platform/CCImage.h"
@@ -41,9 +42,202 @@ THE SOFTWARE.
 // extern
 #include "kazmath/GL/matrix.h"
 #include "CCEGLView.h"
+#include <vector>
 
 NS_CC_BEGIN
 
+// idle render targets that are not reused for this many frames are deleted
+#define CC_RENDER_TARGET_MAX_IDLE_FRAMES 60
+
+// Texture, framebuffer and depth buffer of a CCRenderTexture
+typedef struct _ccRenderTarget
+{
+    int             width;
+    int             height;
+    GLenum          pixelFormat;
+    GLuint          depthStencilFormat;
+    CCTexture2D*    texture;
+    CCTexture2D*    textureCopy;
+    GLuint          fbo;
+    GLuint          depthRenderBuffer;
+    unsigned int    releaseFrame;
+} ccRenderTarget;
+
+// Keeps the render targets of the deleted render textures, and hands them to the
+// next render texture of the same size and formats. Render textures that live
+// for a few frames then reuse the same GL objects instead of creating new ones.
+class CCRenderTargetPool : public CCObject
+{
+public:
+    static CCRenderTargetPool* sharedPool();
+    static void purgeSharedPool();
+
+    CCRenderTargetPool();
+    virtual ~CCRenderTargetPool();
+
+    // takes an idle target, returns false if there is none of this kind
+    bool takeTarget(int w, int h, GLenum pixelFormat, GLuint depthStencilFormat, ccRenderTarget *pTarget);
+    // a target was created because none could be taken
+    void addCreatedTarget();
+    // gives back a target so it can be taken again, its textures are retained
+    void giveTarget(ccRenderTarget &target);
+    // a target is deleted by its render texture
+    static void removeTarget();
+
+    void purgeIdleTargets();
+    void listenToBackground(CCObject *obj);
+
+    // statistics outlive the shared pool, which is deleted when the caches are purged
+    static unsigned int s_uTargetsInUse;
+    static unsigned int s_uPeakTargetsInUse;
+    static unsigned int s_uTargetsCreated;
+    static unsigned int s_uTargetsReused;
+
+private:
+    void deleteIdleTargets(unsigned int uMaxIdleFrames);
+    static void targetInUse();
+
+    std::vector<ccRenderTarget> m_idleTargets;
+};
+
+static CCRenderTargetPool *s_pSharedRenderTargetPool = NULL;
+
+unsigned int CCRenderTargetPool::s_uTargetsInUse = 0;
+unsigned int CCRenderTargetPool::s_uPeakTargetsInUse = 0;
+unsigned int CCRenderTargetPool::s_uTargetsCreated = 0;
+unsigned int CCRenderTargetPool::s_uTargetsReused = 0;
+
+CCRenderTargetPool* CCRenderTargetPool::sharedPool()
+{
+    if (!s_pSharedRenderTargetPool)
+    {
+        s_pSharedRenderTargetPool = new CCRenderTargetPool();
+    }
+    return s_pSharedRenderTargetPool;
+}
+
+void CCRenderTargetPool::purgeSharedPool()
+{
+    // the pool deletes its idle targets when it is released
+    CC_SAFE_RELEASE_NULL(s_pSharedRenderTargetPool);
+}
+
+CCRenderTargetPool::CCRenderTargetPool()
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // idle targets are not restored when the GL context is lost
+    CCNotificationCenter::sharedNotificationCenter()->addObserver(this,
+                                                                  callfuncO_selector(CCRenderTargetPool::listenToBackground),
+                                                                  EVENT_COME_TO_BACKGROUND,
+                                                                  NULL);
+#endif
+}
+
+CCRenderTargetPool::~CCRenderTargetPool()
+{
+    purgeIdleTargets();
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    CCNotificationCenter::sharedNotificationCenter()->removeObserver(this, EVENT_COME_TO_BACKGROUND);
+#endif
+}
+
+void CCRenderTargetPool::listenToBackground(CCObject *obj)
+{
+    purgeIdleTargets();
+}
+
+bool CCRenderTargetPool::takeTarget(int w, int h, GLenum pixelFormat, GLuint depthStencilFormat, ccRenderTarget *pTarget)
+{
+    deleteIdleTargets(CC_RENDER_TARGET_MAX_IDLE_FRAMES);
+
+    // most recently given targets first
+    for (int i = (int)m_idleTargets.size() - 1; i >= 0; i--)
+    {
+        ccRenderTarget &target = m_idleTargets[i];
+        if (target.width != w || target.height != h
+            || target.pixelFormat != pixelFormat || target.depthStencilFormat != depthStencilFormat)
+        {
+            continue;
+        }
+        // the texture may still be displayed by a sprite that outlives its render texture
+        if (target.texture->retainCount() > 1)
+        {
+            continue;
+        }
+
+        *pTarget = target;
+        m_idleTargets.erase(m_idleTargets.begin() + i);
+
+        s_uTargetsReused++;
+        targetInUse();
+        return true;
+    }
+    return false;
+}
+
+void CCRenderTargetPool::addCreatedTarget()
+{
+    s_uTargetsCreated++;
+    targetInUse();
+}
+
+void CCRenderTargetPool::targetInUse()
+{
+    s_uTargetsInUse++;
+    if (s_uPeakTargetsInUse < s_uTargetsInUse)
+    {
+        s_uPeakTargetsInUse = s_uTargetsInUse;
+    }
+}
+
+void CCRenderTargetPool::giveTarget(ccRenderTarget &target)
+{
+    CC_SAFE_RETAIN(target.texture);
+    CC_SAFE_RETAIN(target.textureCopy);
+    target.releaseFrame = CCDirector::sharedDirector()->getTotalFrames();
+    m_idleTargets.push_back(target);
+    removeTarget();
+
+    deleteIdleTargets(CC_RENDER_TARGET_MAX_IDLE_FRAMES);
+}
+
+void CCRenderTargetPool::removeTarget()
+{
+    if (s_uTargetsInUse > 0)
+    {
+        s_uTargetsInUse--;
+    }
+}
+
+void CCRenderTargetPool::purgeIdleTargets()
+{
+    deleteIdleTargets(0);
+}
+
+void CCRenderTargetPool::deleteIdleTargets(unsigned int uMaxIdleFrames)
+{
+    unsigned int uFrame = CCDirector::sharedDirector()->getTotalFrames();
+    unsigned int uKept = 0;
+    for (unsigned int i = 0; i < m_idleTargets.size(); i++)
+    {
+        ccRenderTarget &target = m_idleTargets[i];
+        if (uMaxIdleFrames > 0 && uFrame - target.releaseFrame <= uMaxIdleFrames)
+        {
+            m_idleTargets[uKept++] = target;
+            continue;
+        }
+
+        glDeleteFramebuffers(1, &target.fbo);
+        if (target.depthRenderBuffer)
+        {
+            glDeleteRenderbuffers(1, &target.depthRenderBuffer);
+        }
+        CC_SAFE_RELEASE(target.texture);
+        CC_SAFE_RELEASE(target.textureCopy);
+    }
+    m_idleTargets.resize(uKept);
+}
+
 // implementation CCRenderTexture
 CCRenderTexture::CCRenderTexture()
 : m_pSprite(NULL)
@@ -54,6 +248,7 @@ CCRenderTexture::CCRenderTexture()
 , m_pTextureCopy(0)
 , m_pUITextureImage(NULL)
 , m_ePixelFormat(kCCTexture2DPixelFormat_RGBA8888)
+, m_uDepthStencilFormat(0)
 , m_uClearFlags(0)
 , m_sClearColor(ccc4f(0,0,0,0))
 , m_fClearDepth(0.0f)
@@ -77,14 +272,37 @@ CCRenderTexture::CCRenderTexture()
 
 CCRenderTexture::~CCRenderTexture()
 {
-    CC_SAFE_RELEASE(m_pSprite);
-    CC_SAFE_RELEASE(m_pTextureCopy);
-    
-    glDeleteFramebuffers(1, &m_uFBO);
-    if (m_uDepthRenderBufffer)
+    // hand the target to the next render texture of this size.
+    // A texture that was saved for a lost GL context keeps its data
+    // in VolatileTexture, it is deleted instead.
+    if (m_pTexture && m_uFBO && !m_pUITextureImage)
+    {
+        ccRenderTarget target;
+        target.width = (int)m_pTexture->getContentSizeInPixels().width;
+        target.height = (int)m_pTexture->getContentSizeInPixels().height;
+        target.pixelFormat = m_ePixelFormat;
+        target.depthStencilFormat = m_uDepthStencilFormat;
+        target.texture = m_pTexture;
+        target.textureCopy = m_pTextureCopy;
+        target.fbo = m_uFBO;
+        target.depthRenderBuffer = m_uDepthRenderBufffer;
+        CCRenderTargetPool::sharedPool()->giveTarget(target);
+    }
+    else
     {
-        glDeleteRenderbuffers(1, &m_uDepthRenderBufffer);
+        if (m_pTexture)
+        {
+            CCRenderTargetPool::removeTarget();
+        }
+        glDeleteFramebuffers(1, &m_uFBO);
+        if (m_uDepthRenderBufffer)
+        {
+            glDeleteRenderbuffers(1, &m_uDepthRenderBufffer);
+        }
     }
+
+    CC_SAFE_RELEASE(m_pSprite);
+    CC_SAFE_RELEASE(m_pTextureCopy);
     CC_SAFE_DELETE(m_pUITextureImage);
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -93,6 +311,38 @@ CCRenderTexture::~CCRenderTexture()
 #endif
 }
 
+void CCRenderTexture::purgeRenderTargetPool()
+{
+    CCRenderTargetPool::purgeSharedPool();
+}
+
+unsigned int CCRenderTexture::getRenderTargetsInUse()
+{
+    return CCRenderTargetPool::s_uTargetsInUse;
+}
+
+unsigned int CCRenderTexture::getPeakRenderTargetsInUse()
+{
+    return CCRenderTargetPool::s_uPeakTargetsInUse;
+}
+
+unsigned int CCRenderTexture::getRenderTargetsCreated()
+{
+    return CCRenderTargetPool::s_uTargetsCreated;
+}
+
+unsigned int CCRenderTexture::getRenderTargetsReused()
+{
+    return CCRenderTargetPool::s_uTargetsReused;
+}
+
+void CCRenderTexture::resetRenderTargetStatistics()
+{
+    CCRenderTargetPool::s_uPeakTargetsInUse = CCRenderTargetPool::s_uTargetsInUse;
+    CCRenderTargetPool::s_uTargetsCreated = 0;
+    CCRenderTargetPool::s_uTargetsReused = 0;
+}
+
 void CCRenderTexture::listenToBackground(cocos2d::CCObject *obj)
 {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -261,76 +511,140 @@ bool CCRenderTexture::initWithWidthAndHeight(int w, int h, CCTexture2DPixelForma
 
         glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_nOldFBO);
 
-        // textures must be power of two squared
-        unsigned int powW = 0;
-        unsigned int powH = 0;
+        m_ePixelFormat = eFormat;
+        m_uDepthStencilFormat = uDepthStencilFormat;
 
-        if (CCConfiguration::sharedConfiguration()->supportsNPOT())
+        GLint oldRBO;
+        glGetIntegerv(GL_RENDERBUFFER_BINDING, &oldRBO);
+
+        ccRenderTarget target;
+        if (CCRenderTargetPool::sharedPool()->takeTarget(w, h, m_ePixelFormat, m_uDepthStencilFormat, &target))
         {
-            powW = w;
-            powH = h;
+            m_pTexture = target.texture;
+            m_pTextureCopy = target.textureCopy;
+            m_uFBO = target.fbo;
+            m_uDepthRenderBufffer = target.depthRenderBuffer;
+
+            // the attachments still hold what was drawn into them, clear them like new ones
+            glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
+            GLbitfield clearFlags = GL_COLOR_BUFFER_BIT;
+            GLfloat oldClearColor[4] = {0.0f};
+            GLfloat oldDepthClearValue = 0.0f;
+            GLint oldStencilClearValue = 0;
+            GLboolean oldDepthWriteMask = GL_TRUE;
+            GLint oldStencilWriteMask = 0;
+            GLboolean oldColorWriteMask[4] = {GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE};
+
+            glGetBooleanv(GL_COLOR_WRITEMASK, oldColorWriteMask);
+            glGetFloatv(GL_COLOR_CLEAR_VALUE, oldClearColor);
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+            if (m_uDepthRenderBufffer)
+            {
+                clearFlags |= GL_DEPTH_BUFFER_BIT;
+                glGetBooleanv(GL_DEPTH_WRITEMASK, &oldDepthWriteMask);
+                glGetFloatv(GL_DEPTH_CLEAR_VALUE, &oldDepthClearValue);
+                glDepthMask(GL_TRUE);
+                glClearDepth(1.0f);
+
+                if (m_uDepthStencilFormat == GL_DEPTH24_STENCIL8)
+                {
+                    clearFlags |= GL_STENCIL_BUFFER_BIT;
+                    glGetIntegerv(GL_STENCIL_WRITEMASK, &oldStencilWriteMask);
+                    glGetIntegerv(GL_STENCIL_CLEAR_VALUE, &oldStencilClearValue);
+                    glStencilMask(~0);
+                    glClearStencil(0);
+                    CCClippingNode::notifyStencilBufferWritten();
+                }
+            }
+
+            glClear(clearFlags);
+
+            glColorMask(oldColorWriteMask[0], oldColorWriteMask[1], oldColorWriteMask[2], oldColorWriteMask[3]);
+            glClearColor(oldClearColor[0], oldClearColor[1], oldClearColor[2], oldClearColor[3]);
+            if (clearFlags & GL_DEPTH_BUFFER_BIT)
+            {
+                glDepthMask(oldDepthWriteMask);
+                glClearDepth(oldDepthClearValue);
+            }
+            if (clearFlags & GL_STENCIL_BUFFER_BIT)
+            {
+                glStencilMask(oldStencilWriteMask);
+                glClearStencil(oldStencilClearValue);
+            }
         }
         else
         {
-            powW = ccNextPOT(w);
-            powH = ccNextPOT(h);
-        }
+            // textures must be power of two squared
+            unsigned int powW = 0;
+            unsigned int powH = 0;
 
-        data = malloc((int)(powW * powH * 4));
-        CC_BREAK_IF(! data);
+            if (CCConfiguration::sharedConfiguration()->supportsNPOT())
+            {
+                powW = w;
+                powH = h;
+            }
+            else
+            {
+                powW = ccNextPOT(w);
+                powH = ccNextPOT(h);
+            }
 
-        memset(data, 0, (int)(powW * powH * 4));
-        m_ePixelFormat = eFormat;
+            data = malloc((int)(powW * powH * 4));
+            CC_BREAK_IF(! data);
 
-        m_pTexture = new CCTexture2D();
-        if (m_pTexture)
-        {
-            m_pTexture->initWithData(data, (CCTexture2DPixelFormat)m_ePixelFormat, powW, powH, CCSizeMake((float)w, (float)h));
-        }
-        else
-        {
-            break;
-        }
-        GLint oldRBO;
-        glGetIntegerv(GL_RENDERBUFFER_BINDING, &oldRBO);
-        
-        if (CCConfiguration::sharedConfiguration()->checkForGLExtension("GL_QCOM"))
-        {
-            m_pTextureCopy = new CCTexture2D();
-            if (m_pTextureCopy)
+            memset(data, 0, (int)(powW * powH * 4));
+
+            m_pTexture = new CCTexture2D();
+            if (m_pTexture)
             {
-                m_pTextureCopy->initWithData(data, (CCTexture2DPixelFormat)m_ePixelFormat, powW, powH, CCSizeMake((float)w, (float)h));
+                m_pTexture->initWithData(data, (CCTexture2DPixelFormat)m_ePixelFormat, powW, powH, CCSizeMake((float)w, (float)h));
             }
             else
             {
                 break;
             }
-        }
+            if (CCConfiguration::sharedConfiguration()->checkForGLExtension("GL_QCOM"))
+            {
+                m_pTextureCopy = new CCTexture2D();
+                if (m_pTextureCopy)
+                {
+                    m_pTextureCopy->initWithData(data, (CCTexture2DPixelFormat)m_ePixelFormat, powW, powH, CCSizeMake((float)w, (float)h));
+                }
+                else
+                {
+                    break;
+                }
+            }
 
-        // generate FBO
-        glGenFramebuffers(1, &m_uFBO);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
+            // generate FBO
+            glGenFramebuffers(1, &m_uFBO);
+            glBindFramebuffer(GL_FRAMEBUFFER, m_uFBO);
 
-        // associate texture with FBO
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pTexture->getName(), 0);
+            // associate texture with FBO
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_pTexture->getName(), 0);
 
-        if (uDepthStencilFormat != 0)
-        {
-            //create and attach depth buffer
-            glGenRenderbuffers(1, &m_uDepthRenderBufffer);
-            glBindRenderbuffer(GL_RENDERBUFFER, m_uDepthRenderBufffer);
-            glRenderbufferStorage(GL_RENDERBUFFER, uDepthStencilFormat, (GLsizei)powW, (GLsizei)powH);
-            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_uDepthRenderBufffer);
-
-            // if depth format is the one with stencil part, bind same render buffer as stencil attachment
-            if (uDepthStencilFormat == GL_DEPTH24_STENCIL8)
+            if (uDepthStencilFormat != 0)
             {
-                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_uDepthRenderBufffer);
+                //create and attach depth buffer
+                glGenRenderbuffers(1, &m_uDepthRenderBufffer);
+                glBindRenderbuffer(GL_RENDERBUFFER, m_uDepthRenderBufffer);
+                glRenderbufferStorage(GL_RENDERBUFFER, uDepthStencilFormat, (GLsizei)powW, (GLsizei)powH);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_uDepthRenderBufffer);
+
+                // if depth format is the one with stencil part, bind same render buffer as stencil attachment
+                if (uDepthStencilFormat == GL_DEPTH24_STENCIL8)
+                {
+                    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_uDepthRenderBufffer);
+                }
             }
-        }
 
-        // check if it worked (probably worth doing :) )
-        CCAssert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Could not attach texture to framebuffer");
+            // check if it worked (probably worth doing :) )
+            CCAssert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Could not attach texture to framebuffer");
+
+            CCRenderTargetPool::sharedPool()->addCreatedTarget();
+        }
 
         m_pTexture->setAliasTexParameters();
 
@@ -450,6 +764,7 @@ void CCRenderTexture::beginWithClear(float r, float g, float b, float a, float d
     {
         glGetIntegerv(GL_STENCIL_CLEAR_VALUE, &stencilClearValue);
         glClearStencil(stencilValue);
+        CCClippingNode::notifyStencilBufferWritten();
     }
     
     glClear(flags);
@@ -513,6 +828,7 @@ void CCRenderTexture::clearStencil(int stencilValue)
 
     glClearStencil(stencilValue);
     glClear(GL_STENCIL_BUFFER_BIT);
+    CCClippingNode::notifyStencilBufferWritten();
 
     // restore clear color
     glClearStencil(stencilClearValue);
@@ -578,6 +894,7 @@ void CCRenderTexture::draw()
             {
 				glGetIntegerv(GL_STENCIL_CLEAR_VALUE, &oldStencilClearValue);
 				glClearStencil(m_nClearStencil);
+				CCClippingNode::notifyStencilBufferWritten();
 			}
 			
 			// clear
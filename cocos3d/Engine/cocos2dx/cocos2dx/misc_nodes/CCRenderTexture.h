@@ -82,6 +82,23 @@ public:
     /** creates a RenderTexture object with width and height in Points, pixel format is RGBA8888 */
     static CCRenderTexture * create(int w, int h);
 
+    /** Deletes the textures and framebuffers kept for reuse.
+     The render targets of deleted render textures are kept for a few frames, and given to
+     the next render texture of the same size and formats. The pool itself is released
+     here, which CCDirector::purgeCachedData() and the end of the director also do.
+     */
+    static void purgeRenderTargetPool();
+
+    /** Number of render targets used by render textures, and the peak of it since the last reset. */
+    static unsigned int getRenderTargetsInUse();
+    static unsigned int getPeakRenderTargetsInUse();
+
+    /** Number of render targets created with new GL objects, and taken from the pool. */
+    static unsigned int getRenderTargetsCreated();
+    static unsigned int getRenderTargetsReused();
+
+    static void resetRenderTargetStatistics();
+
     /** initializes a RenderTexture object with width and height in Points and a pixel format, only RGB and RGBA formats are valid */
     bool initWithWidthAndHeight(int w, int h, CCTexture2DPixelFormat eFormat);
 
@@ -175,6 +192,7 @@ protected:
     CCTexture2D* m_pTextureCopy;    // a copy of m_pTexture
     CCImage*     m_pUITextureImage;
     GLenum       m_ePixelFormat;
+    GLuint       m_uDepthStencilFormat;
     
     // code for "auto" update
     GLbitfield   m_uClearFlags;
@@ -25,65 +25,425 @@
 #include "CCSAXParser.h"
 #include "cocoa/CCDictionary.h"
 #include "CCFileUtils.h"
-#include "support/tinyxml2/tinyxml2.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <string>
 #include <vector> // because its based on windows 8 build :P
 
 NS_CC_BEGIN
 
-class XmlSaxHander : public tinyxml2::XMLVisitor
+static inline bool isXmlWhiteSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool isXmlNameEnd(char c)
+{
+    return isXmlWhiteSpace(c) || c == '/' || c == '>' || c == '=';
+}
+
+static inline bool startsWith(const char* p, const char* end, const char* prefix, size_t len)
+{
+    return (size_t)(end - p) >= len && memcmp(p, prefix, len) == 0;
+}
+
+static char* findSequence(char* p, char* end, const char* seq, size_t len)
+{
+    while ((size_t)(end - p) >= len)
+    {
+        char* c = (char*)memchr(p, seq[0], end - p - len + 1);
+        if (!c)
+        {
+            return NULL;
+        }
+        if (memcmp(c, seq, len) == 0)
+        {
+            return c;
+        }
+        p = c + 1;
+    }
+    return NULL;
+}
+
+// Returns whether the span contains anything that decodeInPlace would change
+static bool needsDecoding(const char* p, const char* end, bool bEntities)
+{
+    for (; p < end; ++p)
+    {
+        if (*p == '\r' || (bEntities && *p == '&'))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static char* encodeUTF8(unsigned long cp, char* out)
+{
+    if (cp < 0x80)
+    {
+        *out++ = (char)cp;
+    }
+    else if (cp < 0x800)
+    {
+        *out++ = (char)(0xC0 | (cp >> 6));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        *out++ = (char)(0xE0 | (cp >> 12));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        *out++ = (char)(0xF0 | (cp >> 18));
+        *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+// Decodes one entity starting at the '&', writing the result to out. Returns the character after the
+// entity, or NULL if it is not one recognised by XML, in which case it is kept as it is. A decoded
+// entity is never longer than its reference, so the output never overtakes the input.
+static char* decodeEntity(char* p, char* end, char** out)
+{
+    static const struct { const char* ref; size_t len; char value; } s_entities[] = {
+        { "&amp;", 5, '&' }, { "&lt;", 4, '<' }, { "&gt;", 4, '>' }, { "&quot;", 6, '"' }, { "&apos;", 6, '\'' }
+    };
+
+    if (startsWith(p, end, "&#", 2))
+    {
+        char* q = p + 2;
+        int base = 10;
+        if (q < end && (*q == 'x' || *q == 'X'))
+        {
+            base = 16;
+            ++q;
+        }
+        unsigned long cp = 0;
+        char* digits = q;
+        for (; q < end && *q != ';'; ++q)
+        {
+            int d = (*q >= '0' && *q <= '9') ? *q - '0'
+                  : (base == 16 && *q >= 'a' && *q <= 'f') ? *q - 'a' + 10
+                  : (base == 16 && *q >= 'A' && *q <= 'F') ? *q - 'A' + 10 : -1;
+            if (d < 0 || cp > 0x10FFFF)
+            {
+                return NULL;
+            }
+            cp = cp * base + d;
+        }
+        if (q >= end || q == digits || cp > 0x10FFFF)
+        {
+            return NULL;
+        }
+        *out = encodeUTF8(cp, *out);
+        return q + 1;
+    }
+
+    for (size_t i = 0; i < sizeof(s_entities) / sizeof(s_entities[0]); ++i)
+    {
+        if (startsWith(p, end, s_entities[i].ref, s_entities[i].len))
+        {
+            *(*out)++ = s_entities[i].value;
+            return p + s_entities[i].len;
+        }
+    }
+    return NULL;
+}
+
+// Decodes entities and normalizes line endings to '\n' in place, returning the new end of the span
+static char* decodeInPlace(char* p, char* end, bool bEntities)
+{
+    char* out = p;
+    while (p < end)
+    {
+        if (*p == '\r')
+        {
+            *out++ = '\n';
+            if (++p < end && *p == '\n')
+            {
+                ++p;
+            }
+        }
+        else if (bEntities && *p == '&')
+        {
+            char* next = decodeEntity(p, end, &out);
+            if (next)
+            {
+                p = next;
+            }
+            else
+            {
+                *out++ = *p++;
+            }
+        }
+        else
+        {
+            *out++ = *p++;
+        }
+    }
+    return out;
+}
+
+/**
+ * A streaming XML tokenizer that works in place on a mutable buffer, and reports each element
+ * and text run to the CCSAXParser callbacks as soon as it is read.
+ *
+ * Names, attribute values and text are terminated in place and passed on as pointers into the
+ * buffer. Entities and line endings are only decoded in the spans that contain them. The only
+ * memory used is the stack of open element names and the attribute list of the current element,
+ * which are reused from one element to the next.
+ *
+ * Whitespace before a node is skipped, and comments, declarations and DTDs are ignored, so the
+ * callbacks match those previously produced by replaying a tinyxml2 document.
+ */
+class XmlSaxTokenizer
 {
 public:
-	XmlSaxHander():m_ccsaxParserImp(0){};
-	
-	virtual bool VisitEnter( const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* firstAttribute );
-	virtual bool VisitExit( const tinyxml2::XMLElement& element );
-	virtual bool Visit( const tinyxml2::XMLText& text );
-	virtual bool Visit( const tinyxml2::XMLUnknown&){ return true; }
-
-	void setCCSAXParserImp(CCSAXParser* parser)
-	{
-		m_ccsaxParserImp = parser;
-	}
+    XmlSaxTokenizer(CCSAXParser* parser) : m_pParser(parser), m_pBufferEnd(NULL) {}
+
+    bool parse(char* p, char* end);
 
 private:
-	CCSAXParser *m_ccsaxParserImp;
+    char* parseElement(char* p, char* end);
+    char* parseEndElement(char* p, char* end);
+    void deliverText(char* p, char* end, bool bEntities);
+
+    CCSAXParser* m_pParser;
+    char* m_pBufferEnd;
+    std::vector<const char*> m_openElements;
+    std::vector<const char*> m_atts;
 };
 
+bool XmlSaxTokenizer::parse(char* p, char* end)
+{
+    m_pBufferEnd = end;
+
+    // skip the UTF-8 byte order mark
+    if (startsWith(p, end, "\xEF\xBB\xBF", 3))
+    {
+        p += 3;
+    }
 
-bool XmlSaxHander::VisitEnter( const tinyxml2::XMLElement& element, const tinyxml2::XMLAttribute* firstAttribute )
+    while (p)
+    {
+        char* start = p;
+        while (p < end && isXmlWhiteSpace(*p))
+        {
+            ++p;
+        }
+        if (p >= end)
+        {
+            break;
+        }
+
+        if (*p != '<')
+        {
+            // text keeps its leading whitespace and runs up to the next tag, or to the end of the
+            // data for character data trailing the last tag, e.g. "<a>text</a>trailing"
+            p = (char*)memchr(p, '<', end - p);
+            if (!p)
+            {
+                p = end;
+            }
+            deliverText(start, p, true);
+        }
+        else if (startsWith(p, end, "<!--", 4))
+        {
+            p = findSequence(p + 4, end, "-->", 3);
+            p = p ? p + 3 : NULL;
+        }
+        else if (startsWith(p, end, "<![CDATA[", 9))
+        {
+            char* close = findSequence(p + 9, end, "]]>", 3);
+            if (close)
+            {
+                deliverText(p + 9, close, false);
+            }
+            p = close ? close + 3 : NULL;
+        }
+        else if (startsWith(p, end, "<?", 2))
+        {
+            p = findSequence(p + 2, end, "?>", 2);
+            p = p ? p + 2 : NULL;
+        }
+        else if (startsWith(p, end, "<!", 2))
+        {
+            p = (char*)memchr(p + 2, '>', end - p - 2);
+            p = p ? p + 1 : NULL;
+        }
+        else if (startsWith(p, end, "</", 2))
+        {
+            p = parseEndElement(p + 2, end);
+        }
+        else
+        {
+            p = parseElement(p + 1, end);
+        }
+    }
+
+    return p != NULL && m_openElements.empty();
+}
+
+char* XmlSaxTokenizer::parseElement(char* p, char* end)
 {
-	//CCLog(" VisitEnter %s",element.Value());
+    char* name = p;
+    while (p < end && !isXmlNameEnd(*p))
+    {
+        ++p;
+    }
+    if (p >= end || p == name || *p == '=')
+    {
+        return NULL;
+    }
+
+    char term = *p;
+    *p++ = '\0';
+    bool bSelfClosing = false;
+    m_atts.clear();
 
-	std::vector<const char*> attsVector;
-	for( const tinyxml2::XMLAttribute* attrib = firstAttribute; attrib; attrib = attrib->Next() )
-	{
-		//CCLog("%s", attrib->Name());
-		attsVector.push_back(attrib->Name());
-		//CCLog("%s",attrib->Value());
-		attsVector.push_back(attrib->Value());
-	}
-    
-    // nullptr is used in c++11
-	//attsVector.push_back(nullptr);
-    attsVector.push_back(NULL);
+    if (term == '/')
+    {
+        if (p >= end || *p != '>')
+        {
+            return NULL;
+        }
+        ++p;
+        bSelfClosing = true;
+    }
+    else if (term != '>')
+    {
+        // attributes
+        for (;;)
+        {
+            while (p < end && isXmlWhiteSpace(*p))
+            {
+                ++p;
+            }
+            if (p >= end)
+            {
+                return NULL;
+            }
+            if (*p == '>')
+            {
+                ++p;
+                break;
+            }
+            if (*p == '/')
+            {
+                if (p + 1 >= end || p[1] != '>')
+                {
+                    return NULL;
+                }
+                p += 2;
+                bSelfClosing = true;
+                break;
+            }
 
-	CCSAXParser::startElement(m_ccsaxParserImp, (const CC_XML_CHAR *)element.Value(), (const CC_XML_CHAR **)(&attsVector[0]));
-	return true;
+            char* attName = p;
+            while (p < end && !isXmlNameEnd(*p))
+            {
+                ++p;
+            }
+            char* attNameEnd = p;
+            while (p < end && isXmlWhiteSpace(*p))
+            {
+                ++p;
+            }
+            if (attNameEnd == attName || p >= end || *p != '=')
+            {
+                return NULL;
+            }
+            *attNameEnd = '\0';
+
+            ++p;
+            while (p < end && isXmlWhiteSpace(*p))
+            {
+                ++p;
+            }
+            if (p >= end || (*p != '"' && *p != '\''))
+            {
+                return NULL;
+            }
+            char* value = ++p;
+            char* close = (char*)memchr(p, p[-1], end - p);
+            if (!close)
+            {
+                return NULL;
+            }
+            char* valueEnd = needsDecoding(value, close, true) ? decodeInPlace(value, close, true) : close;
+            *valueEnd = '\0';
+            p = close + 1;
+
+            m_atts.push_back(attName);
+            m_atts.push_back(value);
+        }
+    }
+
+    m_atts.push_back(NULL);
+    CCSAXParser::startElement(m_pParser, (const CC_XML_CHAR *)name, (const CC_XML_CHAR **)(&m_atts[0]));
+
+    if (bSelfClosing)
+    {
+        CCSAXParser::endElement(m_pParser, (const CC_XML_CHAR *)name);
+    }
+    else
+    {
+        m_openElements.push_back(name);
+    }
+    return p;
 }
-bool XmlSaxHander::VisitExit( const tinyxml2::XMLElement& element )
+
+char* XmlSaxTokenizer::parseEndElement(char* p, char* end)
 {
-	//CCLog("VisitExit %s",element.Value());
+    char* name = p;
+    while (p < end && !isXmlNameEnd(*p))
+    {
+        ++p;
+    }
+    size_t len = p - name;
+    while (p < end && isXmlWhiteSpace(*p))
+    {
+        ++p;
+    }
+    if (p >= end || *p != '>' || m_openElements.empty())
+    {
+        return NULL;
+    }
+
+    // the open name was already terminated in place, so it can be reported as is
+    const char* openName = m_openElements.back();
+    if (strncmp(openName, name, len) != 0 || openName[len] != '\0')
+    {
+        return NULL;
+    }
+    m_openElements.pop_back();
 
-	CCSAXParser::endElement(m_ccsaxParserImp, (const CC_XML_CHAR *)element.Value());
-	return true;
+    CCSAXParser::endElement(m_pParser, (const CC_XML_CHAR *)openName);
+    return p + 1;
 }
 
-bool XmlSaxHander::Visit( const tinyxml2::XMLText& text )
+void XmlSaxTokenizer::deliverText(char* p, char* end, bool bEntities)
 {
-	//CCLog("Visit %s",text.Value());
-	CCSAXParser::textHandler(m_ccsaxParserImp, (const CC_XML_CHAR *)text.Value(), strlen(text.Value()));
-	return true;
+    // A run followed by a tag or CDATA terminator is terminated over the first character after
+    // it, which is put back once the delegator has seen the text. Trailing text that reaches the
+    // end of the buffer has no such character, so it is passed on as a copy.
+    char* textEnd = needsDecoding(p, end, bEntities) ? decodeInPlace(p, end, bEntities) : end;
+    if (textEnd == m_pBufferEnd)
+    {
+        std::string text(p, textEnd - p);
+        CCSAXParser::textHandler(m_pParser, (const CC_XML_CHAR *)text.c_str(), (int)text.length());
+        return;
+    }
+    char saved = *textEnd;
+    *textEnd = '\0';
+    CCSAXParser::textHandler(m_pParser, (const CC_XML_CHAR *)p, (int)(textEnd - p));
+    *textEnd = saved;
 }
 
 CCSAXParser::CCSAXParser()
@@ -104,12 +464,11 @@ bool CCSAXParser::init(const char *pszEncoding)
 
 bool CCSAXParser::parse(const char* pXMLData, unsigned int uDataLength)
 {
-	tinyxml2::XMLDocument tinyDoc;
-	tinyDoc.Parse(pXMLData, uDataLength);
-	XmlSaxHander printer;
-	printer.setCCSAXParserImp(this);
-	
-	return tinyDoc.Accept( &printer );	
+    char* pBuffer = new char[uDataLength];
+    memcpy(pBuffer, pXMLData, uDataLength);
+    bool bRet = parseInPlace(pBuffer, uDataLength);
+    CC_SAFE_DELETE_ARRAY(pBuffer);
+    return bRet;
 }
 
 bool CCSAXParser::parse(const char *pszFile)
@@ -119,12 +478,47 @@ bool CCSAXParser::parse(const char *pszFile)
     char* pBuffer = (char*)CCFileUtils::sharedFileUtils()->getFileData(pszFile, "rt", &size);
     if (pBuffer != NULL && size > 0)
     {
-        bRet = parse(pBuffer, size);
+        // the loaded buffer is private to this call, so it can be tokenized without a copy
+        bRet = parseInPlace(pBuffer, size);
     }
     CC_SAFE_DELETE_ARRAY(pBuffer);
     return bRet;
 }
 
+bool CCSAXParser::parseInPlace(char* pXMLData, unsigned int uDataLength)
+{
+    CCAssert(pXMLData != NULL || uDataLength == 0, "CCSAXParser: data must not be NULL");
+    XmlSaxTokenizer tokenizer(this);
+    return tokenizer.parse(pXMLData, pXMLData + uDataLength);
+}
+
+const char* CCSAXParser::getAttribute(const char **atts, const char *name)
+{
+    if (atts != NULL)
+    {
+        for (int i = 0; atts[i] != NULL; i += 2)
+        {
+            if (strcmp(atts[i], name) == 0)
+            {
+                return atts[i + 1];
+            }
+        }
+    }
+    return NULL;
+}
+
+int CCSAXParser::getIntAttribute(const char **atts, const char *name, int defaultValue)
+{
+    const char* value = getAttribute(atts, name);
+    return value ? (int)strtol(value, NULL, 10) : defaultValue;
+}
+
+float CCSAXParser::getFloatAttribute(const char **atts, const char *name, float defaultValue)
+{
+    const char* value = getAttribute(atts, name);
+    return value ? (float)strtod(value, NULL) : defaultValue;
+}
+
 void CCSAXParser::startElement(void *ctx, const CC_XML_CHAR *name, const CC_XML_CHAR **atts)
 {
     ((CCSAXParser*)(ctx))->m_pDelegator->startElement(ctx, (char*)name, (const char**)atts);
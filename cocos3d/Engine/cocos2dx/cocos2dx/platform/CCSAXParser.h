@@ -61,10 +61,29 @@ public:
     ~CCSAXParser(void);
 
     bool init(const char *pszEncoding);
+    /** Parses a copy of the specified data, leaving the data itself untouched. */
     bool parse(const char* pXMLData, unsigned int uDataLength);
     bool parse(const char *pszFile);
+    /**
+     * Parses the specified data in a single streaming pass, without building a document tree.
+     *
+     * The buffer must be writable, such as a loaded file or a private memory mapping, because
+     * names, attribute values and text are decoded and terminated in place, and handed to the
+     * delegator as pointers into the buffer. Those pointers are only valid during the callback.
+     * Apart from the buffer, memory use is bounded by the nesting depth and attribute count.
+     *
+     * Returns false if the data is not well-formed, after delivering the callbacks up to the error.
+     */
+    bool parseInPlace(char* pXMLData, unsigned int uDataLength);
     void setDelegator(CCSAXDelegator* pDelegator);
 
+    /** Returns the value of the named attribute in the attributes passed to startElement, or NULL if there is none. */
+    static const char* getAttribute(const char **atts, const char *name);
+    /** Returns the named attribute parsed as an integer, or the default value if there is no such attribute. */
+    static int getIntAttribute(const char **atts, const char *name, int defaultValue = 0);
+    /** Returns the named attribute parsed as a float, or the default value if there is no such attribute. */
+    static float getFloatAttribute(const char **atts, const char *name, float defaultValue = 0.0f);
+
     static void startElement(void *ctx, const CC_XML_CHAR *name, const CC_XML_CHAR **atts);
     static void endElement(void *ctx, const CC_XML_CHAR *name);
     static void textHandler(void *ctx, const CC_XML_CHAR *name, int len);
@@ -116,6 +116,8 @@ bool CCSpriteBatchNode::initWithFile(const char* fileImage, unsigned int capacit
 CCSpriteBatchNode::CCSpriteBatchNode()
 : m_pobTextureAtlas(NULL)
 , m_pobDescendants(NULL)
+, m_bUsesSlotStorage(false)
+, m_fSlotCompactionThreshold(0.5f)
 {
 }
 
@@ -273,18 +275,27 @@ void CCSpriteBatchNode::sortAllChildren()
             //first sort all children recursively based on zOrder
             arrayMakeObjectsPerformSelector(m_pChildren, sortAllChildren, CCSprite*);
 
-            int index=0;
-
-            CCObject* pObj = NULL;
-            //fast dispatch, give every child a new atlasIndex based on their relative zOrder (keep parent -> child relations intact)
-            // and at the same time reorder descendants and the quads to the right index
-            CCARRAY_FOREACH(m_pChildren, pObj)
+            if (! m_bUsesSlotStorage)
             {
-                CCSprite* pChild = (CCSprite*)pObj;
-                updateAtlasIndex(pChild, &index);
+                int index=0;
+
+                CCObject* pObj = NULL;
+                //fast dispatch, give every child a new atlasIndex based on their relative zOrder (keep parent -> child relations intact)
+                // and at the same time reorder descendants and the quads to the right index
+                CCARRAY_FOREACH(m_pChildren, pObj)
+                {
+                    CCSprite* pChild = (CCSprite*)pObj;
+                    updateAtlasIndex(pChild, &index);
+                }
             }
         }
 
+        // the quads stay in their slots, only the drawing order is rebuilt
+        if (m_bUsesSlotStorage)
+        {
+            updateSlotOrder();
+        }
+
         m_bReorderChildDirty=false;
     }
 }
@@ -362,6 +373,70 @@ void CCSpriteBatchNode::updateAtlasIndex(CCSprite* sprite, int* curIndex)
     }
 }
 
+// Collects the slots in the same order that updateAtlasIndex assigns atlas indices,
+// hands them to the texture atlas, and compacts the slots once too many have been freed.
+void CCSpriteBatchNode::updateSlotOrder()
+{
+    m_slotOrderSprites.clear();
+
+    CCObject* pObj = NULL;
+    CCARRAY_FOREACH(m_pChildren, pObj)
+    {
+        appendSlotOrder((CCSprite*)pObj);
+    }
+
+    unsigned int count = (unsigned int)m_slotOrderSprites.size();
+    m_slotOrder.resize(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        m_slotOrder[i] = m_slotOrderSprites[i]->getAtlasIndex();
+    }
+    m_pobTextureAtlas->setDrawOrder(count > 0 ? &m_slotOrder[0] : NULL, count);
+
+    // don't bother compacting small batches, where a few frees make up a large fraction
+    unsigned int freeCount = m_pobTextureAtlas->getFreeSlotCount();
+    if (freeCount >= 32 && freeCount > m_pobTextureAtlas->getTotalQuads() * m_fSlotCompactionThreshold)
+    {
+        m_pobTextureAtlas->compactSlots();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            m_slotOrderSprites[i]->setAtlasIndex(i);
+        }
+    }
+}
+
+void CCSpriteBatchNode::appendSlotOrder(CCSprite* sprite)
+{
+    bool bAppended = false;
+
+    // children with negative z are drawn before their parent, the others after it
+    CCObject* pObj = NULL;
+    CCARRAY_FOREACH(sprite->getChildren(), pObj)
+    {
+        CCSprite* child = (CCSprite*)pObj;
+        if (! bAppended && child->getZOrder() >= 0)
+        {
+            m_slotOrderSprites.push_back(sprite);
+            bAppended = true;
+        }
+        appendSlotOrder(child);
+    }
+
+    if (! bAppended)
+    {
+        m_slotOrderSprites.push_back(sprite);
+    }
+    sprite->setOrderOfArrival(0);
+}
+
+void CCSpriteBatchNode::setUsesSlotStorage(bool bUsesSlotStorage)
+{
+    CCAssert(m_pobDescendants->count() == 0, "CCSpriteBatchNode: the quad storage can only be changed while the batch node is empty");
+
+    m_bUsesSlotStorage = bUsesSlotStorage;
+    m_pobTextureAtlas->setUsesSlots(bUsesSlotStorage);
+}
+
 void CCSpriteBatchNode::swap(int oldIndex, int newIndex)
 {
     CCObject** x = m_pobDescendants->data->arr;
@@ -557,6 +632,13 @@ unsigned int CCSpriteBatchNode::atlasIndexForChild(CCSprite *pobSprite, int nZ)
 
 void CCSpriteBatchNode::insertChild(CCSprite *pSprite, unsigned int uIndex)
 {
+    // the drawing order is rebuilt from the tree, so the position is not needed
+    if (m_bUsesSlotStorage)
+    {
+        appendChild(pSprite);
+        return;
+    }
+
     pSprite->setBatchNode(this);
     pSprite->setAtlasIndex(uIndex);
     pSprite->setDirty(true);
@@ -599,20 +681,38 @@ void CCSpriteBatchNode::appendChild(CCSprite* sprite)
     sprite->setBatchNode(this);
     sprite->setDirty(true);
 
-    if(m_pobTextureAtlas->getTotalQuads() == m_pobTextureAtlas->getCapacity()) {
-        increaseAtlasCapacity();
+    if (m_bUsesSlotStorage)
+    {
+        if (! m_pobTextureAtlas->hasFreeSlot())
+        {
+            increaseAtlasCapacity();
+        }
+
+        ccArrayAppendObjectWithResize(m_pobDescendants->data, sprite);
+
+        unsigned int slot = m_pobTextureAtlas->allocateSlot();
+        sprite->setAtlasIndex(slot);
+
+        ccV3F_C4B_T2F_Quad quad = sprite->getQuad();
+        m_pobTextureAtlas->updateQuad(&quad, slot);
     }
+    else
+    {
+        if(m_pobTextureAtlas->getTotalQuads() == m_pobTextureAtlas->getCapacity()) {
+            increaseAtlasCapacity();
+        }
 
-    ccArray *descendantsData = m_pobDescendants->data;
+        ccArray *descendantsData = m_pobDescendants->data;
 
-    ccArrayAppendObjectWithResize(descendantsData, sprite);
+        ccArrayAppendObjectWithResize(descendantsData, sprite);
 
-    unsigned int index=descendantsData->num-1;
+        unsigned int index=descendantsData->num-1;
 
-    sprite->setAtlasIndex(index);
+        sprite->setAtlasIndex(index);
 
-    ccV3F_C4B_T2F_Quad quad = sprite->getQuad();
-    m_pobTextureAtlas->insertQuad(&quad, index);
+        ccV3F_C4B_T2F_Quad quad = sprite->getQuad();
+        m_pobTextureAtlas->insertQuad(&quad, index);
+    }
 
     // add children recursively
     
@@ -626,24 +726,40 @@ void CCSpriteBatchNode::appendChild(CCSprite* sprite)
 
 void CCSpriteBatchNode::removeSpriteFromAtlas(CCSprite *pobSprite)
 {
-    // remove from TextureAtlas
-    m_pobTextureAtlas->removeQuadAtIndex(pobSprite->getAtlasIndex());
-
-    // Cleanup sprite. It might be reused (issue #569)
-    pobSprite->setBatchNode(NULL);
+    if (m_bUsesSlotStorage)
+    {
+        // leave a hole in the slot, and let the next sort drop it from the drawing order
+        m_pobTextureAtlas->freeSlot(pobSprite->getAtlasIndex());
+        pobSprite->setBatchNode(NULL);
 
-    unsigned int uIndex = m_pobDescendants->indexOfObject(pobSprite);
-    if (uIndex != UINT_MAX)
+        unsigned int uIndex = m_pobDescendants->indexOfObject(pobSprite);
+        if (uIndex != UINT_MAX)
+        {
+            m_pobDescendants->fastRemoveObjectAtIndex(uIndex);
+        }
+        m_bReorderChildDirty = true;
+    }
+    else
     {
-        m_pobDescendants->removeObjectAtIndex(uIndex);
+        // remove from TextureAtlas
+        m_pobTextureAtlas->removeQuadAtIndex(pobSprite->getAtlasIndex());
 
-        // update all sprites beyond this one
-        unsigned int count = m_pobDescendants->count();
-        
-        for(; uIndex < count; ++uIndex)
+        // Cleanup sprite. It might be reused (issue #569)
+        pobSprite->setBatchNode(NULL);
+
+        unsigned int uIndex = m_pobDescendants->indexOfObject(pobSprite);
+        if (uIndex != UINT_MAX)
         {
-            CCSprite* s = (CCSprite*)(m_pobDescendants->objectAtIndex(uIndex));
-            s->setAtlasIndex( s->getAtlasIndex() - 1 );
+            m_pobDescendants->removeObjectAtIndex(uIndex);
+
+            // update all sprites beyond this one
+            unsigned int count = m_pobDescendants->count();
+            
+            for(; uIndex < count; ++uIndex)
+            {
+                CCSprite* s = (CCSprite*)(m_pobDescendants->objectAtIndex(uIndex));
+                s->setAtlasIndex( s->getAtlasIndex() - 1 );
+            }
         }
     }
 
@@ -700,6 +816,7 @@ void CCSpriteBatchNode::setTexture(CCTexture2D *texture)
 
 void CCSpriteBatchNode::insertQuadFromSprite(CCSprite *sprite, unsigned int index)
 {
+    CCAssert( !m_bUsesSlotStorage, "Quad-level access is not available with slot storage");
     CCAssert( sprite != NULL, "Argument must be non-NULL");
     CCAssert( dynamic_cast<CCSprite*>(sprite), "CCSpriteBatchNode only supports CCSprites as children");
 
@@ -725,6 +842,7 @@ void CCSpriteBatchNode::insertQuadFromSprite(CCSprite *sprite, unsigned int inde
 
 void CCSpriteBatchNode::updateQuadFromSprite(CCSprite *sprite, unsigned int index)
 {
+    CCAssert( !m_bUsesSlotStorage, "Quad-level access is not available with slot storage");
     CCAssert(sprite != NULL, "Argument must be non-nil");
     CCAssert(dynamic_cast<CCSprite*>(sprite) != NULL, "CCSpriteBatchNode only supports CCSprites as children");
     
@@ -748,6 +866,7 @@ void CCSpriteBatchNode::updateQuadFromSprite(CCSprite *sprite, unsigned int inde
 
 CCSpriteBatchNode * CCSpriteBatchNode::addSpriteWithoutQuad(CCSprite*child, unsigned int z, int aTag)
 {
+    CCAssert( !m_bUsesSlotStorage, "Quad-level access is not available with slot storage");
     CCAssert( child != NULL, "Argument must be non-NULL");
     CCAssert( dynamic_cast<CCSprite*>(child), "CCSpriteBatchNode only supports CCSprites as children");
 
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "textures/CCTextureAtlas.h"
 #include "ccMacros.h"
 #include "cocoa/CCArray.h"
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -134,6 +135,30 @@ public:
     unsigned int atlasIndexForChild(CCSprite *sprite, int z);
     /* Sprites use this to start sortChildren, don't call this manually */
     void reorderBatch(bool reorder);
+
+    /** Switches the batch node to slot storage, suited to batches where many sprites are added
+    and removed every frame.
+
+    By default, adding or removing a sprite moves every quad after it in the texture atlas and
+    renumbers the atlas index of every following sprite. With slot storage, each sprite keeps the
+    atlas slot it was given when added, removed sprites leave a zero-area quad in a slot that is
+    reused by the next sprite added, and the z-order is applied by rewriting the changed entries
+    of the index buffer when the children are next sorted. Only the quads and indices that changed
+    are uploaded. The slots are compacted when the fraction of freed slots passes the compaction
+    threshold.
+
+    With slot storage, the atlas index of a sprite is its slot rather than its drawing position,
+    the descendants array is not kept in drawing order, and the quad-level methods used by tile
+    maps and labels are not available.
+
+    This can only be changed while the batch node has no children.
+    */
+    void setUsesSlotStorage(bool bUsesSlotStorage);
+    inline bool isUsingSlotStorage(void) { return m_bUsesSlotStorage; }
+
+    /** The fraction of freed slots above which slot storage is compacted. The default is 0.5. */
+    inline float getSlotCompactionThreshold(void) { return m_fSlotCompactionThreshold; }
+    inline void setSlotCompactionThreshold(float fThreshold) { m_fSlotCompactionThreshold = fThreshold; }
     // CCTextureProtocol
     virtual CCTexture2D* getTexture(void);
     virtual void setTexture(CCTexture2D *texture);
@@ -172,6 +197,8 @@ protected:
 
 private:
     void updateAtlasIndex(CCSprite* sprite, int* curIndex);
+    void updateSlotOrder();
+    void appendSlotOrder(CCSprite* sprite);
     void swap(int oldIndex, int newIndex);
     void updateBlendFunc();
 
@@ -181,6 +208,12 @@ protected:
 
     // all descendants: children, gran children, etc...
     CCArray* m_pobDescendants;
+
+    bool m_bUsesSlotStorage;
+    float m_fSlotCompactionThreshold;
+    // scratch buffers for the drawing order under slot storage
+    std::vector<CCSprite*> m_slotOrderSprites;
+    std::vector<unsigned int> m_slotOrder;
 };
 
 // end of sprite_nodes group
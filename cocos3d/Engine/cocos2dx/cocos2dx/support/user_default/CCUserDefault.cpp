@@ -28,111 +28,613 @@ THE SOFTWARE.
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS && CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
 
-// root name of xml
-#define USERDEFAULT_ROOT_NAME    "userDefaultRoot"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT) || (CC_TARGET_PLATFORM == CC_PLATFORM_WP8)
+#include <io.h>
+#define fsyncFile(fp)   _commit(_fileno(fp))
+#else
+#include <unistd.h>
+#define fsyncFile(fp)   fsync(fileno(fp))
+#endif
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+#include <pthread.h>
+#else
+#include "CCPThreadWinRT.h"
+#endif
+
+// Compaction runs on a background thread where the platform has threads
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8) && !defined(EMSCRIPTEN)
+#define USERDEFAULT_ASYNC_COMPACTION 1
+#else
+#define USERDEFAULT_ASYNC_COMPACTION 0
+#endif
 
 #define XML_FILE_NAME "UserDefault.xml"
 
+// the snapshot of all values, and the journal of the values set since it was written
+#define SNAPSHOT_FILE_NAME          "UserDefault.bin"
+#define JOURNAL_FILE_NAME           "UserDefault.journal"
+
+#define SNAPSHOT_MAGIC              0x44554343  // "CCUD"
+#define SNAPSHOT_VERSION            1
+#define JOURNAL_RECORD_SET          1
+
+// the journal is compacted once it outgrows both this and twice the snapshot
+#define JOURNAL_COMPACTION_BYTES    (64 * 1024)
+
 using namespace std;
 
 NS_CC_BEGIN
 
+static unsigned int hashBytes(const char* pData, size_t length, unsigned int hash = 2166136261u)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)pData[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void appendUInt(std::string& out, unsigned int value)
+{
+    char bytes[4] = { (char)(value & 0xFF), (char)((value >> 8) & 0xFF), (char)((value >> 16) & 0xFF), (char)(value >> 24) };
+    out.append(bytes, 4);
+}
+
+static bool readUInt(const char*& p, const char* end, unsigned int& value)
+{
+    if (end - p < 4)
+    {
+        return false;
+    }
+    const unsigned char* b = (const unsigned char*)p;
+    value = b[0] | (b[1] << 8) | (b[2] << 16) | ((unsigned int)b[3] << 24);
+    p += 4;
+    return true;
+}
+
+static bool readString(const char*& p, const char* end, unsigned int length, std::string& value)
+{
+    if ((size_t)(end - p) < length)
+    {
+        return false;
+    }
+    value.assign(p, length);
+    p += length;
+    return true;
+}
+
+static bool readFile(const std::string& path, std::string& contents)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp)
+    {
+        return false;
+    }
+    char buffer[16 * 1024];
+    size_t n;
+    contents.clear();
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        contents.append(buffer, n);
+    }
+    fclose(fp);
+    return true;
+}
+
+static bool isFileExist(const std::string& path)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp)
+    {
+        fclose(fp);
+    }
+    return fp != NULL;
+}
+
+struct UserDefaultEntry
+{
+    std::string key;
+    std::string value;
+    unsigned int hash;
+};
+
 /**
- * define the functions here because we don't want to
- * export xmlNodePtr and other types in "CCUserDefault.h"
+ * The values of CCUserDefault, held in a hash table that is loaded once, and persisted through
+ * an append-only journal that is compacted into a snapshot.
+ *
+ * Each set appends one checksummed record to the journal and flushes it to the OS, so a killed
+ * process loses nothing that was set before it died. A torn record at the end of the journal
+ * fails its checksum and is dropped when the store is next loaded.
+ *
+ * To compact, the journal is closed and renamed aside, and new records go to a fresh journal.
+ * The snapshot is written to a temporary file, synced, and renamed over the old snapshot, and
+ * only then is the old journal removed. Loading reads the snapshot, the old journal and the
+ * journal in that order, so a crash at any point during compaction leaves a consistent state.
+ * Where rename cannot replace an existing file, a snapshot left behind in the temporary file is
+ * recovered on load.
+ *
+ * The store is locked, because CCUserDefault is also used from worker threads.
  */
+class UserDefaultStore
+{
+public:
+    UserDefaultStore(const std::string& writablePath, const std::string& xmlFilePath);
+    ~UserDefaultStore();
+
+    bool getValue(const char* pKey, std::string& value);
+    void setValue(const char* pKey, const char* pValue);
+    void flush();
+
+private:
+    UserDefaultEntry* findEntry(const char* pKey, unsigned int hash);
+    void putValue(const std::string& key, const std::string& value);
+    void rehash(size_t bucketCount);
+
+    bool loadSnapshot(const std::string& path);
+    bool replayJournal(const std::string& path);
+    bool migrateXMLFile(const std::string& path);
+    void openJournal();
+
+    void collectEntries(std::vector<UserDefaultEntry>& entries);
+    void compact();
+    void startCompaction();
+    void waitForCompaction();
+    unsigned long writeCompaction(const std::vector<UserDefaultEntry>& entries);
+    static bool writeSnapshot(const std::string& path, const std::vector<UserDefaultEntry>& entries, unsigned long& bytes);
+    static void* compactionMain(void* pData);
+
+    std::vector< std::vector<UserDefaultEntry> > m_buckets;
+    size_t m_uCount;
+
+    std::string m_sSnapshotPath;
+    std::string m_sTempSnapshotPath;
+    std::string m_sJournalPath;
+    std::string m_sOldJournalPath;
+
+    FILE* m_pJournal;
+    unsigned long m_uJournalBytes;
+    unsigned long m_uSnapshotBytes;
+    std::string m_record;
+
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_compactionDone;
+    std::vector<UserDefaultEntry> m_compactionEntries;
+    bool m_bCompacting;
+};
+
+UserDefaultStore::UserDefaultStore(const std::string& writablePath, const std::string& xmlFilePath)
+: m_uCount(0)
+, m_sSnapshotPath(writablePath + SNAPSHOT_FILE_NAME)
+, m_sTempSnapshotPath(writablePath + SNAPSHOT_FILE_NAME ".tmp")
+, m_sJournalPath(writablePath + JOURNAL_FILE_NAME)
+, m_sOldJournalPath(writablePath + JOURNAL_FILE_NAME ".old")
+, m_pJournal(NULL)
+, m_uJournalBytes(0)
+, m_uSnapshotBytes(0)
+, m_bCompacting(false)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_compactionDone, NULL);
+    m_buckets.resize(64);
+
+    bool bHasSnapshot = loadSnapshot(m_sSnapshotPath) || loadSnapshot(m_sTempSnapshotPath);
+    bool bHasOldJournal = isFileExist(m_sOldJournalPath);
+    bool bOldJournalIntact = !bHasOldJournal || replayJournal(m_sOldJournalPath);
+    bool bJournalIntact = replayJournal(m_sJournalPath) && bOldJournalIntact;
+
+    if (!bHasSnapshot && !bHasOldJournal && m_uJournalBytes == 0 && migrateXMLFile(xmlFilePath))
+    {
+        // migrated once, the XML file is left as it was and not read again
+        compact();
+    }
+    else if (bHasOldJournal || !bJournalIntact || (bHasSnapshot && isFileExist(m_sTempSnapshotPath)))
+    {
+        // finish an interrupted compaction, or drop a torn record, before appending again
+        compact();
+    }
+
+    openJournal();
+}
 
-static tinyxml2::XMLElement* getXMLNodeForKey(const char* pKey, tinyxml2::XMLElement** rootNode, tinyxml2::XMLDocument **doc)
+UserDefaultStore::~UserDefaultStore()
 {
-    tinyxml2::XMLElement* curNode = NULL;
+    flush();
+    if (m_pJournal)
+    {
+        fclose(m_pJournal);
+    }
+    pthread_cond_destroy(&m_compactionDone);
+    pthread_mutex_destroy(&m_mutex);
+}
 
-    // check the key value
-    if (! pKey)
+UserDefaultEntry* UserDefaultStore::findEntry(const char* pKey, unsigned int hash)
+{
+    std::vector<UserDefaultEntry>& bucket = m_buckets[hash & (m_buckets.size() - 1)];
+    for (size_t i = 0; i < bucket.size(); ++i)
     {
-        return NULL;
-    }
-
-    do 
-    {
- 		tinyxml2::XMLDocument* xmlDoc = new tinyxml2::XMLDocument();
-		*doc = xmlDoc;
-		//CCFileData data(CCUserDefault::sharedUserDefault()->getXMLFilePath().c_str(),"rt");
-		unsigned long nSize;
-		const char* pXmlBuffer = (const char*)CCFileUtils::sharedFileUtils()->getFileData(CCUserDefault::sharedUserDefault()->getXMLFilePath().c_str(), "rb", &nSize);
-		//const char* pXmlBuffer = (const char*)data.getBuffer();
-		if(NULL == pXmlBuffer)
-		{
-			CCLOG("can not read xml file");
-			break;
-		}
-		xmlDoc->Parse(pXmlBuffer, nSize);
-        delete[] pXmlBuffer;
-		// get root node
-		*rootNode = xmlDoc->RootElement();
-		if (NULL == *rootNode)
-		{
-			CCLOG("read root node error");
-			break;
-		}
-		// find the node
-		curNode = (*rootNode)->FirstChildElement();
-		while (NULL != curNode)
-		{
-			const char* nodeName = curNode->Value();
-			if (!strcmp(nodeName, pKey))
-			{
-				break;
-			}
-
-			curNode = curNode->NextSiblingElement();
-		}
-	} while (0);
-
-	return curNode;
+        if (bucket[i].hash == hash && bucket[i].key == pKey)
+        {
+            return &bucket[i];
+        }
+    }
+    return NULL;
 }
 
-static void setValueForKey(const char* pKey, const char* pValue)
+void UserDefaultStore::putValue(const std::string& key, const std::string& value)
 {
- 	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	// check the params
-	if (! pKey || ! pValue)
-	{
-		return;
-	}
-	// find the node
-	node = getXMLNodeForKey(pKey, &rootNode, &doc);
-	// if node exist, change the content
-	if (node)
-	{
-        if (node->FirstChild())
+    unsigned int hash = hashBytes(key.c_str(), key.length());
+    UserDefaultEntry* pEntry = findEntry(key.c_str(), hash);
+    if (pEntry)
+    {
+        pEntry->value = value;
+        return;
+    }
+
+    if (m_uCount >= m_buckets.size())
+    {
+        rehash(m_buckets.size() * 2);
+    }
+    UserDefaultEntry entry;
+    entry.key = key;
+    entry.value = value;
+    entry.hash = hash;
+    m_buckets[hash & (m_buckets.size() - 1)].push_back(entry);
+    ++m_uCount;
+}
+
+void UserDefaultStore::rehash(size_t bucketCount)
+{
+    std::vector< std::vector<UserDefaultEntry> > buckets(bucketCount);
+    for (size_t i = 0; i < m_buckets.size(); ++i)
+    {
+        for (size_t j = 0; j < m_buckets[i].size(); ++j)
         {
-            node->FirstChild()->SetValue(pValue);
+            UserDefaultEntry& entry = m_buckets[i][j];
+            buckets[entry.hash & (bucketCount - 1)].push_back(entry);
         }
-        else
+    }
+    m_buckets.swap(buckets);
+}
+
+bool UserDefaultStore::getValue(const char* pKey, std::string& value)
+{
+    pthread_mutex_lock(&m_mutex);
+    UserDefaultEntry* pEntry = findEntry(pKey, hashBytes(pKey, strlen(pKey)));
+    if (pEntry)
+    {
+        value = pEntry->value;
+    }
+    pthread_mutex_unlock(&m_mutex);
+    return pEntry != NULL;
+}
+
+void UserDefaultStore::setValue(const char* pKey, const char* pValue)
+{
+    pthread_mutex_lock(&m_mutex);
+
+    size_t keyLength = strlen(pKey);
+    size_t valueLength = strlen(pValue);
+    UserDefaultEntry* pEntry = findEntry(pKey, hashBytes(pKey, keyLength));
+    if (pEntry && pEntry->value == pValue)
+    {
+        // setting the same value again does not need to touch the disk
+        pthread_mutex_unlock(&m_mutex);
+        return;
+    }
+    putValue(pKey, pValue);
+
+    m_record.clear();
+    m_record.push_back((char)JOURNAL_RECORD_SET);
+    appendUInt(m_record, (unsigned int)keyLength);
+    appendUInt(m_record, (unsigned int)valueLength);
+    m_record.append(pKey, keyLength);
+    m_record.append(pValue, valueLength);
+    appendUInt(m_record, hashBytes(m_record.data(), m_record.length()));
+
+    if (m_pJournal)
+    {
+        if (fwrite(m_record.data(), 1, m_record.length(), m_pJournal) != m_record.length() || fflush(m_pJournal) != 0)
         {
-            tinyxml2::XMLText* content = doc->NewText(pValue);
-            node->LinkEndChild(content);
+            CCLOG("cocos2d: CCUserDefault: could not append to %s", m_sJournalPath.c_str());
         }
-	}
-	else
-	{
-		if (rootNode)
-		{
-			tinyxml2::XMLElement* tmpNode = doc->NewElement(pKey);//new tinyxml2::XMLElement(pKey);
-			rootNode->LinkEndChild(tmpNode);
-			tinyxml2::XMLText* content = doc->NewText(pValue);//new tinyxml2::XMLText(pValue);
-			tmpNode->LinkEndChild(content);
-		}	
-	}
+        m_uJournalBytes += m_record.length();
+    }
 
-    // save file and free doc
-	if (doc)
-	{
-		doc->SaveFile(CCUserDefault::sharedUserDefault()->getXMLFilePath().c_str());
-		delete doc;
-	}
+    if (m_uJournalBytes > JOURNAL_COMPACTION_BYTES && m_uJournalBytes > 2 * m_uSnapshotBytes && !m_bCompacting)
+    {
+        startCompaction();
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void UserDefaultStore::flush()
+{
+    waitForCompaction();
+
+    pthread_mutex_lock(&m_mutex);
+    if (m_pJournal)
+    {
+        fflush(m_pJournal);
+        fsyncFile(m_pJournal);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+bool UserDefaultStore::loadSnapshot(const std::string& path)
+{
+    std::string contents;
+    if (!readFile(path, contents) || contents.length() < 16)
+    {
+        return false;
+    }
+
+    const char* p = contents.data();
+    const char* end = p + contents.length() - 4;
+    unsigned int magic, version, count, checksum;
+    const char* pChecksum = end;
+    readUInt(pChecksum, pChecksum + 4, checksum);
+    if (checksum != hashBytes(contents.data(), contents.length() - 4)
+        || !readUInt(p, end, magic) || magic != SNAPSHOT_MAGIC
+        || !readUInt(p, end, version) || version != SNAPSHOT_VERSION
+        || !readUInt(p, end, count))
+    {
+        CCLOG("cocos2d: CCUserDefault: ignoring damaged snapshot %s", path.c_str());
+        return false;
+    }
+
+    std::string key, value;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int keyLength, valueLength;
+        if (!readUInt(p, end, keyLength) || !readUInt(p, end, valueLength)
+            || !readString(p, end, keyLength, key) || !readString(p, end, valueLength, value))
+        {
+            return false;
+        }
+        putValue(key, value);
+    }
+
+    m_uSnapshotBytes = contents.length();
+    return true;
+}
+
+bool UserDefaultStore::replayJournal(const std::string& path)
+{
+    std::string contents;
+    if (!readFile(path, contents))
+    {
+        return true;
+    }
+
+    const char* p = contents.data();
+    const char* end = p + contents.length();
+    std::string key, value;
+    while (p < end)
+    {
+        const char* record = p++;
+        unsigned int keyLength, valueLength, checksum;
+        if (*record != JOURNAL_RECORD_SET
+            || !readUInt(p, end, keyLength) || !readUInt(p, end, valueLength)
+            || !readString(p, end, keyLength, key) || !readString(p, end, valueLength, value))
+        {
+            p = record;
+            break;
+        }
+        size_t recordLength = p - record;
+        if (!readUInt(p, end, checksum) || checksum != hashBytes(record, recordLength))
+        {
+            p = record;
+            break;
+        }
+        putValue(key, value);
+        m_uJournalBytes += recordLength + 4;
+    }
+
+    if (p < end)
+    {
+        CCLOG("cocos2d: CCUserDefault: dropping a torn record at the end of %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool UserDefaultStore::migrateXMLFile(const std::string& path)
+{
+    std::string contents;
+    if (!readFile(path, contents))
+    {
+        return false;
+    }
+
+    tinyxml2::XMLDocument doc;
+    doc.Parse(contents.data(), contents.length());
+    tinyxml2::XMLElement* rootNode = doc.RootElement();
+    if (NULL == rootNode)
+    {
+        CCLOG("read root node error");
+        return false;
+    }
+
+    for (tinyxml2::XMLElement* node = rootNode->FirstChildElement(); node; node = node->NextSiblingElement())
+    {
+        // as before, a key keeps the value of its first node
+        unsigned int hash = hashBytes(node->Value(), strlen(node->Value()));
+        if (!findEntry(node->Value(), hash) && node->FirstChild())
+        {
+            putValue(node->Value(), node->FirstChild()->Value());
+        }
+    }
+    return true;
+}
+
+void UserDefaultStore::openJournal()
+{
+    m_pJournal = fopen(m_sJournalPath.c_str(), "ab");
+    if (!m_pJournal)
+    {
+        CCLOG("cocos2d: CCUserDefault: could not open %s, values will not be saved", m_sJournalPath.c_str());
+    }
+}
+
+void UserDefaultStore::collectEntries(std::vector<UserDefaultEntry>& entries)
+{
+    entries.clear();
+    entries.reserve(m_uCount);
+    for (size_t i = 0; i < m_buckets.size(); ++i)
+    {
+        entries.insert(entries.end(), m_buckets[i].begin(), m_buckets[i].end());
+    }
+}
+
+void UserDefaultStore::compact()
+{
+    // Only used while loading, before the journal is opened. Everything in the journals is
+    // already in the snapshot, so replaying them again after a crash here changes nothing.
+    std::vector<UserDefaultEntry> entries;
+    collectEntries(entries);
+    m_uSnapshotBytes = writeCompaction(entries);
+    if (m_uSnapshotBytes)
+    {
+        remove(m_sJournalPath.c_str());
+        m_uJournalBytes = 0;
+    }
+}
+
+void UserDefaultStore::startCompaction()
+{
+    // Called with the lock held. The journal is set aside as the old journal, which holds
+    // nothing the snapshot will not, and new values go to a fresh journal meanwhile. An old
+    // journal left by a failed compaction is kept until the store is next loaded.
+    if (!m_pJournal || isFileExist(m_sOldJournalPath))
+    {
+        return;
+    }
+    fclose(m_pJournal);
+    m_pJournal = NULL;
+    if (rename(m_sJournalPath.c_str(), m_sOldJournalPath.c_str()) != 0)
+    {
+        openJournal();
+        return;
+    }
+    openJournal();
+    m_uJournalBytes = 0;
+
+    collectEntries(m_compactionEntries);
+    m_bCompacting = true;
+
+#if USERDEFAULT_ASYNC_COMPACTION
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, compactionMain, this) == 0)
+    {
+        pthread_detach(thread);
+        return;
+    }
+#endif
+    unsigned long snapshotBytes = writeCompaction(m_compactionEntries);
+    m_uSnapshotBytes = snapshotBytes ? snapshotBytes : m_uSnapshotBytes;
+    m_compactionEntries.clear();
+    m_bCompacting = false;
+}
+
+void UserDefaultStore::waitForCompaction()
+{
+    pthread_mutex_lock(&m_mutex);
+    while (m_bCompacting)
+    {
+        pthread_cond_wait(&m_compactionDone, &m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void* UserDefaultStore::compactionMain(void* pData)
+{
+    UserDefaultStore* pStore = (UserDefaultStore*)pData;
+
+    // the entries are not touched by anything else until m_bCompacting is cleared
+    unsigned long snapshotBytes = pStore->writeCompaction(pStore->m_compactionEntries);
+
+    pthread_mutex_lock(&pStore->m_mutex);
+    pStore->m_uSnapshotBytes = snapshotBytes ? snapshotBytes : pStore->m_uSnapshotBytes;
+    pStore->m_compactionEntries.clear();
+    pStore->m_bCompacting = false;
+#if USERDEFAULT_ASYNC_COMPACTION
+    pthread_cond_broadcast(&pStore->m_compactionDone);
+#endif
+    pthread_mutex_unlock(&pStore->m_mutex);
+    return NULL;
+}
+
+unsigned long UserDefaultStore::writeCompaction(const std::vector<UserDefaultEntry>& entries)
+{
+    unsigned long snapshotBytes = 0;
+    bool bWritten = writeSnapshot(m_sTempSnapshotPath, entries, snapshotBytes);
+    if (bWritten && rename(m_sTempSnapshotPath.c_str(), m_sSnapshotPath.c_str()) != 0)
+    {
+        // rename cannot replace a file on this platform, so a crash between these two
+        // is covered by recovering the temporary snapshot on load
+        remove(m_sSnapshotPath.c_str());
+        bWritten = rename(m_sTempSnapshotPath.c_str(), m_sSnapshotPath.c_str()) == 0;
+    }
+
+    if (!bWritten)
+    {
+        CCLOG("cocos2d: CCUserDefault: could not write %s", m_sSnapshotPath.c_str());
+        return 0;
+    }
+    remove(m_sOldJournalPath.c_str());
+    return snapshotBytes;
+}
+
+bool UserDefaultStore::writeSnapshot(const std::string& path, const std::vector<UserDefaultEntry>& entries, unsigned long& bytes)
+{
+    std::string contents;
+    appendUInt(contents, SNAPSHOT_MAGIC);
+    appendUInt(contents, SNAPSHOT_VERSION);
+    appendUInt(contents, (unsigned int)entries.size());
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        appendUInt(contents, (unsigned int)entries[i].key.length());
+        appendUInt(contents, (unsigned int)entries[i].value.length());
+        contents.append(entries[i].key);
+        contents.append(entries[i].value);
+    }
+    appendUInt(contents, hashBytes(contents.data(), contents.length()));
+    bytes = contents.length();
+
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp)
+    {
+        return false;
+    }
+    bool bRet = fwrite(contents.data(), 1, contents.length(), fp) == contents.length()
+             && fflush(fp) == 0
+             && fsyncFile(fp) == 0;
+    fclose(fp);
+    return bRet;
+}
+
+static UserDefaultStore* s_pStore = NULL;
+
+static bool getValueForKey(const char* pKey, std::string& value)
+{
+    return pKey && s_pStore && s_pStore->getValue(pKey, value);
+}
+
+static void setValueForKey(const char* pKey, const char* pValue)
+{
+    // check the params
+    if (! pKey || ! pValue || ! s_pStore)
+    {
+        return;
+    }
+    s_pStore->setValue(pKey, pValue);
 }
 
 /**
@@ -160,6 +662,8 @@ CCUserDefault::CCUserDefault()
 
 void CCUserDefault::purgeSharedUserDefault()
 {
+    // the store is flushed and reloaded by the next sharedUserDefault()
+    CC_SAFE_DELETE(s_pStore);
     m_spUserDefault = NULL;
 }
 
@@ -170,27 +674,15 @@ void CCUserDefault::purgeSharedUserDefault()
 
 bool CCUserDefault::getBoolForKey(const char* pKey, bool defaultValue)
 {
-    const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
-
-	bool ret = defaultValue;
-
-	if (value)
-	{
-		ret = (! strcmp(value, "true"));
-	}
+    string value;
+    bool ret = defaultValue;
 
-    if (doc) delete doc;
+    if (getValueForKey(pKey, value))
+    {
+        ret = (value == "true");
+    }
 
-	return ret;
+    return ret;
 }
 
 int CCUserDefault::getIntegerForKey(const char* pKey)
@@ -200,31 +692,15 @@ int CCUserDefault::getIntegerForKey(const char* pKey)
 
 int CCUserDefault::getIntegerForKey(const char* pKey, int defaultValue)
 {
-	const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
-
-	int ret = defaultValue;
-
-	if (value)
-	{
-		ret = atoi(value);
-	}
-
-	if(doc)
-	{
-		delete doc;
-	}
+    string value;
+    int ret = defaultValue;
 
+    if (getValueForKey(pKey, value))
+    {
+        ret = atoi(value.c_str());
+    }
 
-	return ret;
+    return ret;
 }
 
 float CCUserDefault::getFloatForKey(const char* pKey)
@@ -246,27 +722,15 @@ double  CCUserDefault::getDoubleForKey(const char* pKey)
 
 double CCUserDefault::getDoubleForKey(const char* pKey, double defaultValue)
 {
-	const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
-
-	double ret = defaultValue;
+    string value;
+    double ret = defaultValue;
 
-	if (value)
-	{
-		ret = atof(value);
-	}
-
-    if (doc) delete doc;
+    if (getValueForKey(pKey, value))
+    {
+        ret = atof(value.c_str());
+    }
 
-	return ret;
+    return ret;
 }
 
 std::string CCUserDefault::getStringForKey(const char* pKey)
@@ -276,27 +740,14 @@ std::string CCUserDefault::getStringForKey(const char* pKey)
 
 string CCUserDefault::getStringForKey(const char* pKey, const std::string & defaultValue)
 {
-    const char* value = NULL;
-	tinyxml2::XMLElement* rootNode;
-	tinyxml2::XMLDocument* doc;
-	tinyxml2::XMLElement* node;
-	node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-	// find the node
-	if (node && node->FirstChild())
-	{
-        value = (const char*)(node->FirstChild()->Value());
-	}
+    string ret;
 
-	string ret = defaultValue;
-
-	if (value)
-	{
-		ret = string(value);
-	}
-
-    if (doc) delete doc;
+    if (! getValueForKey(pKey, ret))
+    {
+        ret = defaultValue;
+    }
 
-	return ret;
+    return ret;
 }
 
 void CCUserDefault::setBoolForKey(const char* pKey, bool value)
@@ -365,11 +816,10 @@ CCUserDefault* CCUserDefault::sharedUserDefault()
 {
     initXMLFilePath();
 
-    // only create xml file one time
-    // the file exists after the program exit
-    if ((! isXMLFileExist()) && (! createXMLFile()))
+    // load the values once, migrating them from the xml file the first time
+    if (! s_pStore)
     {
-        return NULL;
+        s_pStore = new UserDefaultStore(CCFileUtils::sharedFileUtils()->getWritablePath(), m_sFilePath);
     }
 
     if (! m_spUserDefault)
@@ -403,37 +853,6 @@ void CCUserDefault::initXMLFilePath()
     }    
 }
 
-// create new xml file
-bool CCUserDefault::createXMLFile()
-{
-	bool bRet = false;  
-    tinyxml2::XMLDocument *pDoc = new tinyxml2::XMLDocument(); 
-    if (NULL==pDoc)  
-    {  
-        return false;  
-    }  
-	tinyxml2::XMLDeclaration *pDeclaration = pDoc->NewDeclaration(NULL);  
-	if (NULL==pDeclaration)  
-	{  
-		return false;  
-	}  
-	pDoc->LinkEndChild(pDeclaration); 
-	tinyxml2::XMLElement *pRootEle = pDoc->NewElement(USERDEFAULT_ROOT_NAME);  
-	if (NULL==pRootEle)  
-	{  
-		return false;  
-	}  
-	pDoc->LinkEndChild(pRootEle);  
-	bRet = tinyxml2::XML_SUCCESS == pDoc->SaveFile(m_sFilePath.c_str());
-
-	if(pDoc)
-	{
-		delete pDoc;
-	}
-
-	return bRet;
-}
-
 const string& CCUserDefault::getXMLFilePath()
 {
     return m_sFilePath;
@@ -441,6 +860,11 @@ const string& CCUserDefault::getXMLFilePath()
 
 void CCUserDefault::flush()
 {
+    // values reach the OS as they are set, this also makes them durable against power loss
+    if (s_pStore)
+    {
+        s_pStore->flush();
+    }
 }
 
 NS_CC_END
@@ -103,7 +103,7 @@ public:
     */
     void    setStringForKey(const char* pKey, const std::string & value);
     /**
-     @brief Save content to xml file
+     @brief Make the saved content durable, it is already saved as each value is set
      */
     void    flush();
 
@@ -114,7 +114,10 @@ public:
 
 private:
     CCUserDefault();
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    // the journaled store creates its files on demand; only the platform stores still need this
     static bool createXMLFile();
+#endif
     static void initXMLFilePath();
     
     static CCUserDefault* m_spUserDefault;
@@ -47,6 +47,11 @@ NS_CC_BEGIN
 CCTextureAtlas::CCTextureAtlas()
     :m_pIndices(NULL)
     ,m_bDirty(false)
+    ,m_uDirtyQuadStart(0)
+    ,m_uDirtyQuadEnd(0)
+    ,m_uDirtyIndexStart(0)
+    ,m_uDirtyIndexEnd(0)
+    ,m_bUsesSlots(false)
     ,m_pTexture(NULL)
     ,m_pQuads(NULL)
 {}
@@ -222,26 +227,35 @@ void CCTextureAtlas::setupIndices()
     if (m_uCapacity == 0)
         return;
 
+    // with slot storage, the positions being drawn refer to the slots in the draw order
+    unsigned int ordered = m_bUsesSlots ? MIN((unsigned int)m_drawOrder.size(), m_uCapacity) : 0;
     for( unsigned int i=0; i < m_uCapacity; i++)
     {
+        setIndicesForQuad(i, i < ordered ? m_drawOrder[i] : i);
+    }
+}
+
+void CCTextureAtlas::setIndicesForQuad(unsigned int position, unsigned int slot)
+{
+    GLushort* indices = &m_pIndices[position*6];
+    GLushort vertex = (GLushort)(slot*4);
 #if CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
-        m_pIndices[i*6+0] = i*4+0;
-        m_pIndices[i*6+1] = i*4+0;
-        m_pIndices[i*6+2] = i*4+2;        
-        m_pIndices[i*6+3] = i*4+1;
-        m_pIndices[i*6+4] = i*4+3;
-        m_pIndices[i*6+5] = i*4+3;
+    indices[0] = vertex+0;
+    indices[1] = vertex+0;
+    indices[2] = vertex+2;        
+    indices[3] = vertex+1;
+    indices[4] = vertex+3;
+    indices[5] = vertex+3;
 #else
-        m_pIndices[i*6+0] = i*4+0;
-        m_pIndices[i*6+1] = i*4+1;
-        m_pIndices[i*6+2] = i*4+2;
-
-        // inverted index. issue #179
-        m_pIndices[i*6+3] = i*4+3;
-        m_pIndices[i*6+4] = i*4+2;
-        m_pIndices[i*6+5] = i*4+1;        
+    indices[0] = vertex+0;
+    indices[1] = vertex+1;
+    indices[2] = vertex+2;
+
+    // inverted index. issue #179
+    indices[3] = vertex+3;
+    indices[4] = vertex+2;
+    indices[5] = vertex+1;        
 #endif    
-    }
 }
 
 //TextureAtlas - VAO / VBO specific
@@ -273,6 +287,7 @@ void CCTextureAtlas::setupVBOandVAO()
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pBuffersVBO[1]);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_pIndices[0]) * m_uCapacity * 6, m_pIndices, GL_STATIC_DRAW);
+    m_uDirtyIndexStart = m_uDirtyIndexEnd = 0;
 
     // Must unbind the VAO before changing the element buffer.
     ccGLBindVAO(0);
@@ -302,6 +317,7 @@ void CCTextureAtlas::mapBuffers()
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pBuffersVBO[1]);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_pIndices[0]) * m_uCapacity * 6, m_pIndices, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    m_uDirtyIndexStart = m_uDirtyIndexEnd = 0;
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -312,18 +328,36 @@ void CCTextureAtlas::updateQuad(ccV3F_C4B_T2F_Quad *quad, unsigned int index)
 {
     CCAssert( index >= 0 && index < m_uCapacity, "updateQuadWithTexture: Invalid index");
 
-    m_uTotalQuads = MAX( index+1, m_uTotalQuads);
+    // growing the quad count uploads everything, in case the gap was never uploaded
+    if (index >= m_uTotalQuads)
+    {
+        m_uTotalQuads = index+1;
+        m_bDirty = true;
+    }
 
     m_pQuads[index] = *quad;    
 
+    markQuadsDirty(index, 1);
+}
 
-    m_bDirty = true;
-
+void CCTextureAtlas::markQuadsDirty(unsigned int index, unsigned int amount)
+{
+    if (m_uDirtyQuadEnd <= m_uDirtyQuadStart)
+    {
+        m_uDirtyQuadStart = index;
+        m_uDirtyQuadEnd = index + amount;
+    }
+    else
+    {
+        m_uDirtyQuadStart = MIN(m_uDirtyQuadStart, index);
+        m_uDirtyQuadEnd = MAX(m_uDirtyQuadEnd, index + amount);
+    }
 }
 
 void CCTextureAtlas::insertQuad(ccV3F_C4B_T2F_Quad *quad, unsigned int index)
 {
     CCAssert( index < m_uCapacity, "insertQuadWithTexture: Invalid index");
+    CCAssert( !m_bUsesSlots, "insertQuadWithTexture: use allocateSlot with slot storage");
 
     m_uTotalQuads++;
     CCAssert( m_uTotalQuads <= m_uCapacity, "invalid totalQuads");
@@ -409,6 +443,7 @@ void CCTextureAtlas::insertQuadFromIndex(unsigned int oldIndex, unsigned int new
 void CCTextureAtlas::removeQuadAtIndex(unsigned int index)
 {
     CCAssert( index < m_uTotalQuads, "removeQuadAtIndex: Invalid index");
+    CCAssert( !m_bUsesSlots, "removeQuadAtIndex: use freeSlot with slot storage");
 
     unsigned int remaining = (m_uTotalQuads-1) - index;
 
@@ -446,6 +481,117 @@ void CCTextureAtlas::removeQuadsAtIndex(unsigned int index, unsigned int amount)
 void CCTextureAtlas::removeAllQuads()
 {
     m_uTotalQuads = 0;
+    m_freeSlots.clear();
+    m_drawOrder.clear();
+}
+
+// TextureAtlas - Slot storage
+
+void CCTextureAtlas::setUsesSlots(bool bUsesSlots)
+{
+    CCAssert(m_uTotalQuads == 0, "CCTextureAtlas: the quad storage can only be changed while the atlas is empty");
+
+    m_bUsesSlots = bUsesSlots;
+    m_freeSlots.clear();
+    m_drawOrder.clear();
+}
+
+bool CCTextureAtlas::hasFreeSlot()
+{
+    return !m_freeSlots.empty() || m_uTotalQuads < m_uCapacity;
+}
+
+unsigned int CCTextureAtlas::allocateSlot()
+{
+    CCAssert(m_bUsesSlots, "CCTextureAtlas: allocateSlot requires slot storage");
+
+    if (!m_freeSlots.empty())
+    {
+        unsigned int slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        return slot;
+    }
+
+    CCAssert(m_uTotalQuads < m_uCapacity, "CCTextureAtlas: no free slot, increase the capacity first");
+    return m_uTotalQuads++;
+}
+
+void CCTextureAtlas::freeSlot(unsigned int slot)
+{
+    CCAssert(m_bUsesSlots && slot < m_uTotalQuads, "CCTextureAtlas: freeSlot: Invalid slot");
+
+    // a zero-area quad draws nothing, in case the slot is still in the draw order
+    memset(&m_pQuads[slot], 0, sizeof(m_pQuads[0]));
+    markQuadsDirty(slot, 1);
+
+    m_freeSlots.push_back(slot);
+}
+
+void CCTextureAtlas::setDrawOrder(const unsigned int* slots, unsigned int count)
+{
+    CCAssert(m_bUsesSlots, "CCTextureAtlas: setDrawOrder requires slot storage");
+    CCAssert(count <= m_uCapacity, "CCTextureAtlas: setDrawOrder: too many quads");
+
+    unsigned int oldCount = (unsigned int)m_drawOrder.size();
+    m_drawOrder.resize(count);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (i < oldCount && m_drawOrder[i] == slots[i])
+        {
+            continue;
+        }
+
+        m_drawOrder[i] = slots[i];
+        setIndicesForQuad(i, slots[i]);
+
+        if (m_uDirtyIndexEnd <= m_uDirtyIndexStart)
+        {
+            m_uDirtyIndexStart = i;
+            m_uDirtyIndexEnd = i + 1;
+        }
+        else
+        {
+            m_uDirtyIndexStart = MIN(m_uDirtyIndexStart, i);
+            m_uDirtyIndexEnd = MAX(m_uDirtyIndexEnd, i + 1);
+        }
+    }
+}
+
+void CCTextureAtlas::compactSlots()
+{
+    CCAssert(m_bUsesSlots, "CCTextureAtlas: compactSlots requires slot storage");
+
+    unsigned int count = (unsigned int)m_drawOrder.size();
+    CCAssert(count + m_freeSlots.size() == m_uTotalQuads, "CCTextureAtlas: compactSlots: the draw order must cover every slot in use");
+
+    size_t quadSize = sizeof(m_pQuads[0]);
+    ccV3F_C4B_T2F_Quad* tempQuads = (ccV3F_C4B_T2F_Quad*)malloc(quadSize * count);
+    if (count > 0 && !tempQuads)
+    {
+        return;
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        tempQuads[i] = m_pQuads[m_drawOrder[i]];
+    }
+    memcpy(m_pQuads, tempQuads, quadSize * count);
+    memset(&m_pQuads[count], 0, quadSize * (m_uTotalQuads - count));
+    free(tempQuads);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        m_drawOrder[i] = i;
+        setIndicesForQuad(i, i);
+    }
+
+    m_uTotalQuads = count;
+    m_freeSlots.clear();
+
+    m_uDirtyIndexStart = 0;
+    m_uDirtyIndexEnd = count;
+    m_bDirty = true;
 }
 
 // TextureAtlas - Resize
@@ -455,6 +601,7 @@ bool CCTextureAtlas::resizeCapacity(unsigned int newCapacity)
     {
         return true;
     }
+    CCAssert(!m_bUsesSlots || newCapacity >= m_uTotalQuads, "CCTextureAtlas: cannot shrink below the slots in use");
     unsigned int uOldCapactiy = m_uCapacity; 
     // update capacity and totolQuads
     m_uTotalQuads = MIN(m_uTotalQuads, newCapacity);
@@ -581,7 +728,7 @@ void CCTextureAtlas::fillWithEmptyQuadsFromIndex(unsigned int index, unsigned in
 
 void CCTextureAtlas::drawQuads()
 {
-    this->drawNumberOfQuads(m_uTotalQuads, 0);
+    this->drawNumberOfQuads(m_bUsesSlots ? getDrawOrderCount() : m_uTotalQuads, 0);
 }
 
 void CCTextureAtlas::drawNumberOfQuads(unsigned int n)
@@ -606,6 +753,9 @@ void CCTextureAtlas::drawNumberOfQuads(unsigned int n, unsigned int start)
     // XXX: update is done in draw... perhaps it should be done in a timer
     if (m_bDirty) 
     {
+        // with slot storage, the slots being drawn can lie anywhere below totalQuads
+        unsigned int uploadCount = m_bUsesSlots ? m_uTotalQuads : n-start;
+
         glBindBuffer(GL_ARRAY_BUFFER, m_pBuffersVBO[0]);
         // option 1: subdata
         //glBufferSubData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0])*start, sizeof(m_pQuads[0]) * n , &m_pQuads[start] );
@@ -614,18 +764,37 @@ void CCTextureAtlas::drawNumberOfQuads(unsigned int n, unsigned int start)
         //		glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
 		
 		// option 3: orphaning + glMapBuffer
-		glBufferData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0]) * (n-start), NULL, GL_DYNAMIC_DRAW);
+		// The buffer keeps its full capacity, so that later partial updates stay within it.
+		glBufferData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0]) * m_uCapacity, NULL, GL_DYNAMIC_DRAW);
 		void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-		memcpy(buf, m_pQuads, sizeof(m_pQuads[0])* (n-start));
+		memcpy(buf, m_pQuads, sizeof(m_pQuads[0])* uploadCount);
 		glUnmapBuffer(GL_ARRAY_BUFFER);
 		
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
         m_bDirty = false;
+        m_uDirtyQuadStart = m_uDirtyQuadEnd = 0;
+    }
+    else if (m_uDirtyQuadEnd > m_uDirtyQuadStart)
+    {
+        // only the quads updated since the last upload
+        glBindBuffer(GL_ARRAY_BUFFER, m_pBuffersVBO[0]);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0])*m_uDirtyQuadStart, sizeof(m_pQuads[0]) * (m_uDirtyQuadEnd-m_uDirtyQuadStart), &m_pQuads[m_uDirtyQuadStart] );
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_uDirtyQuadStart = m_uDirtyQuadEnd = 0;
     }
 
     ccGLBindVAO(m_uVAOname);
 
+    if (m_uDirtyIndexEnd > m_uDirtyIndexStart)
+    {
+        // the element buffer is part of the VAO state, so it is updated while the VAO is bound
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pBuffersVBO[1]);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_pIndices[0])*6*m_uDirtyIndexStart, sizeof(m_pIndices[0])*6*(m_uDirtyIndexEnd-m_uDirtyIndexStart), &m_pIndices[m_uDirtyIndexStart*6] );
+        m_uDirtyIndexStart = m_uDirtyIndexEnd = 0;
+    }
+
 #if CC_REBIND_INDICES_BUFFER
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pBuffersVBO[1]);
 #endif
@@ -654,8 +823,23 @@ void CCTextureAtlas::drawNumberOfQuads(unsigned int n, unsigned int start)
     // XXX: update is done in draw... perhaps it should be done in a timer
     if (m_bDirty) 
     {
-        glBufferSubData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0])*start, sizeof(m_pQuads[0]) * n , &m_pQuads[start] );
+        if (m_bUsesSlots)
+        {
+            // the slots being drawn can lie anywhere below totalQuads
+            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(m_pQuads[0]) * m_uTotalQuads , m_pQuads );
+        }
+        else
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0])*start, sizeof(m_pQuads[0]) * n , &m_pQuads[start] );
+        }
         m_bDirty = false;
+        m_uDirtyQuadStart = m_uDirtyQuadEnd = 0;
+    }
+    else if (m_uDirtyQuadEnd > m_uDirtyQuadStart)
+    {
+        // only the quads updated since the last upload
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0])*m_uDirtyQuadStart, sizeof(m_pQuads[0]) * (m_uDirtyQuadEnd-m_uDirtyQuadStart), &m_pQuads[m_uDirtyQuadStart] );
+        m_uDirtyQuadStart = m_uDirtyQuadEnd = 0;
     }
 
     ccGLEnableVertexAttribs(kCCVertexAttribFlag_PosColorTex);
@@ -671,6 +855,12 @@ void CCTextureAtlas::drawNumberOfQuads(unsigned int n, unsigned int start)
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_pBuffersVBO[1]);
 
+    if (m_uDirtyIndexEnd > m_uDirtyIndexStart)
+    {
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_pIndices[0])*6*m_uDirtyIndexStart, sizeof(m_pIndices[0])*6*(m_uDirtyIndexEnd-m_uDirtyIndexStart), &m_pIndices[m_uDirtyIndexStart*6] );
+        m_uDirtyIndexStart = m_uDirtyIndexEnd = 0;
+    }
+
 #if CC_TEXTURE_ATLAS_USE_TRIANGLE_STRIP
     glDrawElements(GL_TRIANGLE_STRIP, (GLsizei)n*6, GL_UNSIGNED_SHORT, (GLvoid*) (start*6*sizeof(m_pIndices[0])));
 #else
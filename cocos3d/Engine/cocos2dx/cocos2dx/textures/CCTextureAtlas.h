@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "cocoa/CCObject.h"
 #include "ccConfig.h"
 #include <string>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -62,6 +63,13 @@ protected:
 #endif
     GLuint              m_pBuffersVBO[2]; //0: vertex  1: indices
     bool                m_bDirty; //indicates whether or not the array buffer of the VBO needs to be updated
+    unsigned int        m_uDirtyQuadStart; //range of quads updated since the last upload, when not entirely dirty
+    unsigned int        m_uDirtyQuadEnd;
+    unsigned int        m_uDirtyIndexStart; //range of draw positions whose indices changed since the last upload
+    unsigned int        m_uDirtyIndexEnd;
+    bool                m_bUsesSlots; //quads stay in their slots, and the draw order is held in the index buffer
+    std::vector<unsigned int> m_freeSlots;
+    std::vector<unsigned int> m_drawOrder;
 
 
     /** quantity of quads that are going to be drawn */
@@ -217,8 +225,52 @@ public:
     /** specify if the array buffer of the VBO needs to be updated */
     inline void setDirty(bool bDirty) { m_bDirty = bDirty; }
 
+    /** Switches between positional storage, where the quads are drawn in the order they are
+    stored and inserting or removing a quad moves all the quads after it, and slot storage.
+
+    With slot storage, each quad stays in the slot returned by allocateSlot until freeSlot
+    is called, freed slots are reused, and the order in which the slots are drawn is held
+    separately in the index buffer and set with setDrawOrder. Only the quads and indices that
+    changed are uploaded to the GL buffers. In this mode the totalQuads property is the number
+    of slots in use or free, and the positional insert, remove and move methods must not be used.
+
+    The storage can only be changed while the atlas is empty.
+    */
+    void setUsesSlots(bool bUsesSlots);
+    inline bool isUsingSlots(void) { return m_bUsesSlots; }
+
+    /** Returns whether a slot can be allocated without increasing the capacity. */
+    bool hasFreeSlot();
+
+    /** Returns a slot for a new quad, reusing a freed slot if there is one.
+    The capacity must be increased first if hasFreeSlot returns false.
+    */
+    unsigned int allocateSlot();
+
+    /** Releases a slot for reuse, leaving a degenerate (zero-area) quad in it. */
+    void freeSlot(unsigned int slot);
+
+    /** Returns the number of freed slots that are waiting to be reused. */
+    inline unsigned int getFreeSlotCount(void) { return (unsigned int)m_freeSlots.size(); }
+
+    /** Sets the slots to draw, in drawing order. Only the index buffer entries whose slot
+    differs from the previous order are rewritten and uploaded.
+    */
+    void setDrawOrder(const unsigned int* slots, unsigned int count);
+
+    /** Returns the number of quads that will be drawn by drawQuads when using slot storage. */
+    inline unsigned int getDrawOrderCount(void) { return (unsigned int)m_drawOrder.size(); }
+
+    /** Moves the quads into the lowest slots, in drawing order, and discards the freed slots.
+    Afterwards, the quad at draw position i is in slot i, and the caller must update any slot
+    references it holds accordingly. The draw order must include every slot in use.
+    */
+    void compactSlots();
+
 private:
     void setupIndices();
+    void setIndicesForQuad(unsigned int position, unsigned int slot);
+    void markQuadsDirty(unsigned int index, unsigned int amount);
     void mapBuffers();
 #if CC_TEXTURE_ATLAS_USE_VAO
     void setupVBOandVAO();
@@ -55,14 +55,10 @@ void tmx_endElement(void *ctx, const xmlChar *name);
 void tmx_characters(void *ctx, const xmlChar *ch, int len);
 */
 
-static const char* valueForKey(const char *key, std::map<std::string, std::string>* dict)
+static const char* valueForKey(const char *key, const char **atts)
 {
-    if (dict)
-    {
-        std::map<std::string, std::string>::iterator it = dict->find(key);
-        return it!=dict->end() ? it->second.c_str() : "";
-    }
-    return "";
+    const char* value = CCSAXParser::getAttribute(atts, key);
+    return value ? value : "";
 }
 // implementation CCTMXLayerInfo
 CCTMXLayerInfo::CCTMXLayerInfo()
@@ -317,24 +313,14 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     CC_UNUSED_PARAM(ctx);
     CCTMXMapInfo *pTMXMapInfo = this;
     std::string elementName = (char*)name;
-    std::map<std::string, std::string> *attributeDict = new std::map<std::string, std::string>();
-    if (atts && atts[0])
-    {
-        for(int i = 0; atts[i]; i += 2) 
-        {
-            std::string key = (char*)atts[i];
-            std::string value = (char*)atts[i+1];
-            attributeDict->insert(pair<std::string, std::string>(key, value));
-        }
-    }
     if (elementName == "map")
     {
-        std::string version = valueForKey("version", attributeDict);
+        std::string version = valueForKey("version", atts);
         if ( version != "1.0")
         {
             CCLOG("cocos2d: TMXFormat: Unsupported TMX version: %s", version.c_str());
         }
-        std::string orientationStr = valueForKey("orientation", attributeDict);
+        std::string orientationStr = valueForKey("orientation", atts);
         if (orientationStr == "orthogonal")
             pTMXMapInfo->setOrientation(CCTMXOrientationOrtho);
         else if (orientationStr  == "isometric")
@@ -345,12 +331,12 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             CCLOG("cocos2d: TMXFomat: Unsupported orientation: %d", pTMXMapInfo->getOrientation());
 
         CCSize s;
-        s.width = (float)atof(valueForKey("width", attributeDict));
-        s.height = (float)atof(valueForKey("height", attributeDict));
+        s.width = CCSAXParser::getFloatAttribute(atts, "width");
+        s.height = CCSAXParser::getFloatAttribute(atts, "height");
         pTMXMapInfo->setMapSize(s);
 
-        s.width = (float)atof(valueForKey("tilewidth", attributeDict));
-        s.height = (float)atof(valueForKey("tileheight", attributeDict));
+        s.width = CCSAXParser::getFloatAttribute(atts, "tilewidth");
+        s.height = CCSAXParser::getFloatAttribute(atts, "tileheight");
         pTMXMapInfo->setTileSize(s);
 
         // The parent element is now "map"
@@ -359,7 +345,7 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     else if (elementName == "tileset") 
     {
         // If this is an external tileset then start parsing that
-        std::string externalTilesetFilename = valueForKey("source", attributeDict);
+        std::string externalTilesetFilename = valueForKey("source", atts);
         if (externalTilesetFilename != "")
         {
             // Tileset file will be relative to the map file. So we need to convert it to an absolute path
@@ -374,28 +360,28 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             }
             externalTilesetFilename = CCFileUtils::sharedFileUtils()->fullPathForFilename(externalTilesetFilename.c_str());
             
-            m_uCurrentFirstGID = (unsigned int)atoi(valueForKey("firstgid", attributeDict));
+            m_uCurrentFirstGID = (unsigned int)CCSAXParser::getIntAttribute(atts, "firstgid");
             
             pTMXMapInfo->parseXMLFile(externalTilesetFilename.c_str());
         }
         else
         {
             CCTMXTilesetInfo *tileset = new CCTMXTilesetInfo();
-            tileset->m_sName = valueForKey("name", attributeDict);
+            tileset->m_sName = valueForKey("name", atts);
             if (m_uCurrentFirstGID == 0)
             {
-                tileset->m_uFirstGid = (unsigned int)atoi(valueForKey("firstgid", attributeDict));
+                tileset->m_uFirstGid = (unsigned int)CCSAXParser::getIntAttribute(atts, "firstgid");
             }
             else
             {
                 tileset->m_uFirstGid = m_uCurrentFirstGID;
                 m_uCurrentFirstGID = 0;
             }
-            tileset->m_uSpacing = (unsigned int)atoi(valueForKey("spacing", attributeDict));
-            tileset->m_uMargin = (unsigned int)atoi(valueForKey("margin", attributeDict));
+            tileset->m_uSpacing = (unsigned int)CCSAXParser::getIntAttribute(atts, "spacing");
+            tileset->m_uMargin = (unsigned int)CCSAXParser::getIntAttribute(atts, "margin");
             CCSize s;
-            s.width = (float)atof(valueForKey("tilewidth", attributeDict));
-            s.height = (float)atof(valueForKey("tileheight", attributeDict));
+            s.width = CCSAXParser::getFloatAttribute(atts, "tilewidth");
+            s.height = CCSAXParser::getFloatAttribute(atts, "tileheight");
             tileset->m_tTileSize = s;
 
             pTMXMapInfo->getTilesets()->addObject(tileset);
@@ -406,7 +392,7 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     {
         CCTMXTilesetInfo* info = (CCTMXTilesetInfo*)pTMXMapInfo->getTilesets()->lastObject();
         CCDictionary *dict = new CCDictionary();
-        pTMXMapInfo->setParentGID(info->m_uFirstGid + atoi(valueForKey("id", attributeDict)));
+        pTMXMapInfo->setParentGID(info->m_uFirstGid + CCSAXParser::getIntAttribute(atts, "id"));
         pTMXMapInfo->getTileProperties()->setObject(dict, pTMXMapInfo->getParentGID());
         CC_SAFE_RELEASE(dict);
         
@@ -416,17 +402,17 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     else if (elementName == "layer")
     {
         CCTMXLayerInfo *layer = new CCTMXLayerInfo();
-        layer->m_sName = valueForKey("name", attributeDict);
+        layer->m_sName = valueForKey("name", atts);
 
         CCSize s;
-        s.width = (float)atof(valueForKey("width", attributeDict));
-        s.height = (float)atof(valueForKey("height", attributeDict));
+        s.width = CCSAXParser::getFloatAttribute(atts, "width");
+        s.height = CCSAXParser::getFloatAttribute(atts, "height");
         layer->m_tLayerSize = s;
 
-        std::string visible = valueForKey("visible", attributeDict);
+        std::string visible = valueForKey("visible", atts);
         layer->m_bVisible = !(visible == "0");
 
-        std::string opacity = valueForKey("opacity", attributeDict);
+        std::string opacity = valueForKey("opacity", atts);
         if( opacity != "" )
         {
             layer->m_cOpacity = (unsigned char)(255 * atof(opacity.c_str()));
@@ -436,8 +422,8 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             layer->m_cOpacity = 255;
         }
 
-        float x = (float)atof(valueForKey("x", attributeDict));
-        float y = (float)atof(valueForKey("y", attributeDict));
+        float x = CCSAXParser::getFloatAttribute(atts, "x");
+        float y = CCSAXParser::getFloatAttribute(atts, "y");
         layer->m_tOffset = ccp(x,y);
 
         pTMXMapInfo->getLayers()->addObject(layer);
@@ -450,10 +436,10 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     else if (elementName == "objectgroup")
     {
         CCTMXObjectGroup *objectGroup = new CCTMXObjectGroup();
-        objectGroup->setGroupName(valueForKey("name", attributeDict));
+        objectGroup->setGroupName(valueForKey("name", atts));
         CCPoint positionOffset;
-        positionOffset.x = (float)atof(valueForKey("x", attributeDict)) * pTMXMapInfo->getTileSize().width;
-        positionOffset.y = (float)atof(valueForKey("y", attributeDict)) * pTMXMapInfo->getTileSize().height;
+        positionOffset.x = CCSAXParser::getFloatAttribute(atts, "x") * pTMXMapInfo->getTileSize().width;
+        positionOffset.y = CCSAXParser::getFloatAttribute(atts, "y") * pTMXMapInfo->getTileSize().height;
         objectGroup->setPositionOffset(positionOffset);
 
         pTMXMapInfo->getObjectGroups()->addObject(objectGroup);
@@ -468,7 +454,7 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         CCTMXTilesetInfo* tileset = (CCTMXTilesetInfo*)pTMXMapInfo->getTilesets()->lastObject();
 
         // build full path
-        std::string imagename = valueForKey("source", attributeDict);
+        std::string imagename = valueForKey("source", atts);
 
         if (m_sTMXFileName.find_last_of("/") != string::npos)
         {
@@ -482,8 +468,8 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     } 
     else if (elementName == "data")
     {
-        std::string encoding = valueForKey("encoding", attributeDict);
-        std::string compression = valueForKey("compression", attributeDict);
+        std::string encoding = valueForKey("encoding", atts);
+        std::string compression = valueForKey("compression", atts);
 
         if( encoding == "base64" )
         {
@@ -520,7 +506,7 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         for(size_t i = 0; i < sizeof(pArray)/sizeof(pArray[0]); ++i )
         {
             const char* key = pArray[i];
-            CCString* obj = new CCString(valueForKey(key, attributeDict));
+            CCString* obj = new CCString(valueForKey(key, atts));
             if( obj )
             {
                 obj->autorelease();
@@ -531,7 +517,7 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         // But X and Y since they need special treatment
         // X
 
-        const char* value = valueForKey("x", attributeDict);
+        const char* value = valueForKey("x", atts);
         if (value) 
         {
             int x = atoi(value) + (int)objectGroup->getPositionOffset().x;
@@ -542,12 +528,12 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         }
 
         // Y
-        value = valueForKey("y", attributeDict);
+        value = valueForKey("y", atts);
         if (value)  {
             int y = atoi(value) + (int)objectGroup->getPositionOffset().y;
 
             // Correct y position. (Tiled uses Flipped, cocos2d uses Standard)
-            y = (int)(m_tMapSize.height * m_tTileSize.height) - y - atoi(valueForKey("height", attributeDict));
+            y = (int)(m_tMapSize.height * m_tTileSize.height) - y - CCSAXParser::getIntAttribute(atts, "height");
             sprintf(buffer, "%d", y);
             CCString* pStr = new CCString(buffer);
             pStr->autorelease();
@@ -567,13 +553,13 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         if ( pTMXMapInfo->getParentElement() == TMXPropertyNone ) 
         {
             CCLOG( "TMX tile map: Parent element is unsupported. Cannot add property named '%s' with value '%s'",
-                valueForKey("name", attributeDict), valueForKey("value",attributeDict) );
+                valueForKey("name", atts), valueForKey("value", atts) );
         } 
         else if ( pTMXMapInfo->getParentElement() == TMXPropertyMap )
         {
             // The parent element is the map
-            CCString *value = new CCString(valueForKey("value", attributeDict));
-            std::string key = valueForKey("name", attributeDict);
+            CCString *value = new CCString(valueForKey("value", atts));
+            std::string key = valueForKey("name", atts);
             pTMXMapInfo->getProperties()->setObject(value, key.c_str());
             value->release();
 
@@ -582,8 +568,8 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         {
             // The parent element is the last layer
             CCTMXLayerInfo* layer = (CCTMXLayerInfo*)pTMXMapInfo->getLayers()->lastObject();
-            CCString *value = new CCString(valueForKey("value", attributeDict));
-            std::string key = valueForKey("name", attributeDict);
+            CCString *value = new CCString(valueForKey("value", atts));
+            std::string key = valueForKey("name", atts);
             // Add the property to the layer
             layer->getProperties()->setObject(value, key.c_str());
             value->release();
@@ -593,8 +579,8 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         {
             // The parent element is the last object group
             CCTMXObjectGroup* objectGroup = (CCTMXObjectGroup*)pTMXMapInfo->getObjectGroups()->lastObject();
-            CCString *value = new CCString(valueForKey("value", attributeDict));
-            const char* key = valueForKey("name", attributeDict);
+            CCString *value = new CCString(valueForKey("value", atts));
+            const char* key = valueForKey("name", atts);
             objectGroup->getProperties()->setObject(value, key);
             value->release();
 
@@ -605,8 +591,8 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             CCTMXObjectGroup* objectGroup = (CCTMXObjectGroup*)pTMXMapInfo->getObjectGroups()->lastObject();
             CCDictionary* dict = (CCDictionary*)objectGroup->getObjects()->lastObject();
 
-            const char* propertyName = valueForKey("name", attributeDict);
-            CCString *propertyValue = new CCString(valueForKey("value", attributeDict));
+            const char* propertyName = valueForKey("name", atts);
+            CCString *propertyValue = new CCString(valueForKey("value", atts));
             dict->setObject(propertyValue, propertyName);
             propertyValue->release();
         } 
@@ -614,8 +600,8 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         {
             CCDictionary* dict = (CCDictionary*)pTMXMapInfo->getTileProperties()->objectForKey(pTMXMapInfo->getParentGID());
 
-            const char* propertyName = valueForKey("name", attributeDict);
-            CCString *propertyValue = new CCString(valueForKey("value", attributeDict));
+            const char* propertyName = valueForKey("name", atts);
+            CCString *propertyValue = new CCString(valueForKey("value", atts));
             dict->setObject(propertyValue, propertyName);
             propertyValue->release();
         }
@@ -627,7 +613,7 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         CCDictionary* dict = (CCDictionary*)objectGroup->getObjects()->lastObject();
 
         // get points value string
-        const char* value = valueForKey("points", attributeDict);
+        const char* value = valueForKey("points", atts);
         if(value)
         {
             CCArray* pPointsArray = new CCArray;
@@ -680,12 +666,6 @@ void CCTMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         // CCDictionary* dict = (CCDictionary*)objectGroup->getObjects()->lastObject();
         // TODO: dict->setObject:[attributeDict objectForKey:@"points"] forKey:@"polylinePoints"];
     }
-
-    if (attributeDict)
-    {
-        attributeDict->clear();
-        delete attributeDict;
-    }
 }
 
 void CCTMXMapInfo::endElement(void *ctx, const char *name)
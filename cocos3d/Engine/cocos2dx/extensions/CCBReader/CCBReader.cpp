@@ -53,6 +53,238 @@ void CCBFile::setCCBFileNode(CCNode *pNode)
     CC_SAFE_RETAIN(mCCBFileNode);
 }
 
+/*************************************************************************
+ Implementation of CCBTemplate
+ *************************************************************************/
+
+enum {
+    kCCBTemplateModeNone = 0,
+    kCCBTemplateModeRecord,
+    kCCBTemplateModeRecordStopped,
+    kCCBTemplateModeReplay
+};
+
+enum {
+    kCCBTemplateOpByte = 0,
+    kCCBTemplateOpInt,
+    kCCBTemplateOpSignedInt,
+    kCCBTemplateOpFloat
+};
+
+enum {
+    kCCBTemplateTapeEmpty = 0,
+    kCCBTemplateTapeRecording,
+    kCCBTemplateTapeComplete,
+    kCCBTemplateTapeUnusable
+};
+
+/** One value decoded from the body of a .ccbi file, with the read positions around it. */
+struct CCBTemplateOp
+{
+    int kind;
+    int startByte;
+    int startBit;
+    int endByte;
+    int endBit;
+    union {
+        int i;
+        float f;
+    } value;
+};
+
+/**
+ * A .ccbi file parsed once and shared by every CCBReader that loads the same path.
+ *
+ * The header and string table are decoded by the first reader and kept here. That
+ * reader also records every value it decodes from the rest of the file; the node
+ * graph reads are driven only by the file contents, so later readers replay the
+ * recording instead of bit-decoding the bytes again.
+ */
+class CCBTemplate : public CCObject
+{
+public:
+    CCBTemplate(CCData *pData)
+    : mData(pData)
+    , mPrepared(false)
+    , mJSControlled(false)
+    , mBodyOffset(0)
+    , mTapeState(kCCBTemplateTapeEmpty)
+    {
+        CC_SAFE_RETAIN(mData);
+    }
+
+    virtual ~CCBTemplate()
+    {
+        CC_SAFE_RELEASE(mData);
+    }
+
+    CCData *mData;
+    bool mPrepared;
+    bool mJSControlled;
+    int mBodyOffset;
+    std::vector<std::string> mStrings;
+    std::vector<CCBTemplateOp> mOps;
+    int mTapeState;
+};
+
+/** Drops the template cache when the director purges its cached data. */
+class CCBTemplateCachePurger : public CCObject
+{
+public:
+    void purgeCachedData(CCObject *pObject)
+    {
+        CCBReader::purgeTemplateCache();
+    }
+};
+
+static CCDictionary *s_pTemplateCache = NULL;
+static CCBTemplateCachePurger *s_pTemplateCachePurger = NULL;
+
+void CCBReader::purgeTemplateCache()
+{
+    CC_SAFE_RELEASE_NULL(s_pTemplateCache);
+
+    if (s_pTemplateCachePurger)
+    {
+        CCNotificationCenter::sharedNotificationCenter()->removeObserver(s_pTemplateCachePurger, EVENT_PURGE_CACHED_DATA);
+        CC_SAFE_RELEASE_NULL(s_pTemplateCachePurger);
+    }
+}
+
+CCData* CCBReader::acquireTemplate(const char *pFullPath)
+{
+    releaseTemplate();
+
+    if (! s_pTemplateCache)
+    {
+        s_pTemplateCache = new CCDictionary();
+        s_pTemplateCachePurger = new CCBTemplateCachePurger();
+        CCNotificationCenter::sharedNotificationCenter()->addObserver(s_pTemplateCachePurger,
+                                                                      callfuncO_selector(CCBTemplateCachePurger::purgeCachedData),
+                                                                      EVENT_PURGE_CACHED_DATA,
+                                                                      NULL);
+    }
+
+    CCBTemplate *pTemplate = (CCBTemplate*)s_pTemplateCache->objectForKey(pFullPath);
+    if (! pTemplate)
+    {
+        unsigned long size = 0;
+        unsigned char * pBytes = CCFileUtils::sharedFileUtils()->getFileData(pFullPath, "rb", &size);
+        if (! pBytes)
+        {
+            return NULL;
+        }
+
+        CCData *data = new CCData(pBytes, size);
+        CC_SAFE_DELETE_ARRAY(pBytes);
+
+        pTemplate = new CCBTemplate(data);
+        data->release();
+        s_pTemplateCache->setObject(pTemplate, pFullPath);
+        pTemplate->release();
+    }
+
+    mTemplate = pTemplate;
+    mTemplate->retain();
+    return mTemplate->mData;
+}
+
+void CCBReader::releaseTemplate()
+{
+    CC_SAFE_RELEASE_NULL(mTemplate);
+    mTemplateMode = kCCBTemplateModeNone;
+    mTemplateOp = 0;
+}
+
+void CCBReader::beginTemplateTape()
+{
+    mTemplateMode = kCCBTemplateModeNone;
+    mTemplateOp = 0;
+
+    if (! mTemplate)
+    {
+        return;
+    }
+
+    if (mTemplate->mTapeState == kCCBTemplateTapeComplete)
+    {
+        mTemplateMode = kCCBTemplateModeReplay;
+    }
+    else if (mTemplate->mTapeState == kCCBTemplateTapeEmpty)
+    {
+        // A nested load of the same file while it is being recorded decodes live.
+        mTemplate->mTapeState = kCCBTemplateTapeRecording;
+        mTemplateMode = kCCBTemplateModeRecord;
+    }
+}
+
+void CCBReader::endTemplateTape(bool bSucceeded)
+{
+    if (mTemplateMode == kCCBTemplateModeRecord || mTemplateMode == kCCBTemplateModeRecordStopped)
+    {
+        if (bSucceeded && mTemplateMode == kCCBTemplateModeRecord)
+        {
+            mTemplate->mTapeState = kCCBTemplateTapeComplete;
+        }
+        else
+        {
+            mTemplate->mTapeState = kCCBTemplateTapeUnusable;
+            mTemplate->mOps.clear();
+        }
+    }
+    mTemplateMode = kCCBTemplateModeNone;
+}
+
+const CCBTemplateOp* CCBReader::nextTemplateOp(int kind)
+{
+    if (mTemplateMode != kCCBTemplateModeReplay)
+    {
+        return NULL;
+    }
+
+    // The op must be of the requested kind and start where the reader stands;
+    // otherwise the recording no longer describes these reads.
+    const std::vector<CCBTemplateOp>& ops = mTemplate->mOps;
+    if (mTemplateOp < ops.size() && ops[mTemplateOp].kind == kind
+        && ops[mTemplateOp].startByte == mCurrentByte && ops[mTemplateOp].startBit == mCurrentBit)
+    {
+        const CCBTemplateOp *op = &ops[mTemplateOp++];
+        mCurrentByte = op->endByte;
+        mCurrentBit = op->endBit;
+        return op;
+    }
+
+    // The reads went off the recorded path; everything before matched, so the
+    // position is valid and the rest of the file is decoded from the bytes.
+    CCAssert(mTemplateOp >= ops.size() || ops[mTemplateOp].kind != kind, "CCBReader: template op replayed at the wrong position");
+    mTemplateMode = kCCBTemplateModeNone;
+    return NULL;
+}
+
+void CCBReader::recordTemplateOp(int kind, int startByte, int startBit, int iValue, float fValue)
+{
+    if (mTemplateMode != kCCBTemplateModeRecord)
+    {
+        return;
+    }
+
+    CCBTemplateOp op;
+    op.kind = kind;
+    op.startByte = startByte;
+    op.startBit = startBit;
+    op.endByte = mCurrentByte;
+    op.endBit = mCurrentBit;
+    if (kind == kCCBTemplateOpFloat)
+    {
+        op.value.f = fValue;
+    }
+    else
+    {
+        op.value.i = iValue;
+    }
+    mTemplate->mOps.push_back(op);
+}
+
 /*************************************************************************
  Implementation of CCBReader
  *************************************************************************/
@@ -70,6 +302,9 @@ CCBReader::CCBReader(CCNodeLoaderLibrary * pCCNodeLoaderLibrary, CCBMemberVariab
 , mNodesWithAnimationManagers(NULL)
 , mAnimationManagersForNodes(NULL)
 , mOwnerCallbackNodes(NULL)
+, mTemplate(NULL)
+, mTemplateMode(kCCBTemplateModeNone)
+, mTemplateOp(0)
 {
     this->mCCNodeLoaderLibrary = pCCNodeLoaderLibrary;
     this->mCCNodeLoaderLibrary->retain();
@@ -92,6 +327,9 @@ CCBReader::CCBReader(CCBReader * pCCBReader)
 , mNodesWithAnimationManagers(NULL)
 , mAnimationManagersForNodes(NULL)
 , mOwnerCallbackNodes(NULL)
+, mTemplate(NULL)
+, mTemplateMode(kCCBTemplateModeNone)
+, mTemplateOp(0)
 {
     this->mLoadedSpriteSheets = pCCBReader->mLoadedSpriteSheets;
     this->mCCNodeLoaderLibrary = pCCBReader->mCCNodeLoaderLibrary;
@@ -119,6 +357,9 @@ CCBReader::CCBReader()
 , mCCBSelectorResolver(NULL)
 , mNodesWithAnimationManagers(NULL)
 , mAnimationManagersForNodes(NULL)
+, mTemplate(NULL)
+, mTemplateMode(kCCBTemplateModeNone)
+, mTemplateOp(0)
 {
     init();
 }
@@ -126,6 +367,7 @@ CCBReader::CCBReader()
 CCBReader::~CCBReader() {
     CC_SAFE_RELEASE_NULL(mOwner);
     CC_SAFE_RELEASE_NULL(mData);
+    releaseTemplate();
 
     this->mCCNodeLoaderLibrary->release();
 
@@ -241,15 +483,16 @@ CCNode* CCBReader::readNodeGraphFromFile(const char *pCCBFileName, CCObject *pOw
     }
 
     std::string strPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(strCCBFileName.c_str());
-    unsigned long size = 0;
 
-    unsigned char * pBytes = CCFileUtils::sharedFileUtils()->getFileData(strPath.c_str(), "rb", &size);
-    CCData *data = new CCData(pBytes, size);
-    CC_SAFE_DELETE_ARRAY(pBytes);
+    CCData *data = acquireTemplate(strPath.c_str());
+    if (! data)
+    {
+        return NULL;
+    }
 
     CCNode *ret =  this->readNodeGraphFromData(data, pOwner, parentSize);
-    
-    data->release();
+
+    releaseTemplate();
     
     return ret;
 }
@@ -330,18 +573,39 @@ void CCBReader::cleanUpNodeGraph(CCNode *pNode)
 
 CCNode* CCBReader::readFileWithCleanUp(bool bCleanUp, CCDictionary* am)
 {
-    if (! readHeader())
+    if (mTemplate && mTemplate->mPrepared)
     {
-        return NULL;
+        jsControlled = mTemplate->mJSControlled;
+        mActionManager->jsControlled = jsControlled;
+        mCurrentByte = mTemplate->mBodyOffset;
+        mCurrentBit = 0;
     }
-    
-    if (! readStringCache())
+    else
     {
-        return NULL;
+        if (! readHeader())
+        {
+            return NULL;
+        }
+        
+        if (! readStringCache())
+        {
+            return NULL;
+        }
+
+        if (mTemplate)
+        {
+            mTemplate->mStrings.swap(mStringCache);
+            mTemplate->mJSControlled = jsControlled;
+            mTemplate->mBodyOffset = mCurrentByte;
+            mTemplate->mPrepared = true;
+        }
     }
+
+    beginTemplateTape();
     
     if (! readSequences())
     {
+        endTemplateTape(false);
         return NULL;
     }
     
@@ -349,6 +613,8 @@ CCNode* CCBReader::readFileWithCleanUp(bool bCleanUp, CCDictionary* am)
 
     CCNode *pNode = readNodeGraph(NULL);
 
+    endTemplateTape(pNode != NULL);
+
     mActionManagers->setObject(mActionManager, intptr_t(pNode));
 
     if (bCleanUp)
@@ -399,6 +665,18 @@ bool CCBReader::readHeader()
 }
 
 unsigned char CCBReader::readByte() {
+    const CCBTemplateOp *op = nextTemplateOp(kCCBTemplateOpByte);
+    if (op) {
+        return (unsigned char)op->value.i;
+    }
+
+    int startByte = mCurrentByte, startBit = mCurrentBit;
+    unsigned char byte = this->decodeByte();
+    recordTemplateOp(kCCBTemplateOpByte, startByte, startBit, byte, 0);
+    return byte;
+}
+
+unsigned char CCBReader::decodeByte() {
     unsigned char byte = this->mBytes[this->mCurrentByte];
     this->mCurrentByte++;
     return byte;
@@ -412,8 +690,18 @@ std::string CCBReader::readUTF8()
 {
     std::string ret;
 
-    int b0 = this->readByte();
-    int b1 = this->readByte();
+    // Inline strings are not recorded; leave the template tape and decode the rest live.
+    if (mTemplateMode == kCCBTemplateModeRecord)
+    {
+        mTemplateMode = kCCBTemplateModeRecordStopped;
+    }
+    else if (mTemplateMode == kCCBTemplateModeReplay)
+    {
+        mTemplateMode = kCCBTemplateModeNone;
+    }
+
+    int b0 = this->decodeByte();
+    int b1 = this->decodeByte();
 
     int numBytes = b0 << 8 | b1;
 
@@ -455,6 +743,19 @@ void CCBReader::alignBits() {
 }
 
 int CCBReader::readInt(bool pSigned) {
+    int kind = pSigned ? kCCBTemplateOpSignedInt : kCCBTemplateOpInt;
+    const CCBTemplateOp *op = nextTemplateOp(kind);
+    if (op) {
+        return op->value.i;
+    }
+
+    int startByte = mCurrentByte, startBit = mCurrentBit;
+    int num = this->decodeInt(pSigned);
+    recordTemplateOp(kind, startByte, startBit, num, 0);
+    return num;
+}
+
+int CCBReader::decodeInt(bool pSigned) {
     // Read encoded int
     int numBits = 0;
     while(!this->getBit()) {
@@ -488,7 +789,19 @@ int CCBReader::readInt(bool pSigned) {
 
 
 float CCBReader::readFloat() {
-    unsigned char type = this->readByte();
+    const CCBTemplateOp *op = nextTemplateOp(kCCBTemplateOpFloat);
+    if (op) {
+        return op->value.f;
+    }
+
+    int startByte = mCurrentByte, startBit = mCurrentBit;
+    float f = this->decodeFloat();
+    recordTemplateOp(kCCBTemplateOpFloat, startByte, startBit, 0, f);
+    return f;
+}
+
+float CCBReader::decodeFloat() {
+    unsigned char type = this->decodeByte();
     
     switch (type) {
         case kCCBFloat0:
@@ -500,7 +813,7 @@ float CCBReader::readFloat() {
         case kCCBFloat05:
             return 0.5f;
         case kCCBFloatInteger:
-            return (float)this->readInt(true);
+            return (float)this->decodeInt(true);
         default:
             {
                 /* using a memcpy since the compiler isn't
@@ -530,6 +843,10 @@ float CCBReader::readFloat() {
 
 std::string CCBReader::readCachedString() {
     int n = this->readInt(false);
+    if (mTemplate && mTemplate->mPrepared)
+    {
+        return mTemplate->mStrings[n];
+    }
     return this->mStringCache[n];
 }
 
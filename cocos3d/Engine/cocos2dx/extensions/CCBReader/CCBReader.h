@@ -165,6 +165,8 @@ class CCBSelectorResolver;
 class CCBAnimationManager;
 class CCData;
 class CCBKeyframe;
+class CCBTemplate;
+struct CCBTemplateOp;
 
 /**
  * @brief Parse CCBI file which is generated by CocosBuilder
@@ -203,6 +205,10 @@ private:
     CCArray* mOwnerOwnerCallbackControlEvents;
     std::string mCCBRootPath;
     bool hasScriptingOwner;    
+
+    CCBTemplate *mTemplate;         // retain
+    int mTemplateMode;
+    unsigned int mTemplateOp;
     bool init();
 public:
     
@@ -249,6 +255,16 @@ public:
      *  @lua NA
      */
     CCNode* readNodeGraphFromData(CCData *pData, CCObject *pOwner, const CCSize &parentSize);
+    /** Releases the parsed .ccbi templates kept by readNodeGraphFromFile().
+     *
+     * The first load of a file keeps its bytes, string table and the sequence of values
+     * decoded from it; later loads of the same path replay those values instead of
+     * reading and bit-decoding the file again. Call this after replacing .ccbi files
+     * on disk. CCDirector::purgeCachedData() also releases them.
+     *  @js NA
+     *  @lua NA
+     */
+    static void purgeTemplateCache();
     /**
      *  @js loadScene
      *  @lua NA
@@ -429,6 +445,17 @@ private:
     bool getBit();
     void alignBits();
 
+    unsigned char decodeByte();
+    int decodeInt(bool pSigned);
+    float decodeFloat();
+
+    CCData* acquireTemplate(const char *pFullPath);
+    void releaseTemplate();
+    void beginTemplateTape();
+    void endTemplateTape(bool bSucceeded);
+    const CCBTemplateOp* nextTemplateOp(int kind);
+    void recordTemplateOp(int kind, int startByte, int startBit, int iValue, float fValue);
+
     friend class CCNodeLoader;
 };
 
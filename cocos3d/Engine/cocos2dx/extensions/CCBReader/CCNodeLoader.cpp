@@ -873,19 +873,17 @@ CCNode * CCNodeLoader::parsePropTypeCCBFile(CCNode * pNode, CCNode * pParent, CC
     
     // Load sub file
     std::string path = CCFileUtils::sharedFileUtils()->fullPathForFilename(ccbFileName.c_str());
-    unsigned long size = 0;
-    unsigned char * pBytes = CCFileUtils::sharedFileUtils()->getFileData(path.c_str(), "rb", &size);
 
     CCBReader * ccbReader = new CCBReader(pCCBReader);
     ccbReader->autorelease();
     ccbReader->getAnimationManager()->setRootContainerSize(pParent->getContentSize());
     
-    CCData *data = new CCData(pBytes, size);
-    CC_SAFE_DELETE_ARRAY(pBytes);
+    // Sub files share the parsed template cache with CCBReader::readNodeGraphFromFile().
+    CCData *data = ccbReader->acquireTemplate(path.c_str());
 
-    data->retain();
+    CC_SAFE_RETAIN(data);
     ccbReader->mData = data;
-    ccbReader->mBytes = data->getBytes();
+    ccbReader->mBytes = data ? data->getBytes() : NULL;
     ccbReader->mCurrentByte = 0;
     ccbReader->mCurrentBit = 0;
     CC_SAFE_RETAIN(pCCBReader->mOwner);
@@ -900,8 +898,6 @@ CCNode * CCNodeLoader::parsePropTypeCCBFile(CCNode * pNode, CCNode * pParent, CC
 //     ccbReader->mOwnerCallbackNames = pCCBReader->mOwnerCallbackNames;
 //     ccbReader->mOwnerCallbackNodes = pCCBReader->mOwnerCallbackNodes;
 //     ccbReader->mOwnerCallbackNodes->retain();
-
-    data->release();
     
     CCNode * ccbFileNode = ccbReader->readFileWithCleanUp(false, pCCBReader->getAnimationManagers());
     
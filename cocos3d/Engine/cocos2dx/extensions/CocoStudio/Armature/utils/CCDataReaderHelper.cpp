@@ -36,6 +36,9 @@ THE SOFTWARE.
 #include <cctype>
 #include <queue>
 #include <list>
+#include <map>
+#include <set>
+#include <vector>
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
 #include <pthread.h>
 #else
@@ -44,6 +47,9 @@ THE SOFTWARE.
 #include <ppltasks.h>
 using namespace concurrency;
 #endif
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+#include <unistd.h>
+#endif
 
 static const char *VERSION = "version";
 static const float VERSION_2_0 = 2.0f;
@@ -166,12 +172,14 @@ enum ConfigType
 typedef struct _AsyncStruct
 {
     std::string    filename;
+    std::string    fullPath;
     std::string    fileContent;
     ConfigType     configType;
     std::string    baseFilePath;
     CCObject       *target;
     SEL_SCHEDULE   selector;
     bool           autoLoadSpriteFile;
+    unsigned int   sequence;
     
     std::string    imagePath;
     std::string    plistPath;
@@ -186,21 +194,51 @@ typedef struct _DataInfo
     std::string    baseFilePath;
     float flashToolVersion;
     float cocoStudioVersion;
-} DataInfo;
-
 
-static pthread_t s_loadingThread;
-
-static pthread_mutex_t		s_SleepMutex;
-static pthread_cond_t		s_SleepCondition;
-
-static pthread_mutex_t      s_asyncStructQueueMutex;
-static pthread_mutex_t      s_DataInfoMutex;
+    // When loading asynchronously, the decoded data is held here until it is committed
+    // to CCArmatureDataManager on the main thread. It is not changed after decoding.
+    std::vector<CCArmatureData *>   armatureDatas;
+    std::vector<CCAnimationData *>  animationDatas;
+    std::vector<CCTextureData *>    textureDatas;
+} DataInfo;
 
-static pthread_mutex_t      s_addDataMutex;
+/**
+ * One file loaded by the worker pool. Files are decoded in two stages. The first decodes
+ * everything except XML animations, and the second decodes XML animations, which look up the
+ * armature data they belong to. An XML animation whose armature is not in its own file waits
+ * until that armature has been decoded from an earlier file, or until every earlier file has
+ * been through its first stage, so it resolves to the same armature as a synchronous load.
+ */
+typedef struct _LoadJob
+{
+    AsyncStruct                 *asyncStruct;
+    DataInfo                    *dataInfo;
+    tinyxml2::XMLDocument       *document;
+} LoadJob;
+
+#define kArmatureMaxLoadingThreadCount     4
+
+static std::vector<pthread_t> s_loadingThreads;
+static unsigned int s_nLoadingThreadCount = 0;
+static float s_fCommitTimeBudget = 1.0f / 240;
+
+// guards the job queues, the dependency state, and the armature data of CCArmatureDataManager
+static pthread_mutex_t      s_jobMutex;
+static pthread_cond_t       s_jobCondition;
+static std::list<LoadJob *> *s_pReadyJobs = NULL;
+static std::list<LoadJob *> s_waitingJobs;
+static std::set<unsigned int> s_pendingFirstStages;
+static std::multimap<std::string, std::pair<unsigned int, CCArmatureData *> > s_decodedArmatures;
+
+// CCFileUtils reads files through shared handles on some platforms
 static pthread_mutex_t      s_ReadFileMutex;
 
-static pthread_mutex_t      s_GetFileDataMutex;
+// decoded files, committed on the main thread in the order they were requested
+static pthread_mutex_t      s_commitMutex;
+static std::vector<DataInfo *> s_commitQueue;
+static std::map<unsigned int, DataInfo *> s_decodedData;
+static unsigned int s_nNextSequence = 0;
+static unsigned int s_nNextCommitSequence = 0;
 
 #ifdef EMSCRIPTEN
 // Hack to get ASM.JS validation (no undefined symbols allowed).
@@ -212,100 +250,385 @@ static unsigned long s_nAsyncRefTotalCount = 0;
 
 static bool need_quit = false;
 
-static std::queue<AsyncStruct *> *s_pAsyncStructQueue = NULL;
-static std::queue<DataInfo *>   *s_pDataQueue = NULL;
+static void *loadData(void *);
 
-static void addData(AsyncStruct *pAsyncStruct)
+static unsigned int getProcessorCount()
 {
-    std::string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(pAsyncStruct->filename.c_str());
-    unsigned long size;
-    pthread_mutex_lock(&s_GetFileDataMutex);
-	std::string readmode = "r";
-	bool isbinary = pAsyncStruct->configType == CocoStudio_Binary;
-	if(isbinary)
-		readmode += "b";
-	unsigned char *pBytes = CCFileUtils::sharedFileUtils()->getFileData(fullPath.c_str() , readmode.c_str(), &size);
-	CCData data(pBytes, size);
-    CC_SAFE_DELETE_ARRAY(pBytes);
-	pAsyncStruct->fileContent = std::string((const char*)data.getBytes(), data.getSize());
-    pthread_mutex_unlock(&s_GetFileDataMutex);
-
-    // generate data info
-    DataInfo *pDataInfo = new DataInfo();
-    pDataInfo->asyncStruct = pAsyncStruct;
-    pDataInfo->filename = pAsyncStruct->filename;
-    pDataInfo->baseFilePath = pAsyncStruct->baseFilePath;
+#ifdef _SC_NPROCESSORS_ONLN
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cpuCount > 1) ? (unsigned int)cpuCount : 1;
+#else
+    return 2;
+#endif
+}
+
+static bool isLoadingAsync(DataInfo *dataInfo)
+{
+    return dataInfo && dataInfo->asyncStruct;
+}
+
+static void storeArmatureData(CCArmatureData *armatureData, DataInfo *dataInfo)
+{
+    if (isLoadingAsync(dataInfo))
+    {
+        dataInfo->armatureDatas.push_back(armatureData);
+        return;
+    }
 
-    if (pAsyncStruct->configType == DragonBone_XML)
+    // lock against workers looking up armature data, if there are any
+    if (s_pReadyJobs)
     {
-        CCDataReaderHelper::addDataFromCache(pAsyncStruct->fileContent.c_str(), pDataInfo);
+        pthread_mutex_lock(&s_jobMutex);
     }
-    else if(pAsyncStruct->configType == CocoStudio_JSON)
+    CCArmatureDataManager::sharedArmatureDataManager()->addArmatureData(armatureData->name.c_str(), armatureData, dataInfo->filename.c_str());
+    if (s_pReadyJobs)
     {
-        CCDataReaderHelper::addDataFromJsonCache(pAsyncStruct->fileContent.c_str(), pDataInfo);
+        pthread_mutex_unlock(&s_jobMutex);
     }
-	else if(isbinary)
-	{
-		CCDataReaderHelper::addDataFromBinaryCache(pAsyncStruct->fileContent.c_str(),pDataInfo);
-	}
+    armatureData->release();
+}
 
-    // put the image info into the queue
-    pthread_mutex_lock(&s_DataInfoMutex);
-    s_pDataQueue->push(pDataInfo);
-    pthread_mutex_unlock(&s_DataInfoMutex);
+static void storeAnimationData(CCAnimationData *animationData, DataInfo *dataInfo)
+{
+    if (isLoadingAsync(dataInfo))
+    {
+        dataInfo->animationDatas.push_back(animationData);
+        return;
+    }
+    CCArmatureDataManager::sharedArmatureDataManager()->addAnimationData(animationData->name.c_str(), animationData, dataInfo->filename.c_str());
+    animationData->release();
 }
 
-static void *loadData(void *)
+static void storeTextureData(CCTextureData *textureData, DataInfo *dataInfo)
 {
-    while (true)
+    if (isLoadingAsync(dataInfo))
     {
-        // create autorelease pool for iOS
-        CCThread thread;
-        thread.createAutoreleasePool();
+        dataInfo->textureDatas.push_back(textureData);
+        return;
+    }
+    CCArmatureDataManager::sharedArmatureDataManager()->addTextureData(textureData->name.c_str(), textureData, dataInfo->filename.c_str());
+    textureData->release();
+}
 
-        std::queue<AsyncStruct *> *pQueue = s_pAsyncStructQueue;
-        pthread_mutex_lock(&s_asyncStructQueueMutex);// get async struct from queue
-        if (pQueue->empty())
+// Returns the armature decoded from the same file, or from the latest earlier file, and the sequence
+// of the file it comes from. Called with s_jobMutex held.
+static CCArmatureData *findDecodedArmatureData(const char *name, DataInfo *dataInfo, unsigned int *pSequence = NULL)
+{
+    for (std::vector<CCArmatureData *>::reverse_iterator it = dataInfo->armatureDatas.rbegin(); it != dataInfo->armatureDatas.rend(); ++it)
+    {
+        if ((*it)->name == name)
         {
-            pthread_mutex_unlock(&s_asyncStructQueueMutex);
-            if (need_quit)
-            {
-                break;
-            }
-            else
+            if (pSequence)
             {
-                pthread_cond_wait(&s_SleepCondition, &s_SleepMutex);
-                continue;
+                *pSequence = dataInfo->asyncStruct->sequence;
             }
+            return *it;
+        }
+    }
+
+    CCArmatureData *armatureData = NULL;
+    unsigned int latest = 0;
+    typedef std::multimap<std::string, std::pair<unsigned int, CCArmatureData *> >::iterator DecodedIterator;
+    std::pair<DecodedIterator, DecodedIterator> range = s_decodedArmatures.equal_range(name);
+    for (DecodedIterator it = range.first; it != range.second; ++it)
+    {
+        if (it->second.first < dataInfo->asyncStruct->sequence && (!armatureData || it->second.first >= latest))
+        {
+            latest = it->second.first;
+            armatureData = it->second.second;
+        }
+    }
+    if (armatureData && pSequence)
+    {
+        *pSequence = latest;
+    }
+    return armatureData;
+}
+
+static bool hasPendingFirstStageBefore(unsigned int sequence)
+{
+    return !s_pendingFirstStages.empty() && *s_pendingFirstStages.begin() < sequence;
+}
+
+// Whether a file added after first and before last has not finished its first stage yet
+static bool hasPendingFirstStageBetween(unsigned int first, unsigned int last)
+{
+    std::set<unsigned int>::iterator it = s_pendingFirstStages.upper_bound(first);
+    return it != s_pendingFirstStages.end() && *it < last;
+}
+
+static CCArmatureData *findArmatureData(const char *name, DataInfo *dataInfo)
+{
+    if (!isLoadingAsync(dataInfo))
+    {
+        return CCArmatureDataManager::sharedArmatureDataManager()->getArmatureData(name);
+    }
+
+    pthread_mutex_lock(&s_jobMutex);
+    CCArmatureData *armatureData = findDecodedArmatureData(name, dataInfo);
+    if (!armatureData)
+    {
+        armatureData = CCArmatureDataManager::sharedArmatureDataManager()->getArmatureData(name);
+    }
+    pthread_mutex_unlock(&s_jobMutex);
+    return armatureData;
+}
+
+// Whether the armatures the XML animations of the job need are decided. Called with s_jobMutex held.
+static bool canDecodeAnimations(LoadJob *job)
+{
+    if (!hasPendingFirstStageBefore(job->asyncStruct->sequence))
+    {
+        return true;
+    }
+
+    tinyxml2::XMLElement *root = job->document->RootElement();
+    tinyxml2::XMLElement *animationsXML = root ? root->FirstChildElement(ANIMATIONS) : NULL;
+    tinyxml2::XMLElement *animationXML = animationsXML ? animationsXML->FirstChildElement(ANIMATION) : NULL;
+    for (; animationXML; animationXML = animationXML->NextSiblingElement(ANIMATION))
+    {
+        const char *name = animationXML->Attribute(A_NAME);
+        if (!name)
+        {
+            continue;
+        }
+        // a file still decoding between the armature and the job may define a later armature of that name
+        unsigned int armatureSequence = 0;
+        if (!findDecodedArmatureData(name, job->dataInfo, &armatureSequence)
+            || hasPendingFirstStageBetween(armatureSequence, job->asyncStruct->sequence))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void wakeLoadingThread()
+{
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+    pthread_cond_signal(&s_jobCondition);
+#else
+    // WinRT uses an Async Task per job since the ThreadPool has a limited number of threads
+    create_task([] {
+        loadData(NULL);
+    });
+#endif
+}
+
+// Publishes the armatures of a job that finished its first stage, and releases the jobs waiting on them
+static void finishFirstStage(LoadJob *job)
+{
+    pthread_mutex_lock(&s_jobMutex);
+
+    unsigned int sequence = job->asyncStruct->sequence;
+    s_pendingFirstStages.erase(sequence);
+    std::vector<CCArmatureData *> &armatureDatas = job->dataInfo->armatureDatas;
+    for (size_t i = 0; i < armatureDatas.size(); ++i)
+    {
+        armatureDatas[i]->retain();
+        s_decodedArmatures.insert(std::make_pair(armatureDatas[i]->name, std::make_pair(sequence, armatureDatas[i])));
+    }
+
+    std::list<LoadJob *>::iterator it = s_waitingJobs.begin();
+    while (it != s_waitingJobs.end())
+    {
+        if (canDecodeAnimations(*it))
+        {
+            s_pReadyJobs->push_front(*it);
+            it = s_waitingJobs.erase(it);
+            wakeLoadingThread();
         }
         else
         {
-            AsyncStruct *pAsyncStruct = pQueue->front();
-            pQueue->pop();
-            pthread_mutex_unlock(&s_asyncStructQueueMutex);
-            addData(pAsyncStruct);
-       }
+            ++it;
+        }
+    }
+
+    pthread_mutex_unlock(&s_jobMutex);
+}
+
+static void decodeXMLArmatures(tinyxml2::XMLElement *root, DataInfo *dataInfo)
+{
+    root->QueryFloatAttribute(VERSION, &dataInfo->flashToolVersion);
+
+    /*
+    * Begin decode armature data from xml
+    */
+    tinyxml2::XMLElement *armaturesXML = root->FirstChildElement(ARMATURES);
+    tinyxml2::XMLElement *armatureXML = armaturesXML->FirstChildElement(ARMATURE);
+    while(armatureXML)
+    {
+        CCArmatureData *armatureData = CCDataReaderHelper::decodeArmature(armatureXML, dataInfo);
+
+        storeArmatureData(armatureData, dataInfo);
+
+        armatureXML = armatureXML->NextSiblingElement(ARMATURE);
+    }
+
+
+    /*
+    * Begin decode texture data from xml
+    */
+    tinyxml2::XMLElement *texturesXML = root->FirstChildElement(TEXTURE_ATLAS);
+    tinyxml2::XMLElement *textureXML = texturesXML->FirstChildElement(SUB_TEXTURE);
+    while(textureXML)
+    {
+        CCTextureData *textureData = CCDataReaderHelper::decodeTexture(textureXML, dataInfo);
+
+        storeTextureData(textureData, dataInfo);
+        textureXML = textureXML->NextSiblingElement(SUB_TEXTURE);
+    }
+}
+
+static void decodeXMLAnimations(tinyxml2::XMLElement *root, DataInfo *dataInfo)
+{
+    /*
+    * Begin decode animation data from xml
+    */
+    tinyxml2::XMLElement *animationsXML = root->FirstChildElement(ANIMATIONS);
+    tinyxml2::XMLElement *animationXML = animationsXML->FirstChildElement(ANIMATION);
+    while(animationXML)
+    {
+        CCAnimationData *animationData = CCDataReaderHelper::decodeAnimation(animationXML, dataInfo);
+        storeAnimationData(animationData, dataInfo);
+        animationXML = animationXML->NextSiblingElement(ANIMATION);
     }
+}
+
+static void addData(LoadJob *job)
+{
+    AsyncStruct *pAsyncStruct = job->asyncStruct;
+    DataInfo *pDataInfo = job->dataInfo;
 
-    if( s_pAsyncStructQueue != NULL )
+    if (job->document == NULL)
     {
-        delete s_pAsyncStructQueue;
-        s_pAsyncStructQueue = NULL;
-        delete s_pDataQueue;
-        s_pDataQueue = NULL;
+        unsigned long size = 0;
+        bool isbinary = pAsyncStruct->configType == CocoStudio_Binary;
+        pthread_mutex_lock(&s_ReadFileMutex);
+        unsigned char *pBytes = CCFileUtils::sharedFileUtils()->getFileData(pAsyncStruct->fullPath.c_str(), isbinary ? "rb" : "r", &size);
+        pthread_mutex_unlock(&s_ReadFileMutex);
+        pAsyncStruct->fileContent = std::string((const char*)pBytes, pBytes ? size : 0);
+        CC_SAFE_DELETE_ARRAY(pBytes);
+
+        if (pAsyncStruct->configType == DragonBone_XML)
+        {
+            job->document = new tinyxml2::XMLDocument();
+            job->document->Parse(pAsyncStruct->fileContent.c_str());
+            tinyxml2::XMLElement *root = job->document->RootElement();
+            CCAssert(root, "XML error  or  XML is empty.");
+            decodeXMLArmatures(root, pDataInfo);
+        }
+        else if(pAsyncStruct->configType == CocoStudio_JSON)
+        {
+            CCDataReaderHelper::addDataFromJsonCache(pAsyncStruct->fileContent.c_str(), pDataInfo);
+        }
+        else if(isbinary)
+        {
+            CCDataReaderHelper::addDataFromBinaryCache(pAsyncStruct->fileContent.c_str(), pDataInfo);
+        }
+
+        finishFirstStage(job);
+
+        if (job->document)
+        {
+            pthread_mutex_lock(&s_jobMutex);
+            bool bReady = canDecodeAnimations(job);
+            if (!bReady)
+            {
+                s_waitingJobs.push_back(job);
+            }
+            pthread_mutex_unlock(&s_jobMutex);
+            if (!bReady)
+            {
+                return;
+            }
+        }
+    }
 
-        pthread_mutex_destroy(&s_asyncStructQueueMutex);
-        pthread_mutex_destroy(&s_DataInfoMutex);
-        pthread_mutex_destroy(&s_SleepMutex);
-        pthread_mutex_destroy(&s_addDataMutex);
-        pthread_mutex_destroy(&s_ReadFileMutex);
-        pthread_mutex_destroy(&s_GetFileDataMutex);
-        pthread_cond_destroy(&s_SleepCondition);
+    if (job->document)
+    {
+        decodeXMLAnimations(job->document->RootElement(), pDataInfo);
+        CC_SAFE_DELETE(job->document);
+    }
+    pAsyncStruct->fileContent.clear();
+    delete job;
+
+    // put the data info into the commit queue
+    pthread_mutex_lock(&s_commitMutex);
+    s_commitQueue.push_back(pDataInfo);
+    pthread_mutex_unlock(&s_commitMutex);
+}
+
+static void *loadData(void *)
+{
+    while (true)
+    {
+        // create autorelease pool for iOS
+        CCThread thread;
+        thread.createAutoreleasePool();
+
+        pthread_mutex_lock(&s_jobMutex);
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+        while (s_pReadyJobs->empty() && !need_quit)
+        {
+            pthread_cond_wait(&s_jobCondition, &s_jobMutex);
+        }
+#endif
+        if (s_pReadyJobs->empty() || need_quit)
+        {
+            pthread_mutex_unlock(&s_jobMutex);
+            break;
+        }
+        LoadJob *job = s_pReadyJobs->front();
+        s_pReadyJobs->pop_front();
+        pthread_mutex_unlock(&s_jobMutex);
+
+        addData(job);
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT) || (CC_TARGET_PLATFORM == CC_PLATFORM_WP8)
+        // each task runs a single job
+        break;
+#endif
     }
 
     return NULL;
 }
 
+static void commitData(DataInfo *pDataInfo)
+{
+    CCArmatureDataManager *manager = CCArmatureDataManager::sharedArmatureDataManager();
+    const char *filename = pDataInfo->filename.c_str();
+
+    pthread_mutex_lock(&s_jobMutex);
+    for (size_t i = 0; i < pDataInfo->armatureDatas.size(); ++i)
+    {
+        manager->addArmatureData(pDataInfo->armatureDatas[i]->name.c_str(), pDataInfo->armatureDatas[i], filename);
+    }
+    pthread_mutex_unlock(&s_jobMutex);
+
+    for (size_t i = 0; i < pDataInfo->animationDatas.size(); ++i)
+    {
+        manager->addAnimationData(pDataInfo->animationDatas[i]->name.c_str(), pDataInfo->animationDatas[i], filename);
+    }
+    for (size_t i = 0; i < pDataInfo->textureDatas.size(); ++i)
+    {
+        manager->addTextureData(pDataInfo->textureDatas[i]->name.c_str(), pDataInfo->textureDatas[i], filename);
+    }
+
+    // the manager holds the data now, and s_decodedArmatures holds the armatures until loading is idle
+    for (size_t i = 0; i < pDataInfo->armatureDatas.size(); ++i)
+    {
+        pDataInfo->armatureDatas[i]->release();
+    }
+    for (size_t i = 0; i < pDataInfo->animationDatas.size(); ++i)
+    {
+        pDataInfo->animationDatas[i]->release();
+    }
+    for (size_t i = 0; i < pDataInfo->textureDatas.size(); ++i)
+    {
+        pDataInfo->textureDatas[i]->release();
+    }
+}
 
 CCDataReaderHelper *CCDataReaderHelper::sharedDataReaderHelper()
 {
@@ -328,6 +651,16 @@ float CCDataReaderHelper::getPositionReadScale()
 }
 
 
+void CCDataReaderHelper::setAsyncLoadingThreadCount(unsigned int count)
+{
+    s_nLoadingThreadCount = count;
+}
+
+void CCDataReaderHelper::setAsyncCommitTimeBudget(float budget)
+{
+    s_fCommitTimeBudget = budget;
+}
+
 void CCDataReaderHelper::purge()
 {
     s_arrConfigFileList.clear();
@@ -337,8 +670,24 @@ void CCDataReaderHelper::purge()
 
 CCDataReaderHelper::~CCDataReaderHelper()
 {
+    if (s_pReadyJobs == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_jobMutex);
     need_quit = true;
-    pthread_cond_signal(&s_SleepCondition);
+    for (size_t i = 0; i < s_loadingThreads.size(); ++i)
+    {
+        pthread_cond_signal(&s_jobCondition);
+    }
+    pthread_mutex_unlock(&s_jobMutex);
+
+    for (size_t i = 0; i < s_loadingThreads.size(); ++i)
+    {
+        pthread_join(s_loadingThreads[i], NULL);
+    }
+    s_loadingThreads.clear();
 }
 
 void CCDataReaderHelper::addDataFromFile(const char *filePath)
@@ -452,23 +801,30 @@ void CCDataReaderHelper::addDataFromFileAsync(const char *imagePath, const char
 
 
     // lazy init
-    if (s_pAsyncStructQueue == NULL)
+    if (s_pReadyJobs == NULL)
     {
-        s_pAsyncStructQueue = new std::queue<AsyncStruct *>();
-        s_pDataQueue = new std::queue<DataInfo *>();
+        s_pReadyJobs = new std::list<LoadJob *>();
 
-        pthread_mutex_init(&s_asyncStructQueueMutex, NULL);
-        pthread_mutex_init(&s_DataInfoMutex, NULL);
-        pthread_mutex_init(&s_SleepMutex, NULL);
-        pthread_mutex_init(&s_addDataMutex, NULL);
+        pthread_mutex_init(&s_jobMutex, NULL);
         pthread_mutex_init(&s_ReadFileMutex, NULL);
-        pthread_mutex_init(&s_GetFileDataMutex, NULL);
-        pthread_cond_init(&s_SleepCondition, NULL);
- #if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
-        pthread_create(&s_loadingThread, NULL, loadData, NULL);
-#endif
+        pthread_mutex_init(&s_commitMutex, NULL);
+        pthread_cond_init(&s_jobCondition, NULL);
+    }
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+    if (s_loadingThreads.empty())
+    {
         need_quit = false;
+        unsigned int threadCount = s_nLoadingThreadCount ? s_nLoadingThreadCount : MIN(getProcessorCount(), (unsigned int)kArmatureMaxLoadingThreadCount);
+        for (unsigned int i = 0; i < threadCount; ++i)
+        {
+            pthread_t thread;
+            if (pthread_create(&thread, NULL, loadData, NULL) == 0)
+            {
+                s_loadingThreads.push_back(thread);
+            }
+        }
     }
+#endif
 
     if (0 == s_nAsyncRefCount)
     {
@@ -483,9 +839,11 @@ void CCDataReaderHelper::addDataFromFileAsync(const char *imagePath, const char
         target->retain();
     }
 
-    // generate async struct
+    // generate async struct, resolving the path here since the path cache is not thread safe
     AsyncStruct *data = new AsyncStruct();
     data->filename = filePath;
+    data->fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(filePath);
+    data->sequence = s_nNextSequence++;
     data->baseFilePath = basefilePath;
     data->target = target;
     data->selector = selector;
@@ -511,54 +869,63 @@ void CCDataReaderHelper::addDataFromFileAsync(const char *imagePath, const char
 		data->configType = CocoStudio_Binary;
 	}
 
-#if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
-    // add async struct into queue
-    pthread_mutex_lock(&s_asyncStructQueueMutex);
-    s_pAsyncStructQueue->push(data);
-    pthread_mutex_unlock(&s_asyncStructQueueMutex);
-
-    pthread_cond_signal(&s_SleepCondition);
-#else
-    // WinRT uses an Async Task to load the image since the ThreadPool has a limited number of threads
-    create_task([this, data] {
-        addData(data);
-    });
-#endif
+    // generate the job, whose decoded data is committed in sequence by addDataAsyncCallBack
+    DataInfo *pDataInfo = new DataInfo();
+    pDataInfo->asyncStruct = data;
+    pDataInfo->filename = data->filename;
+    pDataInfo->baseFilePath = data->baseFilePath;
+
+    LoadJob *job = new LoadJob();
+    job->asyncStruct = data;
+    job->dataInfo = pDataInfo;
+    job->document = NULL;
+
+    // add the job into the queue
+    pthread_mutex_lock(&s_jobMutex);
+    s_pendingFirstStages.insert(data->sequence);
+    s_pReadyJobs->push_back(job);
+    wakeLoadingThread();
+    pthread_mutex_unlock(&s_jobMutex);
 }
 
 
 
 void CCDataReaderHelper::addDataAsyncCallBack(float dt)
 {
-    // the data is generated in loading thread
-    std::queue<DataInfo *> *dataQueue = s_pDataQueue;
-
-    pthread_mutex_lock(&s_DataInfoMutex);
-    if (dataQueue->empty())
+    // take everything the loading threads have decoded since the last frame
+    pthread_mutex_lock(&s_commitMutex);
+    for (size_t i = 0; i < s_commitQueue.size(); ++i)
     {
-        pthread_mutex_unlock(&s_DataInfoMutex);
+        s_decodedData[s_commitQueue[i]->asyncStruct->sequence] = s_commitQueue[i];
     }
-    else
+    s_commitQueue.clear();
+    pthread_mutex_unlock(&s_commitMutex);
+
+    // commit in the order the files were requested, at least one file per frame,
+    // and then as many as fit in the time budget
+    struct cc_timeval start;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
+
+    std::map<unsigned int, DataInfo *>::iterator it;
+    while ((it = s_decodedData.find(s_nNextCommitSequence)) != s_decodedData.end())
     {
-        DataInfo *pDataInfo = dataQueue->front();
-        dataQueue->pop();
-        pthread_mutex_unlock(&s_DataInfoMutex);
+        DataInfo *pDataInfo = it->second;
+        s_decodedData.erase(it);
+        ++s_nNextCommitSequence;
 
         AsyncStruct *pAsyncStruct = pDataInfo->asyncStruct;
 
+        commitData(pDataInfo);
+
         if (pAsyncStruct->imagePath != "" && pAsyncStruct->plistPath != "")
         {
-            pthread_mutex_lock(&s_GetFileDataMutex);
             CCArmatureDataManager::sharedArmatureDataManager()->addSpriteFrameFromFile(pAsyncStruct->plistPath.c_str(), pAsyncStruct->imagePath.c_str());
-            pthread_mutex_unlock(&s_GetFileDataMutex);
         }
 
         while (!pDataInfo->configFileQueue.empty())
         {
             std::string configPath = pDataInfo->configFileQueue.front();
-            pthread_mutex_lock(&s_GetFileDataMutex);
             CCArmatureDataManager::sharedArmatureDataManager()->addSpriteFrameFromFile((pAsyncStruct->baseFilePath + configPath + ".plist").c_str(), (pAsyncStruct->baseFilePath + configPath + ".png").c_str());
-            pthread_mutex_unlock(&s_GetFileDataMutex);
             pDataInfo->configFileQueue.pop();
         }
 
@@ -580,8 +947,26 @@ void CCDataReaderHelper::addDataAsyncCallBack(float dt)
 
         if (0 == s_nAsyncRefCount)
         {
+            // nothing is left to look up the decoded armatures
+            pthread_mutex_lock(&s_jobMutex);
+            typedef std::multimap<std::string, std::pair<unsigned int, CCArmatureData *> >::iterator DecodedIterator;
+            for (DecodedIterator decoded = s_decodedArmatures.begin(); decoded != s_decodedArmatures.end(); ++decoded)
+            {
+                decoded->second.second->release();
+            }
+            s_decodedArmatures.clear();
+            pthread_mutex_unlock(&s_jobMutex);
+
             s_nAsyncRefTotalCount = 0;
             CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(schedule_selector(CCDataReaderHelper::addDataAsyncCallBack), this);
+            break;
+        }
+
+        struct cc_timeval now;
+        CCTime::gettimeofdayCocos2d(&now, NULL);
+        if (CCTime::timersubCocos2d(&start, &now) / 1000.0 >= s_fCommitTimeBudget)
+        {
+            break;
         }
     }
 }
@@ -614,76 +999,8 @@ void CCDataReaderHelper::addDataFromCache(const char *pFileContent, DataInfo *da
     tinyxml2::XMLElement *root = document.RootElement();
     CCAssert(root, "XML error  or  XML is empty.");
 
-    root->QueryFloatAttribute(VERSION, &dataInfo->flashToolVersion);
-
-
-    /*
-    * Begin decode armature data from xml
-    */
-    tinyxml2::XMLElement *armaturesXML = root->FirstChildElement(ARMATURES);
-    tinyxml2::XMLElement *armatureXML = armaturesXML->FirstChildElement(ARMATURE);
-    while(armatureXML)
-    {
-        CCArmatureData *armatureData = CCDataReaderHelper::decodeArmature(armatureXML, dataInfo);
-
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_lock(&s_addDataMutex);
-        }
-        CCArmatureDataManager::sharedArmatureDataManager()->addArmatureData(armatureData->name.c_str(), armatureData, dataInfo->filename.c_str());
-        armatureData->release();
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_unlock(&s_addDataMutex);
-        }
-
-        armatureXML = armatureXML->NextSiblingElement(ARMATURE);
-    }
-
-
-    /*
-    * Begin decode animation data from xml
-    */
-    tinyxml2::XMLElement *animationsXML = root->FirstChildElement(ANIMATIONS);
-    tinyxml2::XMLElement *animationXML = animationsXML->FirstChildElement(ANIMATION);
-    while(animationXML)
-    {
-        CCAnimationData *animationData = CCDataReaderHelper::decodeAnimation(animationXML, dataInfo);
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_lock(&s_addDataMutex);
-        }
-        CCArmatureDataManager::sharedArmatureDataManager()->addAnimationData(animationData->name.c_str(), animationData, dataInfo->filename.c_str());
-        animationData->release();
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_unlock(&s_addDataMutex);
-        }
-        animationXML = animationXML->NextSiblingElement(ANIMATION);
-    }
-
-
-    /*
-    * Begin decode texture data from xml
-    */
-    tinyxml2::XMLElement *texturesXML = root->FirstChildElement(TEXTURE_ATLAS);
-    tinyxml2::XMLElement *textureXML = texturesXML->FirstChildElement(SUB_TEXTURE);
-    while(textureXML)
-    {
-        CCTextureData *textureData = CCDataReaderHelper::decodeTexture(textureXML, dataInfo);
-
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_lock(&s_addDataMutex);
-        }
-        CCArmatureDataManager::sharedArmatureDataManager()->addTextureData(textureData->name.c_str(), textureData, dataInfo->filename.c_str());
-        textureData->release();
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_unlock(&s_addDataMutex);
-        }
-        textureXML = textureXML->NextSiblingElement(SUB_TEXTURE);
-    }
+    decodeXMLArmatures(root, dataInfo);
+    decodeXMLAnimations(root, dataInfo);
 }
 
 CCArmatureData *CCDataReaderHelper::decodeArmature(tinyxml2::XMLElement *armatureXML, DataInfo *dataInfo)
@@ -805,7 +1122,7 @@ CCAnimationData *CCDataReaderHelper::decodeAnimation(tinyxml2::XMLElement *anima
 
     const char	*name = animationXML->Attribute(A_NAME);
 
-    CCArmatureData *armatureData = CCArmatureDataManager::sharedArmatureDataManager()->getArmatureData(name);
+    CCArmatureData *armatureData = findArmatureData(name, dataInfo);
 
     aniData->name = name;
 
@@ -1317,16 +1634,7 @@ void CCDataReaderHelper::addDataFromJsonCache(const char *fileContent, DataInfo
 		const rapidjson::Value &armatureDic = DICTOOL->getSubDictionary_json(json, ARMATURE_DATA, i); 
         CCArmatureData *armatureData = decodeArmature(armatureDic, dataInfo);
 
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_lock(&s_addDataMutex);
-        }
-        CCArmatureDataManager::sharedArmatureDataManager()->addArmatureData(armatureData->name.c_str(), armatureData, dataInfo->filename.c_str());
-        armatureData->release();
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_unlock(&s_addDataMutex);
-        }
+        storeArmatureData(armatureData, dataInfo);
         //delete armatureDic;
     }
 
@@ -1337,16 +1645,7 @@ void CCDataReaderHelper::addDataFromJsonCache(const char *fileContent, DataInfo
 		const rapidjson::Value &animationDic = DICTOOL->getSubDictionary_json(json, ANIMATION_DATA, i);
         CCAnimationData *animationData = decodeAnimation(animationDic, dataInfo);
 
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_lock(&s_addDataMutex);
-        }
-        CCArmatureDataManager::sharedArmatureDataManager()->addAnimationData(animationData->name.c_str(), animationData, dataInfo->filename.c_str());
-        animationData->release();
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_unlock(&s_addDataMutex);
-        }
+        storeAnimationData(animationData, dataInfo);
     }
 
     // Decode textures
@@ -1356,16 +1655,7 @@ void CCDataReaderHelper::addDataFromJsonCache(const char *fileContent, DataInfo
         const rapidjson::Value &textureDic =  DICTOOL->getSubDictionary_json(json, TEXTURE_DATA, i); 
         CCTextureData *textureData = decodeTexture(textureDic);
 
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_lock(&s_addDataMutex);
-        }
-        CCArmatureDataManager::sharedArmatureDataManager()->addTextureData(textureData->name.c_str(), textureData, dataInfo->filename.c_str());
-        textureData->release();
-        if (dataInfo->asyncStruct)
-        {
-            pthread_mutex_unlock(&s_addDataMutex);
-        }
+        storeTextureData(textureData, dataInfo);
         //delete textureDic;
     }
 
@@ -1834,16 +2124,7 @@ void CCDataReaderHelper::addDataFromBinaryCache(const char *fileContent, DataInf
 					for (int i = 0; i < length; ++i)
 					{
 						armatureData = decodeArmature(&tCocoLoader, &pDataArray[i], dataInfo);
-						if (dataInfo->asyncStruct)
-						{
-							pthread_mutex_lock(&s_addDataMutex);
-						}
-						CCArmatureDataManager::sharedArmatureDataManager()->addArmatureData(armatureData->name.c_str(), armatureData, dataInfo->filename.c_str());
-						armatureData->release();
-						if (dataInfo->asyncStruct)
-						{
-							pthread_mutex_unlock(&s_addDataMutex);
-						}
+						storeArmatureData(armatureData, dataInfo);
 					}
 				}
 				else if ( 0 == key.compare(ANIMATION_DATA))
@@ -1854,16 +2135,7 @@ void CCDataReaderHelper::addDataFromBinaryCache(const char *fileContent, DataInf
 					for (int i = 0; i < length; ++i)
 					{
 						animationData = decodeAnimation(&tCocoLoader, &pDataArray[i], dataInfo);
-						if (dataInfo->asyncStruct)
-						{
-							pthread_mutex_lock(&s_addDataMutex);
-						}
-						CCArmatureDataManager::sharedArmatureDataManager()->addAnimationData(animationData->name.c_str(), animationData, dataInfo->filename.c_str());
-						animationData->release();
-						if (dataInfo->asyncStruct)
-						{
-							pthread_mutex_unlock(&s_addDataMutex);
-						}
+						storeAnimationData(animationData, dataInfo);
 					}
 				}
 				else if (key.compare(TEXTURE_DATA) == 0)
@@ -1873,16 +2145,7 @@ void CCDataReaderHelper::addDataFromBinaryCache(const char *fileContent, DataInf
 					for (int i = 0; i < length; ++i)
 					{
 						CCTextureData *textureData = decodeTexture(&tCocoLoader, &pDataArray[i]);
-						if (dataInfo->asyncStruct)
-						{
-							pthread_mutex_lock(&s_addDataMutex);
-						}
-						CCArmatureDataManager::sharedArmatureDataManager()->addTextureData(textureData->name.c_str(), textureData, dataInfo->filename.c_str());
-						textureData->release();
-						if (dataInfo->asyncStruct)
-						{
-							pthread_mutex_unlock(&s_addDataMutex);
-						}
+						storeTextureData(textureData, dataInfo);
 					}
 				}
 			}
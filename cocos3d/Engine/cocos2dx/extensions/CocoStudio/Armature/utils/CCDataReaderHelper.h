@@ -57,6 +57,18 @@ public:
     static void setPositionReadScale(float scale);
     static float getPositionReadScale();
 
+    /**
+     * Sets the number of threads addDataFromFileAsync decodes files on. It takes effect when
+     * the threads are next started. Zero, the default, uses one per processor, up to four.
+     */
+    static void setAsyncLoadingThreadCount(unsigned int count);
+
+    /**
+     * Sets the time, in seconds, addDataAsyncCallBack may spend each frame committing decoded
+     * files to CCArmatureDataManager. At least one file is committed per frame regardless.
+     */
+    static void setAsyncCommitTimeBudget(float budget);
+
     static void purge();
     
 public:
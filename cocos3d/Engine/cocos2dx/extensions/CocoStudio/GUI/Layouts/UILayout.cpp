@@ -190,6 +190,8 @@ void Layout::visit()
     }
     if (_clippingEnabled)
     {
+        // the clipping state only lasts for this visit, draw the primitives before it is restored
+        int batchDepth = ccDrawSuspendBatch();
         switch (_clippingType)
         {
             case LAYOUT_CLIPPING_STENCIL:
@@ -201,6 +203,7 @@ void Layout::visit()
             default:
                 break;
         }
+        ccDrawResumeBatch(batchDepth);
     }
     else
     {
@@ -242,6 +245,7 @@ void Layout::stencilClippingVisit()
         return;
     }
     layer++;
+    CCClippingNode::notifyStencilBufferWritten();
     GLint mask_layer = 0x1 << layer;
     GLint mask_layer_l = mask_layer - 1;
     GLint mask_layer_le = mask_layer | mask_layer_l;
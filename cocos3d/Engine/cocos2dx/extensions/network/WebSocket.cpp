@@ -35,12 +35,46 @@
 
 NS_CC_EXT_BEGIN
 
+/**
+ *  @brief A message passed between the UI thread and the websocket thread.
+ *         Message slots and their byte buffers belong to a WsMessageQueue and are reused.
+ */
 class WsMessage
 {
 public:
-    WsMessage() : what(0), obj(NULL){}
+    WsMessage() : what(0), bytes(NULL), len(0), capacity(0), isBinary(false){}
     unsigned int what; // message type
-    void* obj;
+    char* bytes;
+    int len;
+    int capacity;
+    bool isBinary;
+};
+
+/**
+ *  @brief Single producer, single consumer message queue.
+ *
+ *  The producer copies each message into a preallocated slot under a short lock, and the
+ *  consumer takes every pending message at once by swapping the slot arrays. Slots keep
+ *  their buffers after they have been consumed, so steady traffic does not allocate.
+ */
+class WsMessageQueue
+{
+public:
+    WsMessageQueue();
+    ~WsMessageQueue();
+
+    // Copies a message into the queue. Invoked by the producer thread only.
+    void push(unsigned int what, const void* bytes, int len, bool isBinary);
+
+    // Takes every message pushed since the previous call. Invoked by the consumer thread only;
+    // the returned slots stay valid until the next call.
+    std::vector<WsMessage>& takeAll(unsigned int& count);
+
+private:
+    std::vector<WsMessage> _pending;
+    std::vector<WsMessage> _draining;
+    unsigned int _pendingCount;
+    pthread_mutex_t _mutex;
 };
 
 /**
@@ -57,14 +91,20 @@ public:
     // Quits sub-thread (websocket thread).
     void quitSubThread();
     
-    // Schedule callback function
+    // Schedule callback function, delivers every pending message to the websocket.
     virtual void update(float dt);
+
+    // Stops delivering messages to the UI thread. It's needed to be invoked in UI thread.
+    void stopDispatching();
     
     // Sends message to UI thread. It's needed to be invoked in sub-thread.
-    void sendMessageToUIThread(WsMessage *msg);
+    void sendMessageToUIThread(unsigned int what, const void* bytes = NULL, int len = 0, bool isBinary = false);
     
     // Sends message to sub-thread(websocket thread). It's needs to be invoked in UI thread.
-    void sendMessageToSubThread(WsMessage *msg);
+    void sendMessageToSubThread(unsigned int what, const void* bytes = NULL, int len = 0, bool isBinary = false);
+    
+    // Returns a buffer of at least 'size' bytes for libwebsocket_write. It's needed to be invoked in sub-thread.
+    unsigned char* getWriteBuffer(int size);
     
     // Waits the sub-thread (websocket thread) to exit,
     void joinSubThread();
@@ -75,16 +115,84 @@ protected:
     void* wsThreadEntryFunc(void* arg);
     
 private:
-    std::list<WsMessage*>* _UIWsMessageQueue;
-    std::list<WsMessage*>* _subThreadWsMessageQueue;
-    pthread_mutex_t _UIWsMessageQueueMutex;
-    pthread_mutex_t _subThreadWsMessageQueueMutex;
+    WsMessageQueue* _UIWsMessageQueue;
+    WsMessageQueue* _subThreadWsMessageQueue;
+    unsigned char* _writeBuffer;
+    int _writeBufferSize;
     pthread_t  _subThreadInstance;
     WebSocket* _ws;
     bool _needQuit;
+    bool _dispatchStopped;
     friend class WebSocket;
 };
 
+// Number of message slots preallocated in each direction.
+#define WS_MESSAGE_QUEUE_CAPACITY 64
+
+// Implementation of WsMessageQueue
+WsMessageQueue::WsMessageQueue()
+: _pendingCount(0)
+{
+    _pending.resize(WS_MESSAGE_QUEUE_CAPACITY);
+    _draining.resize(WS_MESSAGE_QUEUE_CAPACITY);
+    pthread_mutex_init(&_mutex, NULL);
+}
+
+WsMessageQueue::~WsMessageQueue()
+{
+    pthread_mutex_destroy(&_mutex);
+    for (size_t i = 0; i < _pending.size(); ++i)
+    {
+        CC_SAFE_DELETE_ARRAY(_pending[i].bytes);
+    }
+    for (size_t i = 0; i < _draining.size(); ++i)
+    {
+        CC_SAFE_DELETE_ARRAY(_draining[i].bytes);
+    }
+}
+
+void WsMessageQueue::push(unsigned int what, const void* bytes, int len, bool isBinary)
+{
+    pthread_mutex_lock(&_mutex);
+
+    // The consumer fell behind, add a slot rather than blocking either thread.
+    if (_pendingCount == _pending.size())
+    {
+        _pending.push_back(WsMessage());
+    }
+
+    WsMessage& msg = _pending[_pendingCount++];
+    msg.what = what;
+    msg.len = len;
+    msg.isBinary = isBinary;
+
+    if (bytes)
+    {
+        // Keeps one extra byte so text messages are NUL terminated.
+        if (msg.capacity < len + 1)
+        {
+            CC_SAFE_DELETE_ARRAY(msg.bytes);
+            msg.capacity = MAX(len + 1, 2 * msg.capacity);
+            msg.bytes = new char[msg.capacity];
+        }
+        memcpy(msg.bytes, bytes, len);
+        msg.bytes[len] = '\0';
+    }
+
+    pthread_mutex_unlock(&_mutex);
+}
+
+std::vector<WsMessage>& WsMessageQueue::takeAll(unsigned int& count)
+{
+    pthread_mutex_lock(&_mutex);
+    _pending.swap(_draining);
+    count = _pendingCount;
+    _pendingCount = 0;
+    pthread_mutex_unlock(&_mutex);
+
+    return _draining;
+}
+
 // Wrapper for converting websocket callback from static function to member function of WebSocket class.
 class WebSocketCallbackWrapper {
 public:
@@ -106,13 +214,14 @@ public:
 
 // Implementation of WsThreadHelper
 WsThreadHelper::WsThreadHelper()
-: _ws(NULL)
+: _writeBuffer(NULL)
+, _writeBufferSize(0)
+, _ws(NULL)
 , _needQuit(false)
+, _dispatchStopped(false)
 {
-    _UIWsMessageQueue = new std::list<WsMessage*>();
-    pthread_mutex_init(&_UIWsMessageQueueMutex, NULL);
-    _subThreadWsMessageQueue = new std::list<WsMessage*>();
-    pthread_mutex_init(&_subThreadWsMessageQueueMutex, NULL);
+    _UIWsMessageQueue = new WsMessageQueue();
+    _subThreadWsMessageQueue = new WsMessageQueue();
     
     CCDirector::sharedDirector()->getScheduler()->scheduleUpdateForTarget(this, 0, false);
 }
@@ -120,10 +229,9 @@ WsThreadHelper::WsThreadHelper()
 WsThreadHelper::~WsThreadHelper()
 {
     CCDirector::sharedDirector()->getScheduler()->unscheduleAllForTarget(this);
-    pthread_mutex_destroy(&_UIWsMessageQueueMutex);
-    pthread_mutex_destroy(&_subThreadWsMessageQueueMutex);
     delete _UIWsMessageQueue;
     delete _subThreadWsMessageQueue;
+    CC_SAFE_DELETE_ARRAY(_writeBuffer);
 }
 
 // For converting static function to member function
@@ -174,18 +282,25 @@ void* WsThreadHelper::wsThreadEntryFunc(void* arg)
     return (void*)0;
 }
 
-void WsThreadHelper::sendMessageToUIThread(WsMessage *msg)
+void WsThreadHelper::sendMessageToUIThread(unsigned int what, const void* bytes, int len, bool isBinary)
 {
-    pthread_mutex_lock(&_UIWsMessageQueueMutex);
-    _UIWsMessageQueue->push_back(msg);
-    pthread_mutex_unlock(&_UIWsMessageQueueMutex);
+    _UIWsMessageQueue->push(what, bytes, len, isBinary);
 }
 
-void WsThreadHelper::sendMessageToSubThread(WsMessage *msg)
+void WsThreadHelper::sendMessageToSubThread(unsigned int what, const void* bytes, int len, bool isBinary)
 {
-    pthread_mutex_lock(&_subThreadWsMessageQueueMutex);
-    _subThreadWsMessageQueue->push_back(msg);
-    pthread_mutex_unlock(&_subThreadWsMessageQueueMutex);
+    _subThreadWsMessageQueue->push(what, bytes, len, isBinary);
+}
+
+unsigned char* WsThreadHelper::getWriteBuffer(int size)
+{
+    if (_writeBufferSize < size)
+    {
+        CC_SAFE_DELETE_ARRAY(_writeBuffer);
+        _writeBufferSize = MAX(size, 2 * _writeBufferSize);
+        _writeBuffer = new unsigned char[_writeBufferSize];
+    }
+    return _writeBuffer;
 }
 
 void WsThreadHelper::joinSubThread()
@@ -194,29 +309,36 @@ void WsThreadHelper::joinSubThread()
     pthread_join(_subThreadInstance, &ret);
 }
 
+void WsThreadHelper::stopDispatching()
+{
+    _dispatchStopped = true;
+    CCDirector::sharedDirector()->getScheduler()->unscheduleAllForTarget(this);
+}
+
 void WsThreadHelper::update(float dt)
 {
-    WsMessage *msg = NULL;
+    if (_dispatchStopped)
+    {
+        return;
+    }
+
+    unsigned int count = 0;
+    std::vector<WsMessage>& msgs = _UIWsMessageQueue->takeAll(count);
 
     // Returns quickly if no message
-    pthread_mutex_lock(&_UIWsMessageQueueMutex);
-    if (0 == _UIWsMessageQueue->size())
+    if (0 == count)
     {
-        pthread_mutex_unlock(&_UIWsMessageQueueMutex);
         return;
     }
     
-    // Gets message
-    msg = *(_UIWsMessageQueue->begin());
-    _UIWsMessageQueue->pop_front();
-    pthread_mutex_unlock(&_UIWsMessageQueueMutex);
-    
-    if (_ws)
+    // Delivers the whole batch in this frame. The delegate may close or delete the
+    // websocket while handling a message, which stops dispatching or releases this helper.
+    retain();
+    for (unsigned int i = 0; i < count && _ws && !_dispatchStopped; ++i)
     {
-        _ws->onUIThreadReceiveMessage(msg);
+        _ws->onUIThreadReceiveMessage(&msgs[i]);
     }
-    
-    CC_SAFE_DELETE(msg);
+    release();
 }
 
 enum WS_MSG {
@@ -231,6 +353,7 @@ enum WS_MSG {
 WebSocket::WebSocket()
 : _readyState(kStateConnecting)
 , _port(80)
+, _deflateEnabled(true)
 , _wsHelper(NULL)
 , _wsInstance(NULL)
 , _wsContext(NULL)
@@ -243,6 +366,10 @@ WebSocket::WebSocket()
 WebSocket::~WebSocket()
 {
     close();
+    if (_wsHelper)
+    {
+        _wsHelper->_ws = NULL;
+    }
     CC_SAFE_RELEASE_NULL(_wsHelper);
     
     for (int i = 0; _wsProtocols[i].callback != NULL; ++i) {
@@ -341,14 +468,7 @@ void WebSocket::send(const std::string& message)
     if (_readyState == kStateOpen)
     {
         // In main thread
-        WsMessage* msg = new WsMessage();
-        msg->what = WS_MSG_TO_SUBTRHEAD_SENDING_STRING;
-        Data* data = new Data();
-        data->bytes = new char[message.length()+1];
-        strcpy(data->bytes, message.c_str());
-        data->len = message.length();
-        msg->obj = data;
-        _wsHelper->sendMessageToSubThread(msg);
+        _wsHelper->sendMessageToSubThread(WS_MSG_TO_SUBTRHEAD_SENDING_STRING, message.c_str(), message.length(), false);
     }
 }
 
@@ -359,20 +479,13 @@ void WebSocket::send(const unsigned char* binaryMsg, unsigned int len)
     if (_readyState == kStateOpen)
     {
         // In main thread
-        WsMessage* msg = new WsMessage();
-        msg->what = WS_MSG_TO_SUBTRHEAD_SENDING_BINARY;
-        Data* data = new Data();
-        data->bytes = new char[len];
-        memcpy((void*)data->bytes, (void*)binaryMsg, len);
-        data->len = len;
-        msg->obj = data;
-        _wsHelper->sendMessageToSubThread(msg);
+        _wsHelper->sendMessageToSubThread(WS_MSG_TO_SUBTRHEAD_SENDING_BINARY, binaryMsg, len, true);
     }
 }
 
 void WebSocket::close()
 {
-    CCDirector::sharedDirector()->getScheduler()->unscheduleAllForTarget(_wsHelper);
+    _wsHelper->stopDispatching();
     
     if (_readyState == kStateClosing || _readyState == kStateClosed)
         return;
@@ -392,6 +505,17 @@ WebSocket::State WebSocket::getReadyState()
     return _readyState;
 }
 
+void WebSocket::setDeflateEnabled(bool enabled)
+{
+    CCAssert(_wsHelper == NULL, "setDeflateEnabled must be invoked before init.");
+    _deflateEnabled = enabled;
+}
+
+bool WebSocket::isDeflateEnabled() const
+{
+    return _deflateEnabled;
+}
+
 int WebSocket::onSubThreadLoop()
 {
     if (_readyState == kStateClosed || _readyState == kStateClosing)
@@ -476,66 +600,62 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
         case LWS_CALLBACK_PROTOCOL_DESTROY:
         case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
             {
-                WsMessage* msg = NULL;
+                unsigned int what = 0;
+                bool hasMessage = false;
                 if (reason == LWS_CALLBACK_CLIENT_CONNECTION_ERROR
                     || (reason == LWS_CALLBACK_PROTOCOL_DESTROY && _readyState == kStateConnecting)
                     || (reason == LWS_CALLBACK_DEL_POLL_FD && _readyState == kStateConnecting)
                     )
                 {
-                    msg = new WsMessage();
-                    msg->what = WS_MSG_TO_UITHREAD_ERROR;
+                    what = WS_MSG_TO_UITHREAD_ERROR;
+                    hasMessage = true;
                     _readyState = kStateClosing;
                 }
                 else if (reason == LWS_CALLBACK_PROTOCOL_DESTROY && _readyState == kStateClosing)
                 {
-                    msg = new WsMessage();
-                    msg->what = WS_MSG_TO_UITHREAD_CLOSE;
+                    what = WS_MSG_TO_UITHREAD_CLOSE;
+                    hasMessage = true;
                 }
 
-                if (msg)
+                if (hasMessage)
                 {
-                    _wsHelper->sendMessageToUIThread(msg);
+                    _wsHelper->sendMessageToUIThread(what);
                 }
             }
             break;
         case LWS_CALLBACK_CLIENT_ESTABLISHED:
             {
-                WsMessage* msg = new WsMessage();
-                msg->what = WS_MSG_TO_UITHREAD_OPEN;
                 _readyState = kStateOpen;
                 /*
                  * start the ball rolling,
                  * LWS_CALLBACK_CLIENT_WRITEABLE will come next service
                  */
                 libwebsocket_callback_on_writable(ctx, wsi);
-                _wsHelper->sendMessageToUIThread(msg);
+                _wsHelper->sendMessageToUIThread(WS_MSG_TO_UITHREAD_OPEN);
             }
             break;
             
         case LWS_CALLBACK_CLIENT_WRITEABLE:
             {
-                pthread_mutex_lock(&_wsHelper->_subThreadWsMessageQueueMutex);
-                std::list<WsMessage*>::iterator iter = _wsHelper->_subThreadWsMessageQueue->begin();
+                unsigned int count = 0;
+                std::vector<WsMessage>& msgs = _wsHelper->_subThreadWsMessageQueue->takeAll(count);
                 
                 int bytesWrite = 0;
-                for (; iter != _wsHelper->_subThreadWsMessageQueue->end(); ++iter) {
+                for (unsigned int i = 0; i < count; ++i) {
 
-                    WsMessage* subThreadMsg = *iter;
+                    WsMessage& subThreadMsg = msgs[i];
                     
-                    if ( WS_MSG_TO_SUBTRHEAD_SENDING_STRING == subThreadMsg->what
-                      || WS_MSG_TO_SUBTRHEAD_SENDING_BINARY == subThreadMsg->what)
+                    if ( WS_MSG_TO_SUBTRHEAD_SENDING_STRING == subThreadMsg.what
+                      || WS_MSG_TO_SUBTRHEAD_SENDING_BINARY == subThreadMsg.what)
                     {
-                        Data* data = (Data*)subThreadMsg->obj;
-
-                        unsigned char* buf = new unsigned char[LWS_SEND_BUFFER_PRE_PADDING
-                                                               + data->len + LWS_SEND_BUFFER_POST_PADDING];
+                        unsigned char* buf = _wsHelper->getWriteBuffer(LWS_SEND_BUFFER_PRE_PADDING
+                                                                      + subThreadMsg.len + LWS_SEND_BUFFER_POST_PADDING);
                         
-                        memset(&buf[LWS_SEND_BUFFER_PRE_PADDING], 0, data->len);
-                        memcpy((char*)&buf[LWS_SEND_BUFFER_PRE_PADDING], data->bytes, data->len);
+                        memcpy((char*)&buf[LWS_SEND_BUFFER_PRE_PADDING], subThreadMsg.bytes, subThreadMsg.len);
                         
                         enum libwebsocket_write_protocol writeProtocol;
                         
-                        if (WS_MSG_TO_SUBTRHEAD_SENDING_STRING == subThreadMsg->what)
+                        if (WS_MSG_TO_SUBTRHEAD_SENDING_STRING == subThreadMsg.what)
                         {
                             writeProtocol = LWS_WRITE_TEXT;
                         }
@@ -544,26 +664,16 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
                             writeProtocol = LWS_WRITE_BINARY;
                         }
                         
-                        bytesWrite = libwebsocket_write(wsi,  &buf[LWS_SEND_BUFFER_PRE_PADDING], data->len, writeProtocol);
+                        bytesWrite = libwebsocket_write(wsi,  &buf[LWS_SEND_BUFFER_PRE_PADDING], subThreadMsg.len, writeProtocol);
                         
                         if (bytesWrite < 0) {
                             CCLOGERROR("%s", "libwebsocket_write error...");
                         }
-                        if (bytesWrite < data->len) {
+                        if (bytesWrite < subThreadMsg.len) {
                             CCLOGERROR("Partial write LWS_CALLBACK_CLIENT_WRITEABLE\n");
                         }
-                        
-                        CC_SAFE_DELETE_ARRAY(data->bytes);
-                        CC_SAFE_DELETE(data);
-                        CC_SAFE_DELETE_ARRAY(buf);
                     }
-                    
-                    CC_SAFE_DELETE(subThreadMsg);
                 }
-
-                _wsHelper->_subThreadWsMessageQueue->clear();
-                
-                pthread_mutex_unlock(&_wsHelper->_subThreadWsMessageQueueMutex);
                 
                 /* get notified as soon as we can write again */
                 
@@ -580,10 +690,8 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
                 
                 if (_readyState != kStateClosed)
                 {
-                    WsMessage* msg = new WsMessage();
                     _readyState = kStateClosed;
-                    msg->what = WS_MSG_TO_UITHREAD_CLOSE;
-                    _wsHelper->sendMessageToUIThread(msg);
+                    _wsHelper->sendMessageToUIThread(WS_MSG_TO_UITHREAD_CLOSE);
                 }
             }
             break;
@@ -592,32 +700,19 @@ int WebSocket::onSocketCallback(struct libwebsocket_context *ctx,
             {
                 if (in && len > 0)
                 {
-                    WsMessage* msg = new WsMessage();
-                    msg->what = WS_MSG_TO_UITHREAD_MESSAGE;
-                    
-                    char* bytes = NULL;
-                    Data* data = new Data();
-                    
-                    if (lws_frame_is_binary(wsi))
-                    {
-                        
-                        bytes = new char[len];
-                        data->isBinary = true;
-                    }
-                    else
-                    {
-                        bytes = new char[len+1];
-                        bytes[len] = '\0';
-                        data->isBinary = false;
-                    }
+                    _wsHelper->sendMessageToUIThread(WS_MSG_TO_UITHREAD_MESSAGE, in, len, lws_frame_is_binary(wsi) ? true : false);
+                }
+            }
+            break;
 
-                    memcpy(bytes, in, len);
-                    
-                    data->bytes = bytes;
-                    data->len = len;
-                    msg->obj = (void*)data;
-                    
-                    _wsHelper->sendMessageToUIThread(msg);
+        case LWS_CALLBACK_CLIENT_CONFIRM_EXTENSION_SUPPORTED:
+            {
+                // Returning non-zero stops the extension from being offered in the handshake.
+                // Covers permessage-deflate and the older deflate-frame/deflate-stream drafts.
+                const char* extensionName = (const char*)in;
+                if (!_deflateEnabled && extensionName && strstr(extensionName, "deflate"))
+                {
+                    return 1;
                 }
             }
             break;
@@ -639,10 +734,12 @@ void WebSocket::onUIThreadReceiveMessage(WsMessage* msg)
             break;
         case WS_MSG_TO_UITHREAD_MESSAGE:
             {
-                Data* data = (Data*)msg->obj;
-                _delegate->onMessage(this, *data);
-                CC_SAFE_DELETE_ARRAY(data->bytes);
-                CC_SAFE_DELETE(data);
+                // The bytes belong to the message queue and are reused after this call.
+                Data data;
+                data.bytes = msg->bytes;
+                data.len = msg->len;
+                data.isBinary = msg->isBinary;
+                _delegate->onMessage(this, data);
             }
             break;
         case WS_MSG_TO_UITHREAD_CLOSE:
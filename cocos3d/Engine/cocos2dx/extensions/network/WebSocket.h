@@ -136,6 +136,18 @@ public:
      *  @brief Gets current state of connection.
      */
     State getReadyState();
+
+    /**
+     *  @brief Sets whether compression extensions (permessage-deflate, or the deflate-frame
+     *         draft implemented by older libwebsockets) are offered to the server.
+     *         It needs to be invoked before init(). Enabled by default.
+     */
+    void setDeflateEnabled(bool enabled);
+
+    /**
+     *  @brief Gets whether compression extensions are offered to the server.
+     */
+    bool isDeflateEnabled() const;
 private:
     virtual void onSubThreadStarted();
     virtual int onSubThreadLoop();
@@ -154,6 +166,7 @@ private:
     std::string  _host;
     unsigned int _port;
     std::string  _path;
+    bool         _deflateEnabled;
     
     friend class WsThreadHelper;
     WsThreadHelper* _wsHelper;
@@ -0,0 +1,146 @@
+/****************************************************************************
+Copyright (c) 2010-2012 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+/*
+ * fntb-converter: precompiles AngelCode text fonts (.fnt) into the binary
+ * ".fntb" format read by CCBMFontConfiguration.
+ *
+ *   fntb-converter [-v] font.fnt [font.fntb]
+ *
+ * The output defaults to the input name with a trailing 'b', which is where
+ * CCBMFontConfiguration looks for a precompiled sibling. With -v the written
+ * file is read back and compared against the parsed tables.
+ */
+
+#include "label_nodes/CCBMFontFormat.h"
+#include <stdio.h>
+#include <string.h>
+
+USING_NS_CC;
+
+static bool readFile(const char *pszPath, std::vector<unsigned char> &data)
+{
+    FILE *fp = fopen(pszPath, "rb");
+    if (! fp)
+    {
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    long nSize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data.resize(nSize > 0 ? nSize : 0);
+    bool bRet = nSize <= 0 || fread(&data[0], 1, nSize, fp) == (size_t)nSize;
+    fclose(fp);
+    return bRet;
+}
+
+static bool verify(const std::vector<unsigned char> &binary, const ccBMFontInfo &info,
+                   const std::vector<ccBMFontGlyph> &glyphs, const std::vector<ccBMFontKerning> &kernings)
+{
+    // copy into a vector of ints so the records are 4-byte aligned like a loaded file
+    std::vector<unsigned int> aligned((binary.size() + 3) / 4);
+    memcpy(&aligned[0], &binary[0], binary.size());
+
+    ccBMFontInfo readInfo;
+    const ccBMFontGlyph *pGlyphs = NULL;
+    const ccBMFontKerning *pKernings = NULL;
+    unsigned int uGlyphCount = 0, uKerningCount = 0;
+    if (! ccBMFontReadBinary((const unsigned char*)&aligned[0], binary.size(), &readInfo,
+                             &pGlyphs, &uGlyphCount, &pKernings, &uKerningCount))
+    {
+        return false;
+    }
+
+    return readInfo.commonHeight == info.commonHeight
+        && memcmp(readInfo.padding, info.padding, sizeof(info.padding)) == 0
+        && readInfo.scaleW == info.scaleW
+        && readInfo.scaleH == info.scaleH
+        && readInfo.pages == info.pages
+        && readInfo.atlasFile == info.atlasFile
+        && readInfo.sourceSize == info.sourceSize
+        && readInfo.sourceHash == info.sourceHash
+        && uGlyphCount == glyphs.size()
+        && uKerningCount == kernings.size()
+        && (glyphs.empty() || memcmp(pGlyphs, &glyphs[0], glyphs.size() * sizeof(ccBMFontGlyph)) == 0)
+        && (kernings.empty() || memcmp(pKernings, &kernings[0], kernings.size() * sizeof(ccBMFontKerning)) == 0);
+}
+
+int main(int argc, char **argv)
+{
+    bool bVerify = false;
+    int nArg = 1;
+    if (nArg < argc && strcmp(argv[nArg], "-v") == 0)
+    {
+        bVerify = true;
+        ++nArg;
+    }
+
+    if (nArg >= argc || argc - nArg > 2)
+    {
+        fprintf(stderr, "usage: %s [-v] font.fnt [font.fntb]\n", argv[0]);
+        return 1;
+    }
+
+    const char *pszInput = argv[nArg];
+    std::string output = (nArg + 1 < argc) ? argv[nArg + 1] : std::string(pszInput) + "b";
+
+    std::vector<unsigned char> text;
+    if (! readFile(pszInput, text))
+    {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], pszInput);
+        return 1;
+    }
+
+    ccBMFontInfo info;
+    std::vector<ccBMFontGlyph> glyphs;
+    std::vector<ccBMFontKerning> kernings;
+    if (! ccBMFontParseText(text.empty() ? "" : (const char*)&text[0], text.size(), &info, glyphs, kernings))
+    {
+        fprintf(stderr, "%s: cannot parse %s\n", argv[0], pszInput);
+        return 1;
+    }
+
+    std::vector<unsigned char> binary;
+    ccBMFontWriteBinary(&info, glyphs.empty() ? NULL : &glyphs[0], (unsigned int)glyphs.size(),
+                        kernings.empty() ? NULL : &kernings[0], (unsigned int)kernings.size(), binary);
+
+    if (bVerify && ! verify(binary, info, glyphs, kernings))
+    {
+        fprintf(stderr, "%s: round trip of %s failed\n", argv[0], pszInput);
+        return 1;
+    }
+
+    FILE *fp = fopen(output.c_str(), "wb");
+    if (! fp || fwrite(&binary[0], 1, binary.size(), fp) != binary.size())
+    {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], output.c_str());
+        if (fp) fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+
+    printf("%s: %u glyphs, %u kerning pairs, %u bytes\n", output.c_str(),
+           (unsigned int)glyphs.size(), (unsigned int)kernings.size(), (unsigned int)binary.size());
+    return 0;
+}
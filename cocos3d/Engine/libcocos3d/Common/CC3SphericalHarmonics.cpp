@@ -0,0 +1,178 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#include "cocos3d.h"
+
+NS_COCOS3D_BEGIN
+
+const CC3SphericalHarmonics CC3SphericalHarmonics::kCC3SphericalHarmonicsZero;
+
+CC3SphericalHarmonics::CC3SphericalHarmonics()
+{
+    for ( GLuint i = 0; i < kCC3SHCoefficientCount; i++ )
+        coefficients[i] = CC3Vector::kCC3VectorZero;
+}
+
+void CC3SphericalHarmonics::evaluateBasis( const CC3Vector& dir, GLfloat* basis )
+{
+    GLfloat x = dir.x, y = dir.y, z = dir.z;
+    basis[0] = 0.282095f;
+    basis[1] = 0.488603f * y;
+    basis[2] = 0.488603f * z;
+    basis[3] = 0.488603f * x;
+    basis[4] = 1.092548f * x * y;
+    basis[5] = 1.092548f * y * z;
+    basis[6] = 0.315392f * (3.0f * z * z - 1.0f);
+    basis[7] = 1.092548f * x * z;
+    basis[8] = 0.546274f * (x * x - y * y);
+}
+
+void CC3SphericalHarmonics::addRadiance( const CC3Vector& direction, const CC3Vector& color, GLfloat weight )
+{
+    GLfloat basis[kCC3SHCoefficientCount];
+    evaluateBasis( direction, basis );
+    for ( GLuint i = 0; i < kCC3SHCoefficientCount; i++ )
+        coefficients[i] = coefficients[i] + color * (basis[i] * weight);
+}
+
+void CC3SphericalHarmonics::addScaled( const CC3SphericalHarmonics& sh, GLfloat weight )
+{
+    for ( GLuint i = 0; i < kCC3SHCoefficientCount; i++ )
+        coefficients[i] = coefficients[i] + sh.coefficients[i] * weight;
+}
+
+CC3SphericalHarmonics CC3SphericalHarmonics::scaleByColor( const CC3Vector& rgb ) const
+{
+    CC3SphericalHarmonics sh;
+    for ( GLuint i = 0; i < kCC3SHCoefficientCount; i++ )
+        sh.coefficients[i] = coefficients[i].scale( rgb );
+    return sh;
+}
+
+/**
+ * The clamped-cosine lobe has band factors of pi, 2pi/3 and pi/4 (Ramamoorthi & Hanrahan).
+ * Dividing by pi converts the irradiance to the radiance leaving a white Lambertian surface.
+ */
+CC3SphericalHarmonics CC3SphericalHarmonics::convolveToIrradiance() const
+{
+    static const GLfloat bandFactors[kCC3SHCoefficientCount] =
+        { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+    
+    CC3SphericalHarmonics sh;
+    for ( GLuint i = 0; i < kCC3SHCoefficientCount; i++ )
+        sh.coefficients[i] = coefficients[i] * bandFactors[i];
+    return sh;
+}
+
+CC3Vector CC3SphericalHarmonics::evaluate( const CC3Vector& direction ) const
+{
+    GLfloat basis[kCC3SHCoefficientCount];
+    evaluateBasis( direction, basis );
+    CC3Vector sum = CC3Vector::kCC3VectorZero;
+    for ( GLuint i = 0; i < kCC3SHCoefficientCount; i++ )
+        sum = sum + coefficients[i] * basis[i];
+    return sum;
+}
+
+bool CC3SphericalHarmonics::isZero() const
+{
+    for ( GLuint i = 0; i < kCC3SHCoefficientCount; i++ )
+        if ( !coefficients[i].isZero() )
+            return false;
+    return true;
+}
+
+/**
+ * Returns the direction through the center of the texel at face coordinates (sc, tc), each in
+ * the range (-1, 1), following the cube map face selection table of the OpenGL specification.
+ */
+static CC3Vector CC3SHCubeFaceDirection( GLuint face, GLfloat sc, GLfloat tc )
+{
+    switch ( face )
+    {
+        case 0:  return CC3Vector(  1.0f, -tc, -sc );   // +X
+        case 1:  return CC3Vector( -1.0f, -tc,  sc );   // -X
+        case 2:  return CC3Vector(  sc,  1.0f,  tc );   // +Y
+        case 3:  return CC3Vector(  sc, -1.0f, -tc );   // -Y
+        case 4:  return CC3Vector(  sc, -tc,  1.0f );   // +Z
+        case 5:
+        default: return CC3Vector( -sc, -tc, -1.0f );   // -Z
+    }
+}
+
+CC3SphericalHarmonics CC3SphericalHarmonics::projectCubeFaces( const GLubyte* faces[6], GLuint faceSize, GLuint componentCount )
+{
+    CC3SphericalHarmonics sh;
+    if ( faceSize == 0 || componentCount < 1 || componentCount > 4 )
+        return sh;
+    
+    GLfloat texelSpan = 2.0f / faceSize;
+    GLfloat totalWeight = 0.0f;
+    for ( GLuint face = 0; face < 6; face++ )
+    {
+        const GLubyte* px = faces[face];
+        if ( !px )
+            continue;
+        
+        for ( GLuint row = 0; row < faceSize; row++ )
+        {
+            GLfloat tc = (row + 0.5f) * texelSpan - 1.0f;
+            for ( GLuint col = 0; col < faceSize; col++, px += componentCount )
+            {
+                GLfloat sc = (col + 0.5f) * texelSpan - 1.0f;
+                
+                // The solid angle of the texel, relative to its area on the unit face.
+                GLfloat d2 = 1.0f + sc * sc + tc * tc;
+                GLfloat weight = 1.0f / (d2 * sqrtf(d2));
+                
+                CC3Vector color;
+                if ( componentCount < 3 )
+                    color = CC3Vector( px[0], px[0], px[0] ) * (1.0f / 255.0f);
+                else
+                    color = CC3Vector( px[0], px[1], px[2] ) * (1.0f / 255.0f);
+                
+                CC3Vector dir = CC3SHCubeFaceDirection( face, sc, tc ).normalize();
+                sh.addRadiance( dir, color, weight );
+                totalWeight += weight;
+            }
+        }
+    }
+    
+    // Normalize so the weights over the full sphere sum to its solid angle of 4 pi.
+    if ( totalWeight > 0.0f )
+    {
+        GLfloat norm = (4.0f * (GLfloat)M_PI) / totalWeight;
+        for ( GLuint i = 0; i < kCC3SHCoefficientCount; i++ )
+            sh.coefficients[i] = sh.coefficients[i] * norm;
+    }
+    return sh;
+}
+
+
+NS_COCOS3D_END
@@ -0,0 +1,99 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+
+#ifndef _CC3_SPHERICAL_HARMONICS_H_
+#define _CC3_SPHERICAL_HARMONICS_H_
+
+
+NS_COCOS3D_BEGIN
+
+
+/** The number of coefficients in a third-order (bands 0 to 2) spherical-harmonic expansion. */
+#define kCC3SHCoefficientCount		9
+
+/////////////////////////////////////////////////////////////////////////////////////
+///             CC3SphericalHarmonics
+/**
+ * Third-order real spherical harmonics, holding nine RGB coefficients, in the order
+ * (l,m) = (0,0), (1,-1), (1,0), (1,1), (2,-2), (2,-1), (2,0), (2,1), (2,2).
+ *
+ * An instance typically holds either the projection of the radiance arriving at a point from
+ * all directions, or, once convolved, the diffuse irradiance leaving a surface with any normal.
+ */
+struct CC3SphericalHarmonics
+{
+    CC3Vector   coefficients[kCC3SHCoefficientCount];	/**< The RGB coefficients, held as x, y & z. */
+    
+    static const CC3SphericalHarmonics kCC3SphericalHarmonicsZero;    /** All coefficients zero. */
+    
+    CC3SphericalHarmonics();
+    
+    /** Populates the specified array with the nine basis functions evaluated in the specified unit direction. */
+    static void                     evaluateBasis( const CC3Vector& direction, GLfloat* basis );
+    
+    /**
+     * Projects the six faces of a cube map, each faceSize pixels square, into spherical harmonics.
+     *
+     * The faces are in the order +X, -X, +Y, -Y, +Z, -Z, and each face holds unsigned byte pixels
+     * with the specified number of components (1 to 4), in rows as they would be uploaded to GL.
+     * Single component pixels are treated as grey, and any alpha component is ignored. Each texel
+     * is weighted by the solid angle it subtends, and the result is the projection of the radiance.
+     */
+    static CC3SphericalHarmonics    projectCubeFaces( const GLubyte* faces[6], GLuint faceSize, GLuint componentCount );
+    
+    /** Adds the radiance of the specified color arriving from the specified unit direction, scaled by the weight. */
+    void                            addRadiance( const CC3Vector& direction, const CC3Vector& color, GLfloat weight );
+    
+    /** Adds the coefficients of the specified harmonics, scaled by the weight. */
+    void                            addScaled( const CC3SphericalHarmonics& sh, GLfloat weight );
+    
+    /** Returns these harmonics with every coefficient scaled by the specified RGB factors. */
+    CC3SphericalHarmonics           scaleByColor( const CC3Vector& rgb ) const;
+    
+    /**
+     * Returns the radiance harmonics convolved with the clamped-cosine lobe and divided by pi, so
+     * that evaluating the result in a surface normal directly gives the outgoing diffuse radiance
+     * of a white Lambertian surface. This is the form uploaded by the kCC3SemanticLightProbeSH
+     * semantic, where a shader evaluates it as the sum of each coefficient times its basis.
+     */
+    CC3SphericalHarmonics           convolveToIrradiance() const;
+    
+    /** Returns the sum of each coefficient multiplied by its basis function in the specified unit direction. */
+    CC3Vector                       evaluate( const CC3Vector& direction ) const;
+    
+    /** Returns whether all coefficients are zero. */
+    bool                            isZero() const;
+};
+
+
+NS_COCOS3D_END
+
+
+#endif /* _CC3_SPHERICAL_HARMONICS_H_ */
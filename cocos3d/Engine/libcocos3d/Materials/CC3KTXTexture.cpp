@@ -0,0 +1,1056 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#include "cocos3d.h"
+
+NS_COCOS3D_BEGIN
+
+CC3KTXFormatFamily CC3KTXFormatFamilyFromGLFormat( GLenum glInternalFormat )
+{
+	switch ( glInternalFormat )
+	{
+		case GL_RGBA:
+		case GL_RGB:
+		case GL_LUMINANCE:
+		case GL_LUMINANCE_ALPHA:
+		case GL_ALPHA:
+			return kCC3KTXFormatFamilyUncompressed;
+		case GL_ETC1_RGB8_OES:
+			return kCC3KTXFormatFamilyETC1;
+		case GL_COMPRESSED_R11_EAC:
+		case GL_COMPRESSED_RG11_EAC:
+		case GL_COMPRESSED_RGB8_ETC2:
+		case GL_COMPRESSED_SRGB8_ETC2:
+		case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+		case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+			return kCC3KTXFormatFamilyETC2;
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return kCC3KTXFormatFamilyBC;
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+			return kCC3KTXFormatFamilyBC7;
+		default:
+			if ( (glInternalFormat >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR && glInternalFormat <= GL_COMPRESSED_RGBA_ASTC_12x12_KHR) ||
+				 (glInternalFormat >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR && glInternalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR) )
+				return kCC3KTXFormatFamilyASTC;
+			return kCC3KTXFormatFamilyUnknown;
+	}
+}
+
+#pragma mark -
+#pragma mark Block decoders
+
+/** Returns the specified value clamped to the range of an unsigned byte. */
+static inline GLubyte CC3KTXClampByte( GLint value )
+{
+	return (GLubyte)((value < 0) ? 0 : ((value > 255) ? 255 : value));
+}
+
+static inline GLubyte CC3KTXExtend4( GLuint value ) { return (GLubyte)((value << 4) | value); }
+static inline GLubyte CC3KTXExtend5( GLuint value ) { return (GLubyte)((value << 3) | (value >> 2)); }
+static inline GLubyte CC3KTXExtend6( GLuint value ) { return (GLubyte)((value << 2) | (value >> 4)); }
+static inline GLubyte CC3KTXExtend7( GLuint value ) { return (GLubyte)((value << 1) | (value >> 6)); }
+
+static const GLint kCC3ETCModifierTable[8][4] = {
+	{ 2, 8, -2, -8 }, { 5, 17, -5, -17 }, { 9, 29, -9, -29 }, { 13, 42, -13, -42 },
+	{ 18, 60, -18, -60 }, { 24, 80, -24, -80 }, { 33, 106, -33, -106 }, { 47, 183, -47, -183 },
+};
+
+static const GLint kCC3ETCDistanceTable[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const GLint kCC3EACModifierTable[16][8] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 },
+	{ -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 },
+	{ -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 },
+	{ -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 },
+};
+
+/** Returns the 2-bit ETC pixel index of the pixel at the specified location in the block. */
+static inline GLuint CC3ETCPixelIndex( const GLubyte* src, GLuint x, GLuint y )
+{
+	GLuint bit = x * 4 + y;		// Pixels are stored in column-major order
+	GLuint msbs = ((GLuint)src[4] << 8) | src[5];
+	GLuint lsbs = ((GLuint)src[6] << 8) | src[7];
+	return (((msbs >> bit) & 1) << 1) | ((lsbs >> bit) & 1);
+}
+
+/** 
+ * Decodes a 4x4 block of ETC1 or ETC2 RGB content into the specified 16 RGBA texels.
+ * ETC1 blocks never use the T, H and planar modes, so are decoded as ETC2 blocks.
+ */
+static void CC3DecodeETC2RGBBlock( const GLubyte* src, ccColor4B* texels )
+{
+	bool isDifferential = (src[3] & 0x2) != 0;
+	bool isFlipped = (src[3] & 0x1) != 0;
+
+	GLint r1, g1, b1, r2, g2, b2;
+	if ( !isDifferential )
+	{
+		r1 = CC3KTXExtend4( src[0] >> 4 ); r2 = CC3KTXExtend4( src[0] & 0xF );
+		g1 = CC3KTXExtend4( src[1] >> 4 ); g2 = CC3KTXExtend4( src[1] & 0xF );
+		b1 = CC3KTXExtend4( src[2] >> 4 ); b2 = CC3KTXExtend4( src[2] & 0xF );
+	}
+	else
+	{
+		GLint r = src[0] >> 3, dr = ((GLint)(src[0] & 0x7) << 29) >> 29;
+		GLint g = src[1] >> 3, dg = ((GLint)(src[1] & 0x7) << 29) >> 29;
+		GLint b = src[2] >> 3, db = ((GLint)(src[2] & 0x7) << 29) >> 29;
+
+		if ( r + dr < 0 || r + dr > 31 )
+		{
+			// T mode
+			ccColor4B paint[4];
+			GLint d = kCC3ETCDistanceTable[((src[3] >> 1) & 0x6) | (src[3] & 0x1)];
+			GLint tr1 = CC3KTXExtend4( ((src[0] & 0x18) >> 1) | (src[0] & 0x3) );
+			GLint tg1 = CC3KTXExtend4( src[1] >> 4 ), tb1 = CC3KTXExtend4( src[1] & 0xF );
+			GLint tr2 = CC3KTXExtend4( src[2] >> 4 ), tg2 = CC3KTXExtend4( src[2] & 0xF );
+			GLint tb2 = CC3KTXExtend4( src[3] >> 4 );
+			paint[0] = ccc4( tr1, tg1, tb1, 255 );
+			paint[1] = ccc4( CC3KTXClampByte( tr2 + d ), CC3KTXClampByte( tg2 + d ), CC3KTXClampByte( tb2 + d ), 255 );
+			paint[2] = ccc4( tr2, tg2, tb2, 255 );
+			paint[3] = ccc4( CC3KTXClampByte( tr2 - d ), CC3KTXClampByte( tg2 - d ), CC3KTXClampByte( tb2 - d ), 255 );
+			for ( GLuint y = 0; y < 4; y++ )
+				for ( GLuint x = 0; x < 4; x++ )
+					texels[y * 4 + x] = paint[CC3ETCPixelIndex( src, x, y )];
+			return;
+		}
+
+		if ( g + dg < 0 || g + dg > 31 )
+		{
+			// H mode
+			ccColor4B paint[4];
+			GLuint hr1 = (src[0] >> 3) & 0xF;
+			GLuint hg1 = ((src[0] << 1) & 0xE) | ((src[1] >> 4) & 0x1);
+			GLuint hb1 = (src[1] & 0x8) | ((src[1] << 1) & 0x6) | (src[2] >> 7);
+			GLuint hr2 = (src[2] >> 3) & 0xF;
+			GLuint hg2 = ((src[2] << 1) & 0xE) | (src[3] >> 7);
+			GLuint hb2 = (src[3] >> 3) & 0xF;
+			GLuint dIdx = (src[3] & 0x4) | ((src[3] << 1) & 0x2);
+			if ( ((hr1 << 8) | (hg1 << 4) | hb1) >= ((hr2 << 8) | (hg2 << 4) | hb2) )
+				dIdx |= 1;
+			GLint d = kCC3ETCDistanceTable[dIdx];
+			GLint cr1 = CC3KTXExtend4( hr1 ), cg1 = CC3KTXExtend4( hg1 ), cb1 = CC3KTXExtend4( hb1 );
+			GLint cr2 = CC3KTXExtend4( hr2 ), cg2 = CC3KTXExtend4( hg2 ), cb2 = CC3KTXExtend4( hb2 );
+			paint[0] = ccc4( CC3KTXClampByte( cr1 + d ), CC3KTXClampByte( cg1 + d ), CC3KTXClampByte( cb1 + d ), 255 );
+			paint[1] = ccc4( CC3KTXClampByte( cr1 - d ), CC3KTXClampByte( cg1 - d ), CC3KTXClampByte( cb1 - d ), 255 );
+			paint[2] = ccc4( CC3KTXClampByte( cr2 + d ), CC3KTXClampByte( cg2 + d ), CC3KTXClampByte( cb2 + d ), 255 );
+			paint[3] = ccc4( CC3KTXClampByte( cr2 - d ), CC3KTXClampByte( cg2 - d ), CC3KTXClampByte( cb2 - d ), 255 );
+			for ( GLuint y = 0; y < 4; y++ )
+				for ( GLuint x = 0; x < 4; x++ )
+					texels[y * 4 + x] = paint[CC3ETCPixelIndex( src, x, y )];
+			return;
+		}
+
+		if ( b + db < 0 || b + db > 31 )
+		{
+			// Planar mode
+			GLint ro = CC3KTXExtend6( (src[0] >> 1) & 0x3F );
+			GLint go = CC3KTXExtend7( ((src[0] & 0x1) << 6) | ((src[1] >> 1) & 0x3F) );
+			GLint bo = CC3KTXExtend6( ((src[1] & 0x1) << 5) | (src[2] & 0x18) | ((src[2] & 0x3) << 1) | ((src[3] >> 7) & 0x1) );
+			GLint rh = CC3KTXExtend6( ((src[3] >> 1) & 0x3E) | (src[3] & 0x1) );
+			GLint gh = CC3KTXExtend7( (src[4] >> 1) & 0x7F );
+			GLint bh = CC3KTXExtend6( ((src[4] & 0x1) << 5) | ((src[5] >> 3) & 0x1F) );
+			GLint rv = CC3KTXExtend6( ((src[5] & 0x7) << 3) | ((src[6] >> 5) & 0x7) );
+			GLint gv = CC3KTXExtend7( ((src[6] & 0x1F) << 2) | ((src[7] >> 6) & 0x3) );
+			GLint bv = CC3KTXExtend6( src[7] & 0x3F );
+			for ( GLint y = 0; y < 4; y++ )
+				for ( GLint x = 0; x < 4; x++ )
+					texels[y * 4 + x] = ccc4( CC3KTXClampByte( (x * (rh - ro) + y * (rv - ro) + 4 * ro + 2) >> 2 ),
+											  CC3KTXClampByte( (x * (gh - go) + y * (gv - go) + 4 * go + 2) >> 2 ),
+											  CC3KTXClampByte( (x * (bh - bo) + y * (bv - bo) + 4 * bo + 2) >> 2 ), 255 );
+			return;
+		}
+
+		r1 = CC3KTXExtend5( r ); r2 = CC3KTXExtend5( r + dr );
+		g1 = CC3KTXExtend5( g ); g2 = CC3KTXExtend5( g + dg );
+		b1 = CC3KTXExtend5( b ); b2 = CC3KTXExtend5( b + db );
+	}
+
+	const GLint* mods1 = kCC3ETCModifierTable[(src[3] >> 5) & 0x7];
+	const GLint* mods2 = kCC3ETCModifierTable[(src[3] >> 2) & 0x7];
+	for ( GLuint y = 0; y < 4; y++ )
+	{
+		for ( GLuint x = 0; x < 4; x++ )
+		{
+			bool isSecond = isFlipped ? (y >= 2) : (x >= 2);
+			GLint mod = (isSecond ? mods2 : mods1)[CC3ETCPixelIndex( src, x, y )];
+			texels[y * 4 + x] = isSecond
+				? ccc4( CC3KTXClampByte( r2 + mod ), CC3KTXClampByte( g2 + mod ), CC3KTXClampByte( b2 + mod ), 255 )
+				: ccc4( CC3KTXClampByte( r1 + mod ), CC3KTXClampByte( g1 + mod ), CC3KTXClampByte( b1 + mod ), 255 );
+		}
+	}
+}
+
+/** Decodes an 8-byte EAC alpha block into the alpha components of the specified 16 texels. */
+static void CC3DecodeEACAlphaBlock( const GLubyte* src, ccColor4B* texels )
+{
+	GLint base = src[0];
+	GLint mult = src[1] >> 4;
+	const GLint* mods = kCC3EACModifierTable[src[1] & 0xF];
+	unsigned long long bits = 0;
+	for ( GLuint i = 2; i < 8; i++ )
+		bits = (bits << 8) | src[i];
+
+	for ( GLuint x = 0; x < 4; x++ )
+	{
+		for ( GLuint y = 0; y < 4; y++ )
+		{
+			GLuint i = x * 4 + y;		// Pixels are stored in column-major order
+			GLuint idx = (GLuint)(bits >> (45 - 3 * i)) & 0x7;
+			texels[y * 4 + x].a = CC3KTXClampByte( base + mods[idx] * mult );
+		}
+	}
+}
+
+/** Decodes a BC1 color block into the specified 16 texels, optionally using the transparent mode. */
+static void CC3DecodeBC1Block( const GLubyte* src, ccColor4B* texels, bool allowTransparent )
+{
+	GLuint c0 = src[0] | ((GLuint)src[1] << 8);
+	GLuint c1 = src[2] | ((GLuint)src[3] << 8);
+	ccColor4B paint[4];
+	paint[0] = ccc4( CC3KTXExtend5( c0 >> 11 ), CC3KTXExtend6( (c0 >> 5) & 0x3F ), CC3KTXExtend5( c0 & 0x1F ), 255 );
+	paint[1] = ccc4( CC3KTXExtend5( c1 >> 11 ), CC3KTXExtend6( (c1 >> 5) & 0x3F ), CC3KTXExtend5( c1 & 0x1F ), 255 );
+	if ( c0 > c1 || !allowTransparent )
+	{
+		paint[2] = ccc4( (2 * paint[0].r + paint[1].r) / 3, (2 * paint[0].g + paint[1].g) / 3, (2 * paint[0].b + paint[1].b) / 3, 255 );
+		paint[3] = ccc4( (paint[0].r + 2 * paint[1].r) / 3, (paint[0].g + 2 * paint[1].g) / 3, (paint[0].b + 2 * paint[1].b) / 3, 255 );
+	}
+	else
+	{
+		paint[2] = ccc4( (paint[0].r + paint[1].r) / 2, (paint[0].g + paint[1].g) / 2, (paint[0].b + paint[1].b) / 2, 255 );
+		paint[3] = ccc4( 0, 0, 0, 0 );
+	}
+
+	GLuint indices = src[4] | ((GLuint)src[5] << 8) | ((GLuint)src[6] << 16) | ((GLuint)src[7] << 24);
+	for ( GLuint i = 0; i < 16; i++ )
+		texels[i] = paint[(indices >> (2 * i)) & 0x3];		// Pixels are stored in row-major order
+}
+
+/** Decodes a BC2 explicit alpha block into the alpha components of the specified 16 texels. */
+static void CC3DecodeBC2AlphaBlock( const GLubyte* src, ccColor4B* texels )
+{
+	for ( GLuint i = 0; i < 16; i++ )
+		texels[i].a = CC3KTXExtend4( (src[i / 2] >> ((i & 1) * 4)) & 0xF );
+}
+
+/** Decodes a BC3 interpolated alpha block into the alpha components of the specified 16 texels. */
+static void CC3DecodeBC3AlphaBlock( const GLubyte* src, ccColor4B* texels )
+{
+	GLuint a0 = src[0], a1 = src[1];
+	GLubyte alphas[8];
+	alphas[0] = (GLubyte)a0;
+	alphas[1] = (GLubyte)a1;
+	if ( a0 > a1 )
+	{
+		for ( GLuint k = 1; k < 7; k++ )
+			alphas[k + 1] = (GLubyte)(((7 - k) * a0 + k * a1) / 7);
+	}
+	else
+	{
+		for ( GLuint k = 1; k < 5; k++ )
+			alphas[k + 1] = (GLubyte)(((5 - k) * a0 + k * a1) / 5);
+		alphas[6] = 0;
+		alphas[7] = 255;
+	}
+
+	unsigned long long bits = 0;
+	for ( GLint i = 7; i >= 2; i-- )
+		bits = (bits << 8) | src[i];
+	for ( GLuint i = 0; i < 16; i++ )
+		texels[i].a = alphas[(bits >> (3 * i)) & 0x7];
+}
+
+/** Returns the number of bytes in each 4x4 block of the specified decodable format, or zero if it cannot be decoded. */
+static GLuint CC3KTXDecodableBlockSize( GLenum format )
+{
+	switch ( format )
+	{
+		case GL_ETC1_RGB8_OES:
+		case GL_COMPRESSED_RGB8_ETC2:
+		case GL_COMPRESSED_SRGB8_ETC2:
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			return 8;
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+		case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+/** Returns the number of bytes of compressed content of the specified decodable format and size. */
+static unsigned long long CC3KTXDecodableByteCount( GLenum format, const CC3IntSize& size )
+{
+	return (unsigned long long)((size.width + 3) / 4) * ((size.height + 3) / 4) * CC3KTXDecodableBlockSize( format );
+}
+
+/** 
+ * Decodes compressed content of the specified format and size into RGBA texels.
+ * The source must hold the number of bytes returned by CC3KTXDecodableByteCount.
+ * Returns whether the format is one that can be decoded.
+ */
+static bool CC3KTXDecodeImage( const GLubyte* src, GLenum format, const CC3IntSize& size, ccColor4B* dst )
+{
+	GLuint blockSize = CC3KTXDecodableBlockSize( format );
+	if ( blockSize == 0 )
+		return false;
+
+	GLint blocksWide = (size.width + 3) / 4;
+	GLint blocksHigh = (size.height + 3) / 4;
+	ccColor4B texels[16];
+	for ( GLint by = 0; by < blocksHigh; by++ )
+	{
+		for ( GLint bx = 0; bx < blocksWide; bx++, src += blockSize )
+		{
+			switch ( format )
+			{
+				case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+					CC3DecodeBC1Block( src, texels, false );
+					break;
+				case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+					CC3DecodeBC1Block( src, texels, true );
+					break;
+				case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+					CC3DecodeBC1Block( src + 8, texels, false );
+					CC3DecodeBC2AlphaBlock( src, texels );
+					break;
+				case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+					CC3DecodeBC1Block( src + 8, texels, false );
+					CC3DecodeBC3AlphaBlock( src, texels );
+					break;
+				case GL_COMPRESSED_RGBA8_ETC2_EAC:
+				case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+					CC3DecodeETC2RGBBlock( src + 8, texels );
+					CC3DecodeEACAlphaBlock( src, texels );
+					break;
+				default:
+					CC3DecodeETC2RGBBlock( src, texels );
+					break;
+			}
+
+			// Copy the texels that lie within the image, clipping partial edge blocks
+			for ( GLint y = 0; y < 4 && by * 4 + y < size.height; y++ )
+				for ( GLint x = 0; x < 4 && bx * 4 + x < size.width; x++ )
+					dst[(by * 4 + y) * size.width + bx * 4 + x] = texels[y * 4 + x];
+		}
+	}
+	return true;
+}
+
+#pragma mark -
+#pragma mark CC3KTXTextureContent
+
+static const GLubyte kCC3KTX1Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+static const GLubyte kCC3KTX2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+#define kCC3KTX1HeaderSize			64
+#define kCC3KTX2HeaderSize			80
+#define kCC3KTX2LevelIndexEntrySize	24
+#define kCC3KTXEndianness			0x04030201
+#define kCC3KTXMaxDimension			16384		// Larger than any GL texture size limit
+#define kCC3KTXMaxMipmapLevels		15			// Enough for the largest dimension
+
+/** Returns the 32-bit little-endian value at the specified location. */
+static inline GLuint CC3KTXReadUInt32( const GLubyte* src )
+{
+	return src[0] | ((GLuint)src[1] << 8) | ((GLuint)src[2] << 16) | ((GLuint)src[3] << 24);
+}
+
+/** Returns the 64-bit little-endian value at the specified location. */
+static inline unsigned long long CC3KTXReadUInt64( const GLubyte* src )
+{
+	return CC3KTXReadUInt32( src ) | ((unsigned long long)CC3KTXReadUInt32( src + 4 ) << 32);
+}
+
+static inline GLuint CC3KTXSwapUInt32( GLuint value )
+{
+	return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+}
+
+/** 
+ * Returns the GL format equivalent to the specified Vulkan format used in KTX2 files, or GL_ZERO
+ * if the format is not supported. For uncompressed formats, the pixel format and type are also
+ * returned. Since Cocos3D does not use sRGB framebuffers, sRGB variants of the BC formats are
+ * mapped to their linear equivalents, so that they are shaded the same as other textures.
+ */
+static GLenum CC3GLFormatFromVkFormat( GLuint vkFormat, GLenum& pixelFormat, GLenum& pixelType )
+{
+	pixelFormat = GL_ZERO;
+	pixelType = GL_ZERO;
+	switch ( vkFormat )
+	{
+		case 23:	// VK_FORMAT_R8G8B8_UNORM
+			pixelFormat = GL_RGB;
+			pixelType = GL_UNSIGNED_BYTE;
+			return GL_RGB;
+		case 37:	// VK_FORMAT_R8G8B8A8_UNORM
+			pixelFormat = GL_RGBA;
+			pixelType = GL_UNSIGNED_BYTE;
+			return GL_RGBA;
+		case 131:	// VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		case 132:	return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case 133:	// VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+		case 134:	return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case 135:	// VK_FORMAT_BC2_UNORM_BLOCK
+		case 136:	return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		case 137:	// VK_FORMAT_BC3_UNORM_BLOCK
+		case 138:	return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case 145:	// VK_FORMAT_BC7_UNORM_BLOCK
+		case 146:	return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		case 147:	return GL_COMPRESSED_RGB8_ETC2;
+		case 148:	return GL_COMPRESSED_SRGB8_ETC2;
+		case 149:	// VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK
+		case 150:	return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+		case 151:	return GL_COMPRESSED_RGBA8_ETC2_EAC;
+		case 152:	return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+		case 153:	return GL_COMPRESSED_R11_EAC;
+		case 155:	return GL_COMPRESSED_RG11_EAC;
+		default:
+			// VK_FORMAT_ASTC_4x4_UNORM_BLOCK to VK_FORMAT_ASTC_12x12_SRGB_BLOCK alternate UNORM & SRGB
+			if ( vkFormat >= 157 && vkFormat <= 184 )
+			{
+				GLuint blockIdx = (vkFormat - 157) / 2;
+				bool isSRGB = ((vkFormat - 157) % 2) != 0;
+				return (isSRGB ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR : GL_COMPRESSED_RGBA_ASTC_4x4_KHR) + blockIdx;
+			}
+			return GL_ZERO;
+	}
+}
+
+CC3KTXTextureContent::CC3KTXTextureContent()
+{
+	m_data = NULL;
+	m_dataSize = 0;
+	m_size = CC3IntSizeMake( 0, 0 );
+	m_internalFormat = GL_ZERO;
+	m_pixelFormat = GL_ZERO;
+	m_pixelType = GL_ZERO;
+	m_mipmapLevelCount = 0;
+	m_faceCount = 0;
+	m_unpackAlignment = 1;
+	m_hasPremultipliedAlpha = false;
+}
+
+CC3KTXTextureContent::~CC3KTXTextureContent()
+{
+	CC_SAFE_DELETE_ARRAY( m_data );
+}
+
+CC3IntSize CC3KTXTextureContent::getSize()
+{
+	return m_size;
+}
+
+GLenum CC3KTXTextureContent::getInternalFormat()
+{
+	return m_internalFormat;
+}
+
+GLenum CC3KTXTextureContent::getPixelFormat()
+{
+	return m_pixelFormat;
+}
+
+GLenum CC3KTXTextureContent::getPixelType()
+{
+	return m_pixelType;
+}
+
+bool CC3KTXTextureContent::isCompressed()
+{
+	return m_pixelType == GL_ZERO;
+}
+
+GLuint CC3KTXTextureContent::getMipmapLevelCount()
+{
+	return m_mipmapLevelCount;
+}
+
+GLuint CC3KTXTextureContent::getFaceCount()
+{
+	return m_faceCount;
+}
+
+bool CC3KTXTextureContent::isTextureCube()
+{
+	return m_faceCount == 6;
+}
+
+GLint CC3KTXTextureContent::getUnpackAlignment()
+{
+	return m_unpackAlignment;
+}
+
+bool CC3KTXTextureContent::hasAlpha()
+{
+	switch ( m_internalFormat )
+	{
+		case GL_RGB:
+		case GL_LUMINANCE:
+		case GL_ETC1_RGB8_OES:
+		case GL_COMPRESSED_RGB8_ETC2:
+		case GL_COMPRESSED_SRGB8_ETC2:
+		case GL_COMPRESSED_R11_EAC:
+		case GL_COMPRESSED_RG11_EAC:
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+			return false;
+		default:
+			return true;
+	}
+}
+
+bool CC3KTXTextureContent::hasPremultipliedAlpha()
+{
+	return m_hasPremultipliedAlpha;
+}
+
+unsigned long CC3KTXTextureContent::getByteCount()
+{
+	unsigned long byteCount = 0;
+	for ( std::vector<CC3KTXImage>::iterator it = m_images.begin(); it != m_images.end(); ++it )
+		byteCount += it->byteCount;
+	return byteCount;
+}
+
+const CC3KTXImage& CC3KTXTextureContent::getImage( GLuint mipLevel, GLuint face )
+{
+	return m_images[mipLevel * m_faceCount + face];
+}
+
+const GLvoid* CC3KTXTextureContent::getImageData( GLuint mipLevel, GLuint face )
+{
+	return m_data + getImage( mipLevel, face ).offset;
+}
+
+bool CC3KTXTextureContent::isKTXFile( const std::string& filePath )
+{
+	std::string lcPath = filePath;
+	std::transform( lcPath.begin(), lcPath.end(), lcPath.begin(), ::tolower );
+	size_t extPos = lcPath.find_last_of( '.' );
+	if ( extPos == std::string::npos )
+		return false;
+
+	std::string ext = lcPath.substr( extPos );
+	return (ext == ".ktx" || ext == ".ktx2");
+}
+
+bool CC3KTXTextureContent::initFromFile( const std::string& filePath )
+{
+	std::string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename( filePath.c_str() );
+	m_data = CCFileUtils::sharedFileUtils()->getFileData( fullPath.c_str(), "rb", &m_dataSize );
+	if ( !m_data || m_dataSize < kCC3KTX1HeaderSize )
+	{
+		CCLOGERROR( "Could not load KTX texture file %s", filePath.c_str() );
+		return false;
+	}
+
+	bool wasParsed = false;
+	if ( memcmp( m_data, kCC3KTX1Identifier, sizeof(kCC3KTX1Identifier) ) == 0 )
+		wasParsed = parseKTX1();
+	else if ( memcmp( m_data, kCC3KTX2Identifier, sizeof(kCC3KTX2Identifier) ) == 0 )
+		wasParsed = parseKTX2();
+
+	if ( !wasParsed )
+	{
+		CCLOGERROR( "Could not parse KTX texture file %s", filePath.c_str() );
+		return false;
+	}
+
+	return true;
+}
+
+/** Parses the content of a KTX version 1 file, which may be in either byte order. */
+bool CC3KTXTextureContent::parseKTX1()
+{
+	GLuint header[13];
+	for ( GLuint i = 0; i < 13; i++ )
+		header[i] = CC3KTXReadUInt32( m_data + 12 + i * 4 );
+
+	bool needsSwap = (header[0] != kCC3KTXEndianness);
+	if ( needsSwap )
+	{
+		if ( CC3KTXSwapUInt32( header[0] ) != kCC3KTXEndianness )
+			return false;
+		for ( GLuint i = 1; i < 13; i++ )
+			header[i] = CC3KTXSwapUInt32( header[i] );
+	}
+
+	GLuint glType = header[1];
+	GLuint glTypeSize = header[2];
+	GLuint glFormat = header[3];
+	GLuint glInternalFormat = header[4];
+	GLuint pixelDepth = header[8];
+	GLuint arrayElementCount = header[9];
+	GLuint bytesOfKeyValueData = header[12];
+
+	if ( pixelDepth > 1 || arrayElementCount > 0 )
+		return false;		// 3D and array textures are not supported
+	if ( header[6] == 0 || header[6] > kCC3KTXMaxDimension || header[7] > kCC3KTXMaxDimension || header[11] > kCC3KTXMaxMipmapLevels )
+		return false;
+
+	m_size = CC3IntSizeMake( header[6], MAX( header[7], 1u ) );
+	m_faceCount = header[10];
+	m_mipmapLevelCount = MAX( header[11], 1u );
+	m_internalFormat = (glType == 0) ? glInternalFormat : glFormat;	// GLES requires matching uncompressed formats
+	m_pixelFormat = (glType == 0) ? GL_ZERO : glFormat;
+	m_pixelType = glType;
+	m_unpackAlignment = 4;		// KTX1 rows are padded to 4 bytes
+	if ( m_faceCount != 1 && m_faceCount != 6 )
+		return false;
+
+	unsigned long long offset = (unsigned long long)kCC3KTX1HeaderSize + bytesOfKeyValueData;
+	for ( GLuint level = 0; level < m_mipmapLevelCount; level++ )
+	{
+		if ( offset + 4 > m_dataSize )
+			return false;
+
+		GLuint imageSize = CC3KTXReadUInt32( m_data + offset );
+		if ( needsSwap )
+			imageSize = CC3KTXSwapUInt32( imageSize );
+		offset += 4;
+
+		CC3IntSize levelSize = CC3IntSizeMake( MAX( m_size.width >> level, 1 ), MAX( m_size.height >> level, 1 ) );
+		for ( GLuint face = 0; face < m_faceCount; face++ )
+		{
+			if ( offset + imageSize > m_dataSize )
+				return false;
+
+			// Swap multi-byte uncompressed texel components into native order
+			if ( needsSwap && glTypeSize == 2 )
+			{
+				for ( GLuint i = 0; i + 1 < imageSize; i += 2 )
+					std::swap( m_data[offset + i], m_data[offset + i + 1] );
+			}
+			else if ( needsSwap && glTypeSize == 4 )
+			{
+				for ( GLuint i = 0; i + 3 < imageSize; i += 4 )
+				{
+					std::swap( m_data[offset + i], m_data[offset + i + 3] );
+					std::swap( m_data[offset + i + 1], m_data[offset + i + 2] );
+				}
+			}
+
+			CC3KTXImage image;
+			image.offset = (GLuint)offset;
+			image.byteCount = imageSize;
+			image.size = levelSize;
+			m_images.push_back( image );
+			offset += (imageSize + 3) & ~3u;		// Cube padding
+		}
+		offset = (offset + 3) & ~3ull;				// Mip padding
+	}
+	return true;
+}
+
+/** Parses the content of a KTX2 file, which is always little-endian. */
+bool CC3KTXTextureContent::parseKTX2()
+{
+	if ( m_dataSize < kCC3KTX2HeaderSize )
+		return false;
+
+	GLuint vkFormat = CC3KTXReadUInt32( m_data + 12 );
+	GLuint pixelWidth = CC3KTXReadUInt32( m_data + 20 );
+	GLuint pixelHeight = CC3KTXReadUInt32( m_data + 24 );
+	GLuint pixelDepth = CC3KTXReadUInt32( m_data + 28 );
+	GLuint layerCount = CC3KTXReadUInt32( m_data + 32 );
+	GLuint faceCount = CC3KTXReadUInt32( m_data + 36 );
+	GLuint levelCount = CC3KTXReadUInt32( m_data + 40 );
+	GLuint supercompressionScheme = CC3KTXReadUInt32( m_data + 44 );
+	GLuint dfdByteOffset = CC3KTXReadUInt32( m_data + 48 );
+	GLuint dfdByteLength = CC3KTXReadUInt32( m_data + 52 );
+
+	if ( supercompressionScheme != 0 )
+	{
+		CCLOGERROR( "Supercompressed KTX2 files are not supported" );
+		return false;
+	}
+	if ( pixelDepth > 1 || layerCount > 0 || (faceCount != 1 && faceCount != 6) )
+		return false;		// 3D and array textures are not supported
+	if ( pixelWidth == 0 || pixelWidth > kCC3KTXMaxDimension || pixelHeight > kCC3KTXMaxDimension || levelCount > kCC3KTXMaxMipmapLevels )
+		return false;
+
+	m_internalFormat = CC3GLFormatFromVkFormat( vkFormat, m_pixelFormat, m_pixelType );
+	if ( m_internalFormat == GL_ZERO )
+	{
+		CCLOGERROR( "KTX2 Vulkan format %u is not supported", vkFormat );
+		return false;
+	}
+
+	m_size = CC3IntSizeMake( pixelWidth, MAX( pixelHeight, 1u ) );
+	m_faceCount = faceCount;
+	m_mipmapLevelCount = MAX( levelCount, 1u );
+	m_unpackAlignment = 1;		// KTX2 rows are tightly packed
+
+	// The alpha-premultiplied flag is in the first byte of the third word of the basic data format descriptor
+	if ( dfdByteLength >= 16 && (unsigned long long)dfdByteOffset + 16 <= m_dataSize )
+		m_hasPremultipliedAlpha = (m_data[dfdByteOffset + 4 + 8 + 3] & 0x1) != 0;
+
+	if ( kCC3KTX2HeaderSize + (unsigned long long)m_mipmapLevelCount * kCC3KTX2LevelIndexEntrySize > m_dataSize )
+		return false;
+
+	for ( GLuint level = 0; level < m_mipmapLevelCount; level++ )
+	{
+		const GLubyte* entry = m_data + kCC3KTX2HeaderSize + level * kCC3KTX2LevelIndexEntrySize;
+		unsigned long long byteOffset = CC3KTXReadUInt64( entry );
+		unsigned long long byteLength = CC3KTXReadUInt64( entry + 8 );
+		if ( byteOffset > m_dataSize || byteLength > m_dataSize - byteOffset )
+			return false;
+
+		CC3IntSize levelSize = CC3IntSizeMake( MAX( m_size.width >> level, 1 ), MAX( m_size.height >> level, 1 ) );
+		GLuint faceSize = (GLuint)(byteLength / m_faceCount);
+		for ( GLuint face = 0; face < m_faceCount; face++ )
+		{
+			CC3KTXImage image;
+			image.offset = (GLuint)(byteOffset + face * faceSize);
+			image.byteCount = faceSize;
+			image.size = levelSize;
+			m_images.push_back( image );
+		}
+	}
+	return true;
+}
+
+bool CC3KTXTextureContent::canDecode()
+{
+	switch ( m_internalFormat )
+	{
+		case GL_ETC1_RGB8_OES:
+		case GL_COMPRESSED_RGB8_ETC2:
+		case GL_COMPRESSED_SRGB8_ETC2:
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+		case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool CC3KTXTextureContent::decodeToRGBA()
+{
+	if ( !isCompressed() || !canDecode() )
+		return false;
+
+	// Reject truncated images before reading them. The dimensions were capped while parsing.
+	unsigned long long decodedSize = 0;
+	for ( std::vector<CC3KTXImage>::iterator it = m_images.begin(); it != m_images.end(); ++it )
+	{
+		if ( it->byteCount < CC3KTXDecodableByteCount( m_internalFormat, it->size ) )
+			return false;
+		decodedSize += (unsigned long long)it->size.width * it->size.height * sizeof(ccColor4B);
+	}
+	if ( decodedSize > 0xFFFFFFFFull )
+		return false;
+
+	GLubyte* decodedData = new GLubyte[(size_t)decodedSize];
+	GLuint offset = 0;
+	for ( std::vector<CC3KTXImage>::iterator it = m_images.begin(); it != m_images.end(); ++it )
+	{
+		CC3KTXDecodeImage( m_data + it->offset, m_internalFormat, it->size, (ccColor4B*)(decodedData + offset) );
+		it->offset = offset;
+		it->byteCount = it->size.width * it->size.height * sizeof(ccColor4B);
+		offset += it->byteCount;
+	}
+
+	CC_SAFE_DELETE_ARRAY( m_data );
+	m_data = decodedData;
+	m_dataSize = (unsigned long)decodedSize;
+	m_internalFormat = GL_RGBA;
+	m_pixelFormat = GL_RGBA;
+	m_pixelType = GL_UNSIGNED_BYTE;
+	m_unpackAlignment = 4;
+	return true;
+}
+
+#pragma mark -
+#pragma mark CC3KTXTexture
+
+CC3KTXTexture::CC3KTXTexture()
+{
+	m_byteCost = 0;
+	m_isTextureCube = false;
+	m_isCompressed = false;
+}
+
+bool CC3KTXTexture::shouldFlipVerticallyOnLoad()
+{
+	return false;
+}
+
+void CC3KTXTexture::setShouldFlipVerticallyOnLoad( bool shouldFlip )
+{
+
+}
+
+bool CC3KTXTexture::shouldFlipHorizontallyOnLoad()
+{
+	return false;
+}
+
+void CC3KTXTexture::setShouldFlipHorizontallyOnLoad( bool shouldFlip )
+{
+
+}
+
+GLenum CC3KTXTexture::getSamplerSemantic()
+{
+	return isTextureCube() ? kCC3SemanticTextureCubeSampler : kCC3SemanticTexture2DSampler;
+}
+
+bool CC3KTXTexture::isTexture2D()
+{
+	return !isTextureCube();
+}
+
+bool CC3KTXTexture::isTextureCube()
+{
+	return m_isTextureCube;
+}
+
+GLenum CC3KTXTexture::getTextureTarget()
+{
+	return isTextureCube() ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+}
+
+GLenum CC3KTXTexture::getInitialAttachmentFace()
+{
+	return isTextureCube() ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : GL_TEXTURE_2D;
+}
+
+unsigned long CC3KTXTexture::getByteCost()
+{
+	return m_byteCost;
+}
+
+bool CC3KTXTexture::isCompressed()
+{
+	return m_isCompressed;
+}
+
+/** Uploads the content directly. The orientation of compressed content cannot be changed. */
+void CC3KTXTexture::bindTextureContent( CC3KTXTextureContent* texContent )
+{
+	if ( !texContent )
+		return;
+
+	m_size = texContent->getSize();
+	m_coverage = CCSizeMake( 1.0f, 1.0f );
+	m_isTextureCube = texContent->isTextureCube();
+	m_isCompressed = texContent->isCompressed();
+	m_pixelFormat = m_isCompressed ? texContent->getInternalFormat() : texContent->getPixelFormat();
+	m_pixelType = texContent->getPixelType();
+	m_hasAlpha = texContent->hasAlpha();
+	m_hasPremultipliedAlpha = texContent->hasPremultipliedAlpha();
+	m_hasMipmap = (texContent->getMipmapLevelCount() > 1);
+	m_isUpsideDown = false;
+	m_byteCost = texContent->getByteCount();
+
+	ensureGLTexture();
+	CC3OpenGL* gl = CC3OpenGL::sharedGL();
+	GLuint tuIdx = 0;		// Choose the texture unit in which to work
+	gl->bindTexture( getTextureID(), getTextureTarget(), tuIdx );
+
+	GLuint levelCount = texContent->getMipmapLevelCount();
+	GLuint faceCount = texContent->getFaceCount();
+	for ( GLuint level = 0; level < levelCount; level++ )
+	{
+		for ( GLuint face = 0; face < faceCount; face++ )
+		{
+			const CC3KTXImage& image = texContent->getImage( level, face );
+			GLenum target = getInitialAttachmentFace() + face;
+			if ( m_isCompressed )
+				gl->loadCompressedTextureImage( texContent->getImageData( level, face ), image.byteCount, target, level,
+												image.size, texContent->getInternalFormat(), tuIdx );
+			else
+				gl->loadTexureImage( texContent->getImageData( level, face ), target, level, image.size,
+									 texContent->getPixelFormat(), texContent->getPixelType(),
+									 texContent->getUnpackAlignment(), tuIdx );
+		}
+	}
+
+	// Update the texture parameters depending on whether the KTX file is 2D or cube-map.
+	setTextureParameters( isTextureCube()
+							? CC3TextureCube::defaultTextureParameters()
+							: CC3Texture2D::defaultTextureParameters() );
+}
+
+/** 
+ * The content is not decoded into a CC3Texture2DContent, so KTX textures do not record their
+ * file path, and cannot be evicted by the CC3TextureResidencyManager.
+ */
+bool CC3KTXTexture::loadFromFile( const std::string& filePath )
+{
+	if ( m_sName.empty() )
+		setName( textureNameFromFilePath( filePath ).c_str() );
+
+	std::string bestPath = getBestFilePath( filePath );
+	CC3KTXTextureContent* content = new CC3KTXTextureContent;
+	if ( !content->initFromFile( bestPath ) )
+	{
+		content->release();
+		return false;
+	}
+
+	if ( content->isCompressed() && !isFormatFamilySupported( CC3KTXFormatFamilyFromGLFormat( content->getInternalFormat() ) ) )
+	{
+		if ( !content->decodeToRGBA() )
+		{
+			CCLOGERROR( "The compressed format 0x%04x of KTX texture %s is not supported by this GPU, and cannot be decoded",
+						content->getInternalFormat(), bestPath.c_str() );
+			content->release();
+			return false;
+		}
+		CC3_TRACE( "Decoded KTX texture %s on the CPU, because its compressed format is not supported by this GPU", bestPath.c_str() );
+	}
+
+	bindTextureContent( content );
+	content->release();		// Could be big, so get rid of it immediately
+
+	if ( !hasMipmap() && !isCompressed() && shouldGenerateMipmaps() )
+		generateMipmap();
+
+	checkGLDebugLabel();
+
+	return true;
+}
+
+/** Replacing pixels not supported in compressed KTX textures. */
+void CC3KTXTexture::replacePixels( const CC3Viewport& rect, GLenum target, ccColor4B* colorArray )
+{
+	CCAssert( false, "replacePixels:inTarget:withContent: is not implemented for KTX textures" );
+}
+
+GLuint CC3KTXTexture::getTextureUnitFromVisitor( CC3NodeDrawingVisitor* visitor )
+{
+	return isTextureCube() ? visitor->getCurrentCubeTextureUnit() : visitor->getCurrent2DTextureUnit();
+}
+
+void CC3KTXTexture::incrementTextureUnitInVisitor( CC3NodeDrawingVisitor* visitor )
+{
+	if ( isTextureCube() )
+		visitor->incrementCubeTextureUnit();
+	else
+		visitor->increment2DTextureUnit();
+}
+
+/** Returns whether the GL version string identifies OpenGL ES 3 or later. */
+static bool CC3KTXIsGLES3OrLater()
+{
+	std::string glVersion = CC3OpenGL::sharedGL()->getString( GL_VERSION );
+	size_t esPos = glVersion.find( "OpenGL ES " );
+	return (esPos != std::string::npos) && (atoi( glVersion.c_str() + esPos + 10 ) >= 3);
+}
+
+bool CC3KTXTexture::isFormatFamilySupported( CC3KTXFormatFamily family )
+{
+	static GLint supportedFamilies[kCC3KTXFormatFamilyUnknown + 1] = { -1, -1, -1, -1, -1, -1, -1 };
+	if ( supportedFamilies[family] < 0 )
+	{
+		CC3OpenGL* gl = CC3OpenGL::sharedGL();
+		bool isSupported = false;
+		switch ( family )
+		{
+			case kCC3KTXFormatFamilyUncompressed:
+				isSupported = true;
+				break;
+			case kCC3KTXFormatFamilyETC1:
+				isSupported = gl->supportsExtension( "OES_compressed_ETC1_RGB8_texture" ) || CC3KTXIsGLES3OrLater();
+				break;
+			case kCC3KTXFormatFamilyETC2:
+				isSupported = CC3KTXIsGLES3OrLater() || gl->supportsExtension( "ARB_ES3_compatibility" );
+				break;
+			case kCC3KTXFormatFamilyASTC:
+				isSupported = gl->supportsExtension( "KHR_texture_compression_astc_ldr" );
+				break;
+			case kCC3KTXFormatFamilyBC:
+				isSupported = gl->supportsExtension( "EXT_texture_compression_s3tc" );
+				break;
+			case kCC3KTXFormatFamilyBC7:
+				isSupported = gl->supportsExtension( "ARB_texture_compression_bptc" ) ||
+							  gl->supportsExtension( "EXT_texture_compression_bptc" );
+				break;
+			default:
+				break;
+		}
+		supportedFamilies[family] = isSupported ? 1 : 0;
+	}
+	return supportedFamilies[family] > 0;
+}
+
+/** The format variants considered by getBestFilePath, in order of preference. */
+static const char* kCC3KTXVariantNames[] = { "astc", "bc7", "bc", "etc2", "etc1" };
+static const CC3KTXFormatFamily kCC3KTXVariantFamilies[] = {
+	kCC3KTXFormatFamilyASTC, kCC3KTXFormatFamilyBC7, kCC3KTXFormatFamilyBC, kCC3KTXFormatFamilyETC2, kCC3KTXFormatFamilyETC1,
+};
+#define kCC3KTXVariantCount		(sizeof(kCC3KTXVariantNames) / sizeof(kCC3KTXVariantNames[0]))
+
+std::string CC3KTXTexture::getBestFilePath( const std::string& filePath )
+{
+	size_t extPos = filePath.find_last_of( '.' );
+	if ( extPos == std::string::npos )
+		return filePath;
+
+	CCFileUtils* fileUtils = CCFileUtils::sharedFileUtils();
+	std::string basePath = filePath.substr( 0, extPos );
+	std::string ext = filePath.substr( extPos );
+	std::string decodablePath;
+
+	for ( GLuint i = 0; i < kCC3KTXVariantCount; i++ )
+	{
+		std::string variantPath = basePath + "." + kCC3KTXVariantNames[i] + ext;
+		if ( !fileUtils->isFileExist( fileUtils->fullPathForFilename( variantPath.c_str() ) ) )
+			continue;
+
+		if ( isFormatFamilySupported( kCC3KTXVariantFamilies[i] ) )
+			return variantPath;
+
+		// ASTC and BC7 cannot be decoded on the CPU
+		bool isDecodable = (kCC3KTXVariantFamilies[i] != kCC3KTXFormatFamilyASTC && 
+							kCC3KTXVariantFamilies[i] != kCC3KTXFormatFamilyBC7);
+		if ( isDecodable && decodablePath.empty() )
+			decodablePath = variantPath;
+	}
+
+	return decodablePath.empty() ? filePath : decodablePath;
+}
+
+NS_COCOS3D_END
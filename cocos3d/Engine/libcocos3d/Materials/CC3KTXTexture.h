@@ -0,0 +1,276 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#ifndef _CC3_KTX_TEXTURE_H_
+#define _CC3_KTX_TEXTURE_H_
+
+NS_COCOS3D_BEGIN
+
+// Compressed texture formats that may not be defined by the platform GL headers
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES								0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT					0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT				0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT				0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT				0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM					0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_R11_EAC							0x9270
+#define GL_COMPRESSED_RG11_EAC							0x9272
+#define GL_COMPRESSED_RGB8_ETC2							0x9274
+#define GL_COMPRESSED_SRGB8_ETC2						0x9275
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2		0x9276
+#define GL_COMPRESSED_RGBA8_ETC2_EAC					0x9278
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC				0x9279
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR					0x93B0
+#define GL_COMPRESSED_RGBA_ASTC_12x12_KHR				0x93BD
+#define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR			0x93D0
+#define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR		0x93DD
+#endif
+
+/** The families of compressed texture formats that a KTX file may contain. */
+typedef enum {
+	kCC3KTXFormatFamilyUncompressed,		/**< Uncompressed texel content. */
+	kCC3KTXFormatFamilyETC1,				/**< ETC1 RGB. */
+	kCC3KTXFormatFamilyETC2,				/**< ETC2 RGB and RGBA, and EAC. */
+	kCC3KTXFormatFamilyASTC,				/**< ASTC LDR, in any block size. */
+	kCC3KTXFormatFamilyBC,					/**< BC1, BC2 and BC3 (DXT1, DXT3 and DXT5). */
+	kCC3KTXFormatFamilyBC7,					/**< BC7 (BPTC). */
+	kCC3KTXFormatFamilyUnknown,				/**< A compressed format not recognized by Cocos3D. */
+} CC3KTXFormatFamily;
+
+/** Returns the family of the specified GL internal texture format. */
+CC3KTXFormatFamily CC3KTXFormatFamilyFromGLFormat( GLenum glInternalFormat );
+
+/** The location of the content of one face of one mipmap level within the data of a KTX file. */
+typedef struct {
+	GLuint			offset;			/**< The offset of the content within the file data. */
+	GLuint			byteCount;		/**< The number of bytes of content. */
+	CC3IntSize		size;			/**< The size of the mipmap level, in pixels. */
+} CC3KTXImage;
+
+/**
+ * A helper class used by the CC3KTXTexture class during the loading of a texture from a
+ * KTX (version 1) or KTX2 file.
+ *
+ * The file content is parsed in place, without copying the texel data. Both 2D and cube-map
+ * textures are supported, along with any pre-built mipmap chain contained in the file. KTX2
+ * files must not be supercompressed. Array and 3D textures are not supported.
+ *
+ * Loading does not touch the GL engine, so instances can be loaded on a background thread.
+ */
+class CC3KTXTextureContent : public CCObject
+{
+public:
+	CC3KTXTextureContent();
+	virtual ~CC3KTXTextureContent();
+
+	/** The size of the base mipmap level of this texture, in pixels. */
+	CC3IntSize					getSize();
+
+	/**
+	 * The GL internal format of the texel content. For compressed content, this is the GL enum
+	 * of the compressed format. For uncompressed content, this is the same as the pixelFormat property.
+	 */
+	GLenum						getInternalFormat();
+
+	/** The GL pixel format of uncompressed content, or GL_ZERO for compressed content. */
+	GLenum						getPixelFormat();
+
+	/** The GL pixel type of uncompressed content, or GL_ZERO for compressed content. */
+	GLenum						getPixelType();
+
+	/** Returns whether the content of this texture is block-compressed. */
+	bool						isCompressed();
+
+	/** Returns the number of mipmap levels contained in this texture. Always at least one. */
+	GLuint						getMipmapLevelCount();
+
+	/** Returns the number of faces in this texture. Either one or six. */
+	GLuint						getFaceCount();
+
+	/** Returns whether this texture is a six-sided cube-map texture. */
+	bool						isTextureCube();
+
+	/** Returns the byte alignment of the rows of uncompressed content. */
+	GLint						getUnpackAlignment();
+
+	/** Returns whether the content of this texture includes an alpha channel. */
+	bool						hasAlpha();
+
+	/** Returns whether the alpha channel has already been multiplied into each of the RGB color channels. */
+	bool						hasPremultipliedAlpha();
+
+	/** Returns the total number of bytes of texel content, across all faces and mipmap levels. */
+	unsigned long				getByteCount();
+
+	/** Returns the location and size of the content of the specified face of the specified mipmap level. */
+	const CC3KTXImage&			getImage( GLuint mipLevel, GLuint face );
+
+	/** Returns a pointer to the content of the specified face of the specified mipmap level. */
+	const GLvoid*				getImageData( GLuint mipLevel, GLuint face );
+
+	/**
+	 * Returns whether the compressed content of this texture can be decoded on the CPU by the
+	 * decodeToRGBA method. ETC1, ETC2 RGB and RGBA, and BC1, BC2 and BC3 content can be decoded.
+	 */
+	bool						canDecode();
+
+	/**
+	 * Decodes the compressed content of this texture into uncompressed 8-bit RGBA content,
+	 * for use when the GL engine does not support the compressed format.
+	 *
+	 * All faces and mipmap levels are decoded. Returns whether the content was decoded.
+	 */
+	bool						decodeToRGBA();
+
+	/**
+	 * Initializes this instance by loading the content of the specified KTX or KTX2 file.
+	 *
+	 * The specified file path may be either an absolute path, or a path relative to the
+	 * application resource directory. If the file is located directly in the application
+	 * resources directory, the specified file path can simply be the name of the file.
+	 *
+	 * Returns false if the file could not be loaded.
+	 */
+	bool						initFromFile( const std::string& filePath );
+
+	/** Returns whether the specified file path has a KTX or KTX2 file extension. */
+	static bool					isKTXFile( const std::string& filePath );
+
+protected:
+	bool						parseKTX1();
+	bool						parseKTX2();
+
+protected:
+	GLubyte*					m_data;
+	unsigned long				m_dataSize;
+	std::vector<CC3KTXImage>	m_images;		// Ordered by mip level, then by face
+	CC3IntSize					m_size;
+	GLenum						m_internalFormat;
+	GLenum						m_pixelFormat;
+	GLenum						m_pixelType;
+	GLuint						m_mipmapLevelCount;
+	GLuint						m_faceCount;
+	GLint						m_unpackAlignment;
+	bool						m_hasPremultipliedAlpha : 1;
+};
+
+/**
+ * The representation of a KTX or KTX2 texture that has been loaded into the GL engine.
+ *
+ * This class is used for all 2D and cube-map textures loaded from a KTX file type. Compressed
+ * content, and any pre-built mipmap chain, is uploaded directly to the GL engine, without being
+ * decoded. If the GL engine does not support the compressed format, the content is decoded to
+ * 8-bit RGBA on the CPU instead, if possible (see the canDecode method of CC3KTXTextureContent).
+ *
+ * An asset can be shipped in several compressed formats, by adding the format family as an
+ * additional file extension (eg- "Wood.astc.ktx2", "Wood.etc2.ktx2" and "Wood.bc.ktx2"). When
+ * loading "Wood.ktx2", the variant in the best format supported by the GL engine is selected.
+ * See the getBestFilePath method for more info.
+ *
+ * Like PVR textures, the orientation of compressed textures cannot be changed after loading,
+ * so KTX textures should be authored with the orientation expected by the texture coordinates.
+ */
+class CC3KTXTexture : public CC3Texture
+{
+	DECLARE_SUPER( CC3Texture );
+public:
+	CC3KTXTexture();
+
+	/**
+	 * KTX textures cannot be flipped after loading. This property is overridden so
+	 * that changes are ignored, and to always return NO.
+	 */
+	bool						shouldFlipVerticallyOnLoad();
+	void						setShouldFlipVerticallyOnLoad( bool shouldFlip );
+
+	/**
+	 * KTX textures cannot be flipped after loading. This property is overridden so
+	 * that changes are ignored, and to always return NO.
+	 */
+	bool						shouldFlipHorizontallyOnLoad();
+	void						setShouldFlipHorizontallyOnLoad( bool shouldFlip );
+
+	GLenum						getSamplerSemantic();
+	bool						isTexture2D();
+	bool						isTextureCube();
+	GLenum						getTextureTarget();
+	GLenum						getInitialAttachmentFace();
+	unsigned long				getByteCost();
+
+	/** Returns whether the content of this texture was uploaded to the GL engine in compressed form. */
+	bool						isCompressed();
+
+	/** Uploads all faces and mipmap levels of the specified content to the GL engine. */
+	void						bindTextureContent( CC3KTXTextureContent* texContent );
+
+	/** Replacing pixels not supported in compressed KTX textures. */
+	void						replacePixels( const CC3Viewport& rect, GLenum target, ccColor4B* colorArray );
+	GLuint						getTextureUnitFromVisitor( CC3NodeDrawingVisitor* visitor );
+	void						incrementTextureUnitInVisitor( CC3NodeDrawingVisitor* visitor );
+
+	/**
+	 * Returns whether the GL engine supports uploading content in the specified family of
+	 * compressed formats. The result for each family is determined once, and cached.
+	 */
+	static bool					isFormatFamilySupported( CC3KTXFormatFamily family );
+
+	/**
+	 * Returns the path of the variant of the specified KTX file that is in the best format
+	 * supported by the GL engine.
+	 *
+	 * The variants are located by inserting a format family name before the file extension
+	 * of the specified path. For "Wood.ktx2", the variants "Wood.astc.ktx2", "Wood.bc7.ktx2",
+	 * "Wood.bc.ktx2", "Wood.etc2.ktx2" and "Wood.etc1.ktx2" are considered, in that order.
+	 * The first existing variant that is supported by the GL engine is returned. If none is
+	 * supported, the first existing variant that can be decoded on the CPU is returned.
+	 * If no variants exist, the specified file path is returned.
+	 */
+	static std::string			getBestFilePath( const std::string& filePath );
+
+protected:
+	bool						loadFromFile( const std::string& filePath );
+
+protected:
+	unsigned long				m_byteCost;
+	bool						m_isTextureCube : 1;
+	bool						m_isCompressed : 1;
+};
+
+NS_COCOS3D_END
+
+#endif
@@ -35,9 +35,19 @@ NS_COCOS3D_BEGIN
 #define STBI_HEADER_FILE_ONLY
 #include "stb_image.c"
 
-CC3STBImage::CC3STBImage()
+CC3STBImageLoadOptions CC3STBImageLoadOptionsDefault()
 {
+	CC3STBImageLoadOptions options;
+	options.shouldFlipVertically = false;
+	options.shouldFlipHorizontally = false;
+	options.shouldGenerateMipmaps = false;
+	options.pixelType = GL_UNSIGNED_BYTE;
+	return options;
+}
 
+CC3STBImage::CC3STBImage()
+{
+	init();
 }
 
 CC3STBImage::~CC3STBImage()
@@ -65,6 +75,9 @@ CC3IntSize CC3STBImage::getSize()
 
 GLenum CC3STBImage::getPixelFormat()
 {
+	if (m_pixelType == GL_UNSIGNED_SHORT_5_6_5)
+		return GL_RGB;		// Any alpha was dropped during conversion
+
 	switch (m_componentCount) {
 		case 4:		return GL_RGBA;
 		case 3:		return GL_RGB;
@@ -76,10 +89,199 @@ GLenum CC3STBImage::getPixelFormat()
 
 GLenum CC3STBImage::getPixelType()
 { 
-	return GL_UNSIGNED_BYTE; 
+	return m_pixelType; 
+}
+
+GLuint CC3STBImage::getBytesPerPixel()
+{
+	return (m_pixelType == GL_UNSIGNED_BYTE) ? m_componentCount : 2;
+}
+
+GLuint CC3STBImage::getMipmapLevelCount()
+{
+	return m_mipmapLevelCount;
+}
+
+bool CC3STBImage::isFlippedVertically()
+{
+	return m_isFlippedVertically;
+}
+
+bool CC3STBImage::isFlippedHorizontally()
+{
+	return m_isFlippedHorizontally;
 }
 
 bool CC3STBImage::loadFromFile( const char* filePath )
+{
+	return loadFromFile( filePath, CC3STBImageLoadOptionsDefault() );
+}
+
+/** Returns the pixel type into which an image with the specified number of components can be converted. */
+static GLenum CC3STBImageEffectivePixelType( GLenum pixelType, GLuint componentCount )
+{
+	switch ( pixelType )
+	{
+		case GL_UNSIGNED_SHORT_5_6_5:
+			return (componentCount >= 3) ? pixelType : GL_UNSIGNED_BYTE;
+		case GL_UNSIGNED_SHORT_4_4_4_4:
+		case GL_UNSIGNED_SHORT_5_5_5_1:
+			return (componentCount == 4) ? pixelType : GL_UNSIGNED_BYTE;
+		default:
+			return GL_UNSIGNED_BYTE;
+	}
+}
+
+/** Returns the number of threads to use when processing the rows of large images. */
+static GLuint CC3STBImageProcessorCount()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	long cpuCount = sysconf( _SC_NPROCESSORS_ONLN );
+	return (cpuCount > 1) ? (GLuint)cpuCount : 1;
+#else
+	return 2;
+#endif
+}
+
+/** Images with fewer pixel bytes than this are processed on a single thread. */
+#define kCC3STBImageParallelByteThreshold	(512 * 1024)
+#define kCC3STBImageMaxBandCount			8
+
+/** A band of rows of an image to be processed, and the pixel buffers it is processed between. */
+typedef struct {
+	const GLubyte*			src;
+	GLubyte*				dst;
+	CC3IntSize				srcSize;
+	CC3IntSize				dstSize;
+	GLuint					componentCount;
+	GLenum					pixelType;
+	bool					shouldFlipVertically;
+	bool					shouldFlipHorizontally;
+	GLint					startRow;
+	GLint					endRow;
+	void					(*processRows)( void* band );
+} CC3STBImageBand;
+
+/**
+ * Copies a band of rows of 8-bit pixels from the source to the destination, flipping them
+ * and converting them to the destination pixel type, all in one pass.
+ */
+static void CC3STBImageLayoutRows( void* bandPtr )
+{
+	CC3STBImageBand* band = (CC3STBImageBand*)bandPtr;
+	GLint width = band->srcSize.width;
+	GLint height = band->srcSize.height;
+	GLuint compCnt = band->componentCount;
+	GLuint dstBPP = (band->pixelType == GL_UNSIGNED_BYTE) ? compCnt : 2;
+
+	for ( GLint dstRow = band->startRow; dstRow < band->endRow; dstRow++ )
+	{
+		GLint srcRow = band->shouldFlipVertically ? (height - 1 - dstRow) : dstRow;
+		const GLubyte* srcPx = band->src + srcRow * width * compCnt;
+		GLubyte* dstRowStart = band->dst + dstRow * width * dstBPP;
+
+		if ( band->pixelType == GL_UNSIGNED_BYTE && !band->shouldFlipHorizontally )
+		{
+			memcpy( dstRowStart, srcPx, width * compCnt );
+			continue;
+		}
+
+		for ( GLint col = 0; col < width; col++, srcPx += compCnt )
+		{
+			GLint dstCol = band->shouldFlipHorizontally ? (width - 1 - col) : col;
+			GLubyte* dstPx = dstRowStart + dstCol * dstBPP;
+			switch ( band->pixelType )
+			{
+				case GL_UNSIGNED_SHORT_5_6_5:
+					*(GLushort*)dstPx = (GLushort)(((srcPx[0] >> 3) << 11) | ((srcPx[1] >> 2) << 5) | (srcPx[2] >> 3));
+					break;
+				case GL_UNSIGNED_SHORT_4_4_4_4:
+					*(GLushort*)dstPx = (GLushort)(((srcPx[0] >> 4) << 12) | ((srcPx[1] >> 4) << 8) | ((srcPx[2] >> 4) << 4) | (srcPx[3] >> 4));
+					break;
+				case GL_UNSIGNED_SHORT_5_5_5_1:
+					*(GLushort*)dstPx = (GLushort)(((srcPx[0] >> 3) << 11) | ((srcPx[1] >> 3) << 6) | ((srcPx[2] >> 3) << 1) | (srcPx[3] >> 7));
+					break;
+				default:
+					for ( GLuint c = 0; c < compCnt; c++ )
+						dstPx[c] = srcPx[c];
+					break;
+			}
+		}
+	}
+}
+
+/** Reduces a band of rows of 8-bit pixels by averaging each 2x2 block of source pixels. */
+static void CC3STBImageReduceRows( void* bandPtr )
+{
+	CC3STBImageBand* band = (CC3STBImageBand*)bandPtr;
+	GLuint compCnt = band->componentCount;
+	GLint srcW = band->srcSize.width;
+	GLint srcH = band->srcSize.height;
+	GLint dstW = band->dstSize.width;
+
+	for ( GLint dstRow = band->startRow; dstRow < band->endRow; dstRow++ )
+	{
+		const GLubyte* srcRow0 = band->src + MIN( dstRow * 2, srcH - 1 ) * srcW * compCnt;
+		const GLubyte* srcRow1 = band->src + MIN( dstRow * 2 + 1, srcH - 1 ) * srcW * compCnt;
+		GLubyte* dstPx = band->dst + dstRow * dstW * compCnt;
+		for ( GLint dstCol = 0; dstCol < dstW; dstCol++ )
+		{
+			GLuint col0 = MIN( dstCol * 2, srcW - 1 ) * compCnt;
+			GLuint col1 = MIN( dstCol * 2 + 1, srcW - 1 ) * compCnt;
+			for ( GLuint c = 0; c < compCnt; c++ )
+				*dstPx++ = (GLubyte)((srcRow0[col0 + c] + srcRow0[col1 + c] + srcRow1[col0 + c] + srcRow1[col1 + c] + 2) >> 2);
+		}
+	}
+}
+
+static void* CC3STBImageBandMain( void* bandPtr )
+{
+	CC3STBImageBand* band = (CC3STBImageBand*)bandPtr;
+	band->processRows( band );
+	return NULL;
+}
+
+/**
+ * Processes the rows of the destination image of the specified band template. If the image is
+ * large, the rows are split into bands that are processed concurrently on separate threads.
+ */
+static void CC3STBImageProcessRows( const CC3STBImageBand& bandTemplate, GLuint bytesPerRow )
+{
+	GLint rowCnt = bandTemplate.dstSize.height;
+	GLuint bandCnt = MIN( MIN( CC3STBImageProcessorCount(), (GLuint)kCC3STBImageMaxBandCount ), (GLuint)rowCnt );
+	if ( (unsigned long)bytesPerRow * rowCnt < kCC3STBImageParallelByteThreshold || bandCnt < 2 )
+	{
+		CC3STBImageBand band = bandTemplate;
+		band.startRow = 0;
+		band.endRow = rowCnt;
+		band.processRows( &band );
+		return;
+	}
+
+	CC3STBImageBand bands[kCC3STBImageMaxBandCount];
+	pthread_t threads[kCC3STBImageMaxBandCount];
+	bool isThreaded[kCC3STBImageMaxBandCount];
+	for ( GLuint i = 0; i < bandCnt; i++ )
+	{
+		bands[i] = bandTemplate;
+		bands[i].startRow = rowCnt * i / bandCnt;
+		bands[i].endRow = rowCnt * (i + 1) / bandCnt;
+	}
+
+	// Run the first band on this thread. If a thread cannot be started, run its band here too.
+	for ( GLuint i = 1; i < bandCnt; i++ )
+		isThreaded[i] = (pthread_create( &threads[i], NULL, CC3STBImageBandMain, &bands[i] ) == 0);
+	bands[0].processRows( &bands[0] );
+	for ( GLuint i = 1; i < bandCnt; i++ )
+	{
+		if ( isThreaded[i] )
+			pthread_join( threads[i], NULL );
+		else
+			bands[i].processRows( &bands[i] );
+	}
+}
+
+bool CC3STBImage::loadFromFile( const char* filePath, const CC3STBImageLoadOptions& options )
 {
 	deleteImageData();		// Delete any existing image data first.
 	
@@ -87,24 +289,132 @@ bool CC3STBImage::loadFromFile( const char* filePath )
 	// directory or the Cocos3D bundle resource directory.
 	std::string absFilePath = CCFileUtils::sharedFileUtils()->fullPathForFilename( filePath );
 
-	m_imageData = stbi_load(absFilePath.c_str(),
-						   (int*)&m_size.width,
-						   (int*)&m_size.height,
-						   (int*)&m_componentCount, 0);
-	if (!m_imageData) 
+	unsigned long fileSize = 0;
+	GLubyte* fileData = CCFileUtils::sharedFileUtils()->getFileData( absFilePath.c_str(), "rb", &fileSize );
+	GLubyte* decodedData = NULL;
+	if ( fileData )
+	{
+		decodedData = stbi_load_from_memory(fileData, (int)fileSize,
+											(int*)&m_size.width,
+											(int*)&m_size.height,
+											(int*)&m_componentCount, 0);
+		delete[] fileData;
+	}
+	if (!decodedData) 
 	{
 		CCLOGERROR("Could not load image file %s using STBI library", absFilePath.c_str() );
 		return false;
 	}
 
+	m_pixelType = CC3STBImageEffectivePixelType( options.pixelType, m_componentCount );
+	m_isFlippedVertically = options.shouldFlipVertically;
+	m_isFlippedHorizontally = options.shouldFlipHorizontally;
+	m_mipmapLevelCount = 1;
+
+	// Only POT images can be mipmapped
+	bool shouldGenerateMipmaps = options.shouldGenerateMipmaps && 
+								 m_size.width == (GLint)CCNextPOT( m_size.width ) &&
+								 m_size.height == (GLint)CCNextPOT( m_size.height );
+	if ( shouldGenerateMipmaps )
+	{
+		GLint maxSide = MAX( m_size.width, m_size.height );
+		while ( (1 << m_mipmapLevelCount) <= maxSide )
+			m_mipmapLevelCount++;
+	}
+
+	// If the decoded pixels are already laid out as required, use them directly
+	if ( m_pixelType == GL_UNSIGNED_BYTE && !m_isFlippedVertically && !m_isFlippedHorizontally && m_mipmapLevelCount == 1 )
+	{
+		m_imageData = decodedData;
+		return true;
+	}
+
+	// Allocate the output for all mipmap levels. Use malloc, so that stbi_image_free can be used for either buffer.
+	GLuint bpp = getBytesPerPixel();
+	unsigned long outputSize = 0;
+	for ( GLuint level = 0; level < m_mipmapLevelCount; level++ )
+		outputSize += (unsigned long)MAX( m_size.width >> level, 1 ) * MAX( m_size.height >> level, 1 ) * bpp;
+	m_imageData = (GLubyte*)malloc( outputSize );
+	if ( !m_imageData )
+	{
+		CCLOGERROR("Could not allocate %lu bytes to lay out image file %s", outputSize, absFilePath.c_str() );
+		stbi_image_free( decodedData );
+		return false;
+	}
+
+	// Lay out each level from an 8-bit version of that level in decoded orientation,
+	// which is also used to reduce the next level.
+	const GLubyte* levelSrc = decodedData;
+	GLubyte* reducedData = NULL;
+	GLubyte* dst = m_imageData;
+	CC3IntSize levelSize = m_size;
+	for ( GLuint level = 0; level < m_mipmapLevelCount; level++ )
+	{
+		CC3STBImageBand band;
+		band.src = levelSrc;
+		band.dst = dst;
+		band.srcSize = levelSize;
+		band.dstSize = levelSize;
+		band.componentCount = m_componentCount;
+		band.pixelType = m_pixelType;
+		band.shouldFlipVertically = m_isFlippedVertically;
+		band.shouldFlipHorizontally = m_isFlippedHorizontally;
+		band.processRows = CC3STBImageLayoutRows;
+		CC3STBImageProcessRows( band, levelSize.width * m_componentCount );
+		dst += levelSize.width * levelSize.height * bpp;
+
+		if ( level + 1 < m_mipmapLevelCount )
+		{
+			CC3IntSize nextSize = CC3IntSizeMake( MAX( levelSize.width >> 1, 1 ), MAX( levelSize.height >> 1, 1 ) );
+			GLubyte* nextData = (GLubyte*)malloc( nextSize.width * nextSize.height * m_componentCount );
+			if ( !nextData )
+			{
+				CCLOGERROR("Could not allocate the mipmaps of image file %s", absFilePath.c_str() );
+				free( reducedData );
+				stbi_image_free( decodedData );
+				deleteImageData();
+				m_mipmapLevelCount = 1;
+				return false;
+			}
+			band.dst = nextData;
+			band.dstSize = nextSize;
+			band.processRows = CC3STBImageReduceRows;
+			CC3STBImageProcessRows( band, levelSize.width * m_componentCount * 2 );
+
+			free( reducedData );
+			reducedData = nextData;
+			levelSrc = nextData;
+			levelSize = nextSize;
+		}
+	}
+
+	free( reducedData );
+	stbi_image_free( decodedData );
 	return true;
 }
 
+void CC3STBImage::takeImageFrom( CC3STBImage* anImage )
+{
+	deleteImageData();
+	m_imageData = anImage->extractImageData();
+	m_size = anImage->m_size;
+	m_componentCount = anImage->m_componentCount;
+	m_pixelType = anImage->m_pixelType;
+	m_mipmapLevelCount = anImage->m_mipmapLevelCount;
+	m_isFlippedVertically = anImage->m_isFlippedVertically;
+	m_isFlippedHorizontally = anImage->m_isFlippedHorizontally;
+	anImage->init();
+}
+
 void CC3STBImage::init()
 {
 	m_imageData = NULL;
 	m_size = kCC3IntSizeZero;
 	m_componentCount = 0;
+	m_pixelType = GL_UNSIGNED_BYTE;
+	m_mipmapLevelCount = 1;
+	m_isFlippedVertically = false;
+	m_isFlippedHorizontally = false;
 }
 
 bool CC3STBImage::initFromFile( const char* aFilePath )
@@ -114,6 +424,14 @@ bool CC3STBImage::initFromFile( const char* aFilePath )
 	return loadFromFile( aFilePath );
 }
 
+bool CC3STBImage::initFromFile( const char* aFilePath, const CC3STBImageLoadOptions& options )
+{
+	deleteImageData();
+	init();
+
+	return loadFromFile( aFilePath, options );
+}
+
 CC3STBImage* CC3STBImage::imageFromFile( const char* filePath )
 {
 	CC3STBImage* image = new CC3STBImage;
@@ -166,4 +484,312 @@ void CC3STBImage::purgeExtensions()
 	CC_SAFE_RELEASE( _useForFileExtensions );
 }
 
+static bool _shouldGenerateMipmapsOnCPU = false;
+
+bool CC3STBImage::shouldGenerateMipmapsOnCPU()
+{
+	return _shouldGenerateMipmapsOnCPU;
+}
+
+void CC3STBImage::setShouldGenerateMipmapsOnCPU( bool shouldGenerate )
+{
+	_shouldGenerateMipmapsOnCPU = shouldGenerate;
+}
+
+static GLenum _defaultPixelType = GL_UNSIGNED_BYTE;
+
+GLenum CC3STBImage::defaultPixelType()
+{
+	return _defaultPixelType;
+}
+
+void CC3STBImage::setDefaultPixelType( GLenum pixelType )
+{
+	_defaultPixelType = pixelType;
+}
+
+#pragma mark -
+#pragma mark CC3STBImageDecoder
+
+#define kCC3STBImageMaxWorkerCount		4
+#define kCC3STBImageMaxUnclaimedImages	32
+
+CC3STBImageDecoder::CC3STBImageDecoder()
+{
+	m_workerCount = MAX( MIN( CC3STBImageProcessorCount() - 1, (GLuint)kCC3STBImageMaxWorkerCount ), 1u );
+	m_nextSequence = 0;
+	m_shouldStopWorkers = false;
+}
+
+CC3STBImageDecoder::~CC3STBImageDecoder()
+{
+	CCNotificationCenter::sharedNotificationCenter()->removeObserver( this, EVENT_PURGE_CACHED_DATA );
+
+	pthread_mutex_lock( &m_mutex );
+	m_shouldStopWorkers = true;
+	pthread_cond_broadcast( &m_queueCondition );
+	pthread_mutex_unlock( &m_mutex );
+
+	for ( std::vector<pthread_t>::iterator it = m_workers.begin(); it != m_workers.end(); ++it )
+		pthread_join( *it, NULL );
+
+	for ( std::map<std::string, CC3STBImageDecodeRequest*>::iterator it = m_requestsByPath.begin(); it != m_requestsByPath.end(); ++it )
+	{
+		CC_SAFE_RELEASE( it->second->image );
+		delete it->second;
+	}
+
+	pthread_cond_destroy( &m_doneCondition );
+	pthread_cond_destroy( &m_queueCondition );
+	pthread_mutex_destroy( &m_mutex );
+}
+
+void CC3STBImageDecoder::init()
+{
+	pthread_mutex_init( &m_mutex, NULL );
+	pthread_cond_init( &m_queueCondition, NULL );
+	pthread_cond_init( &m_doneCondition, NULL );
+
+	CCNotificationCenter::sharedNotificationCenter()->addObserver( this,
+																   callfuncO_selector(CC3STBImageDecoder::listenToPurgeCachedData),
+																   EVENT_PURGE_CACHED_DATA,
+																   NULL );
+}
+
+static CC3STBImageDecoder* _sharedDecoder = NULL;
+
+CC3STBImageDecoder* CC3STBImageDecoder::sharedDecoder()
+{
+	if ( !_sharedDecoder )
+	{
+		_sharedDecoder = new CC3STBImageDecoder;		// retained
+		_sharedDecoder->init();
+	}
+
+	return _sharedDecoder;
+}
+
+GLuint CC3STBImageDecoder::getWorkerCount()
+{
+	return m_workerCount;
+}
+
+void CC3STBImageDecoder::setWorkerCount( GLuint workerCount )
+{
+	m_workerCount = MAX( workerCount, 1u );
+}
+
+/** Returns whether two sets of load options produce the same image data. */
+static bool CC3STBImageLoadOptionsAreEqual( const CC3STBImageLoadOptions& opt1, const CC3STBImageLoadOptions& opt2 )
+{
+	return (opt1.shouldFlipVertically == opt2.shouldFlipVertically &&
+			opt1.shouldFlipHorizontally == opt2.shouldFlipHorizontally &&
+			opt1.shouldGenerateMipmaps == opt2.shouldGenerateMipmaps &&
+			opt1.pixelType == opt2.pixelType);
+}
+
+bool CC3STBImageDecoder::isPrefetching( const std::string& filePath )
+{
+	std::string absFilePath = CCFileUtils::sharedFileUtils()->fullPathForFilename( filePath.c_str() );
+
+	pthread_mutex_lock( &m_mutex );
+	bool isPending = (m_requestsByPath.find( absFilePath ) != m_requestsByPath.end());
+	pthread_mutex_unlock( &m_mutex );
+	return isPending;
+}
+
+void CC3STBImageDecoder::prefetchFile( const std::string& filePath, const CC3STBImageLoadOptions& options )
+{
+	// The path is resolved here, since the path cache of CCFileUtils is not thread-safe, and an
+	// absolute path is used as is. The image is created here, so that no CCObjects are created
+	// on the worker threads.
+	std::string absFilePath = CCFileUtils::sharedFileUtils()->fullPathForFilename( filePath.c_str() );
+	CC3STBImageDecodeRequest* request = new CC3STBImageDecodeRequest;
+	request->filePath = absFilePath;
+	request->options = options;
+	request->image = new CC3STBImage;
+	request->wasLoaded = false;
+	request->isStarted = false;
+	request->isDone = false;
+	request->isAbandoned = false;
+
+	pthread_mutex_lock( &m_mutex );
+	if ( m_requestsByPath.find( absFilePath ) != m_requestsByPath.end() )
+	{
+		pthread_mutex_unlock( &m_mutex );
+		request->image->release();
+		delete request;
+		return;
+	}
+
+	ensureWorkers();
+	request->sequence = m_nextSequence++;
+	m_requestsByPath[absFilePath] = request;
+	m_queue.push_back( request );
+	evictUnclaimedImages( kCC3STBImageMaxUnclaimedImages );
+	pthread_cond_signal( &m_queueCondition );
+	pthread_mutex_unlock( &m_mutex );
+}
+
+/** Must be invoked while the mutex is locked. Discards the oldest decoded images beyond the specified count. */
+void CC3STBImageDecoder::evictUnclaimedImages( unsigned int maxCount )
+{
+	while ( true )
+	{
+		unsigned int doneCount = 0;
+		std::map<std::string, CC3STBImageDecodeRequest*>::iterator oldest = m_requestsByPath.end();
+		for ( std::map<std::string, CC3STBImageDecodeRequest*>::iterator it = m_requestsByPath.begin(); it != m_requestsByPath.end(); ++it )
+		{
+			if ( !it->second->isDone )
+				continue;
+
+			doneCount++;
+			if ( oldest == m_requestsByPath.end() || it->second->sequence < oldest->second->sequence )
+				oldest = it;
+		}
+		if ( doneCount <= maxCount )
+			return;
+
+		oldest->second->image->release();
+		delete oldest->second;
+		m_requestsByPath.erase( oldest );
+	}
+}
+
+void CC3STBImageDecoder::purgeUnclaimedImages()
+{
+	pthread_mutex_lock( &m_mutex );
+	for ( std::map<std::string, CC3STBImageDecodeRequest*>::iterator it = m_requestsByPath.begin(); it != m_requestsByPath.end(); ++it )
+	{
+		CC3STBImageDecodeRequest* request = it->second;
+		if ( !request->isStarted )
+		{
+			m_queue.erase( std::find( m_queue.begin(), m_queue.end(), request ) );
+			request->isDone = true;
+		}
+
+		// A request being decoded is discarded by its worker
+		if ( request->isDone )
+		{
+			request->image->release();
+			delete request;
+		}
+		else
+		{
+			request->isAbandoned = true;
+		}
+	}
+	m_requestsByPath.clear();
+	pthread_mutex_unlock( &m_mutex );
+}
+
+void CC3STBImageDecoder::listenToPurgeCachedData( CCObject* obj )
+{
+	purgeUnclaimedImages();
+}
+
+bool CC3STBImageDecoder::loadFile( const std::string& filePath, const CC3STBImageLoadOptions& options, CC3STBImage* image )
+{
+	std::string absFilePath = CCFileUtils::sharedFileUtils()->fullPathForFilename( filePath.c_str() );
+
+	pthread_mutex_lock( &m_mutex );
+
+	std::map<std::string, CC3STBImageDecodeRequest*>::iterator it = m_requestsByPath.find( absFilePath );
+	CC3STBImageDecodeRequest* request = (it != m_requestsByPath.end()) ? it->second : NULL;
+	if ( request )
+	{
+		m_requestsByPath.erase( it );
+
+		// If the request has not started, or will not produce the image we need, take it
+		// off the queue, or leave it for its worker to discard, and decode on this thread.
+		bool isUsable = CC3STBImageLoadOptionsAreEqual( request->options, options );
+		if ( !request->isStarted || !isUsable )
+		{
+			if ( !request->isStarted )
+			{
+				m_queue.erase( std::find( m_queue.begin(), m_queue.end(), request ) );
+				request->isDone = true;
+			}
+
+			if ( request->isDone )
+			{
+				request->image->release();
+				delete request;
+			}
+			else
+			{
+				request->isAbandoned = true;
+			}
+			request = NULL;
+		}
+		else
+		{
+			while ( !request->isDone )
+				pthread_cond_wait( &m_doneCondition, &m_mutex );
+		}
+	}
+
+	pthread_mutex_unlock( &m_mutex );
+
+	if ( !request )
+		return image->initFromFile( absFilePath.c_str(), options );
+
+	bool wasLoaded = request->wasLoaded;
+	image->takeImageFrom( request->image );
+	request->image->release();
+	delete request;
+	return wasLoaded;
+}
+
+/** Must be invoked while the mutex is locked. */
+void CC3STBImageDecoder::ensureWorkers()
+{
+	m_shouldStopWorkers = false;
+	while ( m_workers.size() < m_workerCount )
+	{
+		pthread_t worker;
+		if ( pthread_create( &worker, NULL, workerMain, this ) != 0 )
+		{
+			CCLOGERROR( "CC3STBImageDecoder could not start a worker thread" );
+			break;
+		}
+		m_workers.push_back( worker );
+	}
+}
+
+void* CC3STBImageDecoder::workerMain( void* decoder )
+{
+	CC3STBImageDecoder* dcdr = (CC3STBImageDecoder*)decoder;
+
+	pthread_mutex_lock( &dcdr->m_mutex );
+	while ( true )
+	{
+		while ( dcdr->m_queue.empty() && !dcdr->m_shouldStopWorkers )
+			pthread_cond_wait( &dcdr->m_queueCondition, &dcdr->m_mutex );
+
+		if ( dcdr->m_shouldStopWorkers )
+			break;
+
+		CC3STBImageDecodeRequest* request = dcdr->m_queue.front();
+		dcdr->m_queue.pop_front();
+		request->isStarted = true;
+		pthread_mutex_unlock( &dcdr->m_mutex );
+
+		// The image is only accessed by this thread until the request is done
+		request->wasLoaded = request->image->initFromFile( request->filePath.c_str(), request->options );
+
+		pthread_mutex_lock( &dcdr->m_mutex );
+		request->isDone = true;
+		if ( request->isAbandoned )
+		{
+			request->image->release();
+			delete request;
+		}
+		pthread_cond_broadcast( &dcdr->m_doneCondition );
+	}
+	pthread_mutex_unlock( &dcdr->m_mutex );
+
+	return NULL;
+}
+
 NS_COCOS3D_END
@@ -29,9 +29,27 @@
  */
 #ifndef _CC3_STB_IMAGE_H_
 #define _CC3_STB_IMAGE_H_
+#include <pthread.h>
+#include <deque>
+#include <map>
 
 NS_COCOS3D_BEGIN
 
+/**
+ * Options that define how the pixels of an image file are laid out by CC3STBImage as they are
+ * decoded, so that the resulting image data can be uploaded to the GL engine without further
+ * processing. All options are applied in a single pass over the decoded pixels.
+ */
+typedef struct {
+	bool		shouldFlipVertically;		/**< Whether rows should be written in reverse order. */
+	bool		shouldFlipHorizontally;		/**< Whether the pixels in each row should be written in reverse order. */
+	bool		shouldGenerateMipmaps;		/**< Whether a mipmap chain should be generated on the CPU. */
+	GLenum		pixelType;					/**< The GL pixel type into which the pixels should be converted. */
+} CC3STBImageLoadOptions;
+
+/** Returns load options that write the pixels exactly as they are decoded. */
+CC3STBImageLoadOptions CC3STBImageLoadOptionsDefault();
+
 /**
  * CC3STBImage represents an image file loaded using the STBImage library.
  *
@@ -107,15 +125,64 @@ public:
 	 */
 	GLenum					getPixelFormat();
 
-	/** Returns the pixel data type. Always returns GL_UNSIGNED_BYTE.  */
+	/**
+	 * Returns the pixel data type.
+	 *
+	 * The returned value is GL_UNSIGNED_BYTE, unless a packed pixel type was requested in the
+	 * options used to load the file, and the image contains components that can be packed into
+	 * that type. The returned value may be one of the following:
+	 *   - GL_UNSIGNED_BYTE
+	 *   - GL_UNSIGNED_SHORT_5_6_5
+	 *   - GL_UNSIGNED_SHORT_4_4_4_4
+	 *   - GL_UNSIGNED_SHORT_5_5_5_1
+	 */
 	GLenum					getPixelType();
 
+	/** Returns the number of bytes in each pixel of the image data. */
+	GLuint					getBytesPerPixel();
+
+	/**
+	 * Returns the number of mipmap levels contained in the image data. The image data of each
+	 * level immediately follows that of the previous level, without any padding between rows.
+	 *
+	 * The returned value is one, unless the shouldGenerateMipmaps load option was set.
+	 */
+	GLuint					getMipmapLevelCount();
+
+	/** Returns whether the rows of the image data have been flipped to GL orientation during loading. */
+	bool					isFlippedVertically();
+
+	/** Returns whether the pixels in each row of the image data have been flipped during loading. */
+	bool					isFlippedHorizontally();
+
 	/** Loads the specified file, and returns whether the file was successfully loaded. */
 	bool					loadFromFile( const char* aFilePath );
 
+	/**
+	 * Loads the specified file, laying out the pixels as defined by the specified options,
+	 * and returns whether the file was successfully loaded.
+	 *
+	 * This method does not use the GL engine or any autoreleased objects, and can be invoked
+	 * on a background thread. Large images are oriented, converted and reduced to mipmap
+	 * levels using several threads, in bands of rows.
+	 */
+	bool					loadFromFile( const char* aFilePath, const CC3STBImageLoadOptions& options );
+
 	/** Initializes this instance by loading the image file at the specified file path. */
 	bool					initFromFile( const char* aFilePath );
 
+	/** 
+	 * Initializes this instance by loading the image file at the specified file path,
+	 * laying out the pixels as defined by the specified options.
+	 */
+	bool					initFromFile( const char* aFilePath, const CC3STBImageLoadOptions& options );
+
+	/** 
+	 * Takes ownership of the image data of the specified image, along with its size and layout.
+	 * The specified image is left empty.
+	 */
+	void					takeImageFrom( CC3STBImage* anImage );
+
 	/** Allocates and initializes an instance by loading the image file at the specified file path. */
 	static CC3STBImage*		imageFromFile( const char* aFilePath );
 
@@ -158,6 +225,27 @@ public:
 	static bool				shouldUseForFileExtension( const std::string& fileExtension );
 	static void				purgeExtensions();
 
+	/**
+	 * Indicates whether textures loaded with this class should have their mipmaps generated on
+	 * the CPU, in the background, as the image file is decoded, instead of by the GL engine.
+	 *
+	 * Set this property to YES on platforms where the GL engine cannot generate mipmaps, or
+	 * does so slowly. Mipmaps are generated on the CPU only for POT images.
+	 *
+	 * The initial value of this property is NO.
+	 */
+	static bool				shouldGenerateMipmapsOnCPU();
+	static void				setShouldGenerateMipmapsOnCPU( bool shouldGenerate );
+
+	/**
+	 * The GL pixel type into which the pixels of textures loaded with this class are converted
+	 * as the image file is decoded. See the getPixelType method for the supported values.
+	 *
+	 * The initial value of this property is GL_UNSIGNED_BYTE, which performs no conversion.
+	 */
+	static GLenum			defaultPixelType();
+	static void				setDefaultPixelType( GLenum pixelType );
+
 protected:
 	void					deleteImageData();
 
@@ -165,6 +253,97 @@ protected:
 	GLubyte*				m_imageData;
 	CC3IntSize				m_size;
 	GLuint					m_componentCount;
+	GLenum					m_pixelType;
+	GLuint					m_mipmapLevelCount;
+	bool					m_isFlippedVertically : 1;
+	bool					m_isFlippedHorizontally : 1;
+};
+
+/** A request to decode an image file in the background. Used internally by CC3STBImageDecoder. */
+typedef struct {
+	std::string				filePath;		/**< The file to decode. */
+	CC3STBImageLoadOptions	options;		/**< The options used to decode the file. */
+	CC3STBImage*			image;			/**< The decoded image. Created on the requesting thread. */
+	bool					wasLoaded;		/**< Whether the file was successfully decoded. */
+	bool					isStarted;		/**< Whether a worker thread has started decoding the file. */
+	bool					isDone;			/**< Whether the file has finished decoding. */
+	bool					isAbandoned;	/**< Whether the result is no longer wanted. */
+	unsigned int			sequence;		/**< The order in which the file was prefetched. */
+} CC3STBImageDecodeRequest;
+
+/**
+ * CC3STBImageDecoder decodes image files on a pool of background worker threads.
+ *
+ * Files that are about to be loaded, such as all of the textures used by a resource, can be
+ * prefetched, so that they decode in parallel. When the texture is subsequently loaded from
+ * the file, the already-decoded image is used. If the file is still decoding, the loading
+ * thread waits for it to finish. If decoding has not started yet, the loading thread decodes
+ * the file itself, rather than waiting behind other files in the queue.
+ *
+ * Only one decode is ever in flight for each file path, so duplicate prefetch requests, or a
+ * prefetch of a texture that is already in the CC3Texture cache, cost nothing.
+ *
+ * Decoded images that are never loaded do not accumulate. Beyond a few dozen of them, the
+ * oldest are discarded, and they are all discarded when CCDirector purges its cached data.
+ */
+class CC3STBImageDecoder : public CCObject
+{
+public:
+	CC3STBImageDecoder();
+	virtual ~CC3STBImageDecoder();
+
+	/**
+	 * The number of background worker threads. Changes take effect when the worker threads are
+	 * next started. The initial value is one less than the number of CPU cores, to a maximum of four.
+	 */
+	GLuint					getWorkerCount();
+	void					setWorkerCount( GLuint workerCount );
+
+	/**
+	 * Starts decoding the specified file in the background, with the specified options,
+	 * if it is not already being decoded.
+	 *
+	 * The file path is resolved to an absolute path on the calling thread, as CCFileUtils
+	 * cannot be used on the worker threads.
+	 */
+	void					prefetchFile( const std::string& filePath, const CC3STBImageLoadOptions& options );
+
+	/**
+	 * Loads the specified file into the specified image, using the specified options.
+	 *
+	 * If the file has been prefetched with the same options, the prefetched image is used,
+	 * waiting for it to finish decoding if needed. Otherwise the file is decoded on the
+	 * calling thread. Returns whether the file was successfully loaded.
+	 */
+	bool					loadFile( const std::string& filePath, const CC3STBImageLoadOptions& options, CC3STBImage* image );
+
+	/** Returns whether a decode of the specified file is pending or complete, but not yet used. */
+	bool					isPrefetching( const std::string& filePath );
+
+	/** Discards the prefetched images that have not been loaded yet, and the pending prefetches. */
+	void					purgeUnclaimedImages();
+
+	void					init();
+
+	/** Returns the singleton decoder instance. */
+	static CC3STBImageDecoder*	sharedDecoder();
+
+protected:
+	void					ensureWorkers();
+	void					evictUnclaimedImages( unsigned int maxCount );
+	void					listenToPurgeCachedData( CCObject* obj );
+	static void*			workerMain( void* decoder );
+
+protected:
+	std::map<std::string, CC3STBImageDecodeRequest*>	m_requestsByPath;
+	std::deque<CC3STBImageDecodeRequest*>				m_queue;
+	std::vector<pthread_t>	m_workers;
+	pthread_mutex_t			m_mutex;
+	pthread_cond_t			m_queueCondition;
+	pthread_cond_t			m_doneCondition;
+	GLuint					m_workerCount;
+	unsigned int			m_nextSequence;
+	bool					m_shouldStopWorkers : 1;
 };
 
 NS_COCOS3D_END
@@ -46,11 +46,15 @@ CC3Texture::CC3Texture()
 {
 	m_textureID = 0;
 	m_ccTexture = NULL;
+	m_evictedByteCost = 0;
+	m_lastBoundFrame = 0;
+	m_residency = kCC3TextureResidencyResident;
 }
 
 CC3Texture::~CC3Texture()
 {
 	remove();
+	CC3TextureResidencyManager::sharedManager()->removeTexture( this );
 	deleteGLTexture();
 	CC_SAFE_RELEASE( m_ccTexture ); 
 }
@@ -94,18 +98,29 @@ void CC3Texture::removeAllTextures()
 	if ( _textureCache )
 		_textureCache->removeAllObjects();
 
-	CC_SAFE_RELEASE( _textureCache );
+	CC_SAFE_RELEASE_NULL( _textureCache );
 }
 
 bool CC3Texture::isPreloading()
 {
-	return _textureCache ? _textureCache->isWeak() : false;
+	return _textureCache ? !_textureCache->isWeak() : false;
 }
 
 void CC3Texture::setIsPreloading( bool bPreloading )
 {
 	ensureCache();
-	_textureCache->setIsWeak( !isPreloading() );
+	_textureCache->setIsWeak( !bPreloading );
+}
+
+unsigned long CC3Texture::getCacheCapacity()
+{
+	return _textureCache ? _textureCache->getCapacity() : 0;
+}
+
+void CC3Texture::setCacheCapacity( unsigned long capacity )
+{
+	ensureCache();
+	_textureCache->setCapacity( capacity );
 }
 
 /** Sets the GL debug label, if required. */
@@ -296,6 +311,21 @@ void CC3Texture::bindTextureContent( CC3CCTexture* texContent, GLenum target )
 	gl->bindTexture( getTextureID(), getTextureTarget(), tuIdx );
 	gl->loadTexureImage( texContent->getImageData(), target, 0, m_size, m_pixelFormat, m_pixelType, byteAlignment/*getByteAlignment()*/, tuIdx );
 
+	// Upload any mipmap levels generated on the CPU. Each level follows the previous one, without row padding.
+	GLuint levelCount = texContent->getMipmapLevelCount();
+	if ( levelCount > 1 )
+	{
+		const GLubyte* levelData = (const GLubyte*)texContent->getImageData();
+		CC3IntSize levelSize = m_size;
+		for ( GLuint level = 1; level < levelCount; level++ )
+		{
+			levelData += levelSize.width * levelSize.height * bitsPerPixel / 8;
+			levelSize = CC3IntSizeMake( MAX( levelSize.width >> 1, 1 ), MAX( levelSize.height >> 1, 1 ) );
+			gl->loadTexureImage( levelData, target, level, levelSize, m_pixelFormat, m_pixelType, 1, tuIdx );
+		}
+		m_hasMipmap = true;
+	}
+
 	bindTextureParametersAt( tuIdx, gl );
 
 	CHECK_GL_ERROR_DEBUG();
@@ -483,6 +513,8 @@ void CC3Texture::setDefaultTextureParameters( const ccTexParams& texParams )
 // This method uses no direct iVar references, to allow subclasses (incl CC3TextureUnitTexture) to override.
 void CC3Texture::drawWithVisitor( CC3NodeDrawingVisitor* visitor )
 {
+	CC3TextureResidencyManager::sharedManager()->textureWasBound( getTexture() );
+
 	CCAssert(getTextureID(), "%CC3Texture:: cannot be bound to the GL engine because it has not been loaded.");
 
 	CC3OpenGL* gl = visitor->getGL();
@@ -550,8 +582,15 @@ bool CC3Texture::loadTarget( GLenum target, const std::string& filePath )
 
 	//MarkRezActivityStart();
 
+	// STBI content is decoded upside-down, so flip it during decoding if it should be flipped
+	CC3STBImageLoadOptions options = CC3STBImageLoadOptionsDefault();
+	options.shouldFlipVertically = shouldFlipVerticallyOnLoad();
+	options.shouldFlipHorizontally = shouldFlipHorizontallyOnLoad();
+	options.shouldGenerateMipmaps = shouldGenerateMipmaps() && CC3STBImage::shouldGenerateMipmapsOnCPU();
+	options.pixelType = CC3STBImage::defaultPixelType();
+
 	CC3Texture2DContent* content = new CC3Texture2DContent;
-	if ( !content->initFromFile( filePath ) )
+	if ( !content->initFromFile( filePath, options ) )
 	{
 		content->release();
 		CC3_TRACE( "CC3Texture could not load texture from file %s", filePath.c_str() );
@@ -571,6 +610,9 @@ bool CC3Texture::loadFromFile( const std::string& filePath )
 	if (wasLoaded && shouldGenerateMipmaps()) 
 		generateMipmap();
 
+	if (wasLoaded)
+		m_filePath = filePath;
+
 	checkGLDebugLabel();
 
 	return wasLoaded;
@@ -578,7 +620,7 @@ bool CC3Texture::loadFromFile( const std::string& filePath )
 
 void CC3Texture::checkTextureOrientation( CC3CCTexture* texContent )
 {
-	bool flipHorz = shouldFlipHorizontallyOnLoad();
+	bool flipHorz = shouldFlipHorizontallyOnLoad() && !texContent->isFlippedHorizontally();
 	bool flipVert = !XOR(texContent->isUpsideDown(), shouldFlipVerticallyOnLoad());
 
 	if (flipHorz && flipVert)
@@ -591,6 +633,8 @@ void CC3Texture::checkTextureOrientation( CC3CCTexture* texContent )
 
 void CC3Texture::replacePixels( const CC3Viewport& rect, GLenum target, ccColor4B* colorArray )
 {
+	m_filePath.clear();		// Content no longer matches the file, so it cannot be evicted and reloaded
+
 	// If needed, convert the contents of the array to the format and type of this texture
 	convertContent( colorArray, (rect.w * rect.h) );
 
@@ -691,6 +735,7 @@ void CC3Texture::convertContent( ccColor4B* colorArray, GLuint pixCount )
 
 void CC3Texture::resizeTo( const CC3IntSize& size )
 {
+	m_filePath.clear();		// Content no longer matches the file, so it cannot be evicted and reloaded
 	m_size = size;
 	m_hasMipmap = false;
 }
@@ -740,6 +785,90 @@ void CC3Texture::setShouldCacheAssociatedCCTextures( bool shouldCache )
 }
 
 
+const std::string& CC3Texture::getFilePath()
+{
+	return m_filePath;
+}
+
+unsigned long CC3Texture::getByteCost()
+{
+	unsigned long byteCost = (unsigned long)m_size.width * m_size.height * CC3TexelSizeFromFormatAndType( m_pixelFormat, m_pixelType );
+	if ( hasMipmap() )
+		byteCost += byteCost / 3;		// The full mip chain adds one third
+	if ( isTextureCube() )
+		byteCost *= 6;
+	return byteCost;
+}
+
+unsigned long CC3Texture::getResidentByteCost()
+{
+	return (m_residency == kCC3TextureResidencyResident) ? getByteCost() : m_evictedByteCost;
+}
+
+unsigned long CC3Texture::getCacheCost()
+{
+	return getByteCost();
+}
+
+CC3TextureResidency CC3Texture::getResidency()
+{
+	return m_residency;
+}
+
+void CC3Texture::setResidency( CC3TextureResidency residency )
+{
+	m_residency = residency;
+}
+
+unsigned int CC3Texture::getLastBoundFrame()
+{
+	return m_lastBoundFrame;
+}
+
+void CC3Texture::setLastBoundFrame( unsigned int frame )
+{
+	m_lastBoundFrame = frame;
+}
+
+bool CC3Texture::isEvictable()
+{
+	return isTexture2D() && !m_filePath.empty() && (m_residency == kCC3TextureResidencyResident);
+}
+
+void CC3Texture::evictContent()
+{
+	static const ccColor4B placeholderTexel = { 128, 128, 128, 255 };
+	bindReducedContent( &placeholderTexel, CC3IntSizeMake( 1, 1 ), GL_RGBA, GL_UNSIGNED_BYTE );
+	m_residency = kCC3TextureResidencyEvicted;
+}
+
+void CC3Texture::bindReducedContent( const GLvoid* data, const CC3IntSize& size, GLenum format, GLenum type )
+{
+	CC3OpenGL* gl = CC3OpenGL::sharedGL();
+	GLuint tuIdx = 0;		// Choose the texture unit in which to work
+	GLuint texelSize = CC3TexelSizeFromFormatAndType( format, type );
+	GLuint byteAlignment = ((size.width * texelSize) % 4 == 0) ? 4 : 1;
+
+	gl->bindTexture( getTextureID(), getTextureTarget(), tuIdx );
+	gl->loadTexureImage( data, getInitialAttachmentFace(), 0, size, format, type, byteAlignment, tuIdx );
+
+	m_evictedByteCost = (unsigned long)size.width * size.height * texelSize;
+	m_hasMipmap = false;
+	markTextureParametersDirty();
+}
+
+void CC3Texture::bindReloadedContent( CC3CCTexture* texContent )
+{
+	m_hasMipmap = false;
+	bindTextureContent( texContent, getInitialAttachmentFace() );
+	if ( shouldGenerateMipmaps() )
+		generateMipmap();
+	markTextureParametersDirty();
+
+	m_evictedByteCost = 0;
+	m_residency = kCC3TextureResidencyResident;
+}
+
 void CC3Texture::initWithTag( GLuint aTag, const std::string& aName )
 {
 	super::initWithTag( aTag, aName );
@@ -755,6 +884,10 @@ void CC3Texture::initWithTag( GLuint aTag, const std::string& aName )
 	m_isUpsideDown = false;
 	m_shouldFlipVerticallyOnLoad = defaultShouldFlipVerticallyOnLoad();
 	m_shouldFlipHorizontallyOnLoad = defaultShouldFlipHorizontallyOnLoad();
+	m_filePath.clear();
+	m_evictedByteCost = 0;
+	m_lastBoundFrame = 0;
+	m_residency = kCC3TextureResidencyResident;
 	setTextureParameters( defaultTextureParameters() );	// Marks params dirty
 }
 
@@ -834,7 +967,11 @@ CC3Texture* CC3Texture::textureFromFile( const char* filePath )
 	if ( tex )
 		return tex;
 
-	tex = new CC3Texture2D;
+	if ( CC3KTXTextureContent::isKTXFile( filePath ) )
+		tex = new CC3KTXTexture;
+	else
+		tex = new CC3Texture2D;
+
 	if ( tex->initFromFile( filePath ) )
 	{
 		tex->autorelease();
@@ -848,6 +985,24 @@ CC3Texture* CC3Texture::textureFromFile( const char* filePath )
 	return tex;
 }
 
+void CC3Texture::prefetchTextureFromFile( const char* filePath )
+{
+	if ( getTextureNamed( textureNameFromFilePath( filePath ) ) )
+		return;
+
+	if ( !CC3STBImage::shouldUseForFileExtension( CC3String::getExtension( filePath ) ) )
+		return;
+
+	// Must match the options used by loadTarget() for a texture created by textureFromFile()
+	CC3STBImageLoadOptions options = CC3STBImageLoadOptionsDefault();
+	options.shouldFlipVertically = defaultShouldFlipVerticallyOnLoad();
+	options.shouldFlipHorizontally = defaultShouldFlipHorizontallyOnLoad();
+	options.shouldGenerateMipmaps = shouldGenerateMipmaps() && CC3STBImage::shouldGenerateMipmapsOnCPU();
+	options.pixelType = CC3STBImage::defaultPixelType();
+
+	CC3STBImageDecoder::sharedDecoder()->prefetchFile( filePath, options );
+}
+
 std::string CC3Texture::textureNameFromFilePath( const std::string& filePath )
 { 
 	return filePath;
@@ -863,6 +1018,7 @@ void CC3Texture::addTexture( CC3Texture* texture )
 {
 	ensureCache();
 	_textureCache->addObject( texture );
+	CC3TextureResidencyManager::sharedManager()->addTexture( texture );
 }
 
 void CC3Texture::removeTexture( CC3Texture* texture )
@@ -1031,6 +1187,8 @@ std::string CC3Texture::cachedTexturesDescription()
 CC3Texture2DContent::CC3Texture2DContent()
 {
 	m_imageData = NULL;
+	m_mipmapLevelCount = 1;
+	m_isFlippedHorizontally = false;
 }
 
 CC3Texture2DContent::~CC3Texture2DContent()
@@ -1088,35 +1246,54 @@ bool CC3Texture2DContent::isUpsideDown()
 }
 
 bool CC3Texture2DContent::initFromFile( const std::string& filePath)
+{
+	return initFromFile( filePath, CC3STBImageLoadOptionsDefault() );
+}
+
+bool CC3Texture2DContent::initFromFile( const std::string& filePath, const CC3STBImageLoadOptions& options )
 {
 	if ( CC3STBImage::shouldUseForFileExtension( CC3String::getExtension(filePath) ) )
-		return initFromSTBIFile( filePath );
+		return initFromSTBIFile( filePath, options );
 	else
 		return initFromOSFile( filePath );
 }
 
-bool CC3Texture2DContent::initFromSTBIFile( const std::string& filePath )
+bool CC3Texture2DContent::isFlippedHorizontally()
+{
+	return m_isFlippedHorizontally;
+}
+
+GLuint CC3Texture2DContent::getMipmapLevelCount()
+{
+	return m_mipmapLevelCount;
+}
+
+bool CC3Texture2DContent::initFromSTBIFile( const std::string& filePath, const CC3STBImageLoadOptions& options )
 {
 	if( super::init() ) 
 	{
-		CC3STBImage* stbImage = CC3STBImage::imageFromFile( filePath.c_str() );
-		if (!stbImage) 
+		// Not autoreleased, so that content can also be loaded on a background thread.
+		// Uses any image already decoded by a prefetch of the same file.
+		CC3STBImage stbImage;
+		if ( !CC3STBImageDecoder::sharedDecoder()->loadFile( filePath, options, &stbImage ) ) 
 			return false;
 
-		m_imageData = stbImage->extractImageData();
+		m_imageData = stbImage.extractImageData();
 
-		m_tContentSize = CGSizeFromCC3IntSize(stbImage->getSize());
-		m_uPixelsWide = stbImage->getSize().width;
-		m_uPixelsHigh = stbImage->getSize().height;
+		m_tContentSize = CGSizeFromCC3IntSize(stbImage.getSize());
+		m_uPixelsWide = stbImage.getSize().width;
+		m_uPixelsHigh = stbImage.getSize().height;
 		m_fMaxS = 1.0f;
 		m_fMaxT = 1.0f;
 		m_bHasPremultipliedAlpha = false;
 		//CC2_TEX_ANTIALIASED = YES;
 		//CC2_TEX_CONTENT_SCALE = 1.0;
 
-		m_isUpsideDown = true;			// Loaded upside-down
-		m_pixelGLFormat = stbImage->getPixelFormat();
-		m_pixelGLType = stbImage->getPixelType();
+		m_isUpsideDown = !stbImage.isFlippedVertically();		// Decoded upside-down, unless flipped
+		m_isFlippedHorizontally = stbImage.isFlippedHorizontally();
+		m_mipmapLevelCount = stbImage.getMipmapLevelCount();
+		m_pixelGLFormat = stbImage.getPixelFormat();
+		m_pixelGLType = stbImage.getPixelType();
 		updatePixelFormat();
 
 		return true;
@@ -2321,6 +2498,16 @@ void CC3CCTexture::flipVertically()
 
 }
 
+bool CC3CCTexture::isFlippedHorizontally()
+{
+	return false;
+}
+
+GLuint CC3CCTexture::getMipmapLevelCount()
+{
+	return 1;
+}
+
 void CC3CCTexture::rotateHalfCircle()
 {
 
@@ -2509,7 +2696,19 @@ bool CC3TextureCube::loadFromFile( const std::string& filePath )
 
 bool CC3TextureCube::loadCubeFace( GLenum faceTarget, const std::string& filePath )
 {
-	return loadTarget( faceTarget, filePath );
+	bool wasLoaded = loadTarget( faceTarget, filePath );
+
+	GLuint faceIdx = faceTarget - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+	if (faceIdx < 6) 
+		m_cubeFaceFilePaths[faceIdx] = wasLoaded ? filePath : "";
+
+	return wasLoaded;
+}
+
+std::string CC3TextureCube::getCubeFaceFilePath( GLenum faceTarget )
+{
+	GLuint faceIdx = faceTarget - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+	return (faceIdx < 6) ? m_cubeFaceFilePaths[faceIdx] : "";
 }
 
 bool CC3TextureCube::loadFromFiles( const std::string& posXFilePath, const std::string& negXFilePath, 
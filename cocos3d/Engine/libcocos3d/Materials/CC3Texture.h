@@ -87,6 +87,14 @@ NS_COCOS3D_BEGIN
  */
 
 class CC3CCTexture;
+
+/** Enumeration of the residency states of the GL content of a texture. */
+typedef enum {
+	kCC3TextureResidencyResident,		/**< The full content of the texture is loaded in the GL engine. */
+	kCC3TextureResidencyEvicted,		/**< The content has been replaced by a placeholder or a reduced mip. */
+	kCC3TextureResidencyLoading,		/**< The full content is being reloaded from the file. */
+} CC3TextureResidency;
+
 class CC3Texture : public CC3Identifiable 
 {
 	DECLARE_SUPER( CC3Identifiable ); 
@@ -716,6 +724,16 @@ public:
 	 */
 	static CC3Texture*		textureFromFile( const char* filePath );
 
+	/**
+	 * Starts decoding the specified file on a background thread, so that a subsequent invocation
+	 * of textureFromFile: for the same file can use the decoded image, instead of decoding it then.
+	 *
+	 * Prefetching several files before loading them allows them to be decoded in parallel.
+	 * This method does nothing if a texture from the file is already in the cache, if the file
+	 * is already being prefetched, or if the file is not of a type loaded by CC3STBImage.
+	 */
+	static void				prefetchTextureFromFile( const char* filePath );
+
 	/**
 	 * Initializes this instance from the specified texture properties, without providing content.
 	 *
@@ -1256,6 +1274,14 @@ public:
 	 */
 	static void				setIsPreloading( bool bPreloading );
 
+	/**
+	 * The total byteCost of strongly cached textures above which the least-recently looked up
+	 * textures are demoted to weak entries, and are deallocated once nothing else retains them.
+	 * A value of zero disables this policy. The initial value of this property is zero.
+	 */
+	static unsigned long	getCacheCapacity();
+	static void				setCacheCapacity( unsigned long capacity );
+
 	/**
 	 * Returns a description of the contents of this cache, with each entry formatted as a
 	 * source-code line for loading the texture from a file.
@@ -1295,6 +1321,61 @@ public:
 	 */
 	virtual void			cacheCCTexture2D();
 
+	/**
+	 * The path of the file from which the content of this texture was loaded, or an empty string
+	 * if this texture was not loaded from a single file, or its content has since been modified.
+	 *
+	 * Only textures with a file path can be evicted by the CC3TextureResidencyManager, since
+	 * their content can be reloaded from that file when needed again.
+	 */
+	virtual const std::string& getFilePath();
+
+	/** 
+	 * Returns the number of bytes of GL memory used by the full content of this texture,
+	 * including all faces of a cube-map and all mipmap levels.
+	 */
+	virtual unsigned long	getByteCost();
+
+	/**
+	 * Returns the number of bytes of GL memory currently used by this texture. This is the same as
+	 * the byteCost property while the texture is resident, and is smaller while it is evicted.
+	 */
+	virtual unsigned long	getResidentByteCost();
+
+	/** Returns the byteCost of this texture, which is charged against the capacity of the texture cache. */
+	virtual unsigned long	getCacheCost();
+
+	/** The residency state of the GL content of this texture. */
+	virtual CC3TextureResidency	getResidency();
+	virtual void			setResidency( CC3TextureResidency residency );
+
+	/** The CCDirector frame in which this texture was last bound to a texture unit for drawing. */
+	virtual unsigned int	getLastBoundFrame();
+	virtual void			setLastBoundFrame( unsigned int frame );
+
+	/** Returns whether the content of this texture is resident, and can be evicted and later reloaded. */
+	virtual bool			isEvictable();
+
+	/**
+	 * Replaces the GL content of this texture with a single-texel placeholder, and sets the residency
+	 * property to kCC3TextureResidencyEvicted. The size property is not changed, so that texture
+	 * coordinates remain valid while the texture is evicted.
+	 */
+	virtual void			evictContent();
+
+	/**
+	 * Binds reduced content to the GL texture of this evicted texture. The data must already be
+	 * oriented correctly, and have the specified size, format and type. The size property of
+	 * this texture is not changed, and the texture remains evicted.
+	 */
+	virtual void			bindReducedContent( const GLvoid* data, const CC3IntSize& size, GLenum format, GLenum type );
+
+	/**
+	 * Binds the specified content, reloaded from the file at the filePath property, to the GL texture,
+	 * regenerates the mipmap if needed, and sets the residency property to kCC3TextureResidencyResident.
+	 */
+	virtual void			bindReloadedContent( CC3CCTexture* texContent );
+
 protected:
 	virtual bool			loadTarget( GLenum target, const std::string& filePath );
 	virtual bool			loadFromFile( const std::string& filePath );
@@ -1312,6 +1393,10 @@ protected:
 	GLenum					m_horizontalWrappingFunction;
 	GLenum					m_verticalWrappingFunction;
 	CC3CCTexture*			m_ccTexture;
+	std::string				m_filePath;
+	unsigned long			m_evictedByteCost;
+	unsigned int			m_lastBoundFrame;
+	CC3TextureResidency		m_residency;
 	bool					m_texParametersAreDirty : 1;
 	bool					m_hasMipmap : 1;
 	bool					m_isUpsideDown : 1;
@@ -1630,6 +1715,19 @@ public:
 	bool					initCubeWithSideLength( GLuint sideLength, GLenum format, GLenum type );
 	bool					initCubeColoredForAxes();
 	std::string				constructorDescription();
+
+	/**
+	 * Returns the file path from which the specified cube face was most recently loaded, or an
+	 * empty string if that face was not loaded from a file. The faceTarget must be one of the
+	 * GL_TEXTURE_CUBE_MAP_POSITIVE_X through GL_TEXTURE_CUBE_MAP_NEGATIVE_Z values.
+	 *
+	 * This allows the content of the faces to be reloaded in application memory,
+	 * such as when a CC3LightProbe projects its texture into spherical harmonics.
+	 */
+	std::string				getCubeFaceFilePath( GLenum faceTarget );
+
+protected:
+	std::string				m_cubeFaceFilePaths[6];
 };
 
 /**
@@ -1851,6 +1949,12 @@ public:
 	/** Does nothing. For compatibility with CC3Texture2DContent. */
 	virtual void			flipVertically();
 
+	/** Returns NO. For compatibility with CC3Texture2DContent. */
+	virtual bool			isFlippedHorizontally();
+
+	/** Returns one. For compatibility with CC3Texture2DContent. */
+	virtual GLuint			getMipmapLevelCount();
+
 	/** Does nothing. For compatibility with CC3Texture2DContent. */
 	virtual void			flipHorizontally();
 
@@ -1953,6 +2057,24 @@ public:
 	 */
 	bool					initFromFile( const std::string& filePath );
 
+	/**
+	 * Initializes this instance with content loaded from the specified file.
+	 *
+	 * If the file is loaded by CC3STBImage, the pixels are flipped, converted and mipmapped
+	 * as defined by the specified options, as the file is decoded. Otherwise, the options
+	 * are ignored, and this method behaves the same as the initFromFile: method.
+	 */
+	bool					initFromFile( const std::string& filePath, const CC3STBImageLoadOptions& options );
+
+	/** Returns whether the content was flipped horizontally as it was loaded. */
+	bool					isFlippedHorizontally();
+
+	/**
+	 * Returns the number of mipmap levels in the image data. The data of each level immediately
+	 * follows that of the previous level. The value is one unless mipmaps were generated on load.
+	 */
+	GLuint					getMipmapLevelCount();
+
 	/** 
 	 * Initializes this instance to define the properties of a texture, without defining any
 	 * specific content.
@@ -1993,7 +2115,7 @@ public:
 	bool					isUpsideDown();
 
 protected:
-	bool					initFromSTBIFile( const std::string& filePath );
+	bool					initFromSTBIFile( const std::string& filePath, const CC3STBImageLoadOptions& options );
 	bool					initFromOSFile( const std::string& filePath );
 
 	bool					initWithData( const void* data, CCTexture2DPixelFormat pixelFormat, unsigned int pixelsWide, unsigned int pixelsHigh, const CCSize& contentSize );
@@ -2005,7 +2127,9 @@ protected:
 
 	GLenum					m_pixelGLFormat;
 	GLenum					m_pixelGLType;
+	GLuint					m_mipmapLevelCount;
 	bool					m_isUpsideDown : 1;
+	bool					m_isFlippedHorizontally : 1;
 };
 
 /** Extension category to support Cocos3D functionality. */
@@ -0,0 +1,438 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#include "cocos3d.h"
+
+NS_COCOS3D_BEGIN
+
+CC3TextureResidencyManager::CC3TextureResidencyManager()
+{
+	m_budget = 0;
+	m_lastUpdateFrame = 0;
+	m_evictedMipLevel = 0;
+	m_evictionCount = 0;
+	m_reloadCount = 0;
+	m_shouldLoadAsynchronously = true;
+	m_isLoadingThreadRunning = false;
+	m_shouldStopLoadingThread = false;
+}
+
+CC3TextureResidencyManager::~CC3TextureResidencyManager()
+{
+	if ( m_isLoadingThreadRunning )
+	{
+		pthread_mutex_lock( &m_requestMutex );
+		m_shouldStopLoadingThread = true;
+		pthread_cond_signal( &m_requestCondition );
+		pthread_mutex_unlock( &m_requestMutex );
+		pthread_join( m_loadingThread, NULL );
+	}
+
+	processCompletedRequests();
+
+	while ( !m_pendingRequests.empty() )
+	{
+		CC3TextureLoadRequest* request = m_pendingRequests.front();
+		m_pendingRequests.pop_front();
+		CC_SAFE_RELEASE( request->texture );
+		delete request;
+	}
+
+	pthread_cond_destroy( &m_requestCondition );
+	pthread_mutex_destroy( &m_requestMutex );
+}
+
+void CC3TextureResidencyManager::init()
+{
+	pthread_mutex_init( &m_requestMutex, NULL );
+	pthread_cond_init( &m_requestCondition, NULL );
+}
+
+static CC3TextureResidencyManager* _sharedManager = NULL;
+
+CC3TextureResidencyManager* CC3TextureResidencyManager::sharedManager()
+{
+	if ( !_sharedManager )
+	{
+		_sharedManager = new CC3TextureResidencyManager;		// retained
+		_sharedManager->init();
+	}
+
+	return _sharedManager;
+}
+
+unsigned long CC3TextureResidencyManager::getBudget()
+{
+	return m_budget;
+}
+
+void CC3TextureResidencyManager::setBudget( unsigned long budget )
+{
+	m_budget = budget;
+}
+
+GLuint CC3TextureResidencyManager::getEvictedMipLevel()
+{
+	return m_evictedMipLevel;
+}
+
+void CC3TextureResidencyManager::setEvictedMipLevel( GLuint mipLevel )
+{
+	m_evictedMipLevel = mipLevel;
+}
+
+bool CC3TextureResidencyManager::shouldLoadAsynchronously()
+{
+	return m_shouldLoadAsynchronously;
+}
+
+void CC3TextureResidencyManager::setShouldLoadAsynchronously( bool shouldLoadAsync )
+{
+	m_shouldLoadAsynchronously = shouldLoadAsync;
+}
+
+GLuint CC3TextureResidencyManager::getEvictionCount()
+{
+	return m_evictionCount;
+}
+
+GLuint CC3TextureResidencyManager::getReloadCount()
+{
+	return m_reloadCount;
+}
+
+unsigned long CC3TextureResidencyManager::getResidentBytes()
+{
+	unsigned long residentBytes = 0;
+	for ( std::vector<CC3Texture*>::iterator it = m_textures.begin(); it != m_textures.end(); ++it )
+		residentBytes += (*it)->getResidentByteCost();
+	return residentBytes;
+}
+
+unsigned int CC3TextureResidencyManager::getCurrentFrame()
+{
+	return CCDirector::sharedDirector()->getTotalFrames();
+}
+
+void CC3TextureResidencyManager::addTexture( CC3Texture* texture )
+{
+	if ( !texture || std::find( m_textures.begin(), m_textures.end(), texture ) != m_textures.end() )
+		return;
+
+	texture->setLastBoundFrame( getCurrentFrame() );
+	m_textures.push_back( texture );
+}
+
+/** 
+ * Requests retain their textures, so a texture cannot be deallocated while it is being loaded,
+ * and only needs to be removed from the list of tracked textures.
+ */
+void CC3TextureResidencyManager::removeTexture( CC3Texture* texture )
+{
+	std::vector<CC3Texture*>::iterator it = std::find( m_textures.begin(), m_textures.end(), texture );
+	if ( it != m_textures.end() )
+		m_textures.erase( it );
+}
+
+void CC3TextureResidencyManager::textureWasBound( CC3Texture* texture )
+{
+	if ( !texture )
+		return;
+
+	update();
+
+	texture->setLastBoundFrame( getCurrentFrame() );
+	if ( texture->getResidency() == kCC3TextureResidencyEvicted )
+		requestLoad( texture, 0 );
+}
+
+void CC3TextureResidencyManager::update()
+{
+	unsigned int currFrame = getCurrentFrame();
+	if ( currFrame == m_lastUpdateFrame )
+		return;
+	m_lastUpdateFrame = currFrame;
+
+	processCompletedRequests();
+	enforceBudget();
+}
+
+/** Sorts textures by the frame in which they were last bound, least-recently-bound first. */
+static bool CC3TextureWasBoundBefore( CC3Texture* tex1, CC3Texture* tex2 )
+{
+	return tex1->getLastBoundFrame() < tex2->getLastBoundFrame();
+}
+
+void CC3TextureResidencyManager::enforceBudget()
+{
+	if ( m_budget == 0 )
+		return;
+
+	unsigned long residentBytes = getResidentBytes();
+	if ( residentBytes <= m_budget )
+		return;
+
+	// Don't evict anything bound in the current or previous frame
+	unsigned int currFrame = getCurrentFrame();
+	std::vector<CC3Texture*> candidates;
+	for ( std::vector<CC3Texture*>::iterator it = m_textures.begin(); it != m_textures.end(); ++it )
+	{
+		CC3Texture* tex = *it;
+		if ( tex->isEvictable() && tex->getLastBoundFrame() + 1 < currFrame )
+			candidates.push_back( tex );
+	}
+	std::stable_sort( candidates.begin(), candidates.end(), CC3TextureWasBoundBefore );
+
+	for ( std::vector<CC3Texture*>::iterator it = candidates.begin(); it != candidates.end() && residentBytes > m_budget; ++it )
+	{
+		CC3Texture* tex = *it;
+		unsigned long byteCost = tex->getResidentByteCost();
+		evictTexture( tex );
+		residentBytes -= byteCost;
+		residentBytes += tex->getResidentByteCost();
+	}
+}
+
+void CC3TextureResidencyManager::evictTexture( CC3Texture* texture )
+{
+	if ( !texture || !texture->isEvictable() )
+		return;
+
+	CC3_TRACE( "Evicting texture %s from GL memory", texture->getName().c_str() );
+
+	texture->evictContent();
+	m_evictionCount++;
+
+	if ( m_evictedMipLevel > 0 )
+		requestLoad( texture, m_evictedMipLevel );
+}
+
+void CC3TextureResidencyManager::evictAllUnusedTextures()
+{
+	unsigned int currFrame = getCurrentFrame();
+	for ( std::vector<CC3Texture*>::iterator it = m_textures.begin(); it != m_textures.end(); ++it )
+	{
+		if ( (*it)->getLastBoundFrame() != currFrame )
+			evictTexture( *it );
+	}
+}
+
+void CC3TextureResidencyManager::requestLoad( CC3Texture* texture, GLuint reduceLevel )
+{
+	if ( reduceLevel == 0 )
+		texture->setResidency( kCC3TextureResidencyLoading );
+
+	CC3TextureLoadRequest* request = new CC3TextureLoadRequest;
+	request->texture = texture;
+	request->filePath = texture->getFilePath();
+	request->reduceLevel = reduceLevel;
+	request->shouldFlipVertically = texture->shouldFlipVerticallyOnLoad();
+	request->shouldFlipHorizontally = texture->shouldFlipHorizontallyOnLoad();
+	request->content = NULL;
+	request->reducedData = NULL;
+	request->reducedSize = CC3IntSizeMake( 0, 0 );
+	texture->retain();		// Released in completeLoadRequest() on this thread
+
+	if ( !m_shouldLoadAsynchronously )
+	{
+		processLoadRequest( request );
+		completeLoadRequest( request );
+		return;
+	}
+
+	ensureLoadingThread();
+
+	pthread_mutex_lock( &m_requestMutex );
+	m_pendingRequests.push_back( request );
+	pthread_cond_signal( &m_requestCondition );
+	pthread_mutex_unlock( &m_requestMutex );
+}
+
+/** 
+ * Reduces the specified unsigned-byte image by averaging each square block of reduceFactor texels,
+ * and orients the result, all in a single pass. Returns a new buffer, owned by the caller.
+ */
+static GLubyte* CC3ReduceImageData( const GLubyte* srcData, const CC3IntSize& srcSize, GLuint texelSize,
+								    GLuint reduceFactor, bool flipVert, bool flipHorz, CC3IntSize& dstSize )
+{
+	dstSize.width = MAX( srcSize.width / (GLint)reduceFactor, 1 );
+	dstSize.height = MAX( srcSize.height / (GLint)reduceFactor, 1 );
+	GLuint blockWidth = MIN( reduceFactor, (GLuint)srcSize.width );
+	GLuint blockHeight = MIN( reduceFactor, (GLuint)srcSize.height );
+	GLuint blockArea = blockWidth * blockHeight;
+	GLuint srcRowSize = srcSize.width * texelSize;
+
+	GLubyte* dstData = new GLubyte[dstSize.width * dstSize.height * texelSize];
+	GLuint accum[4];
+
+	for ( GLint dy = 0; dy < dstSize.height; dy++ )
+	{
+		GLint outRow = flipVert ? (dstSize.height - 1 - dy) : dy;
+		for ( GLint dx = 0; dx < dstSize.width; dx++ )
+		{
+			GLint outCol = flipHorz ? (dstSize.width - 1 - dx) : dx;
+
+			memset( accum, 0, sizeof(accum) );
+			for ( GLuint by = 0; by < blockHeight; by++ )
+			{
+				const GLubyte* srcTexel = srcData + (dy * blockHeight + by) * srcRowSize + dx * blockWidth * texelSize;
+				for ( GLuint bx = 0; bx < blockWidth; bx++ )
+					for ( GLuint c = 0; c < texelSize; c++ )
+						accum[c] += *srcTexel++;
+			}
+
+			GLubyte* dstTexel = dstData + (outRow * dstSize.width + outCol) * texelSize;
+			for ( GLuint c = 0; c < texelSize; c++ )
+				dstTexel[c] = (GLubyte)(accum[c] / blockArea);
+		}
+	}
+	return dstData;
+}
+
+/** Decodes the file of the request. Does not touch the GL engine, so can run on any thread. */
+void CC3TextureResidencyManager::processLoadRequest( CC3TextureLoadRequest* request )
+{
+	CC3Texture2DContent* content = new CC3Texture2DContent;
+	if ( !content->initFromFile( request->filePath ) )
+	{
+		content->release();
+		return;
+	}
+
+	if ( request->reduceLevel == 0 )
+	{
+		request->content = content;
+		return;
+	}
+
+	// Reduce and orient ubyte content. Packed content is left at the placeholder.
+	GLuint texelSize = CC3TexelSizeFromFormatAndType( content->getPixelGLFormat(), content->getPixelGLType() );
+	if ( content->getPixelGLType() == GL_UNSIGNED_BYTE && texelSize <= 4 && content->getImageData() )
+	{
+		bool flipVert = !XOR( content->isUpsideDown(), request->shouldFlipVertically );
+		request->reducedData = CC3ReduceImageData( (const GLubyte*)content->getImageData(), 
+												   CC3IntSizeMake( content->getPixelsWide(), content->getPixelsHigh() ),
+												   texelSize, 1 << MIN( request->reduceLevel, 15u ),
+												   flipVert, request->shouldFlipHorizontally, request->reducedSize );
+	}
+	request->content = content;		// Retained for format info, image data released below
+	content->deleteImageData();
+}
+
+/** Applies the loaded content of the request to its texture. Must be run on the GL thread. */
+void CC3TextureResidencyManager::completeLoadRequest( CC3TextureLoadRequest* request )
+{
+	CC3Texture* tex = request->texture;
+	CC3Texture2DContent* content = request->content;
+
+	if ( request->reduceLevel == 0 )
+	{
+		if ( content && tex->getResidency() == kCC3TextureResidencyLoading )
+		{
+			tex->bindReloadedContent( content );
+			m_reloadCount++;
+		}
+		else if ( tex->getResidency() == kCC3TextureResidencyLoading )
+		{
+			CCLOGERROR( "CC3TextureResidencyManager could not reload texture %s from file %s", 
+						tex->getName().c_str(), request->filePath.c_str() );
+			tex->setResidency( kCC3TextureResidencyEvicted );
+		}
+	}
+	else if ( request->reducedData && tex->getResidency() == kCC3TextureResidencyEvicted )
+	{
+		tex->bindReducedContent( request->reducedData, request->reducedSize, 
+								 content->getPixelGLFormat(), content->getPixelGLType() );
+	}
+
+	delete[] request->reducedData;
+	CC_SAFE_RELEASE( content );
+	tex->release();
+	delete request;
+}
+
+void CC3TextureResidencyManager::processCompletedRequests()
+{
+	if ( !m_isLoadingThreadRunning )
+		return;
+
+	std::deque<CC3TextureLoadRequest*> completedRequests;
+	pthread_mutex_lock( &m_requestMutex );
+	completedRequests.swap( m_completedRequests );
+	pthread_mutex_unlock( &m_requestMutex );
+
+	for ( std::deque<CC3TextureLoadRequest*>::iterator it = completedRequests.begin(); it != completedRequests.end(); ++it )
+		completeLoadRequest( *it );
+}
+
+void CC3TextureResidencyManager::ensureLoadingThread()
+{
+	if ( m_isLoadingThreadRunning )
+		return;
+
+	m_shouldStopLoadingThread = false;
+	m_isLoadingThreadRunning = (pthread_create( &m_loadingThread, NULL, loadingThreadMain, this ) == 0);
+	if ( !m_isLoadingThreadRunning )
+	{
+		CCLOGERROR( "CC3TextureResidencyManager could not start loading thread. Textures will be reloaded synchronously." );
+		m_shouldLoadAsynchronously = false;
+	}
+}
+
+void* CC3TextureResidencyManager::loadingThreadMain( void* manager )
+{
+	CC3TextureResidencyManager* mgr = (CC3TextureResidencyManager*)manager;
+
+	while ( true )
+	{
+		pthread_mutex_lock( &mgr->m_requestMutex );
+		while ( mgr->m_pendingRequests.empty() && !mgr->m_shouldStopLoadingThread )
+			pthread_cond_wait( &mgr->m_requestCondition, &mgr->m_requestMutex );
+
+		if ( mgr->m_shouldStopLoadingThread )
+		{
+			pthread_mutex_unlock( &mgr->m_requestMutex );
+			break;
+		}
+
+		CC3TextureLoadRequest* request = mgr->m_pendingRequests.front();
+		mgr->m_pendingRequests.pop_front();
+		pthread_mutex_unlock( &mgr->m_requestMutex );
+
+		mgr->processLoadRequest( request );
+
+		pthread_mutex_lock( &mgr->m_requestMutex );
+		mgr->m_completedRequests.push_back( request );
+		pthread_mutex_unlock( &mgr->m_requestMutex );
+	}
+
+	return NULL;
+}
+
+NS_COCOS3D_END
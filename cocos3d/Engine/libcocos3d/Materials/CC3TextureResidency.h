@@ -0,0 +1,174 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#ifndef _CC3_TEXTURE_RESIDENCY_H_
+#define _CC3_TEXTURE_RESIDENCY_H_
+#include <pthread.h>
+#include <deque>
+#include <algorithm>
+
+NS_COCOS3D_BEGIN
+
+class CC3Texture;
+class CC3Texture2DContent;
+
+/** A request to decode the content of an evicted texture from its file. Used internally. */
+typedef struct {
+	CC3Texture*				texture;			/**< The texture to load. Retained while the request is in flight. */
+	std::string				filePath;			/**< The file to load the content from. */
+	GLuint					reduceLevel;		/**< Zero for full content, or the mip level of reduced content. */
+	bool					shouldFlipVertically;	/**< Whether reduced content should be flipped vertically. */
+	bool					shouldFlipHorizontally;	/**< Whether reduced content should be flipped horizontally. */
+	CC3Texture2DContent*	content;			/**< The decoded content. */
+	GLubyte*				reducedData;		/**< The reduced and oriented pixel data. */
+	CC3IntSize				reducedSize;		/**< The size of the reduced pixel data. */
+} CC3TextureLoadRequest;
+
+/**
+ * CC3TextureResidencyManager keeps the total GL memory used by file-based textures within a
+ * configurable budget.
+ *
+ * Each texture added to the CC3Texture cache is tracked by this manager. Whenever a texture is
+ * bound to a texture unit for drawing, the current CCDirector frame is recorded in the texture.
+ * Once per frame, if the total resident byte cost of the tracked textures exceeds the budget,
+ * the least-recently-bound textures are evicted until the total is back within the budget.
+ * Textures that were bound in the current or previous frame are never evicted.
+ *
+ * An evicted texture keeps its GL texture name, and its size, so that anything referencing it
+ * remains valid, but its GL content is replaced by a single-texel placeholder. If the
+ * evictedMipLevel property is not zero, the file is then decoded again in the background and
+ * reduced to that mip level, so the evicted texture is drawn blurred rather than flat.
+ *
+ * When an evicted texture is bound again, its full content is reloaded from its file. If the
+ * shouldLoadAsynchronously property is YES, the file is decoded on a background thread, and the
+ * placeholder is drawn until the decoded content is uploaded to the GL engine at the start of a
+ * later frame. Otherwise, the content is reloaded immediately, before the texture is bound.
+ *
+ * Only 2D textures that were loaded from a single file, and whose content has not since been
+ * modified, can be evicted. The initial budget is zero, which disables eviction.
+ */
+class CC3TextureResidencyManager : public CCObject
+{
+public:
+	CC3TextureResidencyManager();
+	virtual ~CC3TextureResidencyManager();
+
+	/** 
+	 * The maximum number of bytes of GL memory that the tracked textures should occupy.
+	 * A value of zero disables eviction. The initial value of this property is zero.
+	 */
+	unsigned long				getBudget();
+	void						setBudget( unsigned long budget );
+
+	/** Returns the number of bytes of GL memory currently occupied by the tracked textures. */
+	unsigned long				getResidentBytes();
+
+	/**
+	 * The mip level to which evicted textures are reduced. A value of zero replaces evicted
+	 * content with a single-texel placeholder only. A value of N reduces the content of each
+	 * dimension by a factor of 2^N. The initial value of this property is zero.
+	 */
+	GLuint						getEvictedMipLevel();
+	void						setEvictedMipLevel( GLuint mipLevel );
+
+	/**
+	 * Indicates whether evicted textures should be reloaded on a background thread.
+	 * The initial value of this property is YES.
+	 */
+	bool						shouldLoadAsynchronously();
+	void						setShouldLoadAsynchronously( bool shouldLoadAsync );
+
+	/** Returns the number of textures evicted since this manager was created. */
+	GLuint						getEvictionCount();
+
+	/** Returns the number of textures reloaded since this manager was created. */
+	GLuint						getReloadCount();
+
+	/** Starts tracking the specified texture. Invoked automatically when a texture is cached. */
+	void						addTexture( CC3Texture* texture );
+
+	/** Stops tracking the specified texture. Invoked automatically when a texture is deallocated. */
+	void						removeTexture( CC3Texture* texture );
+
+	/**
+	 * Records that the specified texture is being bound in the current frame, and requests that
+	 * its content be reloaded if it has been evicted. Invoked automatically when a texture is drawn.
+	 */
+	void						textureWasBound( CC3Texture* texture );
+
+	/**
+	 * Uploads any content that has finished loading in the background, and evicts the
+	 * least-recently-bound textures if the budget has been exceeded.
+	 *
+	 * This method is invoked automatically by the CC3Scene once per frame, before drawing.
+	 * It does nothing if it has already been invoked during the current CCDirector frame.
+	 */
+	void						update();
+
+	/** Evicts the specified texture, if it is evictable. */
+	void						evictTexture( CC3Texture* texture );
+
+	/** Evicts all evictable textures that have not been bound in the current frame. */
+	void						evictAllUnusedTextures();
+
+	void						init();
+
+	/** Returns the singleton residency manager instance. */
+	static CC3TextureResidencyManager* sharedManager();
+
+protected:
+	unsigned int				getCurrentFrame();
+	void						enforceBudget();
+	void						requestLoad( CC3Texture* texture, GLuint reduceLevel );
+	void						processLoadRequest( CC3TextureLoadRequest* request );
+	void						completeLoadRequest( CC3TextureLoadRequest* request );
+	void						processCompletedRequests();
+	void						ensureLoadingThread();
+	static void*				loadingThreadMain( void* manager );
+
+protected:
+	std::vector<CC3Texture*>	m_textures;					// weak references
+	std::deque<CC3TextureLoadRequest*>	m_pendingRequests;
+	std::deque<CC3TextureLoadRequest*>	m_completedRequests;
+	pthread_t					m_loadingThread;
+	pthread_mutex_t				m_requestMutex;
+	pthread_cond_t				m_requestCondition;
+	unsigned long				m_budget;
+	unsigned int				m_lastUpdateFrame;
+	GLuint						m_evictedMipLevel;
+	GLuint						m_evictionCount;
+	GLuint						m_reloadCount;
+	bool						m_shouldLoadAsynchronously : 1;
+	bool						m_isLoadingThreadRunning : 1;
+	bool						m_shouldStopLoadingThread : 1;
+};
+
+NS_COCOS3D_END
+
+#endif
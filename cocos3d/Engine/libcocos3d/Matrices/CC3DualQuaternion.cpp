@@ -0,0 +1,185 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#include "cocos3d.h"
+
+NS_COCOS3D_BEGIN
+
+std::string stringFromCC3DualQuaternion( const CC3DualQuaternion* dq )
+{
+	return CC3String::stringWithFormat( (char*)"(Real: (%.6f, %.6f, %.6f, %.6f), Dual: (%.6f, %.6f, %.6f, %.6f))",
+		dq->real.x, dq->real.y, dq->real.z, dq->real.w,
+		dq->dual.x, dq->dual.y, dq->dual.z, dq->dual.w );
+}
+
+// The dual part is half of the product of the translation, as a pure quaternion, and the rotation.
+void CC3DualQuaternionPopulateFromRotationAndTranslation( CC3DualQuaternion* dq, CC3Quaternion rotation, CC3Vector translation )
+{
+	const CC3Quaternion& r = rotation;
+	const CC3Vector& t = translation;
+
+	dq->real = r;
+	dq->dual.x = 0.5f * ( (t.x * r.w) + (t.y * r.z) - (t.z * r.y));
+	dq->dual.y = 0.5f * (-(t.x * r.z) + (t.y * r.w) + (t.z * r.x));
+	dq->dual.z = 0.5f * ( (t.x * r.y) - (t.y * r.x) + (t.z * r.w));
+	dq->dual.w = -0.5f * ((t.x * r.x) + (t.y * r.y) + (t.z * r.z));
+}
+
+void CC3DualQuaternionPopulateFrom4x3( CC3DualQuaternion* dq, const CC3Matrix4x3* mtx )
+{
+	// Remove any scale from the columns of the rotational part.
+	CC3Vector c1 = CC3Vector( mtx->c1r1, mtx->c1r2, mtx->c1r3 ).normalize();
+	CC3Vector c2 = CC3Vector( mtx->c2r1, mtx->c2r2, mtx->c2r3 ).normalize();
+	CC3Vector c3 = CC3Vector( mtx->c3r1, mtx->c3r2, mtx->c3r3 ).normalize();
+
+	// Extract the rotation from the diagonal, using its largest component to maintain precision.
+	// Elements are named here by row then column, as Rrc.
+	GLfloat r11 = c1.x, r21 = c1.y, r31 = c1.z;
+	GLfloat r12 = c2.x, r22 = c2.y, r32 = c2.z;
+	GLfloat r13 = c3.x, r23 = c3.y, r33 = c3.z;
+
+	CC3Quaternion q;
+	GLfloat trace = r11 + r22 + r33;
+	if (trace > 0.0f) 
+	{
+		GLfloat s = sqrtf(trace + 1.0f) * 2.0f;
+		q.w = 0.25f * s;
+		q.x = (r32 - r23) / s;
+		q.y = (r13 - r31) / s;
+		q.z = (r21 - r12) / s;
+	} 
+	else if (r11 > r22 && r11 > r33) 
+	{
+		GLfloat s = sqrtf(1.0f + r11 - r22 - r33) * 2.0f;
+		q.w = (r32 - r23) / s;
+		q.x = 0.25f * s;
+		q.y = (r12 + r21) / s;
+		q.z = (r13 + r31) / s;
+	} 
+	else if (r22 > r33) 
+	{
+		GLfloat s = sqrtf(1.0f + r22 - r11 - r33) * 2.0f;
+		q.w = (r13 - r31) / s;
+		q.x = (r12 + r21) / s;
+		q.y = 0.25f * s;
+		q.z = (r23 + r32) / s;
+	} 
+	else 
+	{
+		GLfloat s = sqrtf(1.0f + r33 - r11 - r22) * 2.0f;
+		q.w = (r21 - r12) / s;
+		q.x = (r13 + r31) / s;
+		q.y = (r23 + r32) / s;
+		q.z = 0.25f * s;
+	}
+
+	// Keep the rotation in the positive-W hemisphere, so that neighbouring bones blend consistently.
+	if (q.w < 0.0f) 
+		q = CC3Vector4( -q.x, -q.y, -q.z, -q.w );
+
+	// Renormalize to remove the rounding of the extraction.
+	GLfloat ooLen = 1.0f / sqrtf((q.x * q.x) + (q.y * q.y) + (q.z * q.z) + (q.w * q.w));
+	q = CC3Vector4( q.x * ooLen, q.y * ooLen, q.z * ooLen, q.w * ooLen );
+
+	CC3DualQuaternionPopulateFromRotationAndTranslation( dq, q, CC3Vector( mtx->c4r1, mtx->c4r2, mtx->c4r3 ) );
+}
+
+void CC3Matrix4x3PopulateFromDualQuaternion( CC3Matrix4x3* mtx, const CC3DualQuaternion* dq )
+{
+	const CC3Quaternion& q = dq->real;
+
+	GLfloat twoXX = 2.0f * q.x * q.x;
+	GLfloat twoXY = 2.0f * q.x * q.y;
+	GLfloat twoXZ = 2.0f * q.x * q.z;
+	GLfloat twoXW = 2.0f * q.x * q.w;
+	GLfloat twoYY = 2.0f * q.y * q.y;
+	GLfloat twoYZ = 2.0f * q.y * q.z;
+	GLfloat twoYW = 2.0f * q.y * q.w;
+	GLfloat twoZZ = 2.0f * q.z * q.z;
+	GLfloat twoZW = 2.0f * q.z * q.w;
+
+	mtx->c1r1 = 1.0f - twoYY - twoZZ;
+	mtx->c1r2 = twoXY + twoZW;
+	mtx->c1r3 = twoXZ - twoYW;
+
+	mtx->c2r1 = twoXY - twoZW;
+	mtx->c2r2 = 1.0f - twoXX - twoZZ;
+	mtx->c2r3 = twoYZ + twoXW;
+
+	mtx->c3r1 = twoXZ + twoYW;
+	mtx->c3r2 = twoYZ - twoXW;
+	mtx->c3r3 = 1.0f - twoXX - twoYY;
+
+	CC3Vector t = CC3DualQuaternionExtractTranslation( dq );
+	mtx->c4r1 = t.x;
+	mtx->c4r2 = t.y;
+	mtx->c4r3 = t.z;
+}
+
+// The translation is twice the vector part of the product of the dual part and the conjugate of the real part.
+CC3Vector CC3DualQuaternionExtractTranslation( const CC3DualQuaternion* dq )
+{
+	const CC3Quaternion& r = dq->real;
+	const CC3Quaternion& d = dq->dual;
+	return CC3Vector( 2.0f * ((r.w * d.x) - (d.w * r.x) + (r.y * d.z) - (r.z * d.y)),
+					  2.0f * ((r.w * d.y) - (d.w * r.y) + (r.z * d.x) - (r.x * d.z)),
+					  2.0f * ((r.w * d.z) - (d.w * r.z) + (r.x * d.y) - (r.y * d.x)) );
+}
+
+bool CC3DualQuaternionNormalize( CC3DualQuaternion* dq )
+{
+	GLfloat lenSq = (dq->real.x * dq->real.x) + (dq->real.y * dq->real.y) +
+					(dq->real.z * dq->real.z) + (dq->real.w * dq->real.w);
+	if (lenSq <= 0.0f) 
+	{
+		CC3DualQuaternionPopulateIdentity( dq );
+		return false;
+	}
+
+	GLfloat ooLen = 1.0f / sqrtf(lenSq);
+	dq->real = CC3Vector4( dq->real.x * ooLen, dq->real.y * ooLen, dq->real.z * ooLen, dq->real.w * ooLen );
+	dq->dual = CC3Vector4( dq->dual.x * ooLen, dq->dual.y * ooLen, dq->dual.z * ooLen, dq->dual.w * ooLen );
+	return true;
+}
+
+// v' = v + 2 * cross(q.xyz, cross(q.xyz, v) + q.w * v)
+CC3Vector CC3DualQuaternionTransformDirection( const CC3DualQuaternion* dq, CC3Vector v )
+{
+	const CC3Quaternion& q = dq->real;
+	CC3Vector u = CC3Vector( q.x, q.y, q.z );
+	CC3Vector uv = u.cross( v ).add( v.scaleUniform( q.w ) );
+	return v.add( u.cross( uv ).scaleUniform( 2.0f ) );
+}
+
+CC3Vector CC3DualQuaternionTransformLocation( const CC3DualQuaternion* dq, CC3Vector v )
+{
+	return CC3DualQuaternionTransformDirection( dq, v ).add( CC3DualQuaternionExtractTranslation( dq ) );
+}
+
+NS_COCOS3D_END
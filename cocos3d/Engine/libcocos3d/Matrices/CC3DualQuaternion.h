@@ -0,0 +1,137 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#ifndef _CCL_CC3DUALQUATERNION_H_
+#define _CCL_CC3DUALQUATERNION_H_
+
+NS_COCOS3D_BEGIN
+
+/**
+ * A structure representing a rigid transform (a rotation followed by a translation) as a unit
+ * dual quaternion. Dual quaternions are used to skin meshes, because a weighted blend of several
+ * of them is itself a rigid transform, which avoids the loss of volume ("candy-wrapper" collapse)
+ * of a twisting joint that results from blending transform matrices.
+ *
+ * The real part holds the rotation, and the dual part holds half of the translation, multiplied
+ * by the rotation. Both parts follow the common Hamilton convention used by GLSL skinning code,
+ * in which the X, Y & Z components of the real part point along the rotation axis. Note that the
+ * quaternions returned by CC3Matrix3x3ExtractQuaternion are the conjugates of these.
+ *
+ * Only the rigid part of a transform is held. Scale and shear are discarded when a dual
+ * quaternion is populated from a matrix.
+ */
+typedef struct
+{
+	CC3Quaternion	real;		/**< The rotational part of the transform. */
+	CC3Quaternion	dual;		/**< The translational part of the transform. */
+} CC3DualQuaternion;
+
+/** Returns a string description of the specified dual quaternion. */
+std::string stringFromCC3DualQuaternion( const CC3DualQuaternion* dq );
+
+/** Populates the specified dual quaternion as the identity transform. */
+static inline void CC3DualQuaternionPopulateIdentity( CC3DualQuaternion* dq )
+{
+	dq->real = CC3Vector4( 0.0f, 0.0f, 0.0f, 1.0f );
+	dq->dual = CC3Vector4( 0.0f, 0.0f, 0.0f, 0.0f );
+}
+
+/** Populates the specified dual quaternion with zeros, in preparation for accumulating a weighted blend. */
+static inline void CC3DualQuaternionPopulateZero( CC3DualQuaternion* dq )
+{
+	dq->real = CC3Vector4( 0.0f, 0.0f, 0.0f, 0.0f );
+	dq->dual = CC3Vector4( 0.0f, 0.0f, 0.0f, 0.0f );
+}
+
+/**
+ * Populates the specified dual quaternion from the specified unit rotation quaternion, expressed in
+ * the convention described for the CC3DualQuaternion structure, and the specified translation.
+ */
+void CC3DualQuaternionPopulateFromRotationAndTranslation( CC3DualQuaternion* dq, CC3Quaternion rotation, CC3Vector translation );
+
+/**
+ * Populates the specified dual quaternion from the rigid part of the specified matrix.
+ *
+ * The columns of the rotational part of the matrix are normalized before the rotation is
+ * extracted, so a uniformly or non-uniformly scaled matrix yields its unscaled rotation.
+ * The resulting real part is given a non-negative W component, so that the dual quaternions
+ * of bones in similar orientations lie in the same hemisphere, and blend without flipping.
+ */
+void CC3DualQuaternionPopulateFrom4x3( CC3DualQuaternion* dq, const CC3Matrix4x3* mtx );
+
+/** Populates the specified matrix with the rigid transform held by the specified unit dual quaternion. */
+void CC3Matrix4x3PopulateFromDualQuaternion( CC3Matrix4x3* mtx, const CC3DualQuaternion* dq );
+
+/** Returns the translation held by the specified unit dual quaternion. */
+CC3Vector CC3DualQuaternionExtractTranslation( const CC3DualQuaternion* dq );
+
+/**
+ * Adds the specified dual quaternion, scaled by the specified weight, to the specified blend sum.
+ *
+ * A quaternion and its negation represent the same rotation. To blend along the shortest path,
+ * the weight is negated if the real part of the dual quaternion points into the opposite
+ * hemisphere from the real part of the sum accumulated so far. Accumulate the most heavily
+ * weighted influence first, or at least consistently, so that the sum is a stable pivot.
+ *
+ * After all influences have been added, invoke CC3DualQuaternionNormalize on the sum.
+ */
+static inline void CC3DualQuaternionAddWeighted( CC3DualQuaternion* dqSum, const CC3DualQuaternion* dq, GLfloat weight )
+{
+	GLfloat realDot = (dqSum->real.x * dq->real.x) + (dqSum->real.y * dq->real.y) +
+					  (dqSum->real.z * dq->real.z) + (dqSum->real.w * dq->real.w);
+	if (realDot < 0.0f) 
+		weight = -weight;
+
+	dqSum->real.x += dq->real.x * weight;
+	dqSum->real.y += dq->real.y * weight;
+	dqSum->real.z += dq->real.z * weight;
+	dqSum->real.w += dq->real.w * weight;
+
+	dqSum->dual.x += dq->dual.x * weight;
+	dqSum->dual.y += dq->dual.y * weight;
+	dqSum->dual.z += dq->dual.z * weight;
+	dqSum->dual.w += dq->dual.w * weight;
+}
+
+/**
+ * Normalizes the specified dual quaternion, such as one accumulated by CC3DualQuaternionAddWeighted,
+ * so that it represents a rigid transform. Returns whether the dual quaternion could be normalized.
+ * If the real part has zero length, the dual quaternion is set to the identity, and NO is returned.
+ */
+bool CC3DualQuaternionNormalize( CC3DualQuaternion* dq );
+
+/** Returns the specified location transformed by the specified unit dual quaternion. */
+CC3Vector CC3DualQuaternionTransformLocation( const CC3DualQuaternion* dq, CC3Vector v );
+
+/** Returns the specified direction rotated by the specified unit dual quaternion, ignoring translation. */
+CC3Vector CC3DualQuaternionTransformDirection( const CC3DualQuaternion* dq, CC3Vector v );
+
+NS_COCOS3D_END
+
+#endif
@@ -34,6 +34,8 @@ NS_COCOS3D_BEGIN
 CC3DeformedFaceArray::CC3DeformedFaceArray()
 {
 	m_pNode = NULL;
+	m_deformedVertexLocations = NULL;
+	m_generation = 1;
 }
 
 CC3DeformedFaceArray::~CC3DeformedFaceArray()
@@ -52,6 +54,7 @@ void CC3DeformedFaceArray::setNode( CC3SkinMeshNode* aNode )
 	m_pNode = aNode;								// weak reference
 	setMesh( aNode->getMesh() );
 	deallocateDeformedVertexLocations();
+	markBoneBoundsDirty();
 }
 
 void CC3DeformedFaceArray::setShouldCacheFaces( bool shouldCache )
@@ -77,7 +80,14 @@ GLuint CC3DeformedFaceArray::getVertexCount()
 CC3Face CC3DeformedFaceArray::getFaceAt( GLuint faceIndex )
 {
 	CC3FaceIndices faceIndices = m_pNode->getFaceIndicesAt( faceIndex );
-	if (m_shouldCacheFaces) 
+	if (m_shouldCacheFaces && m_shouldDeformLazily) 
+	{
+		CC3SkinSection* ss = m_pNode->getSkinSectionForFaceIndex( faceIndex );
+		return CC3Face(getCurrentVertexLocationAt( faceIndices.vertices[0], ss ),
+					   getCurrentVertexLocationAt( faceIndices.vertices[1], ss ),
+					   getCurrentVertexLocationAt( faceIndices.vertices[2], ss ));
+	}
+	else if (m_shouldCacheFaces) 
 	{
 		CC3Vector* vtxLocs = getDeformedVertexLocations();
 		return CC3Face(vtxLocs[faceIndices.vertices[0]],
@@ -101,6 +111,9 @@ void CC3DeformedFaceArray::initWithTag( GLuint aTag, const std::string& aName )
 		m_deformedVertexLocations = NULL;
 		m_deformedVertexLocationsAreRetained = false;
 		m_deformedVertexLocationsAreDirty = true;
+		m_generation = 1;
+		m_shouldDeformLazily = true;
+		m_boneBoundsAreDirty = true;
 	}
 }
 
@@ -122,6 +135,10 @@ void CC3DeformedFaceArray::populateFrom( CC3DeformedFaceArray* another )
 		m_deformedVertexLocations = another->getDeformedVertexLocations();
 	}
 	m_deformedVertexLocationsAreDirty = another->m_deformedVertexLocationsAreDirty;
+	m_vertexGenerations = another->m_vertexGenerations;
+	m_generation = another->m_generation;
+	m_shouldDeformLazily = another->m_shouldDeformLazily;
+	markBoneBoundsDirty();
 }
 
 CCObject* CC3DeformedFaceArray::copyWithZone( CCZone* zone )
@@ -145,10 +162,14 @@ void CC3DeformedFaceArray::setDeformedVertexLocations( CC3Vector* vtxLocs )
 {
 	deallocateDeformedVertexLocations();			// Safely disposes existing vertices
 	m_deformedVertexLocations = vtxLocs;
+	resetVertexGenerations();
 }
 
 CC3Vector CC3DeformedFaceArray::getDeformedVertexLocationAt( GLuint vertexIndex, GLuint faceIndex )
 {
+	if (m_shouldCacheFaces && m_shouldDeformLazily) 
+		return getCurrentVertexLocationAt( vertexIndex, m_pNode->getSkinSectionForFaceIndex(faceIndex) );
+
 	if (m_shouldCacheFaces) 
 		return getDeformedVertexLocations()[vertexIndex];
 
@@ -163,6 +184,7 @@ CC3Vector* CC3DeformedFaceArray::allocateDeformedVertexLocations()
 	{
 		m_deformedVertexLocations = (CC3Vector*)calloc(vtxCount, sizeof(CC3Vector));
 		m_deformedVertexLocationsAreRetained = true;
+		resetVertexGenerations();
 		CC3_TRACE("CC3DeformedFaceArray allocated space for %d deformed vertex locations", vtxCount);
 	}
 	return m_deformedVertexLocations;
@@ -182,14 +204,13 @@ void CC3DeformedFaceArray::deallocateDeformedVertexLocations()
 void CC3DeformedFaceArray::populateDeformedVertexLocations()
 {
 	CC3_TRACE("CC3DeformedFaceArray populating %d deformed vertex locations", getVertexCount());
+	ensureDeformedVertexStorage();
 	if ( !m_deformedVertexLocations )
-		allocateDeformedVertexLocations();
-	
-	// Mark all the location vectors in the cached array as unset, so we can keep
-	// track of which vertices have been set, as we iterate through the mesh vertices.
+		return;
+
+	// Vertices already deformed in the current generation, either by lazy face access or
+	// because they are shared by several faces, are recognized by their generation stamp.
 	GLuint vtxCount = getVertexCount();
-	for (GLuint vtxIdx = 0; vtxIdx < vtxCount; vtxIdx++)
-		m_deformedVertexLocations[vtxIdx] = CC3Vector::kCC3VectorNull;
 
 	// Determine whether the mesh is indexed.
 	// If it is, we iterate through the indexes.
@@ -219,15 +240,9 @@ void CC3DeformedFaceArray::populateDeformedVertexLocations()
 		// index position. If the mesh is not indexed, then it IS the vertex index position.
 		GLuint vtxIdx = meshIsIndexed ? m_pMesh->getVertexIndexAt(vtxIdxPos) : vtxIdxPos;
 		
-		// If the cached vertex location has not yet been set, use the skin section to
-		// deform the vertex location at the current index, and set it into the cache array.
-		if ( m_deformedVertexLocations[vtxIdx].isNull() )
-		{
-			m_deformedVertexLocations[vtxIdx] = ss->getDeformedVertexLocationAt( vtxIdx );
-			
-// 			LogTrace(@"Setting deformed vertex %i to %@", vtxIdx,
-// 						  NSStringFromCC3Vector(_deformedVertexLocations[vtxIdx]));
-		}
+		// If the cached vertex location is stale, use the skin section to deform
+		// the vertex location at the current index, and set it into the cache array.
+		getCurrentVertexLocationAt( vtxIdx, ss );
 	}
 	m_deformedVertexLocationsAreDirty = false;
 }
@@ -235,6 +250,269 @@ void CC3DeformedFaceArray::populateDeformedVertexLocations()
 void CC3DeformedFaceArray::markDeformedVertexLocationsDirty()
 {
 	m_deformedVertexLocationsAreDirty = true; 
+
+	// Advancing the generation invalidates every cached vertex at once.
+	// On the rare wrap-around, clear the stamps so none appear current.
+	if ( ++m_generation == 0 )
+	{
+		resetVertexGenerations();
+		for (GLuint i = 0; i < m_faceClusters.size(); i++)
+			m_faceClusters[i].generation = 0;
+		m_generation = 1;
+	}
+}
+
+bool CC3DeformedFaceArray::shouldDeformLazily()
+{
+	return m_shouldDeformLazily;
+}
+
+void CC3DeformedFaceArray::setShouldDeformLazily( bool shouldDeformLazily )
+{
+	m_shouldDeformLazily = shouldDeformLazily;
+}
+
+void CC3DeformedFaceArray::resetVertexGenerations()
+{
+	m_vertexGenerations.assign( m_deformedVertexLocations ? getVertexCount() : 0, 0 );
+}
+
+void CC3DeformedFaceArray::ensureDeformedVertexStorage()
+{
+	if ( !m_deformedVertexLocations )
+		allocateDeformedVertexLocations();
+	else if ( m_vertexGenerations.size() != getVertexCount() )
+		resetVertexGenerations();
+}
+
+CC3Vector CC3DeformedFaceArray::getCurrentVertexLocationAt( GLuint vtxIdx, CC3SkinSection* ss )
+{
+	if ( m_vertexGenerations.size() <= vtxIdx || !m_deformedVertexLocations )
+	{
+		ensureDeformedVertexStorage();
+		if ( !m_deformedVertexLocations )
+			return ss->getDeformedVertexLocationAt( vtxIdx );
+	}
+
+	if ( m_vertexGenerations[vtxIdx] != m_generation )
+	{
+		m_deformedVertexLocations[vtxIdx] = ss->getDeformedVertexLocationAt( vtxIdx );
+		m_vertexGenerations[vtxIdx] = m_generation;
+	}
+	return m_deformedVertexLocations[vtxIdx];
+}
+
+void CC3DeformedFaceArray::markBoneBoundsDirty()
+{
+	m_boneBoundsAreDirty = true;
+}
+
+/**
+ * Groups the faces into runs of contiguous faces deformed by the same skin section, and, for each
+ * run, bounds the rest locations of its vertices separately for each bone that influences them.
+ *
+ * A deformed vertex is the weighted sum of the vertex as transformed by each of its bones. When the
+ * weights are non-negative and sum to one, that sum lies within the convex hull of the individually
+ * transformed locations, and therefore within any sphere that encloses all of the per-bone spheres
+ * after they have been moved by their bones. Clusters containing other weights are left unbounded.
+ * Dual-quaternion blending does not stay within that hull, so all clusters are left unbounded when
+ * the node is using dual-quaternion skinning.
+ */
+void CC3DeformedFaceArray::buildBoneBounds()
+{
+	m_faceClusters.clear();
+	m_boneBounds.clear();
+	m_boneBoundsAreDirty = false;
+
+	if ( !m_pNode || !m_pMesh )
+		return;
+
+	GLuint faceCount = getFaceCount();
+	GLuint vuCnt = m_pMesh->getVertexBoneCount();
+	bool canBound = (vuCnt > 0) && !m_pNode->shouldUseDualQuaternionSkinning();
+	std::vector<CC3Box> boneBoxes;
+
+	GLuint faceIdx = 0;
+	while (faceIdx < faceCount) 
+	{
+		CC3SkinSection* ss = m_pNode->getSkinSectionForFaceIndex( faceIdx );
+		if ( !ss )
+		{
+			faceIdx++;
+			continue;
+		}
+
+		CC3DeformedFaceCluster cluster;
+		cluster.skinSection = ss;
+		cluster.faceStart = faceIdx;
+		cluster.faceCount = 0;
+		cluster.boneBoundsStart = (GLuint)m_boneBounds.size();
+		cluster.boneBoundsCount = 0;
+		cluster.isBounded = canBound;
+		cluster.generation = 0;
+		cluster.deformedSphere = CC3SphereMake( CC3Vector::kCC3VectorZero, 0.0f );
+
+		boneBoxes.assign( ss->getBoneCount(), CC3Box::kCC3BoxNull );
+
+		while (faceIdx < faceCount && cluster.faceCount < kCC3DeformedFaceClusterSize &&
+			   m_pNode->getSkinSectionForFaceIndex( faceIdx ) == ss) 
+		{
+			CC3FaceIndices faceIndices = m_pNode->getFaceIndicesAt( faceIdx );
+			for (GLuint i = 0; i < 3; i++) 
+			{
+				GLuint vtxIdx = faceIndices.vertices[i];
+				CC3Vector restLoc = m_pMesh->getVertexLocationAt( vtxIdx );
+				GLfloat wtSum = 0.0f;
+				for (GLuint vuIdx = 0; vuIdx < vuCnt; vuIdx++) 
+				{
+					GLfloat vtxWt = m_pMesh->getVertexWeightForBoneInfluence( vuIdx, vtxIdx );
+					if (vtxWt < 0.0f) 
+						cluster.isBounded = false;
+					if (vtxWt == 0.0f) 
+						continue;
+
+					wtSum += vtxWt;
+					GLuint boneIdx = m_pMesh->getVertexBoneIndexForBoneInfluence( vuIdx, vtxIdx );
+					if (boneIdx < boneBoxes.size()) 
+						boneBoxes[boneIdx] = boneBoxes[boneIdx].boxEngulfLocation( restLoc );
+					else
+						cluster.isBounded = false;
+				}
+				if (fabsf(wtSum - 1.0f) > 0.001f) 
+					cluster.isBounded = false;
+			}
+			cluster.faceCount++;
+			faceIdx++;
+		}
+
+		for (GLuint boneIdx = 0; boneIdx < boneBoxes.size(); boneIdx++) 
+		{
+			if ( boneBoxes[boneIdx].isNull() )
+				continue;
+
+			CC3DeformedFaceBoneBounds bb;
+			bb.boneIndex = boneIdx;
+			bb.restSphere = CC3SphereFromCircumscribingBox( boneBoxes[boneIdx] );
+			m_boneBounds.push_back( bb );
+			cluster.boneBoundsCount++;
+		}
+
+		m_faceClusters.push_back( cluster );
+	}
+
+	CC3_TRACE("CC3DeformedFaceArray bounded %d faces in %d clusters using %d bone bounds",
+			  faceCount, (GLuint)m_faceClusters.size(), (GLuint)m_boneBounds.size());
+}
+
+CC3Sphere CC3DeformedFaceArray::getDeformedSphereOfCluster( CC3DeformedFaceCluster& cluster )
+{
+	if (cluster.generation == m_generation) 
+		return cluster.deformedSphere;
+
+	CC3Sphere defSphere = CC3SphereMake( CC3Vector::kCC3VectorZero, 0.0f );
+	for (GLuint i = 0; i < cluster.boneBoundsCount; i++) 
+	{
+		CC3DeformedFaceBoneBounds& bb = m_boneBounds[cluster.boneBoundsStart + i];
+		CC3Matrix* boneMtx = cluster.skinSection->getTransformMatrixForBoneAt( bb.boneIndex );
+
+		// A rigid transform preserves the radius. Otherwise, scale the radius by
+		// the combined length of the transformed axes, which bounds any stretch.
+		GLfloat radiusScale = 1.0f;
+		if ( !boneMtx->isRigid() )
+		{
+			radiusScale = sqrtf(boneMtx->transformDirection( CC3Vector::kCC3VectorUnitXPositive ).lengthSquared() +
+								boneMtx->transformDirection( CC3Vector::kCC3VectorUnitYPositive ).lengthSquared() +
+								boneMtx->transformDirection( CC3Vector::kCC3VectorUnitZPositive ).lengthSquared());
+		}
+
+		CC3Sphere boneSphere = CC3SphereMake( boneMtx->transformLocation( bb.restSphere.center ),
+											  bb.restSphere.radius * radiusScale );
+		defSphere = (i == 0) ? boneSphere : CC3SphereUnion( defSphere, boneSphere );
+	}
+
+	cluster.deformedSphere = defSphere;
+	cluster.generation = m_generation;
+	return defSphere;
+}
+
+GLuint CC3DeformedFaceArray::findFirst( GLuint maxHitCount, CC3MeshIntersection* intersections,
+									   const CC3Ray& aRay, bool acceptBackFaces, bool acceptBehind )
+{
+	if ( !m_pNode || !m_pMesh )
+		return 0;
+
+	if ( m_boneBoundsAreDirty )
+		buildBoneBounds();
+
+	GLuint hitIdx = 0;
+	GLuint clusterCount = (GLuint)m_faceClusters.size();
+	GLuint clusterIdx = 0;
+	while (clusterIdx < clusterCount && hitIdx < maxHitCount) 
+	{
+		// Find the run of clusters belonging to the same skin section, and reject the
+		// whole section if the union of their deformed bounds misses the ray.
+		CC3SkinSection* ss = m_faceClusters[clusterIdx].skinSection;
+		GLuint sectionEnd = clusterIdx;
+		bool sectionIsBounded = true;
+		CC3Sphere sectionSphere = CC3SphereMake( CC3Vector::kCC3VectorZero, 0.0f );
+		while (sectionEnd < clusterCount && m_faceClusters[sectionEnd].skinSection == ss) 
+		{
+			CC3DeformedFaceCluster& cluster = m_faceClusters[sectionEnd];
+			if (cluster.isBounded && sectionIsBounded) 
+			{
+				CC3Sphere clusterSphere = getDeformedSphereOfCluster( cluster );
+				sectionSphere = (sectionEnd == clusterIdx) ? clusterSphere : CC3SphereUnion( sectionSphere, clusterSphere );
+			} 
+			else
+			{
+				sectionIsBounded = false;
+			}
+			sectionEnd++;
+		}
+
+		if (sectionIsBounded && !CC3DoesRayIntersectSphere( aRay, sectionSphere )) 
+		{
+			clusterIdx = sectionEnd;
+			continue;
+		}
+
+		for ( ; clusterIdx < sectionEnd && hitIdx < maxHitCount; clusterIdx++) 
+		{
+			CC3DeformedFaceCluster& cluster = m_faceClusters[clusterIdx];
+			if (cluster.isBounded && !CC3DoesRayIntersectSphere( aRay, getDeformedSphereOfCluster( cluster ) )) 
+				continue;
+
+			GLuint faceEnd = cluster.faceStart + cluster.faceCount;
+			for (GLuint faceIdx = cluster.faceStart; faceIdx < faceEnd && hitIdx < maxHitCount; faceIdx++) 
+			{
+				CC3MeshIntersection* hit = &intersections[hitIdx];
+				hit->faceIndex = faceIdx;
+				hit->face = getFaceAt( faceIdx );
+				hit->facePlane = CC3Plane::planeFromFace( hit->face );
+
+				// Check if the ray is not parallel to the face, is approaching from the front,
+				// or is approaching from the back and that is okay.
+				GLfloat dirDotNorm = aRay.direction.dot( hit->facePlane.getNormal() );
+				hit->wasBackFace = dirDotNorm > 0.0f;
+				if (dirDotNorm < 0.0f || (hit->wasBackFace && acceptBackFaces)) 
+				{
+					// Find the point of intersection of the ray with the plane
+					// and check that it is not behind the start of the ray.
+					CC3Vector4 loc4 = CC3RayIntersectionWithPlane(aRay, hit->facePlane);
+					if (acceptBehind || loc4.w >= 0.0f) 
+					{
+						hit->location = loc4.cc3Vector();
+						hit->distance = loc4.w;
+						hit->barycentricLocation = CC3FaceBarycentricWeights(hit->face, hit->location);
+						if ( CC3BarycentricWeightsAreInsideTriangle(hit->barycentricLocation) ) 
+							hitIdx++;
+					}
+				}
+			}
+		}
+		clusterIdx = sectionEnd;
+	}
+	return hitIdx;
 }
 
 CC3DeformedFaceArray* CC3DeformedFaceArray::faceArrayWithName( const std::string& aName )
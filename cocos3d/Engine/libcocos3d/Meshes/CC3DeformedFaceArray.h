@@ -32,6 +32,35 @@
 
 NS_COCOS3D_BEGIN
 
+/**
+ * Conservative rest-pose bounds of the vertices of a face cluster that are influenced by a single
+ * bone. The boneIndex is the index of the bone within the skin section that deforms the cluster.
+ */
+typedef struct
+{
+	GLuint			boneIndex;			/**< The index of the bone within its skin section. */
+	CC3Sphere		restSphere;			/**< Encloses the rest locations of the influenced vertices. */
+} CC3DeformedFaceBoneBounds;
+
+/**
+ * A run of contiguous faces that are all deformed by the same skin section. The deformed
+ * bounds of the cluster are rebuilt from the bone bounds whenever the bones have moved.
+ */
+typedef struct
+{
+	CC3SkinSection*	skinSection;		/**< The skin section deforming the faces (weak reference). */
+	GLuint			faceStart;			/**< The index of the first face in the cluster. */
+	GLuint			faceCount;			/**< The number of faces in the cluster. */
+	GLuint			boneBoundsStart;	/**< The index of the first bone bounds of the cluster. */
+	GLuint			boneBoundsCount;	/**< The number of bone bounds of the cluster. */
+	bool			isBounded;			/**< Whether the bone bounds can be trusted to enclose the faces. */
+	GLuint			generation;			/**< The deformation generation of the deformedSphere. */
+	CC3Sphere		deformedSphere;		/**< Encloses the faces in their current deformed pose. */
+} CC3DeformedFaceCluster;
+
+/** The maximum number of faces held by a single CC3DeformedFaceCluster. */
+#define kCC3DeformedFaceClusterSize		32
+
 /**
  * CC3DeformedFaceArray extends CC3FaceArray to hold the deformed positions of each vertex.
  * From this, the deformed shape and orientation of each face in the mesh can be retrieved.
@@ -39,6 +68,15 @@ NS_COCOS3D_BEGIN
  * If configured to cache the face data (if the shouldCacheFaces is set to YES),
  * the instance will register as a transform listener with the skin mesh node,
  * so that the faces can be rebuilt if the skin mesh node or any of the bones move.
+ *
+ * Each cached deformed vertex location is stamped with the deformation generation in which it
+ * was calculated. Moving a bone simply advances the generation, and, when the shouldDeformLazily
+ * property is set to YES, a vertex is only deformed again when a face that uses it is accessed.
+ *
+ * For hit-testing, the faces are grouped into clusters of contiguous faces, and the rest locations
+ * of the vertices of each cluster are bounded per influencing bone. The findFirst method uses these
+ * bounds, as moved by the current bone transforms, to skip whole skin sections and face clusters
+ * that the ray cannot touch, without deforming any of their vertices.
  */
 class CC3DeformedFaceArray : public CC3FaceArray 
 {
@@ -129,8 +167,43 @@ public:
 	 */
 	void						deallocateDeformedVertexLocations();
 
-	/** Marks the deformed vertices data as dirty. It will be automatically repopulated on the next access. */
+	/**
+	 * Marks the deformed vertices data as dirty. It will be automatically repopulated on the next access.
+	 *
+	 * This does not touch the cached vertex locations. It advances the deformation generation,
+	 * so that each vertex is recalculated the next time it is needed.
+	 */
 	void						markDeformedVertexLocationsDirty();
+
+	/**
+	 * Indicates whether, when caching faces, vertices should be deformed only as the faces that use
+	 * them are accessed, rather than deforming the entire mesh on the first face access after the
+	 * bones have moved. Accessing the deformedVertexLocations property always completes the array.
+	 *
+	 * The initial value of this property is YES.
+	 */
+	bool						shouldDeformLazily();
+	void						setShouldDeformLazily( bool shouldDeformLazily );
+
+	/**
+	 * Marks the rest-pose bone bounds used by the findFirst method as dirty, so they will be rebuilt
+	 * on the next ray test. Invoke this if the rest vertex locations, bone indices or bone weights of
+	 * the mesh are changed. Moving the bones does not require this.
+	 */
+	void						markBoneBoundsDirty();
+
+	/**
+	 * Populates the specified array of intersections with up to maxHitCount faces, in their currently
+	 * deformed pose, that are punctured by the specified ray, which is in the local coordinates of
+	 * the skin mesh node. Returns the number of intersections found.
+	 *
+	 * This behaves like the findFirst method of CC3Mesh, except that skin sections and face clusters
+	 * whose deformed bounds do not intersect the ray are rejected before any of their vertices are
+	 * deformed. Face clusters whose vertex weights do not sum to one cannot be bounded, and are
+	 * always tested face by face.
+	 */
+	GLuint						findFirst( GLuint maxHitCount, CC3MeshIntersection* intersections,
+										   const CC3Ray& aRay, bool acceptBackFaces, bool acceptBehind );
 		
 	/**
 	 * Clears any caches that contain deformable information, including deformed vertices, 
@@ -155,10 +228,27 @@ public:
 	void						setShouldCacheFaces( bool shouldCache );
 	
 protected:
+	/** Returns the deformed location of the specified vertex, deforming it only if its stamp is stale. */
+	CC3Vector					getCurrentVertexLocationAt( GLuint vtxIdx, CC3SkinSection* ss );
+	/** Ensures the cache and generation stamps exist for lazy deformation. */
+	void						ensureDeformedVertexStorage();
+	/** Resets all generation stamps, so that every cached vertex is considered stale. */
+	void						resetVertexGenerations();
+	/** Builds the face clusters and their rest-pose bone bounds. */
+	void						buildBoneBounds();
+	/** Returns the bounds of the specified cluster, as deformed by the current bone transforms. */
+	CC3Sphere					getDeformedSphereOfCluster( CC3DeformedFaceCluster& cluster );
+
 	CC3SkinMeshNode*			m_pNode;
 	CC3Vector*					m_deformedVertexLocations;
+	std::vector<GLuint>			m_vertexGenerations;
+	GLuint						m_generation;
+	std::vector<CC3DeformedFaceCluster>		m_faceClusters;
+	std::vector<CC3DeformedFaceBoneBounds>	m_boneBounds;
 	bool						m_deformedVertexLocationsAreRetained : 1;
 	bool						m_deformedVertexLocationsAreDirty : 1;
+	bool						m_shouldDeformLazily : 1;
+	bool						m_boneBoundsAreDirty : 1;
 };
 
 NS_COCOS3D_END
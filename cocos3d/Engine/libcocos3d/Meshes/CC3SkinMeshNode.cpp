@@ -37,6 +37,7 @@ CC3SkinMeshNode::CC3SkinMeshNode()
 	m_pSkeletalTransformMatrix = NULL;
 	m_pSkeletalTransformMatrixInverted = NULL;
 	m_deformedFaces = NULL;
+	m_shouldUseDualQuaternionSkinning = false;
 }
 
 CC3SkinMeshNode::~CC3SkinMeshNode()
@@ -94,6 +95,168 @@ void CC3SkinMeshNode::ensureRigidSkeleton()
 	super::ensureRigidSkeleton();
 }
 
+bool CC3SkinMeshNode::shouldUseDualQuaternionSkinning()
+{
+	return m_shouldUseDualQuaternionSkinning; 
+}
+
+void CC3SkinMeshNode::setShouldUseDualQuaternionSkinning( bool shouldUseDQ )
+{
+	if ( shouldUseDQ != m_shouldUseDualQuaternionSkinning )
+	{
+		m_shouldUseDualQuaternionSkinning = shouldUseDQ;
+
+		// The deformed locations, and whether bone bounds can enclose them, depend on the blending mode
+		if ( m_deformedFaces )
+		{
+			m_deformedFaces->markBoneBoundsDirty();
+			m_deformedFaces->clearDeformableCaches();
+		}
+	}
+	super::setShouldUseDualQuaternionSkinning( shouldUseDQ );
+}
+
+/**
+ * Walks the skin sections in order, folding each section into the preceding merged section when the
+ * two cover contiguous vertex indices and the union of their bones fits within the specified limit.
+ * The bones of the preceding section keep their indices, and the bones of the folded section are
+ * appended, so only the vertices of the folded section need their bone indices remapped.
+ *
+ * A vertex referenced by more than one section cannot be remapped without corrupting the other
+ * section, so a fold is refused if any such vertex would need a different bone index.
+ */
+void CC3SkinMeshNode::mergeSkinSections( GLuint maxBonesPerSection )
+{
+	super::mergeSkinSections( maxBonesPerSection );
+
+	GLuint ssCount = (GLuint)m_skinSections->count();
+	if ( !m_pMesh || ssCount < 2 )
+		return;
+
+	GLuint vuCnt = m_pMesh->getVertexBoneCount();
+	CC3VertexBoneIndices* vtxBoneIndices = m_pMesh->getVertexBoneIndices();
+	if ( vuCnt == 0 || !vtxBoneIndices || !vtxBoneIndices->getVertices() )
+	{
+		CC3_TRACE("%s cannot merge skin sections because the vertex bone indices are not in memory", getName().c_str());
+		return;
+	}
+
+	bool hasIndices = m_pMesh->hasVertexIndices();
+	const GLint kSharedVertex = -2;
+
+	// Record the section that owns each vertex, or mark it as shared by several sections.
+	std::vector<GLint> vtxOwners( m_pMesh->getVertexCount(), -1 );
+	for (GLuint ssIdx = 0; ssIdx < ssCount; ssIdx++) 
+	{
+		CC3SkinSection* ss = (CC3SkinSection*)m_skinSections->objectAtIndex( ssIdx );
+		GLint viEnd = ss->getVertexStart() + ss->getVertexCount();
+		for (GLint vi = ss->getVertexStart(); vi < viEnd; vi++) 
+		{
+			GLuint vtxIdx = hasIndices ? m_pMesh->getVertexIndexAt( vi ) : vi;
+			GLint& owner = vtxOwners[vtxIdx];
+			if (owner == -1) 
+				owner = (GLint)ssIdx;
+			else if (owner != (GLint)ssIdx) 
+				owner = kSharedVertex;
+		}
+	}
+
+	CCArray* mergedSections = CCArray::createWithCapacity( ssCount );
+	CC3SkinSection* mergedSS = (CC3SkinSection*)m_skinSections->objectAtIndex( 0 );
+	GLuint mergedIdx = 0;
+	mergedSections->addObject( mergedSS );
+
+	std::vector<CC3Bone*> unionBones;
+	std::vector<GLuint> boneMap;
+	for (GLuint ssIdx = 1; ssIdx < ssCount; ssIdx++) 
+	{
+		CC3SkinSection* ss = (CC3SkinSection*)m_skinSections->objectAtIndex( ssIdx );
+		GLint viStart = ss->getVertexStart();
+		GLint viEnd = viStart + ss->getVertexCount();
+
+		// Build the union of the bones, and the mapping from the old to the new bone indices
+		bool canMerge = (mergedSS->getVertexStart() + mergedSS->getVertexCount() == viStart);
+		GLuint mergedBoneCount = mergedSS->getBoneCount();
+		unionBones.clear();
+		for (GLuint bIdx = 0; bIdx < mergedBoneCount; bIdx++) 
+			unionBones.push_back( mergedSS->getBoneAt( bIdx ) );
+
+		GLuint ssBoneCount = ss->getBoneCount();
+		boneMap.resize( ssBoneCount );
+		for (GLuint bIdx = 0; canMerge && bIdx < ssBoneCount; bIdx++) 
+		{
+			CC3Bone* bone = ss->getBoneAt( bIdx );
+			GLuint uIdx = (GLuint)(std::find( unionBones.begin(), unionBones.end(), bone ) - unionBones.begin());
+			if (uIdx == unionBones.size()) 
+				unionBones.push_back( bone );
+			boneMap[bIdx] = uIdx;
+		}
+		canMerge = canMerge && (unionBones.size() <= maxBonesPerSection);
+
+		// Shared vertices must already refer to the same bones in both sections
+		for (GLint vi = viStart; canMerge && vi < viEnd; vi++) 
+		{
+			GLuint vtxIdx = hasIndices ? m_pMesh->getVertexIndexAt( vi ) : vi;
+			if (vtxOwners[vtxIdx] != kSharedVertex) 
+				continue;
+
+			for (GLuint vuIdx = 0; vuIdx < vuCnt; vuIdx++) 
+			{
+				if (m_pMesh->getVertexWeightForBoneInfluence( vuIdx, vtxIdx ) == 0.0f) 
+					continue;
+				GLuint bIdx = m_pMesh->getVertexBoneIndexForBoneInfluence( vuIdx, vtxIdx );
+				if (bIdx >= ssBoneCount || boneMap[bIdx] != bIdx) 
+					canMerge = false;
+			}
+		}
+
+		if ( !canMerge )
+		{
+			mergedSS = ss;
+			mergedIdx = ssIdx;
+			mergedSections->addObject( ss );
+			continue;
+		}
+
+		// Remap the vertices owned by the folded section, marking each as done by handing it to
+		// the merged section, so that vertices repeated in the index array are remapped only once.
+		for (GLint vi = viStart; vi < viEnd; vi++) 
+		{
+			GLuint vtxIdx = hasIndices ? m_pMesh->getVertexIndexAt( vi ) : vi;
+			if (vtxOwners[vtxIdx] != (GLint)ssIdx) 
+				continue;
+
+			for (GLuint vuIdx = 0; vuIdx < vuCnt; vuIdx++) 
+			{
+				GLuint bIdx = m_pMesh->getVertexBoneIndexForBoneInfluence( vuIdx, vtxIdx );
+				if (bIdx < ssBoneCount) 
+					m_pMesh->setVertexBoneIndex( boneMap[bIdx], vuIdx, vtxIdx );
+			}
+			vtxOwners[vtxIdx] = (GLint)mergedIdx;
+		}
+
+		for (GLuint bIdx = mergedBoneCount; bIdx < unionBones.size(); bIdx++) 
+			mergedSS->addBone( unionBones[bIdx] );
+		mergedSS->setVertexCount( mergedSS->getVertexCount() + ss->getVertexCount() );
+	}
+
+	GLuint mergedCount = (GLuint)mergedSections->count();
+	if (mergedCount == ssCount) 
+		return;
+
+	m_skinSections->removeAllObjects();
+	m_skinSections->addObjectsFromArray( mergedSections );
+	m_pMesh->updateVertexBoneIndicesGLBuffer();
+
+	if ( m_deformedFaces )
+	{
+		m_deformedFaces->markBoneBoundsDirty();
+		m_deformedFaces->clearDeformableCaches();
+	}
+
+	CC3_TRACE("%s merged %d skin sections into %d of up to %d bones", getName().c_str(), ssCount, mergedCount, maxBonesPerSection);
+}
+
 void CC3SkinMeshNode::setShouldCacheFaces( bool shouldCache )
 {
 	getDeformedFaces()->setShouldCacheFaces( shouldCache );
@@ -122,6 +285,14 @@ void CC3SkinMeshNode::setDeformedFaces( CC3DeformedFaceArray* aFaceArray )
 	m_deformedFaces->setNode( this );
 }
 
+GLuint CC3SkinMeshNode::findFirst( GLuint maxHitCount, CC3MeshIntersection* intersections, CC3Ray aRay, bool acceptBackFaces, bool acceptBehind )
+{
+	if ( !m_pMesh || !hasSkeleton() )
+		return super::findFirst( maxHitCount, intersections, aRay, acceptBackFaces, acceptBehind );
+
+	return getDeformedFaces()->findFirst( maxHitCount, intersections, aRay, acceptBackFaces, acceptBehind );
+}
+
 CC3Face CC3SkinMeshNode::getDeformedFaceAt( GLuint faceIndex )
 {
 	return getDeformedFaces()->getFaceAt( faceIndex ); 
@@ -158,6 +329,7 @@ void CC3SkinMeshNode::initWithTag( GLuint aTag, const std::string& aName )
 		m_pSkeletalTransformMatrixInverted = CC3AffineMatrix::matrix();// retained
 		m_pSkeletalTransformMatrixInverted->retain();
 		m_deformedFaces = NULL;
+		m_shouldUseDualQuaternionSkinning = false;
 	}
 }
 
@@ -169,6 +341,8 @@ void CC3SkinMeshNode::populateFrom( CC3SkinMeshNode* another )
 	// are different for each mesh node and is created lazily if needed.
 	// The skeletal transform matrices are not copied
 
+	m_shouldUseDualQuaternionSkinning = another->shouldUseDualQuaternionSkinning();
+
 	m_skinSections->removeAllObjects();
 	CCArray* otherSkinSections = another->getSkinSections();
 	CCObject* pObj = NULL;
@@ -156,6 +156,9 @@ public:
 	bool						hasSkeleton();
 	bool						hasRigidSkeleton();
 	void						ensureRigidSkeleton();
+	bool						shouldUseDualQuaternionSkinning();
+	void						setShouldUseDualQuaternionSkinning( bool shouldUseDQ );
+	void						mergeSkinSections( GLuint maxBonesPerSection );
 	void						setShouldCacheFaces( bool shouldCache );
 	CC3DeformedFaceArray*		getDeformedFaces();
 	void						setDeformedFaces( CC3DeformedFaceArray* aFaceArray );
@@ -164,6 +167,13 @@ public:
 	CC3Vector					getDeformedFaceNormalAt( GLuint faceIndex );
 	CC3Plane					getDeformedFacePlaneAt( GLuint faceIndex );
 	CC3Vector					getDeformedVertexLocationAt( GLuint vertexIndex, GLuint faceIndex );
+
+	/**
+	 * Overridden to test the ray against the faces in their current deformed pose, rather than
+	 * against the rest pose of the mesh. Skin sections and face clusters whose deformed bone
+	 * bounds miss the ray are skipped without deforming their vertices.
+	 */
+	GLuint						findFirst( GLuint maxHitCount, CC3MeshIntersection* intersections, CC3Ray aRay, bool acceptBackFaces, bool acceptBehind );
 	void						initWithTag( GLuint aTag, const std::string& aName );
 
 	void						populateFrom( CC3SkinMeshNode* another );
@@ -199,6 +209,7 @@ protected:
 	CC3Matrix*					m_pSkeletalTransformMatrix;
 	CC3Matrix*					m_pSkeletalTransformMatrixInverted;
 	CC3DeformedFaceArray*		m_deformedFaces;
+	bool						m_shouldUseDualQuaternionSkinning : 1;
 };
 
 NS_COCOS3D_END
@@ -125,6 +125,9 @@ CC3Vector CC3SkinSection::getDeformedVertexLocationAt( GLuint vtxIdx )
 	CC3Vector restLoc = skinMesh->getVertexLocationAt( vtxIdx );
 	CC3Vector defLoc = CC3Vector::kCC3VectorZero;
 	
+	if ( m_pNode->shouldUseDualQuaternionSkinning() )
+		return getDualQuaternionDeformedLocation( restLoc, vtxIdx );
+
 	// Calc the weighted sum of the deformation contributed by each bone to this vertex.
 	// Iterate through the bones associated with this vertex.
 	GLuint vuCnt = skinMesh->getVertexBoneCount();
@@ -152,6 +155,32 @@ CC3Vector CC3SkinSection::getDeformedVertexLocationAt( GLuint vtxIdx )
 	return defLoc;
 }
 
+// Blends the dual quaternions of the bones influencing the vertex, and transforms the rest location
+// by the normalized result. The blend ignores zero weights, and flips the sign of any bone whose real
+// part lies in the opposite hemisphere, so that the blend takes the shortest path.
+CC3Vector CC3SkinSection::getDualQuaternionDeformedLocation( const CC3Vector& restLoc, GLuint vtxIdx )
+{
+	CC3Mesh* skinMesh = m_pNode->getMesh();
+
+	CC3DualQuaternion blendDQ;
+	CC3DualQuaternionPopulateZero( &blendDQ );
+
+	GLuint vuCnt = skinMesh->getVertexBoneCount();
+	for (GLuint vuIdx = 0; vuIdx < vuCnt; vuIdx++) 
+	{
+		GLfloat vtxWt = skinMesh->getVertexWeightForBoneInfluence( vuIdx, vtxIdx );
+		if ( vtxWt == 0.0f )
+			continue;
+
+		GLuint vtxBoneIdx = skinMesh->getVertexBoneIndexForBoneInfluence( vuIdx, vtxIdx );
+		CC3DualQuaternionAddWeighted( &blendDQ, getDualQuaternionForBoneAt( vtxBoneIdx ), vtxWt );
+	}
+
+	// A vertex with no effective weights collapses to the identity, leaving it undeformed.
+	CC3DualQuaternionNormalize( &blendDQ );
+	return CC3DualQuaternionTransformLocation( &blendDQ, restLoc );
+}
+
 void CC3SkinSection::init()
 { 
 	return initForNode( NULL ); 
@@ -237,4 +266,26 @@ CC3Matrix* CC3SkinSection::getTransformMatrixForBoneAt( GLuint boneIdx )
 	return ((CC3SkinnedBone*)(m_skinnedBones->objectAtIndex(boneIdx)))->getTransformMatrix();
 }
 
+const CC3DualQuaternion* CC3SkinSection::getDualQuaternionForBoneAt( GLuint boneIdx )
+{
+	return ((CC3SkinnedBone*)(m_skinnedBones->objectAtIndex(boneIdx)))->getDualQuaternion();
+}
+
+static GLuint _boneUniformVectorCount = 36;
+
+GLuint CC3SkinSection::getBoneUniformVectorCount()
+{
+	return _boneUniformVectorCount;
+}
+
+void CC3SkinSection::setBoneUniformVectorCount( GLuint vecCount )
+{
+	_boneUniformVectorCount = vecCount;
+}
+
+GLuint CC3SkinSection::getMaxBoneCount( bool isDualQuaternion )
+{
+	return _boneUniformVectorCount / (isDualQuaternion ? 2 : 3);
+}
+
 NS_COCOS3D_END
@@ -157,6 +157,9 @@ public:
 	 *
 	 * This implementation retrieves the vertex location from the mesh and transforms
 	 * it using the matrices and weights defined by the bones in this skin section. 
+	 *
+	 * If the skin mesh node is using dual-quaternion skinning, the dual quaternions of the bones
+	 * are blended and normalized instead, matching the deformation performed by the shader.
 	 */
 	CC3Vector					getDeformedVertexLocationAt( GLuint vtxIdx );
 
@@ -226,10 +229,44 @@ public:
 	 */
 	CC3Matrix*					getTransformMatrixForBoneAt( GLuint boneIdx );
 
+	/**
+	 * Returns the unit dual quaternion used by the bone at the specified index to influence the
+	 * vertices of the mesh in this skin section, when the skin mesh node is using dual-quaternion
+	 * skinning.
+	 *
+	 * The returned dual quaternion holds the rigid part of the matrix returned by the
+	 * getTransformMatrixForBoneAt method. See the notes of the getDualQuaternion method
+	 * of the CC3SkinnedBone class for more details.
+	 */
+	const CC3DualQuaternion*	getDualQuaternionForBoneAt( GLuint boneIdx );
+
+	/**
+	 * Returns the maximum number of bones that a single skin section can submit to a shader
+	 * in one draw call, given the bone uniform budget set by setBoneUniformVectorCount.
+	 *
+	 * Each bone consumes three vec4 uniforms when submitted as a 4x3 matrix, but only two when
+	 * submitted as a dual quaternion, so the dual-quaternion path allows 50% more bones per batch.
+	 */
+	static GLuint				getMaxBoneCount( bool isDualQuaternion );
+
+	/**
+	 * The number of vec4 uniforms available to a vertex shader for holding bone transforms.
+	 *
+	 * This is used by getMaxBoneCount, and in turn by CC3SkinMeshNode::mergeSkinSections, to
+	 * determine how many bones can be submitted to the shader in a single draw call.
+	 * The initial value is 36, which matches the 12 bone batches of the standard bone shaders,
+	 * and yields 18 bones per batch when using dual quaternions.
+	 */
+	static GLuint				getBoneUniformVectorCount();
+	static void					setBoneUniformVectorCount( GLuint vecCount );
+
 	virtual void				init();
 	void						populateFrom( CC3SkinSection* another );
 	CCObject*					copyWithZone( CCZone* zone );
 
+protected:
+	CC3Vector					getDualQuaternionDeformedLocation( const CC3Vector& restLoc, GLuint vtxIdx );
+
 protected:
 	CC3SkinMeshNode*			m_pNode;
 	CCArray*					m_skinnedBones;
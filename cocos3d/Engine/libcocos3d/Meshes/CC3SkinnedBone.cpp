@@ -36,6 +36,7 @@ CC3SkinnedBone::CC3SkinnedBone()
 	m_pSkinNode = NULL;
 	m_pBone = NULL;
 	m_transformMatrix = NULL;
+	m_isDualQuaternionDirty = true;
 }
 
 CC3SkinnedBone::~CC3SkinnedBone()
@@ -65,6 +66,7 @@ void CC3SkinnedBone::markTransformDirty()
 {
 	if ( m_transformMatrix )
 		m_transformMatrix->setIsDirty( true );
+	m_isDualQuaternionDirty = true;
 }
 
 CC3Matrix* CC3SkinnedBone::getTransformMatrix()
@@ -80,6 +82,18 @@ CC3Matrix* CC3SkinnedBone::getTransformMatrix()
 	return m_transformMatrix;
 }
 
+const CC3DualQuaternion* CC3SkinnedBone::getDualQuaternion()
+{
+	if ( m_isDualQuaternionDirty )
+	{
+		CC3Matrix4x3 mtx;
+		getTransformMatrix()->populateCC3Matrix4x3( &mtx );
+		CC3DualQuaternionPopulateFrom4x3( &m_dualQuaternion, &mtx );
+		m_isDualQuaternionDirty = false;
+	}
+	return &m_dualQuaternion;
+}
+
 // This will raise an assertion without a skin node or bone.
 void CC3SkinnedBone::init()
 {
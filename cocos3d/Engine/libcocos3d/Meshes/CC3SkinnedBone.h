@@ -94,6 +94,16 @@ public:
 	 */
 	CC3Matrix*					getTransformMatrix();
 
+	/**
+	 * Returns the rigid part of the transformMatrix property, expressed as a unit dual quaternion,
+	 * for use in dual-quaternion skinning.
+	 *
+	 * Like the transformMatrix, this is lazily recomputed the first time it is accessed after the
+	 * bone or skin mesh node has been transformed, so that it is computed once per skeleton update,
+	 * regardless of how many vertices, skin sections or shader uniforms make use of it.
+	 */
+	const CC3DualQuaternion*	getDualQuaternion();
+
 	/**
 	 * Marks the transform matrix as dirty.
 	 *
@@ -123,6 +133,8 @@ protected:
 	CC3SkinMeshNode*			m_pSkinNode;
 	CC3Bone*					m_pBone;
 	CC3Matrix*					m_transformMatrix;
+	CC3DualQuaternion			m_dualQuaternion;
+	bool						m_isDualQuaternionDirty : 1;
 };
 
 NS_COCOS3D_END
@@ -113,12 +113,124 @@ void CC3LightProbe::setDiffuseColor( const ccColor4F& aColor )
 {
 	m_diffuseColor = aColor;
 	super::setDiffuseColor(aColor);	// pass along to any descendant
+	lightProbeContentChanged();
 }
 
 void CC3LightProbe::initWithTag( GLuint aTag, const std::string& aName )
 {
 	super::initWithTag( aTag, aName );
 	m_diffuseColor = kCCC4FWhite;
+	m_sphericalHarmonicsAreDirty = true;
+	m_sphericalHarmonicsAreExplicit = false;
+}
+
+void CC3LightProbe::setTexture( CC3Texture* texture )
+{
+	super::setTexture( texture );
+	markSphericalHarmonicsDirty();
+}
+
+void CC3LightProbe::markSphericalHarmonicsDirty()
+{
+	m_sphericalHarmonicsAreDirty = true;
+	m_sphericalHarmonicsAreExplicit = false;
+	lightProbeContentChanged();
+}
+
+void CC3LightProbe::lightProbeContentChanged()
+{
+	CC3Scene* scene = getScene();
+	if ( scene )
+		scene->getLightProbeGrid()->markProbesChanged();
+}
+
+CC3SphericalHarmonics CC3LightProbe::getSphericalHarmonics()
+{
+	if ( m_sphericalHarmonicsAreDirty && !m_sphericalHarmonicsAreExplicit )
+	{
+		m_sphericalHarmonics = CC3SphericalHarmonics::kCC3SphericalHarmonicsZero;
+		CC3TextureCube* cube = dynamic_cast<CC3TextureCube*>( m_pTexture );
+		if ( !cube || !projectCubeTexture( cube, &m_sphericalHarmonics ) )
+			CC3_TRACE("CC3LightProbe %s could not project spherical harmonics from its texture", getName().c_str());
+		m_sphericalHarmonicsAreDirty = false;
+	}
+	return m_sphericalHarmonics;
+}
+
+void CC3LightProbe::setSphericalHarmonics( const CC3SphericalHarmonics& sh )
+{
+	m_sphericalHarmonics = sh;
+	m_sphericalHarmonicsAreDirty = false;
+	m_sphericalHarmonicsAreExplicit = true;
+	lightProbeContentChanged();
+}
+
+CC3SphericalHarmonics CC3LightProbe::getIrradianceHarmonics()
+{
+	CC3Vector rgb( m_diffuseColor.r, m_diffuseColor.g, m_diffuseColor.b );
+	return getSphericalHarmonics().convolveToIrradiance().scaleByColor( rgb );
+}
+
+/** Returns the number of unsigned byte components per pixel of the specified content, or zero if not bytes. */
+static GLuint CC3LightProbeComponentCount( CC3Texture2DContent* content )
+{
+	if (content->getPixelGLType() != GL_UNSIGNED_BYTE) 
+		return 0;
+
+	switch (content->getPixelGLFormat()) 
+	{
+		case GL_RGBA:				return 4;
+		case GL_RGB:				return 3;
+		case GL_LUMINANCE_ALPHA:	return 2;
+		case GL_LUMINANCE:
+		case GL_ALPHA:				return 1;
+		default:					return 0;
+	}
+}
+
+bool CC3LightProbe::projectCubeTexture( CC3TextureCube* texture, CC3SphericalHarmonics* sh )
+{
+	// Reload each face as it was uploaded, in the same orientation, but as plain bytes.
+	CC3STBImageLoadOptions options = CC3STBImageLoadOptionsDefault();
+	options.shouldFlipVertically = texture->shouldFlipVerticallyOnLoad();
+	options.shouldFlipHorizontally = texture->shouldFlipHorizontallyOnLoad();
+	options.shouldGenerateMipmaps = false;
+	options.pixelType = GL_UNSIGNED_BYTE;
+
+	CC3Texture2DContent* faces[6] = { NULL, NULL, NULL, NULL, NULL, NULL };
+	const GLubyte* faceData[6];
+	GLuint faceSize = 0;
+	GLuint compCount = 0;
+	bool wasLoaded = true;
+	for (GLuint faceIdx = 0; faceIdx < 6 && wasLoaded; faceIdx++) 
+	{
+		std::string filePath = texture->getCubeFaceFilePath( GL_TEXTURE_CUBE_MAP_POSITIVE_X + faceIdx );
+		faces[faceIdx] = new CC3Texture2DContent;
+		wasLoaded = !filePath.empty() && faces[faceIdx]->initFromFile( filePath, options );
+		if ( !wasLoaded )
+			break;
+
+		texture->checkTextureOrientation( faces[faceIdx] );
+
+		GLuint width = faces[faceIdx]->getPixelsWide();
+		GLuint height = faces[faceIdx]->getPixelsHigh();
+		GLuint faceComps = CC3LightProbeComponentCount( faces[faceIdx] );
+		if (faceIdx == 0) 
+		{
+			faceSize = width;
+			compCount = faceComps;
+		}
+		wasLoaded = (width == height && width == faceSize && faceComps == compCount && compCount > 0);
+		faceData[faceIdx] = (const GLubyte*)faces[faceIdx]->getImageData();
+	}
+
+	if ( wasLoaded )
+		*sh = CC3SphericalHarmonics::projectCubeFaces( faceData, faceSize, compCount );
+
+	for (GLuint faceIdx = 0; faceIdx < 6; faceIdx++) 
+		CC_SAFE_RELEASE( faces[faceIdx] );
+
+	return wasLoaded;
 }
 
 CC3LightProbe* CC3LightProbe::nodeWithTexture( CC3Texture* texture )
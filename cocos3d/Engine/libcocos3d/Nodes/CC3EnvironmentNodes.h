@@ -32,6 +32,8 @@
 
 NS_COCOS3D_BEGIN
 
+class CC3TextureCube;
+
 /**
  * CC3EnvironmentNode is an abstract superclass of a family of node classes that hold a 
  * texture that can be used as an environment map by other nodes.
@@ -55,7 +57,7 @@ public:
 	 * Typically, this texture is a cube-map, to provide a map in all six directions.
 	 */
 	CC3Texture*					getTexture();
-	void						setTexture( CC3Texture* texture );
+	virtual void				setTexture( CC3Texture* texture );
 
 	/** Initializes this instance with the specified name and environment texture. */
 	void						initWithName( const std::string& name, CC3Texture* texture );
@@ -87,6 +89,12 @@ protected:
 /**
  * CC3LightProbe is a type of light that uses a texture to define the
  * light intensity in any direction at the light's location.
+ *
+ * The lighting captured by a light probe can also be represented by third-order spherical
+ * harmonics, which are lazily projected on the CPU from the cube-map texture. Mesh nodes that
+ * use light probes blend the harmonics of the light probes nearest them, as found through the
+ * lightProbeGrid of the scene, and a shader can light a model from all of those light probes
+ * with a single kCC3SemanticLightProbeSH uniform.
  */
 class CC3LightProbe : public CC3EnvironmentNode 
 {
@@ -105,8 +113,45 @@ public:
 
 	static CC3LightProbe*		nodeWithTexture( CC3Texture* texture );
 
+	/** Overridden to mark the spherical harmonics of this light probe as needing to be recalculated. */
+	void						setTexture( CC3Texture* texture );
+
+	/**
+	 * The spherical harmonics describing the radiance arriving at this light probe from all directions.
+	 *
+	 * Unless set directly, this property is lazily projected from the texture on first access. The
+	 * texture must be a CC3TextureCube whose faces were loaded from files, which are reloaded into
+	 * application memory for the projection. If the harmonics cannot be projected from the texture,
+	 * this property holds zero harmonics, and should be set directly by the application.
+	 */
+	CC3SphericalHarmonics		getSphericalHarmonics();
+	void						setSphericalHarmonics( const CC3SphericalHarmonics& sh );
+
+	/**
+	 * Returns the spherical harmonics of this light probe, convolved for diffuse lighting and scaled
+	 * by the diffuseColor property. Evaluating the result in a surface normal gives the diffuse
+	 * lighting of a white surface with that normal.
+	 */
+	CC3SphericalHarmonics		getIrradianceHarmonics();
+
+	/** Marks the spherical harmonics as needing to be projected again from the texture on the next access. */
+	void						markSphericalHarmonicsDirty();
+
+	/**
+	 * Projects the six faces of the specified cube-map texture into spherical harmonics, by reloading
+	 * the files from which the faces were loaded. Returns whether the projection was successful.
+	 */
+	static bool					projectCubeTexture( CC3TextureCube* texture, CC3SphericalHarmonics* sh );
+
+protected:
+	/** Notifies the light probe grid of the scene that the content of this light probe has changed. */
+	void						lightProbeContentChanged();
+
 protected:
 	ccColor4F					m_diffuseColor;
+	CC3SphericalHarmonics		m_sphericalHarmonics;
+	bool						m_sphericalHarmonicsAreDirty : 1;
+	bool						m_sphericalHarmonicsAreExplicit : 1;
 };
 
 NS_COCOS3D_END
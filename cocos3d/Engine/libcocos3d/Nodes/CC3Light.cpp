@@ -36,12 +36,14 @@ CC3Light::CC3Light()
 	m_cameraShadowVolume = NULL;
 	m_shadowCastingVolume = NULL;
 	m_stencilledShadowPainter = NULL;
+	m_shadowMap = NULL;
 	m_shadows = NULL;
 }
 
 CC3Light::~CC3Light()
 {
 	cleanupShadows(); // Includes releasing the shadows array, camera shadow volume & shadow painter
+	setShadowMap( NULL );
 	returnLightIndex( m_lightIndex );
 }
 
@@ -221,6 +223,8 @@ void CC3Light::initWithTag( GLuint aTag, const std::string& aName, GLuint ltIndx
 		m_shadowCastingVolume = NULL;
 		m_cameraShadowVolume = NULL;
 		m_stencilledShadowPainter = NULL;
+		m_shadowMap = NULL;
+		m_shadowTechnique = kCC3ShadowTechniqueVolumes;
 		m_ambientColor = kCC3DefaultLightColorAmbient;
 		m_diffuseColor = kCC3DefaultLightColorDiffuse;
 		m_specularColor = kCC3DefaultLightColorSpecular;
@@ -335,6 +339,7 @@ void CC3Light::populateFrom( CC3Light* another )
 	m_isDirectionalOnly = another->isDirectionalOnly();
 	m_shouldCopyLightIndex = another->shouldCopyLightIndex();
 	m_shouldCastShadowsWhenInvisible = another->shouldCastShadowsWhenInvisible();
+	setShadowTechnique( another->getShadowTechnique() );
 }
 
 CCObject* CC3Light::copyWithZone( CCZone* zone )
@@ -544,6 +549,62 @@ void CC3Light::updateShadows()
 		CC3ShadowVolumeMeshNode* sv = (CC3ShadowVolumeMeshNode*)pObj;
         sv->updateShadow();
 	}
+
+	if ( isUsingShadowMap() )
+		m_shadowMap->updateWithCamera( getActiveCamera() );
+}
+
+CC3ShadowTechnique CC3Light::getShadowTechnique()
+{
+	return m_shadowTechnique;
+}
+
+/** Creates the shadow map when switching to it, and releases it when switching back to volumes. */
+void CC3Light::setShadowTechnique( CC3ShadowTechnique technique )
+{
+	m_shadowTechnique = technique;
+
+	if (m_shadowTechnique == kCC3ShadowTechniqueShadowMap)
+	{
+		if ( !m_shadowMap )
+			setShadowMap( CC3ShadowMap::shadowMapForLight( this ) );
+	}
+	else
+	{
+		setShadowMap( NULL );
+	}
+}
+
+bool CC3Light::isUsingShadowMap()
+{
+	return (m_shadowTechnique == kCC3ShadowTechniqueShadowMap) && (m_shadowMap != NULL);
+}
+
+CC3ShadowMap* CC3Light::getShadowMap()
+{
+	return m_shadowMap;
+}
+
+void CC3Light::setShadowMap( CC3ShadowMap* shadowMap )
+{
+	if (shadowMap == m_shadowMap)
+		return;
+
+	if ( m_shadowMap )
+		m_shadowMap->setLight( NULL );
+
+	CC_SAFE_RELEASE( m_shadowMap );
+	CC_SAFE_RETAIN( shadowMap );
+	m_shadowMap = shadowMap;
+
+	if ( m_shadowMap )
+		m_shadowMap->setLight( this );
+}
+
+void CC3Light::drawShadowMapWithVisitor( CC3Scene* scene, CC3NodeDrawingVisitor* visitor )
+{
+	if ( isUsingShadowMap() && (isVisible() || shouldCastShadowsWhenInvisible()) )
+		m_shadowMap->drawWithVisitor( scene, visitor );
 }
 
 CC3ShadowCastingVolume* CC3Light::getShadowCastingVolume()
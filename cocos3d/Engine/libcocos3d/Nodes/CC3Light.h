@@ -35,10 +35,17 @@ class CC3ShadowProtocol;
 class CC3ShadowCastingVolume;
 class CC3CameraShadowVolume;
 class CC3StencilledShadowPainterNode;
+class CC3ShadowMap;
 
 /** Constant indicating that the light is not directional. */
 static const GLfloat kCC3SpotCutoffNone = 180.0f;
 
+/** Enumeration of the techniques a light can use to cast shadows. */
+typedef enum {
+	kCC3ShadowTechniqueVolumes,			/**< Stencilled shadow volumes, built per caster. */
+	kCC3ShadowTechniqueShadowMap,		/**< Depth maps rendered from the light, cascaded for directional lights. */
+} CC3ShadowTechnique;
+
 /** Default ambient light color. */
 static const ccColor4F kCC3DefaultLightColorAmbient = { 0.0, 0.0, 0.0, 1.0 };
 
@@ -436,6 +443,45 @@ public:
 	/** Draws any shadows cast by this light. */
 	void						drawShadowsWithVisitor( CC3NodeDrawingVisitor* visitor );
 
+	/**
+	 * The technique used by this light to cast shadows.
+	 *
+	 * When set to kCC3ShadowTechniqueVolumes, shadows are cast by the CC3ShadowVolumeMeshNodes
+	 * added to the shadow-casting nodes, and drawn into the stencil buffer.
+	 *
+	 * When set to kCC3ShadowTechniqueShadowMap, each frame the nodes whose shouldCastShadows
+	 * property is set are rendered into the depth textures of the shadowMap property, and the
+	 * shaders are responsible for sampling those textures while drawing the shadow receivers.
+	 * Directional lights use cascaded maps, spot lights use a single perspective map, and
+	 * point lights do not cast shadow-mapped shadows.
+	 *
+	 * The initial value of this property is kCC3ShadowTechniqueVolumes.
+	 */
+	CC3ShadowTechnique			getShadowTechnique();
+	void						setShadowTechnique( CC3ShadowTechnique technique );
+
+	/** Returns whether this light is casting shadows using a shadow map. */
+	bool						isUsingShadowMap();
+
+	/**
+	 * The shadow map used by this light when the shadowTechnique property is set to
+	 * kCC3ShadowTechniqueShadowMap.
+	 *
+	 * If not set directly, this property is created automatically when the shadowTechnique
+	 * property is set to kCC3ShadowTechniqueShadowMap, and is released when the shadowTechnique
+	 * property is set back to kCC3ShadowTechniqueVolumes.
+	 */
+	CC3ShadowMap*				getShadowMap();
+	void						setShadowMap( CC3ShadowMap* shadowMap );
+
+	/**
+	 * Renders the shadow casters into the shadow map of this light, using the specified visitor,
+	 * if this light is using a shadow map, and is visible or casts shadows when invisible.
+	 *
+	 * This method is invoked automatically by the scene before the scene content is drawn.
+	 */
+	void						drawShadowMapWithVisitor( CC3Scene* scene, CC3NodeDrawingVisitor* visitor );
+
 	/**
 	 * A specialized bounding volume that encloses a volume that includes the camera
 	 * frustum plus the space between the camera frustum and this light.
@@ -712,6 +758,7 @@ protected:
 	CC3ShadowCastingVolume*		m_shadowCastingVolume;
 	CC3CameraShadowVolume*		m_cameraShadowVolume;
 	CC3StencilledShadowPainterNode* m_stencilledShadowPainter;
+	CC3ShadowMap*				m_shadowMap;
 	CCArray*					m_shadows;
 	ccColor4F					m_ambientColor;
 	ccColor4F					m_diffuseColor;
@@ -721,6 +768,7 @@ protected:
 	GLfloat						m_spotCutoffAngle;
 	GLfloat						m_shadowIntensityFactor;
 	GLuint						m_lightIndex;
+	CC3ShadowTechnique			m_shadowTechnique;
 	bool						m_isDirectionalOnly : 1;
 	bool						m_shouldCopyLightIndex : 1;
 	bool						m_shouldCastShadowsWhenInvisible : 1;
@@ -0,0 +1,333 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#include "cocos3d.h"
+
+NS_COCOS3D_BEGIN
+
+CC3LightProbeGrid::CC3LightProbeGrid()
+{
+	m_lightProbes = NULL;
+}
+
+CC3LightProbeGrid::~CC3LightProbeGrid()
+{
+	CC_SAFE_RELEASE( m_lightProbes );
+}
+
+bool CC3LightProbeGrid::init()
+{
+	m_lightProbes = NULL;
+	m_origin = CC3Vector::kCC3VectorZero;
+	m_cellCounts[0] = m_cellCounts[1] = m_cellCounts[2] = 0;
+	m_cellSize = 1.0f;
+	m_requestedCellSize = 0.0f;
+	m_blendCount = kCC3LightProbeGridDefaultBlendCount;
+	m_generation = 1;
+	m_isDirty = true;
+	return true;
+}
+
+CC3LightProbeGrid* CC3LightProbeGrid::grid()
+{
+	CC3LightProbeGrid* pGrid = new CC3LightProbeGrid;
+	pGrid->init();
+	pGrid->autorelease();
+
+	return pGrid;
+}
+
+CCArray* CC3LightProbeGrid::getLightProbes()
+{
+	return m_lightProbes;
+}
+
+void CC3LightProbeGrid::setLightProbes( CCArray* lightProbes )
+{
+	CC_SAFE_RETAIN( lightProbes );
+	CC_SAFE_RELEASE( m_lightProbes );
+	m_lightProbes = lightProbes;
+	markProbesDirty();
+}
+
+GLfloat CC3LightProbeGrid::getCellSize()
+{
+	return m_requestedCellSize;
+}
+
+void CC3LightProbeGrid::setCellSize( GLfloat cellSize )
+{
+	m_requestedCellSize = MAX( cellSize, 0.0f );
+	markProbesDirty();
+}
+
+GLuint CC3LightProbeGrid::getBlendCount()
+{
+	return m_blendCount;
+}
+
+void CC3LightProbeGrid::setBlendCount( GLuint blendCount )
+{
+	m_blendCount = CLAMP( blendCount, 1, kCC3LightProbeGridMaxBlendCount );
+	markProbesChanged();
+}
+
+GLuint CC3LightProbeGrid::getGeneration()
+{
+	if ( m_isDirty )
+		rebuild();
+	return m_generation;
+}
+
+void CC3LightProbeGrid::markProbesDirty()
+{
+	m_isDirty = true;
+}
+
+void CC3LightProbeGrid::markProbesChanged()
+{
+	m_generation++;
+}
+
+void CC3LightProbeGrid::updateProbeLocations()
+{
+	if ( m_isDirty || !m_lightProbes )
+		return;
+
+	GLuint probeCnt = (GLuint)m_lightProbes->count();
+	if (probeCnt != m_probeLocations.size()) 
+	{
+		markProbesDirty();
+		return;
+	}
+
+	for (GLuint i = 0; i < probeCnt; i++) 
+	{
+		CC3Node* lp = (CC3Node*)m_lightProbes->objectAtIndex( i );
+		if ( !lp->getGlobalLocation().equals( m_probeLocations[i] ) )
+		{
+			markProbesDirty();
+			return;
+		}
+	}
+}
+
+/**
+ * Sorts the light probes into cells, held as a compressed array: the light probes of cell c are
+ * the entries of m_cellProbes between m_cellStarts[c] and m_cellStarts[c + 1].
+ */
+void CC3LightProbeGrid::rebuild()
+{
+	m_isDirty = false;
+	m_generation++;
+
+	m_probeLocations.clear();
+	m_cellStarts.clear();
+	m_cellProbes.clear();
+	m_cellCounts[0] = m_cellCounts[1] = m_cellCounts[2] = 0;
+
+	GLuint probeCnt = m_lightProbes ? (GLuint)m_lightProbes->count() : 0;
+	if (probeCnt == 0) 
+		return;
+
+	CC3Box bounds = CC3Box::kCC3BoxNull;
+	m_probeLocations.reserve( probeCnt );
+	for (GLuint i = 0; i < probeCnt; i++) 
+	{
+		CC3Vector loc = ((CC3Node*)m_lightProbes->objectAtIndex( i ))->getGlobalLocation();
+		m_probeLocations.push_back( loc );
+		bounds = bounds.boxEngulfLocation( loc );
+	}
+
+	// Unless set explicitly, size the cells to hold about one light probe each. Flat or linear
+	// arrangements of light probes are given a nominal thickness, so the volume is not zero.
+	CC3Vector extent = bounds.getSize();
+	GLfloat maxExtent = MAX( MAX( extent.x, extent.y ), extent.z );
+	m_cellSize = m_requestedCellSize;
+	if (m_cellSize <= 0.0f) 
+	{
+		GLfloat minExtent = MAX( maxExtent / kCC3LightProbeGridMaxCellsPerAxis, 0.001f );
+		GLfloat volume = MAX( extent.x, minExtent ) * MAX( extent.y, minExtent ) * MAX( extent.z, minExtent );
+		m_cellSize = cbrtf( volume / probeCnt );
+	}
+	m_cellSize = MAX( m_cellSize, maxExtent / kCC3LightProbeGridMaxCellsPerAxis );
+	m_cellSize = MAX( m_cellSize, 0.001f );
+
+	m_origin = bounds.minimum;
+	m_cellCounts[0] = MIN( (GLint)(extent.x / m_cellSize) + 1, kCC3LightProbeGridMaxCellsPerAxis );
+	m_cellCounts[1] = MIN( (GLint)(extent.y / m_cellSize) + 1, kCC3LightProbeGridMaxCellsPerAxis );
+	m_cellCounts[2] = MIN( (GLint)(extent.z / m_cellSize) + 1, kCC3LightProbeGridMaxCellsPerAxis );
+	GLuint cellCnt = m_cellCounts[0] * m_cellCounts[1] * m_cellCounts[2];
+
+	// Count the light probes in each cell, convert the counts to start offsets, then fill.
+	std::vector<GLuint> probeCells( probeCnt );
+	m_cellStarts.assign( cellCnt + 1, 0 );
+	for (GLuint i = 0; i < probeCnt; i++) 
+	{
+		GLint cell[3];
+		getCellCoordinates( m_probeLocations[i], cell );
+		probeCells[i] = (cell[2] * m_cellCounts[1] + cell[1]) * m_cellCounts[0] + cell[0];
+		m_cellStarts[probeCells[i] + 1]++;
+	}
+	for (GLuint c = 0; c < cellCnt; c++) 
+		m_cellStarts[c + 1] += m_cellStarts[c];
+
+	std::vector<GLuint> fillPos( m_cellStarts.begin(), m_cellStarts.end() - 1 );
+	m_cellProbes.resize( probeCnt );
+	for (GLuint i = 0; i < probeCnt; i++) 
+		m_cellProbes[fillPos[probeCells[i]]++] = i;
+
+	CC3_TRACE("CC3LightProbeGrid indexed %d light probes in %d x %d x %d cells of size %.3f",
+			  probeCnt, m_cellCounts[0], m_cellCounts[1], m_cellCounts[2], m_cellSize);
+}
+
+void CC3LightProbeGrid::getCellCoordinates( const CC3Vector& location, GLint* cell )
+{
+	CC3Vector rel = (location - m_origin) * (1.0f / m_cellSize);
+	cell[0] = CLAMP( (GLint)floorf(rel.x), 0, m_cellCounts[0] - 1 );
+	cell[1] = CLAMP( (GLint)floorf(rel.y), 0, m_cellCounts[1] - 1 );
+	cell[2] = CLAMP( (GLint)floorf(rel.z), 0, m_cellCounts[2] - 1 );
+}
+
+/**
+ * Searches the cells in expanding shells around the cell containing the location. Every cell in
+ * the shell beyond ring r is at least r cells away along some axis, so once the list is full and
+ * its farthest entry is no farther than that, no unsearched light probe can be nearer.
+ */
+GLuint CC3LightProbeGrid::findNearestProbes( const CC3Vector& location, GLuint maxCount, bool visibleOnly,
+											 CC3LightProbe** probes, GLfloat* distancesSquared )
+{
+	if ( m_isDirty )
+		rebuild();
+
+	if (maxCount == 0 || m_probeLocations.empty()) 
+		return 0;
+
+	GLuint foundIdx[kCC3LightProbeGridMaxBlendCount * 4];
+	GLfloat foundDistSq[kCC3LightProbeGridMaxBlendCount * 4];
+	GLuint bufCount = MIN( maxCount, (GLuint)(kCC3LightProbeGridMaxBlendCount * 4) );
+	std::vector<GLuint> bigIdx;
+	std::vector<GLfloat> bigDistSq;
+	GLuint* bestIdx = foundIdx;
+	GLfloat* bestDistSq = foundDistSq;
+	if (maxCount > bufCount) 
+	{
+		bigIdx.resize( maxCount );
+		bigDistSq.resize( maxCount );
+		bestIdx = &bigIdx[0];
+		bestDistSq = &bigDistSq[0];
+	}
+
+	GLint center[3];
+	getCellCoordinates( location, center );
+	GLint maxRing = MAX( MAX( m_cellCounts[0], m_cellCounts[1] ), m_cellCounts[2] );
+
+	GLuint foundCnt = 0;
+	for (GLint ring = 0; ring < maxRing; ring++) 
+	{
+		for (GLint z = center[2] - ring; z <= center[2] + ring; z++) 
+		{
+			if (z < 0 || z >= m_cellCounts[2]) continue;
+			for (GLint y = center[1] - ring; y <= center[1] + ring; y++) 
+			{
+				if (y < 0 || y >= m_cellCounts[1]) continue;
+				bool isShellRow = (abs(z - center[2]) == ring || abs(y - center[1]) == ring);
+				GLint xStep = isShellRow ? 1 : MAX( 2 * ring, 1 );
+				for (GLint x = center[0] - ring; x <= center[0] + ring; x += xStep) 
+				{
+					if (x < 0 || x >= m_cellCounts[0]) continue;
+
+					GLuint cellIdx = (z * m_cellCounts[1] + y) * m_cellCounts[0] + x;
+					for (GLuint p = m_cellStarts[cellIdx]; p < m_cellStarts[cellIdx + 1]; p++) 
+					{
+						GLuint probeIdx = m_cellProbes[p];
+						if ( visibleOnly && !((CC3Node*)m_lightProbes->objectAtIndex( probeIdx ))->isVisible() )
+							continue;
+
+						GLfloat distSq = location.distanceSquared( m_probeLocations[probeIdx] );
+						if (foundCnt == maxCount && distSq >= bestDistSq[foundCnt - 1]) 
+							continue;
+
+						// Insert into the sorted list, dropping the farthest entry if full.
+						GLuint pos = (foundCnt < maxCount) ? foundCnt++ : foundCnt - 1;
+						while (pos > 0 && bestDistSq[pos - 1] > distSq) 
+						{
+							bestDistSq[pos] = bestDistSq[pos - 1];
+							bestIdx[pos] = bestIdx[pos - 1];
+							pos--;
+						}
+						bestDistSq[pos] = distSq;
+						bestIdx[pos] = probeIdx;
+					}
+				}
+			}
+		}
+
+		GLfloat shellDist = ring * m_cellSize;
+		if (foundCnt == maxCount && bestDistSq[foundCnt - 1] <= shellDist * shellDist) 
+			break;
+	}
+
+	for (GLuint i = 0; i < foundCnt; i++) 
+	{
+		probes[i] = (CC3LightProbe*)m_lightProbes->objectAtIndex( bestIdx[i] );
+		if (distancesSquared) 
+			distancesSquared[i] = bestDistSq[i];
+	}
+	return foundCnt;
+}
+
+CC3SphericalHarmonics CC3LightProbeGrid::getBlendedHarmonicsAt( const CC3Vector& location )
+{
+	CC3LightProbe* probes[kCC3LightProbeGridMaxBlendCount];
+	GLfloat distSq[kCC3LightProbeGridMaxBlendCount];
+	GLuint probeCnt = findNearestProbes( location, m_blendCount, true, probes, distSq );
+
+	CC3SphericalHarmonics sh;
+	if (probeCnt == 0) 
+		return sh;
+
+	// A location essentially at a light probe takes its lighting directly.
+	if (distSq[0] < 1.0e-6f) 
+		return probes[0]->getIrradianceHarmonics();
+
+	GLfloat weights[kCC3LightProbeGridMaxBlendCount];
+	GLfloat totalWeight = 0.0f;
+	for (GLuint i = 0; i < probeCnt; i++) 
+	{
+		weights[i] = 1.0f / distSq[i];
+		totalWeight += weights[i];
+	}
+	for (GLuint i = 0; i < probeCnt; i++) 
+		sh.addScaled( probes[i]->getIrradianceHarmonics(), weights[i] / totalWeight );
+
+	return sh;
+}
+
+NS_COCOS3D_END
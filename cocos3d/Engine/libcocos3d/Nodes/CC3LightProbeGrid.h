@@ -0,0 +1,153 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#ifndef _CC3_LIGHT_PROBE_GRID_H_
+#define _CC3_LIGHT_PROBE_GRID_H_
+
+NS_COCOS3D_BEGIN
+
+class CC3LightProbe;
+
+/** The maximum number of light probes that can be blended by a CC3LightProbeGrid. */
+#define kCC3LightProbeGridMaxBlendCount		8
+
+/** The default number of light probes blended by a CC3LightProbeGrid. */
+#define kCC3LightProbeGridDefaultBlendCount	4
+
+/** The maximum number of cells along each axis of a CC3LightProbeGrid. */
+#define kCC3LightProbeGridMaxCellsPerAxis	128
+
+/**
+ * CC3LightProbeGrid indexes the light probes of a scene in a uniform spatial grid, so that the
+ * light probes nearest any location can be found without examining every light probe.
+ *
+ * Each CC3Scene holds an instance in its lightProbeGrid property, which tracks the lightProbes
+ * of the scene automatically. The grid is rebuilt whenever a light probe is added, removed or
+ * moved, and the generation property changes whenever the grid is rebuilt, or the content of a
+ * light probe changes, so that values derived from the light probes can be cached.
+ *
+ * The getBlendedHarmonicsAt method blends the irradiance spherical harmonics of the visible
+ * light probes nearest a location, weighted by the inverse square of their distances. This is
+ * used by CC3MeshNode to light a model from the light probes that surround it.
+ */
+class CC3LightProbeGrid : public CCObject
+{
+public:
+	CC3LightProbeGrid();
+	virtual ~CC3LightProbeGrid();
+
+	/** The light probes indexed by this grid. The array is retained, and may change content. */
+	CCArray*					getLightProbes();
+	void						setLightProbes( CCArray* lightProbes );
+
+	/**
+	 * The edge length of each grid cell, in global coordinates. If this value is zero, the cell
+	 * size is chosen automatically to place about one light probe in each cell.
+	 *
+	 * The initial value of this property is zero.
+	 */
+	GLfloat						getCellSize();
+	void						setCellSize( GLfloat cellSize );
+
+	/**
+	 * The number of nearest light probes blended by the getBlendedHarmonicsAt method.
+	 * This value is clamped to kCC3LightProbeGridMaxBlendCount.
+	 *
+	 * The initial value of this property is kCC3LightProbeGridDefaultBlendCount.
+	 */
+	GLuint						getBlendCount();
+	void						setBlendCount( GLuint blendCount );
+
+	/**
+	 * A value that changes whenever the grid is rebuilt, or the content of a light probe has changed.
+	 * Values derived from the light probes may be cached until this value changes.
+	 */
+	GLuint						getGeneration();
+
+	/**
+	 * Marks this grid as needing to be rebuilt before the next query. This is invoked
+	 * automatically by the scene when a light probe is added or removed.
+	 */
+	void						markProbesDirty();
+
+	/**
+	 * Indicates that the content of a light probe has changed, without any light probe being added,
+	 * removed or moved. This is invoked automatically when the texture, spherical harmonics or
+	 * diffuse color of a light probe in the scene is changed.
+	 */
+	void						markProbesChanged();
+
+	/**
+	 * Checks whether any light probe has moved since the grid was built, and if so, marks this grid
+	 * as needing to be rebuilt. This is invoked automatically by the scene once per update.
+	 */
+	void						updateProbeLocations();
+
+	/**
+	 * Finds up to maxCount light probes nearest the specified global location, and populates the
+	 * specified arrays with the light probes, and the squares of their distances from the location,
+	 * ordered nearest first. If visibleOnly is YES, light probes that are not visible are ignored.
+	 * The distances array may be NULL. Returns the number of light probes found.
+	 */
+	GLuint						findNearestProbes( const CC3Vector& location, GLuint maxCount, bool visibleOnly,
+												   CC3LightProbe** probes, GLfloat* distancesSquared );
+
+	/**
+	 * Returns the irradiance spherical harmonics at the specified global location, blended from
+	 * those of the nearest visible light probes, weighted by the inverse square of their distances.
+	 * Returns zero harmonics if there are no visible light probes.
+	 */
+	CC3SphericalHarmonics		getBlendedHarmonicsAt( const CC3Vector& location );
+
+	virtual bool				init();
+	static CC3LightProbeGrid*	grid();
+
+protected:
+	/** Rebuilds the cells of this grid from the current locations of the light probes. */
+	void						rebuild();
+	/** Returns the index of the cell containing the specified location, clamped into the grid. */
+	void						getCellCoordinates( const CC3Vector& location, GLint* cell );
+
+protected:
+	CCArray*					m_lightProbes;
+	std::vector<CC3Vector>		m_probeLocations;
+	std::vector<GLuint>			m_cellStarts;
+	std::vector<GLuint>			m_cellProbes;
+	CC3Vector					m_origin;
+	GLint						m_cellCounts[3];
+	GLfloat						m_cellSize;
+	GLfloat						m_requestedCellSize;
+	GLuint						m_blendCount;
+	GLuint						m_generation;
+	bool						m_isDirty : 1;
+};
+
+NS_COCOS3D_END
+
+#endif
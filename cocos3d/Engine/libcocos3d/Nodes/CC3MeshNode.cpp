@@ -321,6 +321,24 @@ void CC3MeshNode::setShouldUseLightProbes( bool shouldUse )
 	super::setShouldUseLightProbes( shouldUse );	// pass along to any children
 }
 
+const CC3SphericalHarmonics& CC3MeshNode::getLightProbeHarmonics()
+{
+	CC3Scene* scene = getScene();
+	if ( !scene )
+		return CC3SphericalHarmonics::kCC3SphericalHarmonicsZero;
+
+	CC3LightProbeGrid* grid = scene->getLightProbeGrid();
+	GLuint gridGen = grid->getGeneration();
+	CC3Vector globalLoc = getGlobalLocation();
+	if (gridGen != m_lightProbeHarmonicsGeneration || !globalLoc.equals( m_lightProbeHarmonicsLocation )) 
+	{
+		m_lightProbeHarmonics = grid->getBlendedHarmonicsAt( globalLoc );
+		m_lightProbeHarmonicsLocation = globalLoc;
+		m_lightProbeHarmonicsGeneration = gridGen;
+	}
+	return m_lightProbeHarmonics;
+}
+
 ccColor4F CC3MeshNode::getAmbientColor()
 {
 	return getMaterial()->getAmbientColor(); 
@@ -717,6 +735,7 @@ void CC3MeshNode::initWithTag( GLuint aTag, const std::string& aName )
 	m_pShaderContext = NULL;
 	m_renderStreamGroupMarker = "";
 	m_shouldUseLightProbes = false;
+	m_lightProbeHarmonicsGeneration = 0;		// Grid generations start at one
 	m_shouldUseSmoothShading = true;
 	m_shouldCullBackFaces = true;
 	m_shouldCullFrontFaces = false;
@@ -1488,6 +1507,11 @@ bool CC3MeshNode::hasRigidSkeleton()
 	return false; 
 }
 
+bool CC3MeshNode::shouldUseDualQuaternionSkinning()
+{
+	return false; 
+}
+
 CC3Face CC3MeshNode::getDeformedFaceAt( GLuint faceIndex )
 {
 	return getFaceAt( faceIndex ); 
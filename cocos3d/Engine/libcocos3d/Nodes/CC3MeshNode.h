@@ -199,6 +199,15 @@ public:
 	virtual void				setShouldUseLightProbes( bool use );
 	virtual bool				shouldUseLightProbes();
 
+	/**
+	 * Returns the irradiance spherical harmonics at the global location of this mesh node, blended
+	 * from the light probes nearest this node, as found by the lightProbeGrid of the scene.
+	 *
+	 * The result is cached, and is recalculated only when this node moves, or the light probes
+	 * of the scene change. This is used to populate the kCC3SemanticLightProbeSH uniform.
+	 */
+	const CC3SphericalHarmonics& getLightProbeHarmonics();
+
 	/**
 	 * The ambient color of the material of this mesh node.
 	 *
@@ -1765,7 +1774,7 @@ public:
 	 * inside the mesh. Again,in most cases, you will be interested only in intersections that occur in
 	 * the direction the ray is pointing, and can ususally set this parameter to NO.
 	 */
-	GLuint						findFirst( GLuint maxHitCount, CC3MeshIntersection* intersectons, CC3Ray aRay, bool acceptBackFaces, bool acceptBehind );
+	virtual GLuint				findFirst( GLuint maxHitCount, CC3MeshIntersection* intersectons, CC3Ray aRay, bool acceptBackFaces, bool acceptBehind );
 
 	/**
 	 * Populates the specified array with information about the intersections of the specified ray
@@ -1830,6 +1839,15 @@ public:
 	 */
 	virtual bool				hasRigidSkeleton();
 
+	/**
+	 * Returns whether the vertices of this mesh node are deformed by blending the bones as unit
+	 * dual quaternions, instead of as weighted transform matrices.
+	 *
+	 * This implementation returns NO. The CC3SkinMeshNode subclass returns the value set by the
+	 * setShouldUseDualQuaternionSkinning method, which can be invoked on this node or any ancestor.
+	 */
+	virtual bool				shouldUseDualQuaternionSkinning();
+
 	/**
 	 * Returns the face from the mesh at the specified index.
 	 * 
@@ -2567,6 +2585,9 @@ protected:
 	GLfloat						m_decalOffsetUnits;
 	GLfloat						m_lineWidth;
 	GLenum						m_lineSmoothingHint;
+	CC3SphericalHarmonics		m_lightProbeHarmonics;
+	CC3Vector					m_lightProbeHarmonicsLocation;
+	GLuint						m_lightProbeHarmonicsGeneration;
 
 	CC3NormalScaling			m_normalScalingMethod : 4;
 	bool						m_shouldUseLightProbes : 1;
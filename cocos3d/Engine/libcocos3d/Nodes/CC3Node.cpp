@@ -4036,6 +4036,32 @@ void CC3Node::ensureRigidSkeleton()
 	}
 }
 
+void CC3Node::setShouldUseDualQuaternionSkinning( bool shouldUseDQ )
+{
+	CCObject* object;
+	CCARRAY_FOREACH( m_pChildren, object )
+	{
+		CC3Node* child = (CC3Node*)object;
+		if ( child )
+		{
+			child->setShouldUseDualQuaternionSkinning( shouldUseDQ );
+		}
+	}
+}
+
+void CC3Node::mergeSkinSections( GLuint maxBonesPerSection )
+{
+	CCObject* object;
+	CCARRAY_FOREACH( m_pChildren, object )
+	{
+		CC3Node* child = (CC3Node*)object;
+		if ( child )
+		{
+			child->mergeSkinSections( maxBonesPerSection );
+		}
+	}
+}
+
 CC3SoftBodyNode* CC3Node::getSoftBodyNode()
 {
 	return m_pParent->getSoftBodyNode(); 
@@ -4555,6 +4555,42 @@ public:
 	 */
 	virtual void				ensureRigidSkeleton();
 
+	/**
+	 * Sets whether descendant skinned mesh nodes should blend their bones as unit dual quaternions,
+	 * instead of as weighted transform matrices.
+	 *
+	 * Blending transform matrices linearly causes the familiar "candy-wrapper" collapse of the mesh
+	 * around joints that twist strongly, such as wrists and shoulders. Blending dual quaternions
+	 * preserves the volume of the mesh around such joints. In addition, each bone is submitted to
+	 * the shader as two vec4 uniforms instead of three, so more bones fit in each draw call.
+	 *
+	 * Dual quaternions encode only rotation and translation, so any scale in the bones is discarded.
+	 * This mode is therefore intended for skeletons that have been made rigid by the
+	 * ensureRigidSkeleton method.
+	 *
+	 * Setting this property affects the choice of shader that is selected automatically for the
+	 * skinned mesh nodes, the CPU-side deformation used for picking and deformed faces, and disables
+	 * the bone bounds used to cull ray tests against the deformed faces. Because shaders are selected
+	 * automatically when a node is first drawn, you should set this property before then.
+	 */
+	virtual void				setShouldUseDualQuaternionSkinning( bool shouldUseDQ );
+
+	/**
+	 * Merges adjacent skin sections of descendant skinned mesh nodes, as long as the merged
+	 * section is influenced by no more than the specified number of bones, and remaps the bone
+	 * indices of the affected vertices accordingly.
+	 *
+	 * Each skin section is drawn in a separate GL draw call. When bones are submitted to the shader
+	 * as dual quaternions, more bones fit in a single batch, and skin sections that were split to
+	 * fit the matrix palette can be merged to reduce the number of draw calls. Typically, you will
+	 * pass the value returned by CC3SkinSection::getMaxBoneCount( true ).
+	 *
+	 * The vertex bone indices content must still be available in memory when this method is invoked.
+	 * Sections whose vertices are shared with another section, and would need different bone indices,
+	 * are not merged.
+	 */
+	virtual void				mergeSkinSections( GLuint maxBonesPerSection );
+
 	/**
 	 * After copying a skin mesh node, the newly created copy will still be influenced
 	 * by the original skeleton. The result is that both the original mesh and the copy
@@ -82,6 +82,8 @@ GLuint CC3NodeDrawingVisitor::getCurrent2DTextureUnit()
 	switch (m_textureBindingMode) {
 		case kCC3TextureBindingModeLightProbe:
 			return m_currentLightProbeTextureUnit;
+		case kCC3TextureBindingModeShadowMap:
+			return m_currentShadowMapTextureUnit;
 		case kCC3TextureBindingModeModel:
 			return m_current2DTextureUnit;
 	}
@@ -95,6 +97,9 @@ void CC3NodeDrawingVisitor::increment2DTextureUnit()
 		case kCC3TextureBindingModeLightProbe:
 			m_currentLightProbeTextureUnit++;
 			break;
+		case kCC3TextureBindingModeShadowMap:
+			m_currentShadowMapTextureUnit++;
+			break;
 		case kCC3TextureBindingModeModel:
 			m_current2DTextureUnit++;
 			break;
@@ -106,6 +111,8 @@ GLuint CC3NodeDrawingVisitor::getCurrentCubeTextureUnit()
 	switch (m_textureBindingMode) {
 		case kCC3TextureBindingModeLightProbe:
 			return m_currentLightProbeTextureUnit;
+		case kCC3TextureBindingModeShadowMap:
+			return m_currentShadowMapTextureUnit;
 		case kCC3TextureBindingModeModel:
 			return m_currentCubeTextureUnit;
 	}
@@ -119,6 +126,9 @@ void CC3NodeDrawingVisitor::incrementCubeTextureUnit()
 		case kCC3TextureBindingModeLightProbe:
 			m_currentLightProbeTextureUnit++;
 			break;
+		case kCC3TextureBindingModeShadowMap:
+			m_currentShadowMapTextureUnit++;
+			break;
 		case kCC3TextureBindingModeModel:
 			m_currentCubeTextureUnit++;
 			break;
@@ -285,12 +295,14 @@ void CC3NodeDrawingVisitor::resetTextureUnits()
 	m_current2DTextureUnit = 0;
 	m_currentCubeTextureUnit = sp ? sp->getTextureCubeStart() : getTextureCount();
 	m_currentLightProbeTextureUnit = sp ? sp->getTextureLightProbeStart() : getTextureCount();
+	m_currentShadowMapTextureUnit = sp ? sp->getTextureShadowMapStart() : getTextureCount();
 	m_textureBindingMode = kCC3TextureBindingModeModel;
 }
 
 void CC3NodeDrawingVisitor::bindEnvironmentalTextures()
 {
 	bindLightProbeTextures();
+	bindShadowMapTextures();
 }
 
 /** Retrieve any light probe textures and bind them to the GL engine. */
@@ -308,6 +320,27 @@ void CC3NodeDrawingVisitor::bindLightProbeTextures()
 	m_textureBindingMode = kCC3TextureBindingModeModel;
 }
 
+/** Retrieve the depth textures of any shadow map cascades and bind them to the GL engine. */
+void CC3NodeDrawingVisitor::bindShadowMapTextures()
+{
+	CC3ShaderProgram* sp = getCurrentShaderProgram();
+	GLuint tuCnt = sp ? sp->getTextureShadowMapCount() : 0;
+	if ( !tuCnt )
+		return;
+
+	CC3ShadowMap* sm = getShadowMap();
+	if ( !sm )
+		return;
+
+	m_textureBindingMode = kCC3TextureBindingModeShadowMap;
+
+	tuCnt = MIN(tuCnt, sm->getActiveCascadeCount());
+	for (GLuint tuIdx = 0; tuIdx < tuCnt; tuIdx++)
+		sm->getDepthTextureAt( tuIdx )->drawWithVisitor( this );
+
+	m_textureBindingMode = kCC3TextureBindingModeModel;
+}
+
 void CC3NodeDrawingVisitor::disableUnusedTextureUnits()
 {
 	// Determine the maximum number of textures of each type that could be used
@@ -332,6 +365,11 @@ void CC3NodeDrawingVisitor::disableUnusedTextureUnits()
 	for (GLuint tuIdx = m_currentLightProbeTextureUnit; tuIdx < tuMax; tuIdx++)
 		gl->disableTexturingAt( tuIdx );
 	
+	// Disable remaining shadow map textures
+	tuMax = (sp ? (sp->getTextureShadowMapStart() + sp->getTextureShadowMapCount()) : tuMax);
+	for (GLuint tuIdx = m_currentShadowMapTextureUnit; tuIdx < tuMax; tuIdx++)
+		gl->disableTexturingAt( tuIdx );
+	
 	// Ensure remaining system texture units are disabled
 	gl->disableTexturingFrom( tuMax );
 }
@@ -644,6 +682,8 @@ void CC3NodeDrawingVisitor::init()
 	m_isDrawingEnvironmentMap = false;
 	m_currentCubeTextureUnit = 0;
 	m_current2DTextureUnit = 0;
+	m_currentLightProbeTextureUnit = 0;
+	m_currentShadowMapTextureUnit = 0;
 }
 
 std::string CC3NodeDrawingVisitor::fullDescription()
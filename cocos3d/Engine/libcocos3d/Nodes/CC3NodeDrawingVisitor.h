@@ -44,6 +44,7 @@ class CC3OpenGL;
 typedef enum {
 	kCC3TextureBindingModeModel,			/**< Binding model textures. */
 	kCC3TextureBindingModeLightProbe,		/**< Binding light probe textures. */
+	kCC3TextureBindingModeShadowMap,		/**< Binding shadow map textures. */
 } CC3TextureBindingMode;
 
 /**
@@ -132,7 +133,7 @@ public:
 	 */
 	void						resetTextureUnits();
 		
-	/** Binds environmental textures, such as light probes. */
+	/** Binds environmental textures, such as light probes and shadow maps. */
 	void						bindEnvironmentalTextures();
 
 	/** 
@@ -373,6 +374,9 @@ public:
 	/** Retrieve any light probe textures and bind them to the GL engine. */
 	void						bindLightProbeTextures();
 
+	/** Retrieve the depth textures of any shadow map cascades and bind them to the GL engine. */
+	void						bindShadowMapTextures();
+
 	void						setCamera( CC3Camera* camera );
 
 	/**
@@ -423,6 +427,7 @@ protected:
 	GLuint						m_current2DTextureUnit;
 	GLuint						m_currentCubeTextureUnit;
 	GLuint						m_currentLightProbeTextureUnit;
+	GLuint						m_currentShadowMapTextureUnit;
 	float						m_fDeltaTime;
 	bool						m_shouldDecorateNode : 1;
 	bool						m_isDrawingEnvironmentMap : 1;
@@ -34,6 +34,9 @@ NS_COCOS3D_BEGIN
 CC3NodeTransformListeners::CC3NodeTransformListeners()
 {
 	m_pNode = NULL;
+	m_notificationsRequested = 0;
+	m_notificationsSent = 0;
+	m_isNotificationPending = false;
 }
 
 CC3NodeTransformListeners::~CC3NodeTransformListeners()
@@ -84,6 +87,23 @@ void CC3NodeTransformListeners::removeAllTransformListeners()
 
 void CC3NodeTransformListeners::notifyTransformListeners()
 {
+	m_notificationsRequested++;
+
+	CC3NodeTransformNotificationQueue* pQueue = CC3NodeTransformNotificationQueue::sharedQueue();
+	if ( pQueue->shouldDeferNotifications() )
+		pQueue->queueListeners( this );
+	else
+		sendTransformNotifications();
+}
+
+void CC3NodeTransformListeners::sendTransformNotifications()
+{
+	// The node may have been deallocated while the notification was queued
+	if ( !m_pNode )
+		return;
+
+	m_notificationsSent++;
+
 	for (unsigned int i = 0; i < m_transformListenerWrappers.size(); i++)
 	{
 		CC3NodeTransformListenerProtocol* listener = m_transformListenerWrappers[i];
@@ -100,6 +120,40 @@ void CC3NodeTransformListeners::notifyDestructionListeners()
 		if ( listener )
 			listener->nodeWasDestroyed( m_pNode );
 	}
+
+	// Drop any queued notification, since the node is going away
+	m_pNode = NULL;
+}
+
+bool CC3NodeTransformListeners::isNotificationPending()
+{
+	return m_isNotificationPending;
+}
+
+void CC3NodeTransformListeners::setIsNotificationPending( bool isPending )
+{
+	m_isNotificationPending = isPending;
+}
+
+unsigned int CC3NodeTransformListeners::getNotificationsRequested()
+{
+	return m_notificationsRequested;
+}
+
+unsigned int CC3NodeTransformListeners::getNotificationsSent()
+{
+	return m_notificationsSent;
+}
+
+unsigned int CC3NodeTransformListeners::getNotificationsSaved()
+{
+	return m_notificationsRequested - m_notificationsSent;
+}
+
+void CC3NodeTransformListeners::resetNotificationStatistics()
+{
+	m_notificationsRequested = 0;
+	m_notificationsSent = 0;
 }
 
 void CC3NodeTransformListeners::initForNode( CC3Node* node )
@@ -116,4 +170,111 @@ CC3NodeTransformListeners* CC3NodeTransformListeners::listenersForNode( CC3Node*
 	return pListeners;
 }
 
+
+#pragma mark -
+#pragma mark CC3NodeTransformNotificationQueue
+
+static CC3NodeTransformNotificationQueue* _sharedQueue = NULL;
+
+CC3NodeTransformNotificationQueue* CC3NodeTransformNotificationQueue::sharedQueue()
+{
+	if ( !_sharedQueue )
+		_sharedQueue = new CC3NodeTransformNotificationQueue;		// retained
+
+	return _sharedQueue;
+}
+
+CC3NodeTransformNotificationQueue::CC3NodeTransformNotificationQueue()
+{
+	m_notificationsRequested = 0;
+	m_notificationsSent = 0;
+	m_shouldDeferNotifications = false;
+	m_isFlushing = false;
+}
+
+CC3NodeTransformNotificationQueue::~CC3NodeTransformNotificationQueue()
+{
+	for ( unsigned int i = 0; i < m_pending.size(); i++ )
+	{
+		m_pending[i]->setIsNotificationPending( false );
+		m_pending[i]->release();
+	}
+}
+
+bool CC3NodeTransformNotificationQueue::shouldDeferNotifications()
+{
+	return m_shouldDeferNotifications;
+}
+
+void CC3NodeTransformNotificationQueue::setShouldDeferNotifications( bool shouldDefer )
+{
+	m_shouldDeferNotifications = shouldDefer;
+	if ( !shouldDefer )
+		flush();
+}
+
+void CC3NodeTransformNotificationQueue::queueListeners( CC3NodeTransformListeners* listeners )
+{
+	m_notificationsRequested++;
+
+	if ( listeners->isNotificationPending() )
+		return;
+
+	listeners->setIsNotificationPending( true );
+	listeners->retain();		// Keep alive even if the node releases it before the flush
+	m_pending.push_back( listeners );
+}
+
+void CC3NodeTransformNotificationQueue::flush()
+{
+	// A listener may flush indirectly while being notified. The outer loop picks up the rest.
+	if ( m_isFlushing )
+		return;
+
+	m_isFlushing = true;
+
+	// Notifications may queue more listeners, which are appended and notified in this same pass.
+	for ( unsigned int i = 0; i < m_pending.size(); i++ )
+	{
+		CC3NodeTransformListeners* listeners = m_pending[i];
+		listeners->setIsNotificationPending( false );
+
+		unsigned int sentBefore = listeners->getNotificationsSent();
+		listeners->sendTransformNotifications();
+		m_notificationsSent += listeners->getNotificationsSent() - sentBefore;
+	}
+
+	for ( unsigned int i = 0; i < m_pending.size(); i++ )
+		m_pending[i]->release();
+
+	m_pending.clear();
+	m_isFlushing = false;
+}
+
+unsigned int CC3NodeTransformNotificationQueue::getPendingCount()
+{
+	return m_pending.size();
+}
+
+unsigned int CC3NodeTransformNotificationQueue::getNotificationsRequested()
+{
+	return m_notificationsRequested;
+}
+
+unsigned int CC3NodeTransformNotificationQueue::getNotificationsSent()
+{
+	return m_notificationsSent;
+}
+
+unsigned int CC3NodeTransformNotificationQueue::getNotificationsSaved()
+{
+	return m_notificationsRequested - m_notificationsSent;
+}
+
+void CC3NodeTransformNotificationQueue::resetStatistics()
+{
+	m_notificationsRequested = 0;
+	m_notificationsSent = 0;
+}
+
 NS_COCOS3D_END
@@ -127,12 +127,40 @@ public:
 	/** Removes all transform listeners. */
 	void						removeAllTransformListeners();
 
-	/** Notify the transform listeners that the node has been transformed. */
+	/**
+	 * Notify the transform listeners that the node has been transformed.
+	 *
+	 * If the shared CC3NodeTransformNotificationQueue is deferring notifications, the listeners
+	 * are not notified immediately. Instead, this instance is queued once, and any further
+	 * notifications requested before the queue is flushed are coalesced into that one.
+	 */
 	void						notifyTransformListeners();
 
-	/** Notify the transform listeners that the node has been destroyed. */
+	/** Sends the nodeWasTransformed: notification to each listener immediately. */
+	void						sendTransformNotifications();
+
+	/** 
+	 * Notify the transform listeners that the node has been destroyed. 
+	 * Any queued transform notification for the node is dropped.
+	 */
 	void						notifyDestructionListeners();
 
+	/** Returns whether a transform notification is waiting in the notification queue. */
+	bool						isNotificationPending();
+	void						setIsNotificationPending( bool isPending );
+
+	/** Returns the number of times the node has requested that its listeners be notified. */
+	unsigned int				getNotificationsRequested();
+
+	/** Returns the number of times the listeners have actually been notified. */
+	unsigned int				getNotificationsSent();
+
+	/** Returns the number of notifications that were coalesced away while deferring. */
+	unsigned int				getNotificationsSaved();
+
+	/** Resets the notification statistics to zero. */
+	void						resetNotificationStatistics();
+
 	/** Initializes this instance to track transform listeners for the specified node. */
 	void						initForNode( CC3Node* node );
 
@@ -141,9 +169,79 @@ public:
 protected:
 	CC3Node*					m_pNode;
 	TransformListenerList       m_transformListenerWrappers;
+	unsigned int				m_notificationsRequested;
+	unsigned int				m_notificationsSent;
+	bool						m_isNotificationPending : 1;
 //	pthread_mutex_t				m_mutex;
 };
 
+/**
+ * CC3NodeTransformNotificationQueue coalesces transform notifications within a frame.
+ *
+ * When a node high in a hierarchy moves, such as the root of a skeleton, each bone, camera
+ * target, shadow volume and bounding volume listening to nodes below it may be notified
+ * several times within a frame, as the nodes are moved, rebuilt and moved again. When this
+ * queue is deferring notifications, each node with listeners is instead queued once, and its
+ * listeners are notified once, when the queue is flushed.
+ *
+ * The queue is flushed when the CC3NodeUpdatingVisitor opens and closes, and by the CC3Scene
+ * before shadows are updated and before the scene is drawn. Nodes are flushed in the order
+ * they were first queued. A listener that changes its own transform while being notified
+ * queues its own listeners behind it, so dependents are always notified after the nodes they
+ * depend on, within the same flush.
+ *
+ * Since listeners generally respond to a notification by marking their own transforms as
+ * dirty, and transforms are rebuilt lazily, the state observed after a flush is the same as
+ * when each notification is sent immediately.
+ *
+ * The initial value of the shouldDeferNotifications property is NO, so that listeners are
+ * notified immediately, as they have always been.
+ */
+class CC3NodeTransformNotificationQueue : public CCObject
+{
+public:
+	CC3NodeTransformNotificationQueue();
+	virtual ~CC3NodeTransformNotificationQueue();
+
+	/**
+	 * Indicates whether transform notifications are deferred until this queue is flushed.
+	 * Turning this property off flushes any queued notifications.
+	 */
+	bool						shouldDeferNotifications();
+	void						setShouldDeferNotifications( bool shouldDefer );
+
+	/** Queues the specified listeners for notification, unless they are queued already. */
+	void						queueListeners( CC3NodeTransformListeners* listeners );
+
+	/** Notifies the queued listeners, in the order they were queued, until the queue is empty. */
+	void						flush();
+
+	/** Returns the number of listener collections waiting to be notified. */
+	unsigned int				getPendingCount();
+
+	/** Returns the number of notifications requested by nodes while deferring. */
+	unsigned int				getNotificationsRequested();
+
+	/** Returns the number of notifications sent by flushing this queue. */
+	unsigned int				getNotificationsSent();
+
+	/** Returns the number of notifications that were coalesced away. */
+	unsigned int				getNotificationsSaved();
+
+	/** Resets the notification statistics to zero. */
+	void						resetStatistics();
+
+	/** Returns the singleton queue instance. */
+	static CC3NodeTransformNotificationQueue* sharedQueue();
+
+protected:
+	std::vector<CC3NodeTransformListeners*>	m_pending;		// retained
+	unsigned int				m_notificationsRequested;
+	unsigned int				m_notificationsSent;
+	bool						m_shouldDeferNotifications : 1;
+	bool						m_isFlushing : 1;
+};
+
 
 NS_COCOS3D_END
 
@@ -50,6 +50,18 @@ void CC3NodeUpdatingVisitor::processAfterChildren( CC3Node* aNode )
 	super::processAfterChildren( aNode );
 }
 
+void CC3NodeUpdatingVisitor::open()
+{
+	super::open();
+	CC3NodeTransformNotificationQueue::sharedQueue()->flush();
+}
+
+void CC3NodeUpdatingVisitor::close()
+{
+	CC3NodeTransformNotificationQueue::sharedQueue()->flush();
+	super::close();
+}
+
 std::string CC3NodeUpdatingVisitor::fullDescription()
 {
 	/*return [NSString stringWithFormat: @"%@, dt: %.3f ms",
@@ -58,6 +58,12 @@ public:
 	virtual void				processAfterChildren( CC3Node* aNode );
 	std::string					fullDescription();
 
+	/** Flushes transform notifications deferred before this update, so dependents are rebuilt during it. */
+	virtual void				open();
+
+	/** Flushes transform notifications deferred during this update. */
+	virtual void				close();
+
 protected:
 	float						m_fDeltaTime;
 };
@@ -37,6 +37,8 @@ CC3NodeVisitor::CC3NodeVisitor()
 	m_pendingRemovals = NULL;
 	m_pCamera = NULL;
 	m_pStartingNode = NULL;
+	m_pNearestProbesNode = NULL;
+	m_nearestProbesGeneration = 0;
 }
 
 CC3NodeVisitor::~CC3NodeVisitor()
@@ -54,6 +56,8 @@ void CC3NodeVisitor::init()
     m_pCamera = NULL;
     m_pendingRemovals = NULL;
     m_shouldVisitChildren = true;
+    m_pNearestProbesNode = NULL;
+    m_nearestProbesGeneration = 0;
 }
 
 CC3NodeVisitor* CC3NodeVisitor::visitor()
@@ -338,10 +342,54 @@ GLuint CC3NodeVisitor::getLightProbeCount()
 
 CC3LightProbe* CC3NodeVisitor::getLightProbeAt( GLuint index )
 {
-	CCArray* lps = getScene()->getLightProbes();
-	if (index < lps->count())
-		return (CC3LightProbe*)lps->objectAtIndex( index );
-	
+	if ( !m_pCurrentNode )
+	{
+		CCArray* lps = getScene()->getLightProbes();
+		if (index < lps->count())
+			return (CC3LightProbe*)lps->objectAtIndex( index );
+		return NULL;
+	}
+
+	updateNearestLightProbes( MAX(getLightProbeCount(), index + 1) );
+	if (index < m_nearestProbes.size())
+		return m_nearestProbes[index];
+
+	return NULL;
+}
+
+/**
+ * The nearest light probes are cached against the current node, its location, and the generation
+ * of the light probe grid, because shader uniforms request the light probes one index at a time.
+ */
+void CC3NodeVisitor::updateNearestLightProbes( GLuint minCount )
+{
+	CC3LightProbeGrid* grid = getScene()->getLightProbeGrid();
+	GLuint gridGen = grid->getGeneration();
+	GLuint lpCnt = MIN(minCount, (GLuint)grid->getLightProbes()->count());
+	CC3Vector nodeLoc = m_pCurrentNode->getGlobalLocation();
+	if (m_pCurrentNode == m_pNearestProbesNode && gridGen == m_nearestProbesGeneration &&
+		lpCnt <= m_nearestProbes.size() && nodeLoc.equals( m_nearestProbesLocation )) 
+		return;
+
+	m_nearestProbes.resize( lpCnt );
+	if (lpCnt > 0) 
+		lpCnt = grid->findNearestProbes( nodeLoc, lpCnt, false, &m_nearestProbes[0], NULL );
+	m_nearestProbes.resize( lpCnt );
+
+	m_pNearestProbesNode = m_pCurrentNode;
+	m_nearestProbesLocation = nodeLoc;
+	m_nearestProbesGeneration = gridGen;
+}
+
+CC3ShadowMap* CC3NodeVisitor::getShadowMap()
+{
+	CCObject* pObj = NULL;
+	CCARRAY_FOREACH( getScene()->getLights(), pObj )
+	{
+		CC3Light* lgt = (CC3Light*)pObj;
+		if ( lgt->isUsingShadowMap() && (lgt->isVisible() || lgt->shouldCastShadowsWhenInvisible()) )
+			return lgt->getShadowMap();
+	}
 	return NULL;
 }
 
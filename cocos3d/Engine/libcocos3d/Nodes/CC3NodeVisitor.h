@@ -36,6 +36,7 @@ class CC3MeshNode;
 class CC3Camera;
 class CC3Light;
 class CC3LightProbe;
+class CC3ShadowMap;
 class CC3ShaderProgram;
 class CC3Material;
 class CC3TextureUnit;
@@ -226,10 +227,18 @@ public:
 	 * Returns the light probe indicated by the index, or nil if the specified index is 
 	 * greater than the number of light probes currently existing in the scene.
 	 *
-	 * The specified index is an index into the lightProbes array of the scene.
+	 * The light probes are ordered by their distance from the current node, nearest first, as
+	 * found by the lightProbeGrid of the scene, so that a shader that uses fewer light probes
+	 * than exist in the scene is given the light probes nearest the model being drawn.
 	 */
 	CC3LightProbe*				getLightProbeAt( GLuint index );
 
+	/**
+	 * Returns the shadow map of the first light in the scene that is visible and is casting
+	 * shadows using a shadow map, or nil if no light is using a shadow map.
+	 */
+	CC3ShadowMap*				getShadowMap();
+
 	/**
 	 * The performanceStatistics being accumulated during the visitation runs.
 	 *
@@ -304,11 +313,19 @@ public:
     
 	void						init();
 
+protected:
+	/** Finds at least the specified number of light probes nearest the current node, unless already cached. */
+	void						updateNearestLightProbes( GLuint minCount );
+
 protected:
 	CC3Node*					m_pStartingNode;
 	CC3Node*					m_pCurrentNode;
 	CC3Camera*					m_pCamera;
 	CCArray*					m_pendingRemovals;
+	std::vector<CC3LightProbe*>	m_nearestProbes;
+	CC3Node*					m_pNearestProbesNode;
+	CC3Vector					m_nearestProbesLocation;
+	GLuint						m_nearestProbesGeneration;
 	bool						m_shouldVisitChildren : 1;
 };
 
@@ -580,6 +580,10 @@ void CC3OpenGL::setStencilMask( GLuint mask )
 
 void CC3OpenGL::setOpOnStencilFail( GLenum sFail, GLenum dFail, GLenum dPass )
 {
+	// stencils drawn by clipping nodes may be overwritten from now on
+	if ( sFail != GL_KEEP || dFail != GL_KEEP || dPass != GL_KEEP )
+		CCClippingNode::notifyStencilBufferWritten();
+
 	if ((sFail != value_GL_STENCIL_FAIL) ||
 		(dFail != value_GL_STENCIL_PASS_DEPTH_FAIL) ||
 		(dPass != value_GL_STENCIL_PASS_DEPTH_PASS) ||
@@ -1136,6 +1140,9 @@ bool CC3OpenGL::checkFramebufferStatus( GLuint fbID )
 
 void CC3OpenGL::clearBuffers( GLbitfield mask )
 {
+	if ( mask & GL_STENCIL_BUFFER_BIT )
+		CCClippingNode::notifyStencilBufferWritten();
+
 	glClear(mask);
 	
 	CHECK_GL_ERROR_DEBUG();
@@ -1334,12 +1341,9 @@ GLfloat CC3OpenGL::getFragmentShaderVarPrecision( GLenum precisionType )
 /** Returns the specified extension name, stripped of any optional GL_ prefix. */
 std::string CC3OpenGL::trimGLPrefix( const char* extensionName )
 {
-	CCAssert( false, "trimGLPrefix is not implemented" );
+	std::string extName = extensionName ? extensionName : "";
 	std::string extPfx = "GL_";
-	/*return ([extensionName hasPrefix: extPfx]
-	? [extensionName substringFromIndex: extPfx.length]
-	: extensionName);*/
-	return extPfx;
+	return (extName.compare( 0, extPfx.length(), extPfx ) == 0) ? extName.substr( extPfx.length() ) : extName;
 }
 
 CCSet* CC3OpenGL::getExtensions()
@@ -1362,11 +1366,11 @@ CCSet* CC3OpenGL::getExtensions()
 	return _extensions;
 }
 
+/** Searches the space-separated GL_EXTENSIONS string for the whole extension name. */
 bool CC3OpenGL::supportsExtension( const char* extensionName )
 {
-	CCAssert( false, "supportsExtension is not implemented" );
-	//return [_extensions containsObject: [self trimGLPrefix: extensionName]];
-	return true;
+	std::string extName = " GL_" + trimGLPrefix( extensionName ) + " ";
+	return value_GL_EXTENSIONS.find( extName ) != std::string::npos;
 }
 
 CC3ShaderPrewarmer* CC3OpenGL::getShaderProgramPrewarmer()
@@ -1734,6 +1738,9 @@ void CC3OpenGL::initTextureUnits()
 /** Performs any required initialization for GL extensions supported by this platform. */
 void CC3OpenGL::initExtensions()
 {
+	// Pad with spaces, so that each extension name can be matched whole
+	value_GL_EXTENSIONS = " " + getString( GL_EXTENSIONS ) + " ";
+
 	//LogInfoIfPrimary(@"GL extensions supported by this platform: %@", self.extensionsDescription);
 }
 
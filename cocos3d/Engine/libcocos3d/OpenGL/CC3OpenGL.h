@@ -954,8 +954,8 @@ public:
 	 * (eg. both @"OES_packed_depth_stencil" and @"GL_OES_packed_depth_stencil" will work if
 	 * that extension is supported).
 	 *
-	 * This method checks the extensions collection for the presence of the specified name.
-	 * Although this is an optimized hash test, you should generally not use this test in 
+	 * This method searches the GL_EXTENSIONS string, retrieved once when this instance is
+	 * initialized, for the specified name. You should generally not use this test in 
 	 * time-critical code. If you need to frequently test for the presence of an extension
 	 * (for example, within the render loop), you should invoke this method once at the 
 	 * beginning of your app, and cache the resulting boolean value elsewhere in your code.
@@ -1306,6 +1306,7 @@ public:
 	std::string					 value_GL_VENDOR;
 	std::string					 value_GL_RENDERER;
 	std::string					 value_GL_VERSION;
+	std::string					 value_GL_EXTENSIONS;
 	
 	CC3VertexAttr*				vertexAttributes;
 	GLuint						value_MaxVertexAttribsUsed;
@@ -470,6 +470,32 @@ size_t CC3GLElementTypeSize(GLenum dataType)
 	}	
 }
 
+GLuint CC3TexelSizeFromFormatAndType(GLenum pixelFormat, GLenum pixelType)
+{
+	switch (pixelType) {
+		case GL_UNSIGNED_SHORT_4_4_4_4:
+		case GL_UNSIGNED_SHORT_5_5_5_1:
+		case GL_UNSIGNED_SHORT_5_6_5:
+			return 2;
+		case GL_UNSIGNED_INT:
+			return 4;
+		case GL_UNSIGNED_SHORT:
+			return 2;
+	}
+
+	// Pixel type at this point is GL_UNSIGNED_BYTE, so size is determined by component count.
+	switch (pixelFormat) {
+		case GL_RGBA: return 4;
+		case GL_RGB: return 3;
+		case GL_LUMINANCE_ALPHA: return 2;
+		case GL_LUMINANCE:
+		case GL_ALPHA:
+			return 1;
+		case GL_DEPTH_COMPONENT: return 4;
+		default: return 0;
+	}
+}
+
 GLenum CC3GLColorFormatFromBitPlanes(GLint colorCount, GLint alphaCount) 
 {
 	//LogTrace(@"Color buffer size: %i, alpha size: %i", colorCount, alphaCount);
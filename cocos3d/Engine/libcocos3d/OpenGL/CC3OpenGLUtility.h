@@ -55,6 +55,12 @@ std::string CC3GLEnumName(GLenum gle);
  */
 size_t CC3GLElementTypeSize(GLenum dataType);
 
+/**
+ * Returns the number of bytes occupied by a single texel of the specified uncompressed
+ * GL pixel format and type, or zero if the combination is not recognized.
+ */
+GLuint CC3TexelSizeFromFormatAndType(GLenum pixelFormat, GLenum pixelType);
+
 /** Returns the GL color format enum corresponding to the specified number of color and alpha bit planes. */
 GLenum CC3GLColorFormatFromBitPlanes(GLint colorCount, GLint alphaCount);
 
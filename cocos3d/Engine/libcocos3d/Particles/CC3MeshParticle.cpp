@@ -557,6 +557,63 @@ void CC3MeshParticle::transformVertexColors()
 	m_isColorDirty = false;
 }
 
+bool CC3MeshParticle::populateTransformJob( CC3MeshParticleTransformJob* job )
+{
+	job->firstVertex = m_firstVertexOffset;
+	job->vertexCount = getVertexCount();
+	job->shouldTransformLocations = m_isTransformDirty;
+	job->shouldTransformNormals = false;
+	job->shouldUpdateColors = m_isColorDirty;
+
+	if (m_isTransformDirty) 
+	{
+		CC3VertexLocations* tmplLocs = m_pTemplateMesh ? m_pTemplateMesh->getVertexLocations() : NULL;
+		if ( !tmplLocs || !tmplLocs->getVertices() || tmplLocs->getElementType() != GL_FLOAT || tmplLocs->getElementSize() < 3 )
+			return false;
+
+		job->srcLocations = (const GLubyte*)tmplLocs->getVertices() + tmplLocs->getElementOffset();
+		job->srcLocationStride = tmplLocs->getVertexStride();
+		job->srcLocationSize = tmplLocs->getElementSize();
+		job->isTranslationOnly = doesUseTranslationOnly();
+
+		if (job->isTranslationOnly) 
+		{
+			job->translation = m_location;
+		} 
+		else
+		{
+			applyLocalTransformsTo( &job->transform );
+
+			if ( hasVertexNormals() )
+			{
+				CC3VertexNormals* tmplNorms = m_pTemplateMesh->getVertexNormals();
+				if ( !tmplNorms || !tmplNorms->getVertices() || tmplNorms->getElementType() != GL_FLOAT )
+					return false;
+
+				job->shouldTransformNormals = true;
+				job->srcNormals = (const GLubyte*)tmplNorms->getVertices() + tmplNorms->getElementOffset();
+				job->srcNormalStride = tmplNorms->getVertexStride();
+
+				// Matches the transformDirection behaviour of the rotator and its rotation matrix.
+				CC3Matrix* rotMtx = m_pRotator->isMutable() ? m_pRotator->getRotationMatrix() : NULL;
+				job->isNormalTransformIdentity = !rotMtx || rotMtx->isIdentity();
+				if ( !job->isNormalTransformIdentity )
+					rotMtx->populateCC3Matrix3x3( &job->normalTransform );
+			}
+		}
+	}
+
+	if (m_isColorDirty) 
+	{
+		job->color4F = getColor4F();
+		job->color4B = getColor4B();
+	}
+
+	m_isTransformDirty = false;
+	m_isColorDirty = false;
+	return true;
+}
+
 CC3Vector CC3MeshParticle::getVertexLocationAt( GLuint vtxIndex )
 {
 	return getEmitter()->getVertexLocationAt( m_firstVertexOffset + vtxIndex );
@@ -39,6 +39,33 @@ class CC3MutableRotator;
 class CC3DirectionalRotator;
 class CC3TargettingRotator;
 
+/**
+ * Describes the work required to transform the vertices of a single mesh particle, as collected
+ * by a CC3MeshParticleEmitter for its batched transform stage. The source pointers reference the
+ * first vertex of the template mesh content, and the destination vertices are identified by
+ * their offset within the vertex content of the emitter mesh.
+ */
+typedef struct
+{
+	GLuint				firstVertex;				/**< The offset of the first vertex of the particle in the emitter mesh. */
+	GLuint				vertexCount;				/**< The number of vertices in the particle. */
+	const GLubyte*		srcLocations;				/**< The first template vertex location. */
+	GLuint				srcLocationStride;			/**< The stride between template vertex locations. */
+	GLuint				srcLocationSize;			/**< The number of components (3 or 4) of each template location. */
+	const GLubyte*		srcNormals;					/**< The first template vertex normal. */
+	GLuint				srcNormalStride;			/**< The stride between template vertex normals. */
+	CC3Matrix4x3		transform;					/**< The full transform of the particle. */
+	CC3Matrix3x3		normalTransform;			/**< The rotation applied to the normals. */
+	CC3Vector			translation;				/**< The location of the particle, for translation-only transforms. */
+	ccColor4F			color4F;					/**< The particle color, for float vertex colors. */
+	ccColor4B			color4B;					/**< The particle color, for byte vertex colors. */
+	bool				shouldTransformLocations;	/**< Whether the vertex locations must be rewritten. */
+	bool				isTranslationOnly;			/**< Whether the locations are simply offset by the translation. */
+	bool				shouldTransformNormals;		/**< Whether the vertex normals must be rewritten. */
+	bool				isNormalTransformIdentity;	/**< Whether the normals are copied unrotated. */
+	bool				shouldUpdateColors;			/**< Whether the vertex colors must be rewritten. */
+} CC3MeshParticleTransformJob;
+
 /**
  * CC3MeshParticleProtocol defines the requirements for mesh particles that are emitted
  * and managed by the CC3MeshParticleEmitter class.
@@ -663,6 +690,21 @@ public:
 	 */
 	void						transformVertexColors();
 
+	/**
+	 * Populates the specified job with the template vertex content, and the current transform and color
+	 * of this particle, so that the emitter can transform the vertices of this particle in a batch with
+	 * other particles, and then clears the isTransformDirty and isColorDirty properties, exactly as the
+	 * transformVertices method would.
+	 *
+	 * Returns NO, without changing this particle, if the vertex content of the template mesh cannot be
+	 * read directly, in which case the emitter invokes the transformVertices method instead. Subclasses
+	 * that override the transformVertices method should also override this method to return NO.
+	 *
+	 * This method is invoked automatically by the emitter. Usually the application never needs to
+	 * invoke this method directly.
+	 */
+	virtual bool				populateTransformJob( CC3MeshParticleTransformJob* job );
+
 	CC3Mesh*					getMesh();
 
 	bool						isAlive();
@@ -741,7 +783,7 @@ public:
 	void						setColor4B( const ccColor4B& aColor );
 
 	/** Returns whether the mesh vertices can be transformed using only translation. */
-	bool						doesUseTranslationOnly();
+	virtual bool				doesUseTranslationOnly();
 
 	void						translateVertices();
 	/**
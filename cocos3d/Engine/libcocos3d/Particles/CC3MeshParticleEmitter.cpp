@@ -83,6 +83,8 @@ void CC3MeshParticleEmitter::initWithTag( GLuint aTag, const std::string& aName
 	m_pParticleTemplateMesh = NULL;
 	m_isParticleTransformDirty = false;
 	m_shouldTransformUnseenParticles = true;
+	m_shouldBatchParticleTransforms = true;
+	m_transformedByteRange = CCRangeMake( 0, 0 );
 }
 
 void CC3MeshParticleEmitter::populateFrom( CC3MeshParticleEmitter* another )
@@ -92,6 +94,7 @@ void CC3MeshParticleEmitter::populateFrom( CC3MeshParticleEmitter* another )
 	setParticleTemplateMesh( another->getParticleTemplateMesh() );
 	m_isParticleTransformDirty = another->isParticleTransformDirty();
 	m_shouldTransformUnseenParticles = another->shouldTransformUnseenParticles();
+	m_shouldBatchParticleTransforms = another->shouldBatchParticleTransforms();
 }
 
 CCObject* CC3MeshParticleEmitter::copyWithZone( CCZone* zone )
@@ -329,18 +332,317 @@ bool CC3MeshParticleEmitter::shouldTransformParticles( CC3NodeUpdatingVisitor* v
 	return true;
 }
 
+bool CC3MeshParticleEmitter::shouldBatchParticleTransforms()
+{
+	return m_shouldBatchParticleTransforms;
+}
+
+void CC3MeshParticleEmitter::setShouldBatchParticleTransforms( bool shouldBatch )
+{
+	m_shouldBatchParticleTransforms = shouldBatch;
+}
+
+CCRange CC3MeshParticleEmitter::getTransformedByteRange()
+{
+	return m_transformedByteRange;
+}
+
 void CC3MeshParticleEmitter::transformParticles()
 {
-	GLuint partCount = getParticleCount();
 	CC3_TRACE("CC3MeshParticleEmitter transforming %d particles", m_particleCount);
 
+	m_transformedByteRange = CCRangeMake( 0, 0 );
+
+	CC3MeshParticleVertexTarget target;
+	if ( m_shouldBatchParticleTransforms && populateTransformTarget( &target ) )
+		transformParticlesInBatch( target );
+	else
+		transformParticlesIndividually();
+
+	m_isParticleTransformDirty = false;
+}
+
+void CC3MeshParticleEmitter::transformParticlesIndividually()
+{
+	GLuint partCount = getParticleCount();
 	for (GLuint partIdx = 0; partIdx < partCount; partIdx++) 
 	{
 		CC3MeshParticle* mp = (CC3MeshParticle*)m_particles->objectAtIndex( partIdx );
 		mp->transformVertices();
 	}
+}
 
-	m_isParticleTransformDirty = false;
+bool CC3MeshParticleEmitter::populateTransformTarget( CC3MeshParticleVertexTarget* target )
+{
+	CC3Mesh* vaMesh = getMesh();
+	CC3VertexLocations* locs = vaMesh ? vaMesh->getVertexLocations() : NULL;
+	if ( !locs || !locs->getVertices() || locs->getElementType() != GL_FLOAT )
+		return false;
+
+	GLint locSize = locs->getElementSize();
+	if (locSize != 3 && locSize != 4) 
+		return false;
+
+	target->locations = (GLubyte*)locs->getVertices() + locs->getElementOffset();
+	target->locationStride = locs->getVertexStride();
+	target->locationSize = locSize;
+	target->vertexCapacity = locs->getAllocatedVertexCapacity();
+
+	target->normals = NULL;
+	target->normalStride = 0;
+	CC3VertexNormals* norms = vaMesh->getVertexNormals();
+	if ( norms )
+	{
+		if ( !norms->getVertices() || norms->getElementType() != GL_FLOAT )
+			return false;
+		target->normals = (GLubyte*)norms->getVertices() + norms->getElementOffset();
+		target->normalStride = norms->getVertexStride();
+	}
+
+	target->colors = NULL;
+	target->colorStride = 0;
+	target->colorType = GL_ZERO;
+	CC3VertexColors* cols = vaMesh->getVertexColors();
+	if ( cols )
+	{
+		if ( !cols->getVertices() || cols->getElementSize() != 4 )
+			return false;
+		target->colors = (GLubyte*)cols->getVertices() + cols->getElementOffset();
+		target->colorStride = cols->getVertexStride();
+		target->colorType = cols->getElementType();
+	}
+
+	return true;
+}
+
+/** Batches with fewer vertices than this are transformed on a single thread. */
+#define kCC3MeshParticleParallelVertexThreshold		8192
+#define kCC3MeshParticleMaxTransformThreadCount		8
+
+static GLuint CC3MeshParticleProcessorCount()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	long cpuCount = sysconf( _SC_NPROCESSORS_ONLN );
+	return (cpuCount > 1) ? (GLuint)cpuCount : 1;
+#else
+	return 2;
+#endif
+}
+
+/** A contiguous range of jobs from a batch, transformed on a single thread. */
+typedef struct
+{
+	const CC3MeshParticleVertexTarget*	target;
+	const CC3MeshParticleTransformJob*	jobs;
+	GLuint								startJob;
+	GLuint								endJob;
+} CC3MeshParticleTransformBand;
+
+/**
+ * The batch transform kernel. Writes the vertex content for a range of jobs directly into the
+ * emitter vertex content. The arithmetic follows CC3Matrix4x3TransformCC3Vector4 and
+ * CC3Matrix3x3TransformCC3Vector term for term, so the output is identical to that of the
+ * transformVertices method of CC3MeshParticle.
+ */
+static void CC3MeshParticleTransformJobs( const CC3MeshParticleTransformBand* band )
+{
+	const CC3MeshParticleVertexTarget* tgt = band->target;
+	for (GLuint jobIdx = band->startJob; jobIdx < band->endJob; jobIdx++) 
+	{
+		const CC3MeshParticleTransformJob* job = &band->jobs[jobIdx];
+		GLuint vtxCnt = job->vertexCount;
+
+		if (job->shouldTransformLocations) 
+		{
+			const GLubyte* src = job->srcLocations;
+			GLubyte* dst = tgt->locations + (job->firstVertex * tgt->locationStride);
+			bool hasSrcW = (job->srcLocationSize == 4);
+			bool hasDstW = (tgt->locationSize == 4);
+
+			if (job->isTranslationOnly) 
+			{
+				CC3Vector t = job->translation;
+				for (GLuint vIdx = 0; vIdx < vtxCnt; vIdx++) 
+				{
+					const GLfloat* s = (const GLfloat*)src;
+					GLfloat* d = (GLfloat*)dst;
+					d[0] = s[0] + t.x;
+					d[1] = s[1] + t.y;
+					d[2] = s[2] + t.z;
+					if (hasDstW) d[3] = 1.0f;
+					src += job->srcLocationStride;
+					dst += tgt->locationStride;
+				}
+			} 
+			else 
+			{
+				const CC3Matrix4x3* m = &job->transform;
+				for (GLuint vIdx = 0; vIdx < vtxCnt; vIdx++) 
+				{
+					const GLfloat* s = (const GLfloat*)src;
+					GLfloat* d = (GLfloat*)dst;
+					GLfloat x = s[0], y = s[1], z = s[2];
+					GLfloat w = hasSrcW ? s[3] : 1.0f;
+					d[0] = (m->c1r1 * x) + (m->c2r1 * y) + (m->c3r1 * z) + (m->c4r1 * w);
+					d[1] = (m->c1r2 * x) + (m->c2r2 * y) + (m->c3r2 * z) + (m->c4r2 * w);
+					d[2] = (m->c1r3 * x) + (m->c2r3 * y) + (m->c3r3 * z) + (m->c4r3 * w);
+					if (hasDstW) d[3] = w;
+					src += job->srcLocationStride;
+					dst += tgt->locationStride;
+				}
+			}
+
+			if (job->shouldTransformNormals && tgt->normals) 
+			{
+				const GLubyte* srcN = job->srcNormals;
+				GLubyte* dstN = tgt->normals + (job->firstVertex * tgt->normalStride);
+				const CC3Matrix3x3* m = &job->normalTransform;
+				for (GLuint vIdx = 0; vIdx < vtxCnt; vIdx++) 
+				{
+					const GLfloat* s = (const GLfloat*)srcN;
+					GLfloat* d = (GLfloat*)dstN;
+					if (job->isNormalTransformIdentity) 
+					{
+						d[0] = s[0];
+						d[1] = s[1];
+						d[2] = s[2];
+					} 
+					else 
+					{
+						GLfloat x = s[0], y = s[1], z = s[2];
+						d[0] = (m->c1r1 * x) + (m->c2r1 * y) + (m->c3r1 * z);
+						d[1] = (m->c1r2 * x) + (m->c2r2 * y) + (m->c3r2 * z);
+						d[2] = (m->c1r3 * x) + (m->c2r3 * y) + (m->c3r3 * z);
+					}
+					srcN += job->srcNormalStride;
+					dstN += tgt->normalStride;
+				}
+			}
+		}
+
+		if (job->shouldUpdateColors && tgt->colors) 
+		{
+			GLubyte* dstC = tgt->colors + (job->firstVertex * tgt->colorStride);
+			switch (tgt->colorType) 
+			{
+				case GL_FLOAT:
+					for (GLuint vIdx = 0; vIdx < vtxCnt; vIdx++, dstC += tgt->colorStride) 
+						*(ccColor4F*)dstC = job->color4F;
+					break;
+				case GL_FIXED:
+				case GL_UNSIGNED_BYTE:
+					for (GLuint vIdx = 0; vIdx < vtxCnt; vIdx++, dstC += tgt->colorStride) 
+						*(ccColor4B*)dstC = job->color4B;
+					break;
+				default:
+					break;
+			}
+		}
+	}
+}
+
+static void* CC3MeshParticleTransformBandMain( void* bandPtr )
+{
+	CC3MeshParticleTransformJobs( (CC3MeshParticleTransformBand*)bandPtr );
+	return NULL;
+}
+
+/**
+ * Collects a job for each dirty particle, runs the batch kernel over the jobs, splitting large
+ * batches across threads by particle range, and marks the vertices written as dirty.
+ */
+void CC3MeshParticleEmitter::transformParticlesInBatch( const CC3MeshParticleVertexTarget& target )
+{
+	m_transformJobs.clear();
+
+	GLuint vtxTotal = 0;
+	GLuint firstDirtyVtx = UINT_MAX;
+	GLuint endDirtyVtx = 0;
+	bool wroteLocations = false;
+
+	GLuint partCount = getParticleCount();
+	for (GLuint partIdx = 0; partIdx < partCount; partIdx++) 
+	{
+		CC3MeshParticle* mp = (CC3MeshParticle*)m_particles->objectAtIndex( partIdx );
+		if ( !(mp->isTransformDirty() || mp->isColorDirty()) )
+			continue;
+
+		CC3MeshParticleTransformJob job;
+		if ( !mp->populateTransformJob( &job ) ) 
+		{
+			mp->transformVertices();
+			continue;
+		}
+
+		// Never write beyond the allocated vertex content, as the individual setters would not.
+		if (job.firstVertex >= target.vertexCapacity) 
+			continue;
+		job.vertexCount = MIN( job.vertexCount, target.vertexCapacity - job.firstVertex );
+		if (job.vertexCount == 0) 
+			continue;
+
+		m_transformJobs.push_back( job );
+		vtxTotal += job.vertexCount;
+		firstDirtyVtx = MIN( firstDirtyVtx, job.firstVertex );
+		endDirtyVtx = MAX( endDirtyVtx, job.firstVertex + job.vertexCount );
+		wroteLocations |= job.shouldTransformLocations;
+	}
+
+	GLuint jobCount = (GLuint)m_transformJobs.size();
+	if (jobCount == 0) 
+		return;
+
+	CC3MeshParticleTransformBand bandTemplate;
+	bandTemplate.target = &target;
+	bandTemplate.jobs = &m_transformJobs[0];
+
+	GLuint bandCnt = MIN( MIN( CC3MeshParticleProcessorCount(), (GLuint)kCC3MeshParticleMaxTransformThreadCount ), jobCount );
+	if (vtxTotal < kCC3MeshParticleParallelVertexThreshold || bandCnt < 2) 
+	{
+		bandTemplate.startJob = 0;
+		bandTemplate.endJob = jobCount;
+		CC3MeshParticleTransformJobs( &bandTemplate );
+	} 
+	else 
+	{
+		// Split the jobs into bands holding roughly equal numbers of vertices.
+		CC3MeshParticleTransformBand bands[kCC3MeshParticleMaxTransformThreadCount];
+		pthread_t threads[kCC3MeshParticleMaxTransformThreadCount];
+		bool isThreaded[kCC3MeshParticleMaxTransformThreadCount];
+		GLuint jobIdx = 0;
+		GLuint vtxSoFar = 0;
+		for (GLuint i = 0; i < bandCnt; i++) 
+		{
+			bands[i] = bandTemplate;
+			bands[i].startJob = jobIdx;
+			GLuint vtxBandEnd = (GLuint)((unsigned long)vtxTotal * (i + 1) / bandCnt);
+			while (jobIdx < jobCount && (vtxSoFar < vtxBandEnd || i == bandCnt - 1)) 
+				vtxSoFar += m_transformJobs[jobIdx++].vertexCount;
+			bands[i].endJob = jobIdx;
+		}
+
+		// Run the first band on this thread. If a thread cannot be started, run its band here too.
+		for (GLuint i = 1; i < bandCnt; i++) 
+			isThreaded[i] = (pthread_create( &threads[i], NULL, CC3MeshParticleTransformBandMain, &bands[i] ) == 0);
+		CC3MeshParticleTransformJobs( &bands[0] );
+		for (GLuint i = 1; i < bandCnt; i++) 
+		{
+			if ( isThreaded[i] )
+				pthread_join( threads[i], NULL );
+			else
+				CC3MeshParticleTransformJobs( &bands[i] );
+		}
+	}
+
+	CCRange vtxRange = CCRangeMake( firstDirtyVtx, endDirtyVtx - firstDirtyVtx );
+	addDirtyVertexRange( vtxRange );
+	if ( wroteLocations )
+		getMesh()->getVertexLocations()->markBoundaryDirty();
+
+	GLuint vtxStride = getMesh()->getVertexStride();
+	m_transformedByteRange = CCRangeMake( vtxRange.location * vtxStride, vtxRange.length * vtxStride );
+
+	CC3_TRACE("CC3MeshParticleEmitter transformed %d vertices of %d particles in a batch", vtxTotal, jobCount);
 }
 
 CC3MeshParticleEmitter* CC3MeshParticleEmitter::nodeWithName( const std::string& aName )
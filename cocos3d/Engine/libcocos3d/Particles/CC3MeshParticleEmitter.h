@@ -33,6 +33,24 @@
 NS_COCOS3D_BEGIN
 
 class CC3MeshParticle;
+
+/**
+ * Describes where the batched transform stage of a CC3MeshParticleEmitter writes vertex content
+ * within the emitter mesh. The pointers reference the content of the first vertex of each array.
+ */
+typedef struct
+{
+	GLubyte*			locations;				/**< The first vertex location. */
+	GLuint				locationStride;			/**< The stride between vertex locations. */
+	GLuint				locationSize;			/**< The number of components (3 or 4) of each location. */
+	GLubyte*			normals;				/**< The first vertex normal, or NULL if there are no normals. */
+	GLuint				normalStride;			/**< The stride between vertex normals. */
+	GLubyte*			colors;					/**< The first vertex color, or NULL if there are no colors. */
+	GLuint				colorStride;			/**< The stride between vertex colors. */
+	GLenum				colorType;				/**< The element type of the vertex colors. */
+	GLuint				vertexCapacity;			/**< The number of vertices allocated in the emitter mesh. */
+} CC3MeshParticleVertexTarget;
+
 /**
  * CC3MeshParticleEmitter emits particles that conform to the CC3MeshParticleProtocol protocol.
  * 
@@ -53,6 +71,12 @@ class CC3MeshParticle;
  * This method is invoked automatically by the emitter when a particle has been changed, and the mesh
  * particle implementation defines what type of transform occurs when this method is invoked.
  *
+ * By default, the dirty particles are transformed in a batch. The emitter collects the template
+ * content, transform and color of each dirty particle into a flat list of jobs, and a single kernel
+ * writes the locations, normals and colors directly into the vertex content of the emitter mesh,
+ * splitting large batches across several threads by particle range. Only the range of vertices
+ * that was written is then submitted to the GL buffer.
+ *
  * This creates a trade-off, where, relative to mesh nodes, the GPU rendering performance is
  * dramatically improved for large numbers of mesh particles, but the CPU load is increased
  * when mesh particles are constantly being transformed, particularly for larger meshes.
@@ -269,6 +293,30 @@ public:
 	 */
 	void						markParticleTransformDirty();
 
+	/**
+	 * Indicates whether the dirty particles should be transformed in a batch, by a single kernel
+	 * writing directly into the vertex content of the mesh of this emitter, rather than by invoking
+	 * the transformVertices method on each particle in turn.
+	 *
+	 * Particles whose populateTransformJob method returns NO are always transformed individually.
+	 * If the vertex content of this emitter is not laid out in a form the batch kernel can write,
+	 * all particles are transformed individually, regardless of this property.
+	 *
+	 * The initial value of this property is YES.
+	 */
+	bool						shouldBatchParticleTransforms();
+	void						setShouldBatchParticleTransforms( bool shouldBatch );
+
+	/**
+	 * Returns the range of bytes, within the vertex content of the mesh of this emitter, that
+	 * was written by the most recent batched transform. The range is measured using the vertex
+	 * stride of the mesh, and is empty if the most recent transform wrote no vertices in a batch.
+	 *
+	 * The corresponding range of vertices is added to the dirty vertex range of this emitter,
+	 * so that only that sub-range is copied to the GL buffer.
+	 */
+	CCRange						getTransformedByteRange();
+
 	void						initWithTag( GLuint aTag, const std::string& aName );
 
 	void						populateFrom( CC3MeshParticleEmitter* another );
@@ -289,6 +337,19 @@ public:
 	 */
 	virtual bool				shouldTransformParticles( CC3NodeUpdatingVisitor* visitor );
 	virtual void				transformParticles();
+
+	/**
+	 * Template method that populates the specified target with the layout of the vertex content of
+	 * the mesh of this emitter, as written by the batched transform stage. Returns NO if the layout
+	 * cannot be written directly, in which case each particle is transformed individually.
+	 */
+	virtual bool				populateTransformTarget( CC3MeshParticleVertexTarget* target );
+
+	/** Transforms the particles by invoking the transformVertices method on each dirty particle. */
+	void						transformParticlesIndividually();
+
+	/** Transforms the dirty particles in a batch, using the specified vertex layout. */
+	void						transformParticlesInBatch( const CC3MeshParticleVertexTarget& target );
 	/**
 	 * Removes the current particle from the active particles, but possibly keep it cached for future use.
 	 *
@@ -312,8 +373,11 @@ public:
 
 protected:
 	CC3Mesh*					m_pParticleTemplateMesh;
+	std::vector<CC3MeshParticleTransformJob>	m_transformJobs;
+	CCRange						m_transformedByteRange;
 	bool						m_isParticleTransformDirty : 1;
 	bool						m_shouldTransformUnseenParticles : 1;
+	bool						m_shouldBatchParticleTransforms : 1;
 };
 
 NS_COCOS3D_END
@@ -0,0 +1,413 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#include "cocos3d.h"
+
+NS_COCOS3D_BEGIN
+
+CC3EnvironmentMapScheduler::CC3EnvironmentMapScheduler()
+{
+
+}
+
+CC3EnvironmentMapScheduler::~CC3EnvironmentMapScheduler()
+{
+	removeAllEnvironmentMaps();
+}
+
+bool CC3EnvironmentMapScheduler::init()
+{
+	m_facesPerFrame = kCC3EnvironmentMapDefaultFacesPerFrame;
+	m_maxFaceAge = kCC3EnvironmentMapDefaultMaxFaceAge;
+	m_stalenessWeight = 1.0f;
+	m_lowResolutionDistance = 0.0f;
+	m_farClippingDistance = kCC3MaxGLfloat;
+	m_frame = 0;
+	return true;
+}
+
+CC3EnvironmentMapScheduler* CC3EnvironmentMapScheduler::scheduler()
+{
+	CC3EnvironmentMapScheduler* pScheduler = new CC3EnvironmentMapScheduler;
+	pScheduler->init();
+	pScheduler->autorelease();
+
+	return pScheduler;
+}
+
+void CC3EnvironmentMapScheduler::addEnvironmentMap( CC3EnvironmentMapTexture* texture, CC3Node* subject )
+{
+	addEnvironmentMap( texture, subject, NULL );
+}
+
+void CC3EnvironmentMapScheduler::addEnvironmentMap( CC3EnvironmentMapTexture* texture, CC3Node* subject,
+												    CC3EnvironmentMapTexture* lowResolutionTexture )
+{
+	CCAssert( texture && subject, "CC3EnvironmentMapScheduler requires both an environment map and a subject node" );
+
+	removeEnvironmentMap( texture );
+
+	CC3EnvironmentMapEntry entry;
+	entry.texture = texture;
+	entry.lowResolutionTexture = lowResolutionTexture;
+	entry.subject = subject;
+	entry.location = subject->getGlobalCenterOfGeometry();
+	entry.isUsingLowResolution = false;
+	for (GLuint faceIdx = 0; faceIdx < 6; faceIdx++) 
+	{
+		entry.faceRefreshTimes[faceIdx] = 0;
+		entry.isFaceDirty[faceIdx] = true;
+	}
+
+	texture->retain();
+	CC_SAFE_RETAIN( lowResolutionTexture );
+	subject->retain();
+	m_entries.push_back( entry );
+}
+
+void CC3EnvironmentMapScheduler::removeEnvironmentMap( CC3EnvironmentMapTexture* texture )
+{
+	for (std::vector<CC3EnvironmentMapEntry>::iterator iter = m_entries.begin(); iter != m_entries.end(); ++iter) 
+	{
+		if (iter->texture != texture) 
+			continue;
+
+		// Leave the full resolution texture in the subject node
+		if ( iter->isUsingLowResolution )
+			swapTextureOfNode( iter->subject, iter->lowResolutionTexture, iter->texture );
+
+		iter->texture->release();
+		CC_SAFE_RELEASE( iter->lowResolutionTexture );
+		iter->subject->release();
+		m_entries.erase( iter );
+		return;
+	}
+}
+
+void CC3EnvironmentMapScheduler::removeAllEnvironmentMaps()
+{
+	while ( !m_entries.empty() )
+		removeEnvironmentMap( m_entries.back().texture );
+	m_nodeRecords.clear();
+}
+
+GLuint CC3EnvironmentMapScheduler::getEnvironmentMapCount()
+{
+	return (GLuint)m_entries.size();
+}
+
+GLuint CC3EnvironmentMapScheduler::getFacesPerFrame()
+{
+	return m_facesPerFrame;
+}
+
+void CC3EnvironmentMapScheduler::setFacesPerFrame( GLuint facesPerFrame )
+{
+	m_facesPerFrame = facesPerFrame;
+}
+
+GLfloat CC3EnvironmentMapScheduler::getMaxFaceAge()
+{
+	return m_maxFaceAge;
+}
+
+void CC3EnvironmentMapScheduler::setMaxFaceAge( GLfloat maxAge )
+{
+	m_maxFaceAge = MAX( maxAge, 0.0f );
+}
+
+GLfloat CC3EnvironmentMapScheduler::getStalenessWeight()
+{
+	return m_stalenessWeight;
+}
+
+void CC3EnvironmentMapScheduler::setStalenessWeight( GLfloat weight )
+{
+	m_stalenessWeight = MAX( weight, 0.0f );
+}
+
+GLfloat CC3EnvironmentMapScheduler::getLowResolutionDistance()
+{
+	return m_lowResolutionDistance;
+}
+
+void CC3EnvironmentMapScheduler::setLowResolutionDistance( GLfloat distance )
+{
+	m_lowResolutionDistance = MAX( distance, 0.0f );
+}
+
+CC3Vector CC3EnvironmentMapScheduler::getLocationOfEntry( CC3EnvironmentMapEntry& entry )
+{
+	return entry.subject->getGlobalCenterOfGeometry();
+}
+
+/**
+ * Returns whether a sphere, at the specified offset from the viewpoint of a cube-map, might be
+ * within the 90 degree view of the specified face. The sphere is tested against the four planes
+ * at 45 degrees that bound the face, and against the far clipping distance.
+ */
+static bool CC3EnvironmentMapFaceCanSee( GLuint faceIdx, const CC3Vector& offset, GLfloat radius, GLfloat farDist )
+{
+	GLfloat dist = offset.length();
+	if (dist <= radius) 
+		return true;
+	if (dist - radius > farDist) 
+		return false;
+
+	GLfloat comps[3] = { offset.x, offset.y, offset.z };
+	GLuint axis = faceIdx / 2;
+	GLfloat fwd = (faceIdx % 2) ? -comps[axis] : comps[axis];
+	GLfloat margin = -radius * 1.41421356f;		// Distance to each 45 degree plane is scaled by sqrt(2)
+	return (fwd - fabsf(comps[(axis + 1) % 3]) >= margin &&
+			fwd - fabsf(comps[(axis + 2) % 3]) >= margin);
+}
+
+/** Returns the far clipping distance of the active camera of the scene, which environment maps match. */
+static GLfloat CC3EnvironmentMapFarDistance( CC3Scene* scene )
+{
+	CC3Camera* cam = scene->getActiveCamera();
+	return cam ? cam->getFarClippingDistance() : kCC3MaxGLfloat;
+}
+
+void CC3EnvironmentMapScheduler::markFacesDirtyForBox( const CC3Box& box )
+{
+	if ( box.isNull() )
+		return;
+
+	CC3Vector center = box.getCenter();
+	GLfloat radius = box.getSize().length() * 0.5f;
+	for (GLuint entryIdx = 0; entryIdx < m_entries.size(); entryIdx++) 
+	{
+		CC3EnvironmentMapEntry& entry = m_entries[entryIdx];
+		CC3Vector offset = center - entry.location;
+		for (GLuint faceIdx = 0; faceIdx < 6; faceIdx++) 
+		{
+			if ( CC3EnvironmentMapFaceCanSee( faceIdx, offset, radius, m_farClippingDistance ) )
+				entry.isFaceDirty[faceIdx] = true;
+		}
+	}
+}
+
+void CC3EnvironmentMapScheduler::collectSceneChanges( CC3Scene* scene )
+{
+	m_frame++;
+	m_farClippingDistance = CC3EnvironmentMapFarDistance( scene );
+
+	// A map whose viewpoint has moved sees everything differently
+	for (GLuint entryIdx = 0; entryIdx < m_entries.size(); entryIdx++) 
+	{
+		CC3EnvironmentMapEntry& entry = m_entries[entryIdx];
+		CC3Vector loc = getLocationOfEntry( entry );
+		if ( !loc.equals( entry.location ) )
+		{
+			for (GLuint faceIdx = 0; faceIdx < 6; faceIdx++) 
+				entry.isFaceDirty[faceIdx] = true;
+			entry.location = loc;
+		}
+	}
+
+	// Compare each drawable node with its bounds on the previous frame
+	CC3NodeSequencer* sequencer = scene->getDrawingSequencer();
+	CCArray* nodes = sequencer ? sequencer->getNodes() : NULL;
+	CCObject* pObj = NULL;
+	CCARRAY_FOREACH( nodes, pObj )
+	{
+		CC3Node* node = (CC3Node*)pObj;
+		CC3Box bounds = node->getGlobalBoundingBox();
+		bool isVisible = node->isVisible();
+
+		std::map<CC3Node*, CC3EnvironmentMapNodeRecord>::iterator iter = m_nodeRecords.find( node );
+		if (iter == m_nodeRecords.end()) 
+		{
+			if ( isVisible )
+				markFacesDirtyForBox( bounds );
+			CC3EnvironmentMapNodeRecord record;
+			record.bounds = bounds;
+			record.isVisible = isVisible;
+			record.frame = m_frame;
+			m_nodeRecords[node] = record;
+			continue;
+		}
+
+		CC3EnvironmentMapNodeRecord& record = iter->second;
+		if ( (isVisible || record.isVisible) && (isVisible != record.isVisible || !bounds.equals( record.bounds )) )
+		{
+			markFacesDirtyForBox( record.bounds );
+			markFacesDirtyForBox( bounds );
+		}
+		record.bounds = bounds;
+		record.isVisible = isVisible;
+		record.frame = m_frame;
+	}
+
+	// Nodes that were not seen on this frame have left the scene
+	std::map<CC3Node*, CC3EnvironmentMapNodeRecord>::iterator iter = m_nodeRecords.begin();
+	while (iter != m_nodeRecords.end()) 
+	{
+		if (iter->second.frame != m_frame) 
+		{
+			if ( iter->second.isVisible )
+				markFacesDirtyForBox( iter->second.bounds );
+			m_nodeRecords.erase( iter++ );
+		}
+		else
+			++iter;
+	}
+}
+
+/** Orders faces that are due first, then by descending priority, then by entry and face, for a stable plan. */
+static bool CC3EnvironmentMapFaceUpdateIsBefore( const CC3EnvironmentMapFaceUpdate& a, const CC3EnvironmentMapFaceUpdate& b )
+{
+	if (a.isDue != b.isDue) 
+		return a.isDue;
+	if (a.priority != b.priority) 
+		return a.priority > b.priority;
+	if (a.entryIndex != b.entryIndex) 
+		return a.entryIndex < b.entryIndex;
+	return a.face < b.face;
+}
+
+GLuint CC3EnvironmentMapScheduler::planFaceUpdates( CC3Scene* scene, std::vector<CC3EnvironmentMapFaceUpdate>& plan )
+{
+	plan.clear();
+
+	CC3Camera* cam = scene->getActiveCamera();
+	if ( !cam || m_facesPerFrame == 0 )
+		return 0;
+
+	CC3Vector camLoc = cam->getGlobalLocation();
+	GLfloat tanHalfFOV = tanf( CC3DegToRad( cam->getFieldOfView() * 0.5f ) );
+	unsigned long now = scene->getElapsedTimeSinceOpened();
+
+	for (GLuint entryIdx = 0; entryIdx < m_entries.size(); entryIdx++) 
+	{
+		CC3EnvironmentMapEntry& entry = m_entries[entryIdx];
+		CC3Node* subject = entry.subject;
+
+		// A reflection that cannot be seen does not need updating
+		if ( !subject->isVisible() || !subject->doesIntersectFrustum( cam->getFrustum() ) )
+			continue;
+
+		// Estimate the fraction of the view covered by the subject node
+		CC3Vector center = subject->getGlobalCenterOfGeometry();
+		GLfloat radius = subject->getGlobalBoundingBox().getSize().length() * 0.5f;
+		GLfloat dist = camLoc.distance( center );
+		GLfloat coverage = 1.0f;
+		if (dist > radius && tanHalfFOV > 0.0f) 
+		{
+			GLfloat ratio = radius / (dist * tanHalfFOV);
+			coverage = MIN( ratio * ratio, 1.0f );
+		}
+
+		bool isLowRes = (entry.lowResolutionTexture && m_lowResolutionDistance > 0.0f && dist > m_lowResolutionDistance);
+		bool isSwitching = (isLowRes != entry.isUsingLowResolution);
+
+		for (GLuint faceIdx = 0; faceIdx < 6; faceIdx++) 
+		{
+			GLfloat age = (now - entry.faceRefreshTimes[faceIdx]) / 1000.0f;
+			bool isDue = entry.isFaceDirty[faceIdx] || isSwitching || (m_maxFaceAge > 0.0f && age >= m_maxFaceAge);
+			if (!isDue && m_maxFaceAge > 0.0f) 
+				continue;
+
+			// Faces that are due always outrank clean faces, which are only generated with spare budget
+			CC3EnvironmentMapFaceUpdate update;
+			update.entryIndex = entryIdx;
+			update.face = GL_TEXTURE_CUBE_MAP_POSITIVE_X + faceIdx;
+			update.priority = coverage * (1.0f + age * m_stalenessWeight);
+			update.isDue = isDue;
+			update.isLowResolution = isLowRes;
+			plan.push_back( update );
+		}
+	}
+
+	std::sort( plan.begin(), plan.end(), CC3EnvironmentMapFaceUpdateIsBefore );
+	if (plan.size() > m_facesPerFrame) 
+		plan.resize( m_facesPerFrame );
+
+	return (GLuint)plan.size();
+}
+
+void CC3EnvironmentMapScheduler::executePlan( CC3Scene* scene, const std::vector<CC3EnvironmentMapFaceUpdate>& plan )
+{
+	unsigned long now = scene->getElapsedTimeSinceOpened();
+	for (GLuint updateIdx = 0; updateIdx < plan.size(); updateIdx++) 
+	{
+		const CC3EnvironmentMapFaceUpdate& update = plan[updateIdx];
+		CC3EnvironmentMapEntry& entry = m_entries[update.entryIndex];
+
+		// Swap the displayed texture when the subject crosses the low resolution distance,
+		// and mark the faces of the newly displayed texture as needing to be generated.
+		if (update.isLowResolution != entry.isUsingLowResolution) 
+		{
+			if ( update.isLowResolution )
+				swapTextureOfNode( entry.subject, entry.texture, entry.lowResolutionTexture );
+			else
+				swapTextureOfNode( entry.subject, entry.lowResolutionTexture, entry.texture );
+			entry.isUsingLowResolution = update.isLowResolution;
+			for (GLuint faceIdx = 0; faceIdx < 6; faceIdx++) 
+				entry.isFaceDirty[faceIdx] = true;
+		}
+
+		CC3EnvironmentMapTexture* texture = entry.isUsingLowResolution ? entry.lowResolutionTexture : entry.texture;
+
+		// Hide the subject from itself while generating its own environment map
+		bool isVis = entry.subject->isVisible();
+		entry.subject->setVisible( false );
+		texture->generateFaceOfScene( scene, entry.location, update.face );
+		entry.subject->setVisible( isVis );
+
+		GLuint faceIdx = update.face - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+		entry.faceRefreshTimes[faceIdx] = now;
+		entry.isFaceDirty[faceIdx] = false;
+	}
+}
+
+void CC3EnvironmentMapScheduler::generateSnapshotsOfScene( CC3Scene* scene )
+{
+	collectSceneChanges( scene );
+	planFaceUpdates( scene, m_plan );
+	executePlan( scene, m_plan );
+}
+
+void CC3EnvironmentMapScheduler::swapTextureOfNode( CC3Node* node, CC3Texture* fromTexture, CC3Texture* toTexture )
+{
+	CC3MeshNode* meshNode = dynamic_cast<CC3MeshNode*>( node );
+	CC3Material* material = meshNode ? meshNode->getMaterial() : NULL;
+	if ( !material )
+		return;
+
+	GLuint texCount = material->getTextureCount();
+	for (GLuint texUnit = 0; texUnit < texCount; texUnit++) 
+	{
+		if (material->getTextureForTextureUnit( texUnit ) == fromTexture) 
+			material->setTexture( toTexture, texUnit );
+	}
+}
+
+NS_COCOS3D_END
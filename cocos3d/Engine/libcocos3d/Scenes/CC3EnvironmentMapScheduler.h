@@ -0,0 +1,220 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#ifndef _CC3_ENVIRONMENT_MAP_SCHEDULER_H_
+#define _CC3_ENVIRONMENT_MAP_SCHEDULER_H_
+
+NS_COCOS3D_BEGIN
+
+class CC3EnvironmentMapTexture;
+
+/** The default number of cube-map faces generated on each frame by a CC3EnvironmentMapScheduler. */
+#define kCC3EnvironmentMapDefaultFacesPerFrame		2
+
+/** The default time, in seconds, after which an unchanged cube-map face is regenerated anyway. */
+#define kCC3EnvironmentMapDefaultMaxFaceAge			2.0f
+
+/** An environment map tracked by CC3EnvironmentMapScheduler. */
+typedef struct _CC3EnvironmentMapEntry 
+{
+	CC3EnvironmentMapTexture*	texture;				/**< The full-resolution environment map (retained). */
+	CC3EnvironmentMapTexture*	lowResolutionTexture;	/**< Optional environment map used when far from the camera (retained). */
+	CC3Node*					subject;				/**< The node whose center is the viewpoint of the map (retained). */
+	CC3Vector					location;				/**< The viewpoint of the faces most recently generated. */
+	unsigned long				faceRefreshTimes[6];	/**< Scene time, in ms, at which each face was last generated. */
+	bool						isFaceDirty[6];			/**< Whether scene content visible to each face has changed. */
+	bool						isUsingLowResolution;	/**< Whether the low resolution texture is the one in use. */
+} CC3EnvironmentMapEntry;
+
+/** A single cube-map face chosen to be generated by CC3EnvironmentMapScheduler. */
+typedef struct _CC3EnvironmentMapFaceUpdate 
+{
+	GLuint						entryIndex;				/**< The index of the environment map in the scheduler. */
+	GLenum						face;					/**< The GL_TEXTURE_CUBE_MAP_* face to generate. */
+	GLfloat						priority;				/**< The ranking score of the face. Higher scores are generated first. */
+	bool						isDue;					/**< Whether the face is dirty or old. Other faces only use spare budget. */
+	bool						isLowResolution;		/**< Whether the low resolution texture is to be generated. */
+} CC3EnvironmentMapFaceUpdate;
+
+/** The bounds of a node, as last seen by CC3EnvironmentMapScheduler. */
+typedef struct _CC3EnvironmentMapNodeRecord 
+{
+	CC3Box						bounds;					/**< The global bounding box of the node. */
+	GLuint						frame;					/**< The frame in which the node was last seen. */
+	bool						isVisible;				/**< Whether the node was visible. */
+} CC3EnvironmentMapNodeRecord;
+
+/**
+ * CC3EnvironmentMapScheduler shares a global per-frame budget of cube-map face renderings among
+ * all of the CC3EnvironmentMapTextures in a scene.
+ *
+ * Rendering a cube-map face requires rendering the entire scene. With many reflective models,
+ * invoking generateSnapshotOfScene:fromGlobalLocation: on each environment map renders faces of
+ * every map on every frame, regardless of how far away or how visible each model is. Instead,
+ * register each environment map with this scheduler, along with the node that displays it, and
+ * set the scheduler into the environmentMapScheduler property of the scene. On each frame, the
+ * scene will invoke the generateSnapshotsOfScene: method, which:
+ *   - marks a face as dirty if any node within the view of that face has moved, appeared or
+ *     disappeared, or if the viewpoint of the map has moved. Faces that are not dirty are not
+ *     regenerated, until they are older than the maxFaceAge property.
+ *   - ranks the remaining faces by the screen coverage of the model displaying the map (which
+ *     falls off with the square of its distance from the camera), scaled up by the time since
+ *     the face was last generated. Maps whose models are outside the camera frustum are skipped.
+ *   - generates the highest-ranked faces, up to the facesPerFrame budget.
+ *   - optionally swaps a lower resolution environment map into the model when the model is
+ *     farther than the lowResolutionDistance property from the camera.
+ *
+ * The planFaceUpdates: method that makes the scheduling decisions does not touch the GL engine,
+ * and its result depends only on the state of the scene and of this scheduler, so that the same
+ * scene state always produces the same plan.
+ */
+class CC3EnvironmentMapScheduler : public CCObject
+{
+public:
+	CC3EnvironmentMapScheduler();
+	virtual ~CC3EnvironmentMapScheduler();
+
+	/**
+	 * Registers the specified environment map, to be generated from the center of geometry of
+	 * the specified subject node. The subject node is hidden while its own map is generated.
+	 */
+	void						addEnvironmentMap( CC3EnvironmentMapTexture* texture, CC3Node* subject );
+
+	/**
+	 * Registers the specified environment map, as with addEnvironmentMap:forSubject:, along with a
+	 * lower resolution environment map, which is generated instead of the texture while the subject
+	 * node is farther from the camera than the lowResolutionDistance property. The two textures are
+	 * swapped within the material of the subject node as it crosses that distance.
+	 */
+	void						addEnvironmentMap( CC3EnvironmentMapTexture* texture, CC3Node* subject,
+												   CC3EnvironmentMapTexture* lowResolutionTexture );
+
+	/** Removes the specified environment map from this scheduler. */
+	void						removeEnvironmentMap( CC3EnvironmentMapTexture* texture );
+
+	/** Removes all environment maps from this scheduler. */
+	void						removeAllEnvironmentMaps();
+
+	/** Returns the number of environment maps registered with this scheduler. */
+	GLuint						getEnvironmentMapCount();
+
+	/**
+	 * The maximum number of cube-map faces, across all environment maps, generated on each frame.
+	 *
+	 * The initial value of this property is kCC3EnvironmentMapDefaultFacesPerFrame.
+	 */
+	GLuint						getFacesPerFrame();
+	void						setFacesPerFrame( GLuint facesPerFrame );
+
+	/**
+	 * The time, in seconds, after which a face is eligible for regeneration, even if no nodes
+	 * within its view have moved. This catches changes that do not move nodes, such as changes
+	 * to lighting or materials. Set this to zero to regenerate clean faces only when budget is
+	 * left after all dirty faces have been generated.
+	 *
+	 * The initial value of this property is kCC3EnvironmentMapDefaultMaxFaceAge.
+	 */
+	GLfloat						getMaxFaceAge();
+	void						setMaxFaceAge( GLfloat maxAge );
+
+	/**
+	 * The weight given to the age of a face, per second, when ranking faces. The priority of a face
+	 * is the screen coverage of its subject node, multiplied by (1 + age * stalenessWeight).
+	 *
+	 * The initial value of this property is 1.
+	 */
+	GLfloat						getStalenessWeight();
+	void						setStalenessWeight( GLfloat weight );
+
+	/**
+	 * The distance from the camera beyond which the low resolution texture of an environment map,
+	 * if it has one, is generated and displayed instead of the full resolution texture.
+	 * A value of zero disables the use of low resolution textures.
+	 *
+	 * The initial value of this property is zero.
+	 */
+	GLfloat						getLowResolutionDistance();
+	void						setLowResolutionDistance( GLfloat distance );
+
+	/**
+	 * Compares the bounds of the nodes in the drawing sequence of the specified scene with those
+	 * seen on the previous frame, and marks as dirty the faces of each environment map whose view
+	 * contains a node that has moved, appeared or disappeared since then.
+	 */
+	void						collectSceneChanges( CC3Scene* scene );
+
+	/**
+	 * Populates the specified plan with the faces to be generated on this frame, in the order they
+	 * should be generated, and returns the number of faces in the plan.
+	 *
+	 * This method does not change the state of this scheduler or the scene, and does not access the
+	 * GL engine. The plan depends only on the active camera of the scene, the global bounds of the
+	 * subject nodes, the elapsed time of the scene, and the state of the faces in this scheduler.
+	 */
+	GLuint						planFaceUpdates( CC3Scene* scene, std::vector<CC3EnvironmentMapFaceUpdate>& plan );
+
+	/** Generates the faces in the specified plan, and records them as fresh. */
+	void						executePlan( CC3Scene* scene, const std::vector<CC3EnvironmentMapFaceUpdate>& plan );
+
+	/**
+	 * Collects the changes to the scene, then plans and generates the faces to update on this frame.
+	 *
+	 * This method is invoked automatically by the scene on each frame, when this scheduler has
+	 * been set into the environmentMapScheduler property of the scene.
+	 */
+	void						generateSnapshotsOfScene( CC3Scene* scene );
+
+	virtual bool				init();
+	static CC3EnvironmentMapScheduler* scheduler();
+
+protected:
+	/** Returns the location from which the faces of the specified entry are generated. */
+	CC3Vector					getLocationOfEntry( CC3EnvironmentMapEntry& entry );
+
+	/** Marks the faces of all entries that can see the specified global box as dirty. */
+	void						markFacesDirtyForBox( const CC3Box& box );
+
+	/** Swaps the specified textures within the material of the specified node, if it is a mesh node. */
+	void						swapTextureOfNode( CC3Node* node, CC3Texture* fromTexture, CC3Texture* toTexture );
+
+protected:
+	std::vector<CC3EnvironmentMapEntry>					m_entries;
+	std::map<CC3Node*, CC3EnvironmentMapNodeRecord>		m_nodeRecords;
+	std::vector<CC3EnvironmentMapFaceUpdate>			m_plan;
+	GLuint						m_facesPerFrame;
+	GLfloat						m_maxFaceAge;
+	GLfloat						m_stalenessWeight;
+	GLfloat						m_lowResolutionDistance;
+	GLfloat						m_farClippingDistance;
+	GLuint						m_frame;
+};
+
+NS_COCOS3D_END
+
+#endif
@@ -1079,6 +1079,23 @@ void CC3EnvironmentMapTexture::generateSnapshotOfScene( CC3Scene* scene, const C
 	if ( !facesToGenerate ) 
 		return;
 	
+	CC3NodeDrawingVisitor* envMapVisitor = prepareVisitorForScene( scene, location );
+	for ( GLuint faceIdx = 0; faceIdx < facesToGenerate; faceIdx++ ) 
+	{
+		moveToNextFace();
+		drawCurrentFaceOfScene( scene, envMapVisitor );
+	}
+}
+
+void CC3EnvironmentMapTexture::generateFaceOfScene( CC3Scene* scene, const CC3Vector& location, GLenum face )
+{
+	CC3NodeDrawingVisitor* envMapVisitor = prepareVisitorForScene( scene, location );
+	m_currentFace = face;
+	drawCurrentFaceOfScene( scene, envMapVisitor );
+}
+
+CC3NodeDrawingVisitor* CC3EnvironmentMapTexture::prepareVisitorForScene( CC3Scene* scene, const CC3Vector& location )
+{
 	// Get the scene and the cube-map visitor, and set the render surface to that of this texture.
 	CC3NodeDrawingVisitor* envMapVisitor = scene->getEnvMapDrawingVisitor();
 	envMapVisitor->setRenderSurface( getRenderSurface() );
@@ -1095,25 +1112,26 @@ void CC3EnvironmentMapTexture::generateSnapshotOfScene( CC3Scene* scene, const C
 		envMapCam->setNearClippingDistance( sceneCam->getNearClippingDistance() );
 		envMapCam->setFarClippingDistance( sceneCam->getFarClippingDistance() );
 	}
-	
-	for ( GLuint faceIdx = 0; faceIdx < facesToGenerate; faceIdx++ ) 
-	{
-		moveToNextFace();
 
-		// Bind the texture face to the framebuffer
-		CC3TextureFramebufferAttachment* fbAtt = (CC3TextureFramebufferAttachment*)m_pRenderSurface->getColorAttachment();
-		fbAtt->setFace( m_currentFace );
-		fbAtt->bindToFramebuffer( m_pRenderSurface, GL_COLOR_ATTACHMENT0 );
-		
-		// Point the camera towards the face
-		envMapCam->setForwardDirection( getCameraDirection() );
-		envMapCam->setReferenceUpDirection( getUpDirection() );
+	return envMapVisitor;
+}
 
-		// Draw the scene to the texture face
-		scene->drawSceneContentForEnvironmentMapWithVisitor( envMapVisitor );
+void CC3EnvironmentMapTexture::drawCurrentFaceOfScene( CC3Scene* scene, CC3NodeDrawingVisitor* envMapVisitor )
+{
+	// Bind the texture face to the framebuffer
+	CC3TextureFramebufferAttachment* fbAtt = (CC3TextureFramebufferAttachment*)m_pRenderSurface->getColorAttachment();
+	fbAtt->setFace( m_currentFace );
+	fbAtt->bindToFramebuffer( m_pRenderSurface, GL_COLOR_ATTACHMENT0 );
+	
+	// Point the camera towards the face
+	CC3Camera* envMapCam = envMapVisitor->getCamera();
+	envMapCam->setForwardDirection( getCameraDirection() );
+	envMapCam->setReferenceUpDirection( getUpDirection() );
 
-//		paintFace();		// Uncomment to identify the faces
-	}
+	// Draw the scene to the texture face
+	scene->drawSceneContentForEnvironmentMapWithVisitor( envMapVisitor );
+
+//	paintFace();		// Uncomment to identify the faces
 }
 
 CC3GLFramebuffer* CC3EnvironmentMapTexture::getRenderSurface()
@@ -1400,6 +1400,17 @@ public:
 	 */
 	void						generateSnapshotOfScene( CC3Scene* scene, const CC3Vector& location );
 
+	/**
+	 * Generates the single specified face of this cube-map, by creating a view of the specified
+	 * scene, from the specified global location, in the direction of that face.
+	 *
+	 * The face argument must be one of the GL_TEXTURE_CUBE_MAP_POSITIVE_X...GL_TEXTURE_CUBE_MAP_NEGATIVE_Z
+	 * enums. Unlike the generateSnapshotOfScene:fromGlobalLocation: method, the numberOfFacesPerSnapshot
+	 * property is ignored, and the face is always generated. This method is used by CC3EnvironmentMapScheduler
+	 * to choose which faces of many environment maps should be generated on each frame.
+	 */
+	void						generateFaceOfScene( CC3Scene* scene, const CC3Vector& location, GLenum face );
+
 	/** Returns the surface to which the environment will be rendered. */
 	CC3GLFramebuffer*			getRenderSurface();
 
@@ -1576,6 +1587,16 @@ public:
 	/** Returns the color to paint the current face, using the diagnostic paintFace method. */
 	ccColor4B					getFaceColor();
 
+protected:
+	/**
+	 * Sets the render surface of the environment-map visitor of the specified scene to that of this
+	 * texture, locates its camera at the specified location, and returns the visitor.
+	 */
+	CC3NodeDrawingVisitor*		prepareVisitorForScene( CC3Scene* scene, const CC3Vector& location );
+
+	/** Renders the scene with the specified visitor into the current face of this texture. */
+	void						drawCurrentFaceOfScene( CC3Scene* scene, CC3NodeDrawingVisitor* envMapVisitor );
+
 protected:
 	CC3GLFramebuffer*			m_pRenderSurface;
 	GLfloat						m_numberOfFacesPerSnapshot;
@@ -40,12 +40,15 @@ CC3Scene::CC3Scene()
 	m_pDrawingSequencer = NULL;
 	m_pViewDrawingVisitor = NULL;
 	m_pEnvMapDrawingVisitor = NULL;
+	m_pEnvironmentMapScheduler = NULL;
 	m_pUpdateVisitor = NULL;
 	m_pShadowVisitor = NULL;
+	m_pShadowMapVisitor = NULL;
 	m_pTouchedNodePicker = NULL;
 	m_pPerformanceStatistics = NULL;
 	m_lights = NULL;
 	m_lightProbes = NULL;
+	m_pLightProbeGrid = NULL;
 	m_billboards = NULL;
 }
 
@@ -64,13 +67,16 @@ CC3Scene::~CC3Scene()
 	setDrawingSequenceVisitor( NULL );		// Use setter to release and make nil
 	setViewDrawingVisitor( NULL );			// Use setter to release and make nil
 	setEnvMapDrawingVisitor( NULL );		// Use setter to release and make nil
+	setEnvironmentMapScheduler( NULL );		// Use setter to release and make nil
 	setUpdateVisitor( NULL );				// Use setter to release and make nil
 	setShadowVisitor( NULL );				// Use setter to release and make nil
+	setShadowMapVisitor( NULL );			// Use setter to release and make nil
 	setTouchedNodePicker( NULL );			// Use setter to release and make nil
 	setPerformanceStatistics( NULL );		// Use setter to release and make nil
 	
 	CC_SAFE_RELEASE( m_lights );
 	CC_SAFE_RELEASE( m_lightProbes );
+	CC_SAFE_RELEASE_NULL( m_pLightProbeGrid );
 	CC_SAFE_RELEASE( m_billboards );
 }
 
@@ -265,6 +271,9 @@ void CC3Scene::initWithTag( GLuint aTag, const std::string& aName )
 	m_lights->retain();
 	m_lightProbes = CCArray::create();	// retained
 	m_lightProbes->retain();
+	m_pLightProbeGrid = CC3LightProbeGrid::grid();	// retained
+	m_pLightProbeGrid->retain();
+	m_pLightProbeGrid->setLightProbes( m_lightProbes );
 	m_billboards = CCArray::create();		// retained
 	m_billboards->retain();
 	setDrawingSequenceVisitor( CC3NodeSequencerVisitor::visitorWithScene( this ) );
@@ -450,11 +459,19 @@ void CC3Scene::updateScene( float dt )
 	
 	m_pUpdateVisitor->setDeltaTime( m_deltaFrameTime );
 	m_pUpdateVisitor->visit( this );
+	m_pLightProbeGrid->updateProbeLocations();
 	
 	updateCamera( m_deltaFrameTime );
 	updateBillboards( m_deltaFrameTime );
+
+	// Deliver any transform notifications deferred by moving the camera or billboards,
+	// before the shadows and draw sequence depend on them.
+	CC3NodeTransformNotificationQueue* pNotificationQueue = CC3NodeTransformNotificationQueue::sharedQueue();
+	pNotificationQueue->flush();
+
 	updateShadows( m_deltaFrameTime );
 	updateDrawSequence();
+	pNotificationQueue->flush();
 	
 	//LogTrace(@"******* %@ exiting update", self);
 }
@@ -530,11 +547,18 @@ void CC3Scene::drawSceneWithVisitor( CC3NodeDrawingVisitor* visitor )
 	
 	collectFrameInterval();	// Collect the frame interval in the performance statistics.
 
+	CC3TextureResidencyManager::sharedManager()->update();	// Upload reloaded textures and enforce the texture budget
+
 	open3DWithVisitor( visitor );
 	
 	m_pTouchedNodePicker->pickTouchedNodeWithVisitor( visitor );
 	if ( !m_shouldDisplayPickingRender ) 
+	{
+		drawShadowMapsWithVisitor( visitor );
+		if ( m_pEnvironmentMapScheduler && !visitor->isDrawingEnvironmentMap() )
+			m_pEnvironmentMapScheduler->generateSnapshotsOfScene( this );
 		drawSceneContentWithVisitor( visitor );
+	}
 
 	close3DWithVisitor( visitor );
 
@@ -742,6 +766,18 @@ void CC3Scene::drawShadowsWithVisitor( CC3NodeDrawingVisitor* visitor )
 	}
 }
 
+/** Template method to render the shadow maps of any lights that use them. */
+void CC3Scene::drawShadowMapsWithVisitor( CC3NodeDrawingVisitor* visitor )
+{
+	CCObject* obj = NULL;
+	CCARRAY_FOREACH( m_lights, obj )
+	{
+		CC3Light* lgt = (CC3Light*)obj;
+		if ( lgt->isUsingShadowMap() )
+			lgt->drawShadowMapWithVisitor( this, getShadowMapVisitor() );
+	}
+}
+
 /** If this scene contains fog, configure it in the GL engine. */
 void CC3Scene::configureFogWithVisitor( CC3NodeDrawingVisitor* visitor )
 {
@@ -801,6 +837,18 @@ void CC3Scene::setEnvMapDrawingVisitor( CC3NodeDrawingVisitor* visitor )
 	m_pEnvMapDrawingVisitor = visitor;
 }
 
+CC3EnvironmentMapScheduler* CC3Scene::getEnvironmentMapScheduler()
+{
+	return m_pEnvironmentMapScheduler;
+}
+
+void CC3Scene::setEnvironmentMapScheduler( CC3EnvironmentMapScheduler* scheduler )
+{
+	CC_SAFE_RETAIN( scheduler );
+	CC_SAFE_RELEASE( m_pEnvironmentMapScheduler );
+	m_pEnvironmentMapScheduler = scheduler;
+}
+
 CC3NodeDrawingVisitor* CC3Scene::getShadowVisitor()
 {
 	return m_pShadowVisitor;
@@ -813,6 +861,21 @@ void CC3Scene::setShadowVisitor( CC3NodeDrawingVisitor* visitor )
 	m_pShadowVisitor = visitor;
 }
 
+CC3NodeDrawingVisitor* CC3Scene::getShadowMapVisitor()
+{
+	if ( !m_pShadowMapVisitor )
+		setShadowMapVisitor( CC3ShadowMapDrawingVisitor::visitor() );
+
+	return m_pShadowMapVisitor;
+}
+
+void CC3Scene::setShadowMapVisitor( CC3NodeDrawingVisitor* visitor )
+{
+	CC_SAFE_RELEASE(m_pShadowMapVisitor);
+	CC_SAFE_RETAIN(visitor);
+	m_pShadowMapVisitor = visitor;
+}
+
 void CC3Scene::setDrawingSequenceVisitor( CC3NodeSequencerVisitor* visitor )
 {
 	CC_SAFE_RELEASE(m_pDrawingSequenceVisitor);
@@ -907,7 +970,10 @@ void CC3Scene::didAddDescendant( CC3Node* aNode )
 
 		// If the node is a light probe, add it to the collection of light probes
 		if (addedNode->isLightProbe())
+		{
 			m_lightProbes->addObject( addedNode );
+			m_pLightProbeGrid->markProbesDirty();
+		}
 
 		// if the node is the first camera to be added, make it the active camera.
 		if (addedNode->isCamera() && !m_pActiveCamera) 
@@ -949,7 +1015,11 @@ void CC3Scene::didRemoveDescendant( CC3Node* aNode )
 
 		// If the node is a light probe, remove it from the collection of light probes
 		if (removedNode->isLightProbe())
+		{
 			m_lightProbes->removeObject( removedNode );
+			if ( m_pLightProbeGrid )
+				m_pLightProbeGrid->markProbesDirty();
+		}
 
 		// If the node is a billboard, remove it from the collection of billboards
 		if (removedNode->isBillboard()) 
@@ -1026,6 +1096,11 @@ CCArray* CC3Scene::getLightProbes()
 	return m_lightProbes;
 }
 
+CC3LightProbeGrid* CC3Scene::getLightProbeGrid()
+{
+	return m_pLightProbeGrid;
+}
+
 CC3TouchedNodePicker::CC3TouchedNodePicker()
 {
 	m_pScene = NULL;				// weak reference
@@ -281,6 +281,15 @@ public:
 	 */
 	CCArray*					getLightProbes();
 
+	/**
+	 * Returns the spatial index of the lightProbes of this scene, which is used to find the light
+	 * probes nearest each model, and to blend their spherical harmonics for that model.
+	 *
+	 * The grid tracks the light probes of this scene automatically, as they are added, removed
+	 * or moved. The application may adjust the cellSize and blendCount properties of the grid.
+	 */
+	CC3LightProbeGrid*			getLightProbeGrid();
+
 	/**
 	 * To create a backdrop for this scene, set this to a CC3Backdrop instance, covered with
 	 * either a solid color, or a texture.
@@ -750,6 +759,16 @@ public:
 	 */
 	virtual void				drawShadowsWithVisitor( CC3NodeDrawingVisitor* visitor );
 
+	/**
+	 * Template method that renders the depth textures of the lights that cast shadows using a
+	 * shadow map, using the visitor held in the shadowMapVisitor property.
+	 *
+	 * This method is invoked from the drawSceneWithVisitor: method before the scene content is
+	 * drawn, so that the shadow maps are available to the shaders when drawing the receivers.
+	 * It is not invoked when drawing environment maps.
+	 */
+	virtual void				drawShadowMapsWithVisitor( CC3NodeDrawingVisitor* visitor );
+
 	/**
 	 * Template method that turns on lighting of the 3D scene.
 	 *
@@ -818,6 +837,17 @@ public:
 	CC3NodeDrawingVisitor*		getEnvMapDrawingVisitor();
 	void						setEnvMapDrawingVisitor( CC3NodeDrawingVisitor* visitor );
 
+	/**
+	 * The scheduler that chooses which faces of the registered environment maps are generated on
+	 * each frame, within a shared per-frame budget. If set, the generateSnapshotsOfScene: method
+	 * of the scheduler is invoked on each frame, after shadow maps are drawn, and before the scene
+	 * content is drawn.
+	 *
+	 * The initial value of this property is nil.
+	 */
+	CC3EnvironmentMapScheduler*	getEnvironmentMapScheduler();
+	void						setEnvironmentMapScheduler( CC3EnvironmentMapScheduler* scheduler );
+
 	/**
 	 * The visitor that is used to visit shadow nodes to draw them to the GL engine.
 	 *
@@ -829,6 +859,15 @@ public:
 	CC3NodeDrawingVisitor*		getShadowVisitor();
 	void						setShadowVisitor( CC3NodeDrawingVisitor* visitor );
 
+	/**
+	 * The visitor that is used to render shadow casting nodes into the shadow maps of the lights.
+	 *
+	 * If not set directly, the first time it is accessed, a new instance of the
+	 * CC3ShadowMapDrawingVisitor class will be created and set into this property.
+	 */
+	CC3NodeDrawingVisitor*		getShadowMapVisitor();
+	void						setShadowMapVisitor( CC3NodeDrawingVisitor* visitor );
+
 	/**
 	 * The sequencer visitor used to visit the drawing sequencer during operations
 	 * on the drawing sequencer, such as adding or removing individual nodes.
@@ -1122,6 +1161,7 @@ protected:
 protected:
 	CCArray*					m_lights;
 	CCArray*					m_lightProbes;
+	CC3LightProbeGrid*			m_pLightProbeGrid;
 	CCArray*					m_billboards;
 	CC3Layer*					m_pLayer;
 	CC3Camera*					m_pActiveCamera;
@@ -1131,7 +1171,9 @@ protected:
 	CC3NodeUpdatingVisitor*		m_pUpdateVisitor;
 	CC3NodeDrawingVisitor*		m_pViewDrawingVisitor;
 	CC3NodeDrawingVisitor*		m_pEnvMapDrawingVisitor;
+	CC3EnvironmentMapScheduler*	m_pEnvironmentMapScheduler;
 	CC3NodeDrawingVisitor*		m_pShadowVisitor;
+	CC3NodeDrawingVisitor*		m_pShadowMapVisitor;
 	CC3NodeSequencerVisitor*	m_pDrawingSequenceVisitor;
 	CC3MeshNode*				m_pBackdrop;
 	CC3Fog*						m_pFog;
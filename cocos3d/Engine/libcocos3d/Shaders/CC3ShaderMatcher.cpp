@@ -87,6 +87,12 @@ std::string CC3ShaderMatcherBase::vertexShaderFileForMeshNode( CC3MeshNode* aMes
 	if (aMeshNode->shouldDrawInClipSpace()) 
 		return "CC3ClipSpaceTexturable.vsh";
 	
+	if (aMeshNode->hasSkeleton() && aMeshNode->shouldUseDualQuaternionSkinning()) 
+	{
+		ensureDualQuaternionSkinningLibrary();
+		return "CC3TexturableDualQuaternionBones.vsh";
+	}
+
 	if (aMeshNode->hasRigidSkeleton()) 
 		return "CC3TexturableRigidBones.vsh";
 	
@@ -134,6 +140,58 @@ std::string CC3ShaderMatcherBase::fragmentShaderFileForMeshNode( CC3MeshNode* aM
 	return shouldAlphaTest ? "CC3SingleTextureAlphaTest.fsh" : "CC3SingleTexture.fsh";
 }
 
+/**
+ * GLSL functions that blend the bone dual quaternions held in the u_cc3BoneDualQuaternionsModelSpace
+ * uniform, and use the result to deform vertex locations and directions. Each bone occupies two
+ * consecutive vec4 elements, holding the real and dual parts respectively. Each bone is sign-flipped
+ * against the first bone influencing the vertex, so that the blend takes the shortest path.
+ */
+static const char* _dualQuaternionSkinningLibrarySource =
+	"#ifndef MAX_BONES_PER_BATCH\n"
+	"#define MAX_BONES_PER_BATCH 18\n"
+	"#endif\n"
+	"uniform highp vec4 u_cc3BoneDualQuaternionsModelSpace[MAX_BONES_PER_BATCH * 2];\n"
+	"\n"
+	"void CC3BlendBoneDualQuaternions(vec4 boneIndices, vec4 boneWeights, int boneCount, out highp vec4 dqReal, out highp vec4 dqDual) {\n"
+	"	highp vec4 pivot = u_cc3BoneDualQuaternionsModelSpace[int(boneIndices.x) * 2];\n"
+	"	dqReal = vec4(0.0);\n"
+	"	dqDual = vec4(0.0);\n"
+	"	for (int i = 0; i < 4; i++) {\n"
+	"		if (i >= boneCount) break;\n"
+	"		int bIdx = int(boneIndices[i]) * 2;\n"
+	"		highp vec4 bReal = u_cc3BoneDualQuaternionsModelSpace[bIdx];\n"
+	"		highp float wt = (dot(bReal, pivot) < 0.0) ? -boneWeights[i] : boneWeights[i];\n"
+	"		dqReal += bReal * wt;\n"
+	"		dqDual += u_cc3BoneDualQuaternionsModelSpace[bIdx + 1] * wt;\n"
+	"	}\n"
+	"	highp float invLen = 1.0 / length(dqReal);\n"
+	"	dqReal *= invLen;\n"
+	"	dqDual *= invLen;\n"
+	"}\n"
+	"\n"
+	"highp vec3 CC3DualQuaternionTransformDirection(highp vec4 dqReal, highp vec3 v) {\n"
+	"	return v + 2.0 * cross(dqReal.xyz, cross(dqReal.xyz, v) + dqReal.w * v);\n"
+	"}\n"
+	"\n"
+	"highp vec3 CC3DualQuaternionTransformLocation(highp vec4 dqReal, highp vec4 dqDual, highp vec3 v) {\n"
+	"	highp vec3 t = 2.0 * (dqReal.w * dqDual.xyz - dqDual.w * dqReal.xyz + cross(dqReal.xyz, dqDual.xyz));\n"
+	"	return CC3DualQuaternionTransformDirection(dqReal, v) + t;\n"
+	"}\n";
+
+static CC3ShaderSourceCode* _dualQuaternionSkinningLibrary = NULL;
+
+// The source code cache holds weak references, so the library is retained here to keep it
+// available to any dual-quaternion skinning shader that imports it by name.
+void CC3ShaderMatcherBase::ensureDualQuaternionSkinningLibrary()
+{
+	if ( !_dualQuaternionSkinningLibrary ) 
+	{
+		_dualQuaternionSkinningLibrary = CC3ShaderSourceCode::shaderSourceCodeWithName( "CC3LibDualQuaternionSkinning.vsh",
+																						_dualQuaternionSkinningLibrarySource );
+		_dualQuaternionSkinningLibrary->retain();
+	}
+}
+
 CC3ShaderProgram* CC3ShaderMatcherBase::getPureColorProgramMatching( CC3ShaderProgram* shaderProgram )
 {
 	return CC3ShaderProgram::programWithSemanticDelegate( shaderProgram->getSemanticDelegate(),
@@ -120,6 +120,17 @@ public:
 	CC3ShaderProgram*				getProgramForMeshNode( CC3MeshNode* aMeshNode );
 	std::string						vertexShaderFileForMeshNode( CC3MeshNode* aMeshNode );
 	std::string						fragmentShaderFileForMeshNode( CC3MeshNode* aMeshNode );
+
+	/**
+	 * Ensures that the GLSL library of dual-quaternion skinning functions is available under the
+	 * name "CC3LibDualQuaternionSkinning.vsh", so that vertex shaders selected for mesh nodes using
+	 * dual-quaternion skinning can import it, without the app having to supply it as a file.
+	 *
+	 * The library declares the u_cc3BoneDualQuaternionsModelSpace uniform, sized by MAX_BONES_PER_BATCH,
+	 * and the CC3BlendBoneDualQuaternions, CC3DualQuaternionTransformLocation and
+	 * CC3DualQuaternionTransformDirection functions.
+	 */
+	static void						ensureDualQuaternionSkinningLibrary();
 	CC3ShaderProgram*				getPureColorProgramMatching( CC3ShaderProgram* shaderProgram );
 	virtual bool					init();
 	void							initSemanticDelegate();
@@ -130,6 +130,12 @@ std::string stringFromCC3Semantic(CC3Semantic semantic)
 		case kCC3SemanticLightProbeLocationEyeSpace: return "kCC3SemanticLightProbeLocationEyeSpace";
 		case kCC3SemanticLightProbeLocationModelSpace: return "kCC3SemanticLightProbeLocationModelSpace";
 		case kCC3SemanticLightProbeColorDiffuse: return "kCC3SemanticLightProbeColorDiffuse";
+		case kCC3SemanticLightProbeSH: return "kCC3SemanticLightProbeSH";
+
+		case kCC3SemanticShadowMapCascadeCount: return "kCC3SemanticShadowMapCascadeCount";
+		case kCC3SemanticShadowMapMatrices: return "kCC3SemanticShadowMapMatrices";
+		case kCC3SemanticShadowMapSplitDistances: return "kCC3SemanticShadowMapSplitDistances";
+		case kCC3SemanticShadowMapDepthBias: return "kCC3SemanticShadowMapDepthBias";
 			
 		case kCC3SemanticFogIsEnabled: return "kCC3SemanticFogIsEnabled";
 		case kCC3SemanticFogColor: return "kCC3SemanticFogColor";
@@ -146,6 +152,7 @@ std::string stringFromCC3Semantic(CC3Semantic semantic)
 		case kCC3SemanticTextureCubeCount: return "kCC3SemanticTextureCubeCount";
 		case kCC3SemanticTextureCubeSampler: return "kCC3SemanticTextureCubeSampler";
 		case kCC3SemanticTextureLightProbeSampler: return "kCC3SemanticTextureLightProbeSampler";
+		case kCC3SemanticTextureShadowMapSampler: return "kCC3SemanticTextureShadowMapSampler";
 			
 		case kCC3SemanticTexUnitMode: return "kCC3SemanticTexUnitMode";
 		case kCC3SemanticTexUnitConstantColor: return "kCC3SemanticTexUnitConstantColor";
@@ -194,6 +201,7 @@ std::string stringFromCC3Semantic(CC3Semantic semantic)
 		case kCC3SemanticBoneQuaternionsModelSpace: return "kCC3SemanticBoneQuaternionsModelSpace";
 		case kCC3SemanticBoneTranslationsModelSpace: return "kCC3SemanticBoneTranslationsModelSpace";
 		case kCC3SemanticBoneScalesModelSpace: return "kCC3SemanticBoneScalesModelSpace";
+		case kCC3SemanticBoneDualQuaternionsModelSpace: return "kCC3SemanticBoneDualQuaternionsModelSpace";
 			
 		// PARTICLES ------------
 		case kCC3SemanticPointSize: return "kCC3SemanticPointSize";
@@ -321,6 +329,7 @@ CC3GLSLVariableScope CC3ShaderSemanticsBase::getVariableScopeForSemantic( GLenum
 		case kCC3SemanticBoneQuaternionsModelSpace:
 		case kCC3SemanticBoneTranslationsModelSpace:
 		case kCC3SemanticBoneScalesModelSpace:
+		case kCC3SemanticBoneDualQuaternionsModelSpace:
 			
 			return kCC3GLSLVariableScopeDraw;
 
@@ -359,6 +368,11 @@ CC3GLSLVariableScope CC3ShaderSemanticsBase::getVariableScopeForSemantic( GLenum
 		case kCC3SemanticLightSpotCutoffAngle:
 		case kCC3SemanticLightSpotCutoffAngleCosine:
 
+		case kCC3SemanticShadowMapCascadeCount:
+		case kCC3SemanticShadowMapMatrices:
+		case kCC3SemanticShadowMapSplitDistances:
+		case kCC3SemanticShadowMapDepthBias:
+
 		case kCC3SemanticFogIsEnabled:
 		case kCC3SemanticFogColor:
 		case kCC3SemanticFogAttenuationMode:
@@ -758,6 +772,22 @@ bool CC3ShaderSemanticsBase::populateUniform( CC3GLSLUniform* uniform, CC3NodeDr
 				}
 			}
 			return true;
+		case kCC3SemanticBoneDualQuaternionsModelSpace:
+			{
+				CC3AssertBoneUniformForSkinSection(uniform, visitor->getCurrentSkinSection());
+				CC3SkinSection* pSection = visitor->getCurrentSkinSection();
+				if ( pSection )
+				{
+					boneCnt = pSection->getBoneCount();
+					for (GLuint boneIdx = 0; boneIdx < boneCnt; boneIdx++) 
+					{
+						const CC3DualQuaternion* pDQ = pSection->getDualQuaternionForBoneAt( boneIdx );
+						uniform->setVector4( pDQ->real, boneIdx * 2 );
+						uniform->setVector4( pDQ->dual, boneIdx * 2 + 1 );
+					}
+				}
+			}
+			return true;
 
 		// CAMERA -----------------
 		case kCC3SemanticCameraLocationGlobal:
@@ -1064,6 +1094,51 @@ bool CC3ShaderSemanticsBase::populateUniform( CC3GLSLUniform* uniform, CC3NodeDr
 				uniform->setColor4F( lpColor, i );
 			}
 			return true;
+		case kCC3SemanticLightProbeSH:
+			{
+				// The nine coefficients are pre-convolved for diffuse lighting, so the shader
+				// evaluates the irradiance by dotting them with the basis at the global normal.
+				CC3MeshNode* meshNode = visitor->getCurrentMeshNode();
+				const CC3SphericalHarmonics& sh = meshNode ? meshNode->getLightProbeHarmonics()
+														   : CC3SphericalHarmonics::kCC3SphericalHarmonicsZero;
+				for (GLint i = 0; i < uniformSize; i++)
+				{
+					GLint shIdx = semanticIndex + i;
+					uniform->setVector( (shIdx < 9) ? sh.coefficients[shIdx] : CC3Vector::kCC3VectorZero, i );
+				}
+			}
+			return true;
+
+		case kCC3SemanticShadowMapCascadeCount:
+			{
+				CC3ShadowMap* sm = visitor->getShadowMap();
+				uniform->setInteger( sm ? sm->getActiveCascadeCount() : 0 );
+			}
+			return true;
+		case kCC3SemanticShadowMapMatrices:
+			{
+				CC3ShadowMap* sm = visitor->getShadowMap();
+				GLuint cscCnt = sm ? sm->getActiveCascadeCount() : 0;
+				for (GLint i = 0; i < uniformSize; i++)
+				{
+					GLuint cscIdx = semanticIndex + i;
+					if (cscIdx < cscCnt)
+						uniform->setMatrix4x4( sm->getShadowMatrixAt( cscIdx ), i );
+				}
+			}
+			return true;
+		case kCC3SemanticShadowMapSplitDistances:
+			{
+				CC3ShadowMap* sm = visitor->getShadowMap();
+				uniform->setVector4( sm ? sm->getSplitDistances() : CC3Vector4( 0, 0, 0, 0 ) );
+			}
+			return true;
+		case kCC3SemanticShadowMapDepthBias:
+			{
+				CC3ShadowMap* sm = visitor->getShadowMap();
+				uniform->setFloat( sm ? sm->getDepthBias() : kCC3DefaultShadowMapDepthBias );
+			}
+			return true;
 			
 		case kCC3SemanticFogIsEnabled:
 			{
@@ -1172,6 +1247,13 @@ bool CC3ShaderSemanticsBase::populateUniform( CC3GLSLUniform* uniform, CC3NodeDr
 				uniform->setInteger( semanticIndex + i, i );
 			return true;
 			
+		case kCC3SemanticTextureShadowMapSampler:
+			// Shadow map samplers always come after the light probe samplers, and are consecutive.
+			semanticIndex += visitor->getCurrentShaderProgram()->getTextureShadowMapStart();
+			for (GLint i = 0; i < uniformSize; i++) 
+				uniform->setInteger( semanticIndex + i, i );
+			return true;
+			
 		// The semantics below mimic OpenGL ES 1.1 configuration functionality for combining texture units.
 		// In most shaders, these will be left unused in favor of customized the texture combining in code.
 		case kCC3SemanticTexUnitMode:
@@ -1556,6 +1638,7 @@ void CC3ShaderSemanticsByVarName::populateWithDefaultVariableNameMappings()
 	mapVarName( "u_cc3BoneQuaternionsModelSpace", kCC3SemanticBoneQuaternionsModelSpace );		/**< (vec4[]) Array of bone quaternions in the current mesh skin section in model space (length of array is specified by u_cc3BatchBoneCount). */
 	mapVarName( "u_cc3BoneTranslationsModelSpace", kCC3SemanticBoneTranslationsModelSpace );	/**< (vec3[]) Array of bone translations in the current mesh skin section in model space (length of array is specified by u_cc3BatchBoneCount). */
 	mapVarName( "u_cc3BoneScalesModelSpace", kCC3SemanticBoneScalesModelSpace );				/**< (vec3[]) Array of bone scales in the current mesh skin section in model space (length of array is specified by u_cc3BatchBoneCount). */
+	mapVarName( "u_cc3BoneDualQuaternionsModelSpace", kCC3SemanticBoneDualQuaternionsModelSpace );	/**< (vec4[]) Array of bone dual quaternions in the current mesh skin section in model space, as real and dual pairs (length of array is twice u_cc3BatchBoneCount). */
 	
 	// CAMERA -----------------
 	mapVarName( "u_cc3CameraPositionGlobal", kCC3SemanticCameraLocationGlobal );		/**< (vec3) Location of the camera in global coordinates. */
@@ -1602,6 +1685,12 @@ void CC3ShaderSemanticsByVarName::populateWithDefaultVariableNameMappings()
 	mapVarName( "u_cc3LightProbeLocationEyeSpace", kCC3SemanticLightProbeLocationEyeSpace );		/**< (vec3[]) Location of each light probe in eye space. */
 	mapVarName( "u_cc3LightProbeLocationModelSpace", kCC3SemanticLightProbeLocationModelSpace );	/**< (vec3[]) Location of each light probe in local coordinates of the model (not light probe). */
 	mapVarName( "u_cc3LightProbeColorDiffuse", kCC3SemanticLightProbeColorDiffuse );				/**< (vec4) Diffuse color of each light probe. */
+	mapVarName( "u_cc3LightProbeSH", kCC3SemanticLightProbeSH );									/**< (vec3[9]) Irradiance spherical harmonics blended from the nearest light probes. */
+
+	mapVarName( "u_cc3ShadowMapCascadeCount", kCC3SemanticShadowMapCascadeCount );			/**< (int) Number of active shadow map cascades. */
+	mapVarName( "u_cc3ShadowMapMatrices", kCC3SemanticShadowMapMatrices );					/**< (mat4[]) Global to depth texture space matrix of each cascade. */
+	mapVarName( "u_cc3ShadowMapSplitDistances", kCC3SemanticShadowMapSplitDistances );		/**< (vec4) Camera view distance at which each cascade ends. */
+	mapVarName( "u_cc3ShadowMapDepthBias", kCC3SemanticShadowMapDepthBias );				/**< (float) Depth bias to apply when comparing against the shadow map. */
 	
 	mapVarName( "u_cc3FogIsEnabled", kCC3SemanticFogIsEnabled );				/**< (bool) Whether scene fogging is enabled. */
 	mapVarName( "u_cc3FogColor", kCC3SemanticFogColor );						/**< (vec4) Fog color. */
@@ -1625,6 +1714,7 @@ void CC3ShaderSemanticsByVarName::populateWithDefaultVariableNameMappings()
 	
 	mapVarName( "s_cc3LightProbeTexture", kCC3SemanticTextureLightProbeSampler );		/**< (samplerCube or sampler2D) Single light probe texture sampler. */
 	mapVarName( "s_cc3LightProbeTextures", kCC3SemanticTextureLightProbeSampler );		/**< (samplerCube[] or sampler2D[]) Array of light probe texture samplers. */
+	mapVarName( "s_cc3ShadowMapTextures", kCC3SemanticTextureShadowMapSampler );		/**< (sampler2D[]) Array of shadow map cascade depth texture samplers. */
 
 	// The semantics below mimic OpenGL ES 1.1 configuration functionality for combining texture units.
 	// In most shaders, these will be left unused in favor of customized the texture combining in GLSL code.
@@ -136,6 +136,7 @@ typedef enum {
 	kCC3SemanticBoneQuaternionsModelSpace,		/**< (vec4[]) Array of bone quaternions in the current mesh skin section in local coordinates of model (length of array is specified by kCC3SemanticBatchBoneCount). */
 	kCC3SemanticBoneTranslationsModelSpace,		/**< (vec3[]) Array of bone translations in the current mesh skin section in local coordinates of model (length of array is specified by kCC3SemanticBatchBoneCount). */
 	kCC3SemanticBoneScalesModelSpace,			/**< (vec3[]) Array of bone scales in the current mesh skin section in local coordinates of model (length of array is specified by kCC3SemanticBatchBoneCount). */
+	kCC3SemanticBoneDualQuaternionsModelSpace,	/**< (vec4[]) Array of bone unit dual quaternions in the current mesh skin section in local coordinates of model, as pairs of real and dual parts (length of array is twice kCC3SemanticBatchBoneCount). */
 	
 	// CAMERA -----------------
 	kCC3SemanticCameraLocationGlobal,			/**< (vec3) Location of the camera in global coordinates. */
@@ -184,6 +185,12 @@ typedef enum {
 	kCC3SemanticLightProbeLocationEyeSpace,		/**< (vec3[]) Location of each light probe in eye space. */
 	kCC3SemanticLightProbeLocationModelSpace,	/**< (vec3[]) Location of each light probe in local coordinates of the model (not light probe). */
 	kCC3SemanticLightProbeColorDiffuse,			/**< (vec4) Diffuse color of each light probe. */
+	kCC3SemanticLightProbeSH,					/**< (vec3[9]) Irradiance spherical harmonics blended from the light probes nearest the model. */
+
+	kCC3SemanticShadowMapCascadeCount,			/**< (int) Number of active cascades in the shadow map of the first shadow-mapped light. */
+	kCC3SemanticShadowMapMatrices,				/**< (mat4[]) Global to depth texture space matrix of each shadow map cascade. */
+	kCC3SemanticShadowMapSplitDistances,		/**< (vec4) Camera view distance at which each shadow map cascade ends. */
+	kCC3SemanticShadowMapDepthBias,				/**< (float) Depth bias to apply when comparing against the shadow map. */
 
 	kCC3SemanticFogIsEnabled,					/**< (bool) Whether scene fogging is enabled. */
 	kCC3SemanticFogColor,						/**< (vec4) Fog color. */
@@ -200,6 +207,7 @@ typedef enum {
 	kCC3SemanticTextureCubeCount,				/**< (int) Number of active cube-map textures on the current model. */
 	kCC3SemanticTextureCubeSampler,				/**< (samplerCube[]) Array of cube-map texture samplers. */
 	kCC3SemanticTextureLightProbeSampler,		/**< (samplerCube[]/sampler2D[]) Array of light probe texture samplers. */
+	kCC3SemanticTextureShadowMapSampler,		/**< (sampler2D[]) Array of shadow map cascade depth texture samplers. */
 
 	// The semantics below mimic OpenGL ES 1.1 configuration functionality for combining texture units.
 	// In most shaders, these will be left unused in favor of customized the texture combining in code.
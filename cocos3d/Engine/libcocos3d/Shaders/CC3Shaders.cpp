@@ -792,20 +792,12 @@ void CC3ShaderProgram::setWillBeginDrawingScene()
 	if ( _programCache == NULL )
 		return;
 
-	CCDictionary* shaders = _programCache->getAllObjects();
-	CCArray* keys = shaders->allKeys();
-	if ( keys == NULL )
-		return;
-
-	for (unsigned int i = 0; i < keys->count(); i++)
+	CCArray* programs = _programCache->getAllObjects();
+	CCObject* pObj = NULL;
+	CCARRAY_FOREACH( programs, pObj )
 	{
-		CCString* key = (CCString*)keys->objectAtIndex( i );
-		if ( key )
-		{
-			CC3ShaderProgram* program = ( CC3ShaderProgram* )_programCache->getObjectNamed( key->getCString() );
-			if ( program ) 
-				program->willBeginDrawingScene();
-		}
+		CC3ShaderProgram* program = (CC3ShaderProgram*)pObj;
+		program->willBeginDrawingScene();
 	}
 }
 
@@ -883,6 +875,16 @@ GLuint CC3ShaderProgram::getTextureLightProbeCount()
 	return m_textureLightProbeCount;
 }
 
+GLuint CC3ShaderProgram::getTextureShadowMapStart()
+{
+	return getTextureLightProbeStart() + m_textureLightProbeCount;
+}
+
+GLuint CC3ShaderProgram::getTextureShadowMapCount()
+{
+	return m_textureShadowMapCount;
+}
+
 void CC3ShaderProgram::link()
 {
 	CCAssert(m_pVertexShader && m_pFragmentShader, "CC3Shader requires both vertex and fragment shaders to be assigned before linking.");
@@ -940,6 +942,7 @@ void CC3ShaderProgram::clearUniforms()
 	m_texture2DCount = 0;
 	m_textureCubeCount = 0;
 	m_textureLightProbeCount = 0;
+	m_textureShadowMapCount = 0;
 }
 
 /** Let the delegate configure the uniform, and then update the texture counts. */
@@ -955,6 +958,8 @@ void CC3ShaderProgram::configureUniform( CC3GLSLUniform* var )
 		m_textureCubeCount += var->getSize();
 	if (var->getSemantic() == kCC3SemanticTextureLightProbeSampler) 
 		m_textureLightProbeCount += var->getSize();
+	if (var->getSemantic() == kCC3SemanticTextureShadowMapSampler) 
+		m_textureShadowMapCount += var->getSize();
 }
 
 /** Adds the specified uniform to the appropriate internal collection, based on variable scope. */
@@ -1114,6 +1119,7 @@ void CC3ShaderProgram::initWithTag( GLuint aTag, const std::string& aName )
 		m_texture2DCount = 0;
 		m_textureCubeCount = 0;
 		m_textureLightProbeCount = 0;
+		m_textureShadowMapCount = 0;
 		m_isSceneScopeDirty = true;	// start out dirty for auto-loaded programs
 		m_pSemanticDelegate = NULL;
 		m_shouldAllowDefaultVariableValues = defaultShouldAllowDefaultVariableValues();
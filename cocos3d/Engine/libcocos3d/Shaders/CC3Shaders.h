@@ -610,6 +610,17 @@ public:
 	/** Returns the number of light probe textures supported by this shader program. */
 	GLuint						getTextureLightProbeCount();
 
+	/**
+	 * Returns the texture unit index of the first shadow map texture supported by this shader program.
+	 *
+	 * The shadow map textures are allocated consecutive texture units beginning at the returned
+	 * texture unit, which follows the light probe textures.
+	 */
+	GLuint						getTextureShadowMapStart();
+
+	/** Returns the number of shadow map textures supported by this shader program. */
+	GLuint						getTextureShadowMapCount();
+
 	/**
 	 * Each uniform used by this shader program must have a valid value. This property can be used to 
 	 * indicate whether a uniform, whose value cannot be determined, will use its standard default value.
@@ -1215,6 +1226,7 @@ protected:
 	GLuint						m_texture2DCount;
 	GLuint						m_textureCubeCount;
 	GLuint						m_textureLightProbeCount;
+	GLuint						m_textureShadowMapCount;
 	bool						m_shouldAllowDefaultVariableValues : 1;
 	bool						m_isSceneScopeDirty : 1;
 };
@@ -0,0 +1,500 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#include "cocos3d.h"
+
+NS_COCOS3D_BEGIN
+
+CC3ShadowMap::CC3ShadowMap()
+{
+	m_light = NULL;
+	for (GLuint i = 0; i < kCC3MaxShadowMapCascades; i++)
+		m_renderSurfaces[i] = NULL;
+}
+
+CC3ShadowMap::~CC3ShadowMap()
+{
+	releaseRenderSurfaces();
+}
+
+void CC3ShadowMap::initForLight( CC3Light* light )
+{
+	m_light = light;
+	m_cascadeCount = kCC3MaxShadowMapCascades;
+	m_mapSize = kCC3DefaultShadowMapSize;
+	m_splitLambda = kCC3DefaultShadowMapSplitLambda;
+	m_maxShadowDistance = 0.0f;
+	m_casterReach = 100.0f;
+	m_depthBias = kCC3DefaultShadowMapDepthBias;
+
+	for (GLuint i = 0; i < kCC3MaxShadowMapCascades; i++)
+	{
+		CC3ShadowMapCascade* csc = &m_cascades[i];
+		CC3Matrix4x3PopulateIdentity( &csc->viewMatrix );
+		CC3Matrix4x4PopulateIdentity( &csc->projMatrix );
+		CC3Matrix4x4PopulateIdentity( &csc->viewProjMatrix );
+		CC3Matrix4x4PopulateIdentity( &csc->textureMatrix );
+		csc->splitNear = 0.0f;
+		csc->splitFar = 0.0f;
+	}
+}
+
+CC3ShadowMap* CC3ShadowMap::shadowMapForLight( CC3Light* light )
+{
+	CC3ShadowMap* pMap = new CC3ShadowMap;
+	pMap->initForLight( light );
+	pMap->autorelease();
+
+	return pMap;
+}
+
+CC3Light* CC3ShadowMap::getLight()
+{
+	return m_light;
+}
+
+void CC3ShadowMap::setLight( CC3Light* light )
+{
+	m_light = light;		// weak reference
+}
+
+GLuint CC3ShadowMap::getCascadeCount()
+{
+	return m_cascadeCount;
+}
+
+void CC3ShadowMap::setCascadeCount( GLuint count )
+{
+	m_cascadeCount = CLAMP(count, 1, kCC3MaxShadowMapCascades);
+}
+
+/** Directional lights use all cascades, spot lights use one, and point lights cannot be mapped. */
+GLuint CC3ShadowMap::getActiveCascadeCount()
+{
+	if ( !m_light )
+		return 0;
+
+	if ( m_light->isDirectionalOnly() )
+		return m_cascadeCount;
+
+	return (m_light->getSpotCutoffAngle() < 90.0f) ? 1 : 0;
+}
+
+GLuint CC3ShadowMap::getMapSize()
+{
+	return m_mapSize;
+}
+
+void CC3ShadowMap::setMapSize( GLuint mapSize )
+{
+	if (mapSize == m_mapSize)
+		return;
+
+	m_mapSize = mapSize;
+	releaseRenderSurfaces();
+}
+
+GLfloat CC3ShadowMap::getSplitLambda()
+{
+	return m_splitLambda;
+}
+
+void CC3ShadowMap::setSplitLambda( GLfloat lambda )
+{
+	m_splitLambda = CLAMP(lambda, 0.0f, 1.0f);
+}
+
+GLfloat CC3ShadowMap::getMaxShadowDistance()
+{
+	return m_maxShadowDistance;
+}
+
+void CC3ShadowMap::setMaxShadowDistance( GLfloat distance )
+{
+	m_maxShadowDistance = MAX(distance, 0.0f);
+}
+
+GLfloat CC3ShadowMap::getCasterReach()
+{
+	return m_casterReach;
+}
+
+void CC3ShadowMap::setCasterReach( GLfloat reach )
+{
+	m_casterReach = MAX(reach, 0.0f);
+}
+
+GLfloat CC3ShadowMap::getDepthBias()
+{
+	return m_depthBias;
+}
+
+void CC3ShadowMap::setDepthBias( GLfloat bias )
+{
+	m_depthBias = bias;
+}
+
+CC3ShadowMapCascade* CC3ShadowMap::getCascadeAt( GLuint index )
+{
+	CCAssert(index < kCC3MaxShadowMapCascades, "CC3ShadowMap cascade index out of range");
+	return &m_cascades[index];
+}
+
+const CC3Matrix4x4* CC3ShadowMap::getShadowMatrixAt( GLuint index )
+{
+	return &getCascadeAt( index )->textureMatrix;
+}
+
+CC3Vector4 CC3ShadowMap::getSplitDistances()
+{
+	GLfloat splits[kCC3MaxShadowMapCascades];
+	GLuint cscCnt = getActiveCascadeCount();
+	GLfloat lastSplit = 0.0f;
+	for (GLuint i = 0; i < kCC3MaxShadowMapCascades; i++)
+	{
+		if (i < cscCnt)
+			lastSplit = m_cascades[i].splitFar;
+		splits[i] = lastSplit;
+	}
+	return CC3Vector4( splits[0], splits[1], splits[2], splits[3] );
+}
+
+CC3GLFramebuffer* CC3ShadowMap::getRenderSurfaceAt( GLuint index )
+{
+	CC3GLFramebuffer* surface = m_renderSurfaces[index];
+	if ( !surface )
+	{
+		CC3Texture* depthTex = CC3Texture::textureWithPixelFormat( GL_DEPTH_COMPONENT, GL_UNSIGNED_INT );
+		depthTex->setMinifyingFunction( GL_NEAREST );
+		depthTex->setMagnifyingFunction( GL_NEAREST );
+		depthTex->setHorizontalWrappingFunction( GL_CLAMP_TO_EDGE );
+		depthTex->setVerticalWrappingFunction( GL_CLAMP_TO_EDGE );
+
+		surface = CC3GLFramebuffer::surface();
+		surface->setName( CC3String::stringWithFormat( (char*)"Shadow map cascade %u", index ) );
+		surface->setDepthTexture( depthTex );
+		surface->setSize( CC3IntSizeMake( m_mapSize, m_mapSize ) );
+		surface->validate();
+
+		surface->retain();
+		m_renderSurfaces[index] = surface;
+	}
+	return surface;
+}
+
+CC3Texture* CC3ShadowMap::getDepthTextureAt( GLuint index )
+{
+	return getRenderSurfaceAt( index )->getDepthTexture();
+}
+
+void CC3ShadowMap::releaseRenderSurfaces()
+{
+	for (GLuint i = 0; i < kCC3MaxShadowMapCascades; i++)
+		CC_SAFE_RELEASE_NULL( m_renderSurfaces[i] );
+}
+
+/**
+ * Splits the shadowed portion of the camera view into the active number of cascades, using the
+ * practical split scheme, which blends a logarithmic distribution with a uniform distribution.
+ */
+void CC3ShadowMap::updateWithCamera( CC3Camera* camera )
+{
+	GLuint cscCnt = getActiveCascadeCount();
+	if ( !camera || !cscCnt )
+		return;
+
+	if ( !m_light->isDirectionalOnly() )
+	{
+		updateSpotCascade( 0 );
+		finishCascade( 0 );
+		return;
+	}
+
+	GLfloat camNear = camera->getNearClippingDistance();
+	GLfloat camFar = camera->getFarClippingDistance();
+	GLfloat shdwFar = (m_maxShadowDistance > 0.0f) ? MIN(m_maxShadowDistance, camFar) : camFar;
+	GLfloat ratio = shdwFar / camNear;
+	GLfloat range = shdwFar - camNear;
+
+	GLfloat splitNear = camNear;
+	for (GLuint i = 0; i < cscCnt; i++)
+	{
+		GLfloat p = (GLfloat)(i + 1) / (GLfloat)cscCnt;
+		GLfloat logSplit = camNear * powf( ratio, p );
+		GLfloat uniSplit = camNear + range * p;
+		GLfloat splitFar = (m_splitLambda * logSplit) + ((1.0f - m_splitLambda) * uniSplit);
+
+		updateDirectionalCascade( i, camera, splitNear, splitFar );
+		finishCascade( i );
+		splitNear = splitFar;
+	}
+}
+
+/**
+ * Fits an orthographic light-space box around the bounding sphere of the slice of the camera
+ * frustum between the specified split distances. Using a sphere keeps the size of the box
+ * constant as the camera rotates, and snapping the box to whole texels keeps the shadow edges
+ * from shimmering as the camera moves.
+ */
+void CC3ShadowMap::updateDirectionalCascade( GLuint index, CC3Camera* camera, GLfloat splitNear, GLfloat splitFar )
+{
+	CC3ShadowMapCascade* csc = &m_cascades[index];
+	csc->splitNear = splitNear;
+	csc->splitFar = splitFar;
+
+	// Interpolate the frustum corners at the split distances
+	CC3Frustum* frustum = camera->getFrustum();
+	GLfloat camNear = camera->getNearClippingDistance();
+	GLfloat camRange = camera->getFarClippingDistance() - camNear;
+	GLfloat tNear = (splitNear - camNear) / camRange;
+	GLfloat tFar = (splitFar - camNear) / camRange;
+
+	CC3Vector nearCorners[4] = { frustum->getNearTopLeft(), frustum->getNearTopRight(),
+								 frustum->getNearBottomLeft(), frustum->getNearBottomRight() };
+	CC3Vector farCorners[4] = { frustum->getFarTopLeft(), frustum->getFarTopRight(),
+								frustum->getFarBottomLeft(), frustum->getFarBottomRight() };
+	CC3Vector corners[8];
+	CC3Vector center = CC3Vector::kCC3VectorZero;
+	for (GLuint i = 0; i < 4; i++)
+	{
+		CC3Vector edge = farCorners[i] - nearCorners[i];
+		corners[i] = nearCorners[i] + edge * tNear;
+		corners[i + 4] = nearCorners[i] + edge * tFar;
+		center += corners[i] + corners[i + 4];
+	}
+	center /= 8.0f;
+
+	GLfloat radius = 0.0f;
+	for (GLuint i = 0; i < 8; i++)
+		radius = MAX(radius, center.distance( corners[i] ));
+	radius = ceilf( radius * 16.0f ) / 16.0f;
+
+	// Rotation-only view matrix looking along the direction the light travels
+	CC3Vector4 lgtPos = m_light->getGlobalHomogeneousPosition();
+	CC3Vector lightDir = CC3Vector( -lgtPos.x, -lgtPos.y, -lgtPos.z ).normalize();
+	CC3Vector upDir = CC3Vector::kCC3VectorUnitYPositive;
+	if ( lightDir.isParallelWith( upDir ) )
+		upDir = CC3Vector::kCC3VectorUnitXPositive;
+
+	CC3Matrix4x3PopulateToPointTowards( &csc->viewMatrix, lightDir, upDir );
+	CC3Matrix4x3InvertRigid( &csc->viewMatrix );
+
+	// Snap the light-space center of the box to whole texels
+	CC3Vector lsCenter = CC3Matrix4x3TransformLocation( &csc->viewMatrix, center );
+	GLfloat texelSize = (2.0f * radius) / (GLfloat)m_mapSize;
+	lsCenter.x = floorf( lsCenter.x / texelSize ) * texelSize;
+	lsCenter.y = floorf( lsCenter.y / texelSize ) * texelSize;
+
+	// Light space looks down the negative Z-axis. Extend the near side towards the light,
+	// so that casters outside the view frustum can still cast into it.
+	CC3Matrix4x4PopulateOrthoFrustum( &csc->projMatrix,
+									  lsCenter.x - radius, lsCenter.x + radius,
+									  lsCenter.y + radius, lsCenter.y - radius,
+									  -lsCenter.z - radius - m_casterReach,
+									  -lsCenter.z + radius );
+}
+
+/** A spot light uses a single perspective map that covers the cone of the light. */
+void CC3ShadowMap::updateSpotCascade( GLuint index )
+{
+	CC3ShadowMapCascade* csc = &m_cascades[index];
+
+	CC3Camera* cam = m_light->getActiveCamera();
+	GLfloat farDist = m_maxShadowDistance;
+	if (farDist <= 0.0f)
+		farDist = cam ? cam->getFarClippingDistance() : 1000.0f;
+	GLfloat nearDist = MAX(farDist * 0.001f, 0.01f);
+
+	csc->splitNear = 0.0f;
+	csc->splitFar = farDist;
+
+	CC3Matrix4x3PopulateToPointTowards( &csc->viewMatrix, m_light->getGlobalForwardDirection(), m_light->getGlobalUpDirection() );
+	CC3Vector& col4 = *(CC3Vector*)&csc->viewMatrix.c4r1;
+	col4 = m_light->getGlobalLocation();
+	CC3Matrix4x3InvertRigid( &csc->viewMatrix );
+
+	GLfloat halfExtent = nearDist * tanf( CC_DEGREES_TO_RADIANS( m_light->getSpotCutoffAngle() ) );
+	CC3Matrix4x4PopulatePerspectiveFrustum( &csc->projMatrix,
+										   -halfExtent, halfExtent, halfExtent, -halfExtent,
+										   nearDist, farDist );
+}
+
+/**
+ * Derives the combined matrices of the cascade, and extracts the culling planes from the
+ * view-projection matrix. Each plane is normalized and faces into the cascade volume.
+ */
+void CC3ShadowMap::finishCascade( GLuint index )
+{
+	CC3ShadowMapCascade* csc = &m_cascades[index];
+
+	CC3Matrix4x4 viewMtx;
+	CC3Matrix4x4PopulateFrom4x3( &viewMtx, &csc->viewMatrix );
+	CC3Matrix4x4Multiply( &csc->viewProjMatrix, &csc->projMatrix, &viewMtx );
+
+	// Map clip space [-1, 1] to texture space [0, 1]
+	CC3Matrix4x4 biasMtx;
+	CC3Matrix4x4PopulateIdentity( &biasMtx );
+	biasMtx.c1r1 = biasMtx.c2r2 = biasMtx.c3r3 = 0.5f;
+	biasMtx.c4r1 = biasMtx.c4r2 = biasMtx.c4r3 = 0.5f;
+	CC3Matrix4x4Multiply( &csc->textureMatrix, &biasMtx, &csc->viewProjMatrix );
+
+	const CC3Matrix4x4* m = &csc->viewProjMatrix;
+	CC3Vector4 row1( m->c1r1, m->c2r1, m->c3r1, m->c4r1 );
+	CC3Vector4 row2( m->c1r2, m->c2r2, m->c3r2, m->c4r2 );
+	CC3Vector4 row3( m->c1r3, m->c2r3, m->c3r3, m->c4r3 );
+	CC3Vector4 row4( m->c1r4, m->c2r4, m->c3r4, m->c4r4 );
+
+	csc->planes[0] = CC3Plane::normalize( CC3Plane( row4.x + row1.x, row4.y + row1.y, row4.z + row1.z, row4.w + row1.w ) );	// left
+	csc->planes[1] = CC3Plane::normalize( CC3Plane( row4.x - row1.x, row4.y - row1.y, row4.z - row1.z, row4.w - row1.w ) );	// right
+	csc->planes[2] = CC3Plane::normalize( CC3Plane( row4.x + row2.x, row4.y + row2.y, row4.z + row2.z, row4.w + row2.w ) );	// bottom
+	csc->planes[3] = CC3Plane::normalize( CC3Plane( row4.x - row2.x, row4.y - row2.y, row4.z - row2.z, row4.w - row2.w ) );	// top
+	csc->planes[4] = CC3Plane::normalize( CC3Plane( row4.x + row3.x, row4.y + row3.y, row4.z + row3.z, row4.w + row3.w ) );	// near
+	csc->planes[5] = CC3Plane::normalize( CC3Plane( row4.x - row3.x, row4.y - row3.y, row4.z - row3.z, row4.w - row3.w ) );	// far
+}
+
+/** The box is outside if its corner furthest along the normal of any plane is behind that plane. */
+bool CC3ShadowMap::doesCascadeIntersectNode( GLuint index, CC3Node* aNode )
+{
+	CC3Box gbb = aNode->getGlobalBoundingBox();
+	if ( gbb.isNull() )
+		return true;
+
+	CC3ShadowMapCascade* csc = &m_cascades[index];
+	for (GLuint i = 0; i < 6; i++)
+	{
+		const CC3Plane& pln = csc->planes[i];
+		CC3Vector pv( (pln.a >= 0.0f) ? gbb.maximum.x : gbb.minimum.x,
+					  (pln.b >= 0.0f) ? gbb.maximum.y : gbb.minimum.y,
+					  (pln.c >= 0.0f) ? gbb.maximum.z : gbb.minimum.z );
+		if (pln.distance( pv ) < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+void CC3ShadowMap::drawWithVisitor( CC3Scene* scene, CC3NodeDrawingVisitor* visitor )
+{
+	CC3ShadowMapDrawingVisitor* smVisitor = dynamic_cast<CC3ShadowMapDrawingVisitor*>( visitor );
+	if ( !smVisitor )
+		return;
+
+	smVisitor->setShadowMap( this );
+	smVisitor->setCamera( scene->getActiveCamera() );
+
+	GLuint cscCnt = getActiveCascadeCount();
+	for (GLuint i = 0; i < cscCnt; i++)
+	{
+		smVisitor->setCascadeIndex( i );
+		smVisitor->setRenderSurface( getRenderSurfaceAt( i ) );
+		smVisitor->visit( scene );
+	}
+
+	smVisitor->setShadowMap( NULL );
+}
+
+CC3ShadowMap* CC3ShadowMapDrawingVisitor::getShadowMap()
+{
+	return m_shadowMap;
+}
+
+void CC3ShadowMapDrawingVisitor::setShadowMap( CC3ShadowMap* shadowMap )
+{
+	m_shadowMap = shadowMap;		// weak reference
+}
+
+GLuint CC3ShadowMapDrawingVisitor::getCascadeIndex()
+{
+	return m_cascadeIndex;
+}
+
+void CC3ShadowMapDrawingVisitor::setCascadeIndex( GLuint index )
+{
+	m_cascadeIndex = index;
+}
+
+void CC3ShadowMapDrawingVisitor::init()
+{
+	super::init();
+	m_shadowMap = NULL;
+	m_cascadeIndex = 0;
+	m_shouldDecorateNode = false;
+}
+
+CC3ShadowMapDrawingVisitor* CC3ShadowMapDrawingVisitor::visitor()
+{
+	CC3ShadowMapDrawingVisitor* pVal = new CC3ShadowMapDrawingVisitor;
+	pVal->init();
+	pVal->autorelease();
+
+	return pVal;
+}
+
+bool CC3ShadowMapDrawingVisitor::shouldDrawNode( CC3Node* aNode )
+{
+	return aNode->shouldCastShadows() && super::shouldDrawNode( aNode );
+}
+
+bool CC3ShadowMapDrawingVisitor::doesNodeIntersectFrustum( CC3Node* aNode )
+{
+	if ( !m_shadowMap )
+		return super::doesNodeIntersectFrustum( aNode );
+
+	return m_shadowMap->doesCascadeIntersectNode( m_cascadeIndex, aNode );
+}
+
+/** Loads the cascade matrices directly, bypassing the camera, and clears the depth map. */
+void CC3ShadowMapDrawingVisitor::openCamera()
+{
+	if ( !m_shadowMap )
+		return super::openCamera();
+
+	CC3ShadowMapCascade* csc = m_shadowMap->getCascadeAt( m_cascadeIndex );
+	m_projMatrix = csc->projMatrix;
+	m_viewMatrix = csc->viewMatrix;
+	m_isVPMtxDirty = true;
+	m_isMVMtxDirty = true;
+	m_isMVPMtxDirty = true;
+
+	CC3OpenGL* gl = getGL();
+	gl->loadProjectionMatrix( &m_projMatrix );
+	gl->loadModelviewMatrix( &m_viewMatrix );
+
+	gl->setColorMask( ccc4(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE) );
+	getRenderSurface()->clearDepthContent();
+}
+
+void CC3ShadowMapDrawingVisitor::closeCamera()
+{
+	if ( !m_shadowMap )
+		return super::closeCamera();
+
+	getGL()->setColorMask( ccc4(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE) );
+}
+
+NS_COCOS3D_END
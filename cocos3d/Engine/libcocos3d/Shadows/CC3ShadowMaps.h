@@ -0,0 +1,258 @@
+/*
+ * Cocos3D-X 1.0.0
+ * Author: Bill Hollings
+ * Copyright (c) 2010-2014 The Brenwill Workshop Ltd. All rights reserved.
+ * http://www.brenwill.com
+ *
+ * Copyright (c) 2014-2015 Jason Wang
+ * http://www.cocos3dx.org/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ * http://en.wikipedia.org/wiki/MIT_License
+ */
+#ifndef _CC3_SHADOWMAPS_H_
+#define _CC3_SHADOWMAPS_H_
+
+/** The maximum number of cascades that a single CC3ShadowMap can split the view into. */
+static const GLuint kCC3MaxShadowMapCascades = 4;
+
+/** The default side length, in pixels, of each shadow map cascade texture. */
+static const GLuint kCC3DefaultShadowMapSize = 1024;
+
+/** The default blend between logarithmic and uniform cascade split distances. */
+static const GLfloat kCC3DefaultShadowMapSplitLambda = 0.75f;
+
+/** The default depth bias used when comparing fragment depths against a shadow map. */
+static const GLfloat kCC3DefaultShadowMapDepthBias = 0.002f;
+
+NS_COCOS3D_BEGIN
+
+class CC3Light;
+class CC3Camera;
+class CC3Scene;
+class CC3GLFramebuffer;
+class CC3NodeDrawingVisitor;
+
+/**
+ * CC3ShadowMapCascade holds the per-cascade state of a CC3ShadowMap: the light-space
+ * view and projection matrices that render the casters into the cascade depth texture,
+ * the matrix that maps a global location into the texture space of that depth texture,
+ * the clipping planes used to cull casters, and the view-depth range covered by the cascade.
+ */
+typedef struct {
+	CC3Matrix4x3		viewMatrix;			/**< Global space to light space. */
+	CC3Matrix4x4		projMatrix;			/**< Light space to light clip space. */
+	CC3Matrix4x4		viewProjMatrix;		/**< Global space to light clip space. */
+	CC3Matrix4x4		textureMatrix;		/**< Global space to depth texture space [0, 1]. */
+	CC3Plane			planes[6];			/**< Inward facing culling planes, in global space. */
+	GLfloat				splitNear;			/**< Camera view distance at which this cascade starts. */
+	GLfloat				splitFar;			/**< Camera view distance at which this cascade ends. */
+} CC3ShadowMapCascade;
+
+/**
+ * CC3ShadowMap renders the shadow casting nodes of a scene into one or more depth textures,
+ * as seen from a light, so that shaders can determine whether a fragment is in shadow by
+ * comparing its depth from the light with the depth stored in the shadow map.
+ *
+ * Shadow maps are an alternative to the stencilled shadow volumes implemented by
+ * CC3ShadowVolumeMeshNode. Shadow maps do not require any extra geometry per caster, cost
+ * one depth-only pass per cascade regardless of the geometric complexity of the casters,
+ * and allow receivers to be shaded softly. The technique used by each light is selected
+ * with the shadowTechnique property of CC3Light.
+ *
+ * For a directional light, the view frustum of the active camera is split along its depth
+ * into cascadeCount slices, and each slice is covered by its own orthographic depth map. Slices
+ * near the camera therefore receive more shadow texels per world unit than distant slices.
+ * The split distances are determined by the splitLambda property, which blends between a
+ * uniform split and a logarithmic split.
+ *
+ * For a spot light, a single perspective depth map is rendered from the location of the light,
+ * covering the cone of the light. Point lights, whose shadows would require a cube map, are
+ * not supported, and will not cast shadows using this technique.
+ *
+ * Each cascade only renders the nodes whose global bounding box intersects that cascade's
+ * light-space volume, and whose shouldCastShadows property is set.
+ */
+class CC3ShadowMap : public CCObject
+{
+public:
+	CC3ShadowMap();
+	virtual ~CC3ShadowMap();
+
+	/** The light that casts the shadows held in this shadow map. This is a weak reference. */
+	CC3Light*					getLight();
+	void						setLight( CC3Light* light );
+
+	/**
+	 * The number of cascades into which the view frustum is split. For spot lights, this
+	 * property is ignored, and a single map is used.
+	 *
+	 * The value is clamped between one and kCC3MaxShadowMapCascades.
+	 * The initial value of this property is kCC3MaxShadowMapCascades.
+	 */
+	GLuint						getCascadeCount();
+	void						setCascadeCount( GLuint count );
+
+	/** 
+	 * Returns the number of cascades actually in use, taking into consideration the type of light.
+	 * Returns zero if the light cannot cast shadow-mapped shadows.
+	 */
+	GLuint						getActiveCascadeCount();
+
+	/**
+	 * The side length, in pixels, of each cascade depth texture.
+	 *
+	 * Changing this property releases the existing depth textures, which will be recreated
+	 * on the next render. The initial value of this property is kCC3DefaultShadowMapSize.
+	 */
+	GLuint						getMapSize();
+	void						setMapSize( GLuint mapSize );
+
+	/**
+	 * Blend factor between a logarithmic (1.0) and a uniform (0.0) distribution of the
+	 * cascade split distances. The initial value is kCC3DefaultShadowMapSplitLambda.
+	 */
+	GLfloat						getSplitLambda();
+	void						setSplitLambda( GLfloat lambda );
+
+	/**
+	 * The maximum distance from the camera over which shadows are rendered. If zero, the far
+	 * clipping distance of the camera is used. Limiting the shadow distance concentrates the
+	 * shadow texels closer to the camera. The initial value of this property is zero.
+	 */
+	GLfloat						getMaxShadowDistance();
+	void						setMaxShadowDistance( GLfloat distance );
+
+	/**
+	 * The distance behind each directional cascade, in the direction of the light, over which
+	 * casters outside the view frustum are still rendered into the cascade, so that they can
+	 * cast shadows into the visible region. The initial value of this property is 100.
+	 */
+	GLfloat						getCasterReach();
+	void						setCasterReach( GLfloat reach );
+
+	/**
+	 * The bias that shaders should subtract from a fragment depth before comparing it against
+	 * the shadow map, to avoid self-shadowing acne. The initial value is kCC3DefaultShadowMapDepthBias.
+	 */
+	GLfloat						getDepthBias();
+	void						setDepthBias( GLfloat bias );
+
+	/** Returns the cascade at the specified index. */
+	CC3ShadowMapCascade*		getCascadeAt( GLuint index );
+
+	/** Returns the depth texture of the cascade at the specified index, creating it if needed. */
+	CC3Texture*					getDepthTextureAt( GLuint index );
+
+	/** Returns the matrix that maps global locations into the depth texture of the specified cascade. */
+	const CC3Matrix4x4*			getShadowMatrixAt( GLuint index );
+
+	/**
+	 * Returns the far split distance of each cascade, as view distances from the camera, packed
+	 * into a vector. Components beyond the active cascade count are set to the last split distance.
+	 */
+	CC3Vector4					getSplitDistances();
+
+	/**
+	 * Recalculates the cascade splits and light-space matrices, so that they cover the view
+	 * frustum of the specified camera.
+	 *
+	 * This method is invoked automatically by the light once per frame, when the shadows are updated.
+	 */
+	void						updateWithCamera( CC3Camera* camera );
+
+	/** Returns whether the global bounding box of the specified node intersects the specified cascade. */
+	bool						doesCascadeIntersectNode( GLuint index, CC3Node* aNode );
+
+	/**
+	 * Renders the shadow casters of the specified scene into the depth texture of each cascade,
+	 * using the specified visitor, which is usually an instance of CC3ShadowMapDrawingVisitor.
+	 */
+	void						drawWithVisitor( CC3Scene* scene, CC3NodeDrawingVisitor* visitor );
+
+	/** Releases the GL depth textures and framebuffers held by this shadow map. */
+	void						releaseRenderSurfaces();
+
+	void						initForLight( CC3Light* light );
+	static CC3ShadowMap*		shadowMapForLight( CC3Light* light );
+
+protected:
+	void						updateDirectionalCascade( GLuint index, CC3Camera* camera, GLfloat splitNear, GLfloat splitFar );
+	void						updateSpotCascade( GLuint index );
+	void						finishCascade( GLuint index );
+	CC3GLFramebuffer*			getRenderSurfaceAt( GLuint index );
+
+protected:
+	CC3Light*					m_light;
+	CC3GLFramebuffer*			m_renderSurfaces[kCC3MaxShadowMapCascades];
+	CC3ShadowMapCascade			m_cascades[kCC3MaxShadowMapCascades];
+	GLuint						m_cascadeCount;
+	GLuint						m_mapSize;
+	GLfloat						m_splitLambda;
+	GLfloat						m_maxShadowDistance;
+	GLfloat						m_casterReach;
+	GLfloat						m_depthBias;
+};
+
+/**
+ * CC3ShadowMapDrawingVisitor is a CC3NodeDrawingVisitor that renders the shadow casting nodes
+ * of a scene into the depth texture of a single cascade of a CC3ShadowMap.
+ *
+ * Instead of using a camera, the view and projection matrices are taken from the cascade,
+ * and nodes are culled against the cascade volume instead of the camera frustum. Only nodes
+ * whose shouldCastShadows property is set are drawn, and they are drawn undecorated, with
+ * writing to the color buffer disabled.
+ */
+class CC3ShadowMapDrawingVisitor : public CC3NodeDrawingVisitor
+{
+	DECLARE_SUPER( CC3NodeDrawingVisitor );
+public:
+	/** The shadow map being rendered. This is a weak reference. */
+	CC3ShadowMap*				getShadowMap();
+	void						setShadowMap( CC3ShadowMap* shadowMap );
+
+	/** The index of the cascade being rendered. */
+	GLuint						getCascadeIndex();
+	void						setCascadeIndex( GLuint index );
+
+	/** Only draws nodes that cast shadows. */
+	bool						shouldDrawNode( CC3Node* aNode );
+
+	/** Culls nodes against the volume of the current cascade. */
+	bool						doesNodeIntersectFrustum( CC3Node* aNode );
+
+	void						init();
+	static CC3ShadowMapDrawingVisitor* visitor();
+
+protected:
+	/** Loads the view and projection matrices of the current cascade, and disables color writes. */
+	void						openCamera();
+
+	/** Restores color writes. */
+	void						closeCamera();
+
+protected:
+	CC3ShadowMap*				m_shadowMap;
+	GLuint						m_cascadeIndex;
+};
+
+NS_COCOS3D_END
+
+#endif
@@ -28,51 +28,267 @@
  * http://en.wikipedia.org/wiki/MIT_License
  */
 #include "cocos3d.h"
+#include <map>
+#include <algorithm>
 
 NS_COCOS3D_BEGIN
 
+// Interned keys live for the life of the app, and are shared by all caches.
+static std::map<std::string, CC3CacheKey*>* _internedKeys = NULL;
+static pthread_mutex_t _internedKeysMutex = PTHREAD_MUTEX_INITIALIZER;
+
 CC3Cache::CC3Cache()
 {
-	m_objectsByName = NULL;
 	m_typeName = "";
-//	_mutex = 0;
+	m_capacity = 0;
+	m_strongCost = 0;
+	m_isWeak = false;
+	pthread_mutex_init( &m_costMutex, NULL );
+	for ( int i = 0; i < kCC3CacheShardCount; i++ )
+	{
+		pthread_rwlock_init( &m_shards[i].lock, NULL );
+		m_shards[i].count = 0;
+	}
 }
 
 CC3Cache::~CC3Cache()
 {
-	CC_SAFE_RELEASE_NULL( m_objectsByName );
+	for ( int i = 0; i < kCC3CacheShardCount; i++ )
+	{
+		CC3CacheShard* shard = &m_shards[i];
+		for ( unsigned int s = 0; s < shard->slots.size(); s++ )
+		{
+			CC3CacheEntry& entry = shard->slots[s];
+			if ( entry.key && !entry.isWeak )
+				entry.object->release();
+		}
+		pthread_rwlock_destroy( &shard->lock );
+	}
+	pthread_mutex_destroy( &m_costMutex );
+}
+
+unsigned int CC3Cache::hashName( const char* name, size_t length )
+{
+	// FNV-1a
+	unsigned int hash = 2166136261u;
+	for ( size_t i = 0; i < length; i++ )
+	{
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+const CC3CacheKey* CC3Cache::internKey( const std::string& name )
+{
+	pthread_mutex_lock( &_internedKeysMutex );
+
+	if ( !_internedKeys )
+		_internedKeys = new std::map<std::string, CC3CacheKey*>();
+
+	CC3CacheKey* key = NULL;
+	std::map<std::string, CC3CacheKey*>::iterator iter = _internedKeys->find( name );
+	if ( iter != _internedKeys->end() )
+	{
+		key = iter->second;
+	}
+	else
+	{
+		key = new CC3CacheKey;
+		key->name = name;
+		key->hash = hashName( name.c_str(), name.length() );
+		(*_internedKeys)[name] = key;
+	}
+
+	pthread_mutex_unlock( &_internedKeysMutex );
+	return key;
+}
+
+CC3CacheShard* CC3Cache::getShardForHash( unsigned int hash )
+{
+	// Slots are indexed by the low bits of the hash, so pick the shard with the high bits
+	return &m_shards[(hash >> 24) & (kCC3CacheShardCount - 1)];
+}
+
+int CC3Cache::findSlot( CC3CacheShard* shard, const std::string& name, unsigned int hash )
+{
+	unsigned int capacity = shard->slots.size();
+	if ( capacity == 0 )
+		return -1;
+
+	unsigned int mask = capacity - 1;
+	for ( unsigned int i = hash & mask; shard->slots[i].key; i = (i + 1) & mask )
+	{
+		const CC3CacheKey* key = shard->slots[i].key;
+		if ( key->hash == hash && key->name == name )
+			return i;
+	}
+	return -1;
+}
+
+int CC3Cache::findSlotForKey( CC3CacheShard* shard, const CC3CacheKey* key )
+{
+	unsigned int capacity = shard->slots.size();
+	if ( capacity == 0 )
+		return -1;
+
+	unsigned int mask = capacity - 1;
+	for ( unsigned int i = key->hash & mask; shard->slots[i].key; i = (i + 1) & mask )
+	{
+		if ( shard->slots[i].key == key )
+			return i;
+	}
+	return -1;
+}
+
+void CC3Cache::insertSlot( CC3CacheShard* shard, const CC3CacheEntry& entry )
+{
+	// Keep the load factor at or below one half, so probe sequences stay short
+	if ( (shard->count + 1) * 2 > shard->slots.size() )
+	{
+		std::vector<CC3CacheEntry> oldSlots;
+		oldSlots.swap( shard->slots );
+
+		CC3CacheEntry emptyEntry;
+		memset( &emptyEntry, 0, sizeof(emptyEntry) );
+		shard->slots.resize( oldSlots.empty() ? 16 : oldSlots.size() * 2, emptyEntry );
+		shard->count = 0;
+
+		for ( unsigned int i = 0; i < oldSlots.size(); i++ )
+		{
+			if ( oldSlots[i].key )
+				insertSlot( shard, oldSlots[i] );
+		}
+	}
+
+	unsigned int mask = shard->slots.size() - 1;
+	unsigned int i = entry.key->hash & mask;
+	while ( shard->slots[i].key )
+		i = (i + 1) & mask;
+
+	shard->slots[i] = entry;
+	shard->count++;
+}
+
+void CC3Cache::eraseSlot( CC3CacheShard* shard, int slotIndex )
+{
+	// Backward-shift deletion keeps the probe sequences intact without tombstones
+	unsigned int mask = shard->slots.size() - 1;
+	unsigned int hole = slotIndex;
+	unsigned int next = hole;
+	while ( true )
+	{
+		next = (next + 1) & mask;
+		const CC3CacheKey* key = shard->slots[next].key;
+		if ( !key )
+			break;
+
+		unsigned int home = key->hash & mask;
+		bool homeBetween = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+		if ( !homeBetween )
+		{
+			shard->slots[hole] = shard->slots[next];
+			hole = next;
+		}
+	}
+
+	shard->slots[hole].key = NULL;
+	shard->slots[hole].object = NULL;
+	shard->count--;
+}
+
+CC3Cacheable* CC3Cache::lookupInShard( CC3CacheShard* shard, int slotIndex )
+{
+	if ( slotIndex < 0 )
+		return NULL;
+
+	CC3CacheEntry& entry = shard->slots[slotIndex];
+
+	// A weak object whose last reference has been released is being deallocated,
+	// and will remove itself as soon as its destructor can take the shard lock.
+	if ( entry.isWeak && entry.object->retainCount() == 0 )
+		return NULL;
+
+	// Only an eviction hint, so concurrent readers storing the same frame number is harmless
+	if ( m_capacity && !entry.isWeak )
+		entry.lastAccessFrame = CCDirector::sharedDirector()->getTotalFrames();
+
+	return entry.object;
 }
 
 CC3Cacheable* CC3Cache::getObjectNamed( const std::string& name )
 {
-	CC3Cacheable* obj = (CC3Cacheable*)m_objectsByName->objectForKey( name );
+	unsigned int hash = hashName( name.c_str(), name.length() );
+	CC3CacheShard* shard = getShardForHash( hash );
+
+	pthread_rwlock_rdlock( &shard->lock );
+	CC3Cacheable* obj = lookupInShard( shard, findSlot( shard, name, hash ) );
+	pthread_rwlock_unlock( &shard->lock );
+
+	return obj;
+}
+
+CC3Cacheable* CC3Cache::getObjectForKey( const CC3CacheKey* key )
+{
+	if ( !key )
+		return NULL;
+
+	CC3CacheShard* shard = getShardForHash( key->hash );
+
+	pthread_rwlock_rdlock( &shard->lock );
+	CC3Cacheable* obj = lookupInShard( shard, findSlotForKey( shard, key ) );
+	pthread_rwlock_unlock( &shard->lock );
+
 	return obj;
 }
-//
+
 void CC3Cache::removeObject( CC3Cacheable* obj )
 {
-	removeObjectNamed( obj->getName() ); 
+	if ( obj )
+		removeObjectNamed( obj->getName(), obj );
 }
 
 void CC3Cache::removeObjectNamed( const std::string& name )
 {
-	if ( name.empty() || m_objectsByName == NULL ) 
+	removeObjectNamed( name, NULL );
+}
+
+void CC3Cache::removeObjectNamed( const std::string& name, CC3Cacheable* expectedObj )
+{
+	if ( name.empty() ) 
 		return;
 
-	// If this cache is the only thing referencing the object, it will be deallocated immediately,
-	// which may interfere with with further processing of the removed object on this loop,
-	// including the auto-removal of weakly-cached objects from within the dealloc method of
-	// the removed object itself, resulting in a deadlock. To avoid this deadlock, the object
-	// is retained before removing it from the cache, and then autoreleased. In the case of a
-	// weakly-held value, we are careful to retain the NSValue wrapper, not the object itself,
-	// in case this removal is occurring from within the dealloc method of the object itself.
-	CC3Cacheable* obj = (CC3Cacheable*)m_objectsByName->objectForKey( name );
-	CC_SAFE_RETAIN( obj );
-	
-	m_objectsByName->removeObjectForKey( name );
+	unsigned int hash = hashName( name.c_str(), name.length() );
+	CC3CacheShard* shard = getShardForHash( hash );
 
-	if ( obj )
-		obj->autorelease();		// Let the object go once the loop is done
+	pthread_rwlock_wrlock( &shard->lock );
+
+	int slotIndex = findSlot( shard, name, hash );
+	// When removing a specific object, leave any other object cached under the same name
+	if ( slotIndex < 0 || (expectedObj && shard->slots[slotIndex].object != expectedObj) )
+	{
+		pthread_rwlock_unlock( &shard->lock );
+		return;
+	}
+
+	CC3CacheEntry entry = shard->slots[slotIndex];
+	eraseSlot( shard, slotIndex );
+
+	pthread_rwlock_unlock( &shard->lock );
+
+	if ( entry.isWeak )
+		return;
+
+	pthread_mutex_lock( &m_costMutex );
+	m_strongCost -= entry.cost;
+	pthread_mutex_unlock( &m_costMutex );
+
+	// If this cache is the only thing referencing the object, it would be deallocated immediately,
+	// which may interfere with further processing of the removed object by the caller. To avoid
+	// this, the object is autoreleased rather than released, and lives until the loop is done.
+	// A weakly-held object is never retained, in case this removal is occurring from within
+	// its own destructor.
+	entry.object->autorelease();
 }
 
 void CC3Cache::setIsWeak( bool weak )
@@ -85,23 +301,78 @@ bool CC3Cache::isWeak()
 	return m_isWeak;
 }
 
-void CC3Cache::removeAllObjectsOfType( int type )
+unsigned long CC3Cache::getCapacity()
+{
+	return m_capacity;
+}
+
+void CC3Cache::setCapacity( unsigned long capacity )
+{
+	m_capacity = capacity;
+	enforceCapacity();
+}
+
+unsigned long CC3Cache::getStrongCost()
+{
+	return m_strongCost;
+}
+
+unsigned int CC3Cache::getObjectCount()
 {
-	CCArray* names = m_objectsByName->allKeys();
-	if ( names )
+	unsigned int count = 0;
+	for ( int i = 0; i < kCC3CacheShardCount; i++ )
 	{
-		for (unsigned int i = 0; i < names->count(); i++)
-		{
-			const char* key = ((CCString*)names->objectAtIndex(i))->getCString();
-			m_objectsByName->removeObjectForKey( key );
-		}
+		pthread_rwlock_rdlock( &m_shards[i].lock );
+		count += m_shards[i].count;
+		pthread_rwlock_unlock( &m_shards[i].lock );
 	}
+	return count;
+}
+
+std::string CC3Cache::getTypeName()
+{
+	return m_typeName;
+}
+
+void CC3Cache::removeAllObjectsOfType( int type )
+{
+	removeAllObjects();
 }
 
 void CC3Cache::removeAllObjects()
 {
-	if ( m_objectsByName )
-		m_objectsByName->removeAllObjects();
+	std::vector<CC3Cacheable*> strongObjects;
+
+	for ( int i = 0; i < kCC3CacheShardCount; i++ )
+	{
+		CC3CacheShard* shard = &m_shards[i];
+		pthread_rwlock_wrlock( &shard->lock );
+
+		for ( unsigned int s = 0; s < shard->slots.size(); s++ )
+		{
+			CC3CacheEntry& entry = shard->slots[s];
+			if ( !entry.key )
+				continue;
+
+			if ( entry.isWeak )
+				CC3_TRACE( "[rez]%s %s is weakly cached and is still retained elsewhere when the cache is cleared", 
+					m_typeName.c_str(), entry.key->name.c_str() );
+			else
+				strongObjects.push_back( entry.object );
+		}
+		shard->slots.clear();
+		shard->count = 0;
+
+		pthread_rwlock_unlock( &shard->lock );
+	}
+
+	pthread_mutex_lock( &m_costMutex );
+	m_strongCost = 0;
+	pthread_mutex_unlock( &m_costMutex );
+
+	// Released outside the locks, since each object removes itself from the cache when deallocated
+	for ( unsigned int i = 0; i < strongObjects.size(); i++ )
+		strongObjects[i]->release();
 }
 
 void CC3Cache::addObject( CC3Cacheable* obj )
@@ -112,21 +383,133 @@ void CC3Cache::addObject( CC3Cacheable* obj )
 	std::string objName = obj->getName();
 	CCAssert(!objName.empty(), "obj cannot be added to the cache because its name property is nil.");
 
-	CC3Cacheable* cached = getObjectNamed( objName );
-	if ( cached == obj )
-		return;
-	
-	if ( cached != NULL )
+	CC3CacheEntry entry;
+	entry.key = internKey( objName );
+	entry.object = obj;
+	entry.isWeak = m_isWeak;
+	entry.cost = entry.isWeak ? 0 : obj->getCacheCost();
+	entry.lastAccessFrame = CCDirector::sharedDirector()->getTotalFrames();
+
+	CC3CacheShard* shard = getShardForHash( entry.key->hash );
+	CC3CacheEntry replaced;
+	replaced.key = NULL;
+
+	pthread_rwlock_wrlock( &shard->lock );
+
+	int slotIndex = findSlotForKey( shard, entry.key );
+	if ( slotIndex >= 0 )
+	{
+		replaced = shard->slots[slotIndex];
+		if ( replaced.object == obj )
+		{
+			pthread_rwlock_unlock( &shard->lock );
+			return;
+		}
+		shard->slots[slotIndex] = entry;
+	}
+	else
+	{
+		insertSlot( shard, entry );
+	}
+
+	if ( !entry.isWeak )
+		obj->retain();
+
+	pthread_rwlock_unlock( &shard->lock );
+
+	if ( replaced.key )
 	{
 		CC3_WARNING( "Duplicated objects 0x%04x and 0x%04x with the same name %s found", (unsigned long long)obj, 
-			(unsigned long long)cached, objName.c_str() );
+			(unsigned long long)replaced.object, objName.c_str() );
 	}
 
-	m_objectsByName->setObject( obj, objName );
+	pthread_mutex_lock( &m_costMutex );
+	m_strongCost += entry.cost;
+	if ( replaced.key && !replaced.isWeak )
+		m_strongCost -= replaced.cost;
+	pthread_mutex_unlock( &m_costMutex );
+
+	if ( replaced.key && !replaced.isWeak )
+		replaced.object->release();
+
+	if ( m_capacity && m_strongCost > m_capacity )
+		enforceCapacity();
 		
 	CC3_TRACE("[rez]Added obj[%s] to the %s cache.", objName.c_str(), m_typeName.c_str());
 }
 
+/** An LRU candidate gathered by enforceCapacity. */
+typedef struct {
+	unsigned int			lastAccessFrame;
+	const CC3CacheKey*		key;
+} CC3CacheEvictionCandidate;
+
+static bool isAccessedBefore( const CC3CacheEvictionCandidate& a, const CC3CacheEvictionCandidate& b )
+{
+	return a.lastAccessFrame < b.lastAccessFrame;
+}
+
+void CC3Cache::enforceCapacity()
+{
+	if ( !m_capacity )
+		return;
+
+	std::vector<CC3Cacheable*> demotedObjects;
+
+	// Serializes evictions. Lock order is the cost mutex, then a shard lock.
+	pthread_mutex_lock( &m_costMutex );
+
+	if ( m_strongCost > m_capacity )
+	{
+		std::vector<CC3CacheEvictionCandidate> candidates;
+		for ( int i = 0; i < kCC3CacheShardCount; i++ )
+		{
+			CC3CacheShard* shard = &m_shards[i];
+			pthread_rwlock_rdlock( &shard->lock );
+			for ( unsigned int s = 0; s < shard->slots.size(); s++ )
+			{
+				CC3CacheEntry& entry = shard->slots[s];
+				if ( entry.key && !entry.isWeak && entry.cost )
+				{
+					CC3CacheEvictionCandidate candidate = { entry.lastAccessFrame, entry.key };
+					candidates.push_back( candidate );
+				}
+			}
+			pthread_rwlock_unlock( &shard->lock );
+		}
+
+		std::sort( candidates.begin(), candidates.end(), isAccessedBefore );
+
+		// Demote rather than drop, so an object still in use elsewhere can still be found
+		for ( unsigned int i = 0; i < candidates.size() && m_strongCost > m_capacity; i++ )
+		{
+			CC3CacheShard* shard = getShardForHash( candidates[i].key->hash );
+			pthread_rwlock_wrlock( &shard->lock );
+
+			int slotIndex = findSlotForKey( shard, candidates[i].key );
+			if ( slotIndex >= 0 && !shard->slots[slotIndex].isWeak )
+			{
+				CC3CacheEntry& entry = shard->slots[slotIndex];
+				m_strongCost -= entry.cost;
+				entry.cost = 0;
+				entry.isWeak = true;
+				demotedObjects.push_back( entry.object );
+			}
+
+			pthread_rwlock_unlock( &shard->lock );
+		}
+	}
+
+	pthread_mutex_unlock( &m_costMutex );
+
+	// An object released here for the last time removes itself from this cache
+	for ( unsigned int i = 0; i < demotedObjects.size(); i++ )
+	{
+		CC3_TRACE( "[rez]Demoted %s in the %s cache to a weak entry", demotedObjects[i]->getName().c_str(), m_typeName.c_str() );
+		demotedObjects[i]->release();
+	}
+}
+
 CC3Cache* CC3Cache::weakCacheForType( const std::string& typeName )
 {
 	CC3Cache* cache = new CC3Cache;
@@ -149,20 +532,63 @@ void CC3Cache::initAsWeakCache( bool _weak, const std::string& typeName )
 {
 	setIsWeak( _weak );
 	m_typeName = typeName;
-	m_objectsByName = CCDictionary::create();
-    
-    // Initialize dict type as string
-    CCObject* pObject = new CCObject;
-    m_objectsByName->setObject( pObject, "dummy_cc3_object" );
-    m_objectsByName->removeAllObjects();
-    CC_SAFE_DELETE( pObject );
-    
-	m_objectsByName->retain();
 }
 
-CCDictionary* CC3Cache::getAllObjects()
+CCArray* CC3Cache::getAllObjects()
+{
+	CCArray* objects = CCArray::create();
+
+	for ( int i = 0; i < kCC3CacheShardCount; i++ )
+	{
+		CC3CacheShard* shard = &m_shards[i];
+		pthread_rwlock_rdlock( &shard->lock );
+		for ( unsigned int s = 0; s < shard->slots.size(); s++ )
+		{
+			CC3Cacheable* obj = lookupInShard( shard, shard->slots[s].key ? (int)s : -1 );
+			if ( obj )
+				objects->addObject( obj );
+		}
+		pthread_rwlock_unlock( &shard->lock );
+	}
+
+	return objects;
+}
+
+static bool isNamedBefore( const std::pair<const CC3CacheKey*, CC3Cacheable*>& a, 
+						   const std::pair<const CC3CacheKey*, CC3Cacheable*>& b )
 {
-	return m_objectsByName;
+	return a.first->name < b.first->name;
+}
+
+CCArray* CC3Cache::objectsSortedByName()
+{
+	std::vector< std::pair<const CC3CacheKey*, CC3Cacheable*> > namedObjects;
+	CCArray* objects = CCArray::create();
+
+	for ( int i = 0; i < kCC3CacheShardCount; i++ )
+	{
+		CC3CacheShard* shard = &m_shards[i];
+		pthread_rwlock_rdlock( &shard->lock );
+		for ( unsigned int s = 0; s < shard->slots.size(); s++ )
+		{
+			CC3Cacheable* obj = lookupInShard( shard, shard->slots[s].key ? (int)s : -1 );
+			if ( obj )
+			{
+				// Retained by the array before the lock is released
+				objects->addObject( obj );
+				namedObjects.push_back( std::make_pair( shard->slots[s].key, obj ) );
+			}
+		}
+		pthread_rwlock_unlock( &shard->lock );
+	}
+
+	std::sort( namedObjects.begin(), namedObjects.end(), isNamedBefore );
+
+	CCArray* sortedObjects = CCArray::createWithCapacity( namedObjects.size() );
+	for ( unsigned int i = 0; i < namedObjects.size(); i++ )
+		sortedObjects->addObject( namedObjects[i].second );
+
+	return sortedObjects;
 }
 
 NS_COCOS3D_END
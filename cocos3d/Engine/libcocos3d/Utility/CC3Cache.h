@@ -30,9 +30,13 @@
 #ifndef _CC3_CACHE_H_
 #define _CC3_CACHE_H_
 #include <pthread.h>
+#include <vector>
 
 NS_COCOS3D_BEGIN
 
+/** The number of independently locked shards in each CC3Cache. Must be a power of two. */
+#define kCC3CacheShardCount		16
+
 /**
  * Defines the behaviour required for an object that can be held in a cache.
  *
@@ -44,8 +48,39 @@ class CC3Cacheable : public CCObject
 {
 public:
 	virtual std::string			getName() { return ""; };
+
+	/**
+	 * Returns the approximate number of bytes of memory held by this object. This is charged
+	 * against the capacity of a cache that has one. The default implementation returns zero.
+	 */
+	virtual unsigned long		getCacheCost() { return 0; };
 };
 
+/**
+ * An interned cache key. Each distinct name is interned once for the life of the app, and its
+ * hash is computed at that time, so interned keys can be compared by pointer.
+ */
+typedef struct {
+	std::string					name;
+	unsigned int				hash;
+} CC3CacheKey;
+
+/** An entry in a CC3Cache shard. Used internally. */
+typedef struct {
+	const CC3CacheKey*			key;				/**< The interned name. NULL for an empty slot. */
+	CC3Cacheable*				object;				/**< The cached object. Retained only if not weak. */
+	unsigned long				cost;				/**< The cost charged to the cache capacity. */
+	unsigned int				lastAccessFrame;	/**< The frame of the last lookup, for LRU eviction. */
+	bool						isWeak;				/**< Whether the object is held weakly. */
+} CC3CacheEntry;
+
+/** A separately locked open-addressing table within a CC3Cache. Used internally. */
+typedef struct {
+	pthread_rwlock_t			lock;
+	std::vector<CC3CacheEntry>	slots;
+	unsigned int				count;
+} CC3CacheShard;
+
 /**
  * Instances of CC3Cache hold cachable objects, which are stored and retrieved by name.
  *
@@ -54,10 +89,22 @@ public:
  * the same name exists in the cache already. To replace an object in the cache, you must
  * first remove the existing object from the cache.
  *
- * CC3Cache implements the NSLocking protocol, and all access to the cache contents is thread-safe.
+ * All access to the cache contents is thread-safe. Entries are spread across a number of
+ * shards by the hash of their name, and each shard has its own read-write lock, so lookups
+ * never wait for each other, and only wait for a write to the same shard.
  *
  * Each object may be held either strongly or weakly by this cache, depending on the value
- * of the isWeak property at the time the object was added to the cache.
+ * of the isWeak property at the time the object was added to the cache. A weakly cached
+ * object is not retained, and must remove itself from the cache when it is deallocated.
+ *
+ * If the capacity property is not zero, strongly cached objects are charged their cacheCost,
+ * and when the total exceeds the capacity, the least-recently looked up strong entries are
+ * demoted to weak entries. A demoted object stays in the cache for as long as something else
+ * retains it, and is deallocated, and removes itself, once nothing does.
+ *
+ * Cached objects are CCObjects, whose reference counts are not thread-safe. A strongly cached
+ * object that is removed from the cache is autoreleased, so strong entries should be removed
+ * on the main thread.
  */
 class CC3Cache : public CCObject
 {
@@ -86,9 +133,15 @@ public:
 	/**
 	 * Returns the cached object with the specified name,
 	 * or nil if an object with that name has not been cached.
+	 *
+	 * A weakly cached object is not retained by this cache, so a caller on another thread
+	 * should retain the returned object before the main thread can release it.
 	 */
 	CC3Cacheable*				getObjectNamed( const std::string& name );
 
+	/** Returns the cached object with the specified interned key, without hashing the name again. */
+	CC3Cacheable*				getObjectForKey( const CC3CacheKey* key );
+
 	/** Removes the specified object from the cache. */
 	void						removeObject( CC3Cacheable* obj );
 
@@ -117,14 +170,6 @@ public:
 	 */
 	void						removeAllObjectsOfType( int type );
 
-	/**
-	 * Enumerates all of the objects in the cache with the specified block.
-	 *
-	 * The block takes as arguments an object from the cache, and a pointer to a boolean that
-	 * can be set to YES to stop enumeration.
-	 */
-	//void						enumerateObjectsUsingBlock: (void (^) (id<CC3Cacheable> obj, BOOL* stop)) block;
-
 	/** 
 	 * Returns an array of all objects in this cache, sorted by name.
 	 *
@@ -154,6 +199,20 @@ public:
 	bool						isWeak();
 	void						setIsWeak( bool weak );
 
+	/**
+	 * The total cacheCost of strongly cached objects above which the least-recently used strong
+	 * entries are demoted to weak entries. A value of zero disables this policy. The initial
+	 * value of this property is zero.
+	 */
+	unsigned long				getCapacity();
+	void						setCapacity( unsigned long capacity );
+
+	/** Returns the total cacheCost of the objects currently held strongly by this cache. */
+	unsigned long				getStrongCost();
+
+	/** Returns the number of objects in this cache. */
+	unsigned int				getObjectCount();
+
 	/** 
 	 * Initializes this instance as either a weak or strong cache, for holding objects of
 	 * the specified content type.
@@ -183,12 +242,39 @@ public:
 	 */
 	static CC3Cache*			strongCacheForType( const std::string& typeName );
 
-	CCDictionary*				getAllObjects();
+	/**
+	 * Returns an autoreleased array holding all of the objects in this cache, in no particular order.
+	 *
+	 * Since the objects are retained within the returned array, be careful not to hold on to the array,
+	 * if you want weakly cached objects to be automatically removed from this cache.
+	 */
+	CCArray*					getAllObjects();
+
+	/** 
+	 * Returns the interned key for the specified name, creating it if needed.
+	 * The returned key remains valid for the life of the app.
+	 */
+	static const CC3CacheKey*	internKey( const std::string& name );
+
+	/** Returns the hash used for cache names. */
+	static unsigned int			hashName( const char* name, size_t length );
+
+protected:
+	CC3CacheShard*				getShardForHash( unsigned int hash );
+	int							findSlot( CC3CacheShard* shard, const std::string& name, unsigned int hash );
+	int							findSlotForKey( CC3CacheShard* shard, const CC3CacheKey* key );
+	void						insertSlot( CC3CacheShard* shard, const CC3CacheEntry& entry );
+	void						eraseSlot( CC3CacheShard* shard, int slotIndex );
+	CC3Cacheable*				lookupInShard( CC3CacheShard* shard, int slotIndex );
+	void						removeObjectNamed( const std::string& name, CC3Cacheable* expectedObj );
+	void						enforceCapacity();
 
 protected:
-	CCDictionary*				m_objectsByName;
+	CC3CacheShard				m_shards[kCC3CacheShardCount];
 	std::string					m_typeName;
-	pthread_mutex_t				m_mutex;
+	pthread_mutex_t				m_costMutex;
+	unsigned long				m_capacity;
+	unsigned long				m_strongCost;
 	bool						m_isWeak : 1;
 };
 
@@ -104,6 +104,7 @@ bool CC3PODResource::init()
 		_textures->retain();
 		_textureParameters = CC3Texture::defaultTextureParameters();
 		_shouldAutoBuild = true;
+		_shouldBuildInParallel = true;
 
 		return true;
 	}
@@ -129,13 +130,35 @@ bool CC3PODResource::processFile( const std::string& anAbsoluteFilePath )
 	return wasLoaded;
 }
 
+bool CC3PODResource::shouldAutoBuild()
+{
+	return _shouldAutoBuild;
+}
+
+void CC3PODResource::setShouldAutoBuild( bool autoBuild )
+{
+	_shouldAutoBuild = autoBuild;
+}
+
+bool CC3PODResource::shouldBuildInParallel()
+{
+	return _shouldBuildInParallel;
+}
+
+void CC3PODResource::setShouldBuildInParallel( bool inParallel )
+{
+	_shouldBuildInParallel = inParallel;
+}
+
 void CC3PODResource::build()
 {
 	buildSceneInfo();
 	//LogRez(@"Building %@", self.fullDescription);
+	prefetchTextures();
+	buildMeshes();
+	measureMeshBoundaries();
 	buildTextures();
 	buildMaterials();
-	buildMeshes();
 	buildNodes();
 	buildSoftBodyNode();
 	deleteCPVRTModelPOD();
@@ -542,6 +565,112 @@ CC3Mesh* CC3PODResource::buildMeshAtIndex( GLuint meshIndex )
 	return CC3PODMesh::meshAtIndex( meshIndex, this );
 }
 
+/** Meshes holding fewer vertices in total than this are measured on a single thread. */
+#define kCC3PODParallelVertexThreshold		16384
+#define kCC3PODMaxBuildThreadCount			8
+
+static GLuint CC3PODProcessorCount()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	long cpuCount = sysconf( _SC_NPROCESSORS_ONLN );
+	return (cpuCount > 1) ? (GLuint)cpuCount : 1;
+#else
+	return 2;
+#endif
+}
+
+/** A contiguous range of vertex location arrays, measured on a single thread. */
+typedef struct
+{
+	CC3VertexLocations**	locations;
+	GLuint					startIndex;
+	GLuint					endIndex;
+} CC3PODBoundaryBand;
+
+/**
+ * Measures the bounding box, center of geometry and radius of each vertex location array in
+ * the band. Each array is touched by only one band, and measuring only reads the vertex content
+ * and writes the boundary of that array, so bands can safely be measured concurrently.
+ */
+static void CC3PODMeasureBoundaries( const CC3PODBoundaryBand* band )
+{
+	for (GLuint i = band->startIndex; i < band->endIndex; i++) 
+	{
+		CC3VertexLocations* vLocs = band->locations[i];
+		vLocs->buildBoundingBoxIfNecessary();
+		vLocs->calcRadiusIfNecessary();
+	}
+}
+
+static void* CC3PODMeasureBoundariesBandMain( void* bandPtr )
+{
+	CC3PODMeasureBoundaries( (CC3PODBoundaryBand*)bandPtr );
+	return NULL;
+}
+
+void CC3PODResource::measureMeshBoundaries()
+{
+	// Collect the vertex locations that can be measured, on this thread.
+	std::vector<CC3VertexLocations*> vLocsList;
+	GLuint vtxTotal = 0;
+	GLuint mCount = _meshes->count();
+	for (GLuint i = 0; i < mCount; i++) 
+	{
+		CC3VertexLocations* vLocs = getMeshAtIndex(i)->getVertexLocations();
+		if ( !vLocs || !vLocs->getVertices() || vLocs->getElementType() != GL_FLOAT )
+			continue;
+
+		vLocsList.push_back( vLocs );
+		vtxTotal += vLocs->getVertexCount();
+	}
+
+	GLuint locsCount = (GLuint)vLocsList.size();
+	if (locsCount == 0) 
+		return;
+
+	CC3PODBoundaryBand bandTemplate;
+	bandTemplate.locations = &vLocsList[0];
+
+	GLuint bandCnt = MIN( MIN( CC3PODProcessorCount(), (GLuint)kCC3PODMaxBuildThreadCount ), locsCount );
+	if ( !_shouldBuildInParallel || vtxTotal < kCC3PODParallelVertexThreshold || bandCnt < 2 ) 
+	{
+		bandTemplate.startIndex = 0;
+		bandTemplate.endIndex = locsCount;
+		CC3PODMeasureBoundaries( &bandTemplate );
+		return;
+	}
+
+	// Split the meshes into bands holding roughly equal numbers of vertices.
+	CC3PODBoundaryBand bands[kCC3PODMaxBuildThreadCount];
+	pthread_t threads[kCC3PODMaxBuildThreadCount];
+	bool isThreaded[kCC3PODMaxBuildThreadCount];
+	GLuint locsIdx = 0;
+	GLuint vtxSoFar = 0;
+	for (GLuint i = 0; i < bandCnt; i++) 
+	{
+		bands[i] = bandTemplate;
+		bands[i].startIndex = locsIdx;
+		GLuint vtxBandEnd = (GLuint)((unsigned long)vtxTotal * (i + 1) / bandCnt);
+		while (locsIdx < locsCount && (vtxSoFar < vtxBandEnd || i == bandCnt - 1)) 
+			vtxSoFar += vLocsList[locsIdx++]->getVertexCount();
+		bands[i].endIndex = locsIdx;
+	}
+
+	// Run the first band on this thread. If a thread cannot be started, run its band here too.
+	for (GLuint i = 1; i < bandCnt; i++) 
+		isThreaded[i] = (pthread_create( &threads[i], NULL, CC3PODMeasureBoundariesBandMain, &bands[i] ) == 0);
+	CC3PODMeasureBoundaries( &bands[0] );
+	for (GLuint i = 1; i < bandCnt; i++) 
+	{
+		if ( isThreaded[i] )
+			pthread_join( threads[i], NULL );
+		else
+			CC3PODMeasureBoundaries( &bands[i] );
+	}
+
+	CC3_TRACE("CC3PODResource measured %d vertices of %d meshes on %d threads", vtxTotal, locsCount, bandCnt);
+}
+
 PODStructPtr CC3PODResource::getMeshPODStructAtIndex( GLuint meshIndex )
 {
 	return &getPvrtModelImpl()->pMesh[meshIndex]; 
@@ -686,8 +815,21 @@ void CC3PODResource::buildTextures()
 	}
 }
 
-/** Loads the texture file from the directory indicated by the directory property. */
-CC3Texture* CC3PODResource::buildTextureAtIndex( GLuint textureIndex )
+/** 
+ * Decoding each file is independent of the others, so all of the texture files are
+ * queued here, and are decoded by the worker threads while the meshes are built.
+ */
+void CC3PODResource::prefetchTextures()
+{
+	if ( !_shouldBuildInParallel )
+		return;
+
+	GLuint tCount = getTextureCount();
+	for (GLuint i = 0; i < tCount; i++) 
+		CC3Texture::prefetchTextureFromFile( getTextureFilePathAtIndex(i).c_str() );
+}
+
+std::string CC3PODResource::getTextureFilePathAtIndex( GLuint textureIndex )
 {
 	SPODTexture* pst = (SPODTexture*)getTexturePODStructAtIndex(textureIndex);
 	std::string texFile = pst->pszName;
@@ -699,7 +841,13 @@ CC3Texture* CC3PODResource::buildTextureAtIndex( GLuint textureIndex )
 	if ( texFile.find( ".bmp" ) != std::string::npos )
 		texFile = "Cocos3D.png";
 
-	std::string texPath = getDirectory() + texFile;
+	return getDirectory() + texFile;
+}
+
+/** Loads the texture file from the directory indicated by the directory property. */
+CC3Texture* CC3PODResource::buildTextureAtIndex( GLuint textureIndex )
+{
+	std::string texPath = getTextureFilePathAtIndex(textureIndex);
 	CC3Texture* tex = CC3Texture::textureFromFile(texPath.c_str());
 	if ( tex )
 		tex->setTextureParameters( _textureParameters );
@@ -187,6 +187,20 @@ public:
 	bool						shouldAutoBuild();
 	void						setShouldAutoBuild( bool autoBuild );
 
+	/**
+	 * Indicates whether the build method should spread independent work across background threads.
+	 *
+	 * When this property is set to YES, the texture files are decoded in parallel by the
+	 * CC3STBImageDecoder worker threads while the meshes are being built, and the bounding boxes
+	 * and radii of the meshes are then measured on a band of worker threads. All objects are still
+	 * created on the calling thread, and in POD index order, as are node linkage and any GL work,
+	 * so the components that are built are identical to those built with this property set to NO.
+	 *
+	 * The initial value of this property is YES.
+	 */
+	bool						shouldBuildInParallel();
+	void						setShouldBuildInParallel( bool inParallel );
+
 	/**
 	 * Template method that extracts and builds all components. This is automatically invoked from
 	 * the loadFromFile: method if the POD file was successfully loaded, and the shouldAutoBuild
@@ -194,12 +208,16 @@ public:
 	 * should not need to invoke this method directly.
 	 * 
 	 * The order of component extraction and building is:
+	 *   - texture file decoding is started in the background, by invoking the prefetchTextures template method
+	 *   - mesh models, by invoking the buildMeshes template method
+	 *   - mesh bounding volumes, by invoking the measureMeshBoundaries template method
 	 *   - textures, by invoking the buildTextures template method
 	 *   - materials, by invoking the buildMaterials template method
-	 *   - mesh models, by invoking the buildMeshes template method
 	 *   - nodes, by invoking the buildNodes template method
 	 *   - a soft body node if needed
 	 *
+	 * Meshes do not depend on textures or materials, so they are built while the texture files decode.
+	 *
 	 * This template method can be overridden in a subclass if specialized processing is required.
 	 */
 	void						build();
@@ -383,6 +401,17 @@ public:
 	 */
 	CC3Mesh*					buildMeshAtIndex( GLuint meshIndex );
 
+	/**
+	 * Template method that measures the bounding box and radius of the vertex locations of each
+	 * built mesh, so that they are not measured lazily the first time each is needed. When the
+	 * shouldBuildInParallel property is set to YES, and the meshes hold enough vertices to make
+	 * it worthwhile, the meshes are split into bands that are measured on separate threads.
+	 *
+	 * This is automatically invoked from the build method, after the buildMeshes method.
+	 * The application should not invoke this method directly.
+	 */
+	void						measureMeshBoundaries();
+
 	/**
 	 * Returns meshIndex'th SPODMesh structure from the data structures.
 	 * Note that meshIndex is an ordinal number indicating the rank of the mesh.
@@ -534,6 +563,22 @@ public:
 	 */
 	CC3Texture*					buildTextureAtIndex( GLuint textureIndex );
 
+	/**
+	 * Template method that starts decoding all of the texture files on background threads,
+	 * so that the decoded images are ready, or nearly so, when the buildTextures method runs.
+	 * Does nothing if the shouldBuildInParallel property is set to NO.
+	 *
+	 * This is automatically invoked from the build method.
+	 * The application should not invoke this method directly.
+	 */
+	void						prefetchTextures();
+
+	/**
+	 * Returns the path of the file from which the textureIndex'th texture is loaded.
+	 * Note that textureIndex is an ordinal number indicating the rank of the texture.
+	 */
+	std::string					getTextureFilePathAtIndex( GLuint textureIndex );
+
 	/**
 	 * Returns textureIndex'th SPODTexture structure from the data structures.
 	 * Note that textureIndex is an ordinal number indicating the rank of the texture.
@@ -567,6 +612,7 @@ protected:
 	GLuint						_animationFrameCount;
 	GLfloat						_animationFrameRate;
 	bool						_shouldAutoBuild : 1;
+	bool						_shouldBuildInParallel : 1;
 };
 
 
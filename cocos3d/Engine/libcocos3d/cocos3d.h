@@ -46,11 +46,13 @@
 #include "Common/CC3WeakRef.h"
 #include "Common/CC3Ref.h"
 #include "Common/CC3Collision.h"
+#include "Common/CC3SphericalHarmonics.h"
 
 /// matrices
 #include "Matrices/CC3Matrix3x3.h"
 #include "Matrices/CC3Matrix4x3.h"
 #include "Matrices/CC3Matrix4x4.h"
+#include "Matrices/CC3DualQuaternion.h"
 #include "Matrices/CC3Matrix.h"
 #include "Matrices/CC3AffineMatrix.h"
 #include "Matrices/CC3LinearMatrix.h"
@@ -72,6 +74,7 @@
 #include "Nodes/CC3BoundingVolumes.h"
 #include "Nodes/CC3Camera.h"
 #include "Nodes/CC3EnvironmentNodes.h"
+#include "Nodes/CC3LightProbeGrid.h"
 #include "Nodes/CC3Light.h"
 #include "Nodes/CC3LocalContentNode.h"
 #include "Nodes/CC3MeshNode.h"
@@ -133,6 +136,8 @@
 #include "Materials/CC3STBImage.h"
 #include "Materials/CC3Texture.h"
 #include "Materials/CC3TextureUnit.h"
+#include "Materials/CC3TextureResidency.h"
+#include "Materials/CC3KTXTexture.h"
 
 /// cc3PVR
 #include "cc3PVR/CC3PVRFoundation.h"
@@ -191,9 +196,11 @@
 #include "Scenes/CC3Layer.h"
 #include "Scenes/CC3NodeSequencer.h"
 #include "Scenes/CC3RenderSurfaces.h"
+#include "Scenes/CC3EnvironmentMapScheduler.h"
 #include "Scenes/CC3Scene.h"
 
 /// shadows
 #include "Shadows/CC3ShadowVolumes.h"
+#include "Shadows/CC3ShadowMaps.h"
 
 #endif